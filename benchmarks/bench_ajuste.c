@@ -0,0 +1,138 @@
+/**
+ * @file bench_ajuste.c
+ * @brief Ajuste de pesos: partidas por segundo e retomada do checkpoint
+ *
+ * Roda o algoritmo genético por algumas gerações de três formas: de uma
+ * vez com 1 thread, de uma vez com todas as threads e parando na metade,
+ * gravando o checkpoint e retomando de um estado carregado do arquivo. As
+ * três precisam chegar à mesma população, ao mesmo sorteio e aos mesmos
+ * melhores pesos: as partidas não dependem de quantas threads jogam, e o
+ * checkpoint guarda tudo o que a geração seguinte usa. Mede partidas por
+ * segundo no total e por núcleo.
+ *
+ * Por fim, joga mais gerações com ao menos 4 threads e confere que a
+ * memória em uso no malloc (todas as arenas da glibc) não cresce: cada
+ * geração cria threads novas, e uma arena de busca que não fosse devolvida
+ * somaria uma arena por thread por geração. O programa retorna 1 se algum
+ * estado divergir ou se a memória crescer mais que uma arena de busca.
+ *
+ * Compilação:
+ * @code
+ * gcc -O2 -pthread -o bench_ajuste benchmarks/bench_ajuste.c -lm
+ * ./bench_ajuste [geracoes] [populacao] [sequencias] [pecas] [threads]
+ * @endcode
+ */
+
+#define TETRIS_SEM_MAIN
+#include "../tetris.c"
+
+#include <malloc.h>
+#include <sys/resource.h>
+
+/// Bytes entregues pelo malloc e ainda não liberados, somando todas as arenas e os blocos mmap
+static long memoriaEmUso(void) {
+    struct mallinfo2 info = mallinfo2();
+    return (long)(info.uordblks + info.hblkhd);
+}
+
+/// Joga gerações até estadoPtr->geracao == ate; devolve partidas e tempo acumulados
+static int jogarGeracoes(const ConfigAjuste* configPtr, EstadoAjuste* estadoPtr, uint32_t ate, long* partidasPtr,
+                         double* segundosPtr) {
+    while (estadoPtr->geracao < ate) {
+        RelatorioGeracaoAjuste relatorio;
+        if (!executarGeracaoAjuste(configPtr, estadoPtr, &relatorio)) {
+            return 0;
+        }
+        *partidasPtr += relatorio.partidas;
+        *segundosPtr += relatorio.segundos;
+    }
+    return 1;
+}
+
+/// Compara o que a próxima geração usa (o tempo de jogo fica de fora)
+static int mesmoEstado(const EstadoAjuste* a, const EstadoAjuste* b) {
+    return a->geracao == b->geracao && a->estadoSorteio == b->estadoSorteio && a->sigma == b->sigma &&
+           a->aptidaoMelhor == b->aptidaoMelhor && a->partidasJogadas == b->partidasJogadas &&
+           memcmp(&a->melhor, &b->melhor, sizeof(a->melhor)) == 0 &&
+           memcmp(a->populacao, b->populacao, sizeof(PesosAvaliacao) * a->tamanhoPopulacao) == 0;
+}
+
+int main(int argc, char* argv[]) {
+    ConfigAjuste config;
+    configurarAjustePadrao(&config);
+    config.geracoes = argc > 1 ? atoi(argv[1]) : 4;
+    config.tamanhoPopulacao = argc > 2 ? atoi(argv[2]) : 16;
+    config.quantidadeSequencias = argc > 3 ? atoi(argv[3]) : 4;
+    config.limitePecas = argc > 4 ? atoi(argv[4]) : 200;
+    long nucleos = sysconf(_SC_NPROCESSORS_ONLN);
+    int numeroThreads = argc > 5 ? atoi(argv[5]) : (int)nucleos;
+    if (config.geracoes < 2 || config.tamanhoPopulacao < 2 || config.tamanhoPopulacao > MAX_POPULACAO_AJUSTE ||
+        numeroThreads < 1) {
+        fprintf(stderr, "Use ao menos 2 geracoes, populacao de 2 a %d e 1 thread\n", MAX_POPULACAO_AJUSTE);
+        return 1;
+    }
+    saidaSilenciosa = 1;
+    const char* caminho = "bench_ajuste.ckpt";
+
+    printf("=== AJUSTE DE PESOS ===\n");
+    printf("%d geracoes | populacao %d x %d sequencias | ate %d pecas | feixe %d\n", config.geracoes,
+           config.tamanhoPopulacao, config.quantidadeSequencias, config.limitePecas, config.base.larguraFeixe);
+
+    static EstadoAjuste sequencial, paralelo, retomado;
+    long partidas = 0;
+    double segundos = 0.0;
+    config.numeroThreads = 1;
+    iniciarEstadoAjuste(&config, &sequencial);
+    if (!jogarGeracoes(&config, &sequencial, (uint32_t)config.geracoes, &partidas, &segundos)) {
+        return 1;
+    }
+    double porSegundoSequencial = partidas / segundos;
+    printf(" 1 thread : %6ld partidas em %6.2fs | %7.1f partidas/s | %7.1f por nucleo\n", partidas, segundos,
+           porSegundoSequencial, porSegundoSequencial);
+
+    partidas = 0;
+    segundos = 0.0;
+    config.numeroThreads = numeroThreads;
+    iniciarEstadoAjuste(&config, &paralelo);
+    if (!jogarGeracoes(&config, &paralelo, (uint32_t)config.geracoes, &partidas, &segundos)) {
+        return 1;
+    }
+    int nucleosUsados = numeroThreads < nucleos || nucleos < 1 ? numeroThreads : (int)nucleos;
+    printf("%2d threads: %6ld partidas em %6.2fs | %7.1f partidas/s | %7.1f por nucleo (%d nucleos)\n",
+           numeroThreads, partidas, segundos, partidas / segundos, partidas / segundos / nucleosUsados,
+           nucleosUsados);
+
+    // Metade, checkpoint, retomada a partir do arquivo
+    EstadoAjuste metade;
+    iniciarEstadoAjuste(&config, &metade);
+    if (!jogarGeracoes(&config, &metade, (uint32_t)config.geracoes / 2, &partidas, &segundos) ||
+        !gravarCheckpointAjuste(caminho, &metade) || carregarCheckpointAjuste(caminho, &config, &retomado) != 1 ||
+        !jogarGeracoes(&config, &retomado, (uint32_t)config.geracoes, &partidas, &segundos)) {
+        unlink(caminho);
+        return 1;
+    }
+    unlink(caminho);
+
+    int divergentes = !mesmoEstado(&sequencial, &paralelo) + !mesmoEstado(&sequencial, &retomado);
+    printf("Melhor aptidao: %.1f | %d threads %s | retomado na geracao %d %s\n", sequencial.aptidaoMelhor,
+           numeroThreads, mesmoEstado(&sequencial, &paralelo) ? "igual" : "DIVERGE", config.geracoes / 2,
+           mesmoEstado(&sequencial, &retomado) ? "igual" : "DIVERGE");
+    printf("Estados divergentes: %d\n", divergentes);
+
+    // Mais gerações com threads novas a cada uma: a memória não pode crescer
+    config.numeroThreads = numeroThreads > 4 ? numeroThreads : 4;
+    jogarGeracoes(&config, &paralelo, paralelo.geracao + 1, &partidas, &segundos); // Aquece as arenas
+    long emUsoAntes = memoriaEmUso();
+    if (!jogarGeracoes(&config, &paralelo, paralelo.geracao + (uint32_t)config.geracoes, &partidas, &segundos)) {
+        return 1;
+    }
+    long crescimento = memoriaEmUso() - emUsoAntes;
+    long arena = (long)obterArenaBusca()->capacidade;
+    int vazamento = crescimento > arena;
+    struct rusage uso;
+    getrusage(RUSAGE_SELF, &uso);
+    printf("Memoria em uso: %+.1f KB em %d geracoes com %d threads (arena de busca: %.1f KB) %s | pico RSS %.1f MB\n",
+           crescimento / 1024.0, config.geracoes, config.numeroThreads, arena / 1024.0,
+           vazamento ? "CRESCE" : "estavel", uso.ru_maxrss / 1024.0);
+    return divergentes == 0 && !vazamento ? 0 : 1;
+}
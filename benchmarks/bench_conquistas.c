@@ -0,0 +1,140 @@
+/**
+ * @file bench_conquistas.c
+ * @brief Custo por jogada das conquistas: índice por campo x varredura da tabela
+ *
+ * Gera uma tabela com centenas de regras (limiares sorteados sobre os
+ * campos do Sistema Expert, parte delas com duas condições) e joga
+ * partidas sintéticas avaliando as conquistas depois de cada jogada de
+ * três formas: sem conquistas, com avaliarConquistas() e verificando todas
+ * as regras ainda bloqueadas. As duas últimas devem desbloquear as mesmas
+ * regras, na mesma jogada.
+ *
+ * Compilação:
+ * @code
+ * gcc -O2 -pthread -o bench_conquistas benchmarks/bench_conquistas.c -lm
+ * ./bench_conquistas [regras] [partidas] [jogadasPorPartida]
+ * @endcode
+ */
+
+#define TETRIS_SEM_MAIN
+#include "../tetris.c"
+#include "tempo_bench.h"
+
+/// Maior valor plausível de cada campo em uma partida do benchmark
+static int escalaCampo(int campo, int jogadas) {
+    switch (campo) {
+        case CAMPO_PONTUACAO_TOTAL: return 1500 * jogadas;
+        case CAMPO_NIVEL: return 30;
+        case CAMPO_MELHOR_COMBO: return 4;
+        case CAMPO_MARCOS: return 30;
+        case CAMPO_CONTAGEM_I: case CAMPO_CONTAGEM_O:
+        case CAMPO_CONTAGEM_T: case CAMPO_CONTAGEM_L: return jogadas / 7 + 1;
+        default: return jogadas;
+    }
+}
+
+/**
+ * @brief Versão sem índice: todas as regras bloqueadas são testadas
+ * @return Número de conquistas desbloqueadas agora
+ */
+static int varrerConquistas(const RegraConquista* regras, int quantidade, uint64_t* desbloqueadas,
+                            const SistemaExpert* sistemaPtr) {
+    int novas = 0;
+    for (int r = 0; r < quantidade; r++) {
+        if (desbloqueadas[r / 64] & (1ULL << (r % 64))) {
+            continue;
+        }
+        int valem = 1;
+        for (int c = 0; c < regras[r].quantidadeCondicoes && valem; c++) {
+            valem = valorCampoConquista(sistemaPtr, regras[r].condicoes[c].campo) >= regras[r].condicoes[c].limiar;
+        }
+        if (valem) {
+            desbloqueadas[r / 64] |= 1ULL << (r % 64);
+            novas++;
+        }
+    }
+    return novas;
+}
+
+int main(int argc, char* argv[]) {
+    int quantidadeRegras = argc > 1 ? atoi(argv[1]) : MAX_CONQUISTAS;
+    int partidas = argc > 2 ? atoi(argv[2]) : 200;
+    int jogadasPorPartida = argc > 3 ? atoi(argv[3]) : 5000;
+    if (quantidadeRegras < 1 || quantidadeRegras > MAX_CONQUISTAS) {
+        quantidadeRegras = MAX_CONQUISTAS;
+    }
+    saidaSilenciosa = 1;
+
+    GeradorPecas gerador;
+    inicializarGeradorPecas(&gerador, 36);
+    RegraConquista* regras = calloc((size_t)quantidadeRegras, sizeof(RegraConquista));
+    for (int r = 0; r < quantidadeRegras; r++) {
+        regras[r].nome = "Sintetica";
+        regras[r].descricao = "";
+        regras[r].quantidadeCondicoes = 1 + (r % 4 == 0);
+        for (int c = 0; c < regras[r].quantidadeCondicoes; c++) {
+            sortearTipoPeca(&gerador);
+            int campo = (int)(gerador.estado % NUMERO_CAMPOS_CONQUISTA);
+            regras[r].condicoes[c].campo = (uint8_t)campo;
+            regras[r].condicoes[c].limiar = 1 + (int)((gerador.estado >> 20) % (uint64_t)escalaCampo(campo, jogadasPorPartida));
+        }
+    }
+    MotorConquistas motor;
+    if (!compilarMotorConquistas(&motor, regras, quantidadeRegras)) {
+        fprintf(stderr, "Tabela de regras invalida\n");
+        return 1;
+    }
+
+    JogadaPeca* jogadas = malloc(sizeof(JogadaPeca) * (size_t)jogadasPorPartida);
+    SistemaExpert* sistema = aligned_alloc(_Alignof(SistemaExpert), sizeof(SistemaExpert));
+    EstadoConquistas conquistas;
+    uint64_t varridas[MAX_CONQUISTAS / 64];
+    double tempos[3] = {0.0, 0.0, 0.0};
+    long long desbloqueiosIndice = 0, desbloqueiosVarredura = 0;
+    int divergentes = 0;
+
+    for (int p = 0; p < partidas; p++) {
+        for (int j = 0; j < jogadasPorPartida; j++) {
+            jogadas[j].peca = criarPeca(sortearTipoPeca(&gerador), j);
+            jogadas[j].origem = (gerador.estado >> 33) % 4 == 0;
+        }
+        for (int modo = 0; modo < 3; modo++) {
+            memset(sistema, 0, sizeof(*sistema));
+            inicializarSistemaExpert(sistema);
+            if (modo == 1) {
+                inicializarConquistas(&conquistas, &motor);
+            } else if (modo == 2) {
+                memset(varridas, 0, sizeof(varridas));
+            }
+            double inicio = agoraSegundos();
+            for (int j = 0; j < jogadasPorPartida; j++) {
+                processarJogadaExpert(jogadas[j].peca, jogadas[j].origem, sistema);
+                if (modo == 1) {
+                    desbloqueiosIndice += avaliarConquistas(&motor, &conquistas, sistema);
+                } else if (modo == 2) {
+                    desbloqueiosVarredura += varrerConquistas(regras, quantidadeRegras, varridas, sistema);
+                }
+            }
+            tempos[modo] += agoraSegundos() - inicio;
+        }
+        divergentes += memcmp(conquistas.desbloqueadas, varridas, sizeof(varridas)) != 0;
+    }
+
+    double total = (double)partidas * jogadasPorPartida;
+    printf("=== CONQUISTAS POR JOGADA ===\n");
+    printf("Regras: %d (%d entradas no indice) | %d partidas x %d jogadas\n", quantidadeRegras,
+           motor.inicioCampo[NUMERO_CAMPOS_CONQUISTA], partidas, jogadasPorPartida);
+    printf("Sem conquistas:  %6.2f ns/jogada\n", tempos[0] / total * 1e9);
+    printf("Indice por campo: %6.2f ns/jogada (+%.2f)\n", tempos[1] / total * 1e9,
+           (tempos[1] - tempos[0]) / total * 1e9);
+    printf("Varredura:       %6.2f ns/jogada (+%.2f)\n", tempos[2] / total * 1e9,
+           (tempos[2] - tempos[0]) / total * 1e9);
+    printf("Desbloqueios: %lld (indice) | %lld (varredura) | partidas divergentes: %d\n",
+           desbloqueiosIndice, desbloqueiosVarredura, divergentes);
+
+    liberarMotorConquistas(&motor);
+    free(regras);
+    free(jogadas);
+    free(sistema);
+    return divergentes == 0 && desbloqueiosIndice == desbloqueiosVarredura ? 0 : 1;
+}
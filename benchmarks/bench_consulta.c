@@ -0,0 +1,157 @@
+/**
+ * @file bench_consulta.c
+ * @brief Arquivo de partidas: consultas com índice de zonas contra leitura completa
+ *
+ * Grava um arquivo de partidas de cerca de um milhão de resumos sintéticos
+ * divididos em vários arquivos (cada um com seu perfil de jogador: mais ou
+ * menos habilidoso, usando mais ou menos a reserva) e mede consultas típicas
+ * com o índice (resumo do arquivo, zonas de mínimo/máximo e mapas de bits
+ * de nível e combo) e lendo todas as partidas. As duas formas precisam
+ * encontrar exatamente as mesmas partidas.
+ *
+ * Compilação:
+ * @code
+ * gcc -O2 -pthread -o bench_consulta benchmarks/bench_consulta.c -lm
+ * ./bench_consulta [partidas] [arquivos] [prefixo]
+ * @endcode
+ */
+
+#define TETRIS_SEM_MAIN
+#include "../tetris.c"
+#include "tempo_bench.h"
+
+#define REPETICOES_CONSULTA 5
+
+static const char* const consultasBench[] = {
+    "comboAntesNivel3 >= 8",
+    "eficienciaMinima > 50",
+    "nivel >= 12, melhorCombo >= 15",
+    "nivel = 7, eficienciaReserva >= 60",
+    "pontuacao >= 150000",
+    "pecas < 100",
+};
+
+static uint64_t sortearBench(uint64_t* estadoPtr) {
+    *estadoPtr ^= *estadoPtr << 13;
+    *estadoPtr ^= *estadoPtr >> 7;
+    *estadoPtr ^= *estadoPtr << 17;
+    return *estadoPtr;
+}
+
+/// Resumo sintético de uma partida de um jogador com habilidade (0-1) e reserva (%) dadas
+static void sintetizarResumo(ResumoPartidaArquivo* resumoPtr, uint64_t partida, double habilidade, int reserva,
+                             uint64_t* estadoPtr) {
+    int32_t* valores = resumoPtr->valores;
+    resumoPtr->partida = partida;
+    int nivel = 1 + (int)(sortearBench(estadoPtr) % (uint64_t)(2 + habilidade * 12));
+    int melhorCombo = (int)(sortearBench(estadoPtr) % (uint64_t)(1 + nivel + habilidade * 6));
+    int pecas = 50 + nivel * 40 + (int)(sortearBench(estadoPtr) % 100);
+    int eficiencia = reserva + (int)(sortearBench(estadoPtr) % 20);
+    int minima = eficiencia - (int)(sortearBench(estadoPtr) % 20);
+    valores[COLUNA_PONTUACAO] = nivel * nivel * 1000 + melhorCombo * 500 + (int)(sortearBench(estadoPtr) % 1000);
+    valores[COLUNA_NIVEL] = nivel;
+    valores[COLUNA_MELHOR_COMBO] = melhorCombo;
+    valores[COLUNA_PECAS] = pecas;
+    valores[COLUNA_LINHAS] = pecas * 2 / 5;
+    valores[COLUNA_RESERVAS] = pecas * eficiencia / 100;
+    valores[COLUNA_EFICIENCIA_RESERVA] = eficiencia;
+    valores[COLUNA_EFICIENCIA_MINIMA] = minima < 0 ? 0 : minima;
+    // Maior combo antes de cada nível: cresce com o nível e é o melhor combo enquanto o nível não chegou lá
+    int combo = 0;
+    for (int k = 0; k < NIVEIS_COMBO_ARQUIVO; k++) {
+        int sorteado = (int)(sortearBench(estadoPtr) % (uint64_t)(2 * k + 3 + habilidade * 4));
+        combo = sorteado > combo ? sorteado : combo;
+        combo = combo < melhorCombo ? combo : melhorCombo;
+        valores[COLUNA_COMBO_ANTES_NIVEL + k] = nivel < k + 2 ? melhorCombo : combo;
+    }
+}
+
+/// Soma de controle das partidas encontradas (independe da ordem)
+static void somarPartidaBench(const ResumoPartidaArquivo* resumoPtr, void* contexto) {
+    *(uint64_t*)contexto += resumoPtr->partida * UINT64_C(0x9E3779B97F4A7C15);
+}
+
+/// Abre todos os arquivos e roda a consulta; devolve os segundos gastos
+static double rodarConsulta(char caminhos[][4096], int arquivos, const ConsultaPartidas* consultaPtr, int usarIndice,
+                            EstatisticasConsulta* estatisticasPtr, uint64_t* controlePtr) {
+    memset(estatisticasPtr, 0, sizeof(*estatisticasPtr));
+    *controlePtr = 0;
+    double inicio = agoraSegundos();
+    for (int f = 0; f < arquivos; f++) {
+        ArquivoPartidas arquivo;
+        if (!abrirArquivoPartidas(&arquivo, caminhos[f])) {
+            return -1;
+        }
+        consultarArquivoPartidas(&arquivo, consultaPtr, usarIndice, somarPartidaBench, controlePtr, estatisticasPtr);
+        fecharArquivoPartidas(&arquivo);
+    }
+    return agoraSegundos() - inicio;
+}
+
+int main(int argc, char* argv[]) {
+    long total = argc > 1 ? atol(argv[1]) : 1 << 20;
+    int arquivos = argc > 2 ? atoi(argv[2]) : 16;
+    const char* prefixo = argc > 3 ? argv[3] : "bench_consulta";
+    if (total < arquivos || arquivos < 1 || arquivos > 256) {
+        fprintf(stderr, "Use de 1 a 256 arquivos e pelo menos uma partida por arquivo\n");
+        return 1;
+    }
+
+    // Cada arquivo é um perfil de jogador; as partidas continuam numeradas em sequência
+    char (*caminhos)[4096] = malloc(sizeof(*caminhos) * (size_t)arquivos);
+    long porArquivo = total / arquivos;
+    ResumoPartidaArquivo* partidas = malloc(sizeof(ResumoPartidaArquivo) * (size_t)porArquivo);
+    uint64_t estado = 0x2545F4914F6CDD1DULL;
+    double inicio = agoraSegundos();
+    for (int f = 0; f < arquivos; f++) {
+        double habilidade = (double)f / (arquivos > 1 ? arquivos - 1 : 1);
+        int reserva = (int)(sortearBench(&estado) % 80);
+        for (long i = 0; i < porArquivo; i++) {
+            sintetizarResumo(&partidas[i], (uint64_t)f * (uint64_t)porArquivo + (uint64_t)i, habilidade, reserva, &estado);
+        }
+        snprintf(caminhos[f], sizeof(caminhos[f]), "%s_%02d.tap", prefixo, f);
+        if (!gravarArquivoPartidas(caminhos[f], partidas, (uint64_t)porArquivo)) {
+            return 1;
+        }
+    }
+    free(partidas);
+    printf("=== ARQUIVO DE PARTIDAS: %ld partidas em %d arquivos (gravados em %.2f s) ===\n",
+           porArquivo * arquivos, arquivos, agoraSegundos() - inicio);
+    printf("%-36s %10s | %9s %13s %13s | %9s %9s %8s\n", "Consulta", "Encontr.", "Arq. desc", "Blocos lidos",
+           "Partidas lid.", "Indice ms", "Tudo ms", "Ganho");
+
+    int divergentes = 0;
+    for (size_t q = 0; q < sizeof(consultasBench) / sizeof(consultasBench[0]); q++) {
+        ConsultaPartidas consulta;
+        if (!lerConsultaPartidas(consultasBench[q], &consulta)) {
+            return 1;
+        }
+        EstatisticasConsulta comIndice, semIndice;
+        uint64_t controleIndice = 0, controleTudo = 0;
+        double melhorIndice = 1e30, melhorTudo = 1e30;
+        for (int r = 0; r < REPETICOES_CONSULTA; r++) {
+            double segundos = rodarConsulta(caminhos, arquivos, &consulta, 1, &comIndice, &controleIndice);
+            melhorIndice = segundos < melhorIndice ? segundos : melhorIndice;
+            segundos = rodarConsulta(caminhos, arquivos, &consulta, 0, &semIndice, &controleTudo);
+            melhorTudo = segundos < melhorTudo ? segundos : melhorTudo;
+        }
+        if (melhorIndice < 0 || melhorTudo < 0) {
+            return 1;
+        }
+        int igual = comIndice.encontradas == semIndice.encontradas && controleIndice == controleTudo;
+        divergentes += !igual;
+        printf("%-36s %10llu | %4llu/%-4llu %6llu/%-6llu %13llu | %9.2f %9.2f %7.1fx%s\n", consultasBench[q],
+               (unsigned long long)comIndice.encontradas, (unsigned long long)comIndice.arquivosDescartados,
+               (unsigned long long)comIndice.arquivos,
+               (unsigned long long)(comIndice.blocos - comIndice.blocosDescartados),
+               (unsigned long long)comIndice.blocos, (unsigned long long)comIndice.partidasLidas,
+               melhorIndice * 1e3, melhorTudo * 1e3, melhorTudo / (melhorIndice > 0 ? melhorIndice : 1e-9),
+               igual ? "" : "  DIVERGENTE");
+    }
+    printf("Consultas divergentes: %d\n", divergentes);
+    for (int f = 0; f < arquivos; f++) {
+        unlink(caminhos[f]);
+    }
+    free(caminhos);
+    return divergentes == 0 ? 0 : 1;
+}
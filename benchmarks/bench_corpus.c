@@ -0,0 +1,155 @@
+/**
+ * @file bench_corpus.c
+ * @brief Corpus de sequências mapeado: abertura, reabastecimento e conferência
+ *
+ * Grava dois corpus com as sequências do gerador (semente i para a
+ * sequência i), um pequeno e um grande, e mede o custo de abri-los: como
+ * só o cabeçalho é lido, ele não deve crescer com o corpus. Depois esvazia
+ * e reabastece a fila com reabastecerFilaCorpus() e com reabastecerFila()
+ * sobre o gerador, conferindo peça a peça que tipos e IDs são os mesmos, e
+ * mede o primeiro acesso a sequências sorteadas do corpus grande.
+ *
+ * Compilação:
+ * @code
+ * gcc -O2 -pthread -o bench_corpus benchmarks/bench_corpus.c -lm
+ * ./bench_corpus [sequenciasGrande] [pecasPorSequencia] [caminho]
+ * @endcode
+ */
+
+#define TETRIS_SEM_MAIN
+#include "../tetris.c"
+#include "tempo_bench.h"
+
+#define SEQUENCIAS_PEQUENO 100
+#define ABERTURAS_MEDIDAS 200
+
+/// Grava um corpus com as sequências das sementes 0 .. quantidade - 1
+static int gravarCorpusGerador(const char* caminho, uint32_t quantidade, long pecasPorSequencia) {
+    char* tipos = malloc((size_t)quantidade * (size_t)pecasPorSequencia + 1);
+    uint64_t* inicios = malloc(sizeof(uint64_t) * ((size_t)quantidade + 1));
+    uint64_t total = 0;
+    for (uint32_t s = 0; s < quantidade; s++) {
+        GeradorPecas gerador;
+        inicializarGeradorPecas(&gerador, s);
+        inicios[s] = total;
+        for (long p = 0; p < pecasPorSequencia; p++) {
+            tipos[total++] = sortearTipoPeca(&gerador);
+        }
+    }
+    inicios[quantidade] = total;
+    int gravou = gravarCorpusSequencias(caminho, tipos, inicios, quantidade);
+    free(tipos);
+    free(inicios);
+    return gravou;
+}
+
+/// Microssegundos médios para abrir e fechar o corpus
+static double medirAbertura(const char* caminho) {
+    CorpusSequencias corpus;
+    double inicio = agoraSegundos();
+    for (int i = 0; i < ABERTURAS_MEDIDAS; i++) {
+        if (!abrirCorpusSequencias(&corpus, caminho)) {
+            return -1.0;
+        }
+        fecharCorpusSequencias(&corpus);
+    }
+    return (agoraSegundos() - inicio) * 1e6 / ABERTURAS_MEDIDAS;
+}
+
+int main(int argc, char* argv[]) {
+    uint32_t sequenciasGrande = argc > 1 ? (uint32_t)atol(argv[1]) : 100000;
+    long pecasPorSequencia = argc > 2 ? atol(argv[2]) : 500;
+    const char* caminho = argc > 3 ? argv[3] : "bench_corpus";
+    if (sequenciasGrande < SEQUENCIAS_PEQUENO || pecasPorSequencia < 1) {
+        fprintf(stderr, "Use pelo menos %d sequencias de 1 peca\n", SEQUENCIAS_PEQUENO);
+        return 1;
+    }
+    char caminhoPequeno[4096], caminhoGrande[4096];
+    snprintf(caminhoPequeno, sizeof(caminhoPequeno), "%s_pequeno.corpus", caminho);
+    snprintf(caminhoGrande, sizeof(caminhoGrande), "%s_grande.corpus", caminho);
+
+    printf("=== CORPUS DE SEQUENCIAS ===\n");
+    double inicio = agoraSegundos();
+    if (!gravarCorpusGerador(caminhoPequeno, SEQUENCIAS_PEQUENO, pecasPorSequencia) ||
+        !gravarCorpusGerador(caminhoGrande, sequenciasGrande, pecasPorSequencia)) {
+        return 1;
+    }
+    printf("Gravacao: %u + %u sequencias de %ld pecas em %.2fs\n", SEQUENCIAS_PEQUENO, sequenciasGrande,
+           pecasPorSequencia, agoraSegundos() - inicio);
+
+    double aberturaPequeno = medirAbertura(caminhoPequeno);
+    double aberturaGrande = medirAbertura(caminhoGrande);
+    CorpusSequencias corpus;
+    if (aberturaPequeno < 0 || aberturaGrande < 0 || !abrirCorpusSequencias(&corpus, caminhoGrande)) {
+        return 1;
+    }
+    struct stat pequeno;
+    stat(caminhoPequeno, &pequeno);
+    printf("Abertura: %.1f us (%u sequencias, %.1f KB) | %.1f us (%u sequencias, %.1f KB)\n", aberturaPequeno,
+           SEQUENCIAS_PEQUENO, pequeno.st_size / 1e3, aberturaGrande, sequenciasGrande, corpus.tamanho / 1e3);
+
+    // Primeiro acesso a sequências sorteadas (páginas ainda não tocadas)
+    FilaCircular fila;
+    inicializarFila(&fila);
+    GeradorPecas sorteio;
+    inicializarGeradorPecas(&sorteio, 99);
+    int sorteadas = sequenciasGrande < 1000 ? (int)sequenciasGrande : 1000;
+    inicio = agoraSegundos();
+    for (int i = 0; i < sorteadas; i++) {
+        CursorCorpus cursor;
+        sortearTipoPeca(&sorteio);
+        selecionarSequenciaCorpus(&corpus, (uint32_t)(sorteio.estado % sequenciasGrande), &cursor);
+        reabastecerFilaCorpus(&fila, &cursor);
+        while (!filaVazia(&fila)) {
+            jogarPecaDaFila(&fila);
+        }
+    }
+    double primeiroAcesso = (agoraSegundos() - inicio) * 1e6 / sorteadas;
+
+    // Esvaziar e reabastecer: corpus x gerador, conferindo cada peça
+    int conferidas = sequenciasGrande < 2000 ? (int)sequenciasGrande : 2000;
+    long divergentes = 0, pecas = 0;
+    double tempoCorpus = 0.0, tempoGerador = 0.0;
+    Peca* jogadas = malloc(sizeof(Peca) * (size_t)pecasPorSequencia);
+    for (int s = 0; s < conferidas; s++) {
+        CursorCorpus cursor;
+        selecionarSequenciaCorpus(&corpus, (uint32_t)s, &cursor);
+        inicio = agoraSegundos();
+        long quantidade = 0;
+        reabastecerFilaCorpus(&fila, &cursor);
+        while (!filaVazia(&fila)) {
+            jogadas[quantidade++] = jogarPecaDaFila(&fila);
+            reabastecerFilaCorpus(&fila, &cursor);
+        }
+        tempoCorpus += agoraSegundos() - inicio;
+
+        GeradorPecas gerador;
+        inicializarGeradorPecas(&gerador, (uint64_t)s);
+        inicio = agoraSegundos();
+        long indice = 0;
+        reabastecerFila(&fila, &gerador);
+        while (indice < quantidade) {
+            Peca peca = jogarPecaDaFila(&fila);
+            divergentes += peca.tipo != jogadas[indice].tipo || peca.id != jogadas[indice].id;
+            indice++;
+            reabastecerFila(&fila, &gerador);
+        }
+        tempoGerador += agoraSegundos() - inicio;
+        while (!filaVazia(&fila)) {
+            jogarPecaDaFila(&fila);
+        }
+        divergentes += quantidade != pecasPorSequencia;
+        pecas += quantidade;
+    }
+    printf("Reabastecimento: corpus %.1f ns/peca | gerador %.1f ns/peca (%ld pecas de %d sequencias)\n",
+           tempoCorpus * 1e9 / pecas, tempoGerador * 1e9 / pecas, pecas, conferidas);
+    printf("Primeiro acesso a uma sequencia sorteada: %.2f us\n", primeiroAcesso);
+    printf("Pecas divergentes: %ld\n", divergentes);
+
+    free(jogadas);
+    liberarFila(&fila);
+    fecharCorpusSequencias(&corpus);
+    unlink(caminhoPequeno);
+    unlink(caminhoGrande);
+    return divergentes == 0 ? 0 : 1;
+}
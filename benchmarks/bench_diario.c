@@ -0,0 +1,208 @@
+/**
+ * @file bench_diario.c
+ * @brief Latência de registrar uma jogada: diário assíncrono x write() na thread do jogo
+ *
+ * Várias threads produzem eventos em ritmo de jogo e medem quanto cada
+ * registro custa para quem joga. Com o diário, o evento vai para o anel da
+ * thread e o escritor de fundo grava em blocos, com cada política de
+ * sincronização; na versão síncrona cada evento é um write() (e, na última
+ * linha, um fdatasync()) feito pela própria thread. Ao final confere que o
+ * arquivo tem exatamente os eventos aceitos, na ordem de cada sessão.
+ * Eventos descartados indicam que o ritmo pedido passou do que o escritor
+ * (ou o disco, com fdatasync) consegue acompanhar com anéis de
+ * CAPACIDADE_ANEL_DIARIO eventos.
+ *
+ * Compilação:
+ * @code
+ * gcc -O2 -pthread -o bench_diario benchmarks/bench_diario.c -lm
+ * ./bench_diario [threads] [eventosPorThread] [intervaloUs] [arquivo]
+ * @endcode
+ */
+
+#define TETRIS_SEM_MAIN
+#include "../tetris.c"
+#include "tempo_bench.h"
+
+/**
+ * @brief Parâmetros e resultados de uma thread produtora
+ */
+typedef struct {
+    pthread_t thread;
+    int sessao;
+    int eventos;
+    int intervaloUs;
+    DiarioJogadas* diarioPtr;       ///< NULL = write() síncrono em descritor
+    int descritor;
+    int sincronizar;                ///< fdatasync() após cada write() síncrono
+    uint64_t* latencias;
+    int aceitos;
+} Produtor;
+
+static void* produzirEventos(void* argumento) {
+    Produtor* p = argumento;
+    uint64_t proximo = agoraNanossegundos();
+    for (int i = 0; i < p->eventos; i++) {
+        while (agoraNanossegundos() < proximo) {
+        }
+        proximo += (uint64_t)p->intervaloUs * 1000ULL;
+
+        EventoDiario evento;
+        memset(&evento, 0, sizeof(evento));
+        evento.sessao = p->sessao;
+        evento.sequencia = (uint32_t)p->aceitos;
+        evento.pontuacaoTotal = i * 75;
+        evento.idPeca = i;
+        evento.acao = ACAO_HISTORICO_JOGAR_FILA;
+        evento.sentido = 1;
+        evento.tipoPeca = 'I';
+
+        uint64_t inicio = agoraNanossegundos();
+        evento.instanteNs = inicio;
+        int aceito;
+        if (p->diarioPtr != NULL) {
+            aceito = registrarEventoDiario(p->diarioPtr, &evento);
+        } else {
+            aceito = write(p->descritor, &evento, sizeof(evento)) == sizeof(evento);
+            if (p->sincronizar) {
+                fdatasync(p->descritor);
+            }
+        }
+        p->latencias[i] = agoraNanossegundos() - inicio;
+        p->aceitos += aceito;
+    }
+    return NULL;
+}
+
+static int compararLatencias(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Confere o arquivo: tamanho e sequência de cada sessão sem buracos
+ * @return 1 se o arquivo contém exatamente os eventos aceitos
+ */
+static int conferirArquivo(const char* caminho, const Produtor* produtores, int threads) {
+    FILE* arquivo = fopen(caminho, "rb");
+    if (arquivo == NULL) {
+        return 0;
+    }
+    uint32_t esperado[MAX_ANEIS_DIARIO] = {0};
+    EventoDiario evento;
+    int valido = 1;
+    while (fread(&evento, sizeof(evento), 1, arquivo) == 1) {
+        if (evento.sessao < 0 || evento.sessao >= threads || evento.sequencia != esperado[evento.sessao]++) {
+            valido = 0;
+        }
+    }
+    fclose(arquivo);
+    for (int t = 0; t < threads; t++) {
+        valido &= esperado[t] == (uint32_t)produtores[t].aceitos;
+    }
+    return valido;
+}
+
+/**
+ * @brief Executa uma configuração e imprime a linha de resultado
+ * @param politica Política do diário, ou -1 para write() síncrono
+ * @return 1 se nenhum evento aceito se perdeu
+ */
+static int medir(const char* nome, int politica, int sincronizar, int threads, int eventos, int intervaloUs,
+                 const char* caminho) {
+    unlink(caminho);
+    static DiarioJogadas diario;
+    int descritor = -1;
+    if (politica >= 0) {
+        if (!abrirDiario(&diario, caminho, (PoliticaSyncDiario)politica, 10)) {
+            return 0;
+        }
+    } else {
+        descritor = open(caminho, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        if (descritor < 0) {
+            perror(caminho);
+            return 0;
+        }
+    }
+
+    Produtor* produtores = calloc((size_t)threads, sizeof(Produtor));
+    uint64_t inicio = agoraNanossegundos();
+    for (int t = 0; t < threads; t++) {
+        produtores[t].sessao = t;
+        produtores[t].eventos = eventos;
+        produtores[t].intervaloUs = intervaloUs;
+        produtores[t].diarioPtr = politica >= 0 ? &diario : NULL;
+        produtores[t].descritor = descritor;
+        produtores[t].sincronizar = sincronizar;
+        produtores[t].latencias = malloc(sizeof(uint64_t) * (size_t)eventos);
+        pthread_create(&produtores[t].thread, NULL, produzirEventos, &produtores[t]);
+    }
+    for (int t = 0; t < threads; t++) {
+        pthread_join(produtores[t].thread, NULL);
+    }
+    double segundos = (agoraNanossegundos() - inicio) * 1e-9;
+
+    MetricasDiario metricas;
+    memset(&metricas, 0, sizeof(metricas));
+    if (politica >= 0) {
+        fecharDiario(&diario);
+        lerMetricasDiario(&diario, &metricas);
+    } else {
+        close(descritor);
+    }
+
+    long total = (long)threads * eventos;
+    uint64_t* todas = malloc(sizeof(uint64_t) * (size_t)total);
+    long aceitos = 0;
+    for (int t = 0; t < threads; t++) {
+        memcpy(&todas[(long)t * eventos], produtores[t].latencias, sizeof(uint64_t) * (size_t)eventos);
+        aceitos += produtores[t].aceitos;
+    }
+    qsort(todas, (size_t)total, sizeof(uint64_t), compararLatencias);
+    int valido = conferirArquivo(caminho, produtores, threads);
+    if (politica >= 0) {
+        valido &= metricas.eventosEscritos == (uint64_t)aceitos && metricas.eventosRegistrados == (uint64_t)aceitos;
+    }
+
+    printf("%-18s p50 %7.0f ns | p99 %8.0f ns | max %9.0f ns | %6.2f Meventos/s | descartados %ld",
+           nome, (double)todas[total / 2], (double)todas[total * 99 / 100], (double)todas[total - 1],
+           total / segundos / 1e6, total - aceitos);
+    if (politica >= 0) {
+        printf(" | %llu escritas (%.0f eventos/escrita, max %.2f ms) | %llu fdatasync (max %.2f ms) | fila max %llu",
+               (unsigned long long)metricas.escritas,
+               metricas.escritas ? (double)metricas.eventosEscritos / metricas.escritas : 0.0,
+               metricas.latenciaEscritaMaximaNs / 1e6, (unsigned long long)metricas.sincronizacoes,
+               metricas.latenciaSyncMaximaNs / 1e6, (unsigned long long)metricas.profundidadeMaxima);
+    }
+    printf("%s\n", valido ? "" : " | ARQUIVO DIVERGENTE");
+
+    for (int t = 0; t < threads; t++) {
+        free(produtores[t].latencias);
+    }
+    free(produtores);
+    free(todas);
+    unlink(caminho);
+    return valido;
+}
+
+int main(int argc, char* argv[]) {
+    int threads = argc > 1 ? atoi(argv[1]) : 2;
+    int eventos = argc > 2 ? atoi(argv[2]) : 100000;
+    int intervaloUs = argc > 3 ? atoi(argv[3]) : 10;
+    const char* caminho = argc > 4 ? argv[4] : "bench_diario.bin";
+    if (threads < 1 || threads > MAX_ANEIS_DIARIO) {
+        threads = 2;
+    }
+
+    printf("=== DIARIO DE JOGADAS ===\n");
+    printf("Threads: %d | eventos por thread: %d | um evento a cada %d us | evento: %zu bytes\n",
+           threads, eventos, intervaloUs, sizeof(EventoDiario));
+    int valido = 1;
+    valido &= medir("Assincrono nunca:", SYNC_DIARIO_NUNCA, 0, threads, eventos, intervaloUs, caminho);
+    valido &= medir("Assincrono grupo:", SYNC_DIARIO_GRUPO, 0, threads, eventos, intervaloUs, caminho);
+    valido &= medir("Assincrono sempre:", SYNC_DIARIO_SEMPRE, 0, threads, eventos, intervaloUs, caminho);
+    valido &= medir("write() sincrono:", -1, 0, threads, eventos, intervaloUs, caminho);
+    int eventosSync = eventos / 50 > 0 ? eventos / 50 : 1;
+    valido &= medir("write()+fdatasync:", -1, 1, threads, eventosSync, intervaloUs, caminho);
+    printf("(write()+fdatasync com %d eventos por thread)\n", eventosSync);
+    return valido ? 0 : 1;
+}
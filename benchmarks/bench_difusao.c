@@ -0,0 +1,242 @@
+/**
+ * @file bench_difusao.c
+ * @brief Sala competitiva: uma sequência difundida contra um gerador por jogador
+ *
+ * Mil jogadores recebem a mesma ordem de peças. Na linha de base, cada um
+ * tem o próprio GeradorPecas e uma FilaCircular com a prévia inteira; na
+ * sala, há uma SequenciaDifundida com um cursor por jogador, que consome
+ * com avancarCursorDifusao() e olha a prévia com espiarDifusao(). Os
+ * jogadores andam em ritmos diferentes. Compara tempo por peça e memória,
+ * e confere que cada jogador viu exatamente as mesmas peças nos dois casos.
+ * Depois repete a sala com o produtor e os jogadores em threads separadas,
+ * para exercitar a reciclagem de segmentos com leitores concorrentes.
+ *
+ * Compilação:
+ * @code
+ * gcc -O2 -pthread -o bench_difusao benchmarks/bench_difusao.c -lm
+ * ./bench_difusao [jogadores] [rodadas] [janela] [threads]
+ * @endcode
+ */
+
+#define TETRIS_SEM_MAIN
+#include "../tetris.c"
+#include "tempo_bench.h"
+
+#include <sched.h>
+
+#define SEMENTE_SALA 2024
+#define SEGMENTOS_CONCORRENTE 8     ///< Diretório pequeno: o produtor esbarra no mais atrasado
+
+/// Acumula uma peça na assinatura do que o jogador viu
+static inline uint64_t assinarPeca(uint64_t assinatura, Peca peca) {
+    return (assinatura ^ ((uint64_t)(unsigned char)peca.tipo << 32 | (uint32_t)peca.id)) * 0x100000001B3ULL;
+}
+
+/// O jogador joga nesta rodada? (ritmos de 50% a 100%, fixos por jogador)
+static inline int jogadorJoga(int jogador, int rodada) {
+    uint32_t x = (uint32_t)jogador * 2654435761u ^ (uint32_t)rodada * 2246822519u;
+    x ^= x >> 15;
+    x *= 2654435761u;
+    return (x >> 24) < 128u + (uint32_t)(jogador % 128);
+}
+
+/**
+ * @brief Jogadores de uma thread na sala concorrente
+ */
+typedef struct {
+    SequenciaDifundida* sequencia;
+    int primeiro, quantidade;
+    int pecasPorJogador;
+    int janela;
+    long divergentes;
+    _Atomic int* concluidas;
+} LeitoresDifusao;
+
+static void* lerDifusao(void* argumento) {
+    LeitoresDifusao* leitoresPtr = argumento;
+    int quantidade = leitoresPtr->quantidade;
+    GeradorPecas* esperados = malloc(sizeof(GeradorPecas) * (size_t)quantidade);
+    int* consumidas = calloc((size_t)quantidade, sizeof(int));
+    for (int j = 0; j < quantidade; j++) {
+        inicializarGeradorPecas(&esperados[j], SEMENTE_SALA);
+    }
+    int restantes = quantidade;
+    while (restantes > 0) {
+        int andou = 0;
+        for (int j = 0; j < quantidade; j++) {
+            int cursor = leitoresPtr->primeiro + j;
+            Peca peca;
+            if (consumidas[j] >= leitoresPtr->pecasPorJogador) {
+                continue;
+            }
+            // A prévia tem que estar intacta enquanto o cursor não passar dela
+            const Peca* ultimaPtr = espiarDifusao(leitoresPtr->sequencia, cursor, leitoresPtr->janela);
+            if (ultimaPtr != NULL && ultimaPtr->id != consumidas[j] + 1 + leitoresPtr->janela) {
+                leitoresPtr->divergentes++;
+            }
+            if (!avancarCursorDifusao(leitoresPtr->sequencia, cursor, &peca)) {
+                continue;
+            }
+            char tipo = sortearTipoPeca(&esperados[j]);
+            leitoresPtr->divergentes += peca.tipo != tipo || peca.id != esperados[j].proximoId++;
+            andou = 1;
+            if (++consumidas[j] == leitoresPtr->pecasPorJogador) {
+                removerCursorDifusao(leitoresPtr->sequencia, cursor);
+                restantes--;
+            }
+        }
+        if (!andou) {
+            sched_yield();
+        }
+    }
+    atomic_fetch_add(leitoresPtr->concluidas, 1);
+    free(esperados);
+    free(consumidas);
+    return NULL;
+}
+
+int main(int argc, char* argv[]) {
+    int jogadores = argc > 1 ? atoi(argv[1]) : 1000;
+    int rodadas = argc > 2 ? atoi(argv[2]) : 5000;
+    int janela = argc > 3 ? atoi(argv[3]) : 32;
+    int numeroThreads = argc > 4 ? atoi(argv[4]) : 4;
+    if (jogadores < 1 || rodadas < 1 || janela < 0 || janela >= CAPACIDADE_MAXIMA_FILA || numeroThreads < 1) {
+        fprintf(stderr, "Parametros invalidos\n");
+        return 1;
+    }
+    printf("=== SEQUENCIA DIFUNDIDA ===\n");
+    printf("Jogadores: %d | rodadas: %d | previa: %d pecas\n", jogadores, rodadas, janela);
+
+    // Linha de base: um gerador e uma fila (peça atual + prévia) por jogador
+    FilaCircular* filas = malloc(sizeof(FilaCircular) * (size_t)jogadores);
+    GeradorPecas* geradores = malloc(sizeof(GeradorPecas) * (size_t)jogadores);
+    uint64_t* assinaturasBase = calloc((size_t)jogadores, sizeof(uint64_t));
+    long pecasBase = 0;
+    size_t memoriaBase = (sizeof(FilaCircular) + sizeof(GeradorPecas)) * (size_t)jogadores;
+    double inicio = agoraSegundos();
+    for (int j = 0; j < jogadores; j++) {
+        inicializarFila(&filas[j]);
+        configurarCapacidadeFila(&filas[j], janela + 1);
+        inicializarGeradorPecas(&geradores[j], SEMENTE_SALA);
+        reabastecerFila(&filas[j], &geradores[j]);
+    }
+    uint64_t somaPrevia = 0;
+    for (int rodada = 0; rodada < rodadas; rodada++) {
+        for (int j = 0; j < jogadores; j++) {
+            if (jogadorJoga(j, rodada)) {
+                somaPrevia += (unsigned char)espiarFila(&filas[j], janela)->tipo;
+                assinaturasBase[j] = assinarPeca(assinaturasBase[j], jogarPecaDaFila(&filas[j]));
+                reabastecerFila(&filas[j], &geradores[j]);
+                pecasBase++;
+            }
+        }
+    }
+    double tempoBase = agoraSegundos() - inicio;
+    for (int j = 0; j < jogadores; j++) {
+        // Diretório e segmentos criados ao crescer (um bloco só: a capacidade é configurada uma vez)
+        if (filas[j].diretorio != NULL) {
+            size_t novos = (size_t)(filas[j].tamanhoDiretorio - SEGMENTOS_EMBUTIDOS_FILA);
+            memoriaBase += sizeof(Peca*) * (size_t)filas[j].tamanhoDiretorio +
+                           sizeof(Peca) * (novos * PECAS_POR_SEGMENTO_FILA + 1);
+        }
+        liberarFila(&filas[j]);
+    }
+
+    // Sala: uma sequência, um cursor por jogador; o diretório cobre a maior distância possível
+    static SequenciaDifundida sala;
+    if (!iniciarSequenciaDifundida(&sala, SEMENTE_SALA, jogadores, (rodadas + janela) / PECAS_POR_SEGMENTO_DIFUSAO + 2)) {
+        fprintf(stderr, "Sem memoria para a sala\n");
+        return 1;
+    }
+    uint64_t* assinaturasSala = calloc((size_t)jogadores, sizeof(uint64_t));
+    long pecasSala = 0, esperas = 0;
+    uint64_t somaPreviaSala = 0;
+    inicio = agoraSegundos();
+    for (int j = 0; j < jogadores; j++) {
+        registrarCursorDifusao(&sala, janela);
+    }
+    for (int rodada = 0; rodada < rodadas; rodada++) {
+        produzirSequenciaDifundida(&sala);
+        for (int j = 0; j < jogadores; j++) {
+            if (jogadorJoga(j, rodada)) {
+                Peca peca;
+                const Peca* previaPtr = espiarDifusao(&sala, j, janela);
+                if (previaPtr == NULL || !avancarCursorDifusao(&sala, j, &peca)) {
+                    esperas++;      // Produtor parado pelo jogador mais atrasado
+                    continue;
+                }
+                somaPreviaSala += (unsigned char)previaPtr->tipo;
+                assinaturasSala[j] = assinarPeca(assinaturasSala[j], peca);
+                pecasSala++;
+            }
+        }
+    }
+    double tempoSala = agoraSegundos() - inicio;
+    size_t memoriaSala = sizeof(SequenciaDifundida) + sizeof(CursorDifusao) * (size_t)jogadores +
+                         sizeof(SegmentoDifusao*) * (size_t)sala.capacidadeDiretorio +
+                         sizeof(SegmentoDifusao) * (size_t)sala.picoSegmentos;
+
+    long divergentes = pecasSala != pecasBase || somaPreviaSala != somaPrevia || esperas != 0;
+    for (int j = 0; j < jogadores; j++) {
+        divergentes += assinaturasSala[j] != assinaturasBase[j];
+    }
+    printf("Gerador por jogador: %.1f ns/peca | %.1f KB (%.0f bytes por jogador)\n", tempoBase * 1e9 / pecasBase,
+           memoriaBase / 1e3, (double)memoriaBase / jogadores);
+    printf("Sequencia difundida: %.1f ns/peca | %.1f KB (%.0f bytes por jogador) | pico de %d segmentos, "
+           "%llu reciclados, %d malloc\n", tempoSala * 1e9 / pecasSala, memoriaSala / 1e3,
+           (double)memoriaSala / jogadores, sala.picoSegmentos, (unsigned long long)sala.segmentosReciclados,
+           sala.segmentosAlocados);
+    printf("Pecas sorteadas: %lu com geradores | %llu na sala\n", (unsigned long)(pecasBase + (long)jogadores * (janela + 1)),
+           (unsigned long long)atomic_load(&sala.publicadas));
+    liberarSequenciaDifundida(&sala);
+
+    // Sala concorrente: produtor nesta thread, jogadores em outras
+    int pecasPorJogador = rodadas;
+    if (!iniciarSequenciaDifundida(&sala, SEMENTE_SALA, jogadores, SEGMENTOS_CONCORRENTE)) {
+        return 1;
+    }
+    for (int j = 0; j < jogadores; j++) {
+        registrarCursorDifusao(&sala, janela);
+    }
+    pthread_t* threads = malloc(sizeof(pthread_t) * (size_t)numeroThreads);
+    LeitoresDifusao* leitores = calloc((size_t)numeroThreads, sizeof(LeitoresDifusao));
+    _Atomic int concluidas = 0;
+    inicio = agoraSegundos();
+    for (int t = 0; t < numeroThreads; t++) {
+        leitores[t].sequencia = &sala;
+        leitores[t].primeiro = jogadores * t / numeroThreads;
+        leitores[t].quantidade = jogadores * (t + 1) / numeroThreads - leitores[t].primeiro;
+        leitores[t].pecasPorJogador = pecasPorJogador;
+        leitores[t].janela = janela;
+        leitores[t].concluidas = &concluidas;
+        pthread_create(&threads[t], NULL, lerDifusao, &leitores[t]);
+    }
+    long producoes = 0;
+    while (atomic_load(&concluidas) < numeroThreads) {
+        uint64_t antes = atomic_load_explicit(&sala.publicadas, memory_order_relaxed);
+        if (produzirSequenciaDifundida(&sala) == antes) {
+            sched_yield();
+        }
+        producoes++;
+    }
+    long divergentesConcorrentes = 0;
+    for (int t = 0; t < numeroThreads; t++) {
+        pthread_join(threads[t], NULL);
+        divergentesConcorrentes += leitores[t].divergentes;
+    }
+    double tempoConcorrente = agoraSegundos() - inicio;
+    printf("Concorrente (%d threads): %.1f ns/peca | pico de %d segmentos de %d | %llu reciclados | %ld producoes\n",
+           numeroThreads, tempoConcorrente * 1e9 / ((double)pecasPorJogador * jogadores), sala.picoSegmentos,
+           sala.capacidadeDiretorio, (unsigned long long)sala.segmentosReciclados, producoes);
+    liberarSequenciaDifundida(&sala);
+
+    divergentes += divergentesConcorrentes;
+    printf("Pecas divergentes: %ld\n", divergentes);
+    free(threads);
+    free(leitores);
+    free(filas);
+    free(geradores);
+    free(assinaturasBase);
+    free(assinaturasSala);
+    return divergentes == 0 ? 0 : 1;
+}
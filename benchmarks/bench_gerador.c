@@ -0,0 +1,320 @@
+/**
+ * @file bench_gerador.c
+ * @brief Geradores de peças: vazão e qualidade da distribuição
+ *
+ * Compara os sorteios de peças do projeto: tipos[rand() % 7] do menu,
+ * tipos[rand() % 4] do tetris_simple.c (I, O, T e L) e o GeradorPecas nos
+ * modos uniforme e saco de 7. Primeiro mede peças por segundo com todas as
+ * threads sorteando ao mesmo tempo (rand() divide um só estado, protegido
+ * por trava na glibc; cada GeradorPecas é da sua thread). Depois, em outra
+ * passagem, mede a qualidade: qui-quadrado das frequências, dos pares e
+ * das trincas de tipos, secas de I (peças entre dois I seguidos), a matriz
+ * de transição P(próximo | anterior) e como o detectarCombo() com os
+ * padrões padrão (três peças iguais) distribui combos e multiplicadores.
+ * Falha se o saco de 7 quebrar a garantia de seca máxima de 12 peças ou
+ * produzir três peças iguais seguidas.
+ *
+ * Compilação:
+ * @code
+ * gcc -O2 -pthread -o bench_gerador benchmarks/bench_gerador.c -lm
+ * ./bench_gerador [pecasVazao] [pecasQualidade] [threads]
+ * ./bench_gerador 4000000000 400000000     # bilhões de peças
+ * @endcode
+ */
+
+#define TETRIS_SEM_MAIN
+#include "../tetris.c"
+#include "tempo_bench.h"
+
+#define MAX_THREADS_GERADOR 256
+#define MAIOR_SECA_CONTADA 64       ///< Secas maiores caem no último balde
+#define MAIOR_COMBO_CONTADO 16
+
+typedef enum {
+    SORTEIO_RAND_7,
+    SORTEIO_RAND_4,
+    SORTEIO_UNIFORME,
+    SORTEIO_SACO_7,
+    QUANTIDADE_SORTEIOS
+} Sorteio;
+
+static const char* NOMES_SORTEIO[QUANTIDADE_SORTEIOS] = {"rand() % 7", "rand() % 4", "uniforme", "saco7"};
+static const int TIPOS_SORTEIO[QUANTIDADE_SORTEIOS] = {7, 4, 7, 7};
+static const char TIPOS_SETE[NUMERO_TIPOS_PECA] = {'I', 'O', 'T', 'S', 'Z', 'J', 'L'};
+static const char TIPOS_SIMPLES[4] = {'I', 'O', 'T', 'L'};
+
+/**
+ * @brief Contadores de uma thread na passagem de qualidade
+ */
+typedef struct {
+    long long pecas;
+    long long frequencias[NUMERO_TIPOS_PECA];
+    long long pares[NUMERO_TIPOS_PECA][NUMERO_TIPOS_PECA];
+    long long trincas[NUMERO_TIPOS_PECA][NUMERO_TIPOS_PECA][NUMERO_TIPOS_PECA];
+    long long secas[MAIOR_SECA_CONTADA + 1];
+    long long maiorSeca;
+    long long pecasEmCombo;                      ///< Peças com multiplicador > 1
+    long long sequenciasCombo[MAIOR_COMBO_CONTADO + 1];   ///< Por comprimento (último balde: maiores)
+    int maiorCombo;
+    double somaMultiplicadores;
+} QualidadeSorteio;
+
+typedef struct {
+    Sorteio sorteio;
+    int indice;
+    long long pecas;
+    uint64_t soma;              ///< Só para o compilador não descartar o sorteio
+    QualidadeSorteio* qualidade;
+} TrabalhoGerador;
+
+/// Índice 0..6 do tipo no sorteio (a ordem de TIPOS_SIMPLES para rand() % 4)
+static inline int sortearIndice(Sorteio sorteio, GeradorPecas* geradorPtr) {
+    switch (sorteio) {
+        case SORTEIO_RAND_7:
+            return rand() % 7;
+        case SORTEIO_RAND_4:
+            return rand() % 4;
+        default:
+            return indiceTipoPeca(sortearTipoPeca(geradorPtr));
+    }
+}
+
+static void* sortearVazao(void* argumento) {
+    TrabalhoGerador* trabalhoPtr = argumento;
+    GeradorPecas gerador;
+    inicializarGeradorPecasModo(&gerador, (uint64_t)trabalhoPtr->indice,
+                                trabalhoPtr->sorteio == SORTEIO_SACO_7 ? GERADOR_SACO_7 : GERADOR_UNIFORME);
+    uint64_t soma = 0;
+    for (long long i = 0; i < trabalhoPtr->pecas; i++) {
+        soma += (uint64_t)sortearIndice(trabalhoPtr->sorteio, &gerador);
+    }
+    trabalhoPtr->soma = soma;
+    return NULL;
+}
+
+static void* sortearQualidade(void* argumento) {
+    TrabalhoGerador* trabalhoPtr = argumento;
+    QualidadeSorteio* q = trabalhoPtr->qualidade;
+    GeradorPecas gerador;
+    inicializarGeradorPecasModo(&gerador, (uint64_t)trabalhoPtr->indice + 1000,
+                                trabalhoPtr->sorteio == SORTEIO_SACO_7 ? GERADOR_SACO_7 : GERADOR_UNIFORME);
+    SistemaExpert sistema;
+    inicializarSistemaExpert(&sistema);
+    int anterior = -1, penultimo = -1, combo = 0;
+    long long seca = 0;
+    for (long long i = 0; i < trabalhoPtr->pecas; i++) {
+        int indice = sortearIndice(trabalhoPtr->sorteio, &gerador);
+        char tipo = trabalhoPtr->sorteio == SORTEIO_RAND_4 ? TIPOS_SIMPLES[indice] : TIPOS_SETE[indice];
+        q->frequencias[indice]++;
+        if (anterior >= 0) {
+            q->pares[anterior][indice]++;
+            if (penultimo >= 0) {
+                q->trincas[penultimo][anterior][indice]++;
+            }
+        }
+        penultimo = anterior;
+        anterior = indice;
+
+        if (tipo == 'I') {
+            q->secas[seca < MAIOR_SECA_CONTADA ? seca : MAIOR_SECA_CONTADA]++;
+            seca = 0;
+        } else if (++seca > q->maiorSeca) {
+            q->maiorSeca = seca;
+        }
+
+        double multiplicador = detectarCombo(&sistema, tipo);
+        q->somaMultiplicadores += multiplicador;
+        if (sistema.comboAtual > 0) {
+            q->pecasEmCombo++;
+            combo = sistema.comboAtual;
+        } else if (combo > 0) {
+            q->sequenciasCombo[combo < MAIOR_COMBO_CONTADO ? combo : MAIOR_COMBO_CONTADO]++;
+            combo = 0;
+        }
+    }
+    q->maiorCombo = sistema.melhorCombo;
+    q->pecas = trabalhoPtr->pecas;
+    return NULL;
+}
+
+/// Roda a função em todas as threads, com as peças repartidas; devolve o tempo de parede
+static double executarThreads(void* (*funcao)(void*), TrabalhoGerador* trabalhos, int numeroThreads,
+                              Sorteio sorteio, long long pecas, QualidadeSorteio* qualidades) {
+    pthread_t threads[MAX_THREADS_GERADOR];
+    for (int t = 0; t < numeroThreads; t++) {
+        trabalhos[t].sorteio = sorteio;
+        trabalhos[t].indice = t;
+        trabalhos[t].pecas = pecas / numeroThreads + (t < pecas % numeroThreads);
+        trabalhos[t].qualidade = qualidades != NULL ? &qualidades[t] : NULL;
+    }
+    double inicio = agoraSegundos();
+    for (int t = 1; t < numeroThreads; t++) {
+        pthread_create(&threads[t], NULL, funcao, &trabalhos[t]);
+    }
+    funcao(&trabalhos[0]);
+    for (int t = 1; t < numeroThreads; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    return agoraSegundos() - inicio;
+}
+
+/// Qui-quadrado contra a distribuição uniforme nas células
+static double quiQuadrado(const long long* contagens, int celulas) {
+    long long total = 0;
+    for (int i = 0; i < celulas; i++) {
+        total += contagens[i];
+    }
+    double esperado = (double)total / celulas, soma = 0.0;
+    for (int i = 0; i < celulas; i++) {
+        soma += (contagens[i] - esperado) * (contagens[i] - esperado) / esperado;
+    }
+    return soma;
+}
+
+/// Valor crítico a 5% da qui-quadrado (aproximação de Wilson-Hilferty)
+static double criticoQuiQuadrado(int graus) {
+    double a = 2.0 / (9.0 * graus);
+    double b = 1.0 - a + 1.6449 * sqrt(a);
+    return graus * b * b * b;
+}
+
+/// Soma os contadores das threads em q
+static void somarQualidades(const QualidadeSorteio* qualidades, int numeroThreads, QualidadeSorteio* q) {
+    memset(q, 0, sizeof(*q));
+    for (int t = 0; t < numeroThreads; t++) {
+        const QualidadeSorteio* p = &qualidades[t];
+        q->pecas += p->pecas;
+        for (int a = 0; a < NUMERO_TIPOS_PECA; a++) {
+            q->frequencias[a] += p->frequencias[a];
+            for (int b = 0; b < NUMERO_TIPOS_PECA; b++) {
+                q->pares[a][b] += p->pares[a][b];
+                for (int c = 0; c < NUMERO_TIPOS_PECA; c++) {
+                    q->trincas[a][b][c] += p->trincas[a][b][c];
+                }
+            }
+        }
+        for (int s = 0; s <= MAIOR_SECA_CONTADA; s++) {
+            q->secas[s] += p->secas[s];
+        }
+        q->maiorSeca = p->maiorSeca > q->maiorSeca ? p->maiorSeca : q->maiorSeca;
+        q->pecasEmCombo += p->pecasEmCombo;
+        for (int c = 0; c <= MAIOR_COMBO_CONTADO; c++) {
+            q->sequenciasCombo[c] += p->sequenciasCombo[c];
+        }
+        q->maiorCombo = p->maiorCombo > q->maiorCombo ? p->maiorCombo : q->maiorCombo;
+        q->somaMultiplicadores += p->somaMultiplicadores;
+    }
+}
+
+/// Imprime a qualidade de um sorteio; devolve 1 se o saco de 7 violou a garantia
+static int exibirQualidade(Sorteio sorteio, const QualidadeSorteio* q) {
+    int k = TIPOS_SORTEIO[sorteio];
+    long long frequencias[NUMERO_TIPOS_PECA], pares[NUMERO_TIPOS_PECA * NUMERO_TIPOS_PECA];
+    long long trincas[NUMERO_TIPOS_PECA * NUMERO_TIPOS_PECA * NUMERO_TIPOS_PECA];
+    long long trincasIguais = 0;
+    int n = 0;
+    for (int a = 0; a < k; a++) {
+        frequencias[a] = q->frequencias[a];
+        trincasIguais += q->trincas[a][a][a];
+        for (int b = 0; b < k; b++) {
+            pares[a * k + b] = q->pares[a][b];
+            for (int c = 0; c < k; c++) {
+                trincas[n++] = q->trincas[a][b][c];
+            }
+        }
+    }
+    int grausTipos = k - 1, grausPares = k * k - 1, grausTrincas = k * k * k - 1;
+    printf("\n--- %s: %lld pecas ---\n", NOMES_SORTEIO[sorteio], q->pecas);
+    printf("Qui-quadrado (critico a 5%%): tipos %.1f (%.1f, %d gl) | pares %.1f (%.1f) | trincas %.1f (%.1f)\n",
+           quiQuadrado(frequencias, k), criticoQuiQuadrado(grausTipos), grausTipos, quiQuadrado(pares, k * k),
+           criticoQuiQuadrado(grausPares), quiQuadrado(trincas, k * k * k), criticoQuiQuadrado(grausTrincas));
+
+    long long totalSecas = 0, somaSecas = 0, p99 = 0, acumulado = 0;
+    for (int s = 0; s <= MAIOR_SECA_CONTADA; s++) {
+        totalSecas += q->secas[s];
+        somaSecas += q->secas[s] * s;
+    }
+    for (int s = 0; s <= MAIOR_SECA_CONTADA && acumulado < totalSecas * 0.99; s++) {
+        acumulado += q->secas[s];
+        p99 = s;
+    }
+    printf("Seca de I: media %.2f | p99 %lld | maxima %lld pecas | trincas iguais %lld\n",
+           totalSecas > 0 ? (double)somaSecas / totalSecas : 0.0, p99, q->maiorSeca, trincasIguais);
+
+    printf("Transicoes P(proximo | anterior) x %d:\n       ", k);
+    for (int b = 0; b < k; b++) {
+        printf("  %c   ", sorteio == SORTEIO_RAND_4 ? TIPOS_SIMPLES[b] : TIPOS_SETE[b]);
+    }
+    printf("\n");
+    for (int a = 0; a < k; a++) {
+        long long linha = 0;
+        for (int b = 0; b < k; b++) {
+            linha += q->pares[a][b];
+        }
+        printf("     %c ", sorteio == SORTEIO_RAND_4 ? TIPOS_SIMPLES[a] : TIPOS_SETE[a]);
+        for (int b = 0; b < k; b++) {
+            printf(" %5.3f", linha > 0 ? (double)q->pares[a][b] * k / linha : 0.0);
+        }
+        printf("\n");
+    }
+
+    long long totalCombos = 0;
+    for (int c = 1; c <= MAIOR_COMBO_CONTADO; c++) {
+        totalCombos += q->sequenciasCombo[c];
+    }
+    printf("Combos: %.3f%% das pecas em combo | %lld sequencias | maior %d | multiplicador medio %.5f\n",
+           q->pecas > 0 ? 100.0 * q->pecasEmCombo / q->pecas : 0.0, totalCombos, q->maiorCombo,
+           q->pecas > 0 ? q->somaMultiplicadores / q->pecas : 0.0);
+    printf("Comprimento das sequencias:");
+    for (int c = 1; c <= MAIOR_COMBO_CONTADO; c++) {
+        if (q->sequenciasCombo[c] > 0) {
+            printf(" %d%s: %.2f%%", c, c == MAIOR_COMBO_CONTADO ? "+" : "",
+                   100.0 * q->sequenciasCombo[c] / totalCombos);
+        }
+    }
+    printf("%s\n", totalCombos == 0 ? " nenhuma" : "");
+    return sorteio == SORTEIO_SACO_7 && (q->maiorSeca > 2 * NUMERO_TIPOS_PECA - 2 || trincasIguais > 0);
+}
+
+int main(int argc, char* argv[]) {
+    long long pecasVazao = argc > 1 ? atoll(argv[1]) : 500000000LL;
+    long long pecasQualidade = argc > 2 ? atoll(argv[2]) : 50000000LL;
+    int numeroThreads = argc > 3 ? atoi(argv[3]) : (int)sysconf(_SC_NPROCESSORS_ONLN);
+    numeroThreads = numeroThreads < 1 ? 1 : numeroThreads > MAX_THREADS_GERADOR ? MAX_THREADS_GERADOR : numeroThreads;
+    saidaSilenciosa = 1;
+    srand(1);
+
+    TrabalhoGerador* trabalhos = calloc((size_t)numeroThreads, sizeof(TrabalhoGerador));
+    QualidadeSorteio* qualidades = calloc((size_t)numeroThreads, sizeof(QualidadeSorteio));
+    if (trabalhos == NULL || qualidades == NULL) {
+        return 1;
+    }
+
+    printf("=== GERADORES DE PECAS ===\n");
+    printf("Vazao: %lld pecas por gerador | qualidade: %lld pecas | %d threads\n", pecasVazao, pecasQualidade,
+           numeroThreads);
+    for (int s = 0; s < QUANTIDADE_SORTEIOS; s++) {
+        double segundos = executarThreads(sortearVazao, trabalhos, numeroThreads, (Sorteio)s, pecasVazao, NULL);
+        uint64_t soma = 0;
+        for (int t = 0; t < numeroThreads; t++) {
+            soma += trabalhos[t].soma;
+        }
+        printf("%-11s %8.1f milhoes de pecas/s | %6.2f ns/peca por thread | media do indice %.4f\n",
+               NOMES_SORTEIO[s], pecasVazao / segundos / 1e6, segundos * numeroThreads * 1e9 / pecasVazao,
+               (double)soma / pecasVazao);
+    }
+
+    int violacoes = 0;
+    for (int s = 0; s < QUANTIDADE_SORTEIOS; s++) {
+        memset(qualidades, 0, sizeof(QualidadeSorteio) * (size_t)numeroThreads);
+        executarThreads(sortearQualidade, trabalhos, numeroThreads, (Sorteio)s, pecasQualidade, qualidades);
+        QualidadeSorteio total;
+        somarQualidades(qualidades, numeroThreads, &total);
+        violacoes += exibirQualidade((Sorteio)s, &total);
+    }
+
+    free(trabalhos);
+    free(qualidades);
+    printf("\nViolacoes do saco de 7: %d\n", violacoes);
+    return violacoes == 0 ? 0 : 1;
+}
@@ -0,0 +1,186 @@
+/**
+ * @file bench_historico.c
+ * @brief Desfazer/refazer: custo por ação e volta exata aos estados anteriores
+ *
+ * Cada rodada abre uma sessão com histórico e encaixe automático, sorteia
+ * capacidades de fila e reserva e o modo do gerador, e executa opções
+ * aleatórias do menu (jogadas, transferências, geração, otimização,
+ * desfazer e refazer) pelo mesmo retomarSessao() das sessões reais. Depois
+ * refaz o que estiver pendente, desfaz tudo e compara fila, reserva,
+ * Sistema Expert sincronizado, tabuleiro e conquistas byte a byte com o
+ * estado inicial; em seguida refaz tudo e compara com o estado final. O
+ * programa retorna 1 se alguma rodada divergir.
+ *
+ * Compilação:
+ * @code
+ * gcc -O2 -pthread -o bench_historico benchmarks/bench_historico.c -lm
+ * ./bench_historico [rodadas] [semente]
+ * @endcode
+ */
+
+#define TETRIS_SEM_MAIN
+#include "../tetris.c"
+#include "tempo_bench.h"
+
+/**
+ * @brief Tudo o que desfazer e refazer precisam restaurar
+ */
+typedef struct {
+    int quantidadeFila;
+    int quantidadePilha;
+    char tiposFila[CAPACIDADE_MAXIMA_FILA];
+    int idsFila[CAPACIDADE_MAXIMA_FILA];
+    char tiposPilha[CAPACIDADE_MAXIMA_PILHA];
+    int idsPilha[CAPACIDADE_MAXIMA_PILHA];
+    SistemaExpert sistema;
+    Tabuleiro tabuleiro;
+    uint64_t conquistas[MAX_CONQUISTAS / 64];
+} EstadoComparado;
+
+static void capturarEstado(SessaoJogo* sessaoPtr, EstadoComparado* estadoPtr) {
+    memset(estadoPtr, 0, sizeof(*estadoPtr));
+    estadoPtr->quantidadeFila = sessaoPtr->fila.quantidadePecas;
+    for (int i = 0; i < estadoPtr->quantidadeFila; i++) {
+        estadoPtr->tiposFila[i] = espiarFila(&sessaoPtr->fila, i)->tipo;
+        estadoPtr->idsFila[i] = espiarFila(&sessaoPtr->fila, i)->id;
+    }
+    estadoPtr->quantidadePilha = sessaoPtr->pilha.quantidadeReservada;
+    for (int i = 0; i < estadoPtr->quantidadePilha; i++) {
+        estadoPtr->tiposPilha[i] = espiarPilha(&sessaoPtr->pilha, i)->tipo;
+        estadoPtr->idsPilha[i] = espiarPilha(&sessaoPtr->pilha, i)->id;
+    }
+    sincronizarSistemaExpert(&sessaoPtr->sistema);
+    memcpy(&estadoPtr->sistema, &sessaoPtr->sistema, sizeof(SistemaExpert));
+    memcpy(&estadoPtr->tabuleiro, &sessaoPtr->tabuleiro, sizeof(Tabuleiro));
+    memcpy(estadoPtr->conquistas, sessaoPtr->conquistas.desbloqueadas, sizeof(estadoPtr->conquistas));
+}
+
+/**
+ * @brief Compara com o estado guardado e diz qual parte divergiu
+ * @return NULL se o estado atual é idêntico
+ */
+static const char* compararEstado(SessaoJogo* sessaoPtr, const EstadoComparado* esperadoPtr) {
+    static EstadoComparado atual;
+    capturarEstado(sessaoPtr, &atual);
+    if (atual.quantidadeFila != esperadoPtr->quantidadeFila ||
+        memcmp(atual.tiposFila, esperadoPtr->tiposFila, sizeof(atual.tiposFila)) != 0 ||
+        memcmp(atual.idsFila, esperadoPtr->idsFila, sizeof(atual.idsFila)) != 0) {
+        return "fila";
+    }
+    if (atual.quantidadePilha != esperadoPtr->quantidadePilha ||
+        memcmp(atual.tiposPilha, esperadoPtr->tiposPilha, sizeof(atual.tiposPilha)) != 0 ||
+        memcmp(atual.idsPilha, esperadoPtr->idsPilha, sizeof(atual.idsPilha)) != 0) {
+        return "reserva";
+    }
+    if (memcmp(&atual.sistema, &esperadoPtr->sistema, sizeof(SistemaExpert)) != 0) {
+        return "Sistema Expert";
+    }
+    if (memcmp(&atual.tabuleiro, &esperadoPtr->tabuleiro, sizeof(Tabuleiro)) != 0) {
+        return "tabuleiro";
+    }
+    if (memcmp(atual.conquistas, esperadoPtr->conquistas, sizeof(atual.conquistas)) != 0) {
+        return "conquistas";
+    }
+    return NULL;
+}
+
+/**
+ * @brief Digita uma opção e o Enter que a sessão espera em seguida
+ */
+static void escolherOpcao(SessaoJogo* sessaoPtr, int opcao) {
+    char entrada[8];
+    snprintf(entrada, sizeof(entrada), "%d", opcao);
+    if (retomarSessao(sessaoPtr, entrada) == SESSAO_AGUARDA_ENTER) {
+        retomarSessao(sessaoPtr, "");
+    }
+}
+
+/**
+ * @brief Opção aleatória do menu, com peso maior para as jogadas
+ */
+static int sortearOpcao(GeradorPecas* sorteioPtr) {
+    static const int opcoes[] = {1, 1, 1, 1, 1, 1, 1, 2, 2, 3, 3, 3, 4, 4, 7, 9, 9, 9, 10, 10, 5, 6, 8};
+    int quantidade = (int)(sizeof(opcoes) / sizeof(opcoes[0]));
+    sortearTipoPeca(sorteioPtr);
+    return opcoes[(sorteioPtr->estado >> 33) % (uint64_t)quantidade];
+}
+
+int main(int argc, char* argv[]) {
+    int rodadas = argc > 1 ? atoi(argv[1]) : 2000;
+    uint64_t semente = argc > 2 ? strtoull(argv[2], NULL, 10) : 1;
+    if (rodadas < 1) {
+        fprintf(stderr, "Uso: %s [rodadas] [semente]\n", argv[0]);
+        return 2;
+    }
+    saidaSilenciosa = 1;
+    saidaJogo = fopen("/dev/null", "w");
+    if (saidaJogo == NULL) {
+        perror("/dev/null");
+        return 2;
+    }
+    encaixeAutomaticoMenu = 1;
+
+    static SessaoJogo sessao;
+    static HistoricoAcoes historico;
+    static EstadoComparado inicial, final;
+    GeradorPecas sorteio;
+    inicializarGeradorPecas(&sorteio, semente);
+
+    long long desfeitas = 0, refeitas = 0, opcoes = 0;
+    double tempoDesfazer = 0.0, tempoRefazer = 0.0;
+    int divergentes = 0;
+    for (int r = 0; r < rodadas; r++) {
+        iniciarSessao(&sessao, r, semente * 1000003u + (uint64_t)r, &historico);
+        sortearTipoPeca(&sorteio);
+        configurarCapacidadesSessao(&sessao, 1 + (int)(sorteio.estado >> 58), 1 + (int)((sorteio.estado >> 20) % 12));
+        sessao.gerador.modo = (uint8_t)(r % 2 == 0 ? GERADOR_UNIFORME : GERADOR_SACO_7);
+        retomarSessao(&sessao, NULL);
+        capturarEstado(&sessao, &inicial);
+
+        // Sem eviction no anel: no máximo uma ação registrada por opção
+        for (int i = 0; i < CAPACIDADE_HISTORICO; i++) {
+            escolherOpcao(&sessao, sortearOpcao(&sorteio));
+            opcoes++;
+            if (historico.aplicados == 0) {
+                capturarEstado(&sessao, &inicial); // Fim de partida esvazia o histórico
+            }
+        }
+        while (historico.aplicados < historico.registrados) {
+            escolherOpcao(&sessao, 10);
+        }
+        capturarEstado(&sessao, &final);
+
+        int acoes = historico.aplicados;
+        double inicio = agoraSegundos();
+        while (desfazerAcao(&historico, &sessao.fila, &sessao.pilha, &sessao.sistema, &sessao.conquistas,
+                            &sessao.tabuleiro) >= 0) {
+        }
+        tempoDesfazer += agoraSegundos() - inicio;
+        const char* parte = compararEstado(&sessao, &inicial);
+        if (parte == NULL) {
+            inicio = agoraSegundos();
+            while (refazerAcao(&historico, &sessao.fila, &sessao.pilha, &sessao.sistema, &sessao.conquistas,
+                               &sessao.tabuleiro) >= 0) {
+            }
+            tempoRefazer += agoraSegundos() - inicio;
+            parte = compararEstado(&sessao, &final);
+        }
+        if (parte != NULL && divergentes++ < 5) {
+            fprintf(stderr, "Rodada %d: %s diverge apos %d acoes\n", r, parte, acoes);
+        }
+        desfeitas += acoes;
+        refeitas += acoes;
+
+        liberarFila(&sessao.fila);
+        liberarPilha(&sessao.pilha);
+    }
+    fclose(saidaJogo);
+    saidaJogo = NULL;
+
+    printf("=== DESFAZER/REFAZER ===\n");
+    printf("Rodadas: %d | %lld opcoes do menu | delta de %zu bytes\n", rodadas, opcoes, sizeof(DeltaHistorico));
+    printf("Desfazer: %lld acoes | %.1f ns/acao\n", desfeitas, desfeitas > 0 ? tempoDesfazer * 1e9 / desfeitas : 0.0);
+    printf("Refazer:  %lld acoes | %.1f ns/acao\n", refeitas, refeitas > 0 ? tempoRefazer * 1e9 / refeitas : 0.0);
+    printf("Rodadas divergentes: %d\n", divergentes);
+    return divergentes == 0 ? 0 : 1;
+}
@@ -0,0 +1,290 @@
+/**
+ * @file bench_jogadas.c
+ * @brief Benchmark do gerador de jogadas sobre o tabuleiro em bitmask
+ *
+ * Gera um conjunto de tabuleiros de meio de partida (peças posicionadas ao
+ * acaso, com preferência pelas posições mais baixas) e mede o tempo médio
+ * por posição do gerarJogadas() para cada tipo de peça, além do
+ * gerarJogadasComReserva().
+ *
+ * Antes da medição, cada tabuleiro é conferido contra um caminho de
+ * referência célula a célula: uma busca em largura pelas posições da peça
+ * (esquerda, direita, baixo) a partir do surgimento, e um encaixe com
+ * remoção de linhas sobre uma grade de caracteres. As jogadas geradas e o
+ * tabuleiro resultante de aplicarJogada() precisam coincidir, e tipos fora
+ * da tabela precisam ser rejeitados. Retorna 1 se houver divergência.
+ *
+ * Compilação:
+ * @code
+ * gcc -O2 -pthread -o bench_jogadas benchmarks/bench_jogadas.c -lm
+ * ./bench_jogadas [numeroTabuleiros] [repeticoes]
+ * @endcode
+ */
+
+#define TETRIS_SEM_MAIN
+#include "../tetris.c"
+#include "tempo_bench.h"
+
+/// Grade de referência: uma célula por caractere, linha 0 na base
+typedef char GradeReferencia[ALTURA_TABULEIRO][LARGURA_TABULEIRO];
+
+/**
+ * @brief Expande o tabuleiro em bitmask para a grade de referência
+ */
+static void expandirGrade(const Tabuleiro* tabPtr, GradeReferencia grade) {
+    for (int y = 0; y < ALTURA_TABULEIRO; y++) {
+        for (int x = 0; x < LARGURA_TABULEIRO; x++) {
+            grade[y][x] = (char)((tabPtr->linhas[y] >> x) & 1);
+        }
+    }
+}
+
+/**
+ * @brief Indica se a forma cabe na grade com o canto inferior esquerdo em (x, y)
+ */
+static int cabeNaGrade(GradeReferencia grade, const FormaPeca* forma, int x, int y) {
+    for (int i = 0; i < forma->altura; i++) {
+        for (int b = 0; b < 4; b++) {
+            if (!(forma->linhas[i] & (1 << b))) {
+                continue;
+            }
+            int cx = x + b, cy = y + i;
+            if (cx < 0 || cx >= LARGURA_TABULEIRO || cy < 0 || cy >= ALTURA_TABULEIRO || grade[cy][cx]) {
+                return 0;
+            }
+        }
+    }
+    return 1;
+}
+
+/**
+ * @brief Gerador de referência: busca em largura célula a célula
+ * @return Número de jogadas escritas, na mesma ordem do gerarJogadas()
+ *         (rotação, linha do topo para a base, coluna crescente)
+ */
+static int gerarJogadasReferencia(const Tabuleiro* tabPtr, char tipoPeca, Jogada* saida) {
+    int indiceTipo = indiceTipoPeca(tipoPeca);
+    if (indiceTipo < 0) {
+        return 0;
+    }
+    GradeReferencia grade;
+    expandirGrade(tabPtr, grade);
+
+    int total = 0;
+    for (int rotacao = 0; rotacao < ROTACOES_DISTINTAS[indiceTipo]; rotacao++) {
+        const FormaPeca* forma = &FORMAS_PECA[indiceTipo][rotacao];
+        int xSurgimento = (LARGURA_TABULEIRO - forma->largura) / 2;
+        int ySurgimento = ALTURA_TABULEIRO - forma->altura;
+        if (!cabeNaGrade(grade, forma, xSurgimento, ySurgimento)) {
+            continue;
+        }
+
+        char visitado[ALTURA_TABULEIRO][LARGURA_TABULEIRO] = {{0}};
+        int filaX[ALTURA_TABULEIRO * LARGURA_TABULEIRO], filaY[ALTURA_TABULEIRO * LARGURA_TABULEIRO];
+        int inicio = 0, fim = 0;
+        visitado[ySurgimento][xSurgimento] = 1;
+        filaX[fim] = xSurgimento;
+        filaY[fim++] = ySurgimento;
+        while (inicio < fim) {
+            int x = filaX[inicio], y = filaY[inicio++];
+            static const int DX[3] = {-1, 1, 0}, DY[3] = {0, 0, -1};
+            for (int m = 0; m < 3; m++) {
+                int nx = x + DX[m], ny = y + DY[m];
+                if (nx >= 0 && ny >= 0 && nx < LARGURA_TABULEIRO && !visitado[ny][nx] &&
+                    cabeNaGrade(grade, forma, nx, ny)) {
+                    visitado[ny][nx] = 1;
+                    filaX[fim] = nx;
+                    filaY[fim++] = ny;
+                }
+            }
+        }
+
+        for (int y = ySurgimento; y >= 0; y--) {
+            for (int x = 0; x < LARGURA_TABULEIRO; x++) {
+                if (!visitado[y][x] || cabeNaGrade(grade, forma, x, y - 1)) {
+                    continue;
+                }
+                // Queda direta: alcançável deslizando no topo e descendo reto até y
+                int direta = 1;
+                for (int passo = x; passo != xSurgimento && direta; passo += passo < xSurgimento ? 1 : -1) {
+                    direta = cabeNaGrade(grade, forma, passo, ySurgimento);
+                }
+                for (int yy = ySurgimento; yy >= y && direta; yy--) {
+                    direta = cabeNaGrade(grade, forma, x, yy);
+                }
+                Jogada* jogada = &saida[total++];
+                jogada->tipo = tipoPeca;
+                jogada->rotacao = (unsigned char)rotacao;
+                jogada->coluna = (unsigned char)x;
+                jogada->linha = (unsigned char)y;
+                jogada->origem = 0;
+                jogada->viaDeslize = !direta;
+            }
+        }
+    }
+    return total;
+}
+
+/**
+ * @brief Encaixe de referência: marca as células e remove as linhas completas
+ * @return Número de linhas eliminadas
+ */
+static int aplicarJogadaReferencia(Tabuleiro* tabPtr, const Jogada* jogadaPtr) {
+    const FormaPeca* forma = &FORMAS_PECA[indiceTipoPeca(jogadaPtr->tipo)][jogadaPtr->rotacao];
+    GradeReferencia grade;
+    expandirGrade(tabPtr, grade);
+    for (int i = 0; i < forma->altura; i++) {
+        for (int b = 0; b < 4; b++) {
+            if (forma->linhas[i] & (1 << b)) {
+                grade[jogadaPtr->linha + i][jogadaPtr->coluna + b] = 1;
+            }
+        }
+    }
+
+    int eliminadas = 0;
+    limparTabuleiro(tabPtr);
+    for (int y = 0, destino = 0; y < ALTURA_TABULEIRO; y++) {
+        int ocupadas = 0;
+        for (int x = 0; x < LARGURA_TABULEIRO; x++) {
+            ocupadas += grade[y][x];
+        }
+        if (ocupadas == LARGURA_TABULEIRO) {
+            eliminadas++;
+            continue;
+        }
+        for (int x = 0; x < LARGURA_TABULEIRO; x++) {
+            if (grade[y][x]) {
+                tabPtr->linhas[destino] |= (uint16_t)(1u << x);
+            }
+        }
+        destino++;
+    }
+    return eliminadas;
+}
+
+/**
+ * @brief Confere gerarJogadas() e aplicarJogada() contra o caminho de referência
+ * @return Número de divergências encontradas no tabuleiro
+ */
+static int conferirTabuleiro(const Tabuleiro* tabPtr) {
+    static const char tipos[] = {'I', 'O', 'T', 'S', 'Z', 'J', 'L'};
+    Jogada jogadas[MAX_JOGADAS], referencia[MAX_JOGADAS];
+    int divergencias = 0;
+
+    for (int t = 0; t < 7; t++) {
+        int quantidade = gerarJogadas(tabPtr, tipos[t], 0, jogadas, MAX_JOGADAS);
+        int esperadas = gerarJogadasReferencia(tabPtr, tipos[t], referencia);
+        if (quantidade != esperadas) {
+            divergencias++;
+            continue;
+        }
+        for (int j = 0; j < quantidade; j++) {
+            if (jogadas[j].rotacao != referencia[j].rotacao || jogadas[j].coluna != referencia[j].coluna ||
+                jogadas[j].linha != referencia[j].linha || jogadas[j].viaDeslize != referencia[j].viaDeslize) {
+                divergencias++;
+                continue;
+            }
+            Tabuleiro obtido = *tabPtr, esperado = *tabPtr;
+            int linhas = aplicarJogada(&obtido, &jogadas[j]);
+            if (linhas != aplicarJogadaReferencia(&esperado, &jogadas[j]) ||
+                memcmp(&obtido, &esperado, sizeof(Tabuleiro)) != 0) {
+                divergencias++;
+            }
+        }
+    }
+
+    // Tipos fora da tabela: nenhuma jogada gerada e o tabuleiro intacto
+    Jogada invalida = {'X', 0, 0, 0, 0, 0};
+    Tabuleiro intacto = *tabPtr;
+    if (gerarJogadas(tabPtr, invalida.tipo, 0, jogadas, MAX_JOGADAS) != 0 ||
+        aplicarJogada(&intacto, &invalida) != -1 || memcmp(&intacto, tabPtr, sizeof(Tabuleiro)) != 0) {
+        divergencias++;
+    }
+    return divergencias;
+}
+
+/**
+ * @brief Monta um tabuleiro de meio de partida jogando peças em posições aleatórias
+ * @param tabPtr Tabuleiro de saída
+ * @param pecas Quantidade de peças a posicionar
+ */
+static void montarTabuleiroAleatorio(Tabuleiro* tabPtr, int pecas) {
+    static const char tipos[] = {'I', 'O', 'T', 'S', 'Z', 'J', 'L'};
+    Jogada jogadas[MAX_JOGADAS];
+
+    limparTabuleiro(tabPtr);
+    for (int i = 0; i < pecas; i++) {
+        int quantidade = gerarJogadas(tabPtr, tipos[rand() % 7], 0, jogadas, MAX_JOGADAS);
+        if (quantidade == 0) {
+            break;
+        }
+        // Prefere as posições mais baixas para imitar uma pilha de meio de partida
+        int escolhida = rand() % quantidade;
+        for (int tentativa = 0; tentativa < 3; tentativa++) {
+            int candidata = rand() % quantidade;
+            if (jogadas[candidata].linha < jogadas[escolhida].linha) {
+                escolhida = candidata;
+            }
+        }
+        aplicarJogada(tabPtr, &jogadas[escolhida]);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    int numeroTabuleiros = argc > 1 ? atoi(argv[1]) : 4096;
+    int repeticoes = argc > 2 ? atoi(argv[2]) : 50;
+    static const char tipos[] = {'I', 'O', 'T', 'S', 'Z', 'J', 'L'};
+
+    srand(12345);
+    Tabuleiro* tabuleiros = malloc(sizeof(Tabuleiro) * numeroTabuleiros);
+    for (int i = 0; i < numeroTabuleiros; i++) {
+        montarTabuleiroAleatorio(&tabuleiros[i], 10 + rand() % 30);
+    }
+
+    Jogada jogadas[MAX_JOGADAS];
+    long long totalJogadas = 0;
+
+    printf("=== BENCHMARK DO GERADOR DE JOGADAS ===\n");
+    printf("Tabuleiros: %d | Repeticoes: %d\n", numeroTabuleiros, repeticoes);
+
+    int divergencias = 0;
+    for (int i = 0; i < numeroTabuleiros; i++) {
+        divergencias += conferirTabuleiro(&tabuleiros[i]);
+    }
+    printf("Jogadas divergentes da referencia: %d\n", divergencias);
+    for (int t = 0; t < 7; t++) {
+        long long jogadasTipo = 0;
+        double inicio = agoraSegundos();
+        for (int r = 0; r < repeticoes; r++) {
+            for (int i = 0; i < numeroTabuleiros; i++) {
+                jogadasTipo += gerarJogadas(&tabuleiros[i], tipos[t], 0, jogadas, MAX_JOGADAS);
+            }
+        }
+        double decorrido = (agoraSegundos() - inicio) * 1e9;
+        double posicoes = (double)numeroTabuleiros * repeticoes;
+        printf("Peca %c: %7.1f ns/posicao | %5.1f jogadas/posicao\n",
+               tipos[t], decorrido / posicoes, jogadasTipo / posicoes);
+        totalJogadas += jogadasTipo;
+    }
+
+    // Peça atual + topo da reserva, como usado pelos bots
+    FilaCircular fila;
+    PilhaReserva pilha;
+    inicializarFila(&fila);
+    inicializarPilha(&pilha);
+    gerarPecasAleatorias(&fila);
+    reservarPeca(&pilha, criarPeca('T', 0));
+
+    double inicio = agoraSegundos();
+    for (int r = 0; r < repeticoes; r++) {
+        for (int i = 0; i < numeroTabuleiros; i++) {
+            totalJogadas += gerarJogadasComReserva(&tabuleiros[i], &fila, &pilha, jogadas, MAX_JOGADAS);
+        }
+    }
+    double decorrido = (agoraSegundos() - inicio) * 1e9;
+    printf("Fila + reserva: %7.1f ns/posicao\n", decorrido / ((double)numeroTabuleiros * repeticoes));
+    printf("Total de jogadas geradas: %lld\n", totalJogadas);
+
+    free(tabuleiros);
+    return divergencias == 0 ? 0 : 1;
+}
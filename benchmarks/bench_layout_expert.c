@@ -0,0 +1,263 @@
+/**
+ * @file bench_layout_expert.c
+ * @brief Faltas de cache por jogada: layout antigo x linha quente do SistemaExpert
+ *
+ * Mantém um milhão de sessões residentes e processa jogadas em sessões
+ * sorteadas, como um servidor com muitos jogadores ativos. A versão
+ * "antiga" reproduz o layout anterior (campos quentes e frios misturados,
+ * 120 bytes sem alinhamento) e a atualização de todos os campos derivados
+ * a cada jogada; a "nova" usa SistemaExpert e processarJogadaExpert().
+ * As duas devem chegar à mesma pontuação somada.
+ *
+ * As faltas de cache vêm de perf_event_open(); se os contadores de
+ * hardware não estiverem disponíveis, apenas o tempo é informado.
+ *
+ * Compilação:
+ * @code
+ * gcc -O2 -pthread -o bench_layout_expert benchmarks/bench_layout_expert.c -lm
+ * ./bench_layout_expert [sessoes] [jogadas]
+ * @endcode
+ */
+
+#define TETRIS_SEM_MAIN
+#include "../tetris.c"
+#include "tempo_bench.h"
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+/**
+ * @brief Layout do SistemaExpert antes da separação quente/frio
+ */
+typedef struct {
+    int pontuacaoTotal;
+    int pontuacaoNivel;
+    double multiplicadorAtual;
+    int pontosUltimaJogada;
+    int comboAtual;
+    int melhorCombo;
+    int totalCombos;
+    char ultimoTipoJogado;
+    int sequenciaTipoAtual;
+    int nivelAtual;
+    int pontosParaProximoNivel;
+    int limitePontosNivel;
+    double fatorDificuldade;
+    int totalJogadas;
+    int jogadasDaFila;
+    int jogadasDaPilha;
+    int pecasReservadas;
+    int eficienciaReserva;
+    int contagemTipoI;
+    int contagemTipoO;
+    int contagemTipoT;
+    int contagemTipoL;
+    char tipoMaisJogado;
+    int conquistasDesbloqueadas;
+    int marcosAlcancados;
+    int recordePessoal;
+} SistemaExpertAntigo;
+
+/**
+ * @brief processarJogadaExpert() como era antes: todos os campos a cada jogada
+ */
+static void processarJogadaAntiga(char tipo, int origem, SistemaExpertAntigo* s) {
+    int pontos = pontosPecaRegras(&REGRAS_PONTUACAO_EXPERT, tipo, s->multiplicadorAtual, s->fatorDificuldade);
+    if (s->ultimoTipoJogado == tipo) {
+        s->sequenciaTipoAtual++;
+        if (s->sequenciaTipoAtual >= 3) {
+            s->comboAtual = s->sequenciaTipoAtual - 2;
+            if (s->comboAtual > s->melhorCombo) {
+                s->melhorCombo = s->comboAtual;
+            }
+            pontos = (int)(pontos * (1.0 + s->comboAtual * 0.2));
+        }
+    } else {
+        s->sequenciaTipoAtual = 1;
+        s->comboAtual = 0;
+        s->ultimoTipoJogado = tipo;
+    }
+    s->pontuacaoTotal += pontos;
+    s->pontuacaoNivel += pontos;
+    if (s->pontuacaoTotal > s->recordePessoal) {
+        s->recordePessoal = s->pontuacaoTotal;
+    }
+    s->totalJogadas++;
+    if (origem == 0) {
+        s->jogadasDaFila++;
+    } else {
+        s->jogadasDaPilha++;
+    }
+    switch (tipo) {
+        case 'I': s->contagemTipoI++; break;
+        case 'O': s->contagemTipoO++; break;
+        case 'T': s->contagemTipoT++; break;
+        case 'L': s->contagemTipoL++; break;
+    }
+    int maxContagem = 0;
+    if (s->contagemTipoI > maxContagem) { maxContagem = s->contagemTipoI; s->tipoMaisJogado = 'I'; }
+    if (s->contagemTipoO > maxContagem) { maxContagem = s->contagemTipoO; s->tipoMaisJogado = 'O'; }
+    if (s->contagemTipoT > maxContagem) { maxContagem = s->contagemTipoT; s->tipoMaisJogado = 'T'; }
+    if (s->contagemTipoL > maxContagem) { s->tipoMaisJogado = 'L'; }
+    s->eficienciaReserva = (double)s->jogadasDaPilha / s->totalJogadas * 100.0;
+
+    if (s->pontuacaoTotal >= s->limitePontosNivel) {
+        s->nivelAtual++;
+        s->limitePontosNivel = (int)(1000 * pow(1.5, s->nivelAtual - 1));
+        if (s->fatorDificuldade < 3.0) {
+            s->fatorDificuldade += 0.2;
+        }
+        if (s->multiplicadorAtual < 10.0) {
+            s->multiplicadorAtual += 0.5;
+        }
+        s->marcosAlcancados++;
+    }
+    s->pontosParaProximoNivel = s->limitePontosNivel - s->pontuacaoTotal;
+    if (s->nivelAtual == 5) {
+        s->conquistasDesbloqueadas |= 1;
+    }
+    if (s->nivelAtual == 10) {
+        s->conquistasDesbloqueadas |= 2;
+    }
+}
+
+/**
+ * @brief Abre um contador de hardware para o processo (-1 se indisponível)
+ */
+static int abrirContador(uint32_t tipo, uint64_t configuracao) {
+    struct perf_event_attr atributos;
+    memset(&atributos, 0, sizeof(atributos));
+    atributos.size = sizeof(atributos);
+    atributos.type = tipo;
+    atributos.config = configuracao;
+    atributos.disabled = 1;
+    atributos.exclude_kernel = 1;
+    atributos.exclude_hv = 1;
+    return (int)syscall(SYS_perf_event_open, &atributos, 0, -1, -1, 0);
+}
+
+/**
+ * @brief Contadores de faltas (L1 de dados e último nível) de uma medição
+ */
+typedef struct {
+    int descritores[2];
+    long long faltas[2];
+} Contadores;
+
+static void iniciarContadores(Contadores* c) {
+    c->descritores[0] = abrirContador(PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D |
+                                      (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                      (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+    c->descritores[1] = abrirContador(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+    for (int i = 0; i < 2; i++) {
+        c->faltas[i] = -1;
+        if (c->descritores[i] >= 0) {
+            ioctl(c->descritores[i], PERF_EVENT_IOC_RESET, 0);
+            ioctl(c->descritores[i], PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+}
+
+static void pararContadores(Contadores* c) {
+    for (int i = 0; i < 2; i++) {
+        if (c->descritores[i] >= 0) {
+            ioctl(c->descritores[i], PERF_EVENT_IOC_DISABLE, 0);
+            if (read(c->descritores[i], &c->faltas[i], sizeof(c->faltas[i])) != sizeof(c->faltas[i])) {
+                c->faltas[i] = -1;
+            }
+            close(c->descritores[i]);
+        }
+    }
+}
+
+static void exibirMedicao(const char* nome, double segundos, const Contadores* c, long long jogadas) {
+    printf("%-7s %6.2f ns/jogada", nome, segundos / jogadas * 1e9);
+    const char* rotulos[2] = {"faltas L1d", "faltas LLC"};
+    for (int i = 0; i < 2; i++) {
+        if (c->faltas[i] >= 0) {
+            printf(" | %s: %.3f/jogada", rotulos[i], (double)c->faltas[i] / jogadas);
+        } else {
+            printf(" | %s: indisponivel", rotulos[i]);
+        }
+    }
+    printf("\n");
+}
+
+/// Sorteio da sessão, do tipo e da origem de cada jogada (mesma sequência nas duas versões)
+static inline uint64_t proximoSorteio(uint64_t* estado) {
+    uint64_t x = *estado;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *estado = x;
+    return x * 0x2545F4914F6CDD1DULL;
+}
+
+int main(int argc, char* argv[]) {
+    int sessoes = argc > 1 ? atoi(argv[1]) : 1000000;
+    long long jogadas = argc > 2 ? atoll(argv[2]) : 20000000;
+    static const char tipos[NUMERO_TIPOS_PECA] = {'I', 'O', 'T', 'S', 'Z', 'J', 'L'};
+    saidaSilenciosa = 1;
+
+    SistemaExpertAntigo* antigos = malloc(sizeof(SistemaExpertAntigo) * (size_t)sessoes);
+    SistemaExpert* novos = aligned_alloc(_Alignof(SistemaExpert), sizeof(SistemaExpert) * (size_t)sessoes);
+    for (int i = 0; i < sessoes; i++) {
+        memset(&antigos[i], 0, sizeof(antigos[i]));
+        antigos[i].multiplicadorAtual = 1.0;
+        antigos[i].fatorDificuldade = 1.0;
+        antigos[i].ultimoTipoJogado = 'X';
+        antigos[i].nivelAtual = 1;
+        antigos[i].pontosParaProximoNivel = 1000;
+        antigos[i].limitePontosNivel = 1000;
+        antigos[i].tipoMaisJogado = 'I';
+        memset(&novos[i], 0, sizeof(novos[i]));
+        inicializarSistemaExpert(&novos[i]);
+    }
+
+    Contadores contadores;
+    uint64_t sorteio = 0x9E3779B97F4A7C15ULL;
+    iniciarContadores(&contadores);
+    double inicio = agoraSegundos();
+    for (long long j = 0; j < jogadas; j++) {
+        uint64_t x = proximoSorteio(&sorteio);
+        processarJogadaAntiga(tipos[(x >> 8) % NUMERO_TIPOS_PECA], (x >> 4) % 4 == 0,
+                              &antigos[(x >> 32) % (uint64_t)sessoes]);
+    }
+    double tempoAntigo = agoraSegundos() - inicio;
+    pararContadores(&contadores);
+    Contadores contadoresAntigo = contadores;
+
+    sorteio = 0x9E3779B97F4A7C15ULL;
+    iniciarContadores(&contadores);
+    inicio = agoraSegundos();
+    for (long long j = 0; j < jogadas; j++) {
+        uint64_t x = proximoSorteio(&sorteio);
+        Peca peca = {tipos[(x >> 8) % NUMERO_TIPOS_PECA], 0};
+        processarJogadaExpert(peca, (x >> 4) % 4 == 0, &novos[(x >> 32) % (uint64_t)sessoes]);
+    }
+    double tempoNovo = agoraSegundos() - inicio;
+    pararContadores(&contadores);
+
+    long long somaAntiga = 0, somaNova = 0;
+    for (int i = 0; i < sessoes; i++) {
+        somaAntiga += antigos[i].pontuacaoTotal;
+        somaNova += novos[i].pontuacaoTotal;
+    }
+
+    printf("=== LAYOUT DO SISTEMA EXPERT ===\n");
+    printf("Sessoes residentes: %d (%.0f MB antigo, %.0f MB novo) | jogadas: %lld\n", sessoes,
+           sizeof(SistemaExpertAntigo) * (double)sessoes / 1e6, sizeof(SistemaExpert) * (double)sessoes / 1e6,
+           jogadas);
+    printf("sizeof: antigo %zu bytes | novo %zu bytes (quente: 64)\n",
+           sizeof(SistemaExpertAntigo), sizeof(SistemaExpert));
+    exibirMedicao("Antigo:", tempoAntigo, &contadoresAntigo, jogadas);
+    exibirMedicao("Novo:", tempoNovo, &contadores, jogadas);
+    printf("Aceleracao: %.2fx | pontuacao somada %s\n", tempoAntigo / tempoNovo,
+           somaAntiga == somaNova ? "identica" : "DIVERGENTE");
+
+    free(antigos);
+    free(novos);
+    return somaAntiga == somaNova ? 0 : 1;
+}
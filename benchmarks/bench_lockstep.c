@@ -0,0 +1,148 @@
+/**
+ * @file bench_lockstep.c
+ * @brief Vazão da simulação em lockstep comparada a uma partida por vez
+ *
+ * Roda a mesma política de self-play (rotação e coluna sorteadas no
+ * surgimento, queda de uma linha por passo) de duas formas: uma fila de
+ * partidas jogada em LANES_LOCKSTEP tabuleiros que avançam juntos em
+ * registradores vetoriais e as mesmas partidas jogadas uma por vez em
+ * código escalar com processarJogadaExpert(). Pontuação, nível, linhas,
+ * peças e melhor combo de cada partida são comparados entre as duas; o
+ * programa retorna 1 se alguma partida divergir.
+ *
+ * Compilação (use -march=native para AVX2/AVX-512 quando disponível):
+ * @code
+ * gcc -O2 -pthread -march=native -o bench_lockstep benchmarks/bench_lockstep.c -lm
+ * ./bench_lockstep [partidas] [repeticoes] [regras]
+ * @endcode
+ */
+
+#define TETRIS_SEM_MAIN
+#include "../tetris.c"
+#include "tempo_bench.h"
+
+/**
+ * @brief Mesma partida de uma lane, jogada de forma escalar
+ * @param semente Semente da partida
+ * @param regras Índice das regras de pontuação
+ * @param passosPtr Acumula os passos de gravidade
+ * @param resultadoPtr Recebe o resultado final da partida
+ */
+static void simularPartidaEscalar(uint64_t semente, int regras, long long* passosPtr, ResultadoLockstep* resultadoPtr) {
+    GeradorPecas gerador, politica;
+    SistemaExpert sistema;
+    Tabuleiro tabuleiro;
+    inicializarGeradorPecas(&gerador, semente);
+    inicializarPoliticaLockstep(&politica, semente);
+    inicializarSistemaExpert(&sistema);
+    definirRegrasPontuacao(&sistema, regras);
+    limparTabuleiro(&tabuleiro);
+
+    int pecas = 0, linhas = 0;
+    for (;;) {
+        char tipo = sortearTipoPeca(&gerador);
+        int indiceTipo = indiceTipoPeca(tipo);
+        int coluna;
+        int rotacao = sortearJogadaLockstep(&politica, indiceTipo, &coluna);
+        const FormaPeca* forma = &FORMAS_PECA[indiceTipo][rotacao];
+
+        Jogada jogada = {tipo, (unsigned char)rotacao, (unsigned char)coluna,
+                         (unsigned char)(ALTURA_TABULEIRO - forma->altura), 0, 0};
+        int surgiuLivre = 1;
+        for (int i = 0; i < forma->altura; i++) {
+            if (tabuleiro.linhas[jogada.linha + i] & (forma->linhas[i] << coluna)) {
+                surgiuLivre = 0;
+            }
+        }
+        if (!surgiuLivre) {
+            break;
+        }
+
+        // Queda de uma linha por passo até encostar
+        for (;;) {
+            (*passosPtr)++;
+            int colide = jogada.linha == 0;
+            for (int i = 0; i < forma->altura && !colide; i++) {
+                colide = (tabuleiro.linhas[jogada.linha - 1 + i] & (forma->linhas[i] << coluna)) != 0;
+            }
+            if (colide) {
+                break;
+            }
+            jogada.linha--;
+        }
+        linhas += aplicarJogada(&tabuleiro, &jogada);
+        processarJogadaExpert(criarPeca(tipo, pecas), 0, &sistema);
+        pecas++;
+    }
+    resultadoPtr->pontuacaoTotal = sistema.pontuacaoTotal;
+    resultadoPtr->nivelAtual = sistema.nivelAtual;
+    resultadoPtr->linhasEliminadas = linhas;
+    resultadoPtr->pecasJogadas = pecas;
+    resultadoPtr->melhorCombo = sistema.melhorCombo;
+}
+
+int main(int argc, char* argv[]) {
+    int partidas = argc > 1 ? atoi(argv[1]) : 32000;
+    int repeticoes = argc > 2 ? atoi(argv[2]) : 5;
+    int regras = argc > 3 ? buscarRegrasPontuacao(argv[3]) : REGRAS_EXPERT;
+    if (partidas < 1 || repeticoes < 1 || regras < 0) {
+        fprintf(stderr, "Uso: %s [partidas] [repeticoes] [regras]\n", argv[0]);
+        return 2;
+    }
+    saidaSilenciosa = 1;
+
+    ResultadoLockstep* lockstep = calloc((size_t)partidas, sizeof(ResultadoLockstep));
+    ResultadoLockstep* escalar = calloc((size_t)partidas, sizeof(ResultadoLockstep));
+    if (lockstep == NULL || escalar == NULL) {
+        fprintf(stderr, "Sem memoria para %d partidas\n", partidas);
+        return 2;
+    }
+
+    // Melhor de várias repetições para cada versão, alternadas
+    static LoteLockstep lote;
+    long long pecasLockstep = 0, passosLockstep = 0, pecasEscalar = 0, passosEscalar = 0;
+    double tempoLockstep = 1e30, tempoEscalar = 1e30;
+    for (int r = 0; r < repeticoes; r++) {
+        double inicio = agoraSegundos();
+        inicializarLoteLockstep(&lote, 0, partidas, 0, obterRegrasPontuacao(regras), lockstep);
+        pecasLockstep = simularLoteLockstep(&lote);
+        passosLockstep = lote.passos;
+        double tempo = agoraSegundos() - inicio;
+        tempoLockstep = tempo < tempoLockstep ? tempo : tempoLockstep;
+
+        passosEscalar = 0;
+        pecasEscalar = 0;
+        inicio = agoraSegundos();
+        for (int p = 0; p < partidas; p++) {
+            simularPartidaEscalar((uint64_t)p, regras, &passosEscalar, &escalar[p]);
+            pecasEscalar += escalar[p].pecasJogadas;
+        }
+        tempo = agoraSegundos() - inicio;
+        tempoEscalar = tempo < tempoEscalar ? tempo : tempoEscalar;
+    }
+
+    int divergentes = 0;
+    for (int p = 0; p < partidas; p++) {
+        if (memcmp(&lockstep[p], &escalar[p], sizeof(ResultadoLockstep)) != 0) {
+            if (divergentes++ < 5) {
+                fprintf(stderr, "Partida %d: lockstep %d pts nivel %d %d linhas | escalar %d pts nivel %d %d linhas\n",
+                        p, lockstep[p].pontuacaoTotal, lockstep[p].nivelAtual, lockstep[p].linhasEliminadas,
+                        escalar[p].pontuacaoTotal, escalar[p].nivelAtual, escalar[p].linhasEliminadas);
+            }
+        }
+    }
+
+    printf("=== LOCKSTEP (%d lanes) x ESCALAR ===\n", LANES_LOCKSTEP);
+    printf("Partidas: %d (melhor de %d) | regras %s\n", partidas, repeticoes, obterRegrasPontuacao(regras)->nome);
+    printf("Lockstep: %lld pecas em %.3fs | %.0f pecas/s | %lld passos de lote (%.0f%% das lanes ocupadas)\n",
+           pecasLockstep, tempoLockstep, pecasLockstep / tempoLockstep, passosLockstep,
+           100.0 * passosEscalar / ((double)passosLockstep * LANES_LOCKSTEP));
+    printf("Escalar:  %lld pecas em %.3fs | %.0f pecas/s | %lld passos de peca\n",
+           pecasEscalar, tempoEscalar, pecasEscalar / tempoEscalar, passosEscalar);
+    printf("Aceleracao: %.2fx\n", tempoEscalar / tempoLockstep);
+    printf("Partidas divergentes: %d\n", divergentes);
+
+    free(lockstep);
+    free(escalar);
+    return divergentes == 0 ? 0 : 1;
+}
@@ -0,0 +1,82 @@
+/**
+ * @file bench_lote.c
+ * @brief Reprocessamento de partidas gravadas: jogada a jogada x em lote
+ *
+ * Grava partidas sintéticas (tipos sorteados, cerca de 1/4 das peças vindas
+ * da reserva) e as reprocessa de duas formas: uma chamada a
+ * processarJogadaExpert() por jogada e uma chamada a
+ * processarLoteJogadasExpert() por partida. Confere que o Sistema Expert
+ * final é idêntico nas duas e informa a aceleração.
+ *
+ * Compilação:
+ * @code
+ * gcc -O2 -pthread -o bench_lote benchmarks/bench_lote.c -lm
+ * ./bench_lote [partidas] [jogadasPorPartida]
+ * @endcode
+ */
+
+#define TETRIS_SEM_MAIN
+#include "../tetris.c"
+#include "tempo_bench.h"
+
+/**
+ * @brief Sistema Expert zerado por completo (inclusive campos não inicializados)
+ */
+static void prepararSistema(SistemaExpert* sistemaPtr) {
+    memset(sistemaPtr, 0, sizeof(*sistemaPtr));
+    inicializarSistemaExpert(sistemaPtr);
+}
+
+int main(int argc, char* argv[]) {
+    int partidas = argc > 1 ? atoi(argv[1]) : 500;
+    int jogadasPorPartida = argc > 2 ? atoi(argv[2]) : 2000;
+    saidaSilenciosa = 1;
+
+    JogadaPeca* gravadas = malloc(sizeof(JogadaPeca) * (size_t)partidas * jogadasPorPartida);
+    GeradorPecas gerador;
+    inicializarGeradorPecas(&gerador, 2024);
+    for (long i = 0; i < (long)partidas * jogadasPorPartida; i++) {
+        gravadas[i].peca = criarPeca(sortearTipoPeca(&gerador), (int)i);
+        gravadas[i].origem = (gerador.estado >> 33) % 4 == 0;
+    }
+
+    SistemaExpert* individual = aligned_alloc(_Alignof(SistemaExpert), sizeof(SistemaExpert) * partidas);
+    SistemaExpert* emLote = aligned_alloc(_Alignof(SistemaExpert), sizeof(SistemaExpert) * partidas);
+
+    double inicio = agoraSegundos();
+    for (int p = 0; p < partidas; p++) {
+        prepararSistema(&individual[p]);
+        const JogadaPeca* partida = &gravadas[(long)p * jogadasPorPartida];
+        for (int j = 0; j < jogadasPorPartida; j++) {
+            processarJogadaExpert(partida[j].peca, partida[j].origem, &individual[p]);
+        }
+    }
+    double tempoIndividual = agoraSegundos() - inicio;
+
+    inicio = agoraSegundos();
+    for (int p = 0; p < partidas; p++) {
+        prepararSistema(&emLote[p]);
+        processarLoteJogadasExpert(&gravadas[(long)p * jogadasPorPartida], jogadasPorPartida, &emLote[p]);
+    }
+    double tempoLote = agoraSegundos() - inicio;
+
+    int divergentes = 0;
+    for (int p = 0; p < partidas; p++) {
+        sincronizarSistemaExpert(&individual[p]);
+        sincronizarSistemaExpert(&emLote[p]);
+        divergentes += memcmp(&individual[p], &emLote[p], sizeof(SistemaExpert)) != 0;
+    }
+
+    double total = (double)partidas * jogadasPorPartida;
+    printf("=== REPROCESSAMENTO DE PARTIDAS ===\n");
+    printf("Partidas: %d x %d jogadas | nivel final da 1a: %d\n",
+           partidas, jogadasPorPartida, emLote[0].nivelAtual);
+    printf("Jogada a jogada: %6.2f ns/jogada\n", tempoIndividual / total * 1e9);
+    printf("Em lote:         %6.2f ns/jogada\n", tempoLote / total * 1e9);
+    printf("Aceleracao: %.2fx | partidas divergentes: %d\n", tempoIndividual / tempoLote, divergentes);
+
+    free(gravadas);
+    free(individual);
+    free(emLote);
+    return divergentes == 0 ? 0 : 1;
+}
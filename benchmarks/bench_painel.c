@@ -0,0 +1,256 @@
+/**
+ * @file bench_painel.c
+ * @brief Painel de estatísticas: custo de publicar e leitores concorrentes
+ *
+ * Mede quanto custa publicar os contadores de uma sessão, submete o
+ * seqlock a um escritor e um leitor disputando o mesmo slot (todos os
+ * campos de uma publicação têm o mesmo valor, então uma cópia misturada
+ * aparece como campos diferentes) e conduz muitas sessões pelo servidor
+ * de sessões com e sem painel, com um monitor varrendo todos os slots
+ * enquanto elas jogam. No fim confere que o painel mostra exatamente o
+ * estado final de cada sessão.
+ *
+ * Compilação:
+ * @code
+ * gcc -O2 -pthread -o bench_painel benchmarks/bench_painel.c -lm
+ * ./bench_painel [sessoes] [opcoesPorSessao] [threads] [leituraUs]
+ * @endcode
+ */
+
+#define TETRIS_SEM_MAIN
+#include "../tetris.c"
+#include "tempo_bench.h"
+
+/**
+ * @brief Estado compartilhado pelos jogadores simulados
+ */
+typedef struct {
+    ServidorSessoes* servidor;
+    int* opcoesRestantes;           ///< Por identificador
+    int quantidadeSessoes;
+    pthread_mutex_t trava;
+    pthread_cond_t terminaram;
+    int concluidas;                 ///< Sessões que esgotaram o roteiro (continuam abertas)
+} Plateia;
+
+/**
+ * @brief Responde a cada passo com a próxima entrada; para sem sair no fim do roteiro
+ */
+static void responderSessao(void* contexto, SessaoJogo* sessaoPtr, EstadoSessao estado,
+                            const char* texto, size_t tamanho) {
+    static const int opcoesRoteiro[] = {1, 2, 3, 4, 1, 9, 10, 1, 9, 7, 2, 5};
+    Plateia* plateiaPtr = contexto;
+    (void)texto;
+    (void)tamanho;
+
+    char entrada[TAMANHO_ENTRADA_SESSAO] = "";
+    if (estado == SESSAO_AGUARDA_OPCAO) {
+        int indice = sessaoPtr->identificador - 1;
+        int restantes = plateiaPtr->opcoesRestantes[indice]--;
+        if (restantes <= 0) {
+            pthread_mutex_lock(&plateiaPtr->trava);
+            if (++plateiaPtr->concluidas == plateiaPtr->quantidadeSessoes) {
+                pthread_cond_signal(&plateiaPtr->terminaram);
+            }
+            pthread_mutex_unlock(&plateiaPtr->trava);
+            return;
+        }
+        int quantidadeRoteiro = (int)(sizeof(opcoesRoteiro) / sizeof(opcoesRoteiro[0]));
+        snprintf(entrada, sizeof(entrada), "%d", opcoesRoteiro[(indice * 5 + restantes) % quantidadeRoteiro]);
+    }
+    enviarEntradaSessao(plateiaPtr->servidor, sessaoPtr, entrada);
+}
+
+/**
+ * @brief Leitor concorrente: varre todos os slots até ser parado
+ */
+typedef struct {
+    pthread_t thread;
+    const PainelEstatisticas* painel;
+    int leituraUs;                  ///< Pausa entre varreduras (0 = sem pausa)
+    _Atomic int parar;
+    _Atomic long leituras;
+    long inconsistentes;            ///< lerEstatisticasPainel() sem cópia consistente
+    long misturadas;                ///< Cópias com campos de publicações diferentes (teste do seqlock)
+    int conferirCampos;
+} Monitor;
+
+static void* monitorarPainel(void* argumento) {
+    Monitor* m = argumento;
+    EstatisticasPublicadas copia;
+    while (!atomic_load_explicit(&m->parar, memory_order_relaxed)) {
+        uint32_t usados = atomic_load_explicit(&m->painel->cabecalho->slotsUsados, memory_order_acquire);
+        for (uint32_t slot = 0; slot < usados; slot++) {
+            int lido = lerEstatisticasPainel(m->painel, (int)slot, &copia);
+            atomic_fetch_add_explicit(&m->leituras, 1, memory_order_relaxed);
+            m->inconsistentes += lido < 0;
+            if (lido > 0 && m->conferirCampos) {
+                int32_t valor = copia.pontuacaoTotal;
+                m->misturadas += copia.recordePessoal != valor || copia.nivelAtual != valor ||
+                                 copia.comboAtual != valor || copia.melhorCombo != valor ||
+                                 copia.totalCombos != valor || copia.totalJogadas != valor ||
+                                 copia.jogadasDaPilha != valor || copia.opcoes != (uint32_t)valor ||
+                                 copia.conquistas != (uint32_t)valor || copia.atualizadoNs != (uint64_t)valor ||
+                                 copia.multiplicadorAtual != (double)valor;
+            }
+        }
+        if (m->leituraUs > 0) {
+            struct timespec pausa = {m->leituraUs / 1000000, (long)(m->leituraUs % 1000000) * 1000L};
+            nanosleep(&pausa, NULL);
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Joga todas as sessões pelo servidor
+ * @param painelPtr Painel em que as sessões publicam (NULL = sem painel)
+ * @return Opções por segundo
+ */
+static double jogarSessoes(SessaoJogo** sessoes, int quantidadeSessoes, int opcoesPorSessao, int numeroThreads,
+                           PainelEstatisticas* painelPtr, PoolObjetos* poolSessoes) {
+    int* opcoesRestantes = malloc(sizeof(int) * (size_t)quantidadeSessoes);
+    for (int i = 0; i < quantidadeSessoes; i++) {
+        sessoes[i] = abrirSessao(poolSessoes, NULL, i + 1, 0xFA1E0000ULL + (uint64_t)i);
+        if (painelPtr != NULL) {
+            publicarSessaoPainel(painelPtr, sessoes[i]);
+        }
+        opcoesRestantes[i] = opcoesPorSessao;
+    }
+
+    static ServidorSessoes servidor;
+    static Plateia plateia;
+    memset(&plateia, 0, sizeof(plateia));
+    plateia.servidor = &servidor;
+    plateia.opcoesRestantes = opcoesRestantes;
+    plateia.quantidadeSessoes = quantidadeSessoes;
+    pthread_mutex_init(&plateia.trava, NULL);
+    pthread_cond_init(&plateia.terminaram, NULL);
+    if (!iniciarServidorSessoes(&servidor, numeroThreads, quantidadeSessoes, responderSessao, &plateia)) {
+        fprintf(stderr, "Falha ao iniciar o servidor de sessoes\n");
+        exit(1);
+    }
+
+    double inicio = agoraSegundos();
+    for (int i = 0; i < quantidadeSessoes; i++) {
+        enviarEntradaSessao(&servidor, sessoes[i], "");
+    }
+    pthread_mutex_lock(&plateia.trava);
+    while (plateia.concluidas < quantidadeSessoes) {
+        pthread_cond_wait(&plateia.terminaram, &plateia.trava);
+    }
+    pthread_mutex_unlock(&plateia.trava);
+    double decorrido = agoraSegundos() - inicio;
+    encerrarServidorSessoes(&servidor);
+    pthread_mutex_destroy(&plateia.trava);
+    pthread_cond_destroy(&plateia.terminaram);
+    free(opcoesRestantes);
+    return (double)quantidadeSessoes * opcoesPorSessao / decorrido;
+}
+
+int main(int argc, char* argv[]) {
+    int quantidadeSessoes = argc > 1 ? atoi(argv[1]) : 1000;
+    int opcoesPorSessao = argc > 2 ? atoi(argv[2]) : 200;
+    int numeroThreads = argc > 3 ? atoi(argv[3]) : 4;
+    int leituraUs = argc > 4 ? atoi(argv[4]) : 1000;
+    if (numeroThreads < 1) {
+        numeroThreads = 1;
+    }
+    saidaSilenciosa = 1;
+
+    char nome[TAMANHO_NOME_PAINEL];
+    snprintf(nome, sizeof(nome), "%s-bench-%d", PREFIXO_PAINEL, (int)getpid());
+    static PainelEstatisticas painel;
+    if (!criarPainelEstatisticas(&painel, nome, quantidadeSessoes)) {
+        return 1;
+    }
+    printf("=== PAINEL DE ESTATISTICAS ===\n");
+    printf("Sessoes: %d | opcoes por sessao: %d | threads: %d | monitor a cada %d us | slot: %zu bytes\n",
+           quantidadeSessoes, opcoesPorSessao, numeroThreads, leituraUs, sizeof(EstatisticasPublicadas));
+
+    // Custo de uma publicação, sem leitores
+    PoolObjetos poolSessoes;
+    inicializarPool(&poolSessoes, sizeof(SessaoJogo), 256);
+    SessaoJogo* sessaoPtr = abrirSessao(&poolSessoes, NULL, 1, 42);
+    publicarSessaoPainel(&painel, sessaoPtr);
+    const int publicacoes = 5000000;
+    double inicio = agoraSegundos();
+    for (int i = 0; i < publicacoes; i++) {
+        publicarEstatisticasSessao(sessaoPtr);
+    }
+    printf("Publicar: %.1f ns por opcao\n", (agoraSegundos() - inicio) / publicacoes * 1e9);
+    fecharSessao(&poolSessoes, NULL, sessaoPtr);
+
+    // Seqlock: um escritor e um leitor no mesmo slot, até o leitor fazer tantas cópias quanto as publicações
+    static Monitor monitor;
+    monitor.painel = &painel;
+    monitor.conferirCampos = 1;
+    EstatisticasPublicadas* slotPtr = &painel.slots[0];
+    atomic_store_explicit(&painel.cabecalho->slotsUsados, 1, memory_order_release);
+    pthread_create(&monitor.thread, NULL, monitorarPainel, &monitor);
+    inicio = agoraSegundos();
+    int32_t valor;
+    for (valor = 1; valor <= publicacoes || atomic_load_explicit(&monitor.leituras, memory_order_relaxed) < publicacoes;
+         valor++) {
+        EstatisticasPublicadas valores = {.sessao = valor, .pontuacaoTotal = valor, .recordePessoal = valor,
+                                          .nivelAtual = valor, .comboAtual = valor, .melhorCombo = valor,
+                                          .totalCombos = valor, .totalJogadas = valor, .jogadasDaPilha = valor,
+                                          .opcoes = (uint32_t)valor, .conquistas = (uint32_t)valor,
+                                          .atualizadoNs = (uint64_t)valor, .multiplicadorAtual = valor};
+        escreverSlotPainel(slotPtr, &valores);
+    }
+    double segundosDisputa = agoraSegundos() - inicio;
+    atomic_store_explicit(&monitor.parar, 1, memory_order_relaxed);
+    pthread_join(monitor.thread, NULL);
+    EstatisticasPublicadas vazio;
+    memset(&vazio, 0, sizeof(vazio));
+    escreverSlotPainel(slotPtr, &vazio);
+    printf("Seqlock disputado: %.1f ns por publicacao | %ld leituras (%ld sem copia consistente) | misturadas %ld\n",
+           segundosDisputa / (valor - 1) * 1e9, (long)monitor.leituras, monitor.inconsistentes, monitor.misturadas);
+    long misturadas = monitor.misturadas;
+
+    // Servidor de sessões: sem painel x com painel e monitor
+    SessaoJogo** sessoes = malloc(sizeof(SessaoJogo*) * (size_t)quantidadeSessoes);
+    double semPainel = jogarSessoes(sessoes, quantidadeSessoes, opcoesPorSessao, numeroThreads, NULL, &poolSessoes);
+    for (int i = 0; i < quantidadeSessoes; i++) {
+        fecharSessao(&poolSessoes, NULL, sessoes[i]);
+    }
+
+    memset(&monitor, 0, sizeof(monitor));
+    monitor.painel = &painel;
+    monitor.leituraUs = leituraUs;
+    pthread_create(&monitor.thread, NULL, monitorarPainel, &monitor);
+    double comPainel = jogarSessoes(sessoes, quantidadeSessoes, opcoesPorSessao, numeroThreads, &painel,
+                                    &poolSessoes);
+    atomic_store_explicit(&monitor.parar, 1, memory_order_relaxed);
+    pthread_join(monitor.thread, NULL);
+
+    // O painel deve mostrar o estado final de cada sessão
+    int divergentes = 0;
+    for (int i = 0; i < quantidadeSessoes; i++) {
+        EstatisticasPublicadas copia;
+        const SistemaExpert* sistemaPtr = &sessoes[i]->sistema;
+        divergentes += lerEstatisticasPainel(&painel, sessoes[i]->slotPainel, &copia) != 1 ||
+                       copia.sessao != sessoes[i]->identificador ||
+                       copia.pontuacaoTotal != sistemaPtr->pontuacaoTotal ||
+                       copia.totalJogadas != sistemaPtr->totalJogadas ||
+                       copia.nivelAtual != sistemaPtr->nivelAtual ||
+                       copia.opcoes != (uint32_t)opcoesPorSessao;
+        fecharSessao(&poolSessoes, NULL, sessoes[i]);
+    }
+    int restantes = 0;
+    for (uint32_t slot = 0; slot < painel.cabecalho->capacidade; slot++) {
+        EstatisticasPublicadas copia;
+        restantes += lerEstatisticasPainel(&painel, (int)slot, &copia) != 0;
+    }
+
+    printf("Servidor sem painel: %.0f opcoes/s\n", semPainel);
+    printf("Servidor com painel: %.0f opcoes/s (%+.1f%%) | monitor: %ld leituras, %ld sem copia consistente\n",
+           comPainel, (comPainel / semPainel - 1.0) * 100.0, (long)monitor.leituras, monitor.inconsistentes);
+    printf("Sessoes divergentes no painel: %d | slots ocupados depois de fechar: %d\n", divergentes, restantes);
+
+    free(sessoes);
+    liberarPool(&poolSessoes);
+    fecharPainelEstatisticas(&painel);
+    return misturadas == 0 && divergentes == 0 && restantes == 0 ? 0 : 1;
+}
@@ -0,0 +1,93 @@
+/**
+ * @file bench_regras.c
+ * @brief Regras de pontuação: caminho especializado x tabela interpretada
+ *
+ * Registra uma cópia de cada conjunto de regras embutido (mesmos valores,
+ * outro nome), de modo que as partidas com a cópia passam pelo caminho
+ * genérico, que consulta a tabela de regras. Reprocessa as mesmas partidas
+ * sintéticas com as regras embutidas e com as cópias, jogada a jogada e em
+ * lote, e confere que o Sistema Expert final é idêntico.
+ *
+ * Compilação:
+ * @code
+ * gcc -O2 -pthread -o bench_regras benchmarks/bench_regras.c -lm
+ * ./bench_regras [partidas] [jogadasPorPartida]
+ * @endcode
+ */
+
+#define TETRIS_SEM_MAIN
+#include "../tetris.c"
+#include "tempo_bench.h"
+
+/**
+ * @brief Joga todas as partidas com um conjunto de regras
+ * @param emLote 1 para processarLoteJogadasExpert(), 0 para uma chamada por jogada
+ * @return Tempo em segundos
+ */
+static double jogarPartidas(const JogadaPeca* gravadas, int partidas, int jogadasPorPartida, int regras,
+                            int emLote, SistemaExpert* finais) {
+    double inicio = agoraSegundos();
+    for (int p = 0; p < partidas; p++) {
+        const JogadaPeca* partida = &gravadas[(long)p * jogadasPorPartida];
+        memset(&finais[p], 0, sizeof(finais[p]));
+        inicializarSistemaExpert(&finais[p]);
+        definirRegrasPontuacao(&finais[p], regras);
+        if (emLote) {
+            processarLoteJogadasExpert(partida, jogadasPorPartida, &finais[p]);
+        } else {
+            for (int j = 0; j < jogadasPorPartida; j++) {
+                processarJogadaExpert(partida[j].peca, partida[j].origem, &finais[p]);
+            }
+        }
+    }
+    return agoraSegundos() - inicio;
+}
+
+int main(int argc, char* argv[]) {
+    int partidas = argc > 1 ? atoi(argv[1]) : 500;
+    int jogadasPorPartida = argc > 2 ? atoi(argv[2]) : 2000;
+    saidaSilenciosa = 1;
+
+    JogadaPeca* gravadas = malloc(sizeof(JogadaPeca) * (size_t)partidas * jogadasPorPartida);
+    GeradorPecas gerador;
+    inicializarGeradorPecas(&gerador, 38);
+    for (long i = 0; i < (long)partidas * jogadasPorPartida; i++) {
+        gravadas[i].peca = criarPeca(sortearTipoPeca(&gerador), (int)i);
+        gravadas[i].origem = (gerador.estado >> 33) % 4 == 0;
+    }
+
+    SistemaExpert* especializados = aligned_alloc(_Alignof(SistemaExpert), sizeof(SistemaExpert) * partidas);
+    SistemaExpert* interpretados = aligned_alloc(_Alignof(SistemaExpert), sizeof(SistemaExpert) * partidas);
+    int divergentes = 0;
+    double total = (double)partidas * jogadasPorPartida;
+
+    printf("=== REGRAS DE PONTUACAO ===\n");
+    printf("Partidas: %d x %d jogadas\n", partidas, jogadasPorPartida);
+    for (int embutida = 0; embutida < NUMERO_REGRAS_EMBUTIDAS; embutida++) {
+        RegrasPontuacao copia = *obterRegrasPontuacao(embutida);
+        snprintf(copia.nome, sizeof(copia.nome), "tabela-%d", embutida);
+        int interpretada = registrarRegrasPontuacao(&copia);
+
+        for (int emLote = 0; emLote <= 1; emLote++) {
+            double tempoEspecializado = jogarPartidas(gravadas, partidas, jogadasPorPartida, embutida, emLote,
+                                                      especializados);
+            double tempoInterpretado = jogarPartidas(gravadas, partidas, jogadasPorPartida, interpretada, emLote,
+                                                     interpretados);
+            for (int p = 0; p < partidas; p++) {
+                interpretados[p].regrasPontuacao = especializados[p].regrasPontuacao;
+                sincronizarSistemaExpert(&especializados[p]);
+                sincronizarSistemaExpert(&interpretados[p]);
+                divergentes += memcmp(&especializados[p], &interpretados[p], sizeof(SistemaExpert)) != 0;
+            }
+            printf("%-9s %-8s especializado %5.2f ns/jogada | tabela %5.2f ns/jogada | nivel final %d\n",
+                   obterRegrasPontuacao(embutida)->nome, emLote ? "lote:" : "jogada:",
+                   tempoEspecializado / total * 1e9, tempoInterpretado / total * 1e9, especializados[0].nivelAtual);
+        }
+    }
+    printf("Partidas divergentes: %d\n", divergentes);
+
+    free(gravadas);
+    free(especializados);
+    free(interpretados);
+    return divergentes == 0 ? 0 : 1;
+}
@@ -0,0 +1,172 @@
+/**
+ * @file bench_replay.c
+ * @brief Replays com quadros-chave: latência da busca por tamanho de arquivo
+ *
+ * Grava partidas do bot (feixe 1, para gravar rápido) de
+ * tamanhos crescentes e mede quanto custa reconstruir a partida em jogadas
+ * sorteadas: partindo do quadro-chave mais próximo e reaplicando desde o
+ * início. Com quadros, a latência não deve crescer com o arquivo. Cada
+ * busca é conferida contra a reaplicação completa (sistema Expert,
+ * tabuleiro, gerador, fila, reserva e contadores), e a última jogada
+ * contra o resultado da partida gravada.
+ *
+ * Compilação:
+ * @code
+ * gcc -O2 -pthread -o bench_replay benchmarks/bench_replay.c -lm
+ * ./bench_replay [pecasMaximo] [intervaloQuadros] [caminho]
+ * @endcode
+ */
+
+#define TETRIS_SEM_MAIN
+#include "../tetris.c"
+#include "tempo_bench.h"
+
+#define BUSCAS_POR_ARQUIVO 200
+#define BUSCAS_DESDE_INICIO 20
+#define SEMENTE_PARTIDA 7        ///< Partida que não acaba antes de 100000 peças com feixe 1
+
+static int compararDuplos(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+/// Percentil (0-100) de tempos já ordenados
+static double percentil(const double* tempos, int quantidade, double p) {
+    int indice = (int)(p / 100.0 * (quantidade - 1) + 0.5);
+    return tempos[indice];
+}
+
+/// 1 se as duas partidas estão no mesmo estado
+static int partidasIguais(const EstadoPartidaBot* a, const EstadoPartidaBot* b) {
+    const SistemaExpert* x = &a->sistema;
+    const SistemaExpert* y = &b->sistema;
+    if (x->pontuacaoTotal != y->pontuacaoTotal || x->nivelAtual != y->nivelAtual ||
+        x->multiplicadorAtual != y->multiplicadorAtual || x->totalJogadas != y->totalJogadas ||
+        x->comboAtual != y->comboAtual || x->melhorCombo != y->melhorCombo || x->estadoCombo != y->estadoCombo ||
+        x->pontuacaoNivel != y->pontuacaoNivel || x->jogadasDaPilha != y->jogadasDaPilha ||
+        x->pecasReservadas != y->pecasReservadas) {
+        return 0;
+    }
+    if (memcmp(&a->tabuleiro, &b->tabuleiro, sizeof(Tabuleiro)) != 0 || a->gerador.estado != b->gerador.estado ||
+        a->gerador.proximoId != b->gerador.proximoId || a->gerador.saco != b->gerador.saco ||
+        a->pecasJogadas != b->pecasJogadas || a->linhasEliminadas != b->linhasEliminadas ||
+        a->acoesReserva != b->acoesReserva || a->acoes != b->acoes ||
+        a->fila.quantidadePecas != b->fila.quantidadePecas ||
+        a->pilha.quantidadeReservada != b->pilha.quantidadeReservada) {
+        return 0;
+    }
+    for (int i = 0; i < a->fila.quantidadePecas; i++) {
+        const Peca* p = espiarFila(&a->fila, i);
+        const Peca* q = espiarFila(&b->fila, i);
+        if (p->tipo != q->tipo || p->id != q->id) {
+            return 0;
+        }
+    }
+    for (int i = 0; i < a->pilha.quantidadeReservada; i++) {
+        const Peca* p = espiarPilha(&a->pilha, i);
+        const Peca* q = espiarPilha(&b->pilha, i);
+        if (p->tipo != q->tipo || p->id != q->id) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+int main(int argc, char* argv[]) {
+    int pecasMaximo = argc > 1 ? atoi(argv[1]) : 100000;
+    int intervaloQuadros = argc > 2 ? atoi(argv[2]) : INTERVALO_QUADROS_PADRAO;
+    const char* caminho = argc > 3 ? argv[3] : "bench_replay.rep";
+    if (pecasMaximo < 1000 || intervaloQuadros < 1) {
+        fprintf(stderr, "Use pelo menos 1000 pecas e intervalo de 1 acao\n");
+        return 1;
+    }
+
+    saidaSilenciosa = 1;
+    ConfigBot config;
+    configurarBotPadrao(&config);
+    config.larguraFeixe = 1;
+
+    printf("=== REPLAYS COM QUADROS-CHAVE (a cada %d acoes) ===\n", intervaloQuadros);
+    printf("%10s %10s %10s %9s | %21s | %21s\n", "Pecas", "Jogadas", "Tamanho", "Quadros", "Quadro p50/p99 (us)",
+           "Inicio p50/p99 (us)");
+    long divergentes = 0;
+    double tempos[BUSCAS_POR_ARQUIVO];
+    for (int pecas = 1000; pecas <= pecasMaximo; pecas *= 10) {
+        GravadorReplay gravador;
+        ResultadoPartida resultado;
+        if (!abrirGravacaoReplay(&gravador, caminho, &config, SEMENTE_PARTIDA, intervaloQuadros)) {
+            return 1;
+        }
+        executarPartidaBotGravada(&config, SEMENTE_PARTIDA, pecas, &resultado, &gravador);
+        ArquivoReplay arquivo;
+        if (!fecharGravacaoReplay(&gravador) || !abrirArquivoReplay(&arquivo, caminho)) {
+            return 1;
+        }
+        uint64_t total = arquivo.rodape->totalJogadas;
+
+        // Estado final = resultado da partida gravada
+        EstadoPartidaBot partida, referencia;
+        if (!buscarJogadaReplay(&arquivo, total, &partida, 1) ||
+            partida.sistema.pontuacaoTotal != resultado.sistema.pontuacaoTotal ||
+            partida.pecasJogadas != resultado.pecasJogadas ||
+            partida.linhasEliminadas != resultado.linhasEliminadas) {
+            divergentes++;
+        }
+        liberarPartidaBot(&partida);
+
+        // Jogadas sorteadas: com quadros e desde o início
+        GeradorPecas sorteio;
+        inicializarGeradorPecas(&sorteio, (uint64_t)pecas);
+        uint64_t alvos[BUSCAS_POR_ARQUIVO];
+        for (int i = 0; i < BUSCAS_POR_ARQUIVO; i++) {
+            sortearTipoPeca(&sorteio);
+            alvos[i] = sorteio.estado % (total + 1);
+        }
+        for (int i = 0; i < BUSCAS_POR_ARQUIVO; i++) {
+            double inicio = agoraSegundos();
+            int achou = buscarJogadaReplay(&arquivo, alvos[i], &partida, 1);
+            tempos[i] = (agoraSegundos() - inicio) * 1e6;
+            divergentes += !achou;
+            if (achou) {
+                liberarPartidaBot(&partida);
+            }
+        }
+        qsort(tempos, BUSCAS_POR_ARQUIVO, sizeof(double), compararDuplos);
+        double quadroP50 = percentil(tempos, BUSCAS_POR_ARQUIVO, 50), quadroP99 = percentil(tempos, BUSCAS_POR_ARQUIVO, 99);
+
+        double temposInicio[BUSCAS_DESDE_INICIO];
+        for (int i = 0; i < BUSCAS_DESDE_INICIO; i++) {
+            double inicio = agoraSegundos();
+            int achou = buscarJogadaReplay(&arquivo, alvos[i], &referencia, 0);
+            temposInicio[i] = (agoraSegundos() - inicio) * 1e6;
+            if (!achou || !buscarJogadaReplay(&arquivo, alvos[i], &partida, 1)) {
+                divergentes++;
+                continue;
+            }
+            divergentes += !partidasIguais(&partida, &referencia);
+            liberarPartidaBot(&partida);
+            liberarPartidaBot(&referencia);
+        }
+        qsort(temposInicio, BUSCAS_DESDE_INICIO, sizeof(double), compararDuplos);
+
+        // Custo dos quadros: o mesmo jogo gravado sem eles (intervalo maior que a partida)
+        size_t tamanho = arquivo.tamanho;
+        uint32_t quadros = arquivo.rodape->quantidadeQuadros;
+        fecharArquivoReplay(&arquivo);
+        if (!abrirGravacaoReplay(&gravador, caminho, &config, SEMENTE_PARTIDA, INT32_MAX)) {
+            return 1;
+        }
+        executarPartidaBotGravada(&config, SEMENTE_PARTIDA, pecas, &resultado, &gravador);
+        struct stat semQuadros;
+        if (!fecharGravacaoReplay(&gravador) || stat(caminho, &semQuadros) != 0) {
+            return 1;
+        }
+        printf("%10d %10llu %8.1fKB %9u | %10.1f %10.1f | %10.1f %10.1f | quadros +%.1f%%\n", pecas,
+               (unsigned long long)total, tamanho / 1e3, quadros, quadroP50, quadroP99,
+               percentil(temposInicio, BUSCAS_DESDE_INICIO, 50), percentil(temposInicio, BUSCAS_DESDE_INICIO, 99),
+               100.0 * ((double)tamanho - (double)semQuadros.st_size) / (double)semQuadros.st_size);
+    }
+    printf("Buscas divergentes: %ld\n", divergentes);
+    unlink(caminho);
+    return divergentes == 0 ? 0 : 1;
+}
@@ -0,0 +1,170 @@
+/**
+ * @file bench_sessoes.c
+ * @brief Milhares de sessões interativas simultâneas em poucas threads
+ *
+ * Abre muitas sessões do menu e as conduz por um roteiro de entradas
+ * (opção, Enter, opção, ..., 0) através do servidor de sessões. Cada
+ * resposta entregue pelo servidor dispara a próxima entrada da mesma
+ * sessão, como um jogador respondendo ao que acabou de ver. Informa a
+ * vazão em passos por segundo, o volume de saída e a memória por sessão.
+ *
+ * As sessões vêm de um PoolObjetos e são abertas e fechadas em ondas. Um
+ * contador de malloc (glibc) confere que, depois da primeira onda, o
+ * regime permanente não faz nenhuma alocação.
+ *
+ * Compilação:
+ * @code
+ * gcc -O2 -pthread -o bench_sessoes benchmarks/bench_sessoes.c -lm
+ * ./bench_sessoes [sessoes] [opcoesPorSessao] [threads] [ondas]
+ * @endcode
+ */
+
+#define TETRIS_SEM_MAIN
+#include "../tetris.c"
+#include "tempo_bench.h"
+
+#include <unistd.h>
+
+/// Alocador da glibc, chamado pelo malloc contador abaixo
+extern void* __libc_malloc(size_t tamanho);
+
+static long long chamadasMalloc = 0;
+
+/**
+ * @brief Conta todas as chamadas a malloc do processo (inclusive da libc)
+ */
+void* malloc(size_t tamanho) {
+    __atomic_fetch_add(&chamadasMalloc, 1, __ATOMIC_RELAXED);
+    return __libc_malloc(tamanho);
+}
+
+/**
+ * @brief Estado compartilhado pelos jogadores simulados
+ */
+typedef struct {
+    ServidorSessoes* servidor;
+    int* opcoesRestantes;           ///< Opções que cada sessão ainda vai escolher (por identificador)
+    int quantidadeSessoes;
+    pthread_mutex_t trava;
+    pthread_cond_t terminaram;
+    int encerradas;
+    long long passos;
+    long long bytesSaida;
+} Plateia;
+
+/**
+ * @brief Responde à saída de um passo com a próxima entrada do roteiro
+ */
+static void responderSessao(void* contexto, SessaoJogo* sessaoPtr, EstadoSessao estado,
+                            const char* texto, size_t tamanho) {
+    Plateia* plateiaPtr = contexto;
+    (void)texto;
+    __atomic_fetch_add(&plateiaPtr->passos, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&plateiaPtr->bytesSaida, (long long)tamanho, __ATOMIC_RELAXED);
+
+    if (estado == SESSAO_ENCERRADA) {
+        pthread_mutex_lock(&plateiaPtr->trava);
+        if (++plateiaPtr->encerradas == plateiaPtr->quantidadeSessoes) {
+            pthread_cond_signal(&plateiaPtr->terminaram);
+        }
+        pthread_mutex_unlock(&plateiaPtr->trava);
+        return;
+    }
+
+    char entrada[TAMANHO_ENTRADA_SESSAO] = "";
+    if (estado == SESSAO_AGUARDA_OPCAO) {
+        int indice = sessaoPtr->identificador - 1;
+        int restantes = plateiaPtr->opcoesRestantes[indice]--;
+        // Opções 1 a 7: jogadas, transferências, geração e consultas (o relatório
+        // da opção 8 roda a busca do bot e dominaria a medição)
+        int opcao = restantes > 0 ? 1 + (indice * 7 + restantes * 3) % 7 : 0;
+        snprintf(entrada, sizeof(entrada), "%d", opcao);
+    }
+    enviarEntradaSessao(plateiaPtr->servidor, sessaoPtr, entrada);
+}
+
+/**
+ * @brief Abre todas as sessões do pool, conduz até o fim e as fecha
+ * @return Segundos da onda
+ */
+static double executarOnda(Plateia* plateiaPtr, PoolObjetos* poolSessoes, SessaoJogo** sessoes,
+                           int opcoesPorSessao) {
+    int quantidadeSessoes = plateiaPtr->quantidadeSessoes;
+    double inicio = agoraSegundos();
+    plateiaPtr->encerradas = 0;
+    for (int i = 0; i < quantidadeSessoes; i++) {
+        sessoes[i] = abrirSessao(poolSessoes, NULL, i + 1, (uint64_t)i + 1);
+        plateiaPtr->opcoesRestantes[i] = opcoesPorSessao;
+    }
+    for (int i = 0; i < quantidadeSessoes; i++) {
+        enviarEntradaSessao(plateiaPtr->servidor, sessoes[i], "");
+    }
+
+    pthread_mutex_lock(&plateiaPtr->trava);
+    while (plateiaPtr->encerradas < quantidadeSessoes) {
+        pthread_cond_wait(&plateiaPtr->terminaram, &plateiaPtr->trava);
+    }
+    pthread_mutex_unlock(&plateiaPtr->trava);
+
+    for (int i = 0; i < quantidadeSessoes; i++) {
+        fecharSessao(poolSessoes, NULL, sessoes[i]);
+    }
+    return agoraSegundos() - inicio;
+}
+
+int main(int argc, char* argv[]) {
+    int quantidadeSessoes = argc > 1 ? atoi(argv[1]) : 20000;
+    int opcoesPorSessao = argc > 2 ? atoi(argv[2]) : 20;
+    int numeroThreads = argc > 3 ? atoi(argv[3]) : (int)sysconf(_SC_NPROCESSORS_ONLN);
+    int ondas = argc > 4 ? atoi(argv[4]) : 3;
+    if (numeroThreads < 1) {
+        numeroThreads = 1;
+    }
+
+    PoolObjetos poolSessoes;
+    inicializarPool(&poolSessoes, sizeof(SessaoJogo), 256);
+    SessaoJogo** sessoes = malloc(sizeof(SessaoJogo*) * (size_t)quantidadeSessoes);
+    int* opcoesRestantes = malloc(sizeof(int) * (size_t)quantidadeSessoes);
+
+    static ServidorSessoes servidor;
+    static Plateia plateia;
+    plateia.servidor = &servidor;
+    plateia.opcoesRestantes = opcoesRestantes;
+    plateia.quantidadeSessoes = quantidadeSessoes;
+    pthread_mutex_init(&plateia.trava, NULL);
+    pthread_cond_init(&plateia.terminaram, NULL);
+
+    if (!iniciarServidorSessoes(&servidor, numeroThreads, quantidadeSessoes, responderSessao, &plateia)) {
+        fprintf(stderr, "Falha ao iniciar o servidor de sessoes\n");
+        return 1;
+    }
+
+    printf("=== SESSOES INTERATIVAS SIMULTANEAS ===\n");
+    printf("Sessoes: %d | opcoes por sessao: %d | threads: %d\n",
+           quantidadeSessoes, opcoesPorSessao, numeroThreads);
+
+    double decorrido = 0.0;
+    long long mallocsRegimePermanente = 0;
+    for (int onda = 0; onda < ondas; onda++) {
+        long long mallocsAntes = __atomic_load_n(&chamadasMalloc, __ATOMIC_RELAXED);
+        double segundos = executarOnda(&plateia, &poolSessoes, sessoes, opcoesPorSessao);
+        long long mallocsOnda = __atomic_load_n(&chamadasMalloc, __ATOMIC_RELAXED) - mallocsAntes;
+        printf("Onda %d: %.3fs | %lld chamadas a malloc\n", onda + 1, segundos, mallocsOnda);
+        decorrido += segundos;
+        if (onda > 0) {
+            mallocsRegimePermanente += mallocsOnda;
+        }
+    }
+    encerrarServidorSessoes(&servidor);
+
+    printf("Passos: %lld em %.3fs | %.0f passos/s\n", plateia.passos, decorrido, plateia.passos / decorrido);
+    printf("Saida: %.1f MB | %.0f bytes/passo\n", plateia.bytesSaida / 1e6, (double)plateia.bytesSaida / plateia.passos);
+    printf("Memoria por sessao: %zu bytes (%.1f MB no total)\n",
+           sizeof(SessaoJogo), sizeof(SessaoJogo) * (double)quantidadeSessoes / 1e6);
+    exibirEstatisticasPool("Pool de sessoes", &poolSessoes);
+
+    liberarPool(&poolSessoes);
+    free(sessoes);
+    free(opcoesRestantes);
+    return mallocsRegimePermanente == 0 ? 0 : 1;
+}
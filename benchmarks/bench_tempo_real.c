@@ -0,0 +1,120 @@
+/**
+ * @file bench_tempo_real.c
+ * @brief Motor em passo fixo: a mesma partida em várias velocidades
+ *
+ * Joga a mesma partida com o piloto automático sem limite de velocidade e
+ * com o relógio acelerado (por padrão 100x e 1000x), desenhando cada
+ * quadro em /dev/null. Como a simulação só avança em ticks inteiros, a
+ * velocidade do relógio não pode mudar o resultado: tabuleiro, Sistema
+ * Expert e contadores finais são comparados byte a byte. Mede ticks por
+ * segundo, o atraso do relógio em cada acordar e a latência comando ->
+ * tela. Sem limite, e quando o relógio vence vários ticks por acordar, a
+ * tela só é desenhada no fim de cada lote, e a latência inclui o lote.
+ *
+ * Compilação:
+ * @code
+ * gcc -O2 -pthread -o bench_tempo_real benchmarks/bench_tempo_real.c -lm
+ * ./bench_tempo_real [pecas] [semente] [velocidade...]
+ * @endcode
+ */
+
+#define TETRIS_SEM_MAIN
+#include "../tetris.c"
+
+#define MAX_VELOCIDADES 8
+
+/**
+ * @brief Joga uma partida com o piloto na velocidade pedida
+ * @return 1 se a partida rodou
+ */
+static int jogarComPiloto(double velocidade, int pecas, uint64_t semente, PartidaTempoReal* partidaPtr,
+                          ResultadoTempoReal* resultadoPtr) {
+    ConfigTempoReal config;
+    memset(&config, 0, sizeof(config));
+    config.velocidade = velocidade;
+    config.desenhar = 1;
+    config.piloto = 1;
+    config.limitePecas = pecas;
+    configurarBotPadrao(&config.configBot);
+    iniciarPartidaTempoReal(partidaPtr, semente, TICKS_POR_SEGUNDO_PADRAO, config.configBot.capacidadeFila,
+                            config.configBot.capacidadePilha, config.configBot.regrasPontuacao);
+    return executarPartidaTempoReal(&config, partidaPtr, resultadoPtr);
+}
+
+static void exibirResultado(double velocidade, const PartidaTempoReal* partidaPtr,
+                            const ResultadoTempoReal* resultadoPtr) {
+    char nome[32];
+    if (velocidade > 0.0) {
+        snprintf(nome, sizeof(nome), "%.0fx", velocidade);
+    } else {
+        snprintf(nome, sizeof(nome), "sem limite");
+    }
+    printf("%-10s | %6llu ticks em %7.3f s | %9.0f ticks/s | %4d pecas | pontuacao %8d",
+           nome, (unsigned long long)partidaPtr->tick, resultadoPtr->segundosReais,
+           resultadoPtr->segundosReais > 0 ? partidaPtr->tick / resultadoPtr->segundosReais : 0.0,
+           partidaPtr->pecasJogadas, partidaPtr->sistema.pontuacaoTotal);
+    if (velocidade > 0.0) {
+        printf(" | atraso medio %.0f us, maximo %.0f us, %llu em lote", resultadoPtr->atrasoMedioUs,
+               resultadoPtr->atrasoMaximoUs, (unsigned long long)resultadoPtr->ticksAtrasados);
+    }
+    printf("\n           | latencia comando -> tela: p50 %.1f us | p99 %.1f us | max %.1f us (%ld desenhos)\n",
+           resultadoPtr->latenciaP50Us, resultadoPtr->latenciaP99Us, resultadoPtr->latenciaMaximaUs,
+           resultadoPtr->desenhos);
+}
+
+/// Compara o estado de jogo de duas partidas (ignora o tempo real)
+static int mesmaPartida(const PartidaTempoReal* a, const PartidaTempoReal* b) {
+    return a->tick == b->tick && a->pecasJogadas == b->pecasJogadas && a->linhasEliminadas == b->linhasEliminadas &&
+           memcmp(&a->tabuleiro, &b->tabuleiro, sizeof(a->tabuleiro)) == 0 &&
+           memcmp(&a->ativa, &b->ativa, sizeof(a->ativa)) == 0 &&
+           a->sistema.pontuacaoTotal == b->sistema.pontuacaoTotal && a->sistema.nivelAtual == b->sistema.nivelAtual &&
+           a->sistema.totalJogadas == b->sistema.totalJogadas && a->sistema.melhorCombo == b->sistema.melhorCombo;
+}
+
+int main(int argc, char* argv[]) {
+    int pecas = argc > 1 ? atoi(argv[1]) : 100;
+    uint64_t semente = argc > 2 ? strtoull(argv[2], NULL, 10) : 42;
+    double velocidades[MAX_VELOCIDADES] = {0.0, 100.0, 1000.0};
+    int quantidadeVelocidades = 3;
+    if (argc > 3) {
+        quantidadeVelocidades = 1;   // A referência sem limite vem sempre primeiro
+        for (int i = 3; i < argc && quantidadeVelocidades < MAX_VELOCIDADES; i++) {
+            velocidades[quantidadeVelocidades++] = atof(argv[i]);
+        }
+    }
+    saidaSilenciosa = 1;
+    saidaJogo = fopen("/dev/null", "w");
+    if (saidaJogo == NULL) {
+        fprintf(stderr, "Nao foi possivel abrir /dev/null\n");
+        return 1;
+    }
+
+    printf("=== MOTOR EM TEMPO REAL ===\n");
+    printf("Pecas: %d | semente %llu | %d Hz\n", pecas, (unsigned long long)semente, TICKS_POR_SEGUNDO_PADRAO);
+
+    static PartidaTempoReal referencia, partida;
+    ResultadoTempoReal resultado;
+    if (!jogarComPiloto(velocidades[0], pecas, semente, &referencia, &resultado)) {
+        return 1;
+    }
+    exibirResultado(velocidades[0], &referencia, &resultado);
+
+    int divergentes = 0;
+    for (int v = 1; v < quantidadeVelocidades; v++) {
+        if (!jogarComPiloto(velocidades[v], pecas, semente, &partida, &resultado)) {
+            return 1;
+        }
+        exibirResultado(velocidades[v], &partida, &resultado);
+        if (!mesmaPartida(&referencia, &partida)) {
+            printf("           | DIVERGE da partida sem limite\n");
+            divergentes++;
+        }
+        liberarPartidaTempoReal(&partida);
+    }
+    liberarPartidaTempoReal(&referencia);
+    fclose(saidaJogo);
+    saidaJogo = NULL;
+
+    printf("Velocidades divergentes: %d\n", divergentes);
+    return divergentes == 0 ? 0 : 1;
+}
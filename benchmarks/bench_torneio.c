@@ -0,0 +1,108 @@
+/**
+ * @file bench_torneio.c
+ * @brief Torneio paralelo: aceleração por threads e determinismo da tabela
+ *
+ * Joga o mesmo torneio (participantes x sequências) com 1 thread e depois
+ * com 2, 4, ... até o número pedido, e compara as tabelas de resultados
+ * campo a campo (menos o tempo e a thread de cada partida): a distribuição
+ * e o roubo de partidas não podem mudar o que foi jogado. Mede o tempo de
+ * parede, a aceleração sobre 1 thread e quantas partidas foram roubadas.
+ * Confere também os valores críticos da t de Student com a tabela.
+ *
+ * Compilação:
+ * @code
+ * gcc -O2 -pthread -o bench_torneio benchmarks/bench_torneio.c -lm
+ * ./bench_torneio [sequencias] [pecas] [threads]
+ * @endcode
+ */
+
+#define TETRIS_SEM_MAIN
+#include "../tetris.c"
+
+/// Compara duas tabelas de resultados, ignorando tempo e thread
+static long partidasDivergentes(const ResultadoJogoTorneio* a, const ResultadoJogoTorneio* b, long quantidade) {
+    long divergentes = 0;
+    for (long i = 0; i < quantidade; i++) {
+        divergentes += a[i].pontuacao != b[i].pontuacao || a[i].pecasJogadas != b[i].pecasJogadas ||
+                       a[i].linhasEliminadas != b[i].linhasEliminadas || a[i].nivel != b[i].nivel ||
+                       a[i].melhorCombo != b[i].melhorCombo;
+    }
+    return divergentes;
+}
+
+int main(int argc, char* argv[]) {
+    int quantidadeSequencias = argc > 1 ? atoi(argv[1]) : 16;
+    int limitePecas = argc > 2 ? atoi(argv[2]) : 300;
+    int maximoThreads = argc > 3 ? atoi(argv[3]) : (int)sysconf(_SC_NPROCESSORS_ONLN);
+    maximoThreads = maximoThreads < 1 ? 1 : maximoThreads;
+    saidaSilenciosa = 1;
+
+    // Valores críticos bilaterais a 5% (tabela da t de Student)
+    const int graus[] = {1, 5, 9, 30};
+    const double tabela[] = {12.706, 2.571, 2.262, 2.042};
+    int criticosErrados = 0;
+    for (int i = 0; i < 4; i++) {
+        criticosErrados += fabs(criticoTStudent(0.05, graus[i]) - tabela[i]) > 1e-3;
+    }
+
+    // Larguras de feixe diferentes dão partidas de custos diferentes, o caso do roubo
+    char descricoes[][48] = {"feixe2:largura=2", "feixe4:largura=4", "padrao", "raso:profundidade=1",
+                             "buracos:buracos=-1.5"};
+    int quantidadeParticipantes = (int)(sizeof(descricoes) / sizeof(descricoes[0]));
+    ParticipanteTorneio participantes[sizeof(descricoes) / sizeof(descricoes[0])];
+    for (int p = 0; p < quantidadeParticipantes; p++) {
+        lerParticipanteTorneio(descricoes[p], &participantes[p]);
+    }
+    long partidas = (long)quantidadeParticipantes * quantidadeSequencias;
+
+    printf("=== TORNEIO PARALELO ===\n");
+    printf("%d participantes x %d sequencias | ate %d pecas | t critico (5%%): %s\n", quantidadeParticipantes,
+           quantidadeSequencias, limitePecas, criticosErrados == 0 ? "confere com a tabela" : "DIVERGE");
+
+    ResultadoJogoTorneio* referencia = NULL;
+    double segundosReferencia = 0.0;
+    long divergentes = 0;
+    for (int threads = 1;; threads = threads * 2 < maximoThreads ? threads * 2 : maximoThreads) {
+        Torneio torneio;
+        memset(&torneio, 0, sizeof(torneio));
+        torneio.participantes = participantes;
+        torneio.quantidadeParticipantes = quantidadeParticipantes;
+        torneio.quantidadeSequencias = quantidadeSequencias;
+        torneio.sementeBase = 1;
+        torneio.limitePecas = limitePecas;
+        torneio.resultados = calloc((size_t)partidas, sizeof(ResultadoJogoTorneio));
+        if (torneio.resultados == NULL || !executarTorneio(&torneio, threads)) {
+            return 1;
+        }
+        long diferentes = 0;
+        if (referencia == NULL) {
+            referencia = torneio.resultados;
+            segundosReferencia = torneio.segundos;
+        } else {
+            diferentes = partidasDivergentes(referencia, torneio.resultados, partidas);
+            divergentes += diferentes;
+        }
+        printf("%2d threads: %7.3f s | %6.2fx | %4ld partidas roubadas | %ld partidas divergentes\n", threads,
+               torneio.segundos, torneio.segundos > 0 ? segundosReferencia / torneio.segundos : 0.0,
+               (long)atomic_load(&torneio.roubos), diferentes);
+        if (torneio.resultados != referencia) {
+            free(torneio.resultados);
+        }
+        if (threads == maximoThreads) {
+            break;
+        }
+    }
+
+    Torneio resumo;
+    memset(&resumo, 0, sizeof(resumo));
+    resumo.participantes = participantes;
+    resumo.quantidadeParticipantes = quantidadeParticipantes;
+    resumo.quantidadeSequencias = quantidadeSequencias;
+    resumo.resultados = referencia;
+    printf("\n");
+    exibirResultadosTorneio(&resumo, stdout);
+    free(referencia);
+
+    printf("Partidas divergentes: %ld\n", divergentes);
+    return divergentes == 0 && criticosErrados == 0 ? 0 : 1;
+}
@@ -0,0 +1,279 @@
+/**
+ * @file bench_transmissao.c
+ * @brief Transmissão para espectadores: bytes por ação e espectadores por núcleo
+ *
+ * Grava uma partida do bot como lista de ações e a retransmite quantas
+ * vezes for preciso, para medir só a transmissão. Compara os bytes por
+ * ação dos eventos com os de redesenhar a tela com exibirEstadoCompleto().
+ * Depois, numa única thread, o produtor publica cada ação e milhares de
+ * espectadores decodificam os eventos (metade entra em ações sorteadas,
+ * pelo quadro completo mais recente): ns por evento entregue e ações por
+ * segundo que uma thread aguenta com todos assistindo. Por fim, o
+ * produtor e threads de espectadores rodam ao mesmo tempo. Em todos os
+ * casos, cada espectador precisa terminar com o estado da partida.
+ *
+ * Compilação:
+ * @code
+ * gcc -O2 -pthread -o bench_transmissao benchmarks/bench_transmissao.c -lm
+ * ./bench_transmissao [pecas] [espectadoresMaximo] [threads]
+ * @endcode
+ */
+
+#define TETRIS_SEM_MAIN
+#include "../tetris.c"
+#include "tempo_bench.h"
+
+#define SEMENTE_PARTIDA 7
+
+/// Partida gravada: ações do bot e o estado final
+typedef struct {
+    AcaoBot* acoes;
+    long quantidade;
+    ConfigBot config;
+} PartidaGravada;
+
+/// Espectadores de uma thread leitora
+typedef struct {
+    TransmissaoEspectadores* transmissaoPtr;
+    EspectadorTransmissao* espectadores;
+    int quantidade;
+    _Atomic int* prontosPtr;
+    int erro;
+} LeitoresTransmissao;
+
+/// 1 se o espectador vê o mesmo estado que a partida
+static int visaoIgual(const EspectadorTransmissao* espectadorPtr, const EstadoPartidaBot* partidaPtr) {
+    if (!espectadorPtr->encerrada || espectadorPtr->acoes != partidaPtr->acoes ||
+        espectadorPtr->pontuacao != partidaPtr->sistema.pontuacaoTotal ||
+        espectadorPtr->nivel != partidaPtr->sistema.nivelAtual || espectadorPtr->combo != partidaPtr->sistema.comboAtual ||
+        espectadorPtr->melhorCombo != partidaPtr->sistema.melhorCombo ||
+        espectadorPtr->pecasJogadas != partidaPtr->pecasJogadas ||
+        espectadorPtr->linhasEliminadas != partidaPtr->linhasEliminadas ||
+        espectadorPtr->acoesReserva != partidaPtr->acoesReserva ||
+        espectadorPtr->quantidadeFila != partidaPtr->fila.quantidadePecas ||
+        espectadorPtr->quantidadePilha != partidaPtr->pilha.quantidadeReservada ||
+        memcmp(&espectadorPtr->tabuleiro, &partidaPtr->tabuleiro, sizeof(Tabuleiro)) != 0) {
+        return 0;
+    }
+    for (int i = 0; i < espectadorPtr->quantidadeFila; i++) {
+        int posicao = (espectadorPtr->inicioFila + i) % espectadorPtr->capacidadeFila;
+        if (espectadorPtr->fila[posicao] != espiarFila(&partidaPtr->fila, i)->tipo) {
+            return 0;
+        }
+    }
+    for (int i = 0; i < espectadorPtr->quantidadePilha; i++) {
+        if (espectadorPtr->pilha[espectadorPtr->quantidadePilha - 1 - i] != espiarPilha(&partidaPtr->pilha, i)->tipo) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static void iniciarPartidaGravada(const PartidaGravada* gravadaPtr, EstadoPartidaBot* partidaPtr) {
+    const ConfigBot* configPtr = &gravadaPtr->config;
+    iniciarPartidaBot(partidaPtr, configPtr->capacidadeFila, configPtr->capacidadePilha, configPtr->regrasPontuacao,
+                      SEMENTE_PARTIDA, (ModoGerador)configPtr->modoGerador, NULL);
+}
+
+/// Produtor e espectadores na mesma thread; devolve espectadores divergentes
+static long transmitirUmaThread(const PartidaGravada* gravadaPtr, int quantidadeEspectadores, double* segundosPtr,
+                                uint64_t* eventosPtr) {
+    EstadoPartidaBot partida;
+    iniciarPartidaGravada(gravadaPtr, &partida);
+    TransmissaoEspectadores transmissao;
+    EspectadorTransmissao* espectadores = calloc((size_t)quantidadeEspectadores, sizeof(EspectadorTransmissao));
+    long* entradas = malloc(sizeof(long) * (size_t)quantidadeEspectadores);
+    if (espectadores == NULL || entradas == NULL || !iniciarTransmissao(&transmissao, &partida, 0, 0)) {
+        return quantidadeEspectadores;
+    }
+    // Metade desde o começo; a outra metade entra em ações sorteadas, em ordem
+    GeradorPecas sorteio;
+    inicializarGeradorPecas(&sorteio, (uint64_t)quantidadeEspectadores);
+    int metade = quantidadeEspectadores / 2;
+    for (int i = 0; i < quantidadeEspectadores; i++) {
+        sortearTipoPeca(&sorteio);
+        entradas[i] = i < metade ? 0 : (long)(sorteio.estado % (uint64_t)gravadaPtr->quantidade);
+    }
+    for (int i = metade + 1; i < quantidadeEspectadores; i++) {
+        for (int j = i; j > metade && entradas[j - 1] > entradas[j]; j--) {
+            long troca = entradas[j];
+            entradas[j] = entradas[j - 1];
+            entradas[j - 1] = troca;
+        }
+    }
+
+    int presentes = 0;
+    long erros = 0;
+    uint64_t eventos = 0;
+    double inicio = agoraSegundos();
+    for (long a = 0; a <= gravadaPtr->quantidade; a++) {
+        while (presentes < quantidadeEspectadores && entradas[presentes] <= a) {
+            erros += !entrarTransmissao(&transmissao, &espectadores[presentes++]);
+        }
+        if (a == gravadaPtr->quantidade) {
+            encerrarTransmissao(&transmissao);
+        }
+        for (int i = 0; i < presentes; i++) {
+            int decodificados = acompanharTransmissao(&espectadores[i], 0);
+            erros += decodificados < 0;
+            eventos += decodificados > 0 ? (uint64_t)decodificados : 0;
+        }
+        if (a < gravadaPtr->quantidade) {
+            aplicarAcaoPartidaBot(&partida, &gravadaPtr->acoes[a]);
+            publicarAcaoTransmissao(&transmissao, &partida, &gravadaPtr->acoes[a]);
+        }
+    }
+    *segundosPtr = agoraSegundos() - inicio;
+    *eventosPtr = eventos;
+    for (int i = 0; i < presentes; i++) {
+        erros += !visaoIgual(&espectadores[i], &partida);
+        sairTransmissao(&espectadores[i]);
+    }
+    erros += quantidadeEspectadores - presentes;
+    liberarTransmissao(&transmissao);
+    liberarPartidaBot(&partida);
+    free(espectadores);
+    free(entradas);
+    return erros;
+}
+
+/// Thread leitora: acompanha os seus espectadores até a transmissão acabar
+static void* executarLeitores(void* argumento) {
+    LeitoresTransmissao* leitoresPtr = argumento;
+    for (int i = 0; i < leitoresPtr->quantidade; i++) {
+        leitoresPtr->erro |= !entrarTransmissao(leitoresPtr->transmissaoPtr, &leitoresPtr->espectadores[i]);
+    }
+    atomic_fetch_add(leitoresPtr->prontosPtr, 1);
+    int encerrados = 0;
+    while (encerrados < leitoresPtr->quantidade && !leitoresPtr->erro) {
+        encerrados = 0;
+        for (int i = 0; i < leitoresPtr->quantidade; i++) {
+            leitoresPtr->erro |= acompanharTransmissao(&leitoresPtr->espectadores[i], 0) < 0;
+            encerrados += leitoresPtr->espectadores[i].encerrada;
+        }
+        sched_yield();
+    }
+    return NULL;
+}
+
+/// Produtor nesta thread e espectadores em outras; devolve espectadores divergentes
+static long transmitirVariasThreads(const PartidaGravada* gravadaPtr, int quantidadeEspectadores, int numeroThreads,
+                                    double* segundosPtr) {
+    EstadoPartidaBot partida;
+    iniciarPartidaGravada(gravadaPtr, &partida);
+    TransmissaoEspectadores transmissao;
+    EspectadorTransmissao* espectadores = calloc((size_t)quantidadeEspectadores, sizeof(EspectadorTransmissao));
+    LeitoresTransmissao* leitores = calloc((size_t)numeroThreads, sizeof(LeitoresTransmissao));
+    pthread_t* threads = malloc(sizeof(pthread_t) * (size_t)numeroThreads);
+    if (espectadores == NULL || leitores == NULL || threads == NULL ||
+        !iniciarTransmissao(&transmissao, &partida, 0, 0)) {
+        return quantidadeEspectadores;
+    }
+    _Atomic int prontos = 0;
+    for (int t = 0; t < numeroThreads; t++) {
+        int inicio = (int)((long)quantidadeEspectadores * t / numeroThreads);
+        int fim = (int)((long)quantidadeEspectadores * (t + 1) / numeroThreads);
+        leitores[t].transmissaoPtr = &transmissao;
+        leitores[t].espectadores = espectadores + inicio;
+        leitores[t].quantidade = fim - inicio;
+        leitores[t].prontosPtr = &prontos;
+        pthread_create(&threads[t], NULL, executarLeitores, &leitores[t]);
+    }
+    // Parte dos espectadores entra com a partida em andamento
+    double inicio = agoraSegundos();
+    for (long a = 0; a < gravadaPtr->quantidade; a++) {
+        aplicarAcaoPartidaBot(&partida, &gravadaPtr->acoes[a]);
+        publicarAcaoTransmissao(&transmissao, &partida, &gravadaPtr->acoes[a]);
+    }
+    while (atomic_load(&prontos) < numeroThreads) {
+        sched_yield();
+    }
+    encerrarTransmissao(&transmissao);
+    long erros = 0;
+    for (int t = 0; t < numeroThreads; t++) {
+        pthread_join(threads[t], NULL);
+        erros += leitores[t].erro;
+    }
+    *segundosPtr = agoraSegundos() - inicio;
+    for (int i = 0; i < quantidadeEspectadores; i++) {
+        erros += !visaoIgual(&espectadores[i], &partida);
+        sairTransmissao(&espectadores[i]);
+    }
+    liberarTransmissao(&transmissao);
+    liberarPartidaBot(&partida);
+    free(espectadores);
+    free(leitores);
+    free(threads);
+    return erros;
+}
+
+int main(int argc, char* argv[]) {
+    int limitePecas = argc > 1 ? atoi(argv[1]) : 5000;
+    int espectadoresMaximo = argc > 2 ? atoi(argv[2]) : 10000;
+    int numeroThreads = argc > 3 ? atoi(argv[3]) : (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (limitePecas < 1 || espectadoresMaximo < 2 || numeroThreads < 1) {
+        fprintf(stderr, "Use pelo menos 1 peca, 2 espectadores e 1 thread\n");
+        return 1;
+    }
+    saidaSilenciosa = 1;
+
+    // Grava as ações uma vez; a busca do bot fica fora das medidas
+    PartidaGravada gravada;
+    configurarBotPadrao(&gravada.config);
+    gravada.config.larguraFeixe = 1;
+    gravada.acoes = malloc(sizeof(AcaoBot) * (size_t)limitePecas * 3);
+    gravada.quantidade = 0;
+    EstadoPartidaBot partida;
+    iniciarPartidaGravada(&gravada, &partida);
+    TransmissaoEspectadores transmissao;
+    iniciarTransmissao(&transmissao, &partida, 0, 0);
+    uint64_t bytesTela = 0;
+    char* tela = NULL;
+    size_t tamanhoTela = 0;
+    AcaoBot acao;
+    while (partida.pecasJogadas < limitePecas && gravada.quantidade < (long)limitePecas * 3 &&
+           escolherAcaoBot(&gravada.config, &partida.tabuleiro, &partida.fila, &partida.pilha, &acao)) {
+        gravada.acoes[gravada.quantidade++] = acao;
+        aplicarAcaoPartidaBot(&partida, &acao);
+        publicarAcaoTransmissao(&transmissao, &partida, &acao);
+        // A tela que exibirEstadoCompleto() redesenharia depois da ação
+        SistemaExpert copia = partida.sistema;
+        FILE* memoria = open_memstream(&tela, &tamanhoTela);
+        saidaJogo = memoria;
+        saidaSilenciosa = 0;
+        exibirEstadoCompleto(&partida.fila, &partida.pilha, &copia);
+        saidaSilenciosa = 1;
+        saidaJogo = NULL;
+        fclose(memoria);
+        bytesTela += tamanhoTela;
+        free(tela);
+        tela = NULL;
+    }
+    printf("=== TRANSMISSAO PARA ESPECTADORES ===\n");
+    printf("Partida: %d pecas, %ld acoes (feixe 1, semente %d)\n", partida.pecasJogadas, gravada.quantidade,
+           SEMENTE_PARTIDA);
+    printf("Bytes por acao: eventos %.2f (%llu quadros completos) | exibirEstadoCompleto %.1f (%.0fx)\n",
+           (double)transmissao.bytes / (double)gravada.quantidade, (unsigned long long)transmissao.quadros,
+           (double)bytesTela / (double)gravada.quantidade, (double)bytesTela / (double)transmissao.bytes);
+    liberarTransmissao(&transmissao);
+    liberarPartidaBot(&partida);
+
+    long divergentes = 0;
+    printf("\nUma thread (produtor + espectadores; metade entra no meio):\n");
+    printf("%12s %12s %14s %16s\n", "Espectadores", "ns/evento", "Eventos/s", "Acoes/s por jogo");
+    for (int quantidade = 10; quantidade <= espectadoresMaximo; quantidade *= 10) {
+        double segundos = 0.0;
+        uint64_t eventos = 0;
+        divergentes += transmitirUmaThread(&gravada, quantidade, &segundos, &eventos);
+        printf("%12d %12.1f %14.0f %16.0f\n", quantidade, segundos * 1e9 / (double)eventos,
+               (double)eventos / segundos, (double)gravada.quantidade / segundos);
+    }
+
+    double segundos = 0.0;
+    divergentes += transmitirVariasThreads(&gravada, espectadoresMaximo, numeroThreads, &segundos);
+    printf("\nProdutor + %d threads de espectadores: %d espectadores, %ld acoes em %.3fs\n", numeroThreads,
+           espectadoresMaximo, gravada.quantidade, segundos);
+    printf("Espectadores divergentes: %ld\n", divergentes);
+    free(gravada.acoes);
+    return divergentes == 0 ? 0 : 1;
+}
@@ -0,0 +1,281 @@
+/**
+ * @file bench_wal.c
+ * @brief WAL com group commit: custo por opção, checkpoints e tempo de recuperação
+ *
+ * Conduz muitas sessões com desfazer/refazer pelo servidor de sessões com
+ * o WAL ligado; cada opção só é respondida depois de durável, e as threads
+ * trabalhadoras compartilham os fdatasync (group commit). Enquanto as
+ * sessões jogam, checkpoints são gravados periodicamente; o custo de cada
+ * um é separado em cópia/escrita e fdatasync.
+ *
+ * Depois do roteiro, um último checkpoint é gravado; um oitavo das sessões
+ * só abre então, e todas jogam mais opcoesAposCheckpoint opções, que
+ * ficam só no WAL. Então, sem fechar
+ * as sessões, um registro cortado ao meio é acrescentado ao último
+ * segmento, como numa queda durante a escrita, e as sessões são
+ * recuperadas em pools novos (metade delas jogou com encaixe automático,
+ * que a recuperação precisa restaurar por sessão): do checkpoint mais as opções reaplicadas do
+ * WAL. Cada sessão recuperada é comparada com a original, byte a byte, na
+ * mesma forma usada pelo checkpoint. O programa retorna 1 se alguma sessão
+ * divergir ou se nenhuma opção precisou ser reaplicada.
+ *
+ * Compilação:
+ * @code
+ * gcc -O2 -pthread -o bench_wal benchmarks/bench_wal.c -lm
+ * ./bench_wal [sessoes] [opcoesPorSessao] [threads] [intervaloCheckpointMs] [opcoesAposCheckpoint] [caminho]
+ * @endcode
+ */
+
+#define TETRIS_SEM_MAIN
+#include "../tetris.c"
+#include "tempo_bench.h"
+
+/**
+ * @brief Estado compartilhado pelos jogadores simulados
+ */
+typedef struct {
+    ServidorSessoes* servidor;
+    int* opcoesRestantes;           ///< Por identificador
+    int quantidadeSessoes;
+    pthread_mutex_t trava;
+    pthread_cond_t terminaram;
+    int concluidas;                 ///< Sessões que esgotaram o roteiro (continuam abertas)
+} Plateia;
+
+/**
+ * @brief Envia a próxima opção do roteiro; no fim dele, só marca a sessão como concluída
+ */
+static void enviarProximaOpcao(Plateia* plateiaPtr, SessaoJogo* sessaoPtr) {
+    static const int opcoesRoteiro[] = {1, 2, 3, 4, 1, 9, 10, 1, 9, 7, 2, 5};
+    int indice = sessaoPtr->identificador - 1;
+    int restantes = plateiaPtr->opcoesRestantes[indice]--;
+    if (restantes <= 0) {
+        pthread_mutex_lock(&plateiaPtr->trava);
+        if (++plateiaPtr->concluidas == plateiaPtr->quantidadeSessoes) {
+            pthread_cond_signal(&plateiaPtr->terminaram);
+        }
+        pthread_mutex_unlock(&plateiaPtr->trava);
+        return;
+    }
+    int quantidadeRoteiro = (int)(sizeof(opcoesRoteiro) / sizeof(opcoesRoteiro[0]));
+    char entrada[TAMANHO_ENTRADA_SESSAO];
+    snprintf(entrada, sizeof(entrada), "%d", opcoesRoteiro[(indice * 5 + restantes) % quantidadeRoteiro]);
+    enviarEntradaSessao(plateiaPtr->servidor, sessaoPtr, entrada);
+}
+
+/**
+ * @brief Responde a cada passo com a próxima entrada; para sem sair no fim do roteiro
+ */
+static void responderSessao(void* contexto, SessaoJogo* sessaoPtr, EstadoSessao estado,
+                            const char* texto, size_t tamanho) {
+    Plateia* plateiaPtr = contexto;
+    (void)texto;
+    (void)tamanho;
+    if (estado == SESSAO_AGUARDA_OPCAO) {
+        enviarProximaOpcao(plateiaPtr, sessaoPtr);
+    } else {
+        enviarEntradaSessao(plateiaPtr->servidor, sessaoPtr, "");
+    }
+}
+
+/**
+ * @brief Abre a sessão i e a registra no WAL; metade delas com encaixe automático
+ *
+ * A recuperação precisa usar o modo de cada sessão, não o global do
+ * momento em que roda.
+ */
+static void abrirSessaoBench(PoolObjetos* poolSessoes, PoolObjetos* poolHistoricos, WalSessoes* walPtr,
+                             SessaoJogo** sessoes, int i) {
+    encaixeAutomaticoMenu = i % 2;
+    sessoes[i] = abrirSessao(poolSessoes, poolHistoricos, i + 1, 0x5EED0000ULL + (uint64_t)i);
+    registrarAberturaWal(walPtr, sessoes[i]);
+}
+
+/// Forma canônica da sessão (a mesma do checkpoint) para comparar original e recuperada
+static void serializarSessao(BufferCheckpointWal* bufferPtr, const SessaoJogo* sessaoPtr) {
+    bufferPtr->tamanho = 0;
+    copiarSessaoCheckpointWal(bufferPtr, sessaoPtr);
+}
+
+int main(int argc, char* argv[]) {
+    int quantidadeSessoes = argc > 1 ? atoi(argv[1]) : 1000;
+    int opcoesPorSessao = argc > 2 ? atoi(argv[2]) : 200;
+    int numeroThreads = argc > 3 ? atoi(argv[3]) : 4;
+    int intervaloCheckpointMs = argc > 4 ? atoi(argv[4]) : 200;
+    int opcoesAposCheckpoint = argc > 5 ? atoi(argv[5]) : 20;
+    const char* caminho = argc > 6 ? argv[6] : "bench_wal";
+    if (numeroThreads < 1) {
+        numeroThreads = 1;
+    }
+    if (opcoesAposCheckpoint < 1) {
+        opcoesAposCheckpoint = 1;
+    }
+    saidaSilenciosa = 1;
+
+    // Começa sem arquivos de execuções anteriores
+    char nome[TAMANHO_CAMINHO_WAL + 16];
+    snprintf(nome, sizeof(nome), "%s.ckpt", caminho);
+    unlink(nome);
+    for (uint32_t segmento = 1; segmento < 100000; segmento++) {
+        nomeSegmentoWal(nome, sizeof(nome), caminho, segmento);
+        if (unlink(nome) != 0 && segmento > 16) {
+            break;
+        }
+    }
+
+    PoolObjetos poolSessoes, poolHistoricos;
+    inicializarPool(&poolSessoes, sizeof(SessaoJogo), 256);
+    inicializarPool(&poolHistoricos, sizeof(HistoricoAcoes), 256);
+    SessaoJogo** sessoes = malloc(sizeof(SessaoJogo*) * (size_t)quantidadeSessoes);
+    int* opcoesRestantes = malloc(sizeof(int) * (size_t)quantidadeSessoes);
+
+    ResultadoRecuperacaoWal vazio;
+    static WalSessoes wal;
+    if (recuperarSessoesWal(caminho, &poolSessoes, &poolHistoricos, sessoes, quantidadeSessoes, &vazio) != 0 ||
+        !abrirWal(&wal, caminho, &vazio)) {
+        fprintf(stderr, "Falha ao preparar o WAL em %s\n", caminho);
+        return 1;
+    }
+    walSessoes = &wal;
+    // Um oitavo das sessões só abre depois do último checkpoint e é recuperado só do WAL
+    int sessoesIniciais = quantidadeSessoes - quantidadeSessoes / 8;
+    for (int i = 0; i < sessoesIniciais; i++) {
+        abrirSessaoBench(&poolSessoes, &poolHistoricos, &wal, sessoes, i);
+        opcoesRestantes[i] = opcoesPorSessao;
+    }
+
+    static ServidorSessoes servidor;
+    static Plateia plateia;
+    plateia.servidor = &servidor;
+    plateia.opcoesRestantes = opcoesRestantes;
+    plateia.quantidadeSessoes = sessoesIniciais;
+    pthread_mutex_init(&plateia.trava, NULL);
+    pthread_cond_init(&plateia.terminaram, NULL);
+    if (!iniciarServidorSessoes(&servidor, numeroThreads, quantidadeSessoes, responderSessao, &plateia)) {
+        fprintf(stderr, "Falha ao iniciar o servidor de sessoes\n");
+        return 1;
+    }
+
+    printf("=== WAL E CHECKPOINTS ===\n");
+    printf("Sessoes: %d | opcoes por sessao: %d | threads: %d | checkpoint a cada %d ms | %d opcoes apos o ultimo\n",
+           quantidadeSessoes, opcoesPorSessao, numeroThreads, intervaloCheckpointMs, opcoesAposCheckpoint);
+
+    double inicio = agoraSegundos();
+    for (int i = 0; i < sessoesIniciais; i++) {
+        enviarEntradaSessao(&servidor, sessoes[i], "");
+    }
+    double tempoCheckpoints = 0.0;
+    pthread_mutex_lock(&plateia.trava);
+    while (plateia.concluidas < sessoesIniciais) {
+        struct timespec limite;
+        clock_gettime(CLOCK_REALTIME, &limite);
+        limite.tv_nsec += (long)intervaloCheckpointMs * 1000000L;
+        limite.tv_sec += limite.tv_nsec / 1000000000L;
+        limite.tv_nsec %= 1000000000L;
+        if (pthread_cond_timedwait(&plateia.terminaram, &plateia.trava, &limite) != 0 &&
+            plateia.concluidas < sessoesIniciais) {
+            // Checkpoint com as sessões jogando
+            pthread_mutex_unlock(&plateia.trava);
+            double inicioCheckpoint = agoraSegundos();
+            gravarCheckpointWal(&wal, sessoes, sessoesIniciais);
+            tempoCheckpoints += agoraSegundos() - inicioCheckpoint;
+            pthread_mutex_lock(&plateia.trava);
+        }
+    }
+    pthread_mutex_unlock(&plateia.trava);
+
+    // Último checkpoint; as opções seguintes ficam só no WAL
+    double inicioCheckpoint = agoraSegundos();
+    int checkpointFinal = gravarCheckpointWal(&wal, sessoes, sessoesIniciais);
+    tempoCheckpoints += agoraSegundos() - inicioCheckpoint;
+    for (int i = sessoesIniciais; i < quantidadeSessoes; i++) {
+        abrirSessaoBench(&poolSessoes, &poolHistoricos, &wal, sessoes, i);
+    }
+    pthread_mutex_lock(&plateia.trava);
+    plateia.concluidas = 0;
+    plateia.quantidadeSessoes = quantidadeSessoes;
+    pthread_mutex_unlock(&plateia.trava);
+    for (int i = 0; i < quantidadeSessoes; i++) {
+        opcoesRestantes[i] = opcoesAposCheckpoint;
+        if (i < sessoesIniciais) {
+            enviarProximaOpcao(&plateia, sessoes[i]);
+        } else {
+            enviarEntradaSessao(&servidor, sessoes[i], "");
+        }
+    }
+    pthread_mutex_lock(&plateia.trava);
+    while (plateia.concluidas < quantidadeSessoes) {
+        pthread_cond_wait(&plateia.terminaram, &plateia.trava);
+    }
+    pthread_mutex_unlock(&plateia.trava);
+    double decorrido = agoraSegundos() - inicio;
+    encerrarServidorSessoes(&servidor);
+    walSessoes = NULL;
+    fecharWal(&wal);
+
+    printf("Opcoes duraveis: %llu registros em %.3fs | %.0f registros/s\n",
+           (unsigned long long)wal.registros, decorrido, wal.registros / decorrido);
+    printf("fdatasync: %llu (%.1f registros por fdatasync, maior grupo %d)\n",
+           (unsigned long long)wal.sincronizacoes, (double)wal.registros / wal.sincronizacoes, wal.maiorGrupo);
+    double checkpoints = wal.checkpoints > 0 ? (double)wal.checkpoints : 1.0;
+    printf("Checkpoints: %llu (%.1f ms cada, %.1f ms por mil sessoes, ultimo com %.1f KB)\n",
+           (unsigned long long)wal.checkpoints, tempoCheckpoints / checkpoints * 1e3,
+           tempoCheckpoints / checkpoints * 1e3 * 1000.0 / sessoesIniciais, wal.bytesUltimoCheckpoint / 1e3);
+    printf("  copia, CRC e write: %.1f ms | fdatasync, rename e segmentos: %.1f ms | %.0f MB/s ate o disco\n",
+           wal.nsCopiaCheckpoints / checkpoints * 1e-6, wal.nsSincronizacaoCheckpoints / checkpoints * 1e-6,
+           wal.nsCopiaCheckpoints > 0 ? wal.bytesUltimoCheckpoint / (wal.nsCopiaCheckpoints / checkpoints * 1e-9) / 1e6
+                                      : 0.0);
+
+    // Queda durante a escrita: meio registro no fim do último segmento
+    nomeSegmentoWal(nome, sizeof(nome), caminho, wal.segmento);
+    FILE* segmento = fopen(nome, "ab");
+    if (segmento != NULL) {
+        static const char cortado[17] = "registro cortado";
+        fwrite(cortado, sizeof(cortado), 1, segmento);
+        fclose(segmento);
+    }
+
+    encaixeAutomaticoMenu = 0;
+    PoolObjetos poolRecuperadas, poolHistoricosRecuperados;
+    inicializarPool(&poolRecuperadas, sizeof(SessaoJogo), 256);
+    inicializarPool(&poolHistoricosRecuperados, sizeof(HistoricoAcoes), 256);
+    SessaoJogo** recuperadas = malloc(sizeof(SessaoJogo*) * (size_t)quantidadeSessoes);
+    ResultadoRecuperacaoWal recuperacao;
+    int quantidadeRecuperadas = recuperarSessoesWal(caminho, &poolRecuperadas, &poolHistoricosRecuperados,
+                                                    recuperadas, quantidadeSessoes, &recuperacao);
+
+    int divergentes = quantidadeRecuperadas == quantidadeSessoes ? 0 : quantidadeSessoes;
+    BufferCheckpointWal original = {NULL, 0, 0, 0}, recuperada = {NULL, 0, 0, 0};
+    for (int i = 0; i < quantidadeRecuperadas; i++) {
+        int indice = recuperadas[i]->identificador - 1;
+        if (indice < 0 || indice >= quantidadeSessoes) {
+            divergentes++;
+            continue;
+        }
+        serializarSessao(&original, sessoes[indice]);
+        serializarSessao(&recuperada, recuperadas[i]);
+        divergentes += original.tamanho != recuperada.tamanho ||
+                       memcmp(original.dados, recuperada.dados, original.tamanho) != 0;
+    }
+
+    printf("Recuperacao: %d sessoes (%d do checkpoint) | %ld opcoes reaplicadas | %.2f ms (%.2f ms por mil sessoes)\n",
+           quantidadeRecuperadas, recuperacao.sessoesCheckpoint, recuperacao.registrosReaplicados,
+           recuperacao.segundos * 1e3, recuperacao.segundos * 1e3 * 1000.0 / quantidadeSessoes);
+    printf("Sessoes divergentes: %d\n", divergentes);
+    int semReaplicar = !checkpointFinal || recuperacao.sessoesCheckpoint != sessoesIniciais ||
+                       recuperacao.registrosReaplicados <= 0;
+    if (semReaplicar) {
+        fprintf(stderr, "A recuperacao deveria partir do ultimo checkpoint e reaplicar as opcoes seguintes\n");
+    }
+
+    free(original.dados);
+    free(recuperada.dados);
+    free(recuperadas);
+    free(sessoes);
+    free(opcoesRestantes);
+    liberarPool(&poolSessoes);
+    liberarPool(&poolHistoricos);
+    liberarPool(&poolRecuperadas);
+    liberarPool(&poolHistoricosRecuperados);
+    return divergentes == 0 && !semReaplicar ? 0 : 1;
+}
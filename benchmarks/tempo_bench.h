@@ -0,0 +1,32 @@
+/**
+ * @file tempo_bench.h
+ * @brief Relógio compartilhado pelos benchmarks
+ *
+ * Incluído depois de "../tetris.c" em cada benchmark de benchmarks/.
+ */
+
+#ifndef TEMPO_BENCH_H
+#define TEMPO_BENCH_H
+
+#include <stdint.h>
+#include <time.h>
+
+/**
+ * @brief Retorna o instante atual em segundos (relógio monotônico)
+ */
+static inline double agoraSegundos(void) {
+    struct timespec instante;
+    clock_gettime(CLOCK_MONOTONIC, &instante);
+    return instante.tv_sec + instante.tv_nsec * 1e-9;
+}
+
+/**
+ * @brief Retorna o instante atual em nanossegundos inteiros (relógio monotônico)
+ */
+static inline uint64_t agoraNanossegundos(void) {
+    struct timespec instante;
+    clock_gettime(CLOCK_MONOTONIC, &instante);
+    return (uint64_t)instante.tv_sec * 1000000000ULL + (uint64_t)instante.tv_nsec;
+}
+
+#endif // TEMPO_BENCH_H
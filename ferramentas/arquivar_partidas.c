@@ -0,0 +1,73 @@
+/**
+ * @file arquivar_partidas.c
+ * @brief Joga partidas do bot e grava o arquivo de partidas para consultas
+ *
+ * Cada partida vira um resumo de tamanho fixo (pontuação, nível, melhor
+ * combo, eficiência da reserva, maior combo antes de cada nível...) no
+ * formato lido por abrirArquivoPartidas(), com o índice de zonas que o
+ * modo --consultar usa para descartar arquivos e blocos sem lê-los. A
+ * partida i usa a semente (semente + i); gravar um arquivo por lote de
+ * sementes mantém cada arquivo pequeno e o resumo do cabeçalho útil.
+ *
+ * Compilação:
+ * @code
+ * gcc -O2 -pthread -o arquivar_partidas ferramentas/arquivar_partidas.c -lm
+ * ./arquivar_partidas arquivo [partidas] [pecasPorPartida] [semente] [larguraFeixe]
+ * ./tetris --consultar arquivo --onde "comboAntesNivel3 >= 8"
+ * @endcode
+ */
+
+#define TETRIS_SEM_MAIN
+#include "../tetris.c"
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        fprintf(stderr, "Uso: %s arquivo [partidas] [pecasPorPartida] [semente] [larguraFeixe]\n", argv[0]);
+        return 1;
+    }
+    const char* caminho = argv[1];
+    long quantidade = argc > 2 ? atol(argv[2]) : 1000;
+    int limitePecas = argc > 3 ? atoi(argv[3]) : 500;
+    uint64_t semente = argc > 4 ? strtoull(argv[4], NULL, 10) : 0;
+    ConfigBot config;
+    configurarBotPadrao(&config);
+    config.larguraFeixe = argc > 5 ? atoi(argv[5]) : 1;
+    if (quantidade < 0 || limitePecas < 0 || config.larguraFeixe < 1) {
+        fprintf(stderr, "Quantidades invalidas\n");
+        return 1;
+    }
+
+    saidaSilenciosa = 1;
+    ResumoPartidaArquivo* partidas = malloc(sizeof(ResumoPartidaArquivo) * (size_t)(quantidade > 0 ? quantidade : 1));
+    if (partidas == NULL) {
+        fprintf(stderr, "Sem memoria para %ld partidas\n", quantidade);
+        return 1;
+    }
+    clock_t inicio = clock();
+    for (long i = 0; i < quantidade; i++) {
+        EstadoPartidaBot partida;
+        AcaoBot acao;
+        iniciarPartidaBot(&partida, config.capacidadeFila, config.capacidadePilha, config.regrasPontuacao,
+                          semente + (uint64_t)i, (ModoGerador)config.modoGerador, NULL);
+        iniciarResumoPartida(&partidas[i], semente + (uint64_t)i);
+        while ((limitePecas == 0 || partida.pecasJogadas < limitePecas) &&
+               escolherAcaoBot(&config, &partida.tabuleiro, &partida.fila, &partida.pilha, &acao)) {
+            aplicarAcaoPartidaBot(&partida, &acao);
+            acompanharResumoPartida(&partidas[i], &partida);
+        }
+        concluirResumoPartida(&partidas[i], &partida);
+        liberarPartidaBot(&partida);
+    }
+    double segundos = (double)(clock() - inicio) / CLOCKS_PER_SEC;
+
+    int gravou = gravarArquivoPartidas(caminho, partidas, (uint64_t)quantidade);
+    if (gravou) {
+        uint64_t blocos = ((uint64_t)quantidade + PARTIDAS_POR_BLOCO_ARQUIVO - 1) / PARTIDAS_POR_BLOCO_ARQUIVO;
+        printf("Arquivo %s: %ld partidas em %.1f s, %llu blocos, %.1f KB\n", caminho, quantidade, segundos,
+               (unsigned long long)blocos,
+               (sizeof(CabecalhoArquivoPartidas) + sizeof(ZonaArquivoPartidas) * blocos +
+                sizeof(ResumoPartidaArquivo) * (uint64_t)quantidade) / 1e3);
+    }
+    free(partidas);
+    return gravou ? 0 : 1;
+}
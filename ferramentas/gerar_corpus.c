@@ -0,0 +1,112 @@
+/**
+ * @file gerar_corpus.c
+ * @brief Gera arquivos de corpus de sequências de peças
+ *
+ * Grava sequências fixas de peças para torneios e regressões no formato
+ * lido por abrirCorpusSequencias() (3 bits por peça, índice de sequências).
+ * Por padrão a sequência i é a do gerador com semente (semente + i), a
+ * mesma que o bot joga sem corpus; com -t, cada linha de um arquivo de
+ * texto ("ITOSZJL...") vira uma sequência.
+ *
+ * Compilação:
+ * @code
+ * gcc -O2 -pthread -o gerar_corpus ferramentas/gerar_corpus.c -lm
+ * ./gerar_corpus arquivo [sequencias] [pecasPorSequencia] [semente]
+ * ./gerar_corpus arquivo -t sequencias.txt
+ * @endcode
+ */
+
+#define TETRIS_SEM_MAIN
+#include "../tetris.c"
+
+/**
+ * @brief Lê uma sequência por linha (linhas vazias são ignoradas; tipos inválidos, recusados ao gravar)
+ * @return Número de sequências, ou -1 em caso de falha
+ */
+static long lerSequenciasTexto(const char* caminho, char** tiposPtr, uint64_t** iniciosPtr) {
+    FILE* arquivo = fopen(caminho, "r");
+    if (arquivo == NULL) {
+        fprintf(stderr, "Nao foi possivel abrir %s: %s\n", caminho, strerror(errno));
+        return -1;
+    }
+    size_t capacidadeTipos = 4096, capacidadeInicios = 256;
+    char* tipos = malloc(capacidadeTipos);
+    uint64_t* inicios = malloc(sizeof(uint64_t) * capacidadeInicios);
+    uint64_t total = 0;
+    long quantidade = 0;
+    int caractere, linhaAberta = 0;
+    inicios[0] = 0;
+    do {
+        caractere = fgetc(arquivo);
+        if (caractere == EOF || caractere == '\n' || caractere == '\r') {
+            if (linhaAberta) {
+                if ((size_t)quantidade + 2 > capacidadeInicios) {
+                    capacidadeInicios *= 2;
+                    inicios = realloc(inicios, sizeof(uint64_t) * capacidadeInicios);
+                }
+                inicios[++quantidade] = total;
+                linhaAberta = 0;
+            }
+            continue;
+        }
+        if (total + 1 > capacidadeTipos) {
+            capacidadeTipos *= 2;
+            tipos = realloc(tipos, capacidadeTipos);
+        }
+        tipos[total++] = (char)caractere;
+        linhaAberta = 1;
+    } while (caractere != EOF);
+    fclose(arquivo);
+    *tiposPtr = tipos;
+    *iniciosPtr = inicios;
+    return quantidade;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        fprintf(stderr, "Uso: %s arquivo [sequencias] [pecasPorSequencia] [semente] | %s arquivo -t texto\n",
+                argv[0], argv[0]);
+        return 1;
+    }
+    const char* caminho = argv[1];
+    char* tipos = NULL;
+    uint64_t* inicios = NULL;
+    long quantidade;
+    if (argc > 3 && strcmp(argv[2], "-t") == 0) {
+        quantidade = lerSequenciasTexto(argv[3], &tipos, &inicios);
+        if (quantidade < 0) {
+            return 1;
+        }
+    } else {
+        quantidade = argc > 2 ? atol(argv[2]) : 1000;
+        long pecasPorSequencia = argc > 3 ? atol(argv[3]) : 10000;
+        uint64_t semente = argc > 4 ? strtoull(argv[4], NULL, 10) : 0;
+        if (quantidade < 0 || quantidade > UINT32_MAX || pecasPorSequencia < 0) {
+            fprintf(stderr, "Quantidades invalidas\n");
+            return 1;
+        }
+        tipos = malloc((size_t)quantidade * (size_t)pecasPorSequencia + 1);
+        inicios = malloc(sizeof(uint64_t) * ((size_t)quantidade + 1));
+        uint64_t total = 0;
+        for (long s = 0; s < quantidade; s++) {
+            GeradorPecas gerador;
+            inicializarGeradorPecas(&gerador, semente + (uint64_t)s);
+            inicios[s] = total;
+            for (long p = 0; p < pecasPorSequencia; p++) {
+                tipos[total++] = sortearTipoPeca(&gerador);
+            }
+        }
+        inicios[quantidade] = total;
+    }
+
+    int gravou = gravarCorpusSequencias(caminho, tipos, inicios, (uint32_t)quantidade);
+    if (gravou) {
+        printf("Corpus %s: %ld sequencias, %llu pecas, %.1f KB\n", caminho, quantidade,
+               (unsigned long long)inicios[quantidade],
+               (sizeof(CabecalhoCorpus) + sizeof(uint64_t) * (quantidade + 1) +
+                (inicios[quantidade] * BITS_PECA_CORPUS + 7) / 8 + PREENCHIMENTO_CORPUS) / 1e3);
+    }
+    free(tipos);
+    free(inicios);
+    return gravou ? 0 : 1;
+}
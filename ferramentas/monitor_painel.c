@@ -0,0 +1,195 @@
+/**
+ * @file monitor_painel.c
+ * @brief Monitor de linha de comando dos painéis de estatísticas
+ *
+ * Mapeia só para leitura os painéis publicados pelo menu (--painel nome)
+ * ou por servidores de sessões, e agrega os contadores de todas as
+ * sessões: pontuação, níveis, combos e vazão de jogadas e opções. Sem
+ * nomes na linha de comando, abre todo painel cujo nome começa com
+ * PREFIXO_PAINEL. Ler não trava nem atrasa quem joga: cada slot é copiado
+ * com lerEstatisticasPainel(), que só refaz a própria cópia.
+ *
+ * Compilação:
+ * @code
+ * gcc -O2 -pthread -o monitor_painel ferramentas/monitor_painel.c -lm
+ * ./monitor_painel [-i intervaloMs] [-n amostras] [-t sessoes] [nome...]
+ * @endcode
+ */
+
+#define TETRIS_SEM_MAIN
+#include "../tetris.c"
+
+#include <dirent.h>
+
+#define MAX_PAINEIS_MONITOR 64
+#define SESSAO_PARADA_NS 5000000000ULL     ///< Sem publicar há mais que isto: sessão parada
+
+/**
+ * @brief Painel acompanhado e a amostra anterior de cada slot (para a vazão)
+ */
+typedef struct {
+    PainelEstatisticas painel;
+    int32_t* sessaoAnterior;
+    uint32_t* opcoesAnteriores;
+    int32_t* jogadasAnteriores;
+} PainelMonitorado;
+
+static int compararPontuacao(const void* a, const void* b) {
+    const EstatisticasPublicadas* x = a;
+    const EstatisticasPublicadas* y = b;
+    return (y->pontuacaoTotal > x->pontuacaoTotal) - (y->pontuacaoTotal < x->pontuacaoTotal);
+}
+
+/// Acrescenta os painéis de /dev/shm com o prefixo dos painéis do jogo
+static int descobrirPaineis(char nomes[][TAMANHO_NOME_PAINEL], int capacidade) {
+    DIR* diretorio = opendir("/dev/shm");
+    int quantidade = 0;
+    if (diretorio == NULL) {
+        return 0;
+    }
+    struct dirent* entrada;
+    while ((entrada = readdir(diretorio)) != NULL && quantidade < capacidade) {
+        if (strncmp(entrada->d_name, PREFIXO_PAINEL + 1, strlen(PREFIXO_PAINEL) - 1) == 0 &&
+            strlen(entrada->d_name) + 1 < TAMANHO_NOME_PAINEL) {
+            snprintf(nomes[quantidade++], TAMANHO_NOME_PAINEL, "/%s", entrada->d_name);
+        }
+    }
+    closedir(diretorio);
+    return quantidade;
+}
+
+int main(int argc, char* argv[]) {
+    int intervaloMs = 1000;
+    int amostras = 0;
+    int sessoesExibidas = 10;
+    static char nomes[MAX_PAINEIS_MONITOR][TAMANHO_NOME_PAINEL];
+    int quantidadeNomes = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-i") == 0 && i + 1 < argc) {
+            intervaloMs = atoi(argv[++i]) > 0 ? atoi(argv[i]) : 1000;
+        } else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            amostras = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            sessoesExibidas = atoi(argv[++i]);
+        } else if (quantidadeNomes < MAX_PAINEIS_MONITOR) {
+            snprintf(nomes[quantidadeNomes++], TAMANHO_NOME_PAINEL, "%s", argv[i]);
+        }
+    }
+    if (quantidadeNomes == 0) {
+        quantidadeNomes = descobrirPaineis(nomes, MAX_PAINEIS_MONITOR);
+    }
+
+    static PainelMonitorado paineis[MAX_PAINEIS_MONITOR];
+    int quantidadePaineis = 0;
+    uint32_t capacidadeTotal = 0;
+    for (int i = 0; i < quantidadeNomes; i++) {
+        PainelMonitorado* monitoradoPtr = &paineis[quantidadePaineis];
+        if (!abrirPainelEstatisticas(&monitoradoPtr->painel, nomes[i])) {
+            continue;
+        }
+        uint32_t capacidade = monitoradoPtr->painel.cabecalho->capacidade;
+        monitoradoPtr->sessaoAnterior = calloc(capacidade, sizeof(int32_t));
+        monitoradoPtr->opcoesAnteriores = calloc(capacidade, sizeof(uint32_t));
+        monitoradoPtr->jogadasAnteriores = calloc(capacidade, sizeof(int32_t));
+        capacidadeTotal += capacidade;
+        quantidadePaineis++;
+    }
+    if (quantidadePaineis == 0) {
+        fprintf(stderr, "Nenhum painel encontrado (inicie o jogo com --painel %s)\n", PREFIXO_PAINEL);
+        return 1;
+    }
+    EstatisticasPublicadas* sessoes = malloc(sizeof(EstatisticasPublicadas) * (capacidadeTotal + 1));
+
+    uint64_t amostraAnterior = 0;
+    for (int amostra = 0; amostras <= 0 || amostra < amostras; amostra++) {
+        if (amostra > 0) {
+            struct timespec pausa = {intervaloMs / 1000, (long)(intervaloMs % 1000) * 1000000L};
+            nanosleep(&pausa, NULL);
+        }
+        uint64_t agora = instanteDiarioNs(CLOCK_MONOTONIC);
+        int ativas = 0, paradas = 0, inconsistentes = 0;
+        long pontuacaoTotal = 0, jogadas = 0, jogadasPilha = 0, opcoes = 0;
+        long novasOpcoes = 0, novasJogadas = 0, somaNiveis = 0;
+        int maiorPontuacao = 0, maiorNivel = 0, melhorCombo = 0, maiorComboAtual = 0;
+
+        for (int p = 0; p < quantidadePaineis; p++) {
+            PainelMonitorado* monitoradoPtr = &paineis[p];
+            uint32_t usados = atomic_load_explicit(&monitoradoPtr->painel.cabecalho->slotsUsados,
+                                                   memory_order_acquire);
+            if (usados > monitoradoPtr->painel.cabecalho->capacidade) {
+                usados = monitoradoPtr->painel.cabecalho->capacidade;
+            }
+            for (uint32_t slot = 0; slot < usados; slot++) {
+                EstatisticasPublicadas* copiaPtr = &sessoes[ativas];
+                int lido = lerEstatisticasPainel(&monitoradoPtr->painel, (int)slot, copiaPtr);
+                if (lido < 0) {
+                    inconsistentes++;
+                    continue;
+                }
+                if (lido == 0) {
+                    monitoradoPtr->sessaoAnterior[slot] = 0;
+                    continue;
+                }
+                // Vazão só entre duas amostras da mesma sessão no slot
+                if (monitoradoPtr->sessaoAnterior[slot] == copiaPtr->sessao &&
+                    copiaPtr->opcoes >= monitoradoPtr->opcoesAnteriores[slot]) {
+                    novasOpcoes += copiaPtr->opcoes - monitoradoPtr->opcoesAnteriores[slot];
+                    novasJogadas += copiaPtr->totalJogadas - monitoradoPtr->jogadasAnteriores[slot];
+                }
+                monitoradoPtr->sessaoAnterior[slot] = copiaPtr->sessao;
+                monitoradoPtr->opcoesAnteriores[slot] = copiaPtr->opcoes;
+                monitoradoPtr->jogadasAnteriores[slot] = copiaPtr->totalJogadas;
+
+                ativas++;
+                paradas += agora > copiaPtr->atualizadoNs && agora - copiaPtr->atualizadoNs > SESSAO_PARADA_NS;
+                pontuacaoTotal += copiaPtr->pontuacaoTotal;
+                jogadas += copiaPtr->totalJogadas;
+                jogadasPilha += copiaPtr->jogadasDaPilha;
+                opcoes += copiaPtr->opcoes;
+                somaNiveis += copiaPtr->nivelAtual;
+                maiorPontuacao = copiaPtr->pontuacaoTotal > maiorPontuacao ? copiaPtr->pontuacaoTotal : maiorPontuacao;
+                maiorNivel = copiaPtr->nivelAtual > maiorNivel ? copiaPtr->nivelAtual : maiorNivel;
+                melhorCombo = copiaPtr->melhorCombo > melhorCombo ? copiaPtr->melhorCombo : melhorCombo;
+                maiorComboAtual = copiaPtr->comboAtual > maiorComboAtual ? copiaPtr->comboAtual : maiorComboAtual;
+            }
+        }
+
+        double segundos = amostraAnterior != 0 ? (agora - amostraAnterior) * 1e-9 : 0.0;
+        amostraAnterior = agora;
+        printf("=== PAINEL: %d paineis | %d sessoes ativas (%d paradas) ===\n", quantidadePaineis, ativas, paradas);
+        printf("Pontuacao: total %ld | maior %d | nivel medio %.1f (maior %d) | combo atual maximo %d | melhor combo %d\n",
+               pontuacaoTotal, maiorPontuacao, ativas ? (double)somaNiveis / ativas : 0.0, maiorNivel,
+               maiorComboAtual, melhorCombo);
+        printf("Jogadas: %ld (%ld da reserva) | opcoes: %ld", jogadas, jogadasPilha, opcoes);
+        if (segundos > 0.0) {
+            printf(" | %.1f opcoes/s | %.1f jogadas/s", novasOpcoes / segundos, novasJogadas / segundos);
+        }
+        printf("\n");
+        if (inconsistentes > 0) {
+            printf("Slots sem copia consistente: %d (publicador parado no meio?)\n", inconsistentes);
+        }
+
+        int exibidas = ativas < sessoesExibidas ? ativas : sessoesExibidas;
+        if (exibidas > 0) {
+            qsort(sessoes, (size_t)ativas, sizeof(EstatisticasPublicadas), compararPontuacao);
+            printf("  Sessao  Pontuacao  Nivel  Mult.  Combo  Melhor  Jogadas  Opcoes  Conq.  Atualizada\n");
+            for (int i = 0; i < exibidas; i++) {
+                const EstatisticasPublicadas* e = &sessoes[i];
+                printf("  %6d  %9d  %5d  %4.1fx  %5d  %6d  %7d  %6u  %5u  ha %.1f s\n", e->sessao, e->pontuacaoTotal,
+                       e->nivelAtual, e->multiplicadorAtual, e->comboAtual, e->melhorCombo, e->totalJogadas,
+                       e->opcoes, e->conquistas,
+                       agora > e->atualizadoNs ? (agora - e->atualizadoNs) * 1e-9 : 0.0);
+            }
+        }
+        fflush(stdout);
+    }
+
+    for (int p = 0; p < quantidadePaineis; p++) {
+        fecharPainelEstatisticas(&paineis[p].painel);
+        free(paineis[p].sessaoAnterior);
+        free(paineis[p].opcoesAnteriores);
+        free(paineis[p].jogadasAnteriores);
+    }
+    free(sessoes);
+    return 0;
+}
@@ -24,13 +24,13 @@
  * O sistema oferece as seguintes funcionalidades integradas:
  * 
  * @subsection queue_features Fila Circular de Peças
- * - **Capacidade**: 5 peças simultâneas
+ * - **Capacidade**: 5 peças simultâneas (até 4096 por sessão, sem mover as peças ao crescer)
  * - **Operações**: Inserção (enqueue) e remoção (dequeue)
  * - **Algoritmo**: Circular com índices dinâmicos
  * - **Validação**: Controle automático de overflow/underflow
  * 
  * @subsection stack_features Pilha de Reserva
- * - **Capacidade**: 3 peças reservadas
+ * - **Capacidade**: 3 peças reservadas (configurável por sessão)
  * - **Operações**: Empilhamento (push) e desempilhamento (pop)
  * - **Algoritmo**: LIFO (Last In, First Out)
  * - **Estratégia**: Permite reservar peças para uso posterior
@@ -103,7 +103,7 @@
  * }
  * 
  * // Gerar relatório final
- * gerarRelatorioExpert(&expert);
+ * gerarRelatorioExpert(&expert, &tabuleiro, &fila, &pilha);
  * @endcode
  * 
  * @subsection statistics_usage Estatísticas em Tempo Real
@@ -112,7 +112,8 @@
  * while (continuarJogando) {
  *     processarJogadaExpert(peca, origem, &expert);
  *     
- *     // Alertas de performance
+ *     // Alertas de performance (campos derivados exigem sincronizar)
+ *     sincronizarSistemaExpert(&expert);
  *     if (expert.eficienciaReserva < 20) {
  *         printf("💡 Dica: Use mais a reserva!\n");
  *     }
@@ -123,17 +124,37 @@
  * }
  * @endcode
  * 
+ * @subsection combos_usage Padrões de Combo
+ * @code
+ * // Sequências de tipos, classes ([IT] = I ou T, . = qualquer) e repetições
+ * static const PadraoCombo padroes[] = {
+ *     {"Alternancia", "ITIT", 0.3},
+ *     {"Trinca I/T", "[IT]{3}", 0.2},
+ * };
+ * static MotorCombos motor;
+ * compilarMotorCombos(&motor, padroes, 2);
+ * usarMotorCombos(&motor);   // antes de iniciar as partidas
+ * 
+ * processarJogadaExpert(peca, origem, &expert);
+ * uint32_t completos = padroesComboCompletos(&expert); // bit p: padroes[p]
+ * @endcode
+ * 
  * @subsection achievements_usage Sistema de Conquistas
  * @code
- * // Verificação de conquistas desbloqueadas
- * if (expert.melhorCombo >= 10) {
- *     printf("🏆 Conquista: Mestre dos Combos!\n");
- *     expert.conquistasDesbloqueadas |= CONQUISTA_COMBO_MASTER;
- * }
+ * // Conquistas são linhas de uma tabela: condições campo >= limiar
+ * static const RegraConquista regras[] = {
+ *     {"Mestre dos Combos", "Combo 10", {{CAMPO_MELHOR_COMBO, 10}}, 1},
+ *     {"Especialista", "50.000 pontos no nivel 5", {{CAMPO_PONTUACAO_TOTAL, 50000}, {CAMPO_NIVEL, 5}}, 2},
+ * };
+ * MotorConquistas motor;
+ * EstadoConquistas conquistas;
+ * compilarMotorConquistas(&motor, regras, 2);
+ * inicializarConquistas(&conquistas, &motor);
  * 
- * if (expert.pontuacaoTotal >= 50000) {
- *     printf("🏆 Conquista: Especialista em Pontuação!\n");
- *     expert.conquistasDesbloqueadas |= CONQUISTA_SCORE_EXPERT;
+ * // Depois das jogadas: avalia só as regras cujos limiares foram cruzados
+ * avaliarConquistas(&motor, &conquistas, &expert);
+ * for (int i; (i = proximaConquistaDesbloqueada(&conquistas)) >= 0;) {
+ *     printf("🏆 Conquista: %s!\n", regras[i].nome);
  * }
  * @endcode
  * 
@@ -147,10 +168,14 @@
  * 
  * @section compatibility_sec Compatibilidade
  * 
- * - **Compilador**: GCC 4.8+ ou equivalente
- * - **Padrão C**: C99 ou superior
- * - **Plataformas**: Windows, Linux, macOS
- * - **Dependências**: Apenas bibliotecas padrão do C
+ * - **Compilador**: GCC 4.9+ ou Clang 3.6+ (`_Thread_local`, `stdatomic.h`)
+ * - **Padrão C**: C11 com extensões GNU (`-std=gnu11`, o padrão do GCC)
+ * - **Plataformas**: Linux. O servidor de sessões, o diário, o WAL, o
+ *   painel e o modo em tempo real usam POSIX (pthread, `fdatasync`,
+ *   `shm_open`/`mmap`, `fmemopen`, `termios`) e Linux (`timerfd`)
+ * - **Dependências**: libc, pthread e libm: `gcc -O2 -pthread -o tetris tetris.c -lm`
+ * - Os executáveis `tetris.exe` e `tetris_simple.exe` são de versões
+ *   anteriores ao Nível Expert e não são gerados a partir deste arquivo
  * 
  * @author João Santos - Universidade Estácio de Sá
  * @date Janeiro 2025
@@ -161,6 +186,25 @@
 #include <stdlib.h>  // Funções utilitárias (rand, srand, exit)
 #include <time.h>    // Funções de tempo (time para inicialização aleatória)
 #include <math.h>    // Funções matemáticas (pow para cálculos de progressão)
+#include <stdint.h>  // Inteiros de largura fixa (linhas do tabuleiro em bitmask)
+#include <stddef.h>  // offsetof (verificação do layout do Sistema Expert)
+#include <string.h>  // Manipulação de memória (memset, memcpy)
+#include <ctype.h>   // Leitura das consultas do arquivo de partidas
+#include <stdarg.h>  // Argumentos variáveis (imprimirJogo)
+#include <errno.h>   // Mensagens de falha do diário de jogadas
+#include <pthread.h> // Threads do servidor de sessões interativas
+#include <stdatomic.h> // Anéis sem trava do diário de jogadas
+#include <fcntl.h>   // open() do arquivo do diário
+#include <unistd.h>  // write() e fdatasync() do escritor do diário
+#include <sys/mman.h> // shm_open() e mmap() do painel de estatísticas
+#include <sys/stat.h> // fstat() do painel e do corpus de sequências
+#include <sys/timerfd.h> // Relógio dos ticks do motor em tempo real
+#include <poll.h>    // Espera conjunta por tick e teclado
+#include <termios.h> // Teclado sem eco nem linha (modo bruto)
+#include <signal.h>  // Ctrl+C restaura o terminal antes de sair
+#ifdef __SSE2__
+#include <emmintrin.h> // SSE2: avaliação de 8 tabuleiros por instrução
+#endif
 
 // ═══════════════════════════════════════════════════════════════════════════════
 //                              DEFINIÇÕES DE ESTRUTURAS
@@ -186,52 +230,78 @@ typedef struct {
     int id;     // Identificador único e sequencial (1, 2, 3, ...)
 } Peca;
 
+#define CAPACIDADE_PADRAO_FILA 5        ///< Peças na fila pela regra clássica
+#define CAPACIDADE_MAXIMA_FILA 4096     ///< Maior prévia aceita por configurarCapacidadeFila()
+#define BITS_SEGMENTO_FILA 2            ///< log2 das peças por segmento da fila
+#define PECAS_POR_SEGMENTO_FILA (1 << BITS_SEGMENTO_FILA)
+#define SEGMENTOS_EMBUTIDOS_FILA 2      ///< Segmentos dentro da própria fila (cobrem a capacidade padrão)
+
+#define CAPACIDADE_PADRAO_PILHA 3       ///< Peças na reserva pela regra clássica
+#define CAPACIDADE_MAXIMA_PILHA 1024    ///< Maior reserva aceita por configurarCapacidadePilha()
+#define PECAS_EMBUTIDAS_PILHA 4         ///< Posições da pilha dentro da própria estrutura
+#define PECAS_POR_BLOCO_PILHA 16        ///< Posições por bloco extra da pilha
+
 /**
  * @brief Estrutura que implementa uma fila circular para gerenciamento de peças
  * 
  * A fila circular otimiza o uso de memória reutilizando posições do array.
- * Mantém exatamente 5 peças em rotação constante, seguindo o padrão FIFO
- * (First In, First Out - primeiro a entrar, primeiro a sair).
+ * Por padrão mantém 5 peças em rotação constante, seguindo o padrão FIFO
+ * (First In, First Out - primeiro a entrar, primeiro a sair); a capacidade
+ * pode ser aumentada por sessão com configurarCapacidadeFila().
  * 
  * Componentes da estrutura:
- * • pecas[5]: Array fixo que armazena as 5 peças
- * • indiceFrente: Aponta para a próxima peça a ser jogada
- * • indiceTras: Aponta para a posição da última peça inserida
- * • quantidadePecas: Contador atual de peças válidas (0 a 5)
+ * • segmentosEmbutidos: Dois segmentos de 4 peças, suficientes para 5 peças
+ * • diretorio: Anel de ponteiros para segmentos (NULL = só os embutidos)
+ * • posicaoFrente: Posição absoluta da próxima peça a ser jogada
+ * • quantidadePecas: Contador atual de peças válidas (0 a capacidade)
+ * 
+ * A peça na posição absoluta p fica no segmento p >> 2, deslocamento p & 3.
+ * O segmento n ocupa a entrada n % tamanhoDiretorio do diretório, que tem
+ * sempre mais entradas do que segmentos com peças. Crescer a fila só cria
+ * segmentos e reorganiza ponteiros: nenhuma peça é copiada ou movida.
  * 
- * @note A circularidade é implementada usando operação módulo (%)
- * @note Quando cheia, novas inserções sobrescrevem as mais antigas
+ * @note A circularidade é implementada com máscaras (tamanhos potência de 2)
+ * @note Depois de crescer, o diretório aponta para a própria estrutura: a
+ *       fila não pode ser copiada por valor, e liberarFila() devolve a memória
  */
 typedef struct {
-    Peca pecas[5];          // Array circular com capacidade fixa de 5 peças
-    int indiceFrente;       // Índice da frente (próxima peça a jogar)
-    int indiceTras;         // Índice do final (última peça inserida)
-    int quantidadePecas;    // Contador atual de peças válidas (0-5)
+    Peca segmentosEmbutidos[SEGMENTOS_EMBUTIDOS_FILA][PECAS_POR_SEGMENTO_FILA];
+    Peca** diretorio;               // Segmentos por número (NULL = segmentosEmbutidos)
+    Peca* blocos;                   // Cadeia dos blocos de segmentos alocados no crescimento
+    unsigned int posicaoFrente;     // Posição absoluta da frente (próxima peça a jogar)
+    int quantidadePecas;            // Contador atual de peças válidas
+    int capacidade;                 // Máximo de peças (5 por padrão)
+    int tamanhoDiretorio;           // Entradas do diretório (potência de 2)
 } FilaCircular;
 
 /**
  * @brief Estrutura que implementa uma pilha linear para reserva estratégica
  * 
- * A pilha de reserva permite armazenamento temporário de até 3 peças,
- * seguindo o padrão LIFO (Last In, First Out - último a entrar, primeiro a sair).
+ * A pilha de reserva permite armazenamento temporário de peças (3 por
+ * padrão, ajustável com configurarCapacidadePilha()), seguindo o padrão
+ * LIFO (Last In, First Out - último a entrar, primeiro a sair).
  * É utilizada para estratégias avançadas de gerenciamento de peças.
  * 
  * Componentes da estrutura:
- * • pecasReservadas[3]: Array linear para armazenamento das peças
- * • indiceTopo: Índice do topo da pilha (-1 = vazia, 0-2 = posições válidas)
- * • quantidadeReservada: Contador atual de peças reservadas (0 a 3)
+ * • pecasReservadas[4]: Primeiras posições da pilha, dentro da estrutura
+ * • blocos: Blocos de 16 posições para as demais (criados ao crescer)
+ * • indiceTopo: Índice do topo da pilha (-1 = vazia)
+ * • quantidadeReservada: Contador atual de peças reservadas (0 a capacidade)
  * 
  * Operações principais:
  * • Push (empilhar): Adiciona peça no topo, incrementa indiceTopo
  * • Pop (desempilhar): Remove peça do topo, decrementa indiceTopo
  * 
  * @note O índice -1 indica pilha vazia
- * @note Máximo de 3 peças podem ser armazenadas simultaneamente
+ * @note Os blocos nunca mudam de lugar; ao crescer, só o vetor de ponteiros é realocado
  */
 typedef struct {
-    Peca pecasReservadas[3];    // Array linear para até 3 peças reservadas
-    int indiceTopo;             // Índice do topo (-1=vazia, 0-2=válido)
-    int quantidadeReservada;    // Contador atual de peças reservadas (0-3)
+    Peca pecasReservadas[PECAS_EMBUTIDAS_PILHA]; // Posições 0-3 da pilha
+    Peca** blocos;              // Posições 4 em diante, 16 por bloco
+    int quantidadeBlocos;       // Blocos extras já criados
+    int capacidade;             // Máximo de peças reservadas (3 por padrão)
+    int indiceTopo;             // Índice do topo (-1=vazia)
+    int quantidadeReservada;    // Contador atual de peças reservadas
 } PilhaReserva;
 
 /**
@@ -247,786 +317,10964 @@ typedef struct {
  * - Estatísticas completas de performance
  * - Sistema de conquistas e marcos
  * 
+ * Os campos usados a cada jogada ficam juntos na primeira linha de cache
+ * (64 bytes) e o restante na segunda. Recorde, tipo mais jogado,
+ * eficiência, jogadas da fila e pontos para o próximo nível dependem só
+ * dos totais e não são atualizados a cada jogada.
+ *
+ * @invariant Os campos derivados só valem logo após
+ * sincronizarSistemaExpert(). Toda função deste arquivo que os lê
+ * (exibição, relatório, otimização, histórico, checkpoint e replay)
+ * sincroniza antes, ou sincroniza uma cópia quando a estrutura pertence a
+ * outra thread; quem lê os campos diretamente deve fazer o mesmo.
+ * 
  * @author João Santos
  * @version 2.0 - Nível Expert
  */
 typedef struct {
     // ═══════════════════════════════════════════════════════════════
-    //                    SISTEMA DE PONTUAÇÃO
+    //     ESTADO QUENTE (1ª linha de cache: lido e escrito a cada jogada)
     // ═══════════════════════════════════════════════════════════════
+    _Alignas(64) double multiplicadorAtual; ///< Multiplicador de pontos atual (1.0x-10.0x)
+    double fatorDificuldade;     ///< Multiplicador de dificuldade (1.0-3.0)
     int pontuacaoTotal;          ///< Pontuação acumulada total do jogador
     int pontuacaoNivel;          ///< Pontuação no nível atual (reset a cada nível)
-    double multiplicadorAtual;   ///< Multiplicador de pontos atual (1.0x-10.0x)
-    int pontosUltimaJogada;      ///< Pontos ganhos na última jogada
-    
-    // ═══════════════════════════════════════════════════════════════
-    //                    SISTEMA DE COMBOS
-    // ═══════════════════════════════════════════════════════════════
-    int comboAtual;              ///< Sequência atual de combos consecutivos
-    int melhorCombo;             ///< Maior sequência de combos alcançada
-    int totalCombos;             ///< Total de combos realizados na sessão
-    char ultimoTipoJogado;       ///< Último tipo de peça jogada (para combos)
-    int sequenciaTipoAtual;      ///< Sequência atual do mesmo tipo de peça
-    
-    // ═══════════════════════════════════════════════════════════════
-    //                   NÍVEIS DE DIFICULDADE
-    // ═══════════════════════════════════════════════════════════════
-    int nivelAtual;              ///< Nível de dificuldade atual (1-10)
-    int pontosParaProximoNivel;  ///< Pontos necessários para próximo nível
     int limitePontosNivel;       ///< Limite de pontos do nível atual
-    double fatorDificuldade;     ///< Multiplicador de dificuldade (1.0-3.0)
-    
-    // ═══════════════════════════════════════════════════════════════
-    //                  ESTATÍSTICAS AVANÇADAS
-    // ═══════════════════════════════════════════════════════════════
     int totalJogadas;            ///< Total de peças jogadas na sessão
-    int jogadasDaFila;           ///< Peças jogadas diretamente da fila
     int jogadasDaPilha;          ///< Peças jogadas da pilha de reserva
-    int pecasReservadas;         ///< Total de peças que foram reservadas
-    int eficienciaReserva;       ///< Percentual de uso eficiente da reserva
-    
-    // ═══════════════════════════════════════════════════════════════
-    //                 ESTATÍSTICAS POR TIPO
-    // ═══════════════════════════════════════════════════════════════
+    int comboAtual;              ///< Sequência atual de combos consecutivos
+    int sequenciaTipoAtual;      ///< Sequência atual do mesmo tipo de peça
     int contagemTipoI;           ///< Contador de peças tipo 'I' jogadas
     int contagemTipoO;           ///< Contador de peças tipo 'O' jogadas
     int contagemTipoT;           ///< Contador de peças tipo 'T' jogadas
     int contagemTipoL;           ///< Contador de peças tipo 'L' jogadas
-    char tipoMaisJogado;         ///< Tipo de peça mais utilizado
-    
+    char ultimoTipoJogado;       ///< Último tipo de peça jogada
+    uint8_t estadoCombo;         ///< Estado do autômato de combos (MotorCombos)
+    uint8_t regrasPontuacao;     ///< Regras de pontuação e níveis (índice, ver RegrasPontuacao)
+    char livresQuente[1];        ///< Byte livre da linha quente
+
     // ═══════════════════════════════════════════════════════════════
-    //                 CONQUISTAS E MARCOS
+    //     ESTADO FRIO (exibição e eventos raros: subida de nível, combo)
     // ═══════════════════════════════════════════════════════════════
-    int conquistasDesbloqueadas; ///< Bitmask das conquistas obtidas
+    int nivelAtual;              ///< Nível de dificuldade atual (1-10)
+    int melhorCombo;             ///< Maior sequência de combos alcançada
+    int totalCombos;             ///< Total de combos realizados na sessão
     int marcosAlcancados;        ///< Contador de marcos especiais
+    uint32_t conquistasDesbloqueadas; ///< Bitmask das conquistas obtidas (as 32 primeiras regras)
+    int pecasReservadas;         ///< Total de peças que foram reservadas
+    int pontosUltimaJogada;      ///< Pontos ganhos na última jogada
+
+    // Derivados do estado quente: válidos só após sincronizarSistemaExpert()
     int recordePessoal;          ///< Maior pontuação já alcançada
+    int pontosParaProximoNivel;  ///< Pontos necessários para próximo nível
+    int jogadasDaFila;           ///< Peças jogadas diretamente da fila
+    int eficienciaReserva;       ///< Percentual de uso eficiente da reserva
+    char tipoMaisJogado;         ///< Tipo de peça mais utilizado
 } SistemaExpert;
 
+// Uma jogada toca só a primeira linha; o estado frio começa na segunda
+_Static_assert(sizeof(SistemaExpert) == 128, "SistemaExpert deve ocupar duas linhas de cache");
+_Static_assert(_Alignof(SistemaExpert) == 64, "SistemaExpert deve começar em uma linha de cache");
+_Static_assert(offsetof(SistemaExpert, estadoCombo) < 64, "estado quente fora da primeira linha");
+_Static_assert(offsetof(SistemaExpert, nivelAtual) == 64, "estado frio deve começar na segunda linha");
+
+/**
+ * @brief Uma jogada (peça e origem) para processamento em lote
+ */
+typedef struct {
+    Peca peca;                   ///< Peça jogada
+    int origem;                  ///< Origem da peça (0=fila, 1=pilha)
+} JogadaPeca;
+
 // ═══════════════════════════════════════════════════════════════════════════════
-//                              PROTÓTIPOS DAS FUNÇÕES
+//                       REGRAS DE PONTUAÇÃO E NÍVEIS
 // ═══════════════════════════════════════════════════════════════════════════════
 
-// Funções da Fila Circular
-void inicializarFila(FilaCircular* filaPtr);
-int filaVazia(FilaCircular* filaPtr);
-int filaCheia(FilaCircular* filaPtr);
-void inserirPecaNaFila(FilaCircular* filaPtr, Peca novaPeca);
-Peca jogarPecaDaFila(FilaCircular* filaPtr);
-void exibirFila(FilaCircular* filaPtr);
+#define COLUNAS_TIPO_PECA 32            ///< Tabelas por tipo indexadas por tipo & 31 ('I', 'O', ... não colidem)
+#define MAX_REGRAS_PONTUACAO 16         ///< Conjuntos de regras registrados (embutidos + carregados)
+#define TAMANHO_NOME_REGRAS 24
 
-// Funções da Pilha de Reserva
-void inicializarPilha(PilhaReserva* pilhaPtr);
-int pilhaVazia(PilhaReserva* pilhaPtr);
-int pilhaCheia(PilhaReserva* pilhaPtr);
-void reservarPeca(PilhaReserva* pilhaPtr, Peca peca);
-Peca jogarPecaDaPilha(PilhaReserva* pilhaPtr);
-void exibirPilha(PilhaReserva* pilhaPtr);
+/**
+ * @brief Conjuntos de regras compilados no programa
+ *
+ * Têm um caminho especializado em processarJogadaExpert() e
+ * processarLoteJogadasExpert(); os carregados de arquivo recebem os
+ * índices seguintes e usam o mesmo código consultando a tabela.
+ */
+typedef enum {
+    REGRAS_EXPERT,                  ///< Regras originais desta versão
+    REGRAS_CLASSICO,                ///< Pontos e curva de nível da versão simples (tetris_simple.c)
+    NUMERO_REGRAS_EMBUTIDAS
+} RegrasEmbutidas;
 
-// Funções do Sistema Expert
-void inicializarSistemaExpert(SistemaExpert* sistemaPtr);
-int calcularPontuacao(char tipoPeca, SistemaExpert* sistemaPtr);
-double detectarCombo(SistemaExpert* sistemaPtr, char tipoPeca);
-void verificarProgressaoNivel(SistemaExpert* sistemaPtr);
-void processarJogadaExpert(Peca peca, int origem, SistemaExpert* sistemaPtr);
-void exibirEstatisticasExpert(SistemaExpert* sistemaPtr);
-int otimizarSistemaExpert(SistemaExpert* sistemaPtr);
-void gerarRelatorioExpert(SistemaExpert* sistemaPtr);
+/**
+ * @brief Como o limite de pontos cresce a cada nível
+ */
+typedef enum {
+    CURVA_NIVEL_ABSOLUTA,           ///< Nível n termina com limiteInicial * crescimento^(n-1) pontos no total
+    CURVA_NIVEL_POR_NIVEL           ///< Nível n exige limiteInicial * crescimento^(n-1) pontos a partir da subida
+} CurvaNivel;
 
-// Funções Utilitárias
-Peca criarPeca(char tipo, int id);
-void gerarPecasAleatorias(FilaCircular* filaPtr);
-void transferirPecaFilaParaPilha(FilaCircular* filaPtr, PilhaReserva* pilhaPtr);
-void exibirEstadoCompleto(FilaCircular* filaPtr, PilhaReserva* pilhaPtr, SistemaExpert* sistemaPtr);
-void exibirMenu();
-void pausarExecucao();
+/**
+ * @brief Conjunto de regras de pontuação e progressão de nível
+ *
+ * Pontos de uma peça: pontosBase[tipo & 31] * multiplicador * dificuldade
+ * (o bônus de combo vem dos padrões de combo). Ao subir de nível, a
+ * dificuldade e o multiplicador crescem um passo enquanto estiverem
+ * abaixo do máximo.
+ */
+typedef struct {
+    char nome[TAMANHO_NOME_REGRAS];
+    int pontosBase[COLUNAS_TIPO_PECA];  ///< Colunas que não são tipos: peça desconhecida
+    int limiteInicial;                  ///< Pontos do nível 1
+    double crescimentoNivel;            ///< Razão entre os limites de níveis seguidos
+    double passoDificuldade;
+    double maximoDificuldade;
+    double passoMultiplicador;
+    double maximoMultiplicador;
+    uint8_t curvaNivel;                 ///< CurvaNivel
+} RegrasPontuacao;
 
-// Variável global para controle de IDs sequenciais
-int proximoId = 1;
+// ═══════════════════════════════════════════════════════════════════════════════
+//                       PADRÕES DE COMBO (AUTÔMATO)
+// ═══════════════════════════════════════════════════════════════════════════════
+
+#define MAX_PADROES_COMBO 32            ///< Padrões por motor (bits de completos)
+#define MAX_ELEMENTOS_PADRAO_COMBO 16   ///< Peças por padrão, já com as repetições expandidas
+#define MAX_ESTADOS_COMBO 256           ///< Estados do autômato (cabem em estadoCombo)
+
+/**
+ * @brief Padrão de combo: sequência de peças que rende bônus ao terminar
+ *
+ * A expressão é uma sequência de elementos, cada um uma letra de tipo
+ * (I, O, T, S, Z, J, L), '.' (qualquer tipo) ou uma classe como "[IT]",
+ * opcionalmente seguido de uma repetição "{n}". Exemplos: "III",
+ * "ITIT", "[IT]{3}", "S.S".
+ */
+typedef struct {
+    const char* nome;
+    const char* expressao;
+    double bonus;                   ///< Multiplicador = 1 + comboAtual * (soma dos bônus completos)
+} PadraoCombo;
+
+/**
+ * @brief Padrões de combo compilados em um único autômato determinístico
+ *
+ * Cada estado é o conjunto de prefixos de padrões que terminam na última
+ * peça (construção de subconjuntos, como no Aho-Corasick). Avançar é uma
+ * consulta a transicoes[estado][tipo & 31]; os padrões completos e a soma
+ * dos seus bônus ficam pré-calculados por estado, então mais padrões não
+ * custam nada por jogada. Somente leitura depois de compilado.
+ */
+typedef struct {
+    uint8_t transicoes[MAX_ESTADOS_COMBO][COLUNAS_TIPO_PECA];
+    uint32_t completos[MAX_ESTADOS_COMBO]; ///< Bit p: o padrão p termina na peça que levou ao estado
+    double bonus[MAX_ESTADOS_COMBO];       ///< Soma dos bônus dos padrões completos
+    const char* nomes[MAX_PADROES_COMBO];
+    int quantidadePadroes;
+    int quantidadeEstados;
+} MotorCombos;
 
 // ═══════════════════════════════════════════════════════════════════════════════
-//                              IMPLEMENTAÇÃO DAS FUNÇÕES
+//                         TABULEIRO EM BITMASK E JOGADAS
 // ═══════════════════════════════════════════════════════════════════════════════
 
+#define LARGURA_TABULEIRO 10    ///< Número de colunas do campo de jogo
+#define ALTURA_TABULEIRO 24     ///< 20 linhas visíveis + 4 linhas de surgimento
+#define LINHA_COMPLETA 0x03FF   ///< Máscara de uma linha com as 10 colunas ocupadas
+#define NUMERO_TIPOS_PECA 7     ///< Tipos suportados: I, O, T, S, Z, J, L
+#define MAX_JOGADAS 512         ///< Capacidade recomendada do vetor de saída do gerador
+
 /**
- * @brief Inicializa a fila circular
- * @param filaPtr Ponteiro para a estrutura da fila
+ * @brief Campo de jogo representado como uma máscara de bits por linha
+ *
+ * Cada linha é um inteiro de 16 bits onde o bit x indica a coluna x ocupada.
+ * A linha 0 é a base do tabuleiro. Com essa representação, colisão, queda
+ * e limpeza de linhas se reduzem a operações AND/OR sobre poucas palavras.
+ *
+ * @note Os bits 10-15 de cada linha permanecem sempre zerados
  */
-void inicializarFila(FilaCircular* filaPtr) {
-    filaPtr->indiceFrente = 0;
-    filaPtr->indiceTras = 0;
-    filaPtr->quantidadePecas = 0;
-}
+typedef struct {
+    uint16_t linhas[ALTURA_TABULEIRO];  ///< Ocupação de cada linha (bit x = coluna x)
+} Tabuleiro;
 
 /**
- * @brief Verifica se a fila está vazia
- * @param filaPtr Ponteiro para a estrutura da fila
- * @return 1 se vazia, 0 caso contrário
+ * @brief Formato de uma peça em uma rotação específica
+ *
+ * As linhas são relativas à caixa delimitadora da peça: a linha 0 é a base
+ * e o bit 0 corresponde à coluna mais à esquerda da peça.
  */
-int filaVazia(FilaCircular* filaPtr) {
-    return filaPtr->quantidadePecas == 0;
-}
+typedef struct {
+    uint16_t linhas[4];     ///< Máscara de cada linha da peça (base primeiro)
+    unsigned char largura;  ///< Largura da caixa delimitadora
+    unsigned char altura;   ///< Altura da caixa delimitadora
+} FormaPeca;
 
 /**
- * @brief Verifica se a fila está cheia
- * @param filaPtr Ponteiro para a estrutura da fila
- * @return 1 se cheia, 0 caso contrário
+ * @brief Posição final legal de uma peça no tabuleiro
+ *
+ * Produzida pelo gerador de jogadas e consumida por aplicarJogada().
+ * A origem segue a mesma convenção de processarJogadaExpert().
  */
-int filaCheia(FilaCircular* filaPtr) {
-    return filaPtr->quantidadePecas == 5;
-}
+typedef struct {
+    char tipo;                  ///< Tipo da peça posicionada
+    unsigned char rotacao;      ///< Índice da rotação (0-3)
+    unsigned char coluna;       ///< Coluna do canto esquerdo da peça
+    unsigned char linha;        ///< Linha da base da peça
+    unsigned char origem;       ///< 0=fila, 1=pilha de reserva
+    unsigned char viaDeslize;   ///< 1 se exige queda suave + deslize lateral (tuck)
+} Jogada;
 
 /**
- * @brief Insere uma peça na fila
- * @param filaPtr Ponteiro para a estrutura da fila
- * @param novaPeca Peça a ser inserida
+ * @brief Características estruturais de um tabuleiro usadas na avaliação
+ *
+ * Todas são somas por linha de contagens de bits, o que permite extraí-las
+ * para vários tabuleiros em paralelo (uma linha de cada tabuleiro por lane).
  */
-void inserirPecaNaFila(FilaCircular* filaPtr, Peca novaPeca) {
-    if (!filaCheia(filaPtr)) {
-        filaPtr->indiceTras = (filaPtr->indiceTras + 1) % 5;
-        filaPtr->pecas[filaPtr->indiceTras] = novaPeca;
-        filaPtr->quantidadePecas++;
-    }
-}
+typedef struct {
+    int alturaAgregada;     ///< Soma das alturas das 10 colunas
+    int buracos;            ///< Células vazias cobertas por algum bloco
+    int irregularidade;     ///< Soma das diferenças de altura entre colunas vizinhas
+    int pocos;              ///< Soma das profundidades dos poços (colunas cercadas)
+    int transicoesLinha;    ///< Trocas cheio/vazio ao longo das linhas (paredes contam como cheio)
+} CaracteristicasTabuleiro;
 
 /**
- * @brief Remove e retorna uma peça da fila
- * @param filaPtr Ponteiro para a estrutura da fila
- * @return Peça removida
+ * @brief Pesos da avaliação linear de um tabuleiro
+ *
+ * Valores negativos penalizam a característica; pesoLinhas premia as
+ * linhas eliminadas pela jogada que gerou o tabuleiro.
  */
-Peca jogarPecaDaFila(FilaCircular* filaPtr) {
-    Peca peca = {'X', 0}; // Peça vazia por padrão
-    if (!filaVazia(filaPtr)) {
-        peca = filaPtr->pecas[filaPtr->indiceFrente];
-        filaPtr->indiceFrente = (filaPtr->indiceFrente + 1) % 5;
-        filaPtr->quantidadePecas--;
-    }
-    return peca;
-}
+typedef struct {
+    double pesoAltura;
+    double pesoBuracos;
+    double pesoIrregularidade;
+    double pesoPocos;
+    double pesoTransicoes;
+    double pesoLinhas;
+} PesosAvaliacao;
+
+// ═══════════════════════════════════════════════════════════════════════════════
+//                       MEMÓRIA: ARENAS E POOLS DE OBJETOS
+// ═══════════════════════════════════════════════════════════════════════════════
 
 /**
- * @brief Exibe o conteúdo da fila
- * @param filaPtr Ponteiro para a estrutura da fila
+ * @brief Arena de alocação sequencial, esvaziada de uma vez
+ *
+ * Serve memória temporária de uma jogada ou de um quadro: cada bloco é
+ * apenas um avanço de ponteiro e o reinício devolve tudo. O bloco só é
+ * realocado quando um reinício pede mais capacidade do que já existe.
  */
-void exibirFila(FilaCircular* filaPtr) {
-    printf("Fila: ");
-    for (int i = 0; i < filaPtr->quantidadePecas; i++) {
-        int indice = (filaPtr->indiceFrente + i) % 5;
-        printf("%c ", filaPtr->pecas[indice].tipo);
-    }
-    printf("\n");
-}
+typedef struct {
+    unsigned char* memoria;     ///< Bloco contínuo reaproveitado
+    size_t capacidade;          ///< Bytes disponíveis no bloco
+    size_t usado;               ///< Bytes entregues desde o último reinício
+    size_t picoUsado;           ///< Maior valor de usado já atingido
+    size_t alocacoesSistema;    ///< Chamadas a malloc feitas pela arena
+} ArenaMemoria;
 
 /**
- * @brief Inicializa a pilha de reserva
- * @param pilhaPtr Ponteiro para a estrutura da pilha
+ * @brief Pool de objetos de tamanho fixo em blocos (slabs)
+ *
+ * Objetos devolvidos entram em uma lista de livres encadeada dentro deles
+ * mesmos e são reutilizados antes de qualquer novo slab. Objetos de 64
+ * bytes ou mais começam em linha de cache (exigido por SistemaExpert).
+ * Um pool pertence a uma única thread; não há trava.
  */
-void inicializarPilha(PilhaReserva* pilhaPtr) {
-    pilhaPtr->indiceTopo = -1;
-    pilhaPtr->quantidadeReservada = 0;
-}
+typedef struct {
+    size_t tamanhoObjeto;       ///< Tamanho de cada objeto (múltiplo de 16, ou de 64 a partir de 64)
+    int objetosPorSlab;         ///< Objetos criados a cada malloc
+    void* livres;               ///< Lista de objetos livres
+    void* slabs;                ///< Lista de slabs (para liberar o pool)
+    size_t emUso;               ///< Objetos entregues e ainda não devolvidos
+    size_t picoEmUso;           ///< Maior valor de emUso já atingido
+    size_t objetosReservados;   ///< Objetos existentes em todos os slabs
+    size_t alocacoesSistema;    ///< Chamadas a malloc feitas pelo pool
+} PoolObjetos;
+
+// ═══════════════════════════════════════════════════════════════════════════════
+//                              BOT DE BUSCA EM FEIXE
+// ═══════════════════════════════════════════════════════════════════════════════
+
+#define MAX_PREVIA_BOT 255      ///< Peças da fila alcançáveis pela busca (posicaoPrevia é um byte)
+#define MAX_PILHA_BOT 8         ///< Profundidade máxima da reserva representada nos nós
 
 /**
- * @brief Verifica se a pilha está vazia
- * @param pilhaPtr Ponteiro para a estrutura da pilha
- * @return 1 se vazia, 0 caso contrário
+ * @brief Como o gerador escolhe o próximo tipo
  */
-int pilhaVazia(PilhaReserva* pilhaPtr) {
-    return pilhaPtr->quantidadeReservada == 0;
-}
+typedef enum {
+    GERADOR_UNIFORME = 0,   ///< Cada peça sorteada entre os 7 tipos, independente das anteriores
+    GERADOR_SACO_7          ///< Permutações sorteadas dos 7 tipos, uma após a outra
+} ModoGerador;
 
 /**
- * @brief Verifica se a pilha está cheia
- * @param pilhaPtr Ponteiro para a estrutura da pilha
- * @return 1 se cheia, 0 caso contrário
+ * @brief Gerador de peças determinístico por partida
+ *
+ * Ao contrário de rand(), o estado é local: partidas com a mesma semente
+ * produzem a mesma sequência, mesmo rodando em paralelo. O modo e o saco
+ * ocupam o que era alinhamento: o gerador continua com 16 bytes.
  */
-int pilhaCheia(PilhaReserva* pilhaPtr) {
-    return pilhaPtr->quantidadeReservada == 3;
-}
+typedef struct {
+    uint64_t estado;    ///< Estado do xorshift64*
+    int proximoId;      ///< IDs sequenciais das peças desta partida
+    uint8_t modo;       ///< ModoGerador
+    uint8_t saco;       ///< GERADOR_SACO_7: bit t ligado = tipo t ainda no saco
+} GeradorPecas;
+
+#define VERSAO_CORPUS 1
+#define BITS_PECA_CORPUS 3              ///< Tipos 0-6 na ordem de indiceTipoPeca()
+#define PREENCHIMENTO_CORPUS 8          ///< Bytes após os dados (leitura de 2 bytes no fim)
 
 /**
- * @brief Adiciona uma peça à pilha de reserva
- * @param pilhaPtr Ponteiro para a estrutura da pilha
- * @param peca Peça a ser reservada
+ * @brief Cabeçalho de um arquivo de corpus de sequências de peças (64 bytes)
+ *
+ * Seguem o índice, com quantidadeSequencias + 1 posições de peça (uint64_t;
+ * a sequência i vai de indice[i] a indice[i + 1]), e os dados: os tipos de
+ * todas as sequências em BITS_PECA_CORPUS bits cada, do bit menos
+ * significativo para o mais, sem separação entre sequências.
  */
-void reservarPeca(PilhaReserva* pilhaPtr, Peca peca) {
-    if (!pilhaCheia(pilhaPtr)) {
-        pilhaPtr->indiceTopo++;
-        pilhaPtr->pecasReservadas[pilhaPtr->indiceTopo] = peca;
-        pilhaPtr->quantidadeReservada++;
-    }
-}
+typedef struct {
+    char magica[8];                 ///< "TETRISSQ"
+    uint32_t versao;
+    uint32_t bitsPorPeca;
+    uint32_t quantidadeSequencias;
+    uint32_t reservado;
+    uint64_t totalPecas;
+    uint64_t deslocamentoIndice;    ///< Em bytes, desde o início do arquivo
+    uint64_t deslocamentoDados;
+    uint64_t tamanhoArquivo;
+    uint8_t preenchimento[8];
+} CabecalhoCorpus;
 
 /**
- * @brief Remove e retorna uma peça da pilha
- * @param pilhaPtr Ponteiro para a estrutura da pilha
- * @return Peça removida
+ * @brief Corpus de sequências mapeado só para leitura
+ *
+ * Abrir só mapeia o arquivo e confere o cabeçalho: o custo não depende do
+ * número de sequências, e o kernel só lê as páginas que as partidas tocam.
  */
-Peca jogarPecaDaPilha(PilhaReserva* pilhaPtr) {
-    Peca peca = {'X', 0}; // Peça vazia por padrão
-    if (!pilhaVazia(pilhaPtr)) {
-        peca = pilhaPtr->pecasReservadas[pilhaPtr->indiceTopo];
-        pilhaPtr->indiceTopo--;
-        pilhaPtr->quantidadeReservada--;
-    }
-    return peca;
-}
+typedef struct {
+    const unsigned char* mapa;
+    size_t tamanho;
+    const CabecalhoCorpus* cabecalho;
+    const unsigned char* indice;    ///< uint64_t sem garantia de alinhamento (lido com memcpy)
+    const unsigned char* dados;
+} CorpusSequencias;
 
 /**
- * @brief Exibe o conteúdo da pilha
- * @param pilhaPtr Ponteiro para a estrutura da pilha
+ * @brief Posição de leitura em uma sequência do corpus
  */
-void exibirPilha(PilhaReserva* pilhaPtr) {
-    printf("Pilha: ");
-    for (int i = pilhaPtr->indiceTopo; i >= 0; i--) {
-        printf("%c ", pilhaPtr->pecasReservadas[i].tipo);
-    }
-    printf("\n");
-}
+typedef struct {
+    const unsigned char* dados;     ///< Dados do corpus mapeado
+    uint64_t posicao;               ///< Próxima peça (índice global no corpus)
+    uint64_t fim;                   ///< Uma após a última peça da sequência
+    int proximoId;                  ///< IDs sequenciais das peças, como no GeradorPecas
+} CursorCorpus;
 
 /**
- * @brief Inicializa o sistema Expert com valores padrão
- * @param sistemaPtr Ponteiro para a estrutura do sistema Expert
+ * @brief Parâmetros do bot de busca em feixe
  */
-void inicializarSistemaExpert(SistemaExpert* sistemaPtr) {
-    // Inicialização do sistema de pontuação
-    sistemaPtr->pontuacaoTotal = 0;
-    sistemaPtr->multiplicadorAtual = 1.0;
-    sistemaPtr->fatorDificuldade = 1.0;
-    
-    // Inicialização de combos
-    sistemaPtr->comboAtual = 0;
-    sistemaPtr->melhorCombo = 0;
-    sistemaPtr->totalCombos = 0;
-    sistemaPtr->ultimoTipoJogado = 'X';
-    sistemaPtr->sequenciaTipoAtual = 0;
-    
-    // Inicialização dos níveis de dificuldade
-    sistemaPtr->nivelAtual = 1;
-    sistemaPtr->pontosParaProximoNivel = 1000;
-    sistemaPtr->limitePontosNivel = 1000;
-    
-    // Inicialização das estatísticas avançadas
-    sistemaPtr->totalJogadas = 0;
-    sistemaPtr->jogadasDaFila = 0;
-    sistemaPtr->jogadasDaPilha = 0;
-    sistemaPtr->pecasReservadas = 0;
-    sistemaPtr->eficienciaReserva = 0;
-    
-    // Inicialização das estatísticas por tipo de peça
-    sistemaPtr->contagemTipoI = 0;
-    sistemaPtr->contagemTipoO = 0;
-    sistemaPtr->contagemTipoT = 0;
-    sistemaPtr->contagemTipoL = 0;
-    sistemaPtr->tipoMaisJogado = 'I';
-    
-    // Inicialização de combos
-    sistemaPtr->comboAtual = 0;
-    sistemaPtr->melhorCombo = 0;
-    sistemaPtr->totalCombos = 0;
-    sistemaPtr->ultimoTipoJogado = 'X';
-    sistemaPtr->sequenciaTipoAtual = 0;
-    
-    // Inicialização de conquistas e marcos
-    sistemaPtr->conquistasDesbloqueadas = 0;
-    sistemaPtr->marcosAlcancados = 0;
-    sistemaPtr->recordePessoal = 0;
-}
+typedef struct {
+    int larguraFeixe;       ///< Nós mantidos a cada nível da busca
+    int profundidade;       ///< Máximo de ações à frente (limitado às peças conhecidas)
+    double orcamentoMs;     ///< Tempo máximo por jogada em ms (0 = sem limite)
+    int deterministico;     ///< 1 = ignora o relógio; a escolha depende só do estado
+    int capacidadeFila;     ///< Peças na fila nas partidas de executarPartidaBot()
+    int capacidadePilha;    ///< Peças na reserva nas partidas de executarPartidaBot()
+    int regrasPontuacao;    ///< Regras de pontuação das partidas (REGRAS_EXPERT, ...)
+    PesosAvaliacao pesos;   ///< Pesos da avaliação das folhas
+    const CorpusSequencias* corpus; ///< Peças das partidas (NULL = gerador com a semente)
+    int modoGerador;        ///< ModoGerador das partidas sem corpus
+} ConfigBot;
 
 /**
- * @brief Calcula a pontuação base para um tipo de peça
- * @param tipoPeca Tipo da peça jogada
- * @param sistemaPtr Ponteiro para o sistema Expert
- * @return Pontuação calculada
+ * @brief Ações disponíveis para o bot a cada passo
+ */
+typedef enum {
+    ACAO_JOGAR_FILA,    ///< Posiciona a peça da frente da fila
+    ACAO_JOGAR_PILHA,   ///< Posiciona a peça do topo da reserva
+    ACAO_RESERVAR       ///< Transfere a peça da frente da fila para a reserva
+} TipoAcaoBot;
+
+/**
+ * @brief Ação escolhida pelo bot (a jogada só vale para as ações de jogar)
+ */
+typedef struct {
+    TipoAcaoBot tipo;
+    Jogada jogada;
+} AcaoBot;
+
+/**
+ * @brief Nó da busca em feixe
+ *
+ * Guarda apenas o que muda entre as ações: o tabuleiro, a reserva (tipos,
+ * base primeiro) e a posição na prévia de peças conhecidas.
+ */
+typedef struct {
+    Tabuleiro tabuleiro;            ///< Campo após as ações do caminho
+    char pilha[MAX_PILHA_BOT];      ///< Tipos na reserva (índice 0 = base)
+    unsigned char tamanhoPilha;     ///< Peças na reserva
+    unsigned char posicaoPrevia;    ///< Próxima peça da prévia a sair da fila
+    double recompensa;              ///< Linhas eliminadas ao longo do caminho (ponderadas)
+    double nota;                    ///< recompensa + avaliação do tabuleiro
+    AcaoBot primeiraAcao;           ///< Ação na raiz que leva a este nó
+} NoBusca;
+
+/**
+ * @brief Chave de ordenação de um nó candidato (nota e posição de geração)
+ */
+typedef struct {
+    double nota;
+    int indice;
+} ChaveNoBusca;
+
+/**
+ * @brief Resultado de uma partida headless do bot
+ */
+typedef struct {
+    int pecasJogadas;           ///< Peças posicionadas até o fim da partida
+    int linhasEliminadas;       ///< Total de linhas eliminadas
+    int acoesReserva;           ///< Transferências para a reserva
+    double segundos;            ///< Duração da partida
+    SistemaExpert sistema;      ///< Estado final do sistema Expert
+} ResultadoPartida;
+
+/**
+ * @brief Estado de uma partida do bot (o que um quadro-chave de replay guarda)
+ */
+typedef struct {
+    SistemaExpert sistema;
+    FilaCircular fila;
+    PilhaReserva pilha;
+    Tabuleiro tabuleiro;
+    GeradorPecas gerador;
+    CursorCorpus* cursor;       ///< Sequência do corpus (NULL = gerador)
+    int pecasJogadas;
+    int linhasEliminadas;
+    int acoesReserva;
+    uint64_t acoes;             ///< Ações aplicadas (jogadas e reservas)
+} EstadoPartidaBot;
+
+// ═══════════════════════════════════════════════════════════════════════════════
+//                       SIMULAÇÃO EM LOCKSTEP DE VÁRIOS TABULEIROS
+// ═══════════════════════════════════════════════════════════════════════════════
+
+// Uma linha de todas as lanes por registrador: 32 lanes só compensam com
+// AVX-512 e, sem AVX2, vetores maiores que 128 bits viram pares de operações
+#ifndef LANES_LOCKSTEP
+#if defined(__AVX512BW__)
+#define LANES_LOCKSTEP 32       ///< Tabuleiros simulados juntos (8, 16 ou 32)
+#elif defined(__AVX2__)
+#define LANES_LOCKSTEP 16
+#else
+#define LANES_LOCKSTEP 8
+#endif
+#endif
+
+/// Uma linha de cada um dos LANES_LOCKSTEP tabuleiros em um único vetor
+typedef uint16_t VetorLinhas __attribute__((vector_size(LANES_LOCKSTEP * 2)));
+/// Máscara por lane resultante de comparações (-1 = verdadeiro, 0 = falso)
+typedef int16_t VetorMascara __attribute__((vector_size(LANES_LOCKSTEP * 2)));
+
+/**
+ * @brief Resultado final de uma partida simulada em lockstep
+ */
+typedef struct {
+    int pontuacaoTotal;
+    int nivelAtual;
+    int linhasEliminadas;
+    int pecasJogadas;
+    int melhorCombo;
+} ResultadoLockstep;
+
+/**
+ * @brief Lote de tabuleiros avançando em lockstep dentro de registradores vetoriais
+ *
+ * Os tabuleiros e as peças ativas ficam transpostos (linha y de todos os
+ * tabuleiros em um vetor), e a peça ativa é guardada em posição absoluta.
+ * O apoio (colisão ao descer) do passo seguinte sai da mesma varredura que
+ * move as peças, então cada passo percorre as linhas uma única vez.
+ * Assim colisão, queda, fixação e limpeza de linhas valem para todas as
+ * lanes na mesma sequência de instruções, independentemente do tipo de
+ * peça de cada uma; lanes em fim de partida são desligadas por máscara.
+ *
+ * O lote joga uma fila de partidas: a lane cuja partida termina recebe a
+ * próxima da fila no mesmo passo, de modo que as lanes só ficam ociosas
+ * quando a fila acaba, e não à espera da partida mais longa do lote.
+ *
+ * A pontuação segue processarJogadaExpert() com as regras do lote, em
+ * estrutura de arrays (um campo por lane), e só é calculada nas lanes que
+ * fixaram peça no passo, em média pouco mais de uma por passo.
+ */
+typedef struct {
+    VetorLinhas tabuleiro[ALTURA_TABULEIRO];    ///< Blocos fixados
+    VetorLinhas peca[ALTURA_TABULEIRO];         ///< Peça ativa de cada lane
+    VetorLinhas apoio;                          ///< Não nulo nas lanes cuja peça não pode descer
+    VetorMascara ativas;                        ///< -1 nas lanes ainda em jogo
+    int quantidadeAtivas;                       ///< Lanes ainda em jogo
+    int linhaInferior;                          ///< Nenhuma peça ativa abaixo desta linha
+
+    GeradorPecas geradores[LANES_LOCKSTEP];     ///< Sequência de peças de cada lane
+    GeradorPecas politicas[LANES_LOCKSTEP];     ///< Rotação e coluna de cada lane (ver sortearJogadaLockstep)
+    char tipoAtual[LANES_LOCKSTEP];             ///< Tipo da peça ativa
+    int partidaLane[LANES_LOCKSTEP];            ///< Partida da fila jogada em cada lane
+    int limitePecas;                            ///< Peças por partida antes de encerrar (0 = sem limite)
+    int proximaPartida;                         ///< Próxima partida da fila a entrar em uma lane
+    int totalPartidas;                          ///< Tamanho da fila de partidas
+    uint64_t semente;                           ///< A partida p usa semente + p
+    const RegrasPontuacao* regras;              ///< Regras de pontuação de todas as lanes
+    ResultadoLockstep* resultados;              ///< Resultado de cada partida (pode ser NULL)
+    long long pecasTotais;                      ///< Peças fixadas nas partidas já encerradas
+
+    // Sistema Expert por lane (mesmas regras de processarJogadaExpert)
+    int pontuacaoTotal[LANES_LOCKSTEP];
+    int pontuacaoNivel[LANES_LOCKSTEP];
+    double multiplicadorAtual[LANES_LOCKSTEP];
+    double fatorDificuldade[LANES_LOCKSTEP];
+    uint8_t estadoCombo[LANES_LOCKSTEP];
+    int comboAtual[LANES_LOCKSTEP];
+    int melhorCombo[LANES_LOCKSTEP];
+    int nivelAtual[LANES_LOCKSTEP];
+    int limitePontosNivel[LANES_LOCKSTEP];
+
+    int pecasJogadas[LANES_LOCKSTEP];           ///< Peças fixadas na partida da lane
+    int linhasEliminadas[LANES_LOCKSTEP];       ///< Linhas eliminadas na partida da lane
+    long long passos;                           ///< Passos de gravidade executados
+} LoteLockstep;
+
+// ═══════════════════════════════════════════════════════════════════════════════
+//                       CONQUISTAS E MARCOS (TABELA DE REGRAS)
+// ═══════════════════════════════════════════════════════════════════════════════
+
+#define MAX_CONQUISTAS 256              ///< Regras que um motor de conquistas comporta
+#define MAX_CONDICOES_CONQUISTA 2       ///< Condições por regra (todas precisam valer)
+#define CAPACIDADE_EVENTOS_CONQUISTA 16 ///< Desbloqueios aguardando a sessão exibir
+
+/**
+ * @brief Campos do Sistema Expert que as regras de conquista podem consultar
+ *
+ * Todos só crescem durante a partida (desfazer é a exceção), o que permite
+ * indexar as regras pelo limiar de cada campo.
+ */
+typedef enum {
+    CAMPO_PONTUACAO_TOTAL,
+    CAMPO_NIVEL,
+    CAMPO_MELHOR_COMBO,
+    CAMPO_TOTAL_JOGADAS,
+    CAMPO_JOGADAS_DA_FILA,
+    CAMPO_JOGADAS_DA_PILHA,
+    CAMPO_CONTAGEM_I,
+    CAMPO_CONTAGEM_O,
+    CAMPO_CONTAGEM_T,
+    CAMPO_CONTAGEM_L,
+    CAMPO_MARCOS,
+    NUMERO_CAMPOS_CONQUISTA
+} CampoConquista;
+
+/**
+ * @brief Condição de uma regra: campo >= limiar
+ */
+typedef struct {
+    uint8_t campo;                  ///< CampoConquista
+    int limiar;
+} CondicaoConquista;
+
+/**
+ * @brief Linha da tabela de conquistas
+ */
+typedef struct {
+    const char* nome;
+    const char* descricao;
+    CondicaoConquista condicoes[MAX_CONDICOES_CONQUISTA];
+    int quantidadeCondicoes;        ///< 1 a MAX_CONDICOES_CONQUISTA
+} RegraConquista;
+
+/**
+ * @brief Tabela de regras compilada em um índice por campo
+ *
+ * Cada condição de cada regra vira uma entrada do índice do seu campo, e
+ * as entradas de um campo ficam ordenadas pelo limiar. Avaliar um campo é
+ * comparar o valor com o limiar da próxima entrada: só as regras cujo
+ * limiar acabou de ser cruzado são examinadas. Somente leitura depois de
+ * compilado, pode ser compartilhado por todas as sessões e threads.
+ */
+typedef struct {
+    const RegraConquista* regras;
+    int quantidadeRegras;
+    uint16_t* ordem;                ///< Regra de cada entrada do índice
+    int* limiares;                  ///< Limiar de cada entrada do índice
+    int inicioCampo[NUMERO_CAMPOS_CONQUISTA + 1]; ///< Entradas de cada campo: [inicio[c], inicio[c+1])
+} MotorConquistas;
+
+/**
+ * @brief Conquistas de uma partida e desbloqueios ainda não exibidos
+ */
+typedef struct {
+    uint64_t desbloqueadas[MAX_CONQUISTAS / 64];   ///< Bit i: regra i desbloqueada
+    uint16_t cursor[NUMERO_CAMPOS_CONQUISTA];      ///< Próxima entrada do índice de cada campo
+    uint16_t eventos[CAPACIDADE_EVENTOS_CONQUISTA]; ///< Fila circular de regras desbloqueadas
+    uint8_t inicioEventos;
+    uint8_t quantidadeEventos;
+    uint16_t eventosPerdidos;       ///< Desbloqueios que não couberam na fila
+} EstadoConquistas;
+
+// ═══════════════════════════════════════════════════════════════════════════════
+//                       HISTÓRICO DE AÇÕES (DESFAZER/REFAZER)
+// ═══════════════════════════════════════════════════════════════════════════════
+
+#define CAPACIDADE_HISTORICO 256    ///< Ações guardadas; as mais antigas são descartadas
+
+/**
+ * @brief Ações do menu que podem ser desfeitas e refeitas
+ */
+typedef enum {
+    ACAO_HISTORICO_JOGAR_FILA,      ///< Peça jogada da fila
+    ACAO_HISTORICO_JOGAR_PILHA,     ///< Peça jogada da reserva
+    ACAO_HISTORICO_TRANSFERIR,      ///< Peça movida da fila para a reserva
+    ACAO_HISTORICO_GERAR,           ///< Novas peças geradas na fila
+    ACAO_HISTORICO_OTIMIZAR         ///< Ajustes de otimizarSistemaExpert()
+} AcaoHistorico;
+
+/**
+ * @brief Delta reversível de uma ação (120 bytes, contra 280 da fila, reserva e Sistema Expert)
+ *
+ * Os contadores que uma jogada apenas incrementa (jogadas, origem, tipo,
+ * pontuação, nível e marcos) são refeitos ou desfeitos a partir da própria
+ * ação. Os demais campos do Sistema Expert guardam valorAnterior ^ valorNovo:
+ * aplicar o mesmo delta duas vezes volta ao valor original. As conquistas
+ * desbloqueadas na avaliação que segue a ação ficam com ela: desfazer a
+ * ação volta a bloqueá-las e refazer a desbloqueia de novo.
+ */
+typedef struct {
+    Peca peca;                      ///< Peça movida (na geração, a primeira gerada)
+    int pontos;                     ///< Pontos somados por processarJogadaExpert()
+    int xorSequencia;               ///< sequenciaTipoAtual
+    int xorCombo;                   ///< comboAtual
+    int xorMelhorCombo;             ///< melhorCombo
+    int xorRecorde;                 ///< recordePessoal
+    int xorEficiencia;              ///< eficienciaReserva
+    int xorPontosProximoNivel;      ///< pontosParaProximoNivel
+    int xorLimitePontosNivel;       ///< limitePontosNivel
+    uint64_t xorMultiplicador;      ///< Bits de multiplicadorAtual
+    uint64_t xorFator;              ///< Bits de fatorDificuldade
+    uint64_t conquistas[MAX_CONQUISTAS / 64]; ///< Regras desbloqueadas logo após a ação
+    union {
+        struct {
+            Jogada jogada;          ///< Encaixe no tabuleiro (tipo 0 = sem tabuleiro)
+            uint8_t linhasCompletadas; ///< Bit i: linha jogada.linha + i eliminada
+        } encaixe;
+        struct {
+            GeradorPecas gerador;   ///< Gerador antes da geração (estado 0 = rand(), tipos abaixo)
+            uint16_t quantidade;    ///< Peças inseridas (IDs a partir de peca.id)
+            char tipos[5];          ///< Tipos inseridos por gerarPecasAleatorias()
+        } geracao;
+    };
+    uint8_t acao;                   ///< AcaoHistorico
+    uint8_t subiuNivel;             ///< nivelAtual e marcosAlcancados avançaram 1
+    char xorUltimoTipo;             ///< ultimoTipoJogado
+    char xorTipoMaisJogado;         ///< tipoMaisJogado
+    uint8_t xorEstadoCombo;         ///< estadoCombo
+} DeltaHistorico;
+
+/**
+ * @brief Anel de deltas com cursor para desfazer e refazer em O(1)
+ *
+ * Os deltas de índice [0, aplicados) podem ser desfeitos e os de
+ * [aplicados, registrados) podem ser refeitos; uma nova ação descarta
+ * estes últimos. Com o anel cheio o delta mais antigo é sobrescrito.
+ */
+typedef struct {
+    DeltaHistorico deltas[CAPACIDADE_HISTORICO];
+    int inicio;                     ///< Posição do delta mais antigo no anel
+    int aplicados;                  ///< Ações que podem ser desfeitas
+    int registrados;                ///< Ações aplicadas + ações que podem ser refeitas
+} HistoricoAcoes;
+
+// ═══════════════════════════════════════════════════════════════════════════════
+//                       PAINEL DE ESTATÍSTICAS (MEMÓRIA COMPARTILHADA)
+// ═══════════════════════════════════════════════════════════════════════════════
+
+#define PREFIXO_PAINEL "/tetris-painel"    ///< Nomes que os monitores procuram sozinhos
+#define TAMANHO_NOME_PAINEL 64
+#define VERSAO_PAINEL 1
+#define TENTATIVAS_LEITURA_PAINEL 1000      ///< Releituras de um slot antes de desistir
+
+/**
+ * @brief Contadores de uma sessão publicados para monitores externos
+ *
+ * Um slot por linha de cache. Só a thread que executa a sessão escreve;
+ * os leitores, em qualquer processo, copiam o slot e conferem a sequência
+ * (seqlock): ímpar, ou diferente no fim da cópia, indica uma publicação
+ * no meio, e a cópia é refeita. Quem joga nunca espera um leitor.
+ */
+typedef struct {
+    _Alignas(64) _Atomic uint32_t sequencia; ///< Ímpar enquanto a sessão publica
+    int32_t sessao;                 ///< Identificador da sessão (0 = slot livre)
+    int32_t pontuacaoTotal;
+    int32_t recordePessoal;
+    int32_t nivelAtual;
+    int32_t comboAtual;
+    int32_t melhorCombo;
+    int32_t totalCombos;
+    int32_t totalJogadas;
+    int32_t jogadasDaPilha;
+    uint32_t opcoes;                ///< Opções do menu executadas (vazão)
+    uint32_t conquistas;            ///< Conquistas desbloqueadas
+    uint64_t atualizadoNs;          ///< CLOCK_MONOTONIC da última publicação
+    double multiplicadorAtual;
+} EstatisticasPublicadas;
+
+_Static_assert(sizeof(EstatisticasPublicadas) == 64, "EstatisticasPublicadas deve ocupar uma linha de cache");
+_Static_assert(ATOMIC_INT_LOCK_FREE == 2, "o seqlock entre processos precisa de atômicos sem trava");
+
+/**
+ * @brief Início da região compartilhada; os slots vêm logo depois
+ */
+typedef struct {
+    char magico[8];                 ///< "TETRISPN", gravado por último ao criar
+    uint32_t versao;                ///< VERSAO_PAINEL
+    uint32_t tamanhoSlot;           ///< sizeof(EstatisticasPublicadas)
+    uint32_t capacidade;            ///< Slots da região
+    int32_t processo;               ///< pid de quem publica
+    _Atomic uint32_t slotsUsados;   ///< Slots a partir deste nunca foram usados (leitores param aqui)
+    uint32_t reservado;
+    uint64_t criadoNs;              ///< CLOCK_REALTIME da criação
+    char livres[24];
+} CabecalhoPainel;
+
+_Static_assert(sizeof(CabecalhoPainel) == 64, "CabecalhoPainel deve ocupar uma linha de cache");
+
+/**
+ * @brief Painel mapeado neste processo, por quem publica ou por um monitor
+ *
+ * Um processo (o menu ou um servidor de sessões) cria o painel e publica;
+ * monitores o abrem só para leitura. Reservar e liberar slots usa a trava,
+ * publicar não.
+ */
+typedef struct {
+    char nome[TAMANHO_NOME_PAINEL];
+    int descritor;
+    int gravavel;                   ///< 1 = criado aqui: publica e remove o nome ao fechar
+    size_t tamanho;
+    CabecalhoPainel* cabecalho;
+    EstatisticasPublicadas* slots;
+    pthread_mutex_t trava;          ///< Só para reservar e liberar slots
+    uint8_t* ocupados;              ///< Slots em uso por sessões deste processo
+    uint32_t proximoLivre;          ///< Onde começar a procurar um slot livre
+} PainelEstatisticas;
+
+// ═══════════════════════════════════════════════════════════════════════════════
+//                     SESSÕES INTERATIVAS (MÁQUINA DE ESTADOS)
+// ═══════════════════════════════════════════════════════════════════════════════
+
+#define TAMANHO_ENTRADA_SESSAO 16       ///< Maior linha de entrada guardada por evento
+#define TAMANHO_SAIDA_TRABALHADOR 65536 ///< Saída máxima de um passo de sessão
+
+/**
+ * @brief Ponto em que a sessão está suspensa
+ */
+typedef enum {
+    SESSAO_INICIO,                  ///< Boas-vindas ainda não exibidas
+    SESSAO_AGUARDA_OPCAO,           ///< Menu exibido, aguardando a opção
+    SESSAO_AGUARDA_ENTER,           ///< Resultado exibido, aguardando Enter
+    SESSAO_ENCERRADA                ///< Jogador saiu (opção 0)
+} EstadoSessao;
+
+/**
+ * @brief Sessão do menu interativo como máquina de estados
+ *
+ * Guarda tudo o que o laço do menu mantinha em variáveis locais de main().
+ * A sessão suspende retornando de retomarSessao() no ponto em que esperaria
+ * uma entrada e continua dali quando a próxima linha chega. Sem histórico
+ * de desfazer, cada sessão ocupa 512 bytes (8 linhas de cache) enquanto a
+ * fila e a reserva ficarem nas capacidades padrão.
+ */
+typedef struct {
+    SistemaExpert sistema;          ///< Primeiro: começa alinhado à linha de cache
+    FilaCircular fila;
+    PilhaReserva pilha;
+    Tabuleiro tabuleiro;
+    GeradorPecas gerador;           ///< Peças e IDs próprios da sessão
+    EstadoConquistas conquistas;
+    const MotorConquistas* motorConquistas; ///< Regras avaliadas após cada opção
+    HistoricoAcoes* historico;      ///< Desfazer/refazer (NULL = desativado)
+    int identificador;              ///< Número da sessão no servidor
+    uint32_t eventosDiario;         ///< Ações já enviadas ao diário de jogadas
+    uint8_t estado;                 ///< EstadoSessao
+    uint8_t ocupada;                ///< Entrada pendente ou em execução (trava do servidor)
+    uint8_t encaixeAutomatico;      ///< Jogadas encaixam no tabuleiro (encaixeAutomaticoMenu ao iniciar)
+    _Atomic uint32_t versaoEstado;  ///< Ímpar enquanto uma opção altera a sessão (checkpoint)
+    uint64_t sementeInicial;        ///< Semente recebida por iniciarSessao() (WAL)
+    uint64_t lsnWal;                ///< Último registro do WAL aplicado à sessão
+    PainelEstatisticas* painel;     ///< Onde a sessão publica os contadores (NULL = não publica)
+    int32_t slotPainel;
+} SessaoJogo;
+
+/**
+ * @brief Entrada de um jogador aguardando um trabalhador
+ */
+typedef struct {
+    SessaoJogo* sessao;
+    char entrada[TAMANHO_ENTRADA_SESSAO];
+} EventoSessao;
+
+/// Recebe o texto produzido por um passo da sessão (chamada na thread trabalhadora)
+typedef void (*EntregaSaidaSessao)(void* contexto, SessaoJogo* sessaoPtr, EstadoSessao estado,
+                                   const char* texto, size_t tamanho);
+
+/**
+ * @brief Poucas threads atendendo muitas sessões suspensas
+ *
+ * Cada sessão tem no máximo um evento na fila (campo ocupada), então
+ * passos de uma mesma sessão nunca rodam em paralelo nem fora de ordem.
+ */
+typedef struct {
+    pthread_t* threads;
+    int numeroThreads;
+    pthread_mutex_t trava;
+    pthread_cond_t temEvento;
+    EventoSessao* eventos;          ///< Fila circular de entradas
+    int capacidade;
+    int inicio;
+    int quantidade;
+    int encerrando;
+    EntregaSaidaSessao entregarSaida;
+    void* contexto;
+} ServidorSessoes;
+
+// ═══════════════════════════════════════════════════════════════════════════════
+//                       DIÁRIO DE JOGADAS (ESCRITA ASSÍNCRONA)
+// ═══════════════════════════════════════════════════════════════════════════════
+
+#define CAPACIDADE_ANEL_DIARIO 4096         ///< Eventos por anel (potência de 2)
+#define MAX_ANEIS_DIARIO 64                 ///< Threads que podem registrar eventos em um diário
+#define TAMANHO_BLOCO_DIARIO (64 * 1024)    ///< Maior escrita sequencial do escritor
+#define PAUSA_ESCRITOR_DIARIO_US 500        ///< Espera do escritor quando os anéis estão vazios
+
+/**
+ * @brief Quando o escritor força os dados do diário para o disco
+ */
+typedef enum {
+    SYNC_DIARIO_NUNCA,              ///< Só write(); o sistema operacional decide
+    SYNC_DIARIO_GRUPO,              ///< fdatasync() no máximo a cada intervaloSyncMs (group commit)
+    SYNC_DIARIO_SEMPRE              ///< fdatasync() depois de cada escrita
+} PoliticaSyncDiario;
+
+/**
+ * @brief Registro de 32 bytes de uma ação, gravado como está no arquivo
+ */
+typedef struct {
+    uint64_t instanteNs;            ///< CLOCK_REALTIME da ação
+    int32_t sessao;                 ///< Identificador da sessão
+    uint32_t sequencia;             ///< Ordem da ação na sessão (a partir de 0)
+    int32_t pontuacaoTotal;         ///< Depois da ação
+    int32_t idPeca;                 ///< Peça envolvida (-1 = nenhuma)
+    uint16_t nivel;                 ///< Depois da ação
+    uint8_t acao;                   ///< AcaoHistorico
+    int8_t sentido;                 ///< 1 = feita ou refeita, -1 = desfeita
+    char tipoPeca;                  ///< '\0' = nenhuma
+    uint8_t reservado[3];
+} EventoDiario;
+
+_Static_assert(sizeof(EventoDiario) == 32, "EventoDiario deve ter 32 bytes");
+
+/**
+ * @brief Anel de um produtor e do escritor (um escreve, outro lê)
+ *
+ * Os índices só crescem; cada um fica na sua linha de cache para que o
+ * produtor e o escritor não disputem a mesma linha.
+ */
+typedef struct {
+    _Alignas(64) _Atomic uint64_t escrita;  ///< Próximo evento = eventos aceitos (só o produtor escreve)
+    uint64_t leituraConhecida;              ///< Última leitura vista pelo produtor
+    _Atomic uint64_t descartados;           ///< Eventos recusados com o anel cheio
+    _Alignas(64) _Atomic uint64_t leitura;  ///< Próximo evento a gravar (só o escritor escreve)
+    _Alignas(64) EventoDiario eventos[CAPACIDADE_ANEL_DIARIO];
+} AnelDiario;
+
+/**
+ * @brief Métricas de um diário (cópia lida por lerMetricasDiario())
+ */
+typedef struct {
+    uint64_t eventosRegistrados;    ///< Aceitos pelos anéis
+    uint64_t eventosDescartados;    ///< Recusados (anel cheio ou threads demais)
+    uint64_t eventosEscritos;       ///< Já entregues ao arquivo
+    uint64_t bytesEscritos;
+    uint64_t escritas;              ///< Chamadas a write()
+    uint64_t sincronizacoes;        ///< Chamadas a fdatasync()
+    uint64_t profundidadeAtual;     ///< Eventos nos anéis na última varredura do escritor
+    uint64_t profundidadeMaxima;
+    uint64_t latenciaEscritaTotalNs;
+    uint64_t latenciaEscritaMaximaNs;
+    uint64_t latenciaSyncTotalNs;
+    uint64_t latenciaSyncMaximaNs;
+} MetricasDiario;
+
+/**
+ * @brief Diário de jogadas gravado por uma thread de fundo
+ *
+ * Quem joga só copia o evento para o anel da sua thread, sem trava nem
+ * chamada de sistema; o escritor esvazia os anéis em blocos de até
+ * TAMANHO_BLOCO_DIARIO e aplica a política de sincronização. Com o anel
+ * cheio o evento é descartado e contado, nunca espera o disco.
+ */
+typedef struct {
+    int descritor;
+    uint8_t politicaSync;           ///< PoliticaSyncDiario
+    int intervaloSyncMs;            ///< Janela do group commit
+    uint64_t identificador;         ///< Distingue diários reabertos no mesmo endereço
+    pthread_t escritor;
+    pthread_mutex_t trava;          ///< Só para registrar o anel de uma thread nova
+    AnelDiario* aneis[MAX_ANEIS_DIARIO];
+    _Atomic int quantidadeAneis;
+    _Atomic int encerrar;
+    _Atomic uint64_t descartadosFora; ///< Threads além de MAX_ANEIS_DIARIO ou falha de escrita
+    uint64_t registradosFechados;   ///< Totais dos anéis liberados por fecharDiario()
+    uint64_t descartadosFechados;
+    char* bloco;                    ///< Buffer das escritas (do escritor)
+
+    // Métricas do escritor (escritas só por ele, lidas por qualquer thread)
+    _Atomic uint64_t eventosEscritos;
+    _Atomic uint64_t bytesEscritos;
+    _Atomic uint64_t escritas;
+    _Atomic uint64_t sincronizacoes;
+    _Atomic uint64_t profundidadeAtual;
+    _Atomic uint64_t profundidadeMaxima;
+    _Atomic uint64_t latenciaEscritaTotalNs;
+    _Atomic uint64_t latenciaEscritaMaximaNs;
+    _Atomic uint64_t latenciaSyncTotalNs;
+    _Atomic uint64_t latenciaSyncMaximaNs;
+} DiarioJogadas;
+
+// ═══════════════════════════════════════════════════════════════════════════════
+//                       LOG DE ESCRITA ANTECIPADA (WAL) E CHECKPOINTS
+// ═══════════════════════════════════════════════════════════════════════════════
+
+#define CAPACIDADE_LOTE_WAL 4096            ///< Registros acumulados enquanto o líder sincroniza
+#define TAMANHO_CAMINHO_WAL 256
+#define INTERVALO_CHECKPOINT_PADRAO 1000    ///< Opções entre checkpoints no menu
+
+/**
+ * @brief Tipos de registro do WAL
+ */
+typedef enum {
+    WAL_ABRIR_SESSAO,               ///< Sessão criada (semente, capacidades, regras, encaixe)
+    WAL_OPCAO,                      ///< Opção do menu que alterou a sessão
+    WAL_FECHAR_SESSAO               ///< Jogador saiu; a sessão não é recuperada
+} TipoRegistroWal;
+
+/**
+ * @brief Registro de 32 bytes do WAL, protegido por CRC-32C
+ *
+ * O WAL é lógico: guarda a opção executada, não os bytes alterados. Fila,
+ * reserva, tabuleiro e gerador são determinísticos, então reaplicar as
+ * opções a partir do checkpoint reproduz a sessão exatamente.
+ */
+typedef struct {
+    uint32_t crc;                   ///< CRC-32C dos 28 bytes seguintes
+    int32_t sessao;                 ///< Identificador da sessão
+    uint64_t lsn;                   ///< Número de sequência global (cresce a cada registro)
+    uint64_t semente;               ///< WAL_ABRIR_SESSAO: semente inicial
+    uint16_t capacidadeFila;        ///< WAL_ABRIR_SESSAO
+    uint16_t capacidadePilha;       ///< WAL_ABRIR_SESSAO
+    uint8_t tipo;                   ///< TipoRegistroWal
+    union {
+        uint8_t opcao;              ///< WAL_OPCAO: opção do menu
+        uint8_t encaixeAutomatico;  ///< WAL_ABRIR_SESSAO: jogadas encaixam no tabuleiro
+    };
+    uint8_t regras;                 ///< WAL_ABRIR_SESSAO: índice das regras de pontuação
+    uint8_t comHistorico;           ///< WAL_ABRIR_SESSAO: sessão com desfazer/refazer
+} RegistroWal;
+
+_Static_assert(sizeof(RegistroWal) == 32, "RegistroWal deve ter 32 bytes");
+
+/**
+ * @brief WAL em segmentos numerados, com group commit
+ *
+ * Os registros entram em um lote em memória. Quem precisa da durabilidade
+ * (aguardarWal()) e não encontra um líder sincronizando vira o líder: grava
+ * o lote inteiro com um write() e um fdatasync(), enquanto os demais
+ * acumulam o próximo lote ou esperam. Um fdatasync cobre todas as jogadas
+ * que chegaram durante o anterior.
+ *
+ * Arquivos: caminho.000001, caminho.000002, ... (segmentos) e caminho.ckpt.
+ */
+typedef struct {
+    char caminho[TAMANHO_CAMINHO_WAL];
+    int descritor;
+    uint32_t segmento;              ///< Segmento aberto para escrita
+    uint32_t primeiroSegmento;      ///< Segmento mais antigo ainda necessário
+    pthread_mutex_t trava;
+    pthread_cond_t sincronizado;
+    RegistroWal* lote;              ///< Registros ainda não entregues ao arquivo
+    RegistroWal* loteLider;         ///< Lote sendo gravado pelo líder
+    int quantidadeLote;
+    int liderAtivo;
+    int falhou;                     ///< write() ou fdatasync() falhou: nada mais é durável
+    uint64_t proximoLsn;
+    uint64_t lsnDuravel;            ///< Registros até aqui sobrevivem a uma queda
+
+    // Métricas (protegidas pela trava)
+    uint64_t registros;
+    uint64_t sincronizacoes;
+    int maiorGrupo;                 ///< Mais registros em um único fdatasync
+    uint64_t checkpoints;
+    uint64_t bytesUltimoCheckpoint;
+    uint64_t nsCopiaCheckpoints;    ///< Cópia das sessões, CRC e write() de todos os checkpoints
+    uint64_t nsSincronizacaoCheckpoints; ///< fdatasync(), rename() e remoção dos segmentos
+} WalSessoes;
+
+/**
+ * @brief Resultado de recuperarSessoesWal()
+ */
+typedef struct {
+    int sessoes;                    ///< Sessões abertas recuperadas
+    int sessoesCheckpoint;          ///< Sessões carregadas do checkpoint
+    long registrosReaplicados;      ///< Opções reexecutadas a partir do WAL
+    uint32_t primeiroSegmento;      ///< Para abrirWal()
+    uint32_t proximoSegmento;
+    uint64_t proximoLsn;
+    double segundos;
+} ResultadoRecuperacaoWal;
+
+// ═══════════════════════════════════════════════════════════════════════════════
+//                       MOTOR EM TEMPO REAL (PASSO FIXO)
+// ═══════════════════════════════════════════════════════════════════════════════
+
+#define TICKS_POR_SEGUNDO_PADRAO 60         ///< Passos da simulação por segundo de jogo
+#define UNIDADE_GRAVIDADE 65536             ///< Gravidade em ponto fixo: 1 linha por tick
+#define GRAVIDADE_MAXIMA (20 * UNIDADE_GRAVIDADE) ///< 20G: a peça chega ao chão no tick em que surge
+#define ATRASO_FIXACAO_MS 500               ///< Tempo apoiada antes de fixar
+#define MAX_ADIAMENTOS_FIXACAO 15           ///< Movimentos apoiada que reiniciam o atraso de fixação
+#define MAX_TICKS_POR_ACORDAR 64            ///< Ticks atrasados executados antes de olhar o teclado de novo
+#define CAPACIDADE_LATENCIAS 65536          ///< Amostras de latência guardadas (as mais recentes)
+#define TAMANHO_TELA_TEMPO_REAL 8192
+
+/**
+ * @brief Comandos do jogador (teclado ou piloto)
+ */
+typedef enum {
+    COMANDO_NENHUM,
+    COMANDO_ESQUERDA,
+    COMANDO_DIREITA,
+    COMANDO_GIRAR,
+    COMANDO_QUEDA_SUAVE,            ///< Uma linha para baixo
+    COMANDO_QUEDA_RAPIDA,           ///< Até o chão, fixando na hora
+    COMANDO_RESERVAR,               ///< A peça ativa da fila vai para a reserva
+    COMANDO_USAR_RESERVA,           ///< Alterna a peça ativa entre a fila e o topo da reserva
+    COMANDO_SAIR
+} ComandoTempoReal;
+
+/**
+ * @brief Partida com gravidade, avançada em passos fixos (ticks)
+ *
+ * A simulação só conhece ticks: o relógio de parede decide quando eles
+ * acontecem, não o que acontece neles. Os mesmos comandos nos mesmos
+ * ticks levam à mesma partida em velocidade humana ou acelerada.
+ */
+typedef struct {
+    SistemaExpert sistema;          ///< Primeiro: começa alinhado à linha de cache
+    FilaCircular fila;
+    PilhaReserva pilha;
+    Tabuleiro tabuleiro;
+    GeradorPecas gerador;
+    Jogada ativa;                   ///< Peça caindo (linha = base atual; origem 0=fila, 1=reserva)
+    uint32_t gravidade;             ///< Linhas por tick em UNIDADE_GRAVIDADE (curva de nível)
+    uint32_t acumuladorQueda;
+    int ticksPorSegundo;
+    int ticksFixacao;               ///< ATRASO_FIXACAO_MS em ticks
+    int ticksApoiada;
+    int adiamentosFixacao;
+    uint64_t tick;
+    int pecasSurgidas;              ///< Muda a cada peça nova (não ao alternar com a reserva)
+    int pecasJogadas;
+    int linhasEliminadas;
+    uint8_t encerrada;              ///< A peça nova não coube ou o jogador saiu
+    uint8_t alterada;               ///< Mudou desde o último desenho
+} PartidaTempoReal;
+
+/**
+ * @brief Como executarPartidaTempoReal() conduz a partida
+ */
+typedef struct {
+    double velocidade;              ///< Ticks simulados por tick de relógio (1 = humano, 0 = sem limite)
+    int desenhar;                   ///< Desenha no terminal (ANSI) quando a partida muda
+    int teclado;                    ///< Lê comandos da entrada padrão (modo bruto se for terminal)
+    int piloto;                     ///< O bot joga, no máximo um comando por tick
+    int limitePecas;                ///< 0 = até o fim da partida
+    uint64_t limiteTicks;           ///< 0 = sem limite
+    ConfigBot configBot;            ///< Busca usada pelo piloto
+} ConfigTempoReal;
+
+/**
+ * @brief Medidas de uma execução de executarPartidaTempoReal()
+ */
+typedef struct {
+    double segundosReais;
+    double segundosSimulados;       ///< Ticks / ticksPorSegundo
+    uint64_t ticksAtrasados;        ///< Ticks cujo instante passou sem acordar (recuperados em lote)
+    double atrasoMedioUs;           ///< Acordar depois do instante do tick (só com relógio)
+    double atrasoMaximoUs;
+    long desenhos;
+    long comandos;
+    int amostrasLatencia;           ///< Comandos cujo efeito chegou à tela
+    double latenciaP50Us;           ///< Do comando lido até a tela escrita
+    double latenciaP99Us;
+    double latenciaMaximaUs;
+} ResultadoTempoReal;
+
+// ═══════════════════════════════════════════════════════════════════════════════
+//                       SEQUÊNCIA DIFUNDIDA (SALAS COMPETITIVAS)
+// ═══════════════════════════════════════════════════════════════════════════════
+
+#define BITS_SEGMENTO_DIFUSAO 8         ///< log2 das peças por segmento da sequência difundida
+#define PECAS_POR_SEGMENTO_DIFUSAO (1 << BITS_SEGMENTO_DIFUSAO)
+
+/**
+ * @brief Bloco de peças da sequência difundida
+ */
+typedef struct SegmentoDifusao {
+    struct SegmentoDifusao* proximoLivre;   ///< Encadeamento na lista de livres
+    Peca pecas[PECAS_POR_SEGMENTO_DIFUSAO];
+} SegmentoDifusao;
+
+/**
+ * @brief Posição de leitura de um jogador (uma linha de cache por jogador)
+ */
+typedef struct {
+    _Alignas(64) _Atomic uint64_t posicao;  ///< Próxima peça do jogador (só a thread dele escreve)
+    _Atomic int ativo;
+    int janela;                             ///< Peças de prévia além da próxima
+} CursorDifusao;
+
+/**
+ * @brief Uma sequência de peças compartilhada por todos os jogadores de uma sala
+ *
+ * Um só produtor sorteia as peças e as publica em segmentos apontados por
+ * um diretório circular; cada jogador só tem um cursor. Ler é sem trava:
+ * a peça p está publicada se p < publicadas. O produtor recicla um segmento
+ * quando todos os cursores ativos já passaram dele (o cursor mais atrasado
+ * é o marco, como uma época). Registrar e retirar jogadores usa a trava,
+ * que o produtor também segura enquanto recicla.
+ */
+typedef struct {
+    _Alignas(64) _Atomic uint64_t publicadas;  ///< Peças já produzidas
+    GeradorPecas gerador;                  ///< Só o produtor usa
+    SegmentoDifusao** diretorio;           ///< Segmento n na entrada n % capacidadeDiretorio
+    int capacidadeDiretorio;               ///< Potência de 2
+    uint64_t primeiroSegmento;             ///< Segmento retido mais antigo
+    SegmentoDifusao* livres;               ///< Segmentos reciclados, prontos para reuso
+    CursorDifusao* cursores;
+    int capacidadeCursores;
+    int cursoresUsados;                    ///< Maior índice já registrado + 1
+    pthread_mutex_t trava;                 ///< Registro de jogadores x reciclagem
+    int segmentosEmUso;
+    int picoSegmentos;
+    int segmentosAlocados;                 ///< Chamadas a malloc
+    uint64_t segmentosReciclados;
+} SequenciaDifundida;
+
+// ═══════════════════════════════════════════════════════════════════════════════
+//                       TORNEIO PARALELO (BOTS x SEQUÊNCIAS)
+// ═══════════════════════════════════════════════════════════════════════════════
+
+/**
+ * @brief Configuração do bot inscrita no torneio
+ */
+typedef struct {
+    char nome[32];
+    ConfigBot config;
+} ParticipanteTorneio;
+
+/**
+ * @brief Resultado de uma partida participante x sequência
+ */
+typedef struct {
+    int pontuacao;
+    int pecasJogadas;
+    int linhasEliminadas;
+    int nivel;
+    int melhorCombo;
+    int trabalhador;                ///< Thread que jogou a partida
+    double segundos;                ///< Tempo de parede da partida
+} ResultadoJogoTorneio;
+
+/**
+ * @brief Fila de partidas de uma thread: a dona tira do fim, as outras roubam do início
+ */
+typedef struct {
+    pthread_mutex_t trava;
+    int* tarefas;
+    int inicio;
+    int fim;
+} FilaTarefasTorneio;
+
+/**
+ * @brief Torneio: todas as combinações de participantes e sequências
+ *
+ * A partida k é do participante k / quantidadeSequencias com a sequência
+ * k % quantidadeSequencias (semente sementeBase + sequência, ou a sequência
+ * do corpus de cada participante). resultados tem uma posição por partida.
+ */
+typedef struct {
+    const ParticipanteTorneio* participantes;
+    int quantidadeParticipantes;
+    int quantidadeSequencias;
+    uint64_t sementeBase;
+    int limitePecas;
+    ResultadoJogoTorneio* resultados;
+    FilaTarefasTorneio* filas;      ///< Uma por thread durante executarTorneio()
+    int numeroThreads;
+    _Atomic long roubos;            ///< Partidas jogadas por outra thread que não a dona
+    double segundos;                ///< Tempo de parede do torneio
+} Torneio;
+
+// ═══════════════════════════════════════════════════════════════════════════════
+//                       AJUSTE DE PESOS (ALGORITMO GENÉTICO)
+// ═══════════════════════════════════════════════════════════════════════════════
+
+#define GENES_AJUSTE 6              ///< Um gene por campo de PesosAvaliacao
+#define MAX_POPULACAO_AJUSTE 256
+#define VERSAO_AJUSTE 1
+
+/**
+ * @brief Parâmetros do ajuste de pesos
+ */
+typedef struct {
+    int tamanhoPopulacao;
+    int elite;                      ///< Melhores que passam intactos para a geração seguinte
+    int quantidadeSequencias;       ///< Sequências que todos jogam em cada geração
+    int limitePecas;
+    int geracoes;                   ///< Total de gerações (contando as de um checkpoint)
+    int numeroThreads;
+    uint64_t semente;               ///< Sementes das sequências e do sorteio do algoritmo
+    double sigmaInicial;            ///< Desvio da mutação na primeira geração
+    double decaimentoSigma;         ///< Fator aplicado ao desvio a cada geração
+    double pesoPontuacao;           ///< Aptidão = pesoPontuacao x pontuação
+    double pesoNivel;               ///<         + pesoNivel x nível
+    double pesoCombo;               ///<         + pesoCombo x melhor combo
+    ConfigBot base;                 ///< Bot de todos os indivíduos, menos os pesos
+} ConfigAjuste;
+
+/**
+ * @brief Estado do ajuste entre gerações, gravado como está no checkpoint
+ */
+typedef struct {
+    char magica[8];                 ///< "TETRISGA"
+    uint32_t versao;
+    uint32_t tamanhoPopulacao;
+    uint32_t quantidadeSequencias;
+    uint32_t geracao;               ///< Gerações já jogadas
+    uint64_t semente;
+    uint64_t estadoSorteio;         ///< Sorteio de seleção, cruzamento e mutação
+    double sigma;
+    double aptidaoMelhor;           ///< Aptidão do melhor da última geração
+    PesosAvaliacao melhor;
+    uint64_t partidasJogadas;
+    double segundosJogando;
+    PesosAvaliacao populacao[MAX_POPULACAO_AJUSTE];
+} EstadoAjuste;
+
+/**
+ * @brief Resumo de uma geração
+ */
+typedef struct {
+    double melhorAptidao;
+    double aptidaoMedia;
+    PesosAvaliacao melhor;
+    long partidas;
+    double segundos;                ///< Tempo de parede das partidas
+    int numeroThreads;
+} RelatorioGeracaoAjuste;
+
+// ═══════════════════════════════════════════════════════════════════════════════
+//                       REPLAYS COM QUADROS-CHAVE
+// ═══════════════════════════════════════════════════════════════════════════════
+
+#define VERSAO_REPLAY 1
+#define INTERVALO_QUADROS_PADRAO 4096   ///< Ações entre dois quadros-chave
+#define MARCA_QUADRO_REPLAY 0xFF        ///< Primeiro byte de um quadro-chave (ações usam 0-2)
+
+/**
+ * @brief Cabeçalho de 64 bytes de um arquivo de replay
+ *
+ * O arquivo é uma sequência de registros de 8 bytes (ações) intercalada
+ * com quadros-chave (estado completo antes da ação de mesmo número) a
+ * cada intervaloQuadros ações, e termina com o índice dos quadros e um
+ * RodapeReplay. As regras e os padrões de combo precisam ser os mesmos da
+ * gravação (os embutidos, ou os mesmos --arquivo-regras e --combos).
+ */
+typedef struct {
+    char magica[8];                 ///< "TETRISRP"
+    uint32_t versao;
+    uint32_t intervaloQuadros;
+    uint64_t semente;
+    int32_t capacidadeFila;
+    int32_t capacidadePilha;
+    uint8_t regrasPontuacao;
+    uint8_t modoGerador;
+    uint8_t reservado[30];
+} CabecalhoReplay;
+
+_Static_assert(sizeof(CabecalhoReplay) == 64, "CabecalhoReplay deve ter 64 bytes");
+
+/**
+ * @brief Uma ação do bot no arquivo (AcaoBot em 8 bytes)
+ */
+typedef struct {
+    uint8_t acao;                   ///< TipoAcaoBot (MARCA_QUADRO_REPLAY = quadro-chave)
+    char tipo;
+    uint8_t rotacao;
+    uint8_t coluna;
+    uint8_t linha;
+    uint8_t origem;
+    uint8_t viaDeslize;
+    uint8_t reservado;
+} RegistroAcaoReplay;
+
+_Static_assert(sizeof(RegistroAcaoReplay) == 8, "RegistroAcaoReplay deve ter 8 bytes");
+
+/**
+ * @brief Parte fixa de um quadro-chave
+ *
+ * Seguem: SistemaExpert, Tabuleiro, GeradorPecas, as peças da fila (da
+ * frente para o fim) e as da reserva (da base para o topo). Todas as
+ * partes têm tamanho múltiplo de 8, e as ações seguintes continuam
+ * alinhadas.
+ */
+typedef struct {
+    uint8_t marca;                  ///< MARCA_QUADRO_REPLAY
+    uint8_t reservado[3];
+    uint32_t tamanho;               ///< Bytes do quadro inteiro, esta parte incluída
+    uint64_t jogada;                ///< Ações aplicadas antes do quadro
+    int32_t quantidadeFila;
+    int32_t quantidadePilha;
+    int32_t pecasJogadas;
+    int32_t linhasEliminadas;
+    int32_t acoesReserva;
+    uint32_t reservado2;
+} QuadroChaveReplay;
+
+/**
+ * @brief Entrada do índice: onde fica o quadro-chave de uma jogada
+ */
+typedef struct {
+    uint64_t jogada;
+    uint64_t deslocamento;
+} EntradaIndiceReplay;
+
+/**
+ * @brief Últimos 32 bytes do arquivo
+ */
+typedef struct {
+    char magica[8];                 ///< "TETRISIX"
+    uint64_t quantidadeQuadros;
+    uint64_t deslocamentoIndice;
+    uint64_t totalJogadas;          ///< Ações gravadas
+} RodapeReplay;
+
+/**
+ * @brief Gravação de um replay em andamento
+ */
+typedef struct {
+    FILE* arquivo;
+    uint32_t intervaloQuadros;
+    uint64_t jogadas;               ///< Ações já gravadas
+    uint64_t deslocamento;          ///< Bytes já gravados
+    EntradaIndiceReplay* indice;
+    size_t quantidadeIndice;
+    size_t capacidadeIndice;
+    int falhou;
+} GravadorReplay;
+
+/**
+ * @brief Replay aberto para leitura (mapeado com mmap)
+ */
+typedef struct {
+    const unsigned char* mapa;
+    size_t tamanho;
+    const CabecalhoReplay* cabecalho;
+    const EntradaIndiceReplay* indice;
+    const RodapeReplay* rodape;
+} ArquivoReplay;
+
+// ═══════════════════════════════════════════════════════════════════════════════
+//                       TRANSMISSÃO PARA ESPECTADORES (DELTAS)
+// ═══════════════════════════════════════════════════════════════════════════════
+
+#define TAMANHO_BLOCO_TRANSMISSAO 16384         ///< Bytes por bloco da transmissão (padrão)
+#define INTERVALO_QUADROS_TRANSMISSAO 1024      ///< Ações entre dois quadros completos (padrão)
+
+/// Tipo do evento (2 bits mais baixos do primeiro byte)
+typedef enum {
+    EVENTO_JOGAR_FILA = 0,      ///< Mesma numeração de TipoAcaoBot
+    EVENTO_JOGAR_PILHA,
+    EVENTO_RESERVAR,
+    EVENTO_QUADRO_COMPLETO      ///< Estado inteiro, para quem entra sincronizar
+} TipoEventoTransmissao;
+
+#define NOVAS_EVENTO_DESLOCAMENTO 2     ///< Bits 2-3: peças que entraram no fim da fila (0-3)
+#define EVENTO_COM_PONTOS 0x10          ///< Segue a pontuação ganha (varint)
+#define EVENTO_COM_COMBO 0x20           ///< Segue o combo atual (varint)
+#define EVENTO_COM_NIVEL 0x40           ///< Segue o nível atual (varint)
+
+/**
+ * @brief Bloco de eventos codificados, compartilhado por todos os espectadores
+ *
+ * Todo bloco começa com um quadro completo. O produtor só acrescenta bytes
+ * e publica o novo tamanho; os espectadores decodificam direto do bloco,
+ * sem cópia. Cada espectador, o produtor e o bloco anterior (pelo elo
+ * proximo) seguram uma referência; quem solta a última libera o bloco.
+ */
+typedef struct BlocoTransmissao {
+    _Atomic int referencias;
+    _Atomic uint32_t publicados;                    ///< Bytes de eventos completos
+    _Atomic(struct BlocoTransmissao*) proximo;     ///< Próximo bloco (segura uma referência dele)
+    _Atomic int final;                              ///< 1 = a transmissão termina neste bloco
+    uint32_t capacidade;
+    unsigned char dados[];
+} BlocoTransmissao;
+
+/**
+ * @brief Produtor da transmissão de uma partida
+ *
+ * Cada ação vira um evento de poucos bytes ("jogou a peça da frente na
+ * coluna c, entrou um T, +N pontos, combo k"). Um quadro completo abre um
+ * bloco novo a cada intervaloQuadros ações (ou quando o bloco enche), e
+ * quem entra depois começa no quadro do bloco atual. A trava só protege a
+ * troca de bloco contra quem está entrando; publicar um evento não trava.
+ */
+typedef struct {
+    pthread_mutex_t trava;
+    BlocoTransmissao* atual;        ///< Bloco em que o produtor escreve (referência do produtor)
+    uint32_t tamanhoBloco;
+    int intervaloQuadros;
+    int acoesNoBloco;               ///< Ações publicadas desde o último quadro
+    int capacidadeFila;             ///< Espectadores guardam até estas peças
+    int capacidadePilha;
+    // O que os espectadores já sabem (base dos deltas)
+    int pontuacao;
+    int combo;
+    int nivel;
+    int quantidadeFila;
+    int quantidadePilha;
+    // Estatísticas
+    uint64_t eventos;
+    uint64_t quadros;
+    uint64_t bytes;                 ///< Bytes codificados (eventos e quadros)
+    uint64_t blocosAlocados;
+} TransmissaoEspectadores;
+
+/**
+ * @brief Um espectador: posição no bloco e a própria cópia do estado
+ */
+typedef struct {
+    BlocoTransmissao* bloco;        ///< Referência do espectador
+    uint32_t posicao;               ///< Próximo byte a decodificar
+    int encerrada;                  ///< 1 depois do último evento da transmissão
+    // Estado reconstruído
+    uint64_t acoes;
+    int pontuacao;
+    int nivel;
+    int combo;
+    int melhorCombo;
+    int pecasJogadas;
+    int linhasEliminadas;
+    int acoesReserva;
+    Tabuleiro tabuleiro;
+    char* fila;                     ///< Anel de tipos (capacidadeFila posições)
+    int inicioFila;
+    int quantidadeFila;
+    int capacidadeFila;
+    char* pilha;                    ///< Tipos da base para o topo
+    int quantidadePilha;
+    int capacidadePilha;
+    uint64_t eventos;
+    uint64_t bytes;
+} EspectadorTransmissao;
+
+// ═══════════════════════════════════════════════════════════════════════════════
+//                       ARQUIVO DE PARTIDAS (CONSULTAS COM ÍNDICE)
+// ═══════════════════════════════════════════════════════════════════════════════
+
+#define VERSAO_ARQUIVO_PARTIDAS 1
+#define PARTIDAS_POR_BLOCO_ARQUIVO 1024     ///< Partidas por zona do índice
+#define NIVEIS_COMBO_ARQUIVO 8              ///< Colunas comboAntesNivel2 .. comboAntesNivel9
+#define PECAS_MINIMAS_EFICIENCIA 20         ///< Peças jogadas antes de contar a eficiência mínima
+#define MAX_CONDICOES_CONSULTA 16
+
+/**
+ * @brief Colunas do resumo de uma partida (todas indexadas pelas zonas)
+ */
+typedef enum {
+    COLUNA_PONTUACAO = 0,
+    COLUNA_NIVEL,
+    COLUNA_MELHOR_COMBO,
+    COLUNA_PECAS,
+    COLUNA_LINHAS,
+    COLUNA_RESERVAS,
+    COLUNA_EFICIENCIA_RESERVA,      ///< Peças jogadas da reserva / peças jogadas (%, no fim)
+    COLUNA_EFICIENCIA_MINIMA,       ///< Menor eficiência depois de PECAS_MINIMAS_EFICIENCIA peças
+    COLUNA_COMBO_ANTES_NIVEL,       ///< + k: maior combo enquanto o nível era menor que k + 2
+    COLUNAS_ARQUIVO = COLUNA_COMBO_ANTES_NIVEL + NIVEIS_COMBO_ARQUIVO
+} ColunaArquivoPartidas;
+
+/**
+ * @brief Resumo de uma partida arquivada (registro de tamanho fixo)
+ */
+typedef struct {
+    uint64_t partida;                       ///< Semente da partida
+    int32_t valores[COLUNAS_ARQUIVO];
+} ResumoPartidaArquivo;
+
+/**
+ * @brief Zona do índice: estatísticas de um bloco de partidas (ou do arquivo inteiro)
+ *
+ * Mínimo e máximo de cada coluna descartam blocos em que nenhuma partida
+ * pode satisfazer uma condição; os mapas de bits de nível e melhor combo
+ * (bit v = algum valor v; o bit 63 junta 63 ou mais) descartam também
+ * blocos em que os valores pedidos caem entre os presentes.
+ */
+typedef struct {
+    int32_t minimo[COLUNAS_ARQUIVO];
+    int32_t maximo[COLUNAS_ARQUIVO];
+    uint64_t niveis;
+    uint64_t combos;
+    uint32_t quantidade;
+    uint32_t reservado;
+} ZonaArquivoPartidas;
+
+/**
+ * @brief Cabeçalho do arquivo de partidas
+ *
+ * Depois do cabeçalho vêm as zonas (uma por bloco) e os resumos,
+ * ordenados por nível, melhor combo e pontuação para que as zonas
+ * fiquem estreitas.
+ */
+typedef struct {
+    char magica[8];                         ///< "TETRISAP"
+    uint32_t versao;
+    uint32_t colunas;                       ///< COLUNAS_ARQUIVO
+    uint64_t quantidadePartidas;
+    uint32_t partidasPorBloco;
+    uint32_t quantidadeBlocos;
+    ZonaArquivoPartidas resumo;             ///< Estatísticas do arquivo inteiro
+} CabecalhoArquivoPartidas;
+
+/**
+ * @brief Arquivo de partidas aberto (mapeado com mmap)
+ */
+typedef struct {
+    const unsigned char* mapa;
+    size_t tamanho;
+    const CabecalhoArquivoPartidas* cabecalho;
+    const ZonaArquivoPartidas* zonas;
+    const ResumoPartidaArquivo* partidas;
+} ArquivoPartidas;
+
+/**
+ * @brief Condição "minimo <= coluna <= maximo" (as comparações viram intervalos)
+ */
+typedef struct {
+    int coluna;
+    int32_t minimo;
+    int32_t maximo;
+} CondicaoConsulta;
+
+/**
+ * @brief Consulta: todas as condições precisam valer
+ */
+typedef struct {
+    CondicaoConsulta condicoes[MAX_CONDICOES_CONSULTA];
+    int quantidade;
+} ConsultaPartidas;
+
+/**
+ * @brief O que uma consulta precisou ler
+ */
+typedef struct {
+    uint64_t arquivos;
+    uint64_t arquivosDescartados;       ///< Pelo resumo do cabeçalho
+    uint64_t blocos;
+    uint64_t blocosDescartados;         ///< Pelas zonas
+    uint64_t partidasLidas;
+    uint64_t encontradas;
+} EstatisticasConsulta;
+
+/// Chamada para cada partida que satisfaz a consulta
+typedef void (*VisitarPartidaConsulta)(const ResumoPartidaArquivo* resumoPtr, void* contexto);
+
+// ═══════════════════════════════════════════════════════════════════════════════
+//                              PROTÓTIPOS DAS FUNÇÕES
+// ═══════════════════════════════════════════════════════════════════════════════
+
+// Funções da Fila Circular
+void inicializarFila(FilaCircular* filaPtr);
+int configurarCapacidadeFila(FilaCircular* filaPtr, int capacidade);
+void liberarFila(FilaCircular* filaPtr);
+int filaVazia(FilaCircular* filaPtr);
+int filaCheia(FilaCircular* filaPtr);
+void inserirPecaNaFila(FilaCircular* filaPtr, Peca novaPeca);
+Peca jogarPecaDaFila(FilaCircular* filaPtr);
+int devolverPecaAFila(FilaCircular* filaPtr, Peca peca);
+void descartarFinalDaFila(FilaCircular* filaPtr, int quantidade);
+const Peca* espiarFila(const FilaCircular* filaPtr, int posicao);
+void exibirFila(FilaCircular* filaPtr);
+
+// Funções da Pilha de Reserva
+void inicializarPilha(PilhaReserva* pilhaPtr);
+int pilhaVazia(PilhaReserva* pilhaPtr);
+int pilhaCheia(PilhaReserva* pilhaPtr);
+void reservarPeca(PilhaReserva* pilhaPtr, Peca peca);
+Peca jogarPecaDaPilha(PilhaReserva* pilhaPtr);
+void exibirPilha(PilhaReserva* pilhaPtr);
+int configurarCapacidadePilha(PilhaReserva* pilhaPtr, int capacidade);
+void liberarPilha(PilhaReserva* pilhaPtr);
+const Peca* espiarPilha(const PilhaReserva* pilhaPtr, int posicao);
+
+// Funções do Sistema Expert
+void inicializarSistemaExpert(SistemaExpert* sistemaPtr);
+int calcularPontuacao(char tipoPeca, SistemaExpert* sistemaPtr);
+double detectarCombo(SistemaExpert* sistemaPtr, char tipoPeca);
+uint32_t padroesComboCompletos(const SistemaExpert* sistemaPtr);
+void verificarProgressaoNivel(SistemaExpert* sistemaPtr);
+void sincronizarSistemaExpert(SistemaExpert* sistemaPtr);
+void processarJogadaExpert(Peca peca, int origem, SistemaExpert* sistemaPtr);
+void processarLoteJogadasExpert(const JogadaPeca* jogadas, int quantidade, SistemaExpert* sistemaPtr);
+void exibirEstatisticasExpert(SistemaExpert* sistemaPtr);
+int otimizarSistemaExpert(SistemaExpert* sistemaPtr);
+void gerarRelatorioExpert(SistemaExpert* sistemaPtr, const Tabuleiro* tabPtr,
+                          FilaCircular* filaPtr, PilhaReserva* pilhaPtr);
+
+// Funções Utilitárias
+Peca criarPeca(char tipo, int id);
+void gerarPecasAleatorias(FilaCircular* filaPtr);
+void transferirPecaFilaParaPilha(FilaCircular* filaPtr, PilhaReserva* pilhaPtr);
+void exibirEstadoCompleto(FilaCircular* filaPtr, PilhaReserva* pilhaPtr, SistemaExpert* sistemaPtr);
+void exibirMenu();
+
+// Funções do Tabuleiro e Gerador de Jogadas
+int indiceTipoPeca(char tipoPeca);
+void limparTabuleiro(Tabuleiro* tabPtr);
+int gerarJogadas(const Tabuleiro* tabPtr, char tipoPeca, int origem, Jogada* saida, int capacidade);
+int gerarJogadasComReserva(const Tabuleiro* tabPtr, FilaCircular* filaPtr, PilhaReserva* pilhaPtr,
+                           Jogada* saida, int capacidade);
+int aplicarJogada(Tabuleiro* tabPtr, const Jogada* jogadaPtr);
+int linhasCompletadasPorJogada(const Tabuleiro* tabPtr, const Jogada* jogadaPtr);
+void desfazerJogada(Tabuleiro* tabPtr, const Jogada* jogadaPtr, int linhasCompletadas);
+
+// Funções de Avaliação de Tabuleiros
+void extrairCaracteristicas(const Tabuleiro* tabPtr, CaracteristicasTabuleiro* caracPtr);
+void avaliarLoteTabuleiros(const Tabuleiro* lote, const int* linhasEliminadas, int quantidade,
+                           const PesosAvaliacao* pesosPtr, double* notas);
+int recomendarJogada(const Tabuleiro* tabPtr, FilaCircular* filaPtr, PilhaReserva* pilhaPtr,
+                     const PesosAvaliacao* pesosPtr, Jogada* melhorPtr, double* notaPtr);
+int posicionarPecaNoTabuleiro(Tabuleiro* tabPtr, char tipoPeca, int origem,
+                              const PesosAvaliacao* pesosPtr, Jogada* escolhidaPtr);
+int encaixarPecaJogada(Tabuleiro* tabPtr, Peca peca, int origem, Jogada* jogadaPtr);
+
+// Funções de Memória (arenas e pools)
+void reiniciarArena(ArenaMemoria* arenaPtr, size_t bytesNecessarios);
+void* alocarDaArena(ArenaMemoria* arenaPtr, size_t bytes);
+void liberarArena(ArenaMemoria* arenaPtr);
+void inicializarPool(PoolObjetos* poolPtr, size_t tamanhoObjeto, int objetosPorSlab);
+int reservarPool(PoolObjetos* poolPtr, size_t quantidade);
+void* alocarDoPool(PoolObjetos* poolPtr);
+void devolverAoPool(PoolObjetos* poolPtr, void* objeto);
+void liberarPool(PoolObjetos* poolPtr);
+const ArenaMemoria* obterArenaBusca(void);
+void exibirEstatisticasArena(const char* nome, const ArenaMemoria* arenaPtr);
+void exibirEstatisticasPool(const char* nome, const PoolObjetos* poolPtr);
+
+// Funções do Bot de Busca em Feixe
+void inicializarGeradorPecas(GeradorPecas* geradorPtr, uint64_t semente);
+void inicializarGeradorPecasModo(GeradorPecas* geradorPtr, uint64_t semente, ModoGerador modo);
+int buscarModoGerador(const char* nome);
+const char* nomeModoGerador(ModoGerador modo);
+char sortearTipoPeca(GeradorPecas* geradorPtr);
+uint32_t sortearLimitadoGerador(GeradorPecas* geradorPtr, uint32_t limite);
+void reabastecerFila(FilaCircular* filaPtr, GeradorPecas* geradorPtr);
+int gravarCorpusSequencias(const char* caminho, const char* tipos, const uint64_t* inicios,
+                           uint32_t quantidadeSequencias);
+int abrirCorpusSequencias(CorpusSequencias* corpusPtr, const char* caminho);
+void fecharCorpusSequencias(CorpusSequencias* corpusPtr);
+int selecionarSequenciaCorpus(const CorpusSequencias* corpusPtr, uint32_t sequencia, CursorCorpus* cursorPtr);
+int reabastecerFilaCorpus(FilaCircular* filaPtr, CursorCorpus* cursorPtr);
+void configurarBotPadrao(ConfigBot* configPtr);
+int escolherAcaoBot(const ConfigBot* configPtr, const Tabuleiro* tabPtr, FilaCircular* filaPtr,
+                    PilhaReserva* pilhaPtr, AcaoBot* acaoPtr);
+void iniciarPartidaBot(EstadoPartidaBot* partidaPtr, int capacidadeFila, int capacidadePilha, int regrasPontuacao,
+                       uint64_t semente, ModoGerador modoGerador, CursorCorpus* cursorPtr);
+void aplicarAcaoPartidaBot(EstadoPartidaBot* partidaPtr, const AcaoBot* acaoPtr);
+void liberarPartidaBot(EstadoPartidaBot* partidaPtr);
+void executarPartidaBot(const ConfigBot* configPtr, uint64_t semente, int limitePecas,
+                        ResultadoPartida* resultadoPtr);
+void executarPartidaBotGravada(const ConfigBot* configPtr, uint64_t semente, int limitePecas,
+                               ResultadoPartida* resultadoPtr, GravadorReplay* gravadorPtr);
+int executarModoBot(int argc, char* argv[]);
+
+// Funções da Sequência Difundida
+int iniciarSequenciaDifundida(SequenciaDifundida* sequenciaPtr, uint64_t semente, int capacidadeCursores,
+                              int capacidadeSegmentos);
+void liberarSequenciaDifundida(SequenciaDifundida* sequenciaPtr);
+int registrarCursorDifusao(SequenciaDifundida* sequenciaPtr, int janela);
+void removerCursorDifusao(SequenciaDifundida* sequenciaPtr, int cursor);
+uint64_t produzirSequenciaDifundida(SequenciaDifundida* sequenciaPtr);
+const Peca* espiarDifusao(const SequenciaDifundida* sequenciaPtr, int cursor, int posicao);
+int avancarCursorDifusao(SequenciaDifundida* sequenciaPtr, int cursor, Peca* pecaPtr);
+int reabastecerFilaDifusao(FilaCircular* filaPtr, SequenciaDifundida* sequenciaPtr, int cursor);
+
+// Funções do Torneio Paralelo
+int lerParticipanteTorneio(char* texto, ParticipanteTorneio* participantePtr);
+int executarTorneio(Torneio* torneioPtr, int numeroThreads);
+double probabilidadeTStudent(double t, int grausLiberdade);
+double criticoTStudent(double p, int grausLiberdade);
+void exibirResultadosTorneio(const Torneio* torneioPtr, FILE* saida);
+int executarModoTorneio(int argc, char* argv[]);
+
+// Funções do Ajuste de Pesos
+void configurarAjustePadrao(ConfigAjuste* configPtr);
+void iniciarEstadoAjuste(const ConfigAjuste* configPtr, EstadoAjuste* estadoPtr);
+int gravarCheckpointAjuste(const char* caminho, const EstadoAjuste* estadoPtr);
+int carregarCheckpointAjuste(const char* caminho, const ConfigAjuste* configPtr, EstadoAjuste* estadoPtr);
+int executarGeracaoAjuste(const ConfigAjuste* configPtr, EstadoAjuste* estadoPtr,
+                          RelatorioGeracaoAjuste* relatorioPtr);
+int executarModoAjuste(int argc, char* argv[]);
+
+// Funções dos Replays
+int abrirGravacaoReplay(GravadorReplay* gravadorPtr, const char* caminho, const ConfigBot* configPtr,
+                        uint64_t semente, int intervaloQuadros);
+void registrarAcaoReplay(GravadorReplay* gravadorPtr, const EstadoPartidaBot* partidaPtr, const AcaoBot* acaoPtr);
+int fecharGravacaoReplay(GravadorReplay* gravadorPtr);
+int abrirArquivoReplay(ArquivoReplay* arquivoPtr, const char* caminho);
+void fecharArquivoReplay(ArquivoReplay* arquivoPtr);
+int buscarJogadaReplay(const ArquivoReplay* arquivoPtr, uint64_t jogada, EstadoPartidaBot* partidaPtr,
+                       int usarQuadros);
+int executarModoReplay(int argc, char* argv[]);
+
+// Funções da Transmissão para Espectadores
+int iniciarTransmissao(TransmissaoEspectadores* transmissaoPtr, const EstadoPartidaBot* partidaPtr,
+                       int tamanhoBloco, int intervaloQuadros);
+int publicarAcaoTransmissao(TransmissaoEspectadores* transmissaoPtr, const EstadoPartidaBot* partidaPtr,
+                            const AcaoBot* acaoPtr);
+void encerrarTransmissao(TransmissaoEspectadores* transmissaoPtr);
+void liberarTransmissao(TransmissaoEspectadores* transmissaoPtr);
+int entrarTransmissao(TransmissaoEspectadores* transmissaoPtr, EspectadorTransmissao* espectadorPtr);
+int acompanharTransmissao(EspectadorTransmissao* espectadorPtr, int maximoEventos);
+void sairTransmissao(EspectadorTransmissao* espectadorPtr);
+void exibirVisaoEspectador(const EspectadorTransmissao* espectadorPtr);
+int executarModoTransmissao(int argc, char* argv[]);
+
+// Funções do Arquivo de Partidas
+void iniciarResumoPartida(ResumoPartidaArquivo* resumoPtr, uint64_t partida);
+void acompanharResumoPartida(ResumoPartidaArquivo* resumoPtr, const EstadoPartidaBot* partidaPtr);
+void concluirResumoPartida(ResumoPartidaArquivo* resumoPtr, const EstadoPartidaBot* partidaPtr);
+int gravarArquivoPartidas(const char* caminho, ResumoPartidaArquivo* partidas, uint64_t quantidade);
+int abrirArquivoPartidas(ArquivoPartidas* arquivoPtr, const char* caminho);
+void fecharArquivoPartidas(ArquivoPartidas* arquivoPtr);
+int lerConsultaPartidas(const char* texto, ConsultaPartidas* consultaPtr);
+uint64_t consultarArquivoPartidas(const ArquivoPartidas* arquivoPtr, const ConsultaPartidas* consultaPtr,
+                                  int usarIndice, VisitarPartidaConsulta visitar, void* contexto,
+                                  EstatisticasConsulta* estatisticasPtr);
+int executarModoConsulta(int argc, char* argv[]);
+
+// Funções do Motor em Tempo Real
+double segundosPorLinha(const SistemaExpert* sistemaPtr);
+void iniciarPartidaTempoReal(PartidaTempoReal* partidaPtr, uint64_t semente, int ticksPorSegundo,
+                             int capacidadeFila, int capacidadePilha, int regras);
+void liberarPartidaTempoReal(PartidaTempoReal* partidaPtr);
+int aplicarComandoTempoReal(PartidaTempoReal* partidaPtr, ComandoTempoReal comando);
+void avancarTickTempoReal(PartidaTempoReal* partidaPtr);
+size_t desenharPartidaTempoReal(const PartidaTempoReal* partidaPtr, char* tela, size_t capacidade);
+int executarPartidaTempoReal(const ConfigTempoReal* configPtr, PartidaTempoReal* partidaPtr,
+                             ResultadoTempoReal* resultadoPtr);
+int executarModoTempoReal(int argc, char* argv[]);
+
+// Funções da Simulação em Lockstep
+void inicializarLoteLockstep(LoteLockstep* lotePtr, uint64_t semente, int partidas, int limitePecas,
+                             const RegrasPontuacao* regrasPtr, ResultadoLockstep* resultados);
+void inicializarPoliticaLockstep(GeradorPecas* politicaPtr, uint64_t semente);
+int sortearJogadaLockstep(GeradorPecas* politicaPtr, int indiceTipo, int* colunaPtr);
+int avancarLoteLockstep(LoteLockstep* lotePtr);
+long long simularLoteLockstep(LoteLockstep* lotePtr);
+
+// Funções do Histórico de Ações (desfazer/refazer)
+void inicializarHistorico(HistoricoAcoes* historicoPtr);
+void processarJogadaReversivel(Peca peca, int origem, SistemaExpert* sistemaPtr, DeltaHistorico* deltaPtr);
+void desfazerJogadaExpert(SistemaExpert* sistemaPtr, const DeltaHistorico* deltaPtr);
+Peca jogarPecaComHistorico(HistoricoAcoes* historicoPtr, int origem, FilaCircular* filaPtr,
+                           PilhaReserva* pilhaPtr, SistemaExpert* sistemaPtr, Tabuleiro* tabPtr);
+void transferirPecaComHistorico(HistoricoAcoes* historicoPtr, FilaCircular* filaPtr, PilhaReserva* pilhaPtr);
+void gerarPecasComHistorico(HistoricoAcoes* historicoPtr, FilaCircular* filaPtr, GeradorPecas* geradorPtr);
+int otimizarSistemaComHistorico(HistoricoAcoes* historicoPtr, SistemaExpert* sistemaPtr);
+void registrarConquistasHistorico(HistoricoAcoes* historicoPtr, const uint64_t* novas);
+int desfazerAcao(HistoricoAcoes* historicoPtr, FilaCircular* filaPtr, PilhaReserva* pilhaPtr,
+                 SistemaExpert* sistemaPtr, EstadoConquistas* conquistasPtr, Tabuleiro* tabPtr);
+int refazerAcao(HistoricoAcoes* historicoPtr, FilaCircular* filaPtr, PilhaReserva* pilhaPtr,
+                SistemaExpert* sistemaPtr, EstadoConquistas* conquistasPtr, Tabuleiro* tabPtr);
+
+// Funções das Regras de Pontuação
+int registrarRegrasPontuacao(const RegrasPontuacao* regrasPtr);
+int buscarRegrasPontuacao(const char* nome);
+const RegrasPontuacao* obterRegrasPontuacao(int indice);
+int carregarRegrasPontuacao(const char* caminho);
+int definirRegrasPontuacao(SistemaExpert* sistemaPtr, int indice);
+
+// Funções dos Padrões de Combo
+int compilarMotorCombos(MotorCombos* motorPtr, const PadraoCombo* padroes, int quantidade);
+const MotorCombos* obterMotorCombosPadrao(void);
+void usarMotorCombos(const MotorCombos* motorPtr);
+int configurarPadroesCombo(char* lista);
+
+// Funções das Conquistas
+int compilarMotorConquistas(MotorConquistas* motorPtr, const RegraConquista* regras, int quantidade);
+void liberarMotorConquistas(MotorConquistas* motorPtr);
+const MotorConquistas* obterMotorConquistasPadrao(void);
+void inicializarConquistas(EstadoConquistas* estadoPtr, const MotorConquistas* motorPtr);
+int avaliarConquistas(const MotorConquistas* motorPtr, EstadoConquistas* estadoPtr, SistemaExpert* sistemaPtr);
+int proximaConquistaDesbloqueada(EstadoConquistas* estadoPtr);
+
+// Funções das Sessões Interativas
+void iniciarSessao(SessaoJogo* sessaoPtr, int identificador, uint64_t semente, HistoricoAcoes* historicoPtr);
+EstadoSessao retomarSessao(SessaoJogo* sessaoPtr, const char* entrada);
+int configurarCapacidadesSessao(SessaoJogo* sessaoPtr, int capacidadeFila, int capacidadePilha);
+SessaoJogo* abrirSessao(PoolObjetos* poolSessoes, PoolObjetos* poolHistoricos, int identificador, uint64_t semente);
+void fecharSessao(PoolObjetos* poolSessoes, PoolObjetos* poolHistoricos, SessaoJogo* sessaoPtr);
+int iniciarServidorSessoes(ServidorSessoes* servidorPtr, int numeroThreads, int capacidadeEventos,
+                           EntregaSaidaSessao entregarSaida, void* contexto);
+int enviarEntradaSessao(ServidorSessoes* servidorPtr, SessaoJogo* sessaoPtr, const char* entrada);
+void encerrarServidorSessoes(ServidorSessoes* servidorPtr);
+
+// Funções do Diário de Jogadas
+int abrirDiario(DiarioJogadas* diarioPtr, const char* caminho, PoliticaSyncDiario politica, int intervaloSyncMs);
+int registrarEventoDiario(DiarioJogadas* diarioPtr, const EventoDiario* eventoPtr);
+void lerMetricasDiario(DiarioJogadas* diarioPtr, MetricasDiario* metricasPtr);
+void fecharDiario(DiarioJogadas* diarioPtr);
+
+// Funções do Painel de Estatísticas
+int criarPainelEstatisticas(PainelEstatisticas* painelPtr, const char* nome, int capacidade);
+int abrirPainelEstatisticas(PainelEstatisticas* painelPtr, const char* nome);
+void fecharPainelEstatisticas(PainelEstatisticas* painelPtr);
+int publicarSessaoPainel(PainelEstatisticas* painelPtr, SessaoJogo* sessaoPtr);
+void publicarEstatisticasSessao(SessaoJogo* sessaoPtr);
+void retirarSessaoPainel(SessaoJogo* sessaoPtr);
+int lerEstatisticasPainel(const PainelEstatisticas* painelPtr, int slot, EstatisticasPublicadas* copiaPtr);
+
+// Funções do WAL e dos Checkpoints
+uint32_t calcularCrc32c(const void* dados, size_t tamanho);
+uint32_t continuarCrc32c(uint32_t crc, const void* dados, size_t tamanho);
+int recuperarSessoesWal(const char* caminho, PoolObjetos* poolSessoes, PoolObjetos* poolHistoricos,
+                        SessaoJogo** sessoes, int capacidade, ResultadoRecuperacaoWal* resultadoPtr);
+int abrirWal(WalSessoes* walPtr, const char* caminho, const ResultadoRecuperacaoWal* recuperacaoPtr);
+uint64_t registrarWal(WalSessoes* walPtr, RegistroWal* registroPtr);
+int aguardarWal(WalSessoes* walPtr, uint64_t lsn);
+void registrarAberturaWal(WalSessoes* walPtr, SessaoJogo* sessaoPtr);
+void registrarFechamentoWal(WalSessoes* walPtr, SessaoJogo* sessaoPtr);
+int gravarCheckpointWal(WalSessoes* walPtr, SessaoJogo* const* sessoes, int quantidade);
+void fecharWal(WalSessoes* walPtr);
+
+// Variável global para controle de IDs sequenciais
+int proximoId = 1;
+
+// Suprime as mensagens do sistema Expert (partidas headless e simulações)
+int saidaSilenciosa = 0;
+
+// 1 = o menu encaixa cada peça jogada no tabuleiro pela avaliação (--encaixe automatico);
+// 0 = a jogada não mexe no tabuleiro e o relatório (opção 8) só recomenda o encaixe.
+// Cada sessão copia o valor ao iniciar; o WAL guarda a cópia, e a recuperação a restaura
+int encaixeAutomaticoMenu = 0;
+
+/// pontosBase com os pontos de cada tipo e de peças desconhecidas (colunas I, J, L, O, S, T, Z em ordem)
+#define PONTOS_BASE_TIPOS(i, o, t, s, z, j, l, outros) {                                               \
+    [0 ... ('I' & 31) - 1] = (outros), ['I' & 31] = (i), ['J' & 31] = (j),                              \
+    [('J' & 31) + 1 ... ('L' & 31) - 1] = (outros), ['L' & 31] = (l),                                  \
+    [('L' & 31) + 1 ... ('O' & 31) - 1] = (outros), ['O' & 31] = (o),                                  \
+    [('O' & 31) + 1 ... ('S' & 31) - 1] = (outros), ['S' & 31] = (s), ['T' & 31] = (t),                \
+    [('T' & 31) + 1 ... ('Z' & 31) - 1] = (outros), ['Z' & 31] = (z),                                  \
+    [('Z' & 31) + 1 ... COLUNAS_TIPO_PECA - 1] = (outros)}
+
+/// Regras originais: I=100, O=80, T=90, S/Z=85, J/L=75; limite 1000 * 1.5^(n-1)
+static const RegrasPontuacao REGRAS_PONTUACAO_EXPERT = {
+    .nome = "expert",
+    .pontosBase = PONTOS_BASE_TIPOS(100, 80, 90, 85, 85, 75, 75, 50),
+    .limiteInicial = 1000,
+    .crescimentoNivel = 1.5,
+    .passoDificuldade = 0.2,
+    .maximoDificuldade = 3.0,
+    .passoMultiplicador = 0.5,
+    .maximoMultiplicador = 10.0,
+    .curvaNivel = CURVA_NIVEL_ABSOLUTA,
+};
+
+/// Regras da versão simples: I=150, T=120, L=110, demais 100; cada nível pede 1.5x o anterior
+static const RegrasPontuacao REGRAS_PONTUACAO_CLASSICO = {
+    .nome = "classico",
+    .pontosBase = PONTOS_BASE_TIPOS(150, 100, 120, 100, 100, 100, 110, 100),
+    .limiteInicial = 1000,
+    .crescimentoNivel = 1.5,
+    .passoDificuldade = 0.2,
+    .maximoDificuldade = 3.0,
+    .passoMultiplicador = 0.0,
+    .maximoMultiplicador = 10.0,
+    .curvaNivel = CURVA_NIVEL_POR_NIVEL,
+};
+
+// Regras por índice (SistemaExpert.regrasPontuacao); as carregadas de
+// arquivo são registradas no início do programa, antes das partidas
+static const RegrasPontuacao* tabelaRegrasPontuacao[MAX_REGRAS_PONTUACAO] = {
+    [REGRAS_EXPERT] = &REGRAS_PONTUACAO_EXPERT,
+    [REGRAS_CLASSICO] = &REGRAS_PONTUACAO_CLASSICO,
+};
+static int quantidadeRegrasPontuacao = NUMERO_REGRAS_EMBUTIDAS;
+
+// Autômato de combos de todas as partidas; trocado só por usarMotorCombos(),
+// antes de elas começarem (o estado de um autômato não vale no outro)
+static MotorCombos motorCombosPadrao;
+static const MotorCombos* motorCombos = &motorCombosPadrao;
+
+// Diário em que as sessões registram suas ações (NULL = desligado)
+DiarioJogadas* diarioJogadas = NULL;
+
+// WAL que torna as ações das sessões duráveis (NULL = desligado)
+WalSessoes* walSessoes = NULL;
+
+// Destino das mensagens do jogo na thread atual (NULL = stdout); cada
+// trabalhador do servidor de sessões escreve no seu próprio buffer
+static _Thread_local FILE* saidaJogo = NULL;
+
+/// Descrição de cada AcaoHistorico para o menu
+const char* const NOMES_ACOES_HISTORICO[] = {
+    "jogar peca da fila", "jogar peca da reserva", "transferir para a reserva",
+    "gerar pecas", "otimizar sistema"
+};
+
+/// Pesos padrão da avaliação (ajustados para partidas longas sem topo)
+const PesosAvaliacao PESOS_AVALIACAO_PADRAO = {-0.51, -0.36, -0.18, -0.10, -0.05, 0.76};
+
+// ═══════════════════════════════════════════════════════════════════════════════
+//                              IMPLEMENTAÇÃO DAS FUNÇÕES
+// ═══════════════════════════════════════════════════════════════════════════════
+
+/**
+ * @brief printf() para o destino das mensagens do jogo na thread atual
+ * @param formato Formato no padrão de printf()
+ */
+static void __attribute__((format(printf, 1, 2))) imprimirJogo(const char* formato, ...) {
+    va_list argumentos;
+    va_start(argumentos, formato);
+    vfprintf(saidaJogo != NULL ? saidaJogo : stdout, formato, argumentos);
+    va_end(argumentos);
+}
+
+/**
+ * @brief Inicializa a fila circular
+ * @param filaPtr Ponteiro para a estrutura da fila
+ *
+ * A fila começa com a capacidade padrão, nos segmentos embutidos. Para
+ * reutilizar uma fila que cresceu, chame liberarFila() antes.
+ */
+void inicializarFila(FilaCircular* filaPtr) {
+    filaPtr->diretorio = NULL;
+    filaPtr->blocos = NULL;
+    filaPtr->posicaoFrente = 0;
+    filaPtr->quantidadePecas = 0;
+    filaPtr->capacidade = CAPACIDADE_PADRAO_FILA;
+    filaPtr->tamanhoDiretorio = SEGMENTOS_EMBUTIDOS_FILA;
+}
+
+/**
+ * @brief Segmento que guarda o segmento de número dado
+ */
+static inline Peca* segmentoFila(const FilaCircular* filaPtr, unsigned int numero) {
+    if (filaPtr->diretorio != NULL) {
+        return filaPtr->diretorio[numero & (unsigned int)(filaPtr->tamanhoDiretorio - 1)];
+    }
+    return (Peca*)filaPtr->segmentosEmbutidos[numero & (SEGMENTOS_EMBUTIDOS_FILA - 1)];
+}
+
+/**
+ * @brief Endereço da peça na posição absoluta dada
+ */
+static inline Peca* posicaoFila(const FilaCircular* filaPtr, unsigned int posicao) {
+    return &segmentoFila(filaPtr, posicao >> BITS_SEGMENTO_FILA)[posicao & (PECAS_POR_SEGMENTO_FILA - 1)];
+}
+
+/**
+ * @brief Troca o diretório da fila por um maior
+ * @return 1 em caso de sucesso, 0 se faltou memória (a fila não muda)
+ *
+ * Os segmentos com peças vão para as entradas que o novo tamanho lhes
+ * atribui; os vazios e os novos, alocados num único bloco, ocupam as
+ * entradas restantes. Só ponteiros mudam de lugar.
+ */
+static int crescerDiretorioFila(FilaCircular* filaPtr, int tamanho) {
+    int anterior = filaPtr->tamanhoDiretorio;
+    int novos = tamanho - anterior;
+    Peca** diretorio = malloc(sizeof(Peca*) * (size_t)tamanho);
+    // A primeira posição do bloco encadeia os blocos para liberarFila()
+    Peca* bloco = malloc(sizeof(Peca) * ((size_t)novos * PECAS_POR_SEGMENTO_FILA + 1));
+    if (diretorio == NULL || bloco == NULL) {
+        free(diretorio);
+        free(bloco);
+        return 0;
+    }
+    memcpy(bloco, &filaPtr->blocos, sizeof(Peca*));
+    filaPtr->blocos = bloco;
+
+    for (int i = 0; i < tamanho; i++) {
+        diretorio[i] = NULL;
+    }
+    unsigned int primeiro = filaPtr->posicaoFrente >> BITS_SEGMENTO_FILA;
+    int emUso = 0;
+    if (filaPtr->quantidadePecas > 0) {
+        int deslocamento = (int)(filaPtr->posicaoFrente & (PECAS_POR_SEGMENTO_FILA - 1));
+        emUso = ((deslocamento + filaPtr->quantidadePecas - 1) >> BITS_SEGMENTO_FILA) + 1;
+    }
+    for (int k = 0; k < emUso; k++) {
+        diretorio[(primeiro + k) & (unsigned int)(tamanho - 1)] = segmentoFila(filaPtr, primeiro + k);
+    }
+
+    // Entradas livres: primeiro os segmentos antigos sem peças, depois os novos
+    int livre = 0;
+    for (int k = emUso; k < anterior; k++) {
+        while (diretorio[livre] != NULL) {
+            livre++;
+        }
+        diretorio[livre] = segmentoFila(filaPtr, primeiro + k);
+    }
+    for (int k = 0; k < novos; k++) {
+        while (diretorio[livre] != NULL) {
+            livre++;
+        }
+        diretorio[livre] = bloco + 1 + k * PECAS_POR_SEGMENTO_FILA;
+    }
+
+    free(filaPtr->diretorio);
+    filaPtr->diretorio = diretorio;
+    filaPtr->tamanhoDiretorio = tamanho;
+    return 1;
+}
+
+/**
+ * @brief Ajusta quantas peças a fila comporta (tamanho da prévia)
+ * @param filaPtr Ponteiro para a estrutura da fila
+ * @param capacidade Nova capacidade (1 a CAPACIDADE_MAXIMA_FILA)
+ * @return 1 em caso de sucesso, 0 se a capacidade é inválida, menor que
+ *         o número de peças na fila, ou se faltou memória
+ *
+ * Pode ser chamada com peças na fila: as peças ficam onde estão.
+ */
+int configurarCapacidadeFila(FilaCircular* filaPtr, int capacidade) {
+    if (capacidade < 1 || capacidade > CAPACIDADE_MAXIMA_FILA || capacidade < filaPtr->quantidadePecas) {
+        return 0;
+    }
+    // Segmentos que capacidade peças consecutivas podem tocar
+    int necessarios = (capacidade + 2 * PECAS_POR_SEGMENTO_FILA - 2) / PECAS_POR_SEGMENTO_FILA;
+    int tamanho = filaPtr->tamanhoDiretorio;
+    while (tamanho < necessarios) {
+        tamanho *= 2;
+    }
+    if (tamanho > filaPtr->tamanhoDiretorio && !crescerDiretorioFila(filaPtr, tamanho)) {
+        return 0;
+    }
+    filaPtr->capacidade = capacidade;
+    return 1;
+}
+
+/**
+ * @brief Libera os segmentos alocados e volta à capacidade padrão, vazia
+ * @param filaPtr Ponteiro para a estrutura da fila
+ */
+void liberarFila(FilaCircular* filaPtr) {
+    while (filaPtr->blocos != NULL) {
+        Peca* proximo;
+        memcpy(&proximo, filaPtr->blocos, sizeof(Peca*));
+        free(filaPtr->blocos);
+        filaPtr->blocos = proximo;
+    }
+    free(filaPtr->diretorio);
+    inicializarFila(filaPtr);
+}
+
+/**
+ * @brief Verifica se a fila está vazia
+ * @param filaPtr Ponteiro para a estrutura da fila
+ * @return 1 se vazia, 0 caso contrário
+ */
+int filaVazia(FilaCircular* filaPtr) {
+    return filaPtr->quantidadePecas == 0;
+}
+
+/**
+ * @brief Verifica se a fila está cheia
+ * @param filaPtr Ponteiro para a estrutura da fila
+ * @return 1 se cheia, 0 caso contrário
+ */
+int filaCheia(FilaCircular* filaPtr) {
+    return filaPtr->quantidadePecas >= filaPtr->capacidade;
+}
+
+/**
+ * @brief Insere uma peça na fila
+ * @param filaPtr Ponteiro para a estrutura da fila
+ * @param novaPeca Peça a ser inserida
+ */
+void inserirPecaNaFila(FilaCircular* filaPtr, Peca novaPeca) {
+    if (!filaCheia(filaPtr)) {
+        *posicaoFila(filaPtr, filaPtr->posicaoFrente + (unsigned int)filaPtr->quantidadePecas) = novaPeca;
+        filaPtr->quantidadePecas++;
+    }
+}
+
+/**
+ * @brief Remove e retorna uma peça da fila
+ * @param filaPtr Ponteiro para a estrutura da fila
+ * @return Peça removida
+ */
+Peca jogarPecaDaFila(FilaCircular* filaPtr) {
+    Peca peca = {'X', 0}; // Peça vazia por padrão
+    if (!filaVazia(filaPtr)) {
+        peca = *posicaoFila(filaPtr, filaPtr->posicaoFrente);
+        filaPtr->posicaoFrente++;
+        filaPtr->quantidadePecas--;
+    }
+    return peca;
+}
+
+/**
+ * @brief Devolve uma peça à frente da fila (desfazer uma jogada)
+ * @param filaPtr Ponteiro para a estrutura da fila
+ * @param peca Peça que acabou de sair da fila
+ * @return 1 se a peça voltou, 0 se a fila estava cheia
+ */
+int devolverPecaAFila(FilaCircular* filaPtr, Peca peca) {
+    if (filaCheia(filaPtr)) {
+        return 0;
+    }
+    filaPtr->posicaoFrente--;
+    *posicaoFila(filaPtr, filaPtr->posicaoFrente) = peca;
+    filaPtr->quantidadePecas++;
+    return 1;
+}
+
+/**
+ * @brief Remove as últimas peças inseridas (desfazer uma geração)
+ * @param filaPtr Ponteiro para a estrutura da fila
+ * @param quantidade Peças a remover do final
+ */
+void descartarFinalDaFila(FilaCircular* filaPtr, int quantidade) {
+    filaPtr->quantidadePecas -= quantidade < filaPtr->quantidadePecas ? quantidade : filaPtr->quantidadePecas;
+}
+
+/**
+ * @brief Consulta uma peça da fila sem retirá-la, em O(1)
+ * @param filaPtr Ponteiro para a estrutura da fila
+ * @param posicao Distância da frente (0 = próxima peça a jogar)
+ * @return Peça na posição, ou NULL se a fila não tem tantas peças
+ */
+const Peca* espiarFila(const FilaCircular* filaPtr, int posicao) {
+    if (posicao < 0 || posicao >= filaPtr->quantidadePecas) {
+        return NULL;
+    }
+    return posicaoFila(filaPtr, filaPtr->posicaoFrente + (unsigned int)posicao);
+}
+
+/**
+ * @brief Exibe o conteúdo da fila
+ * @param filaPtr Ponteiro para a estrutura da fila
+ */
+void exibirFila(FilaCircular* filaPtr) {
+    imprimirJogo("Fila: ");
+    for (int i = 0; i < filaPtr->quantidadePecas; i++) {
+        imprimirJogo("%c ", espiarFila(filaPtr, i)->tipo);
+    }
+    imprimirJogo("\n");
+}
+
+/**
+ * @brief Inicializa a pilha de reserva
+ * @param pilhaPtr Ponteiro para a estrutura da pilha
+ *
+ * A pilha começa com a capacidade padrão. Para reutilizar uma pilha que
+ * cresceu, chame liberarPilha() antes.
+ */
+void inicializarPilha(PilhaReserva* pilhaPtr) {
+    pilhaPtr->blocos = NULL;
+    pilhaPtr->quantidadeBlocos = 0;
+    pilhaPtr->capacidade = CAPACIDADE_PADRAO_PILHA;
+    pilhaPtr->indiceTopo = -1;
+    pilhaPtr->quantidadeReservada = 0;
+}
+
+/**
+ * @brief Endereço da posição da pilha (0 = base)
+ */
+static inline Peca* posicaoPilha(const PilhaReserva* pilhaPtr, int indice) {
+    if (indice < PECAS_EMBUTIDAS_PILHA) {
+        return (Peca*)&pilhaPtr->pecasReservadas[indice];
+    }
+    indice -= PECAS_EMBUTIDAS_PILHA;
+    return &pilhaPtr->blocos[indice / PECAS_POR_BLOCO_PILHA][indice % PECAS_POR_BLOCO_PILHA];
+}
+
+/**
+ * @brief Ajusta quantas peças a reserva comporta
+ * @param pilhaPtr Ponteiro para a estrutura da pilha
+ * @param capacidade Nova capacidade (1 a CAPACIDADE_MAXIMA_PILHA)
+ * @return 1 em caso de sucesso, 0 se a capacidade é inválida, menor que
+ *         o número de peças reservadas, ou se faltou memória
+ */
+int configurarCapacidadePilha(PilhaReserva* pilhaPtr, int capacidade) {
+    if (capacidade < 1 || capacidade > CAPACIDADE_MAXIMA_PILHA || capacidade < pilhaPtr->quantidadeReservada) {
+        return 0;
+    }
+    int necessarios = capacidade <= PECAS_EMBUTIDAS_PILHA ? 0 :
+        (capacidade - PECAS_EMBUTIDAS_PILHA + PECAS_POR_BLOCO_PILHA - 1) / PECAS_POR_BLOCO_PILHA;
+    if (necessarios > pilhaPtr->quantidadeBlocos) {
+        Peca** blocos = realloc(pilhaPtr->blocos, sizeof(Peca*) * (size_t)necessarios);
+        if (blocos == NULL) {
+            return 0;
+        }
+        pilhaPtr->blocos = blocos;
+        while (pilhaPtr->quantidadeBlocos < necessarios) {
+            Peca* bloco = malloc(sizeof(Peca) * PECAS_POR_BLOCO_PILHA);
+            if (bloco == NULL) {
+                return 0;
+            }
+            pilhaPtr->blocos[pilhaPtr->quantidadeBlocos++] = bloco;
+        }
+    }
+    pilhaPtr->capacidade = capacidade;
+    return 1;
+}
+
+/**
+ * @brief Libera os blocos extras e volta à capacidade padrão, vazia
+ * @param pilhaPtr Ponteiro para a estrutura da pilha
+ */
+void liberarPilha(PilhaReserva* pilhaPtr) {
+    for (int i = 0; i < pilhaPtr->quantidadeBlocos; i++) {
+        free(pilhaPtr->blocos[i]);
+    }
+    free(pilhaPtr->blocos);
+    inicializarPilha(pilhaPtr);
+}
+
+/**
+ * @brief Verifica se a pilha está vazia
+ * @param pilhaPtr Ponteiro para a estrutura da pilha
+ * @return 1 se vazia, 0 caso contrário
+ */
+int pilhaVazia(PilhaReserva* pilhaPtr) {
+    return pilhaPtr->quantidadeReservada == 0;
+}
+
+/**
+ * @brief Verifica se a pilha está cheia
+ * @param pilhaPtr Ponteiro para a estrutura da pilha
+ * @return 1 se cheia, 0 caso contrário
+ */
+int pilhaCheia(PilhaReserva* pilhaPtr) {
+    return pilhaPtr->quantidadeReservada >= pilhaPtr->capacidade;
+}
+
+/**
+ * @brief Adiciona uma peça à pilha de reserva
+ * @param pilhaPtr Ponteiro para a estrutura da pilha
+ * @param peca Peça a ser reservada
+ */
+void reservarPeca(PilhaReserva* pilhaPtr, Peca peca) {
+    if (!pilhaCheia(pilhaPtr)) {
+        pilhaPtr->indiceTopo++;
+        *posicaoPilha(pilhaPtr, pilhaPtr->indiceTopo) = peca;
+        pilhaPtr->quantidadeReservada++;
+    }
+}
+
+/**
+ * @brief Remove e retorna uma peça da pilha
+ * @param pilhaPtr Ponteiro para a estrutura da pilha
+ * @return Peça removida
+ */
+Peca jogarPecaDaPilha(PilhaReserva* pilhaPtr) {
+    Peca peca = {'X', 0}; // Peça vazia por padrão
+    if (!pilhaVazia(pilhaPtr)) {
+        peca = *posicaoPilha(pilhaPtr, pilhaPtr->indiceTopo);
+        pilhaPtr->indiceTopo--;
+        pilhaPtr->quantidadeReservada--;
+    }
+    return peca;
+}
+
+/**
+ * @brief Consulta uma peça da reserva sem retirá-la, em O(1)
+ * @param pilhaPtr Ponteiro para a estrutura da pilha
+ * @param posicao Distância do topo (0 = próxima peça a sair)
+ * @return Peça na posição, ou NULL se a reserva não tem tantas peças
+ */
+const Peca* espiarPilha(const PilhaReserva* pilhaPtr, int posicao) {
+    if (posicao < 0 || posicao >= pilhaPtr->quantidadeReservada) {
+        return NULL;
+    }
+    return posicaoPilha(pilhaPtr, pilhaPtr->indiceTopo - posicao);
+}
+
+/**
+ * @brief Exibe o conteúdo da pilha
+ * @param pilhaPtr Ponteiro para a estrutura da pilha
+ */
+void exibirPilha(PilhaReserva* pilhaPtr) {
+    imprimirJogo("Pilha: ");
+    for (int i = 0; i < pilhaPtr->quantidadeReservada; i++) {
+        imprimirJogo("%c ", espiarPilha(pilhaPtr, i)->tipo);
+    }
+    imprimirJogo("\n");
+}
+
+/**
+ * @brief Inicializa o sistema Expert com valores padrão
+ * @param sistemaPtr Ponteiro para a estrutura do sistema Expert
+ */
+void inicializarSistemaExpert(SistemaExpert* sistemaPtr) {
+    obterMotorCombosPadrao();
+
+    // Inicialização do sistema de pontuação
+    sistemaPtr->pontuacaoTotal = 0;
+    sistemaPtr->pontuacaoNivel = 0;
+    sistemaPtr->multiplicadorAtual = 1.0;
+    sistemaPtr->fatorDificuldade = 1.0;
+    
+    // Inicialização de combos
+    sistemaPtr->comboAtual = 0;
+    sistemaPtr->melhorCombo = 0;
+    sistemaPtr->totalCombos = 0;
+    sistemaPtr->ultimoTipoJogado = 'X';
+    sistemaPtr->sequenciaTipoAtual = 0;
+    sistemaPtr->estadoCombo = 0;
+    sistemaPtr->regrasPontuacao = REGRAS_EXPERT;
+    
+    // Inicialização dos níveis de dificuldade
+    sistemaPtr->nivelAtual = 1;
+    sistemaPtr->pontosParaProximoNivel = 1000;
+    sistemaPtr->limitePontosNivel = 1000;
+    
+    // Inicialização das estatísticas avançadas
+    sistemaPtr->totalJogadas = 0;
+    sistemaPtr->jogadasDaFila = 0;
+    sistemaPtr->jogadasDaPilha = 0;
+    sistemaPtr->pecasReservadas = 0;
+    sistemaPtr->eficienciaReserva = 0;
+    
+    // Inicialização das estatísticas por tipo de peça
+    sistemaPtr->contagemTipoI = 0;
+    sistemaPtr->contagemTipoO = 0;
+    sistemaPtr->contagemTipoT = 0;
+    sistemaPtr->contagemTipoL = 0;
+    sistemaPtr->tipoMaisJogado = 'I';
+    
+    // Inicialização de conquistas e marcos
+    sistemaPtr->conquistasDesbloqueadas = 0;
+    sistemaPtr->marcosAlcancados = 0;
+    sistemaPtr->recordePessoal = 0;
+}
+
+/**
+ * @brief Calcula a pontuação base para um tipo de peça
+ * @param tipoPeca Tipo da peça jogada
+ * @param sistemaPtr Ponteiro para o sistema Expert
+ * @return Pontuação calculada
  */
 int calcularPontuacao(char tipoPeca, SistemaExpert* sistemaPtr) {
-    int pontuacaoBase = 0;
+    // Pontuação base por tipo de peça, segundo as regras da partida
+    const RegrasPontuacao* regrasPtr = tabelaRegrasPontuacao[sistemaPtr->regrasPontuacao];
+    int pontuacaoBase = regrasPtr->pontosBase[tipoPeca & (COLUNAS_TIPO_PECA - 1)];
+    
+    // Aplicar multiplicadores
+    return (int)(pontuacaoBase * sistemaPtr->multiplicadorAtual * sistemaPtr->fatorDificuldade);
+}
+
+/**
+ * @brief Um passo do autômato de combos sobre campos soltos
+ * @param estadoPtr Estado do autômato
+ * @param comboPtr Combo atual
+ * @param melhorPtr Melhor combo
+ * @param tipoPeca Tipo da peça jogada
+ * @return Multiplicador de combo aplicado
+ *
+ * Compartilhado por detectarCombo() e pela simulação em lockstep, que
+ * guarda esses campos em arrays por lane.
+ */
+static inline double avancarComboMotor(uint8_t* estadoPtr, int* comboPtr, int* melhorPtr, char tipoPeca) {
+    int estado = motorCombos->transicoes[*estadoPtr][tipoPeca & (COLUNAS_TIPO_PECA - 1)];
+    *estadoPtr = (uint8_t)estado;
+    if (motorCombos->completos[estado] == 0) {
+        *comboPtr = 0;
+        return 1.0;
+    }
+    (*comboPtr)++;
+    if (*comboPtr > *melhorPtr) {
+        *melhorPtr = *comboPtr;
+    }
+    return 1.0 + (*comboPtr * motorCombos->bonus[estado]);
+}
+
+/**
+ * @brief Detecta e processa combos de peças consecutivas
+ * @param sistemaPtr Ponteiro para o sistema Expert
+ * @param tipoPeca Tipo da peça atual
+ * @return Multiplicador de combo aplicado
+ *
+ * O autômato de combos avança uma peça; se algum padrão terminou nela o
+ * combo continua (uma peça a mais), senão é zerado. Com os padrões
+ * padrão (três peças iguais) é a regra original: combo = sequência - 2.
+ */
+double detectarCombo(SistemaExpert* sistemaPtr, char tipoPeca) {
+    sistemaPtr->sequenciaTipoAtual = sistemaPtr->ultimoTipoJogado == tipoPeca ? sistemaPtr->sequenciaTipoAtual + 1 : 1;
+    sistemaPtr->ultimoTipoJogado = tipoPeca;
+    return avancarComboMotor(&sistemaPtr->estadoCombo, &sistemaPtr->comboAtual, &sistemaPtr->melhorCombo, tipoPeca);
+}
+
+/**
+ * @brief Padrões de combo que terminaram na última peça jogada
+ * @param sistemaPtr Ponteiro para o sistema Expert
+ * @return Bit p ligado se o padrão p do motor em uso terminou
+ */
+uint32_t padroesComboCompletos(const SistemaExpert* sistemaPtr) {
+    return motorCombos->completos[sistemaPtr->estadoCombo];
+}
+
+/**
+ * @brief Sobe um nível segundo as regras, sobre campos soltos
+ * @param regrasPtr Regras de pontuação da partida
+ * @param pontuacaoTotal Pontuação no momento da subida
+ * @param nivelPtr Nível atual (incrementado)
+ * @param limitePtr Limite de pontos do nível (recalculado)
+ * @param dificuldadePtr Fator de dificuldade
+ * @param multiplicadorPtr Multiplicador de pontos
+ *
+ * Compartilhada por verificarProgressaoNivel() e pela simulação em lockstep.
+ */
+static inline void subirNivelRegras(const RegrasPontuacao* regrasPtr, int pontuacaoTotal, int* nivelPtr,
+                                    int* limitePtr, double* dificuldadePtr, double* multiplicadorPtr) {
+    (*nivelPtr)++;
+    
+    // Calcular novo limite com progressão exponencial
+    int pontosDoNivel = (int)(regrasPtr->limiteInicial * pow(regrasPtr->crescimentoNivel, *nivelPtr - 1));
+    if (regrasPtr->curvaNivel == CURVA_NIVEL_POR_NIVEL) {
+        pontosDoNivel += pontuacaoTotal;
+    }
+    *limitePtr = pontosDoNivel;
+    
+    // Aumentar fator de dificuldade (até o máximo das regras)
+    if (*dificuldadePtr < regrasPtr->maximoDificuldade) {
+        *dificuldadePtr += regrasPtr->passoDificuldade;
+    }
+    
+    // Aumentar multiplicador base (até o máximo das regras)
+    if (*multiplicadorPtr < regrasPtr->maximoMultiplicador) {
+        *multiplicadorPtr += regrasPtr->passoMultiplicador;
+    }
+}
+
+/**
+ * @brief Verifica e processa a progressão de nível baseada na pontuação
+ * @param sistemaPtr Ponteiro para o sistema Expert
+ * 
+ * Esta função implementa um sistema dinâmico de progressão que:
+ * - Monitora a pontuação atual do nível
+ * - Calcula progressão exponencial de dificuldade
+ * - Ajusta automaticamente multiplicadores e limites
+ * - Fornece feedback visual da evolução
+ */
+void verificarProgressaoNivel(SistemaExpert* sistemaPtr) {
+    // Verificar se atingiu pontos suficientes para próximo nível
+    if (sistemaPtr->pontuacaoTotal >= sistemaPtr->limitePontosNivel) {
+        subirNivelRegras(tabelaRegrasPontuacao[sistemaPtr->regrasPontuacao], sistemaPtr->pontuacaoTotal,
+                         &sistemaPtr->nivelAtual, &sistemaPtr->limitePontosNivel,
+                         &sistemaPtr->fatorDificuldade, &sistemaPtr->multiplicadorAtual);
+        sistemaPtr->pontosParaProximoNivel = sistemaPtr->limitePontosNivel - sistemaPtr->pontuacaoTotal;
+        
+        // Registrar marco alcançado
+        sistemaPtr->marcosAlcancados++;
+        
+        if (!saidaSilenciosa) {
+            imprimirJogo("\n*** NIVEL %d ALCANCADO! ***\n", sistemaPtr->nivelAtual);
+            imprimirJogo("Novo multiplicador: %.1fx\n", sistemaPtr->multiplicadorAtual);
+            imprimirJogo("Fator de dificuldade: %.1f\n", sistemaPtr->fatorDificuldade);
+        }
+    } else {
+        // Atualizar pontos restantes para próximo nível
+        sistemaPtr->pontosParaProximoNivel = sistemaPtr->limitePontosNivel - sistemaPtr->pontuacaoTotal;
+    }
+}
+
+/**
+ * @brief Pontos de uma peça antes do combo: base * multiplicador * dificuldade
+ */
+static inline int pontosPecaRegras(const RegrasPontuacao* regrasPtr, char tipoPeca, double multiplicador,
+                                   double dificuldade) {
+    return (int)(regrasPtr->pontosBase[tipoPeca & (COLUNAS_TIPO_PECA - 1)] * multiplicador * dificuldade);
+}
+
+/**
+ * @brief Corpo de processarJogadaExpert() para um conjunto de regras
+ *
+ * Sempre expandido no chamador: com as regras embutidas, que são
+ * constantes, a tabela de pontos vira um acesso a endereço fixo e não
+ * sobra nenhum teste de modo no caminho da jogada.
+ */
+static inline __attribute__((always_inline)) void processarJogadaRegras(Peca peca, int origem, SistemaExpert* sistemaPtr,
+                                                                        const RegrasPontuacao* regrasPtr) {
+    // Cálculo da pontuação
+    int pontos = pontosPecaRegras(regrasPtr, peca.tipo, sistemaPtr->multiplicadorAtual, sistemaPtr->fatorDificuldade);
+    
+    // Detectar combo e aplicar multiplicador
+    double multiplicadorCombo = detectarCombo(sistemaPtr, peca.tipo);
+    
+    // Aplicar multiplicador de combo à pontuação
+    pontos = (int)(pontos * multiplicadorCombo);
+    
+    // Atualização das pontuações
+    sistemaPtr->pontuacaoTotal += pontos;
+    sistemaPtr->pontuacaoNivel += pontos;
     
-    // Pontuação base por tipo de peça
+    // Estatísticas de origem das jogadas (jogadas da fila são derivadas)
+    sistemaPtr->totalJogadas++;
+    sistemaPtr->jogadasDaPilha += origem != 0;
+    
+    // Atualizar contadores de tipo de peça
+    switch(peca.tipo) {
+        case 'I': sistemaPtr->contagemTipoI++; break;
+        case 'O': sistemaPtr->contagemTipoO++; break;
+        case 'T': sistemaPtr->contagemTipoT++; break;
+        case 'L': sistemaPtr->contagemTipoL++; break;
+    }
+    
+    // Progressão de nível só quando o limite é atingido; recorde, tipo mais
+    // jogado e eficiência ficam para sincronizarSistemaExpert() e as
+    // conquistas para avaliarConquistas(), fora do caminho de cada jogada
+    if (sistemaPtr->pontuacaoTotal >= sistemaPtr->limitePontosNivel) {
+        verificarProgressaoNivel(sistemaPtr);
+    }
+}
+
+/**
+ * @brief Processa uma jogada completa no sistema Expert
+ * @param peca Peça jogada
+ * @param origem Origem da peça (0=fila, 1=pilha)
+ * @param sistemaPtr Ponteiro para o sistema Expert
+ */
+void processarJogadaExpert(Peca peca, int origem, SistemaExpert* sistemaPtr) {
+    switch (sistemaPtr->regrasPontuacao) {
+        case REGRAS_EXPERT:
+            processarJogadaRegras(peca, origem, sistemaPtr, &REGRAS_PONTUACAO_EXPERT);
+            break;
+        case REGRAS_CLASSICO:
+            processarJogadaRegras(peca, origem, sistemaPtr, &REGRAS_PONTUACAO_CLASSICO);
+            break;
+        default:
+            processarJogadaRegras(peca, origem, sistemaPtr, tabelaRegrasPontuacao[sistemaPtr->regrasPontuacao]);
+            break;
+    }
+}
+
+/**
+ * @brief Atualiza os campos frios que são derivados dos totais
+ * @param sistemaPtr Ponteiro para o sistema Expert
+ *
+ * processarJogadaExpert() não os toca para não sair da linha quente. Como
+ * a pontuação só cresce entre sincronizações, o recorde calculado aqui é o
+ * mesmo que seria obtido jogada a jogada. Deve ser chamada antes de ler
+ * recordePessoal, tipoMaisJogado, eficienciaReserva, jogadasDaFila ou
+ * pontosParaProximoNivel.
+ */
+void sincronizarSistemaExpert(SistemaExpert* sistemaPtr) {
+    if (sistemaPtr->pontuacaoTotal > sistemaPtr->recordePessoal) {
+        sistemaPtr->recordePessoal = sistemaPtr->pontuacaoTotal;
+    }
+    sistemaPtr->jogadasDaFila = sistemaPtr->totalJogadas - sistemaPtr->jogadasDaPilha;
+    sistemaPtr->pontosParaProximoNivel = sistemaPtr->limitePontosNivel - sistemaPtr->pontuacaoTotal;
+    
+    // Tipo mais jogado (empate: o primeiro na ordem I, O, T, L)
+    int maxContagem = 0;
+    if (sistemaPtr->contagemTipoI > maxContagem) {
+        maxContagem = sistemaPtr->contagemTipoI;
+        sistemaPtr->tipoMaisJogado = 'I';
+    }
+    if (sistemaPtr->contagemTipoO > maxContagem) {
+        maxContagem = sistemaPtr->contagemTipoO;
+        sistemaPtr->tipoMaisJogado = 'O';
+    }
+    if (sistemaPtr->contagemTipoT > maxContagem) {
+        maxContagem = sistemaPtr->contagemTipoT;
+        sistemaPtr->tipoMaisJogado = 'T';
+    }
+    if (sistemaPtr->contagemTipoL > maxContagem) {
+        sistemaPtr->tipoMaisJogado = 'L';
+    }
+    
+    // Eficiência da reserva
+    if (sistemaPtr->totalJogadas > 0) {
+        sistemaPtr->eficienciaReserva = (double)sistemaPtr->jogadasDaPilha / sistemaPtr->totalJogadas * 100.0;
+    }
+}
+
+/**
+ * @brief Corpo de processarLoteJogadasExpert() para um conjunto de regras
+ */
+static inline __attribute__((always_inline)) void processarLoteRegras(const JogadaPeca* jogadas, int quantidade,
+                                                                      SistemaExpert* sistemaPtr,
+                                                                      const RegrasPontuacao* regrasPtr) {
+    // Estado usado a cada jogada fica em variáveis locais (registradores)
+    int pontuacaoTotal = sistemaPtr->pontuacaoTotal;
+    int pontuacaoNivel = sistemaPtr->pontuacaoNivel;
+    int limitePontosNivel = sistemaPtr->limitePontosNivel;
+    double multiplicadorAtual = sistemaPtr->multiplicadorAtual;
+    double fatorDificuldade = sistemaPtr->fatorDificuldade;
+    char ultimoTipo = sistemaPtr->ultimoTipoJogado;
+    int sequencia = sistemaPtr->sequenciaTipoAtual;
+    int estadoCombo = sistemaPtr->estadoCombo;
+    int combo = sistemaPtr->comboAtual;
+    int melhorCombo = sistemaPtr->melhorCombo;
+    const MotorCombos* motorPtr = motorCombos;
+    int jogadasDaPilha = 0;
+    int contagemI = 0, contagemO = 0, contagemT = 0, contagemL = 0;
+
+    for (int i = 0; i < quantidade; i++) {
+        char tipo = jogadas[i].peca.tipo;
+
+        // calcularPontuacao() e detectarCombo()
+        int pontos = pontosPecaRegras(regrasPtr, tipo, multiplicadorAtual, fatorDificuldade);
+        sequencia = ultimoTipo == tipo ? sequencia + 1 : 1;
+        ultimoTipo = tipo;
+        estadoCombo = motorPtr->transicoes[estadoCombo][tipo & (COLUNAS_TIPO_PECA - 1)];
+        if (motorPtr->completos[estadoCombo] != 0) {
+            combo++;
+            if (combo > melhorCombo) {
+                melhorCombo = combo;
+            }
+            pontos = (int)(pontos * (1.0 + combo * motorPtr->bonus[estadoCombo]));
+        } else {
+            combo = 0;
+        }
+        pontuacaoTotal += pontos;
+        pontuacaoNivel += pontos;
+
+        jogadasDaPilha += jogadas[i].origem != 0;
+        contagemI += tipo == 'I';
+        contagemO += tipo == 'O';
+        contagemT += tipo == 'T';
+        contagemL += tipo == 'L';
+
+        // Subida de nível: grava o estado e usa a rotina original
+        if (pontuacaoTotal >= limitePontosNivel) {
+            sistemaPtr->pontuacaoTotal = pontuacaoTotal;
+            verificarProgressaoNivel(sistemaPtr);
+            limitePontosNivel = sistemaPtr->limitePontosNivel;
+            multiplicadorAtual = sistemaPtr->multiplicadorAtual;
+            fatorDificuldade = sistemaPtr->fatorDificuldade;
+        }
+    }
+
+    sistemaPtr->pontuacaoTotal = pontuacaoTotal;
+    sistemaPtr->pontuacaoNivel = pontuacaoNivel;
+    sistemaPtr->ultimoTipoJogado = ultimoTipo;
+    sistemaPtr->sequenciaTipoAtual = sequencia;
+    sistemaPtr->estadoCombo = (uint8_t)estadoCombo;
+    sistemaPtr->comboAtual = combo;
+    sistemaPtr->melhorCombo = melhorCombo;
+    sistemaPtr->totalJogadas += quantidade;
+    sistemaPtr->jogadasDaPilha += jogadasDaPilha;
+    sistemaPtr->contagemTipoI += contagemI;
+    sistemaPtr->contagemTipoO += contagemO;
+    sistemaPtr->contagemTipoT += contagemT;
+    sistemaPtr->contagemTipoL += contagemL;
+}
+
+/**
+ * @brief Processa uma sequência de jogadas com o mesmo resultado de chamadas
+ *        sucessivas a processarJogadaExpert()
+ * @param jogadas Jogadas na ordem em que foram feitas
+ * @param quantidade Número de jogadas
+ * @param sistemaPtr Ponteiro para o sistema Expert
+ *
+ * Pontuação, combos e subida de nível são calculados jogada a jogada, pois
+ * cada jogada depende da anterior. Os campos derivados dos totais ficam,
+ * como em processarJogadaExpert(), para sincronizarSistemaExpert(). Ao
+ * cruzar o limite do nível o estado é gravado e verificarProgressaoNivel()
+ * é chamada, de modo que multiplicador e dificuldade mudam na jogada exata.
+ */
+void processarLoteJogadasExpert(const JogadaPeca* jogadas, int quantidade, SistemaExpert* sistemaPtr) {
+    if (quantidade <= 0) {
+        return;
+    }
+
+    // O modo é decidido uma vez por lote, nunca dentro do laço
+    switch (sistemaPtr->regrasPontuacao) {
+        case REGRAS_EXPERT:
+            processarLoteRegras(jogadas, quantidade, sistemaPtr, &REGRAS_PONTUACAO_EXPERT);
+            break;
+        case REGRAS_CLASSICO:
+            processarLoteRegras(jogadas, quantidade, sistemaPtr, &REGRAS_PONTUACAO_CLASSICO);
+            break;
+        default:
+            processarLoteRegras(jogadas, quantidade, sistemaPtr, tabelaRegrasPontuacao[sistemaPtr->regrasPontuacao]);
+            break;
+    }
+}
+
+/**
+ * @brief Exibe estatísticas avançadas do sistema Expert
+ * @param sistemaPtr Ponteiro para o sistema Expert
+ */
+void exibirEstatisticasExpert(SistemaExpert* sistemaPtr) {
+    sincronizarSistemaExpert(sistemaPtr);
+    imprimirJogo("\n+==============================================================+\n");
+    imprimirJogo("|                    ESTATISTICAS EXPERT                      |\n");
+    imprimirJogo("+==============================================================+\n");
+    
+    // Pontuacao e Progressao
+    imprimirJogo("| Pontuacao Total: %8d  |  Nivel Atual: %3d            |\n", 
+           sistemaPtr->pontuacaoTotal, sistemaPtr->nivelAtual);
+    imprimirJogo("| Recorde Pessoal: %8d  |  Multiplicador: %.1fx         |\n", 
+           sistemaPtr->recordePessoal, sistemaPtr->multiplicadorAtual);
+    
+    // Progresso do nivel com barra visual
+    int progresso = (int)((double)sistemaPtr->pontuacaoTotal / sistemaPtr->limitePontosNivel * 20);
+    imprimirJogo("| Progresso: [");
+    for (int i = 0; i < 20; i++) {
+        imprimirJogo(i < progresso ? "#" : "-");
+    }
+    imprimirJogo("] %3d%%    |\n", (int)((double)sistemaPtr->pontuacaoTotal / sistemaPtr->limitePontosNivel * 100));
+    
+    // Combos e Sequencias
+    imprimirJogo("| Combo Atual: %3d      |  Melhor Combo: %3d           |\n", 
+           sistemaPtr->comboAtual, sistemaPtr->melhorCombo);
+    imprimirJogo("| Sequencia: %3d        |  Ultima Peca: %c              |\n", 
+           sistemaPtr->sequenciaTipoAtual, sistemaPtr->ultimoTipoJogado);
+    uint32_t completos = padroesComboCompletos(sistemaPtr);
+    if (completos != 0) {
+        imprimirJogo("| Padroes completos na ultima peca:");
+        for (int p = 0; p < motorCombos->quantidadePadroes; p++) {
+            if (completos & (1u << p)) {
+                imprimirJogo(" %s", motorCombos->nomes[p]);
+            }
+        }
+        imprimirJogo("\n");
+    }
+    
+    // Estatisticas de Tipos de Pecas
+    imprimirJogo("+==============================================================+\n");
+    imprimirJogo("| Tipo Mais Jogado: %c  |  Total de Jogadas: %4d        |\n", 
+           sistemaPtr->tipoMaisJogado, sistemaPtr->totalJogadas);
+    
+    imprimirJogo("| Tipos de Pecas:                                      |\n");
+    imprimirJogo("|   I:%2d  O:%2d  T:%2d  L:%2d                        |\n", 
+           sistemaPtr->contagemTipoI, sistemaPtr->contagemTipoO, 
+           sistemaPtr->contagemTipoT, sistemaPtr->contagemTipoL);
+    
+    // Eficiencia do Jogo
+    imprimirJogo("+==============================================================+\n");
+    imprimirJogo("| Jogadas da Fila: %4d   |  Jogadas da Pilha: %4d      |\n", 
+           sistemaPtr->jogadasDaFila, sistemaPtr->jogadasDaPilha);
+    
+    // Eficiencia da reserva com barra visual
+    int eficiencia = (int)(sistemaPtr->eficienciaReserva / 5); // Escala para 20 caracteres
+    imprimirJogo("| Eficiencia Reserva: [");
+    for (int i = 0; i < 20; i++) {
+        imprimirJogo(i < eficiencia ? "#" : "-");
+    }
+    imprimirJogo("] %5.1f%% |\n", (double)sistemaPtr->eficienciaReserva);
+    
+    // Conquistas e Marcos
+    imprimirJogo("| Marcos Alcancados: %2d  |  Fator Dificuldade: %.1fx      |\n", 
+           sistemaPtr->marcosAlcancados, sistemaPtr->fatorDificuldade);
+    
+    imprimirJogo("+==============================================================+\n");
+}
+
+/**
+ * @brief Otimiza e valida o sistema Expert
+ * @param sistemaPtr Ponteiro para o sistema Expert
+ * @return 1 se otimização foi aplicada, 0 caso contrário
+ */
+int otimizarSistemaExpert(SistemaExpert* sistemaPtr) {
+    int otimizacaoAplicada = 0;
+    const RegrasPontuacao* regrasPtr = tabelaRegrasPontuacao[sistemaPtr->regrasPontuacao];
+    sincronizarSistemaExpert(sistemaPtr);
+    
+    // Validação e correção de valores inconsistentes
+    if (sistemaPtr->multiplicadorAtual > regrasPtr->maximoMultiplicador) {
+        sistemaPtr->multiplicadorAtual = regrasPtr->maximoMultiplicador;
+        otimizacaoAplicada = 1;
+    }
+    
+    if (sistemaPtr->multiplicadorAtual < 1.0) {
+        sistemaPtr->multiplicadorAtual = 1.0;
+        otimizacaoAplicada = 1;
+    }
+    
+    // Recálculo da eficiência se necessário
+    if (sistemaPtr->totalJogadas > 0) {
+        double novaEficiencia = (double)sistemaPtr->jogadasDaPilha / sistemaPtr->totalJogadas * 100.0;
+        if (abs((int)(novaEficiencia - sistemaPtr->eficienciaReserva)) > 1) {
+            sistemaPtr->eficienciaReserva = novaEficiencia;
+            otimizacaoAplicada = 1;
+        }
+    }
+    
+    // Ajuste automático da dificuldade baseado no desempenho
+    if (sistemaPtr->nivelAtual > 5 && sistemaPtr->fatorDificuldade < 2.0) {
+        sistemaPtr->fatorDificuldade = 1.0 + (sistemaPtr->nivelAtual - 1) * regrasPtr->passoDificuldade;
+        otimizacaoAplicada = 1;
+    }
+    
+    return otimizacaoAplicada;
+}
+
+/**
+ * @brief Gera relatório detalhado do sistema Expert
+ * @param sistemaPtr Ponteiro para o sistema Expert
+ * @param tabPtr Tabuleiro atual (NULL para relatório apenas estatístico)
+ * @param filaPtr Fila de peças (peça atual na frente)
+ * @param pilhaPtr Pilha de reserva
+ *
+ * Com o tabuleiro disponível, as recomendações deixam de ser dicas genéricas
+ * e passam a indicar a melhor posição para a peça atual e para a reserva,
+ * segundo a avaliação de características do tabuleiro.
+ */
+void gerarRelatorioExpert(SistemaExpert* sistemaPtr, const Tabuleiro* tabPtr,
+                          FilaCircular* filaPtr, PilhaReserva* pilhaPtr) {
+    sincronizarSistemaExpert(sistemaPtr);
+    imprimirJogo("\n+==============================================================+\n");
+    imprimirJogo("|                     RELATORIO EXPERT                        |\n");
+    imprimirJogo("+==============================================================+\n");
+    
+    // Analise de Performance
+    imprimirJogo("\n*** ANALISE DE PERFORMANCE:\n");
+    imprimirJogo("   * Pontuacao Media por Jogada: %.1f\n", 
+           sistemaPtr->totalJogadas > 0 ? (double)sistemaPtr->pontuacaoTotal / sistemaPtr->totalJogadas : 0);
+    imprimirJogo("   * Taxa de Uso da Reserva: %.1f%%\n", 
+           sistemaPtr->totalJogadas > 0 ? (double)sistemaPtr->jogadasDaPilha / sistemaPtr->totalJogadas * 100 : 0);
+    imprimirJogo("   * Progressao de Nivel: %d niveis alcancados\n", sistemaPtr->nivelAtual - 1);
+    
+    // Recomendacoes Estrategicas
+    imprimirJogo("\n*** RECOMENDACOES ESTRATEGICAS:\n");
+    if (tabPtr != NULL) {
+        CaracteristicasTabuleiro carac;
+        extrairCaracteristicas(tabPtr, &carac);
+        imprimirJogo("   * Tabuleiro: altura %d | buracos %d | irregularidade %d | pocos %d\n",
+               carac.alturaAgregada, carac.buracos, carac.irregularidade, carac.pocos);
+
+        Jogada melhor;
+        double nota;
+        if (recomendarJogada(tabPtr, filaPtr, pilhaPtr, &PESOS_AVALIACAO_PADRAO, &melhor, &nota) > 0) {
+            imprimirJogo("   * Melhor jogada: peca %c da %s, rotacao %d, coluna %d (avaliacao %.2f)\n",
+                   melhor.tipo, melhor.origem == 0 ? "fila" : "reserva",
+                   melhor.rotacao, melhor.coluna + 1, nota);
+            if (melhor.viaDeslize) {
+                imprimirJogo("   * Encaixe exige queda suave e deslize lateral sob a saliencia\n");
+            }
+        } else {
+            imprimirJogo("   * Nenhuma posicao livre: o tabuleiro esta no topo\n");
+        }
+
+        // Comparar a peça atual com a reserva isoladamente
+        if (!filaVazia(filaPtr) && !pilhaVazia(pilhaPtr)) {
+            PilhaReserva semReserva;
+            FilaCircular semFila;
+            Jogada jogadaFila, jogadaPilha;
+            double notaFila, notaPilha;
+            inicializarPilha(&semReserva);
+            inicializarFila(&semFila);
+            if (recomendarJogada(tabPtr, filaPtr, &semReserva, &PESOS_AVALIACAO_PADRAO, &jogadaFila, &notaFila) > 0 &&
+                recomendarJogada(tabPtr, &semFila, pilhaPtr, &PESOS_AVALIACAO_PADRAO, &jogadaPilha, &notaPilha) > 0) {
+                imprimirJogo("   * Fila (%c): %.2f | Reserva (%c): %.2f -> %s\n",
+                       jogadaFila.tipo, notaFila, jogadaPilha.tipo, notaPilha,
+                       notaPilha > notaFila ? "use a reserva agora" : "mantenha a reserva");
+            }
+        }
+    } else {
+        if (sistemaPtr->eficienciaReserva < 20) {
+            imprimirJogo("   * Utilize mais a pilha de reserva para melhor estrategia\n");
+        }
+        if (sistemaPtr->melhorCombo < 5) {
+            imprimirJogo("   * Foque em formar combos de pecas consecutivas\n");
+        }
+        if (sistemaPtr->sequenciaTipoAtual < 3) {
+            imprimirJogo("   * Mantenha sequencias longas para maximizar multiplicadores\n");
+        }
+    }
+    
+    // Projecoes de Melhoria
+    imprimirJogo("\n*** PROJECOES DE MELHORIA:\n");
+    int proximoNivel = sistemaPtr->limitePontosNivel - sistemaPtr->pontuacaoTotal;
+    imprimirJogo("   * Pontos para proximo nivel: %d\n", proximoNivel);
+    imprimirJogo("   * Potencial de pontuacao com combo maximo: %d\n", 
+           sistemaPtr->pontuacaoTotal + (sistemaPtr->melhorCombo * 100));
+    imprimirJogo("   * Eficiencia otima da reserva: 40-60%%\n");
+}
+
+/**
+ * @brief Cria uma nova peça
+ * @param tipo Tipo da peça
+ * @param id ID da peça
+ * @return Nova peça criada
+ */
+Peca criarPeca(char tipo, int id) {
+    Peca novaPeca;
+    novaPeca.tipo = tipo;
+    novaPeca.id = id;
+    return novaPeca;
+}
+
+/**
+ * @brief Gera peças aleatórias para a fila
+ * @param filaPtr Ponteiro para a fila
+ */
+void gerarPecasAleatorias(FilaCircular* filaPtr) {
+    char tipos[] = {'I', 'O', 'T', 'S', 'Z', 'J', 'L'};
+    for (int i = 0; i < 5; i++) {
+        char tipoAleatorio = tipos[rand() % 7];
+        Peca novaPeca = criarPeca(tipoAleatorio, proximoId++);
+        inserirPecaNaFila(filaPtr, novaPeca);
+    }
+}
+
+/**
+ * @brief Transfere uma peça da fila para a pilha
+ * @param filaPtr Ponteiro para a fila
+ * @param pilhaPtr Ponteiro para a pilha
+ */
+void transferirPecaFilaParaPilha(FilaCircular* filaPtr, PilhaReserva* pilhaPtr) {
+    if (!filaVazia(filaPtr) && !pilhaCheia(pilhaPtr)) {
+        Peca peca = jogarPecaDaFila(filaPtr);
+        reservarPeca(pilhaPtr, peca);
+        if (!saidaSilenciosa) imprimirJogo("Peca %c transferida da fila para a pilha de reserva.\n", peca.tipo);
+    }
+}
+
+/**
+ * @brief Exibe o estado completo do sistema
+ * @param filaPtr Ponteiro para a fila
+ * @param pilhaPtr Ponteiro para a pilha
+ * @param sistemaPtr Ponteiro para o sistema Expert
+ */
+void exibirEstadoCompleto(FilaCircular* filaPtr, PilhaReserva* pilhaPtr, SistemaExpert* sistemaPtr) {
+    imprimirJogo("\n===============================================================\n");
+    imprimirJogo("                    ESTADO ATUAL DO SISTEMA\n");
+    imprimirJogo("===============================================================\n");
+    
+    exibirFila(filaPtr);
+    exibirPilha(pilhaPtr);
+    exibirEstatisticasExpert(sistemaPtr);
+}
+
+// ═══════════════════════════════════════════════════════════════════════════════
+//                       REGRAS DE PONTUAÇÃO E NÍVEIS
+// ═══════════════════════════════════════════════════════════════════════════════
+
+/**
+ * @brief Registra um conjunto de regras para uso pelas partidas
+ * @param regrasPtr Regras (copiadas)
+ * @return Índice para definirRegrasPontuacao(), ou -1 se o nome já existe
+ *         ou não há espaço
+ *
+ * Deve ser chamada antes de iniciar as partidas, como usarMotorCombos().
+ */
+int registrarRegrasPontuacao(const RegrasPontuacao* regrasPtr) {
+    static RegrasPontuacao registradas[MAX_REGRAS_PONTUACAO];
+    if (quantidadeRegrasPontuacao == MAX_REGRAS_PONTUACAO || buscarRegrasPontuacao(regrasPtr->nome) >= 0) {
+        return -1;
+    }
+    registradas[quantidadeRegrasPontuacao] = *regrasPtr;
+    tabelaRegrasPontuacao[quantidadeRegrasPontuacao] = &registradas[quantidadeRegrasPontuacao];
+    return quantidadeRegrasPontuacao++;
+}
+
+/**
+ * @brief Procura um conjunto de regras pelo nome
+ * @return Índice das regras, ou -1 se não existem
+ */
+int buscarRegrasPontuacao(const char* nome) {
+    for (int i = 0; i < quantidadeRegrasPontuacao; i++) {
+        if (strcmp(tabelaRegrasPontuacao[i]->nome, nome) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Regras de um índice (NULL se não há regras nele)
+ */
+const RegrasPontuacao* obterRegrasPontuacao(int indice) {
+    return indice >= 0 && indice < quantidadeRegrasPontuacao ? tabelaRegrasPontuacao[indice] : NULL;
+}
+
+/**
+ * @brief Passa uma partida recém-inicializada para outras regras
+ * @param sistemaPtr Sistema Expert logo após inicializarSistemaExpert()
+ * @param indice Índice das regras
+ * @return 1 em caso de sucesso, 0 se o índice não existe
+ */
+int definirRegrasPontuacao(SistemaExpert* sistemaPtr, int indice) {
+    const RegrasPontuacao* regrasPtr = obterRegrasPontuacao(indice);
+    if (regrasPtr == NULL) {
+        return 0;
+    }
+    sistemaPtr->regrasPontuacao = (uint8_t)indice;
+    sistemaPtr->limitePontosNivel = regrasPtr->limiteInicial;
+    sistemaPtr->pontosParaProximoNivel = regrasPtr->limiteInicial - sistemaPtr->pontuacaoTotal;
+    return 1;
+}
+
+/**
+ * @brief Remove espaços do início e do fim (altera o texto)
+ */
+static char* apararTexto(char* texto) {
+    while (*texto == ' ' || *texto == '\t') {
+        texto++;
+    }
+    char* fim = texto + strlen(texto);
+    while (fim > texto && (fim[-1] == ' ' || fim[-1] == '\t' || fim[-1] == '\r' || fim[-1] == '\n')) {
+        *--fim = '\0';
+    }
+    return texto;
+}
+
+/**
+ * @brief Aplica uma linha "chave = valor" de um arquivo de regras
+ * @return 1 se a chave e o valor são válidos
+ */
+static int lerCampoRegras(RegrasPontuacao* regrasPtr, const char* chave, char* valor) {
+    int lidos = 0;
+    if (strcmp(chave, "base") == 0) {
+        // "I:100 O:80 ... *:50", com '*' valendo para peças desconhecidas
+        char* contexto;
+        for (char* item = strtok_r(valor, " \t", &contexto); item != NULL; item = strtok_r(NULL, " \t", &contexto)) {
+            int pontos;
+            if (item[0] == '\0' || item[1] != ':' || sscanf(item + 2, "%d%n", &pontos, &lidos) != 1 ||
+                item[2 + lidos] != '\0' || pontos < 0) {
+                return 0;
+            }
+            if (item[0] == '*') {
+                for (int coluna = 0; coluna < COLUNAS_TIPO_PECA; coluna++) {
+                    if (indiceTipoPeca((char)('@' + coluna)) < 0) {
+                        regrasPtr->pontosBase[coluna] = pontos;
+                    }
+                }
+            } else if (indiceTipoPeca(item[0]) >= 0) {
+                regrasPtr->pontosBase[item[0] & (COLUNAS_TIPO_PECA - 1)] = pontos;
+            } else {
+                return 0;
+            }
+        }
+        return 1;
+    }
+    if (strcmp(chave, "curva") == 0) {
+        if (strcmp(valor, "absoluta") == 0) {
+            regrasPtr->curvaNivel = CURVA_NIVEL_ABSOLUTA;
+        } else if (strcmp(valor, "por-nivel") == 0) {
+            regrasPtr->curvaNivel = CURVA_NIVEL_POR_NIVEL;
+        } else {
+            return 0;
+        }
+        return 1;
+    }
+    if (strcmp(chave, "limite") == 0) {
+        return sscanf(valor, "%d%n", &regrasPtr->limiteInicial, &lidos) == 1 && valor[lidos] == '\0' &&
+               regrasPtr->limiteInicial > 0;
+    }
+    if (strcmp(chave, "crescimento") == 0) {
+        return sscanf(valor, "%lf%n", &regrasPtr->crescimentoNivel, &lidos) == 1 && valor[lidos] == '\0' &&
+               regrasPtr->crescimentoNivel >= 1.0;
+    }
+    if (strcmp(chave, "dificuldade") == 0) {
+        return sscanf(valor, "%lf %lf%n", &regrasPtr->passoDificuldade, &regrasPtr->maximoDificuldade, &lidos) == 2 &&
+               valor[lidos] == '\0';
+    }
+    if (strcmp(chave, "multiplicador") == 0) {
+        return sscanf(valor, "%lf %lf%n", &regrasPtr->passoMultiplicador, &regrasPtr->maximoMultiplicador, &lidos) == 2 &&
+               valor[lidos] == '\0';
+    }
+    return 0;
+}
+
+/**
+ * @brief Carrega e registra os conjuntos de regras de um arquivo
+ * @param caminho Arquivo de regras
+ * @return Número de conjuntos registrados, ou -1 em caso de erro (informado em stderr)
+ *
+ * Cada seção "[nome]" começa um conjunto com os valores das regras Expert,
+ * e as linhas "chave = valor" seguintes mudam o que for diferente:
+ * base (I:100 O:80 ... *:50), curva (absoluta ou por-nivel), limite,
+ * crescimento, dificuldade (passo máximo) e multiplicador (passo máximo).
+ * O que vem depois de '#' é comentário.
+ */
+int carregarRegrasPontuacao(const char* caminho) {
+    FILE* arquivo = fopen(caminho, "r");
+    if (arquivo == NULL) {
+        fprintf(stderr, "Nao foi possivel abrir o arquivo de regras %s\n", caminho);
+        return -1;
+    }
+    RegrasPontuacao regras;
+    char linha[256];
+    int numeroLinha = 0, emSecao = 0, carregadas = 0, valida = 1;
+    while (valida && fgets(linha, sizeof(linha), arquivo) != NULL) {
+        numeroLinha++;
+        char* comentario = strchr(linha, '#');
+        if (comentario != NULL) {
+            *comentario = '\0';
+        }
+        char* texto = apararTexto(linha);
+        if (*texto == '\0') {
+            continue;
+        }
+        if (*texto == '[') {
+            char* fim = strchr(texto, ']');
+            size_t tamanho = fim != NULL ? (size_t)(fim - texto - 1) : 0;
+            if (emSecao) {
+                valida = registrarRegrasPontuacao(&regras) >= 0;
+                carregadas += valida;
+            }
+            if (valida && (tamanho == 0 || tamanho >= TAMANHO_NOME_REGRAS || fim[1] != '\0')) {
+                valida = 0;
+            }
+            if (valida) {
+                regras = REGRAS_PONTUACAO_EXPERT;
+                memcpy(regras.nome, texto + 1, tamanho);
+                regras.nome[tamanho] = '\0';
+                emSecao = 1;
+            }
+            continue;
+        }
+        char* igual = strchr(texto, '=');
+        if (!emSecao || igual == NULL) {
+            valida = 0;
+            continue;
+        }
+        *igual = '\0';
+        valida = lerCampoRegras(&regras, apararTexto(texto), apararTexto(igual + 1));
+    }
+    fclose(arquivo);
+    if (valida && emSecao) {
+        valida = registrarRegrasPontuacao(&regras) >= 0;
+        carregadas += valida;
+    }
+    if (!valida) {
+        fprintf(stderr, "%s:%d: regras de pontuacao invalidas ou repetidas\n", caminho, numeroLinha);
+        return -1;
+    }
+    return carregadas;
+}
+
+// ═══════════════════════════════════════════════════════════════════════════════
+//                       PADRÕES DE COMBO (AUTÔMATO)
+// ═══════════════════════════════════════════════════════════════════════════════
+
+/// Padrões padrão: três peças iguais seguidas, a regra de combo original
+static const PadraoCombo PADROES_COMBO_PADRAO[] = {
+    {"Trinca I", "III", 0.2},
+    {"Trinca O", "OOO", 0.2},
+    {"Trinca T", "TTT", 0.2},
+    {"Trinca S", "SSS", 0.2},
+    {"Trinca Z", "ZZZ", 0.2},
+    {"Trinca J", "JJJ", 0.2},
+    {"Trinca L", "LLL", 0.2},
+};
+
+/// Palavras do conjunto de posições de um estado (uma posição por elemento de cada padrão)
+#define PALAVRAS_ESTADO_COMBO (MAX_PADROES_COMBO * MAX_ELEMENTOS_PADRAO_COMBO / 64)
+
+/**
+ * @brief Converte a expressão de um padrão nos tipos aceitos por elemento
+ * @param expressao Expressão do padrão (ver PadraoCombo)
+ * @param elementos Saída: bit i ligado se o tipo de índice i é aceito no elemento
+ * @return Número de elementos, ou 0 se a expressão é inválida ou longa demais
+ */
+static int lerExpressaoCombo(const char* expressao, uint8_t elementos[MAX_ELEMENTOS_PADRAO_COMBO]) {
+    int quantidade = 0;
+    const char* cursor = expressao;
+    while (*cursor != '\0') {
+        uint8_t aceitos = 0;
+        if (*cursor == '.') {
+            aceitos = (1u << NUMERO_TIPOS_PECA) - 1;
+            cursor++;
+        } else if (*cursor == '[') {
+            for (cursor++; *cursor != ']'; cursor++) {
+                int indice = indiceTipoPeca(*cursor);
+                if (indice < 0) {
+                    return 0;
+                }
+                aceitos |= (uint8_t)(1u << indice);
+            }
+            cursor++;
+        } else {
+            int indice = indiceTipoPeca(*cursor);
+            if (indice < 0) {
+                return 0;
+            }
+            aceitos = (uint8_t)(1u << indice);
+            cursor++;
+        }
+
+        int repeticoes = 1;
+        if (*cursor == '{') {
+            char* fim;
+            long valor = strtol(cursor + 1, &fim, 10);
+            if (*fim != '}' || valor < 1 || valor > MAX_ELEMENTOS_PADRAO_COMBO) {
+                return 0;
+            }
+            repeticoes = (int)valor;
+            cursor = fim + 1;
+        }
+        if (aceitos == 0 || quantidade + repeticoes > MAX_ELEMENTOS_PADRAO_COMBO) {
+            return 0;
+        }
+        while (repeticoes-- > 0) {
+            elementos[quantidade++] = aceitos;
+        }
+    }
+    return quantidade;
+}
+
+/**
+ * @brief Compila padrões de combo em um autômato determinístico
+ * @param motorPtr Motor a preencher
+ * @param padroes Padrões (os nomes devem continuar válidos enquanto o motor for usado)
+ * @param quantidade Número de padrões (até MAX_PADROES_COMBO)
+ * @return 1 em caso de sucesso, 0 se um padrão é inválido, o autômato passaria
+ *         de MAX_ESTADOS_COMBO estados ou faltou memória
+ *
+ * A posição p * MAX_ELEMENTOS_PADRAO_COMBO + k de um estado indica que os
+ * k + 1 primeiros elementos do padrão p terminam na última peça. O estado 0
+ * é o conjunto vazio; os demais são criados à medida que aparecem como
+ * destino de uma transição (construção de subconjuntos).
+ */
+int compilarMotorCombos(MotorCombos* motorPtr, const PadraoCombo* padroes, int quantidade) {
+    static const char tipos[NUMERO_TIPOS_PECA] = {'I', 'O', 'T', 'S', 'Z', 'J', 'L'};
+    memset(motorPtr, 0, sizeof(*motorPtr));
+    if (quantidade < 0 || quantidade > MAX_PADROES_COMBO) {
+        return 0;
+    }
+    uint8_t elementos[MAX_PADROES_COMBO][MAX_ELEMENTOS_PADRAO_COMBO];
+    int tamanhos[MAX_PADROES_COMBO];
+    for (int p = 0; p < quantidade; p++) {
+        tamanhos[p] = lerExpressaoCombo(padroes[p].expressao, elementos[p]);
+        if (tamanhos[p] == 0) {
+            return 0;
+        }
+        motorPtr->nomes[p] = padroes[p].nome;
+    }
+
+    uint64_t (*conjuntos)[PALAVRAS_ESTADO_COMBO] = calloc(MAX_ESTADOS_COMBO, sizeof(*conjuntos));
+    if (conjuntos == NULL) {
+        return 0;
+    }
+    int quantidadeEstados = 1;
+    for (int estado = 0; estado < quantidadeEstados; estado++) {
+        // Símbolo NUMERO_TIPOS_PECA: tipo desconhecido, que nenhum elemento aceita
+        int destinos[NUMERO_TIPOS_PECA + 1];
+        for (int simbolo = 0; simbolo <= NUMERO_TIPOS_PECA; simbolo++) {
+            uint64_t proximo[PALAVRAS_ESTADO_COMBO] = {0};
+            for (int p = 0; p < quantidade && simbolo < NUMERO_TIPOS_PECA; p++) {
+                for (int k = 0; k < tamanhos[p]; k++) {
+                    int anterior = p * MAX_ELEMENTOS_PADRAO_COMBO + k - 1;
+                    if (((elementos[p][k] >> simbolo) & 1) &&
+                        (k == 0 || ((conjuntos[estado][anterior / 64] >> (anterior % 64)) & 1))) {
+                        proximo[(anterior + 1) / 64] |= 1ULL << ((anterior + 1) % 64);
+                    }
+                }
+            }
+
+            int destino = 0;
+            while (destino < quantidadeEstados && memcmp(conjuntos[destino], proximo, sizeof(proximo)) != 0) {
+                destino++;
+            }
+            if (destino == quantidadeEstados) {
+                if (quantidadeEstados == MAX_ESTADOS_COMBO) {
+                    free(conjuntos);
+                    memset(motorPtr, 0, sizeof(*motorPtr));
+                    return 0;
+                }
+                memcpy(conjuntos[destino], proximo, sizeof(proximo));
+                for (int p = 0; p < quantidade; p++) {
+                    int ultima = p * MAX_ELEMENTOS_PADRAO_COMBO + tamanhos[p] - 1;
+                    if ((proximo[ultima / 64] >> (ultima % 64)) & 1) {
+                        motorPtr->completos[destino] |= 1u << p;
+                        motorPtr->bonus[destino] += padroes[p].bonus;
+                    }
+                }
+                quantidadeEstados++;
+            }
+            destinos[simbolo] = destino;
+        }
+
+        memset(motorPtr->transicoes[estado], destinos[NUMERO_TIPOS_PECA], COLUNAS_TIPO_PECA);
+        for (int simbolo = 0; simbolo < NUMERO_TIPOS_PECA; simbolo++) {
+            motorPtr->transicoes[estado][tipos[simbolo] & (COLUNAS_TIPO_PECA - 1)] = (uint8_t)destinos[simbolo];
+        }
+    }
+    free(conjuntos);
+    motorPtr->quantidadePadroes = quantidade;
+    motorPtr->quantidadeEstados = quantidadeEstados;
+    return 1;
+}
+
+static pthread_once_t motorCombosPadraoPronto = PTHREAD_ONCE_INIT;
+
+static void compilarMotorCombosPadrao(void) {
+    compilarMotorCombos(&motorCombosPadrao, PADROES_COMBO_PADRAO,
+                        (int)(sizeof(PADROES_COMBO_PADRAO) / sizeof(PADROES_COMBO_PADRAO[0])));
+}
+
+/**
+ * @brief Motor com os padrões de combo padrão, compilado no primeiro uso
+ */
+const MotorCombos* obterMotorCombosPadrao(void) {
+    pthread_once(&motorCombosPadraoPronto, compilarMotorCombosPadrao);
+    return &motorCombosPadrao;
+}
+
+/**
+ * @brief Troca o autômato de combos de todas as partidas
+ * @param motorPtr Motor compilado (NULL volta aos padrões padrão)
+ *
+ * Deve ser chamada antes de iniciar as partidas: o estadoCombo de um
+ * Sistema Expert só tem sentido no autômato que o produziu.
+ */
+void usarMotorCombos(const MotorCombos* motorPtr) {
+    motorCombos = motorPtr != NULL ? motorPtr : obterMotorCombosPadrao();
+}
+
+/**
+ * @brief Compila e passa a usar padrões dados como texto (linha de comando)
+ * @param lista Padrões separados por vírgula, cada um "expressao" ou
+ *              "expressao=bonus" (ex.: "III,ITIT=0.5,[IT]{3}"); é alterada e
+ *              deve continuar válida, pois as expressões viram os nomes
+ * @return 1 em caso de sucesso, 0 se algum padrão é inválido
+ */
+int configurarPadroesCombo(char* lista) {
+    static PadraoCombo padroes[MAX_PADROES_COMBO];
+    static MotorCombos motor;
+    int quantidade = 0;
+    for (char* item = strtok(lista, ","); item != NULL; item = strtok(NULL, ",")) {
+        if (quantidade == MAX_PADROES_COMBO) {
+            return 0;
+        }
+        char* separador = strchr(item, '=');
+        padroes[quantidade].bonus = 0.2;
+        if (separador != NULL) {
+            *separador = '\0';
+            padroes[quantidade].bonus = atof(separador + 1);
+        }
+        padroes[quantidade].nome = item;
+        padroes[quantidade].expressao = item;
+        quantidade++;
+    }
+    if (quantidade == 0 || !compilarMotorCombos(&motor, padroes, quantidade)) {
+        return 0;
+    }
+    usarMotorCombos(&motor);
+    return 1;
+}
+
+// ═══════════════════════════════════════════════════════════════════════════════
+//                      TABULEIRO EM BITMASK E GERADOR DE JOGADAS
+// ═══════════════════════════════════════════════════════════════════════════════
+
+/// Número de rotações distintas por tipo (O tem 1; I, S e Z são simétricas)
+static const unsigned char ROTACOES_DISTINTAS[NUMERO_TIPOS_PECA] = {2, 1, 4, 2, 2, 4, 4};
+
+/// Formas de cada tipo em cada rotação (base primeiro, bit 0 = coluna esquerda)
+static const FormaPeca FORMAS_PECA[NUMERO_TIPOS_PECA][4] = {
+    // I
+    {{{0xF, 0, 0, 0}, 4, 1}, {{0x1, 0x1, 0x1, 0x1}, 1, 4}},
+    // O
+    {{{0x3, 0x3, 0, 0}, 2, 2}},
+    // T
+    {{{0x7, 0x2, 0, 0}, 3, 2}, {{0x1, 0x3, 0x1, 0}, 2, 3},
+     {{0x2, 0x7, 0, 0}, 3, 2}, {{0x2, 0x3, 0x2, 0}, 2, 3}},
+    // S
+    {{{0x3, 0x6, 0, 0}, 3, 2}, {{0x2, 0x3, 0x1, 0}, 2, 3}},
+    // Z
+    {{{0x6, 0x3, 0, 0}, 3, 2}, {{0x1, 0x3, 0x2, 0}, 2, 3}},
+    // J
+    {{{0x7, 0x1, 0, 0}, 3, 2}, {{0x1, 0x1, 0x3, 0}, 2, 3},
+     {{0x4, 0x7, 0, 0}, 3, 2}, {{0x3, 0x2, 0x2, 0}, 2, 3}},
+    // L
+    {{{0x7, 0x4, 0, 0}, 3, 2}, {{0x3, 0x1, 0x1, 0}, 2, 3},
+     {{0x1, 0x7, 0, 0}, 3, 2}, {{0x2, 0x2, 0x3, 0}, 2, 3}},
+};
+
+/**
+ * @brief Converte o caractere do tipo para o índice das tabelas de formas
+ * @param tipoPeca Tipo da peça ('I', 'O', 'T', 'S', 'Z', 'J', 'L')
+ * @return Índice de 0 a 6, ou -1 para tipos desconhecidos
+ */
+int indiceTipoPeca(char tipoPeca) {
     switch (tipoPeca) {
-        case 'I': pontuacaoBase = 100; break; // Linha reta
-        case 'O': pontuacaoBase = 80;  break; // Quadrado
-        case 'T': pontuacaoBase = 90;  break; // T
-        case 'S': pontuacaoBase = 85;  break; // S
-        case 'Z': pontuacaoBase = 85;  break; // Z
-        case 'J': pontuacaoBase = 75;  break; // J
-        case 'L': pontuacaoBase = 75;  break; // L
-        default:  pontuacaoBase = 50;  break; // Peça desconhecida
+        case 'I': return 0;
+        case 'O': return 1;
+        case 'T': return 2;
+        case 'S': return 3;
+        case 'Z': return 4;
+        case 'J': return 5;
+        case 'L': return 6;
+        default:  return -1;
+    }
+}
+
+/**
+ * @brief Esvazia todas as linhas do tabuleiro
+ * @param tabPtr Ponteiro para o tabuleiro
+ */
+void limparTabuleiro(Tabuleiro* tabPtr) {
+    memset(tabPtr->linhas, 0, sizeof(tabPtr->linhas));
+}
+
+/**
+ * @brief Calcula o fecho horizontal de um conjunto de colunas alcançáveis
+ * @param alcance Colunas já alcançadas (bit x = coluna x)
+ * @param livre Colunas onde a peça cabe nesta linha
+ * @return Todas as colunas alcançáveis deslizando lateralmente dentro de livre
+ */
+static inline uint16_t expandirHorizontal(uint16_t alcance, uint16_t livre) {
+    // Preenchimento Kogge-Stone nas duas direções: log2(16) passos fixos
+    uint32_t direita = alcance & livre, esquerda = direita;
+    uint32_t propagaDireita = livre, propagaEsquerda = livre;
+    for (int passo = 1; passo < 16; passo <<= 1) {
+        direita |= propagaDireita & (direita << passo);
+        propagaDireita &= propagaDireita << passo;
+        esquerda |= propagaEsquerda & (esquerda >> passo);
+        propagaEsquerda &= propagaEsquerda >> passo;
+    }
+    return (uint16_t)(direita | esquerda);
+}
+
+/**
+ * @brief Enumera todas as posições finais legais de uma peça
+ * @param tabPtr Ponteiro para o tabuleiro
+ * @param tipoPeca Tipo da peça a posicionar
+ * @param origem Origem gravada nas jogadas (0=fila, 1=pilha)
+ * @param saida Vetor fornecido pelo chamador
+ * @param capacidade Número máximo de jogadas a escrever em saida
+ * @return Número de jogadas escritas
+ *
+ * A peça surge no topo, centralizada, em cada rotação distinta. A partir daí
+ * o alcance é propagado linha a linha com operações de bits: a peça pode
+ * deslizar para os lados enquanto couber e descer enquanto houver espaço.
+ * Assim são encontradas tanto as quedas diretas quanto os encaixes sob
+ * saliências (tucks), sem duplicatas por simetria de rotação.
+ */
+int gerarJogadas(const Tabuleiro* tabPtr, char tipoPeca, int origem, Jogada* saida, int capacidade) {
+    int indiceTipo = indiceTipoPeca(tipoPeca);
+    if (indiceTipo < 0 || capacidade <= 0) {
+        return 0;
+    }
+
+    // Acima da linha mais alta ocupada qualquer coluna é livre
+    int alturaPilha = ALTURA_TABULEIRO;
+    while (alturaPilha > 0 && tabPtr->linhas[alturaPilha - 1] == 0) {
+        alturaPilha--;
+    }
+
+    int total = 0;
+    for (int rotacao = 0; rotacao < ROTACOES_DISTINTAS[indiceTipo]; rotacao++) {
+        const FormaPeca* forma = &FORMAS_PECA[indiceTipo][rotacao];
+        int linhaTopo = ALTURA_TABULEIRO - forma->altura;
+        int colunas = LARGURA_TABULEIRO - forma->largura + 1;
+
+        // livre[y]: colunas onde a peça cabe com a base na linha y
+        uint16_t livre[ALTURA_TABULEIRO];
+        uint16_t todasColunas = (uint16_t)((1u << colunas) - 1);
+        for (int y = 0; y <= linhaTopo; y++) {
+            if (y >= alturaPilha) {
+                livre[y] = todasColunas;
+                continue;
+            }
+            // A peça colide na coluna x se algum bloco (i, b) cai sobre linhas[y+i] bit x+b
+            uint16_t colisao = 0;
+            for (int i = 0; i < forma->altura; i++) {
+                for (uint16_t blocos = forma->linhas[i]; blocos; blocos &= (uint16_t)(blocos - 1)) {
+                    colisao |= (uint16_t)(tabPtr->linhas[y + i] >> __builtin_ctz(blocos));
+                }
+            }
+            uint16_t mascara = (uint16_t)(~colisao & todasColunas);
+            livre[y] = mascara;
+        }
+
+        uint16_t surgimento = (uint16_t)(1u << ((LARGURA_TABULEIRO - forma->largura) / 2));
+        if (!(livre[linhaTopo] & surgimento)) {
+            continue; // Rotação bloqueada já no surgimento
+        }
+
+        // Propagação do topo para a base: alcance total e queda direta por coluna
+        uint16_t alcance = expandirHorizontal(surgimento, livre[linhaTopo]);
+        uint16_t quedaDireta = alcance;
+        for (int y = linhaTopo; y >= 0 && alcance; y--) {
+            if (y < linhaTopo) {
+                quedaDireta &= livre[y];
+                alcance = expandirHorizontal(alcance & livre[y], livre[y]);
+            }
+
+            uint16_t apoiadas = (y == 0) ? alcance : (uint16_t)(alcance & ~livre[y - 1]);
+            uint16_t diretas = (y == 0) ? quedaDireta : (uint16_t)(quedaDireta & ~livre[y - 1]);
+            while (apoiadas) {
+                int x = __builtin_ctz(apoiadas);
+                apoiadas &= (uint16_t)(apoiadas - 1);
+                if (total == capacidade) {
+                    return total;
+                }
+                Jogada* jogada = &saida[total++];
+                jogada->tipo = tipoPeca;
+                jogada->rotacao = (unsigned char)rotacao;
+                jogada->coluna = (unsigned char)x;
+                jogada->linha = (unsigned char)y;
+                jogada->origem = (unsigned char)origem;
+                jogada->viaDeslize = !(diretas & (1u << x));
+            }
+        }
+    }
+
+    return total;
+}
+
+/**
+ * @brief Enumera as jogadas da peça atual da fila e do topo da reserva
+ * @param tabPtr Ponteiro para o tabuleiro
+ * @param filaPtr Ponteiro para a fila (a peça da frente é a peça atual)
+ * @param pilhaPtr Ponteiro para a pilha (o topo é a peça que sairia no pop)
+ * @param saida Vetor fornecido pelo chamador
+ * @param capacidade Número máximo de jogadas a escrever em saida
+ * @return Número de jogadas escritas (fila primeiro, depois pilha)
+ */
+int gerarJogadasComReserva(const Tabuleiro* tabPtr, FilaCircular* filaPtr, PilhaReserva* pilhaPtr,
+                           Jogada* saida, int capacidade) {
+    int total = 0;
+    if (!filaVazia(filaPtr)) {
+        char atual = espiarFila(filaPtr, 0)->tipo;
+        total += gerarJogadas(tabPtr, atual, 0, saida, capacidade);
+    }
+    if (!pilhaVazia(pilhaPtr)) {
+        char reserva = espiarPilha(pilhaPtr, 0)->tipo;
+        total += gerarJogadas(tabPtr, reserva, 1, saida + total, capacidade - total);
+    }
+    return total;
+}
+
+/**
+ * @brief Fixa a peça da jogada no tabuleiro e remove as linhas completas
+ * @param tabPtr Ponteiro para o tabuleiro
+ * @param jogadaPtr Jogada produzida pelo gerador
+ * @return Número de linhas eliminadas (0-4), ou -1 se o tipo ou a rotação
+ *         não existem na tabela de formas (o tabuleiro não é alterado)
+ */
+int aplicarJogada(Tabuleiro* tabPtr, const Jogada* jogadaPtr) {
+    int indiceTipo = indiceTipoPeca(jogadaPtr->tipo);
+    if (indiceTipo < 0 || jogadaPtr->rotacao > 3) {
+        return -1;
+    }
+    const FormaPeca* forma = &FORMAS_PECA[indiceTipo][jogadaPtr->rotacao];
+    for (int i = 0; i < forma->altura; i++) {
+        tabPtr->linhas[jogadaPtr->linha + i] |= (uint16_t)(forma->linhas[i] << jogadaPtr->coluna);
+    }
+
+    // Compactação: copia para baixo apenas as linhas incompletas
+    int destino = jogadaPtr->linha;
+    for (int y = jogadaPtr->linha; y < ALTURA_TABULEIRO; y++) {
+        if (tabPtr->linhas[y] != LINHA_COMPLETA) {
+            tabPtr->linhas[destino++] = tabPtr->linhas[y];
+        }
+    }
+    int linhasEliminadas = ALTURA_TABULEIRO - destino;
+    while (destino < ALTURA_TABULEIRO) {
+        tabPtr->linhas[destino++] = 0;
+    }
+    return linhasEliminadas;
+}
+
+/**
+ * @brief Indica quais linhas a jogada completaria, antes de aplicá-la
+ * @param tabPtr Tabuleiro antes da jogada
+ * @param jogadaPtr Jogada produzida pelo gerador
+ * @return Máscara com o bit i ligado se a linha jogada.linha + i ficaria completa
+ *         (0 para tipo ou rotação inválidos)
+ */
+int linhasCompletadasPorJogada(const Tabuleiro* tabPtr, const Jogada* jogadaPtr) {
+    int indiceTipo = indiceTipoPeca(jogadaPtr->tipo);
+    if (indiceTipo < 0 || jogadaPtr->rotacao > 3) {
+        return 0;
+    }
+    const FormaPeca* forma = &FORMAS_PECA[indiceTipo][jogadaPtr->rotacao];
+    int mascara = 0;
+    for (int i = 0; i < forma->altura; i++) {
+        uint16_t linha = tabPtr->linhas[jogadaPtr->linha + i] | (uint16_t)(forma->linhas[i] << jogadaPtr->coluna);
+        if (linha == LINHA_COMPLETA) {
+            mascara |= 1 << i;
+        }
+    }
+    return mascara;
+}
+
+/**
+ * @brief Desfaz aplicarJogada(): reinsere as linhas eliminadas e retira a peça
+ * @param tabPtr Tabuleiro depois da jogada
+ * @param jogadaPtr Jogada aplicada
+ * @param linhasCompletadas Máscara de linhasCompletadasPorJogada() antes da jogada
+ */
+void desfazerJogada(Tabuleiro* tabPtr, const Jogada* jogadaPtr, int linhasCompletadas) {
+    int indiceTipo = indiceTipoPeca(jogadaPtr->tipo);
+    if (indiceTipo < 0 || jogadaPtr->rotacao > 3) {
+        return;
+    }
+    const FormaPeca* forma = &FORMAS_PECA[indiceTipo][jogadaPtr->rotacao];
+
+    // De baixo para cima, cada linha eliminada volta à sua altura original
+    for (int i = 0; i < forma->altura; i++) {
+        if (linhasCompletadas & (1 << i)) {
+            int y = jogadaPtr->linha + i;
+            memmove(&tabPtr->linhas[y + 1], &tabPtr->linhas[y],
+                    sizeof(uint16_t) * (ALTURA_TABULEIRO - 1 - y));
+            tabPtr->linhas[y] = LINHA_COMPLETA;
+        }
+    }
+    for (int i = 0; i < forma->altura; i++) {
+        tabPtr->linhas[jogadaPtr->linha + i] &= (uint16_t)~(forma->linhas[i] << jogadaPtr->coluna);
+    }
+}
+
+// ═══════════════════════════════════════════════════════════════════════════════
+//                          AVALIAÇÃO VETORIZADA DE TABULEIROS
+// ═══════════════════════════════════════════════════════════════════════════════
+
+#define PAREDE_ESQUERDA 0x0001  ///< Bit da parede à esquerda após deslocar a linha 1 bit
+#define PAREDE_DIREITA 0x0400   ///< Bit da parede à direita (coluna 10)
+
+/**
+ * @brief Extrai as características de um único tabuleiro (versão escalar)
+ * @param tabPtr Ponteiro para o tabuleiro
+ * @param caracPtr Características calculadas
+ *
+ * Percorre as linhas do topo para a base acumulando a "cobertura" (colunas
+ * com algum bloco na linha atual ou acima). A altura de uma coluna é o número
+ * de linhas em que ela está coberta, então todas as características viram
+ * contagens de bits por linha.
+ */
+void extrairCaracteristicas(const Tabuleiro* tabPtr, CaracteristicasTabuleiro* caracPtr) {
+    unsigned int cobertura = 0;
+    int altura = 0, buracos = 0, irregularidade = 0, pocos = 0, transicoes = 0;
+
+    for (int y = ALTURA_TABULEIRO - 1; y >= 0; y--) {
+        unsigned int linha = tabPtr->linhas[y];
+        cobertura |= linha;
+        altura += __builtin_popcount(cobertura);
+        buracos += __builtin_popcount(cobertura & ~linha);
+        irregularidade += __builtin_popcount((cobertura ^ (cobertura >> 1)) & 0x01FF);
+        pocos += __builtin_popcount(~cobertura & ((cobertura << 1) | PAREDE_ESQUERDA) &
+                                    ((cobertura >> 1) | (PAREDE_DIREITA >> 1)) & LINHA_COMPLETA);
+        transicoes += __builtin_popcount((((linha << 1) | PAREDE_ESQUERDA) ^ (linha | PAREDE_DIREITA)) & 0x07FF);
+    }
+
+    caracPtr->alturaAgregada = altura;
+    caracPtr->buracos = buracos;
+    caracPtr->irregularidade = irregularidade;
+    caracPtr->pocos = pocos;
+    caracPtr->transicoesLinha = transicoes;
+}
+
+/**
+ * @brief Combina as características com os pesos da avaliação linear
+ */
+static inline double pontuarCaracteristicas(const CaracteristicasTabuleiro* caracPtr, int linhas,
+                                            const PesosAvaliacao* pesosPtr) {
+    return pesosPtr->pesoAltura * caracPtr->alturaAgregada +
+           pesosPtr->pesoBuracos * caracPtr->buracos +
+           pesosPtr->pesoIrregularidade * caracPtr->irregularidade +
+           pesosPtr->pesoPocos * caracPtr->pocos +
+           pesosPtr->pesoTransicoes * caracPtr->transicoesLinha +
+           pesosPtr->pesoLinhas * linhas;
+}
+
+#ifdef __SSE2__
+/**
+ * @brief Contagem de bits independente em cada lane de 16 bits
+ */
+static inline __m128i contarBits16(__m128i x) {
+    x = _mm_sub_epi16(x, _mm_and_si128(_mm_srli_epi16(x, 1), _mm_set1_epi16(0x5555)));
+    x = _mm_add_epi16(_mm_and_si128(x, _mm_set1_epi16(0x3333)),
+                      _mm_and_si128(_mm_srli_epi16(x, 2), _mm_set1_epi16(0x3333)));
+    x = _mm_and_si128(_mm_add_epi16(x, _mm_srli_epi16(x, 4)), _mm_set1_epi16(0x0F0F));
+    return _mm_and_si128(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), _mm_set1_epi16(0x001F));
+}
+
+/**
+ * @brief Transpõe 8 blocos de 8 linhas: saída[y] recebe a linha y de cada tabuleiro
+ */
+static inline void transporLinhas8x8(__m128i r[8]) {
+    __m128i a0 = _mm_unpacklo_epi16(r[0], r[1]), a1 = _mm_unpackhi_epi16(r[0], r[1]);
+    __m128i a2 = _mm_unpacklo_epi16(r[2], r[3]), a3 = _mm_unpackhi_epi16(r[2], r[3]);
+    __m128i a4 = _mm_unpacklo_epi16(r[4], r[5]), a5 = _mm_unpackhi_epi16(r[4], r[5]);
+    __m128i a6 = _mm_unpacklo_epi16(r[6], r[7]), a7 = _mm_unpackhi_epi16(r[6], r[7]);
+    __m128i b0 = _mm_unpacklo_epi32(a0, a2), b1 = _mm_unpackhi_epi32(a0, a2);
+    __m128i b2 = _mm_unpacklo_epi32(a1, a3), b3 = _mm_unpackhi_epi32(a1, a3);
+    __m128i b4 = _mm_unpacklo_epi32(a4, a6), b5 = _mm_unpackhi_epi32(a4, a6);
+    __m128i b6 = _mm_unpacklo_epi32(a5, a7), b7 = _mm_unpackhi_epi32(a5, a7);
+    r[0] = _mm_unpacklo_epi64(b0, b4); r[1] = _mm_unpackhi_epi64(b0, b4);
+    r[2] = _mm_unpacklo_epi64(b1, b5); r[3] = _mm_unpackhi_epi64(b1, b5);
+    r[4] = _mm_unpacklo_epi64(b2, b6); r[5] = _mm_unpackhi_epi64(b2, b6);
+    r[6] = _mm_unpacklo_epi64(b3, b7); r[7] = _mm_unpackhi_epi64(b3, b7);
+}
+
+/**
+ * @brief Extrai as características de 8 tabuleiros de uma vez
+ * @param lote Primeiro dos 8 tabuleiros consecutivos
+ * @param caracs Vetor de 8 características de saída
+ *
+ * Cada lane de 16 bits carrega a mesma linha de um tabuleiro diferente, de
+ * modo que a varredura topo-base da versão escalar roda para os 8 em paralelo.
+ */
+static void extrairCaracteristicas8(const Tabuleiro* lote, CaracteristicasTabuleiro* caracs) {
+    __m128i linhas[ALTURA_TABULEIRO];
+    for (int bloco = 0; bloco < ALTURA_TABULEIRO / 8; bloco++) {
+        __m128i* destino = &linhas[bloco * 8];
+        for (int t = 0; t < 8; t++) {
+            destino[t] = _mm_loadu_si128((const __m128i*)&lote[t].linhas[bloco * 8]);
+        }
+        transporLinhas8x8(destino);
+    }
+
+    const __m128i mascaraLinha = _mm_set1_epi16(LINHA_COMPLETA);
+    const __m128i mascaraVizinhos = _mm_set1_epi16(0x01FF);
+    const __m128i mascaraTransicoes = _mm_set1_epi16(0x07FF);
+    const __m128i paredeEsquerda = _mm_set1_epi16(PAREDE_ESQUERDA);
+    const __m128i paredeDireita = _mm_set1_epi16(PAREDE_DIREITA);
+    const __m128i paredeDireitaVizinha = _mm_set1_epi16(PAREDE_DIREITA >> 1);
+
+    __m128i cobertura = _mm_setzero_si128();
+    __m128i altura = _mm_setzero_si128(), buracos = _mm_setzero_si128();
+    __m128i irregularidade = _mm_setzero_si128(), pocos = _mm_setzero_si128();
+    __m128i transicoes = _mm_setzero_si128();
+
+    for (int y = ALTURA_TABULEIRO - 1; y >= 0; y--) {
+        __m128i linha = linhas[y];
+        cobertura = _mm_or_si128(cobertura, linha);
+        altura = _mm_add_epi16(altura, contarBits16(cobertura));
+        buracos = _mm_add_epi16(buracos, contarBits16(_mm_andnot_si128(linha, cobertura)));
+        irregularidade = _mm_add_epi16(irregularidade, contarBits16(_mm_and_si128(
+            _mm_xor_si128(cobertura, _mm_srli_epi16(cobertura, 1)), mascaraVizinhos)));
+        __m128i vizinhoEsquerdo = _mm_or_si128(_mm_slli_epi16(cobertura, 1), paredeEsquerda);
+        __m128i vizinhoDireito = _mm_or_si128(_mm_srli_epi16(cobertura, 1), paredeDireitaVizinha);
+        pocos = _mm_add_epi16(pocos, contarBits16(_mm_andnot_si128(cobertura,
+            _mm_and_si128(_mm_and_si128(vizinhoEsquerdo, vizinhoDireito), mascaraLinha))));
+        __m128i bordas = _mm_xor_si128(_mm_or_si128(_mm_slli_epi16(linha, 1), paredeEsquerda),
+                                       _mm_or_si128(linha, paredeDireita));
+        transicoes = _mm_add_epi16(transicoes, contarBits16(_mm_and_si128(bordas, mascaraTransicoes)));
+    }
+
+    uint16_t valores[5][8];
+    _mm_storeu_si128((__m128i*)valores[0], altura);
+    _mm_storeu_si128((__m128i*)valores[1], buracos);
+    _mm_storeu_si128((__m128i*)valores[2], irregularidade);
+    _mm_storeu_si128((__m128i*)valores[3], pocos);
+    _mm_storeu_si128((__m128i*)valores[4], transicoes);
+    for (int t = 0; t < 8; t++) {
+        caracs[t].alturaAgregada = valores[0][t];
+        caracs[t].buracos = valores[1][t];
+        caracs[t].irregularidade = valores[2][t];
+        caracs[t].pocos = valores[3][t];
+        caracs[t].transicoesLinha = valores[4][t];
+    }
+}
+#endif
+
+/**
+ * @brief Avalia um lote de tabuleiros candidatos
+ * @param lote Tabuleiros resultantes de cada jogada candidata
+ * @param linhasEliminadas Linhas eliminadas por cada jogada (NULL = nenhuma)
+ * @param quantidade Número de tabuleiros no lote
+ * @param pesosPtr Pesos da avaliação linear
+ * @param notas Nota de cada tabuleiro (maior é melhor)
+ *
+ * Com SSE2 os tabuleiros são processados de 8 em 8; o restante (e
+ * compilações sem SSE2) usa a versão escalar, que produz os mesmos valores.
+ */
+void avaliarLoteTabuleiros(const Tabuleiro* lote, const int* linhasEliminadas, int quantidade,
+                           const PesosAvaliacao* pesosPtr, double* notas) {
+    int i = 0;
+#ifdef __SSE2__
+    CaracteristicasTabuleiro caracs[8];
+    for (; i + 8 <= quantidade; i += 8) {
+        extrairCaracteristicas8(&lote[i], caracs);
+        for (int t = 0; t < 8; t++) {
+            int linhas = linhasEliminadas ? linhasEliminadas[i + t] : 0;
+            notas[i + t] = pontuarCaracteristicas(&caracs[t], linhas, pesosPtr);
+        }
+    }
+#endif
+    for (; i < quantidade; i++) {
+        CaracteristicasTabuleiro carac;
+        extrairCaracteristicas(&lote[i], &carac);
+        notas[i] = pontuarCaracteristicas(&carac, linhasEliminadas ? linhasEliminadas[i] : 0, pesosPtr);
+    }
+}
+
+/**
+ * @brief Escolhe a melhor jogada entre as candidatas já geradas
+ * @return Índice da melhor jogada, ou -1 se não houver candidatas
+ */
+static int escolherMelhorJogada(const Tabuleiro* tabPtr, const Jogada* jogadas, int quantidade,
+                                const PesosAvaliacao* pesosPtr, double* notaPtr) {
+    if (quantidade <= 0) {
+        return -1;
+    }
+    if (quantidade > MAX_JOGADAS) {
+        quantidade = MAX_JOGADAS;
+    }
+
+    Tabuleiro candidatos[MAX_JOGADAS];
+    int linhas[MAX_JOGADAS];
+    double notas[MAX_JOGADAS];
+
+    for (int i = 0; i < quantidade; i++) {
+        candidatos[i] = *tabPtr;
+        linhas[i] = aplicarJogada(&candidatos[i], &jogadas[i]);
+    }
+    avaliarLoteTabuleiros(candidatos, linhas, quantidade, pesosPtr, notas);
+
+    int melhor = -1;
+    for (int i = 0; i < quantidade; i++) {
+        if (melhor < 0 || notas[i] > notas[melhor]) {
+            melhor = i;
+        }
+    }
+    if (melhor >= 0 && notaPtr) {
+        *notaPtr = notas[melhor];
+    }
+    return melhor;
+}
+
+/**
+ * @brief Recomenda a melhor jogada para a peça atual ou para o topo da reserva
+ * @param tabPtr Tabuleiro atual
+ * @param filaPtr Fila de peças
+ * @param pilhaPtr Pilha de reserva
+ * @param pesosPtr Pesos da avaliação
+ * @param melhorPtr Jogada recomendada (saída)
+ * @param notaPtr Avaliação da jogada recomendada (saída, pode ser NULL)
+ * @return Número de jogadas candidatas consideradas (0 = nenhuma possível)
+ */
+int recomendarJogada(const Tabuleiro* tabPtr, FilaCircular* filaPtr, PilhaReserva* pilhaPtr,
+                     const PesosAvaliacao* pesosPtr, Jogada* melhorPtr, double* notaPtr) {
+    Jogada jogadas[MAX_JOGADAS];
+    int quantidade = gerarJogadasComReserva(tabPtr, filaPtr, pilhaPtr, jogadas, MAX_JOGADAS);
+    int melhor = escolherMelhorJogada(tabPtr, jogadas, quantidade, pesosPtr, notaPtr);
+    if (melhor >= 0) {
+        *melhorPtr = jogadas[melhor];
+    }
+    return quantidade;
+}
+
+/**
+ * @brief Posiciona uma peça jogada na melhor posição segundo a avaliação
+ * @param tabPtr Tabuleiro a atualizar
+ * @param tipoPeca Tipo da peça jogada
+ * @param origem Origem da peça (0=fila, 1=pilha)
+ * @param pesosPtr Pesos da avaliação
+ * @param escolhidaPtr Jogada aplicada (saída, pode ser NULL)
+ * @return Linhas eliminadas, ou -1 se a peça não cabe em nenhuma posição
+ */
+int posicionarPecaNoTabuleiro(Tabuleiro* tabPtr, char tipoPeca, int origem,
+                              const PesosAvaliacao* pesosPtr, Jogada* escolhidaPtr) {
+    Jogada jogadas[MAX_JOGADAS];
+    int quantidade = gerarJogadas(tabPtr, tipoPeca, origem, jogadas, MAX_JOGADAS);
+    int melhor = escolherMelhorJogada(tabPtr, jogadas, quantidade, pesosPtr, NULL);
+    if (melhor < 0) {
+        return -1;
+    }
+    if (escolhidaPtr) {
+        *escolhidaPtr = jogadas[melhor];
+    }
+    return aplicarJogada(tabPtr, &jogadas[melhor]);
+}
+
+/**
+ * @brief Encaixa no tabuleiro a peça jogada pelo menu e informa a posição
+ * @param tabPtr Tabuleiro da partida
+ * @param peca Peça jogada
+ * @param origem Origem da peça (0=fila, 1=pilha)
+ * @param jogadaPtr Encaixe aplicado (saída)
+ * @return Máscara de linhasCompletadasPorJogada(), ou -1 se o campo foi reiniciado
+ *
+ * Se a peça não couber em nenhuma posição o campo é reiniciado, como em
+ * um fim de partida, e a peça é encaixada no campo vazio.
+ */
+int encaixarPecaJogada(Tabuleiro* tabPtr, Peca peca, int origem, Jogada* jogadaPtr) {
+    Jogada jogadas[MAX_JOGADAS];
+    int quantidade = gerarJogadas(tabPtr, peca.tipo, origem, jogadas, MAX_JOGADAS);
+    int melhor = escolherMelhorJogada(tabPtr, jogadas, quantidade, &PESOS_AVALIACAO_PADRAO, NULL);
+    int reiniciado = melhor < 0;
+    if (reiniciado) {
+        imprimirJogo("Tabuleiro cheio! Campo reiniciado.\n");
+        limparTabuleiro(tabPtr);
+        quantidade = gerarJogadas(tabPtr, peca.tipo, origem, jogadas, MAX_JOGADAS);
+        melhor = escolherMelhorJogada(tabPtr, jogadas, quantidade, &PESOS_AVALIACAO_PADRAO, NULL);
+    }
+    *jogadaPtr = jogadas[melhor];
+    int mascara = linhasCompletadasPorJogada(tabPtr, jogadaPtr);
+    int linhas = aplicarJogada(tabPtr, jogadaPtr);
+
+    imprimirJogo("Encaixe: rotacao %d, coluna %d", jogadaPtr->rotacao, jogadaPtr->coluna + 1);
+    if (linhas > 0) {
+        imprimirJogo(" | %d linha(s) eliminada(s)", linhas);
+    }
+    imprimirJogo("\n");
+    return reiniciado ? -1 : mascara;
+}
+
+// ═══════════════════════════════════════════════════════════════════════════════
+//                       MEMÓRIA: ARENAS E POOLS DE OBJETOS
+// ═══════════════════════════════════════════════════════════════════════════════
+
+/**
+ * @brief Esvazia a arena garantindo ao menos bytesNecessarios de capacidade
+ * @param arenaPtr Arena a reiniciar
+ * @param bytesNecessarios Capacidade mínima para o próximo uso
+ */
+void reiniciarArena(ArenaMemoria* arenaPtr, size_t bytesNecessarios) {
+    if (arenaPtr->capacidade < bytesNecessarios) {
+        free(arenaPtr->memoria);
+        arenaPtr->memoria = malloc(bytesNecessarios);
+        arenaPtr->capacidade = arenaPtr->memoria ? bytesNecessarios : 0;
+        arenaPtr->alocacoesSistema++;
+    }
+    arenaPtr->usado = 0;
+}
+
+/**
+ * @brief Entrega um bloco da arena alinhado a 16 bytes
+ * @param arenaPtr Arena de origem
+ * @param bytes Tamanho do bloco
+ * @return Bloco, ou NULL se a capacidade reservada acabou
+ */
+void* alocarDaArena(ArenaMemoria* arenaPtr, size_t bytes) {
+    bytes = (bytes + 15) & ~(size_t)15;
+    if (arenaPtr->usado + bytes > arenaPtr->capacidade) {
+        return NULL;
+    }
+    void* bloco = arenaPtr->memoria + arenaPtr->usado;
+    arenaPtr->usado += bytes;
+    if (arenaPtr->usado > arenaPtr->picoUsado) {
+        arenaPtr->picoUsado = arenaPtr->usado;
+    }
+    return bloco;
+}
+
+/**
+ * @brief Devolve o bloco da arena ao sistema (as estatísticas são mantidas)
+ * @param arenaPtr Arena a liberar
+ */
+void liberarArena(ArenaMemoria* arenaPtr) {
+    free(arenaPtr->memoria);
+    arenaPtr->memoria = NULL;
+    arenaPtr->capacidade = 0;
+    arenaPtr->usado = 0;
+}
+
+/**
+ * @brief Prepara um pool vazio
+ * @param poolPtr Pool a inicializar
+ * @param tamanhoObjeto Tamanho dos objetos entregues
+ * @param objetosPorSlab Objetos criados a cada novo slab
+ */
+void inicializarPool(PoolObjetos* poolPtr, size_t tamanhoObjeto, int objetosPorSlab) {
+    memset(poolPtr, 0, sizeof(*poolPtr));
+    if (tamanhoObjeto < sizeof(void*)) {
+        tamanhoObjeto = sizeof(void*);
+    }
+    size_t alinhamento = tamanhoObjeto >= 64 ? 64 : 16;
+    poolPtr->tamanhoObjeto = (tamanhoObjeto + alinhamento - 1) & ~(alinhamento - 1);
+    poolPtr->objetosPorSlab = objetosPorSlab > 0 ? objetosPorSlab : 1;
+}
+
+/**
+ * @brief Cria um slab e coloca seus objetos na lista de livres
+ * @return 1 em caso de sucesso, 0 se faltou memória
+ *
+ * O slab começa em linha de cache e seus primeiros 64 bytes encadeiam a
+ * lista de slabs; os objetos vêm em seguida, já alinhados.
+ */
+static int criarSlabPool(PoolObjetos* poolPtr) {
+    size_t bytes = 64 + poolPtr->tamanhoObjeto * (size_t)poolPtr->objetosPorSlab;
+    unsigned char* slab = aligned_alloc(64, (bytes + 63) & ~(size_t)63);
+    if (slab == NULL) {
+        return 0;
+    }
+    poolPtr->alocacoesSistema++;
+    *(void**)slab = poolPtr->slabs;
+    poolPtr->slabs = slab;
+
+    // Encadeia do último para o primeiro para entregar os objetos em ordem de endereço
+    for (int i = poolPtr->objetosPorSlab - 1; i >= 0; i--) {
+        void* objeto = slab + 64 + poolPtr->tamanhoObjeto * (size_t)i;
+        *(void**)objeto = poolPtr->livres;
+        poolPtr->livres = objeto;
+    }
+    poolPtr->objetosReservados += (size_t)poolPtr->objetosPorSlab;
+    return 1;
+}
+
+/**
+ * @brief Garante que o pool já tenha quantidade objetos criados
+ * @param poolPtr Pool a aquecer
+ * @param quantidade Objetos desejados (em uso + livres)
+ * @return 1 em caso de sucesso, 0 se faltou memória
+ *
+ * Chamado antes de uma partida, deixa o regime permanente sem malloc.
+ */
+int reservarPool(PoolObjetos* poolPtr, size_t quantidade) {
+    while (poolPtr->objetosReservados < quantidade) {
+        if (!criarSlabPool(poolPtr)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * @brief Entrega um objeto do pool (conteúdo indefinido)
+ * @param poolPtr Pool de origem
+ * @return Objeto, ou NULL se faltou memória para um novo slab
+ */
+void* alocarDoPool(PoolObjetos* poolPtr) {
+    if (poolPtr->livres == NULL && !criarSlabPool(poolPtr)) {
+        return NULL;
+    }
+    void* objeto = poolPtr->livres;
+    poolPtr->livres = *(void**)objeto;
+    if (++poolPtr->emUso > poolPtr->picoEmUso) {
+        poolPtr->picoEmUso = poolPtr->emUso;
+    }
+    return objeto;
+}
+
+/**
+ * @brief Devolve ao pool um objeto entregue por alocarDoPool()
+ * @param poolPtr Pool de origem
+ * @param objeto Objeto a devolver (NULL é ignorado)
+ */
+void devolverAoPool(PoolObjetos* poolPtr, void* objeto) {
+    if (objeto == NULL) {
+        return;
+    }
+    *(void**)objeto = poolPtr->livres;
+    poolPtr->livres = objeto;
+    poolPtr->emUso--;
+}
+
+/**
+ * @brief Libera todos os slabs; objetos ainda em uso deixam de ser válidos
+ * @param poolPtr Pool a liberar
+ */
+void liberarPool(PoolObjetos* poolPtr) {
+    while (poolPtr->slabs != NULL) {
+        void* proximo = *(void**)poolPtr->slabs;
+        free(poolPtr->slabs);
+        poolPtr->slabs = proximo;
+    }
+    poolPtr->livres = NULL;
+    poolPtr->emUso = 0;
+    poolPtr->objetosReservados = 0;
+}
+
+/**
+ * @brief Exibe o pico de uso e as alocações do sistema de uma arena
+ */
+void exibirEstatisticasArena(const char* nome, const ArenaMemoria* arenaPtr) {
+    imprimirJogo("%s: pico %.1f KB de %.1f KB | %zu alocacoes do sistema\n", nome,
+                 arenaPtr->picoUsado / 1024.0, arenaPtr->capacidade / 1024.0, arenaPtr->alocacoesSistema);
+}
+
+/**
+ * @brief Exibe o pico de objetos em uso e as alocações do sistema de um pool
+ */
+void exibirEstatisticasPool(const char* nome, const PoolObjetos* poolPtr) {
+    imprimirJogo("%s: pico %zu objetos de %zu bytes | %zu reservados | %zu em uso | %zu alocacoes do sistema\n",
+                 nome, poolPtr->picoEmUso, poolPtr->tamanhoObjeto, poolPtr->objetosReservados,
+                 poolPtr->emUso, poolPtr->alocacoesSistema);
+}
+
+// ═══════════════════════════════════════════════════════════════════════════════
+//                              BOT DE BUSCA EM FEIXE
+// ═══════════════════════════════════════════════════════════════════════════════
+
+/// Arena de nós da busca, uma por thread, reiniciada a cada jogada
+static _Thread_local ArenaMemoria arenaBusca;
+
+/**
+ * @brief Arena de busca da thread atual (para estatísticas)
+ */
+const ArenaMemoria* obterArenaBusca(void) {
+    return &arenaBusca;
+}
+
+/**
+ * @brief Inicializa o gerador de peças com uma semente
+ * @param geradorPtr Ponteiro para o gerador
+ * @param semente Semente da sequência (0 é substituída por uma constante)
+ */
+void inicializarGeradorPecas(GeradorPecas* geradorPtr, uint64_t semente) {
+    // splitmix64 espalha sementes próximas antes do xorshift
+    uint64_t z = semente + 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z ^= z >> 31;
+    geradorPtr->estado = z ? z : 0x2545F4914F6CDD1DULL;
+    geradorPtr->proximoId = 1;
+    geradorPtr->modo = GERADOR_UNIFORME;
+    geradorPtr->saco = 0;
+}
+
+/**
+ * @brief Inicializa o gerador com uma semente e um modo de sorteio
+ * @param geradorPtr Ponteiro para o gerador
+ * @param semente Semente da sequência
+ * @param modo GERADOR_UNIFORME (a sequência de inicializarGeradorPecas()) ou GERADOR_SACO_7
+ */
+void inicializarGeradorPecasModo(GeradorPecas* geradorPtr, uint64_t semente, ModoGerador modo) {
+    inicializarGeradorPecas(geradorPtr, semente);
+    geradorPtr->modo = (uint8_t)modo;
+}
+
+/**
+ * @brief Modo de gerador pelo nome ("uniforme" ou "saco7")
+ * @return ModoGerador, ou -1 se o nome é desconhecido
+ */
+int buscarModoGerador(const char* nome) {
+    if (strcmp(nome, "uniforme") == 0) {
+        return GERADOR_UNIFORME;
+    }
+    if (strcmp(nome, "saco7") == 0) {
+        return GERADOR_SACO_7;
+    }
+    return -1;
+}
+
+/**
+ * @brief Nome de um modo de gerador, como aceito por buscarModoGerador()
+ */
+const char* nomeModoGerador(ModoGerador modo) {
+    return modo == GERADOR_SACO_7 ? "saco7" : "uniforme";
+}
+
+/**
+ * @brief Sorteia o próximo tipo de peça
+ * @param geradorPtr Ponteiro para o gerador
+ * @return Tipo sorteado
+ *
+ * No modo uniforme, cada tipo tem probabilidade 1/7 a cada peça. No saco
+ * de 7, o sorteio é entre os tipos que ainda estão no saco, que volta a
+ * ter os 7 quando esvazia: nenhum tipo fica mais de 12 peças sem sair, e
+ * nunca saem três peças iguais seguidas.
+ */
+/// Avança o xorshift64* e devolve 32 bits sorteados
+static inline uint64_t avancarGeradorPecas(GeradorPecas* geradorPtr) {
+    uint64_t x = geradorPtr->estado;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    geradorPtr->estado = x;
+    return (x * 0x2545F4914F6CDD1DULL) >> 32;
+}
+
+char sortearTipoPeca(GeradorPecas* geradorPtr) {
+    static const char tipos[NUMERO_TIPOS_PECA] = {'I', 'O', 'T', 'S', 'Z', 'J', 'L'};
+    uint64_t sorteio = avancarGeradorPecas(geradorPtr);
+    if (geradorPtr->modo == GERADOR_UNIFORME) {
+        return tipos[sorteio % NUMERO_TIPOS_PECA];
+    }
+
+    unsigned saco = geradorPtr->saco != 0 ? geradorPtr->saco : (1u << NUMERO_TIPOS_PECA) - 1;
+    // sorteio tem 32 bits: (sorteio * n) >> 32 fica em 0 .. n - 1 sem divisão
+    unsigned k = (unsigned)((sorteio * (uint64_t)__builtin_popcount(saco)) >> 32);
+    unsigned restantes = saco;
+    for (unsigned i = 0; i < NUMERO_TIPOS_PECA - 1; i++) {
+        unsigned semMenor = restantes & (restantes - 1);
+        restantes = i < k ? semMenor : restantes;  // Pula os k primeiros tipos do saco, sem desvio
+    }
+    int tipo = __builtin_ctz(restantes);
+    geradorPtr->saco = (uint8_t)(saco & ~(1u << tipo));
+    return tipos[tipo];
+}
+
+/**
+ * @brief Sorteia um inteiro uniforme, sem passar pelo saco de peças
+ * @param geradorPtr Ponteiro para o gerador
+ * @param limite Quantidade de valores possíveis (> 0)
+ * @return Valor em 0 .. limite - 1, todos com a mesma probabilidade
+ *
+ * Multiplicação de 32 x 32 bits com rejeição dos poucos sorteios que
+ * dariam a alguns valores uma chance a mais (método de Lemire). Não
+ * altera o saco nem os IDs: pode ser usado em um gerador próprio para
+ * decisões que não sejam o tipo da peça.
+ */
+uint32_t sortearLimitadoGerador(GeradorPecas* geradorPtr, uint32_t limite) {
+    uint64_t produto = avancarGeradorPecas(geradorPtr) * limite;
+    if ((uint32_t)produto < limite) {
+        uint32_t rejeitar = (0u - limite) % limite;
+        while ((uint32_t)produto < rejeitar) {
+            produto = avancarGeradorPecas(geradorPtr) * limite;
+        }
+    }
+    return (uint32_t)(produto >> 32);
+}
+
+/**
+ * @brief Completa a fila com peças do gerador até ficar cheia
+ * @param filaPtr Ponteiro para a fila
+ * @param geradorPtr Ponteiro para o gerador
+ */
+void reabastecerFila(FilaCircular* filaPtr, GeradorPecas* geradorPtr) {
+    while (!filaCheia(filaPtr)) {
+        char tipo = sortearTipoPeca(geradorPtr);
+        inserirPecaNaFila(filaPtr, criarPeca(tipo, geradorPtr->proximoId++));
+    }
+}
+
+/**
+ * @brief Grava um corpus de sequências de peças
+ * @param caminho Arquivo a criar (substituído de uma vez, via arquivo temporário)
+ * @param tipos Tipos de todas as sequências, concatenados
+ * @param inicios quantidadeSequencias + 1 posições em tipos (a última é o total)
+ * @param quantidadeSequencias Número de sequências
+ * @return 1 em caso de sucesso, 0 em caso de falha (mensagem em stderr)
+ */
+int gravarCorpusSequencias(const char* caminho, const char* tipos, const uint64_t* inicios,
+                           uint32_t quantidadeSequencias) {
+    uint64_t totalPecas = inicios[quantidadeSequencias];
+    for (uint32_t i = 0; i < quantidadeSequencias; i++) {
+        if (inicios[i] > inicios[i + 1]) {
+            fprintf(stderr, "Corpus: inicio da sequencia %u depois do fim\n", i);
+            return 0;
+        }
+    }
+    for (uint64_t i = 0; i < totalPecas; i++) {
+        if (indiceTipoPeca(tipos[i]) < 0) {
+            fprintf(stderr, "Corpus: tipo de peca invalido '%c' na posicao %llu\n", tipos[i],
+                    (unsigned long long)i);
+            return 0;
+        }
+    }
+
+    CabecalhoCorpus cabecalho;
+    memset(&cabecalho, 0, sizeof(cabecalho));
+    memcpy(cabecalho.magica, "TETRISSQ", sizeof(cabecalho.magica));
+    cabecalho.versao = VERSAO_CORPUS;
+    cabecalho.bitsPorPeca = BITS_PECA_CORPUS;
+    cabecalho.quantidadeSequencias = quantidadeSequencias;
+    cabecalho.totalPecas = totalPecas;
+    cabecalho.deslocamentoIndice = sizeof(CabecalhoCorpus);
+    cabecalho.deslocamentoDados = cabecalho.deslocamentoIndice + sizeof(uint64_t) * ((uint64_t)quantidadeSequencias + 1);
+    cabecalho.tamanhoArquivo = cabecalho.deslocamentoDados + (totalPecas * BITS_PECA_CORPUS + 7) / 8 +
+                               PREENCHIMENTO_CORPUS;
+
+    char temporario[4096];
+    snprintf(temporario, sizeof(temporario), "%s.tmp", caminho);
+    FILE* arquivo = fopen(temporario, "wb");
+    int gravou = arquivo != NULL && fwrite(&cabecalho, sizeof(cabecalho), 1, arquivo) == 1 &&
+                 fwrite(inicios, sizeof(uint64_t), (size_t)quantidadeSequencias + 1, arquivo) ==
+                     (size_t)quantidadeSequencias + 1;
+    // Empacota os tipos em um acumulador e grava em blocos de 4 KB
+    unsigned char bloco[4096];
+    size_t usados = 0;
+    uint32_t acumulador = 0;
+    int bitsAcumulados = 0;
+    for (uint64_t i = 0; gravou && i < totalPecas; i++) {
+        acumulador |= (uint32_t)indiceTipoPeca(tipos[i]) << bitsAcumulados;
+        bitsAcumulados += BITS_PECA_CORPUS;
+        while (bitsAcumulados >= 8) {
+            bloco[usados++] = (unsigned char)acumulador;
+            acumulador >>= 8;
+            bitsAcumulados -= 8;
+        }
+        if (usados > sizeof(bloco) - 4) {
+            gravou = fwrite(bloco, 1, usados, arquivo) == usados;
+            usados = 0;
+        }
+    }
+    if (bitsAcumulados > 0) {
+        bloco[usados++] = (unsigned char)acumulador;
+    }
+    memset(bloco + usados, 0, PREENCHIMENTO_CORPUS);
+    usados += PREENCHIMENTO_CORPUS;
+    gravou = gravou && fwrite(bloco, 1, usados, arquivo) == usados;
+    if (arquivo != NULL) {
+        gravou = fclose(arquivo) == 0 && gravou;
+    }
+    gravou = gravou && rename(temporario, caminho) == 0;
+    if (!gravou) {
+        fprintf(stderr, "Falha ao gravar o corpus %s: %s\n", caminho, strerror(errno));
+        unlink(temporario);
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief Mapeia um corpus de sequências só para leitura
+ * @param corpusPtr Corpus a inicializar
+ * @param caminho Arquivo gravado por gravarCorpusSequencias()
+ * @return 1 em caso de sucesso, 0 se o arquivo não existe ou não é reconhecido
+ *
+ * Só o cabeçalho é conferido aqui; cada entrada do índice é conferida
+ * quando a sequência é selecionada.
+ */
+int abrirCorpusSequencias(CorpusSequencias* corpusPtr, const char* caminho) {
+    memset(corpusPtr, 0, sizeof(*corpusPtr));
+    int descritor = open(caminho, O_RDONLY | O_CLOEXEC);
+    struct stat informacoes;
+    if (descritor < 0 || fstat(descritor, &informacoes) != 0) {
+        fprintf(stderr, "Nao foi possivel abrir o corpus %s: %s\n", caminho, strerror(errno));
+        if (descritor >= 0) {
+            close(descritor);
+        }
+        return 0;
+    }
+    size_t tamanho = (size_t)informacoes.st_size;
+    void* regiao = tamanho >= sizeof(CabecalhoCorpus)
+                   ? mmap(NULL, tamanho, PROT_READ, MAP_PRIVATE, descritor, 0) : MAP_FAILED;
+    close(descritor);   // O mapeamento continua válido sem o descritor
+    const CabecalhoCorpus* cabecalhoPtr = regiao;
+    int valido = regiao != MAP_FAILED && memcmp(cabecalhoPtr->magica, "TETRISSQ", sizeof(cabecalhoPtr->magica)) == 0 &&
+                 cabecalhoPtr->versao == VERSAO_CORPUS && cabecalhoPtr->bitsPorPeca == BITS_PECA_CORPUS &&
+                 cabecalhoPtr->tamanhoArquivo == tamanho && cabecalhoPtr->deslocamentoIndice >= sizeof(CabecalhoCorpus) &&
+                 cabecalhoPtr->deslocamentoDados >= cabecalhoPtr->deslocamentoIndice +
+                     sizeof(uint64_t) * ((uint64_t)cabecalhoPtr->quantidadeSequencias + 1) &&
+                 cabecalhoPtr->totalPecas <= (uint64_t)tamanho * 8 / BITS_PECA_CORPUS &&
+                 cabecalhoPtr->deslocamentoDados + (cabecalhoPtr->totalPecas * BITS_PECA_CORPUS + 7) / 8 +
+                     PREENCHIMENTO_CORPUS <= tamanho;
+    if (!valido) {
+        fprintf(stderr, "Corpus %s nao reconhecido (formato ou versao diferente, ou arquivo truncado)\n", caminho);
+        if (regiao != MAP_FAILED) {
+            munmap(regiao, tamanho);
+        }
+        return 0;
+    }
+
+    corpusPtr->mapa = regiao;
+    corpusPtr->tamanho = tamanho;
+    corpusPtr->cabecalho = cabecalhoPtr;
+    corpusPtr->indice = corpusPtr->mapa + cabecalhoPtr->deslocamentoIndice;
+    corpusPtr->dados = corpusPtr->mapa + cabecalhoPtr->deslocamentoDados;
+    return 1;
+}
+
+/**
+ * @brief Desfaz o mapeamento do corpus
+ * @param corpusPtr Corpus aberto (cursores dele deixam de valer)
+ */
+void fecharCorpusSequencias(CorpusSequencias* corpusPtr) {
+    if (corpusPtr->mapa != NULL) {
+        munmap((void*)corpusPtr->mapa, corpusPtr->tamanho);
+    }
+    memset(corpusPtr, 0, sizeof(*corpusPtr));
+}
+
+/**
+ * @brief Posiciona um cursor no início de uma sequência
+ * @param corpusPtr Corpus aberto
+ * @param sequencia Índice da sequência
+ * @param cursorPtr Cursor (saída)
+ * @return 1 em caso de sucesso, 0 se o índice não existe ou a entrada é inválida
+ */
+int selecionarSequenciaCorpus(const CorpusSequencias* corpusPtr, uint32_t sequencia, CursorCorpus* cursorPtr) {
+    if (sequencia >= corpusPtr->cabecalho->quantidadeSequencias) {
+        return 0;
+    }
+    uint64_t limites[2];
+    memcpy(limites, corpusPtr->indice + sizeof(uint64_t) * sequencia, sizeof(limites));
+    if (limites[0] > limites[1] || limites[1] > corpusPtr->cabecalho->totalPecas) {
+        return 0;
+    }
+    cursorPtr->dados = corpusPtr->dados;
+    cursorPtr->posicao = limites[0];
+    cursorPtr->fim = limites[1];
+    cursorPtr->proximoId = 1;
+    return 1;
+}
+
+/**
+ * @brief Completa a fila com as próximas peças da sequência
+ * @param filaPtr Ponteiro para a fila
+ * @param cursorPtr Cursor da sequência
+ * @return Peças inseridas (menos que o espaço livre quando a sequência acaba)
+ *
+ * Os tipos são decodificados direto do mapeamento para as posições da fila,
+ * sem buffer intermediário nem chamadas de sistema: 3 bits nunca cruzam
+ * mais que 2 bytes, e o preenchimento no fim do arquivo garante o segundo.
+ */
+int reabastecerFilaCorpus(FilaCircular* filaPtr, CursorCorpus* cursorPtr) {
+    static const char tipos[8] = {'I', 'O', 'T', 'S', 'Z', 'J', 'L', '\0'};
+    int inseridas = 0;
+    while (!filaCheia(filaPtr) && cursorPtr->posicao < cursorPtr->fim) {
+        uint64_t bit = cursorPtr->posicao * BITS_PECA_CORPUS;
+        const unsigned char* bytePtr = cursorPtr->dados + (bit >> 3);
+        unsigned int codigo = ((unsigned int)(bytePtr[0] | bytePtr[1] << 8) >> (bit & 7)) & 7u;
+        if (tipos[codigo] == '\0') {
+            cursorPtr->posicao = cursorPtr->fim;   // Código 7: dado corrompido, a sequência acaba aqui
+            break;
+        }
+        inserirPecaNaFila(filaPtr, criarPeca(tipos[codigo], cursorPtr->proximoId++));
+        cursorPtr->posicao++;
+        inseridas++;
+    }
+    return inseridas;
+}
+
+/**
+ * @brief Preenche a configuração padrão do bot
+ * @param configPtr Configuração a preencher
+ */
+void configurarBotPadrao(ConfigBot* configPtr) {
+    configPtr->larguraFeixe = 16;
+    configPtr->profundidade = 3;
+    configPtr->orcamentoMs = 0.0;
+    configPtr->deterministico = 1;
+    configPtr->capacidadeFila = CAPACIDADE_PADRAO_FILA;
+    configPtr->capacidadePilha = CAPACIDADE_PADRAO_PILHA;
+    configPtr->regrasPontuacao = REGRAS_EXPERT;
+    configPtr->pesos = PESOS_AVALIACAO_PADRAO;
+    configPtr->corpus = NULL;
+    configPtr->modoGerador = GERADOR_UNIFORME;
+}
+
+/**
+ * @brief Ordena chaves por nota decrescente; empates pela ordem de geração
+ * @param chaves Chaves a ordenar
+ * @param auxiliar Espaço temporário do mesmo tamanho
+ * @param quantidade Número de chaves
+ *
+ * Merge sort de baixo para cima sobre memória da arena: estável como o
+ * qsort() da glibc, mas sem o malloc interno que ele faz para vetores grandes.
+ */
+static void ordenarChavesBusca(ChaveNoBusca* chaves, ChaveNoBusca* auxiliar, int quantidade) {
+    ChaveNoBusca* origem = chaves;
+    ChaveNoBusca* destino = auxiliar;
+    for (int passo = 1; passo < quantidade; passo *= 2) {
+        for (int inicio = 0; inicio < quantidade; inicio += 2 * passo) {
+            int meio = inicio + passo < quantidade ? inicio + passo : quantidade;
+            int fim = inicio + 2 * passo < quantidade ? inicio + 2 * passo : quantidade;
+            int a = inicio, b = meio, k = inicio;
+            while (a < meio && b < fim) {
+                destino[k++] = origem[b].nota > origem[a].nota ? origem[b++] : origem[a++];
+            }
+            while (a < meio) {
+                destino[k++] = origem[a++];
+            }
+            while (b < fim) {
+                destino[k++] = origem[b++];
+            }
+        }
+        ChaveNoBusca* troca = origem;
+        origem = destino;
+        destino = troca;
+    }
+    if (origem != chaves) {
+        memcpy(chaves, origem, sizeof(ChaveNoBusca) * (size_t)quantidade);
+    }
+}
+
+/**
+ * @brief Gera os filhos de um nó posicionando uma peça em todas as posições
+ * @return Número de filhos escritos em destino
+ */
+static int expandirJogadasNo(const NoBusca* pai, char tipoPeca, int origem, const AcaoBot* acaoRaiz,
+                             const PesosAvaliacao* pesosPtr, NoBusca* destino) {
+    Jogada jogadas[MAX_JOGADAS];
+    int quantidade = gerarJogadas(&pai->tabuleiro, tipoPeca, origem, jogadas, MAX_JOGADAS);
+    for (int i = 0; i < quantidade; i++) {
+        NoBusca* filho = &destino[i];
+        *filho = *pai;
+        int linhas = aplicarJogada(&filho->tabuleiro, &jogadas[i]);
+        filho->recompensa += pesosPtr->pesoLinhas * linhas;
+        if (origem == 0) {
+            filho->posicaoPrevia++;
+        } else {
+            filho->tamanhoPilha--;
+        }
+        if (acaoRaiz) {
+            filho->primeiraAcao = *acaoRaiz;
+        } else {
+            filho->primeiraAcao.tipo = origem == 0 ? ACAO_JOGAR_FILA : ACAO_JOGAR_PILHA;
+            filho->primeiraAcao.jogada = jogadas[i];
+        }
+    }
+    return quantidade;
+}
+
+/**
+ * @brief Escolhe a próxima ação do bot por busca em feixe
+ * @param configPtr Parâmetros da busca
+ * @param tabPtr Tabuleiro atual
+ * @param filaPtr Fila de peças (toda a fila é usada como prévia conhecida)
+ * @param pilhaPtr Pilha de reserva (o conteúdo é conhecido; os nós guardam o topo)
+ * @param acaoPtr Ação escolhida (saída)
+ * @return 1 se há ação possível, 0 se a partida acabou (nenhuma peça cabe)
+ *
+ * Cada nível do feixe expande todos os nós com as três ações possíveis
+ * (jogar da fila, jogar da reserva, reservar), avalia os tabuleiros filhos
+ * em lote e mantém os larguraFeixe melhores. Os nós vivem na arena da
+ * thread, que é reaproveitada entre jogadas sem novas alocações. Se a
+ * arena não puder ser reservada, a jogada é a gulosa: a melhor posição
+ * para a peça atual ou para o topo da reserva, sem olhar adiante.
+ */
+int escolherAcaoBot(const ConfigBot* configPtr, const Tabuleiro* tabPtr, FilaCircular* filaPtr,
+                    PilhaReserva* pilhaPtr, AcaoBot* acaoPtr) {
+    // A prévia é lida da fila sob demanda: só as peças alcançadas pela busca são tocadas
+    int tamanhoPrevia = filaPtr->quantidadePecas < MAX_PREVIA_BOT ? filaPtr->quantidadePecas : MAX_PREVIA_BOT;
+
+    int largura = configPtr->larguraFeixe > 0 ? configPtr->larguraFeixe : 1;
+    int profundidade = configPtr->profundidade > 0 ? configPtr->profundidade : 1;
+    if (profundidade > tamanhoPrevia + pilhaPtr->quantidadeReservada) {
+        profundidade = tamanhoPrevia + pilhaPtr->quantidadeReservada;
+    }
+    int filhosPorNo = 2 * MAX_JOGADAS + 1;
+    size_t maximoFilhos = (size_t)largura * filhosPorNo;
+    reiniciarArena(&arenaBusca, sizeof(NoBusca) * (largura + maximoFilhos) +
+                   (sizeof(Tabuleiro) + sizeof(double) + 2 * sizeof(ChaveNoBusca)) * maximoFilhos + 96);
+
+    struct timespec inicio, agora;
+    clock_gettime(CLOCK_MONOTONIC, &inicio);
+    NoBusca* feixe = alocarDaArena(&arenaBusca, sizeof(NoBusca) * largura);
+    NoBusca* filhos = alocarDaArena(&arenaBusca, sizeof(NoBusca) * maximoFilhos);
+    Tabuleiro* lote = alocarDaArena(&arenaBusca, sizeof(Tabuleiro) * maximoFilhos);
+    double* notas = alocarDaArena(&arenaBusca, sizeof(double) * maximoFilhos);
+    ChaveNoBusca* chaves = alocarDaArena(&arenaBusca, sizeof(ChaveNoBusca) * maximoFilhos);
+    ChaveNoBusca* auxiliar = alocarDaArena(&arenaBusca, sizeof(ChaveNoBusca) * maximoFilhos);
+    if (feixe == NULL || filhos == NULL || lote == NULL || notas == NULL || chaves == NULL || auxiliar == NULL) {
+        Jogada jogada;
+        if (recomendarJogada(tabPtr, filaPtr, pilhaPtr, &configPtr->pesos, &jogada, NULL) == 0) {
+            return 0;
+        }
+        acaoPtr->tipo = jogada.origem == 0 ? ACAO_JOGAR_FILA : ACAO_JOGAR_PILHA;
+        acaoPtr->jogada = jogada;
+        return 1;
+    }
+    int tamanhoFeixe = 1;
+
+    NoBusca* raiz = &feixe[0];
+    memset(raiz, 0, sizeof(*raiz));
+    raiz->tabuleiro = *tabPtr;
+    // Reservas maiores que MAX_PILHA_BOT: a busca só enxerga as peças do topo
+    int copiadas = pilhaPtr->quantidadeReservada < MAX_PILHA_BOT ? pilhaPtr->quantidadeReservada : MAX_PILHA_BOT;
+    for (int i = copiadas - 1; i >= 0; i--) {
+        raiz->pilha[raiz->tamanhoPilha++] = espiarPilha(pilhaPtr, i)->tipo;
+    }
+    int limitePilha = pilhaPtr->capacidade - (pilhaPtr->quantidadeReservada - copiadas);
+    if (limitePilha > MAX_PILHA_BOT) {
+        limitePilha = MAX_PILHA_BOT;
+    }
+
+    NoBusca* melhor = NULL;
+    for (int nivel = 0; nivel < profundidade; nivel++) {
+        int quantidadeFilhos = 0;
+
+        for (int n = 0; n < tamanhoFeixe; n++) {
+            const NoBusca* no = &feixe[n];
+            const AcaoBot* acaoRaiz = nivel == 0 ? NULL : &no->primeiraAcao;
+
+            if (no->posicaoPrevia < tamanhoPrevia) {
+                quantidadeFilhos += expandirJogadasNo(no, espiarFila(filaPtr, no->posicaoPrevia)->tipo, 0, acaoRaiz,
+                                                      &configPtr->pesos, &filhos[quantidadeFilhos]);
+            }
+            if (no->tamanhoPilha > 0) {
+                quantidadeFilhos += expandirJogadasNo(no, no->pilha[no->tamanhoPilha - 1], 1, acaoRaiz,
+                                                      &configPtr->pesos, &filhos[quantidadeFilhos]);
+            }
+            if (no->posicaoPrevia < tamanhoPrevia && no->tamanhoPilha < limitePilha) {
+                NoBusca* filho = &filhos[quantidadeFilhos++];
+                *filho = *no;
+                filho->pilha[filho->tamanhoPilha++] = espiarFila(filaPtr, filho->posicaoPrevia++)->tipo;
+                if (!acaoRaiz) {
+                    filho->primeiraAcao.tipo = ACAO_RESERVAR;
+                }
+            }
+
+        }
+
+        if (quantidadeFilhos == 0) {
+            break;
+        }
+
+        // Avaliação em lote de todos os tabuleiros do nível
+        for (int f = 0; f < quantidadeFilhos; f++) {
+            lote[f] = filhos[f].tabuleiro;
+        }
+        avaliarLoteTabuleiros(lote, NULL, quantidadeFilhos, &configPtr->pesos, notas);
+        for (int f = 0; f < quantidadeFilhos; f++) {
+            filhos[f].nota = filhos[f].recompensa + notas[f];
+            chaves[f].nota = filhos[f].nota;
+            chaves[f].indice = f;
+        }
+
+        // Ordena só as chaves e copia para o feixe apenas os nós mantidos
+        ordenarChavesBusca(chaves, auxiliar, quantidadeFilhos);
+        tamanhoFeixe = quantidadeFilhos < largura ? quantidadeFilhos : largura;
+        for (int f = 0; f < tamanhoFeixe; f++) {
+            feixe[f] = filhos[chaves[f].indice];
+        }
+        melhor = &feixe[0];
+
+        if (!configPtr->deterministico && configPtr->orcamentoMs > 0.0 &&
+            clock_gettime(CLOCK_MONOTONIC, &agora) == 0 &&
+            (agora.tv_sec - inicio.tv_sec) * 1e3 + (agora.tv_nsec - inicio.tv_nsec) * 1e-6 >= configPtr->orcamentoMs) {
+            break; // Orçamento esgotado: usa o melhor nó do nível completo
+        }
+    }
+
+    if (melhor == NULL) {
+        return 0;
+    }
+    *acaoPtr = melhor->primeiraAcao;
+    return 1;
+}
+
+/// Reabastece pela sequência do corpus, se houver, ou pelo gerador
+static void reabastecerFilaPartida(FilaCircular* filaPtr, GeradorPecas* geradorPtr, CursorCorpus* cursorPtr) {
+    if (cursorPtr != NULL) {
+        reabastecerFilaCorpus(filaPtr, cursorPtr);
+    } else {
+        reabastecerFila(filaPtr, geradorPtr);
+    }
+}
+
+/**
+ * @brief Prepara uma partida do bot: fila cheia, reserva vazia e tabuleiro limpo
+ * @param partidaPtr Partida (saída; liberar com liberarPartidaBot())
+ * @param capacidadeFila Peças na fila
+ * @param capacidadePilha Peças na reserva
+ * @param regrasPontuacao Regras do Sistema Expert
+ * @param semente Semente do gerador
+ * @param modoGerador Modo do gerador
+ * @param cursorPtr Sequência do corpus que substitui o gerador (NULL = gerador)
+ */
+void iniciarPartidaBot(EstadoPartidaBot* partidaPtr, int capacidadeFila, int capacidadePilha, int regrasPontuacao,
+                       uint64_t semente, ModoGerador modoGerador, CursorCorpus* cursorPtr) {
+    inicializarFila(&partidaPtr->fila);
+    inicializarPilha(&partidaPtr->pilha);
+    configurarCapacidadeFila(&partidaPtr->fila, capacidadeFila);
+    configurarCapacidadePilha(&partidaPtr->pilha, capacidadePilha);
+    inicializarSistemaExpert(&partidaPtr->sistema);
+    definirRegrasPontuacao(&partidaPtr->sistema, regrasPontuacao);
+    limparTabuleiro(&partidaPtr->tabuleiro);
+    inicializarGeradorPecasModo(&partidaPtr->gerador, semente, modoGerador);
+    partidaPtr->cursor = cursorPtr;
+    partidaPtr->pecasJogadas = 0;
+    partidaPtr->linhasEliminadas = 0;
+    partidaPtr->acoesReserva = 0;
+    partidaPtr->acoes = 0;
+    reabastecerFilaPartida(&partidaPtr->fila, &partidaPtr->gerador, cursorPtr);
+}
+
+/**
+ * @brief Aplica uma ação do bot e reabastece a fila
+ * @param partidaPtr Partida
+ * @param acaoPtr Ação escolhida por escolherAcaoBot() (ou lida de um replay)
+ */
+void aplicarAcaoPartidaBot(EstadoPartidaBot* partidaPtr, const AcaoBot* acaoPtr) {
+    if (acaoPtr->tipo == ACAO_RESERVAR) {
+        transferirPecaFilaParaPilha(&partidaPtr->fila, &partidaPtr->pilha);
+        partidaPtr->acoesReserva++;
+    } else {
+        int origem = acaoPtr->tipo == ACAO_JOGAR_FILA ? 0 : 1;
+        Peca peca = origem == 0 ? jogarPecaDaFila(&partidaPtr->fila) : jogarPecaDaPilha(&partidaPtr->pilha);
+        partidaPtr->linhasEliminadas += aplicarJogada(&partidaPtr->tabuleiro, &acaoPtr->jogada);
+        processarJogadaExpert(peca, origem, &partidaPtr->sistema);
+        partidaPtr->pecasJogadas++;
+    }
+    partidaPtr->acoes++;
+    reabastecerFilaPartida(&partidaPtr->fila, &partidaPtr->gerador, partidaPtr->cursor);
+}
+
+/**
+ * @brief Libera a fila e a reserva da partida
+ */
+void liberarPartidaBot(EstadoPartidaBot* partidaPtr) {
+    liberarFila(&partidaPtr->fila);
+    liberarPilha(&partidaPtr->pilha);
+}
+
+/**
+ * @brief Joga uma partida completa sem interface, o mais rápido possível
+ * @param configPtr Parâmetros do bot
+ * @param semente Semente do gerador de peças da partida; com configPtr->corpus,
+ *        a sequência semente % quantidadeSequencias do corpus
+ * @param limitePecas Máximo de peças posicionadas (0 = até o fim da partida)
+ * @param resultadoPtr Resultado da partida (saída)
+ *
+ * Usa as mesmas funções do menu interativo (fila, pilha e sistema Expert),
+ * então os resultados servem de linha de base para comparar jogadores. Com
+ * um corpus, a partida também acaba quando a sequência termina.
+ */
+void executarPartidaBot(const ConfigBot* configPtr, uint64_t semente, int limitePecas,
+                        ResultadoPartida* resultadoPtr) {
+    executarPartidaBotGravada(configPtr, semente, limitePecas, resultadoPtr, NULL);
+}
+
+/**
+ * @brief Como executarPartidaBot(), gravando cada ação em um replay
+ * @param gravadorPtr Replay aberto por abrirGravacaoReplay() (NULL = sem gravação)
+ */
+void executarPartidaBotGravada(const ConfigBot* configPtr, uint64_t semente, int limitePecas,
+                               ResultadoPartida* resultadoPtr, GravadorReplay* gravadorPtr) {
+    CursorCorpus cursor;
+    CursorCorpus* cursorPtr = NULL;
+    if (configPtr->corpus != NULL) {
+        uint32_t quantidade = configPtr->corpus->cabecalho->quantidadeSequencias;
+        cursorPtr = &cursor;
+        if (quantidade == 0 || !selecionarSequenciaCorpus(configPtr->corpus, (uint32_t)(semente % quantidade), cursorPtr)) {
+            cursor.posicao = cursor.fim = 0;     // Sequência inválida: partida vazia
+        }
+    }
+    EstadoPartidaBot partida;
+    iniciarPartidaBot(&partida, configPtr->capacidadeFila, configPtr->capacidadePilha, configPtr->regrasPontuacao,
+                      semente, (ModoGerador)configPtr->modoGerador, cursorPtr);
+
+    struct timespec inicio, fim;
+    clock_gettime(CLOCK_MONOTONIC, &inicio);
+    AcaoBot acao;
+    while ((limitePecas <= 0 || partida.pecasJogadas < limitePecas) &&
+           escolherAcaoBot(configPtr, &partida.tabuleiro, &partida.fila, &partida.pilha, &acao)) {
+        if (gravadorPtr != NULL) {
+            registrarAcaoReplay(gravadorPtr, &partida, &acao);
+        }
+        aplicarAcaoPartidaBot(&partida, &acao);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &fim);
+    resultadoPtr->segundos = (fim.tv_sec - inicio.tv_sec) + (fim.tv_nsec - inicio.tv_nsec) * 1e-9;
+    resultadoPtr->pecasJogadas = partida.pecasJogadas;
+    resultadoPtr->linhasEliminadas = partida.linhasEliminadas;
+    resultadoPtr->acoesReserva = partida.acoesReserva;
+    resultadoPtr->sistema = partida.sistema;
+    liberarPartidaBot(&partida);
+}
+
+/**
+ * @brief Modo de linha de comando: partidas headless do bot
+ * @return Código de saída
+ *
+ * Uso: tetris --bot [largura] [pecas] [partidas] [semente] [--tempo ms]
+ *            [--profundidade n] [--fila n] [--pilha n] [--combos padroes]
+ *            [--arquivo-regras caminho] [--regras nome] [--corpus arquivo]
+ *            [--gerador modo] [--replay arquivo] [--quadros n]
+ *
+ * Com --corpus, a partida n joga a sequência (semente + n) do corpus.
+ * Com --replay, a primeira partida é gravada com um quadro-chave a cada
+ * --quadros ações (ver executarModoReplay()).
+ */
+int executarModoBot(int argc, char* argv[]) {
+    ConfigBot config;
+    configurarBotPadrao(&config);
+
+    int posicionais[4] = {config.larguraFeixe, 10000, 1, 1};
+    int quantidadePosicionais = 0;
+    const char* nomeRegras = NULL;
+    const char* caminhoCorpus = NULL;
+    const char* caminhoReplay = NULL;
+    int intervaloQuadros = INTERVALO_QUADROS_PADRAO;
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--tempo") == 0 && i + 1 < argc) {
+            config.orcamentoMs = atof(argv[++i]);
+            config.deterministico = 0;
+        } else if (strcmp(argv[i], "--profundidade") == 0 && i + 1 < argc) {
+            config.profundidade = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--fila") == 0 && i + 1 < argc) {
+            config.capacidadeFila = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--pilha") == 0 && i + 1 < argc) {
+            config.capacidadePilha = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--combos") == 0 && i + 1 < argc) {
+            if (!configurarPadroesCombo(argv[++i])) {
+                fprintf(stderr, "Padroes de combo invalidos: %s\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--arquivo-regras") == 0 && i + 1 < argc) {
+            if (carregarRegrasPontuacao(argv[++i]) < 0) {
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--regras") == 0 && i + 1 < argc) {
+            nomeRegras = argv[++i];
+        } else if (strcmp(argv[i], "--corpus") == 0 && i + 1 < argc) {
+            caminhoCorpus = argv[++i];
+        } else if (strcmp(argv[i], "--gerador") == 0 && i + 1 < argc) {
+            if ((config.modoGerador = buscarModoGerador(argv[++i])) < 0) {
+                fprintf(stderr, "Gerador desconhecido: %s (uniforme ou saco7)\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            caminhoReplay = argv[++i];
+        } else if (strcmp(argv[i], "--quadros") == 0 && i + 1 < argc) {
+            intervaloQuadros = atoi(argv[++i]);
+        } else if (quantidadePosicionais < 4) {
+            posicionais[quantidadePosicionais++] = atoi(argv[i]);
+        }
+    }
+    config.larguraFeixe = posicionais[0];
+    if (nomeRegras != NULL && (config.regrasPontuacao = buscarRegrasPontuacao(nomeRegras)) < 0) {
+        fprintf(stderr, "Regras de pontuacao desconhecidas: %s\n", nomeRegras);
+        return 1;
+    }
+    if (caminhoReplay != NULL && caminhoCorpus != NULL) {
+        fprintf(stderr, "--replay grava partidas do gerador; nao use com --corpus\n");
+        return 1;
+    }
+
+    CorpusSequencias corpus;
+    if (caminhoCorpus != NULL) {
+        struct timespec antes, depois;
+        clock_gettime(CLOCK_MONOTONIC, &antes);
+        if (!abrirCorpusSequencias(&corpus, caminhoCorpus)) {
+            return 1;
+        }
+        clock_gettime(CLOCK_MONOTONIC, &depois);
+        config.corpus = &corpus;
+        printf("Corpus %s: %u sequencias, %llu pecas (aberto em %.1f us)\n", caminhoCorpus,
+               corpus.cabecalho->quantidadeSequencias, (unsigned long long)corpus.cabecalho->totalPecas,
+               (depois.tv_sec - antes.tv_sec) * 1e6 + (depois.tv_nsec - antes.tv_nsec) * 1e-3);
+    }
+
+    saidaSilenciosa = 1;
+    long long pecasTotais = 0;
+    double segundosTotais = 0.0;
+    for (int partida = 0; partida < posicionais[2]; partida++) {
+        ResultadoPartida resultado;
+        // Com --replay, a primeira partida é gravada
+        GravadorReplay gravador;
+        int gravando = caminhoReplay != NULL && partida == 0 &&
+                       abrirGravacaoReplay(&gravador, caminhoReplay, &config, (uint64_t)posicionais[3], intervaloQuadros);
+        executarPartidaBotGravada(&config, (uint64_t)posicionais[3] + partida, posicionais[1], &resultado,
+                                  gravando ? &gravador : NULL);
+        if (gravando && fecharGravacaoReplay(&gravador)) {
+            printf("Replay gravado em %s\n", caminhoReplay);
+        }
+        pecasTotais += resultado.pecasJogadas;
+        segundosTotais += resultado.segundos;
+        printf("Partida %d: %d pecas | %d linhas | pontuacao %d | nivel %d | melhor combo %d\n",
+               partida + 1, resultado.pecasJogadas, resultado.linhasEliminadas,
+               resultado.sistema.pontuacaoTotal, resultado.sistema.nivelAtual,
+               resultado.sistema.melhorCombo);
+    }
+    printf("Feixe %d | %lld pecas em %.2fs | %.0f pecas/s\n", config.larguraFeixe, pecasTotais,
+           segundosTotais, segundosTotais > 0 ? pecasTotais / segundosTotais : 0.0);
+    exibirEstatisticasArena("Arena da busca", obterArenaBusca());
+    if (config.corpus != NULL) {
+        fecharCorpusSequencias(&corpus);
+    }
+    return 0;
+}
+
+// ═══════════════════════════════════════════════════════════════════════════════
+//                       SIMULAÇÃO EM LOCKSTEP DE VÁRIOS TABULEIROS
+// ═══════════════════════════════════════════════════════════════════════════════
+
+/**
+ * @brief Indica se alguma lane do vetor é diferente de zero
+ */
+static inline int vetorNaoNulo(const VetorLinhas* vetorPtr) {
+    uint64_t palavras[LANES_LOCKSTEP / 4];
+    memcpy(palavras, vetorPtr, sizeof(palavras));
+    uint64_t acumulado = 0;
+    for (int i = 0; i < LANES_LOCKSTEP / 4; i++) {
+        acumulado |= palavras[i];
+    }
+    return acumulado != 0;
+}
+
+/**
+ * @brief Prepara o gerador da política de self-play de uma partida
+ * @param politicaPtr Gerador a inicializar
+ * @param semente Semente da partida (a mesma do gerador de peças)
+ *
+ * É um gerador separado do de peças: as decisões da política não consomem
+ * sorteios de tipo, e a sequência de peças é a mesma de uma partida comum
+ * com a mesma semente.
+ */
+void inicializarPoliticaLockstep(GeradorPecas* politicaPtr, uint64_t semente) {
+    inicializarGeradorPecas(politicaPtr, semente ^ 0x9E3779B97F4A7C15ULL);
+}
+
+/**
+ * @brief Política de self-play: rotação e coluna uniformes para a peça
+ * @param politicaPtr Gerador da política (inicializarPoliticaLockstep())
+ * @param indiceTipo Índice do tipo da peça
+ * @param colunaPtr Recebe a coluna da esquerda
+ * @return Rotação, entre as distintas do tipo
+ */
+int sortearJogadaLockstep(GeradorPecas* politicaPtr, int indiceTipo, int* colunaPtr) {
+    int rotacao = (int)sortearLimitadoGerador(politicaPtr, (uint32_t)ROTACOES_DISTINTAS[indiceTipo]);
+    const FormaPeca* forma = &FORMAS_PECA[indiceTipo][rotacao];
+    *colunaPtr = (int)sortearLimitadoGerador(politicaPtr, (uint32_t)(LARGURA_TABULEIRO - forma->largura + 1));
+    return rotacao;
+}
+
+/**
+ * @brief Faz surgir a próxima peça de uma lane no topo do seu tabuleiro
+ * @return 1 se a peça coube, 0 se a lane chegou ao fim da partida
+ *
+ * A política de self-play escolhe rotação e coluna ao acaso no surgimento;
+ * a queda até a fixação acontece depois, em lockstep com as outras lanes.
+ */
+static int surgirPecaLockstep(LoteLockstep* lotePtr, int lane) {
+    char tipo = sortearTipoPeca(&lotePtr->geradores[lane]);
+    int indiceTipo = indiceTipoPeca(tipo);
+    int coluna;
+    int rotacao = sortearJogadaLockstep(&lotePtr->politicas[lane], indiceTipo, &coluna);
+    const FormaPeca* forma = &FORMAS_PECA[indiceTipo][rotacao];
+    int base = ALTURA_TABULEIRO - forma->altura;
+
+    // A peça anterior da lane já foi apagada na fixação
+    if (base < lotePtr->linhaInferior) {
+        lotePtr->linhaInferior = base;
+    }
+    int cabe = 1;
+    uint16_t apoio = 0;
+    for (int i = 0; i < forma->altura; i++) {
+        uint16_t linha = (uint16_t)(forma->linhas[i] << coluna);
+        cabe &= (lotePtr->tabuleiro[base + i][lane] & linha) == 0;
+        apoio |= lotePtr->tabuleiro[base + i - 1][lane] & linha;
+        lotePtr->peca[base + i][lane] = linha;
+    }
+    lotePtr->apoio[lane] = apoio;
+    lotePtr->tipoAtual[lane] = tipo;
+    return cabe;
+}
+
+/**
+ * @brief Coloca a próxima partida da fila em uma lane
+ * @return 1 se a lane recebeu uma partida, 0 se a fila acabou
+ */
+static int iniciarPartidaLockstep(LoteLockstep* lotePtr, int lane) {
+    for (int y = 0; y < ALTURA_TABULEIRO; y++) {
+        lotePtr->tabuleiro[y][lane] = 0;
+        lotePtr->peca[y][lane] = 0;
+    }
+    if (lotePtr->proximaPartida >= lotePtr->totalPartidas) {
+        return 0;
+    }
+    int partida = lotePtr->proximaPartida++;
+    lotePtr->partidaLane[lane] = partida;
+    inicializarGeradorPecas(&lotePtr->geradores[lane], lotePtr->semente + (uint64_t)partida);
+    inicializarPoliticaLockstep(&lotePtr->politicas[lane], lotePtr->semente + (uint64_t)partida);
+    lotePtr->pontuacaoTotal[lane] = 0;
+    lotePtr->pontuacaoNivel[lane] = 0;
+    lotePtr->multiplicadorAtual[lane] = 1.0;
+    lotePtr->fatorDificuldade[lane] = 1.0;
+    lotePtr->estadoCombo[lane] = 0;
+    lotePtr->comboAtual[lane] = 0;
+    lotePtr->melhorCombo[lane] = 0;
+    lotePtr->nivelAtual[lane] = 1;
+    lotePtr->limitePontosNivel[lane] = lotePtr->regras->limiteInicial;
+    lotePtr->pecasJogadas[lane] = 0;
+    lotePtr->linhasEliminadas[lane] = 0;
+    surgirPecaLockstep(lotePtr, lane); // O tabuleiro vazio sempre comporta a peça
+    return 1;
+}
+
+/**
+ * @brief Registra o fim da partida de uma lane e a reabastece pela fila
+ * @return 1 se a lane continua em jogo com outra partida
+ */
+static int encerrarPartidaLockstep(LoteLockstep* lotePtr, int lane) {
+    lotePtr->pecasTotais += lotePtr->pecasJogadas[lane];
+    if (lotePtr->resultados != NULL) {
+        ResultadoLockstep* resultadoPtr = &lotePtr->resultados[lotePtr->partidaLane[lane]];
+        resultadoPtr->pontuacaoTotal = lotePtr->pontuacaoTotal[lane];
+        resultadoPtr->nivelAtual = lotePtr->nivelAtual[lane];
+        resultadoPtr->linhasEliminadas = lotePtr->linhasEliminadas[lane];
+        resultadoPtr->pecasJogadas = lotePtr->pecasJogadas[lane];
+        resultadoPtr->melhorCombo = lotePtr->melhorCombo[lane];
+    }
+    return iniciarPartidaLockstep(lotePtr, lane);
+}
+
+/**
+ * @brief Prepara um lote e coloca as primeiras partidas da fila nas lanes
+ * @param lotePtr Lote a inicializar
+ * @param semente Semente base (a partida p usa semente + p)
+ * @param partidas Partidas na fila (menos que LANES_LOCKSTEP deixa lanes vazias)
+ * @param limitePecas Peças por partida antes de encerrar (0 = até o fim da partida)
+ * @param regrasPtr Regras de pontuação das partidas
+ * @param resultados Vetor com uma posição por partida, ou NULL
+ */
+void inicializarLoteLockstep(LoteLockstep* lotePtr, uint64_t semente, int partidas, int limitePecas,
+                             const RegrasPontuacao* regrasPtr, ResultadoLockstep* resultados) {
+    obterMotorCombosPadrao();
+    memset(lotePtr, 0, sizeof(*lotePtr));
+    lotePtr->semente = semente;
+    lotePtr->totalPartidas = partidas;
+    lotePtr->limitePecas = limitePecas;
+    lotePtr->regras = regrasPtr;
+    lotePtr->resultados = resultados;
+    lotePtr->linhaInferior = ALTURA_TABULEIRO;
+    for (int lane = 0; lane < LANES_LOCKSTEP; lane++) {
+        lotePtr->ativas[lane] = iniciarPartidaLockstep(lotePtr, lane) ? -1 : 0;
+        lotePtr->quantidadeAtivas += lotePtr->ativas[lane] != 0;
+    }
+}
+
+/**
+ * @brief Pontua a peça que uma lane acabou de fixar
+ * @param lotePtr Lote em simulação
+ * @param lane Lane que fixou a peça
+ *
+ * Mesmos passos de processarJogadaRegras(), sobre os arrays do lote.
+ */
+static void pontuarFixacaoLockstep(LoteLockstep* lotePtr, int lane) {
+    const RegrasPontuacao* regrasPtr = lotePtr->regras;
+    char tipo = lotePtr->tipoAtual[lane];
+    int pontos = pontosPecaRegras(regrasPtr, tipo, lotePtr->multiplicadorAtual[lane], lotePtr->fatorDificuldade[lane]);
+    pontos = (int)(pontos * avancarComboMotor(&lotePtr->estadoCombo[lane], &lotePtr->comboAtual[lane],
+                                              &lotePtr->melhorCombo[lane], tipo));
+    lotePtr->pontuacaoTotal[lane] += pontos;
+    lotePtr->pontuacaoNivel[lane] += pontos;
+    lotePtr->pecasJogadas[lane]++;
+
+    if (lotePtr->pontuacaoTotal[lane] >= lotePtr->limitePontosNivel[lane]) {
+        subirNivelRegras(regrasPtr, lotePtr->pontuacaoTotal[lane], &lotePtr->nivelAtual[lane],
+                         &lotePtr->limitePontosNivel[lane], &lotePtr->fatorDificuldade[lane],
+                         &lotePtr->multiplicadorAtual[lane]);
+    }
+}
+
+/**
+ * @brief Avança todas as lanes um passo de gravidade
+ * @param lotePtr Lote em simulação
+ * @return Número de lanes ainda ativas
+ *
+ * Em cada passo: detecta quais peças não podem descer, desce as demais,
+ * fixa as bloqueadas, elimina linhas completas por lane, pontua e faz
+ * surgir a próxima peça nas lanes que fixaram. Queda e fixação são uma
+ * única varredura das linhas, e só as lanes que fixaram são visitadas.
+ */
+int avancarLoteLockstep(LoteLockstep* lotePtr) {
+    const VetorLinhas zero = {0};
+    VetorLinhas* tab = lotePtr->tabuleiro;
+    VetorLinhas* peca = lotePtr->peca;
+    int inferior = lotePtr->linhaInferior;
+    int inicio = inferior > 0 ? inferior - 1 : 0;
+    lotePtr->passos++;
+
+    // Peças apoiadas (no chão ou sobre algum bloco) são fixadas; as demais descem
+    VetorMascara fixadas = (lotePtr->apoio != zero) & lotePtr->ativas;
+    VetorLinhas manter = (VetorLinhas)fixadas;
+
+    // Uma varredura: fixação, queda, linhas completas e o apoio do próximo
+    // passo (nova posição da peça contra a linha de baixo; o chão é cheio)
+    VetorLinhas completa = zero + LINHA_COMPLETA;
+    VetorLinhas algumaCheia = zero;
+    VetorLinhas apoio = zero;
+    VetorLinhas abaixo = inicio > 0 ? tab[inicio - 1] : ~zero;
+    for (int y = inicio; y < ALTURA_TABULEIRO; y++) {
+        VetorLinhas desce = y < ALTURA_TABULEIRO - 1 ? peca[y + 1] & ~manter : zero;
+        tab[y] |= peca[y] & manter;
+        peca[y] = desce;
+        apoio |= desce & abaixo;
+        abaixo = tab[y];
+        algumaCheia |= (VetorLinhas)(tab[y] == completa);
+    }
+    lotePtr->apoio = apoio;
+    lotePtr->linhaInferior = inicio;
+
+    if (!vetorNaoNulo(&manter)) {
+        return lotePtr->quantidadeAtivas; // Nenhuma peça fixada neste passo
+    }
+
+    // Limpeza: desloca para baixo só as lanes em que a linha está completa
+    if (vetorNaoNulo(&algumaCheia)) {
+        for (int y = ALTURA_TABULEIRO - 1; y >= inicio; y--) {
+            VetorLinhas cheia = (VetorLinhas)(tab[y] == completa);
+            if (!vetorNaoNulo(&cheia)) {
+                continue;
+            }
+            for (int k = y; k < ALTURA_TABULEIRO - 1; k++) {
+                tab[k] = (tab[k + 1] & cheia) | (tab[k] & ~cheia);
+            }
+            tab[ALTURA_TABULEIRO - 1] &= ~cheia;
+            for (int lane = 0; lane < LANES_LOCKSTEP; lane++) {
+                lotePtr->linhasEliminadas[lane] += cheia[lane] & 1;
+            }
+        }
+    }
+
+    // As peças fixadas saíram de peca[]: sobe o limite inferior até a próxima peça
+    while (lotePtr->linhaInferior < ALTURA_TABULEIRO && !vetorNaoNulo(&peca[lotePtr->linhaInferior])) {
+        lotePtr->linhaInferior++;
+    }
+
+    // Visita só as lanes que fixaram: um bit por lane (4 lanes por palavra)
+    uint64_t palavras[LANES_LOCKSTEP / 4];
+    memcpy(palavras, &fixadas, sizeof(palavras));
+    for (int p = 0; p < LANES_LOCKSTEP / 4; p++) {
+        for (uint64_t bits = palavras[p] & 0x0001000100010001ULL; bits != 0; bits &= bits - 1) {
+            int lane = p * 4 + __builtin_ctzll(bits) / 16;
+            pontuarFixacaoLockstep(lotePtr, lane);
+            int noLimite = lotePtr->limitePecas > 0 && lotePtr->pecasJogadas[lane] >= lotePtr->limitePecas;
+            if ((noLimite || !surgirPecaLockstep(lotePtr, lane)) && !encerrarPartidaLockstep(lotePtr, lane)) {
+                lotePtr->ativas[lane] = 0;
+                lotePtr->quantidadeAtivas--;
+            }
+        }
+    }
+    return lotePtr->quantidadeAtivas;
+}
+
+/**
+ * @brief Simula o lote até a fila de partidas acabar
+ * @param lotePtr Lote inicializado
+ * @return Total de peças fixadas somando todas as partidas
+ */
+long long simularLoteLockstep(LoteLockstep* lotePtr) {
+    while (avancarLoteLockstep(lotePtr) > 0) {
+    }
+    return lotePtr->pecasTotais;
+}
+
+// ═══════════════════════════════════════════════════════════════════════════════
+//                       HISTÓRICO DE AÇÕES (DESFAZER/REFAZER)
+// ═══════════════════════════════════════════════════════════════════════════════
+
+/**
+ * @brief Esvazia o histórico (nada a desfazer nem a refazer)
+ * @param historicoPtr Histórico a inicializar
+ */
+void inicializarHistorico(HistoricoAcoes* historicoPtr) {
+    historicoPtr->inicio = 0;
+    historicoPtr->aplicados = 0;
+    historicoPtr->registrados = 0;
+}
+
+/**
+ * @brief Guarda um delta no anel, descartando as ações que podiam ser refeitas
+ */
+static void registrarDeltaHistorico(HistoricoAcoes* historicoPtr, const DeltaHistorico* deltaPtr) {
+    if (historicoPtr == NULL) {
+        return;
+    }
+    historicoPtr->registrados = historicoPtr->aplicados;
+    if (historicoPtr->registrados == CAPACIDADE_HISTORICO) {
+        historicoPtr->inicio = (historicoPtr->inicio + 1) % CAPACIDADE_HISTORICO;
+        historicoPtr->registrados--;
+        historicoPtr->aplicados--;
+    }
+    int posicao = (historicoPtr->inicio + historicoPtr->aplicados) % CAPACIDADE_HISTORICO;
+    historicoPtr->deltas[posicao] = *deltaPtr;
+    historicoPtr->aplicados++;
+    historicoPtr->registrados++;
+}
+
+/**
+ * @brief Combina com o delta os campos do Sistema Expert guardados por XOR
+ * @param deltaPtr Delta em construção
+ * @param sistemaPtr Sistema Expert (chamado antes e depois da ação)
+ */
+static void acumularDeltaExpert(DeltaHistorico* deltaPtr, const SistemaExpert* sistemaPtr) {
+    uint64_t bits;
+    deltaPtr->xorSequencia ^= sistemaPtr->sequenciaTipoAtual;
+    deltaPtr->xorCombo ^= sistemaPtr->comboAtual;
+    deltaPtr->xorMelhorCombo ^= sistemaPtr->melhorCombo;
+    deltaPtr->xorRecorde ^= sistemaPtr->recordePessoal;
+    deltaPtr->xorEficiencia ^= sistemaPtr->eficienciaReserva;
+    deltaPtr->xorPontosProximoNivel ^= sistemaPtr->pontosParaProximoNivel;
+    deltaPtr->xorLimitePontosNivel ^= sistemaPtr->limitePontosNivel;
+    deltaPtr->xorUltimoTipo ^= sistemaPtr->ultimoTipoJogado;
+    deltaPtr->xorTipoMaisJogado ^= sistemaPtr->tipoMaisJogado;
+    deltaPtr->xorEstadoCombo ^= sistemaPtr->estadoCombo;
+    memcpy(&bits, &sistemaPtr->multiplicadorAtual, sizeof(bits));
+    deltaPtr->xorMultiplicador ^= bits;
+    memcpy(&bits, &sistemaPtr->fatorDificuldade, sizeof(bits));
+    deltaPtr->xorFator ^= bits;
+}
+
+/**
+ * @brief Aplica um delta ao Sistema Expert
+ * @param sistemaPtr Sistema Expert
+ * @param deltaPtr Delta registrado
+ * @param sentido +1 para refazer, -1 para desfazer
+ */
+static void aplicarDeltaExpert(SistemaExpert* sistemaPtr, const DeltaHistorico* deltaPtr, int sentido) {
+    uint64_t bits;
+    sistemaPtr->sequenciaTipoAtual ^= deltaPtr->xorSequencia;
+    sistemaPtr->comboAtual ^= deltaPtr->xorCombo;
+    sistemaPtr->melhorCombo ^= deltaPtr->xorMelhorCombo;
+    sistemaPtr->recordePessoal ^= deltaPtr->xorRecorde;
+    sistemaPtr->eficienciaReserva ^= deltaPtr->xorEficiencia;
+    sistemaPtr->pontosParaProximoNivel ^= deltaPtr->xorPontosProximoNivel;
+    sistemaPtr->limitePontosNivel ^= deltaPtr->xorLimitePontosNivel;
+    sistemaPtr->ultimoTipoJogado ^= deltaPtr->xorUltimoTipo;
+    sistemaPtr->tipoMaisJogado ^= deltaPtr->xorTipoMaisJogado;
+    sistemaPtr->estadoCombo ^= deltaPtr->xorEstadoCombo;
+    memcpy(&bits, &sistemaPtr->multiplicadorAtual, sizeof(bits));
+    bits ^= deltaPtr->xorMultiplicador;
+    memcpy(&sistemaPtr->multiplicadorAtual, &bits, sizeof(bits));
+    memcpy(&bits, &sistemaPtr->fatorDificuldade, sizeof(bits));
+    bits ^= deltaPtr->xorFator;
+    memcpy(&sistemaPtr->fatorDificuldade, &bits, sizeof(bits));
+
+    if (deltaPtr->acao != ACAO_HISTORICO_JOGAR_FILA && deltaPtr->acao != ACAO_HISTORICO_JOGAR_PILHA) {
+        return;
+    }
+    sistemaPtr->pontuacaoTotal += sentido * deltaPtr->pontos;
+    sistemaPtr->pontuacaoNivel += sentido * deltaPtr->pontos;
+    sistemaPtr->totalJogadas += sentido;
+    if (deltaPtr->acao == ACAO_HISTORICO_JOGAR_FILA) {
+        sistemaPtr->jogadasDaFila += sentido;
+    } else {
+        sistemaPtr->jogadasDaPilha += sentido;
+    }
+    switch (deltaPtr->peca.tipo) {
+        case 'I': sistemaPtr->contagemTipoI += sentido; break;
+        case 'O': sistemaPtr->contagemTipoO += sentido; break;
+        case 'T': sistemaPtr->contagemTipoT += sentido; break;
+        case 'L': sistemaPtr->contagemTipoL += sentido; break;
+    }
+    if (deltaPtr->subiuNivel) {
+        sistemaPtr->nivelAtual += sentido;
+        sistemaPtr->marcosAlcancados += sentido;
+    }
+}
+
+/**
+ * @brief processarJogadaExpert() que também produz o delta para desfazê-la
+ * @param peca Peça jogada
+ * @param origem Origem da peça (0=fila, 1=pilha)
+ * @param sistemaPtr Ponteiro para o sistema Expert
+ * @param deltaPtr Delta da jogada (saída)
+ *
+ * Junto com desfazerJogadaExpert() forma o par fazer/desfazer usado por
+ * buscas que exploram jogadas sem copiar o Sistema Expert a cada nó.
+ */
+void processarJogadaReversivel(Peca peca, int origem, SistemaExpert* sistemaPtr, DeltaHistorico* deltaPtr) {
+    memset(deltaPtr, 0, sizeof(*deltaPtr));
+    deltaPtr->acao = origem == 0 ? ACAO_HISTORICO_JOGAR_FILA : ACAO_HISTORICO_JOGAR_PILHA;
+    deltaPtr->peca = peca;
+
+    int pontuacaoAnterior = sistemaPtr->pontuacaoTotal;
+    int nivelAnterior = sistemaPtr->nivelAtual;
+    sincronizarSistemaExpert(sistemaPtr);
+    acumularDeltaExpert(deltaPtr, sistemaPtr);
+    processarJogadaExpert(peca, origem, sistemaPtr);
+    sincronizarSistemaExpert(sistemaPtr);
+    acumularDeltaExpert(deltaPtr, sistemaPtr);
+    deltaPtr->pontos = sistemaPtr->pontuacaoTotal - pontuacaoAnterior;
+    deltaPtr->subiuNivel = sistemaPtr->nivelAtual != nivelAnterior;
+}
+
+/**
+ * @brief Desfaz no Sistema Expert uma jogada de processarJogadaReversivel()
+ * @param sistemaPtr Ponteiro para o sistema Expert
+ * @param deltaPtr Delta da jogada (deve ser a última ainda não desfeita)
+ */
+void desfazerJogadaExpert(SistemaExpert* sistemaPtr, const DeltaHistorico* deltaPtr) {
+    aplicarDeltaExpert(sistemaPtr, deltaPtr, -1);
+}
+
+/**
+ * @brief Joga uma peça (fila ou reserva) e registra a jogada no histórico
+ * @param historicoPtr Histórico de ações (NULL = sem registro)
+ * @param origem Origem da peça (0=fila, 1=pilha)
+ * @param filaPtr Fila de peças
+ * @param pilhaPtr Pilha de reserva
+ * @param sistemaPtr Sistema Expert
+ * @param tabPtr Tabuleiro em que a peça é encaixada (NULL = sem tabuleiro)
+ * @return Peça jogada ('X' se a origem estava vazia)
+ *
+ * Se o tabuleiro precisar ser reiniciado (fim de partida) o histórico é
+ * esvaziado: o campo anterior não é guardado, então não há como voltar.
+ */
+Peca jogarPecaComHistorico(HistoricoAcoes* historicoPtr, int origem, FilaCircular* filaPtr,
+                           PilhaReserva* pilhaPtr, SistemaExpert* sistemaPtr, Tabuleiro* tabPtr) {
+    Peca peca = origem == 0 ? jogarPecaDaFila(filaPtr) : jogarPecaDaPilha(pilhaPtr);
+    if (peca.tipo == 'X') {
+        return peca;
+    }
+
+    DeltaHistorico delta;
+    processarJogadaReversivel(peca, origem, sistemaPtr, &delta);
+    if (tabPtr != NULL) {
+        int linhasCompletadas = encaixarPecaJogada(tabPtr, peca, origem, &delta.encaixe.jogada);
+        if (linhasCompletadas < 0) {
+            if (historicoPtr != NULL) {
+                inicializarHistorico(historicoPtr);
+            }
+            return peca;
+        }
+        delta.encaixe.linhasCompletadas = (uint8_t)linhasCompletadas;
+    }
+    registrarDeltaHistorico(historicoPtr, &delta);
+    return peca;
+}
+
+/**
+ * @brief transferirPecaFilaParaPilha() com registro no histórico
+ * @param historicoPtr Histórico de ações (NULL = sem registro)
+ * @param filaPtr Fila de peças
+ * @param pilhaPtr Pilha de reserva
+ */
+void transferirPecaComHistorico(HistoricoAcoes* historicoPtr, FilaCircular* filaPtr, PilhaReserva* pilhaPtr) {
+    if (filaVazia(filaPtr) || pilhaCheia(pilhaPtr)) {
+        return;
+    }
+    DeltaHistorico delta;
+    memset(&delta, 0, sizeof(delta));
+    delta.acao = ACAO_HISTORICO_TRANSFERIR;
+    delta.peca = *espiarFila(filaPtr, 0);
+    transferirPecaFilaParaPilha(filaPtr, pilhaPtr);
+    registrarDeltaHistorico(historicoPtr, &delta);
+}
+
+/**
+ * @brief Gera novas peças na fila com registro no histórico
+ * @param historicoPtr Histórico de ações (NULL = sem registro)
+ * @param filaPtr Fila de peças
+ * @param geradorPtr Gerador da partida (NULL = gerarPecasAleatorias())
+ *
+ * Com gerador, o delta guarda uma cópia dele antes do sorteio (a geração pode
+ * ter milhares de peças numa fila grande), com modo e saco, e refazer
+ * sorteia de novo a partir da cópia; sem
+ * gerador, guarda os até 5 tipos de gerarPecasAleatorias(). Nos dois casos
+ * refazer reinsere as mesmas peças com os mesmos IDs. Desfazer não devolve
+ * os IDs: eles nunca são reutilizados.
+ */
+void gerarPecasComHistorico(HistoricoAcoes* historicoPtr, FilaCircular* filaPtr, GeradorPecas* geradorPtr) {
+    int quantidadeAnterior = filaPtr->quantidadePecas;
+    GeradorPecas geradorAnterior = {0};
+    if (geradorPtr != NULL) {
+        geradorAnterior = *geradorPtr;
+    }
+    if (geradorPtr != NULL) {
+        reabastecerFila(filaPtr, geradorPtr);
+    } else {
+        gerarPecasAleatorias(filaPtr);
+    }
+
+    int inseridas = filaPtr->quantidadePecas - quantidadeAnterior;
+    if (historicoPtr == NULL || inseridas == 0) {
+        return;
+    }
+    DeltaHistorico delta;
+    memset(&delta, 0, sizeof(delta));
+    delta.acao = ACAO_HISTORICO_GERAR;
+    delta.geracao.quantidade = (uint16_t)inseridas;
+    delta.geracao.gerador = geradorAnterior;
+    for (int i = 0; geradorAnterior.estado == 0 && i < inseridas; i++) {
+        delta.geracao.tipos[i] = espiarFila(filaPtr, quantidadeAnterior + i)->tipo;
+    }
+    delta.peca = *espiarFila(filaPtr, quantidadeAnterior);
+    registrarDeltaHistorico(historicoPtr, &delta);
+}
+
+/**
+ * @brief otimizarSistemaExpert() com registro no histórico
+ * @param historicoPtr Histórico de ações (NULL = sem registro)
+ * @param sistemaPtr Sistema Expert
+ * @return 1 se otimização foi aplicada (e registrada), 0 caso contrário
+ */
+int otimizarSistemaComHistorico(HistoricoAcoes* historicoPtr, SistemaExpert* sistemaPtr) {
+    DeltaHistorico delta;
+    memset(&delta, 0, sizeof(delta));
+    delta.acao = ACAO_HISTORICO_OTIMIZAR;
+    sincronizarSistemaExpert(sistemaPtr);
+    acumularDeltaExpert(&delta, sistemaPtr);
+    int otimizado = otimizarSistemaExpert(sistemaPtr);
+    acumularDeltaExpert(&delta, sistemaPtr);
+    if (otimizado) {
+        registrarDeltaHistorico(historicoPtr, &delta);
+    }
+    return otimizado;
+}
+
+/**
+ * @brief Liga à última ação aplicada as conquistas desbloqueadas depois dela
+ * @param historicoPtr Histórico de ações (NULL = sem registro)
+ * @param novas Bits das regras que acabaram de ser desbloqueadas
+ *
+ * A avaliação de conquistas depende só do estado após as ações aplicadas,
+ * por isso os desbloqueios pertencem à ação mais recente, mesmo depois de
+ * um desfazer ou refazer. Sem ação aplicada eles não podem ser desfeitos.
+ */
+void registrarConquistasHistorico(HistoricoAcoes* historicoPtr, const uint64_t* novas) {
+    if (historicoPtr == NULL || historicoPtr->aplicados == 0) {
+        return;
+    }
+    DeltaHistorico* deltaPtr =
+        &historicoPtr->deltas[(historicoPtr->inicio + historicoPtr->aplicados - 1) % CAPACIDADE_HISTORICO];
+    for (int i = 0; i < MAX_CONQUISTAS / 64; i++) {
+        deltaPtr->conquistas[i] |= novas[i];
+    }
+}
+
+/**
+ * @brief Bloqueia (desfazer) ou desbloqueia (refazer) as conquistas de um delta
+ */
+static void aplicarConquistasDelta(EstadoConquistas* conquistasPtr, SistemaExpert* sistemaPtr,
+                                   const DeltaHistorico* deltaPtr, int sentido) {
+    uint32_t primeiras = (uint32_t)deltaPtr->conquistas[0];
+    if (sentido > 0) {
+        sistemaPtr->conquistasDesbloqueadas |= primeiras;
+    } else {
+        sistemaPtr->conquistasDesbloqueadas &= ~primeiras;
+    }
+    if (conquistasPtr == NULL) {
+        return;
+    }
+    for (int i = 0; i < MAX_CONQUISTAS / 64; i++) {
+        if (sentido > 0) {
+            conquistasPtr->desbloqueadas[i] |= deltaPtr->conquistas[i];
+        } else {
+            conquistasPtr->desbloqueadas[i] &= ~deltaPtr->conquistas[i];
+        }
+    }
+}
+
+/**
+ * @brief Desfaz a última ação registrada
+ * @param historicoPtr Histórico de ações (NULL = sem registro)
+ * @param filaPtr Fila de peças
+ * @param pilhaPtr Pilha de reserva
+ * @param sistemaPtr Sistema Expert
+ * @param conquistasPtr Conquistas da partida (NULL = só conquistasDesbloqueadas)
+ * @param tabPtr Tabuleiro (o mesmo passado a jogarPecaComHistorico)
+ * @return Ação desfeita (AcaoHistorico), ou -1 se não há o que desfazer
+ */
+int desfazerAcao(HistoricoAcoes* historicoPtr, FilaCircular* filaPtr, PilhaReserva* pilhaPtr,
+                 SistemaExpert* sistemaPtr, EstadoConquistas* conquistasPtr, Tabuleiro* tabPtr) {
+    if (historicoPtr == NULL || historicoPtr->aplicados == 0) {
+        return -1;
+    }
+    historicoPtr->aplicados--;
+    const DeltaHistorico* deltaPtr =
+        &historicoPtr->deltas[(historicoPtr->inicio + historicoPtr->aplicados) % CAPACIDADE_HISTORICO];
+    aplicarConquistasDelta(conquistasPtr, sistemaPtr, deltaPtr, -1);
+
+    switch (deltaPtr->acao) {
+        case ACAO_HISTORICO_JOGAR_FILA:
+        case ACAO_HISTORICO_JOGAR_PILHA:
+            if (tabPtr != NULL && deltaPtr->encaixe.jogada.tipo != 0) {
+                desfazerJogada(tabPtr, &deltaPtr->encaixe.jogada, deltaPtr->encaixe.linhasCompletadas);
+            }
+            desfazerJogadaExpert(sistemaPtr, deltaPtr);
+            if (deltaPtr->acao == ACAO_HISTORICO_JOGAR_FILA) {
+                devolverPecaAFila(filaPtr, deltaPtr->peca);
+            } else {
+                reservarPeca(pilhaPtr, deltaPtr->peca);
+            }
+            break;
+        case ACAO_HISTORICO_TRANSFERIR:
+            jogarPecaDaPilha(pilhaPtr);
+            devolverPecaAFila(filaPtr, deltaPtr->peca);
+            break;
+        case ACAO_HISTORICO_GERAR:
+            descartarFinalDaFila(filaPtr, deltaPtr->geracao.quantidade);
+            break;
+        case ACAO_HISTORICO_OTIMIZAR:
+            aplicarDeltaExpert(sistemaPtr, deltaPtr, -1);
+            break;
+    }
+    return deltaPtr->acao;
+}
+
+/**
+ * @brief Refaz a última ação desfeita
+ * @param historicoPtr Histórico de ações (NULL = sem registro)
+ * @param filaPtr Fila de peças
+ * @param pilhaPtr Pilha de reserva
+ * @param sistemaPtr Sistema Expert
+ * @param conquistasPtr Conquistas da partida (NULL = só conquistasDesbloqueadas)
+ * @param tabPtr Tabuleiro (o mesmo passado a jogarPecaComHistorico)
+ * @return Ação refeita (AcaoHistorico), ou -1 se não há o que refazer
+ */
+int refazerAcao(HistoricoAcoes* historicoPtr, FilaCircular* filaPtr, PilhaReserva* pilhaPtr,
+                SistemaExpert* sistemaPtr, EstadoConquistas* conquistasPtr, Tabuleiro* tabPtr) {
+    if (historicoPtr == NULL || historicoPtr->aplicados == historicoPtr->registrados) {
+        return -1;
+    }
+    const DeltaHistorico* deltaPtr =
+        &historicoPtr->deltas[(historicoPtr->inicio + historicoPtr->aplicados) % CAPACIDADE_HISTORICO];
+    historicoPtr->aplicados++;
+    aplicarConquistasDelta(conquistasPtr, sistemaPtr, deltaPtr, +1);
+
+    switch (deltaPtr->acao) {
+        case ACAO_HISTORICO_JOGAR_FILA:
+        case ACAO_HISTORICO_JOGAR_PILHA:
+            if (deltaPtr->acao == ACAO_HISTORICO_JOGAR_FILA) {
+                jogarPecaDaFila(filaPtr);
+            } else {
+                jogarPecaDaPilha(pilhaPtr);
+            }
+            aplicarDeltaExpert(sistemaPtr, deltaPtr, +1);
+            if (tabPtr != NULL && deltaPtr->encaixe.jogada.tipo != 0) {
+                aplicarJogada(tabPtr, &deltaPtr->encaixe.jogada);
+            }
+            break;
+        case ACAO_HISTORICO_TRANSFERIR:
+            reservarPeca(pilhaPtr, jogarPecaDaFila(filaPtr));
+            break;
+        case ACAO_HISTORICO_GERAR: {
+            GeradorPecas reprise = deltaPtr->geracao.gerador;
+            for (int i = 0; i < deltaPtr->geracao.quantidade; i++) {
+                char tipo = reprise.estado != 0 ? sortearTipoPeca(&reprise) : deltaPtr->geracao.tipos[i];
+                inserirPecaNaFila(filaPtr, criarPeca(tipo, deltaPtr->peca.id + i));
+            }
+            break;
+        }
+        case ACAO_HISTORICO_OTIMIZAR:
+            aplicarDeltaExpert(sistemaPtr, deltaPtr, +1);
+            break;
+    }
+    return deltaPtr->acao;
+}
+
+/**
+ * @brief Exibe o menu principal
+ */
+void exibirMenu() {
+    imprimirJogo("\n+==============================================================+\n");
+    imprimirJogo("|                    TETRIS EXPERT SYSTEM                     |\n");
+    imprimirJogo("+==============================================================+\n");
+    imprimirJogo("| 1. Jogar peca da fila                                       |\n");
+    imprimirJogo("| 2. Jogar peca da pilha de reserva                           |\n");
+    imprimirJogo("| 3. Transferir peca da fila para reserva                     |\n");
+    imprimirJogo("| 4. Gerar novas pecas aleatorias                             |\n");
+    imprimirJogo("| 5. Exibir estado completo                                   |\n");
+    imprimirJogo("| 6. Exibir estatisticas Expert                               |\n");
+    imprimirJogo("| 7. Otimizar sistema Expert                                  |\n");
+    imprimirJogo("| 8. Gerar relatorio Expert                                   |\n");
+    imprimirJogo("| 9. Desfazer ultima acao                                     |\n");
+    imprimirJogo("| 10. Refazer acao desfeita                                   |\n");
+    imprimirJogo("| 0. Sair                                                     |\n");
+    imprimirJogo("+==============================================================+\n");
+    imprimirJogo("Escolha uma opcao: ");
+}
+
+// ═══════════════════════════════════════════════════════════════════════════════
+//                       CONQUISTAS E MARCOS (TABELA DE REGRAS)
+// ═══════════════════════════════════════════════════════════════════════════════
+
+/// Conquistas das sessões do menu; as duas primeiras são as do nível 5 e 10 originais
+static const RegraConquista REGRAS_CONQUISTA_PADRAO[] = {
+    {"Veterano", "Nivel 5", {{CAMPO_NIVEL, 5}}, 1},
+    {"Mestre", "Nivel 10", {{CAMPO_NIVEL, 10}}, 1},
+    {"Lenda", "Nivel 15", {{CAMPO_NIVEL, 15}}, 1},
+    {"Imortal", "Nivel 20", {{CAMPO_NIVEL, 20}}, 1},
+    {"Primeiros Passos", "10 pecas jogadas", {{CAMPO_TOTAL_JOGADAS, 10}}, 1},
+    {"Centuriao", "100 pecas jogadas", {{CAMPO_TOTAL_JOGADAS, 100}}, 1},
+    {"Maratonista", "1000 pecas jogadas", {{CAMPO_TOTAL_JOGADAS, 1000}}, 1},
+    {"Dez Mil", "10.000 pontos", {{CAMPO_PONTUACAO_TOTAL, 10000}}, 1},
+    {"Especialista em Pontuacao", "50.000 pontos", {{CAMPO_PONTUACAO_TOTAL, 50000}}, 1},
+    {"Milionario", "1.000.000 de pontos", {{CAMPO_PONTUACAO_TOTAL, 1000000}}, 1},
+    {"Sequencia", "Combo 1", {{CAMPO_MELHOR_COMBO, 1}}, 1},
+    {"Combo Triplo", "Combo 3", {{CAMPO_MELHOR_COMBO, 3}}, 1},
+    {"Mestre dos Combos", "Combo 10", {{CAMPO_MELHOR_COMBO, 10}}, 1},
+    {"Guardiao", "25 pecas jogadas da reserva", {{CAMPO_JOGADAS_DA_PILHA, 25}}, 1},
+    {"Estrategista", "100 pecas da reserva no nivel 5",
+     {{CAMPO_JOGADAS_DA_PILHA, 100}, {CAMPO_NIVEL, 5}}, 2},
+    {"Direto da Fila", "200 pecas jogadas da fila", {{CAMPO_JOGADAS_DA_FILA, 200}}, 1},
+    {"Linha Reta", "50 pecas I", {{CAMPO_CONTAGEM_I, 50}}, 1},
+    {"Quadrado Perfeito", "50 pecas O", {{CAMPO_CONTAGEM_O, 50}}, 1},
+    {"Em Forma de T", "50 pecas T", {{CAMPO_CONTAGEM_T, 50}}, 1},
+    {"Cantoneira", "50 pecas L", {{CAMPO_CONTAGEM_L, 50}}, 1},
+    {"Colecionador", "25 pecas de cada um dos tipos I e T",
+     {{CAMPO_CONTAGEM_I, 25}, {CAMPO_CONTAGEM_T, 25}}, 2},
+    {"Escalada", "3 marcos alcancados", {{CAMPO_MARCOS, 3}}, 1},
+};
+
+/**
+ * @brief Valor atual de um campo consultado pelas regras
+ */
+static inline int valorCampoConquista(const SistemaExpert* sistemaPtr, int campo) {
+    switch (campo) {
+        case CAMPO_PONTUACAO_TOTAL: return sistemaPtr->pontuacaoTotal;
+        case CAMPO_NIVEL: return sistemaPtr->nivelAtual;
+        case CAMPO_MELHOR_COMBO: return sistemaPtr->melhorCombo;
+        case CAMPO_TOTAL_JOGADAS: return sistemaPtr->totalJogadas;
+        case CAMPO_JOGADAS_DA_FILA: return sistemaPtr->totalJogadas - sistemaPtr->jogadasDaPilha;
+        case CAMPO_JOGADAS_DA_PILHA: return sistemaPtr->jogadasDaPilha;
+        case CAMPO_CONTAGEM_I: return sistemaPtr->contagemTipoI;
+        case CAMPO_CONTAGEM_O: return sistemaPtr->contagemTipoO;
+        case CAMPO_CONTAGEM_T: return sistemaPtr->contagemTipoT;
+        case CAMPO_CONTAGEM_L: return sistemaPtr->contagemTipoL;
+        default: return sistemaPtr->marcosAlcancados;
+    }
+}
+
+/**
+ * @brief Compila uma tabela de regras no índice por campo
+ * @param motorPtr Motor a preencher
+ * @param regras Tabela de regras (deve continuar válida enquanto o motor for usado)
+ * @param quantidade Número de regras (até MAX_CONQUISTAS)
+ * @return 1 em caso de sucesso, 0 se a tabela é inválida ou faltou memória
+ */
+int compilarMotorConquistas(MotorConquistas* motorPtr, const RegraConquista* regras, int quantidade) {
+    memset(motorPtr, 0, sizeof(*motorPtr));
+    if (quantidade < 0 || quantidade > MAX_CONQUISTAS) {
+        return 0;
+    }
+    int entradas = 0;
+    int porCampo[NUMERO_CAMPOS_CONQUISTA] = {0};
+    for (int r = 0; r < quantidade; r++) {
+        if (regras[r].quantidadeCondicoes < 1 || regras[r].quantidadeCondicoes > MAX_CONDICOES_CONQUISTA) {
+            return 0;
+        }
+        for (int c = 0; c < regras[r].quantidadeCondicoes; c++) {
+            if (regras[r].condicoes[c].campo >= NUMERO_CAMPOS_CONQUISTA) {
+                return 0;
+            }
+            porCampo[regras[r].condicoes[c].campo]++;
+            entradas++;
+        }
+    }
+
+    motorPtr->ordem = malloc(sizeof(uint16_t) * (size_t)(entradas > 0 ? entradas : 1));
+    motorPtr->limiares = malloc(sizeof(int) * (size_t)(entradas > 0 ? entradas : 1));
+    if (motorPtr->ordem == NULL || motorPtr->limiares == NULL) {
+        liberarMotorConquistas(motorPtr);
+        return 0;
+    }
+    for (int campo = 0; campo < NUMERO_CAMPOS_CONQUISTA; campo++) {
+        motorPtr->inicioCampo[campo + 1] = motorPtr->inicioCampo[campo] + porCampo[campo];
+        porCampo[campo] = motorPtr->inicioCampo[campo];
+    }
+
+    // Distribui as condições pelos campos, mantendo cada campo ordenado pelo limiar
+    for (int r = 0; r < quantidade; r++) {
+        for (int c = 0; c < regras[r].quantidadeCondicoes; c++) {
+            int campo = regras[r].condicoes[c].campo;
+            int limiar = regras[r].condicoes[c].limiar;
+            int posicao = porCampo[campo]++;
+            while (posicao > motorPtr->inicioCampo[campo] && motorPtr->limiares[posicao - 1] > limiar) {
+                motorPtr->ordem[posicao] = motorPtr->ordem[posicao - 1];
+                motorPtr->limiares[posicao] = motorPtr->limiares[posicao - 1];
+                posicao--;
+            }
+            motorPtr->ordem[posicao] = (uint16_t)r;
+            motorPtr->limiares[posicao] = limiar;
+        }
+    }
+    motorPtr->regras = regras;
+    motorPtr->quantidadeRegras = quantidade;
+    return 1;
+}
+
+/**
+ * @brief Libera o índice de um motor compilado
+ * @param motorPtr Motor a liberar
+ */
+void liberarMotorConquistas(MotorConquistas* motorPtr) {
+    free(motorPtr->ordem);
+    free(motorPtr->limiares);
+    motorPtr->ordem = NULL;
+    motorPtr->limiares = NULL;
+    motorPtr->quantidadeRegras = 0;
+}
+
+static MotorConquistas motorConquistasPadrao;
+static pthread_once_t motorConquistasPadraoPronto = PTHREAD_ONCE_INIT;
+
+static void compilarMotorConquistasPadrao(void) {
+    compilarMotorConquistas(&motorConquistasPadrao, REGRAS_CONQUISTA_PADRAO,
+                            (int)(sizeof(REGRAS_CONQUISTA_PADRAO) / sizeof(REGRAS_CONQUISTA_PADRAO[0])));
+}
+
+/**
+ * @brief Motor com as conquistas padrão, compilado no primeiro uso
+ */
+const MotorConquistas* obterMotorConquistasPadrao(void) {
+    pthread_once(&motorConquistasPadraoPronto, compilarMotorConquistasPadrao);
+    return &motorConquistasPadrao;
+}
+
+/**
+ * @brief Prepara as conquistas de uma partida nova
+ * @param estadoPtr Estado a inicializar
+ * @param motorPtr Motor com que o estado será avaliado
+ */
+void inicializarConquistas(EstadoConquistas* estadoPtr, const MotorConquistas* motorPtr) {
+    memset(estadoPtr, 0, sizeof(*estadoPtr));
+    for (int campo = 0; campo < NUMERO_CAMPOS_CONQUISTA; campo++) {
+        estadoPtr->cursor[campo] = (uint16_t)motorPtr->inicioCampo[campo];
+    }
+}
+
+/**
+ * @brief Desbloqueia a regra se todas as suas condições valem
+ * @return 1 se a regra acabou de ser desbloqueada
+ */
+static int verificarRegraConquista(const MotorConquistas* motorPtr, EstadoConquistas* estadoPtr,
+                                   SistemaExpert* sistemaPtr, int indice) {
+    uint64_t bit = 1ULL << (indice % 64);
+    if (estadoPtr->desbloqueadas[indice / 64] & bit) {
+        return 0;
+    }
+    const RegraConquista* regraPtr = &motorPtr->regras[indice];
+    for (int c = 0; c < regraPtr->quantidadeCondicoes; c++) {
+        if (valorCampoConquista(sistemaPtr, regraPtr->condicoes[c].campo) < regraPtr->condicoes[c].limiar) {
+            return 0;
+        }
+    }
+    estadoPtr->desbloqueadas[indice / 64] |= bit;
+    if (indice < 32) {
+        sistemaPtr->conquistasDesbloqueadas |= 1u << indice;
+    }
+    if (estadoPtr->quantidadeEventos < CAPACIDADE_EVENTOS_CONQUISTA) {
+        int posicao = (estadoPtr->inicioEventos + estadoPtr->quantidadeEventos) % CAPACIDADE_EVENTOS_CONQUISTA;
+        estadoPtr->eventos[posicao] = (uint16_t)indice;
+        estadoPtr->quantidadeEventos++;
+    } else {
+        estadoPtr->eventosPerdidos++;
+    }
+    return 1;
+}
+
+/**
+ * @brief Avalia as regras cujos limiares foram cruzados desde a última avaliação
+ * @param motorPtr Regras compiladas
+ * @param estadoPtr Conquistas da partida
+ * @param sistemaPtr Sistema Expert da partida
+ * @return Número de conquistas desbloqueadas agora
+ *
+ * Chamada depois das jogadas, fora de processarJogadaExpert(). Por campo,
+ * custa uma comparação quando nenhum limiar foi cruzado, qualquer que seja
+ * o número de regras. Os desbloqueios entram na fila de eventos (ver
+ * proximaConquistaDesbloqueada()) e, para as 32 primeiras regras, também
+ * em conquistasDesbloqueadas. Se um desfazer reduzir um campo, o cursor
+ * volta e a regra é reexaminada quando o limiar for cruzado de novo; as
+ * regras que o desfazer bloqueou (ver registrarConquistasHistorico()) são
+ * então desbloqueadas de novo.
+ */
+int avaliarConquistas(const MotorConquistas* motorPtr, EstadoConquistas* estadoPtr, SistemaExpert* sistemaPtr) {
+    int desbloqueadas = 0;
+    for (int campo = 0; campo < NUMERO_CAMPOS_CONQUISTA; campo++) {
+        int valor = valorCampoConquista(sistemaPtr, campo);
+        int cursor = estadoPtr->cursor[campo];
+        while (cursor < motorPtr->inicioCampo[campo + 1] && valor >= motorPtr->limiares[cursor]) {
+            desbloqueadas += verificarRegraConquista(motorPtr, estadoPtr, sistemaPtr, motorPtr->ordem[cursor]);
+            cursor++;
+        }
+        while (cursor > motorPtr->inicioCampo[campo] && valor < motorPtr->limiares[cursor - 1]) {
+            cursor--;
+        }
+        estadoPtr->cursor[campo] = (uint16_t)cursor;
+    }
+    return desbloqueadas;
+}
+
+/**
+ * @brief Retira o desbloqueio mais antigo ainda não exibido
+ * @param estadoPtr Conquistas da partida
+ * @return Índice da regra no motor, ou -1 se a fila está vazia
+ */
+int proximaConquistaDesbloqueada(EstadoConquistas* estadoPtr) {
+    if (estadoPtr->quantidadeEventos == 0) {
+        return -1;
+    }
+    int indice = estadoPtr->eventos[estadoPtr->inicioEventos];
+    estadoPtr->inicioEventos = (uint8_t)((estadoPtr->inicioEventos + 1) % CAPACIDADE_EVENTOS_CONQUISTA);
+    estadoPtr->quantidadeEventos--;
+    return indice;
+}
+
+// ═══════════════════════════════════════════════════════════════════════════════
+//                       DIÁRIO DE JOGADAS (ESCRITA ASSÍNCRONA)
+// ═══════════════════════════════════════════════════════════════════════════════
+
+static _Atomic uint64_t proximoIdentificadorDiario = 1;
+
+// Anel da thread atual e o diário a que ele pertence
+static _Thread_local AnelDiario* anelDiarioThread = NULL;
+static _Thread_local uint64_t diarioDoAnelThread = 0;
+
+static uint64_t instanteDiarioNs(clockid_t relogio) {
+    struct timespec instante;
+    clock_gettime(relogio, &instante);
+    return (uint64_t)instante.tv_sec * 1000000000ULL + (uint64_t)instante.tv_nsec;
+}
+
+/// Soma uma medição ao total e atualiza o máximo (só o escritor chama)
+static void acumularLatenciaDiario(_Atomic uint64_t* totalPtr, _Atomic uint64_t* maximoPtr, uint64_t ns) {
+    atomic_store_explicit(totalPtr, atomic_load_explicit(totalPtr, memory_order_relaxed) + ns,
+                          memory_order_relaxed);
+    if (ns > atomic_load_explicit(maximoPtr, memory_order_relaxed)) {
+        atomic_store_explicit(maximoPtr, ns, memory_order_relaxed);
+    }
+}
+
+static void sincronizarDiario(DiarioJogadas* diarioPtr) {
+    uint64_t inicio = instanteDiarioNs(CLOCK_MONOTONIC);
+    fdatasync(diarioPtr->descritor);
+    acumularLatenciaDiario(&diarioPtr->latenciaSyncTotalNs, &diarioPtr->latenciaSyncMaximaNs,
+                           instanteDiarioNs(CLOCK_MONOTONIC) - inicio);
+    atomic_fetch_add_explicit(&diarioPtr->sincronizacoes, 1, memory_order_relaxed);
+}
+
+/**
+ * @brief Grava o bloco acumulado pelo escritor
+ * @return 1 se os dados chegaram ao arquivo, 0 se foram perdidos
+ */
+static int gravarBlocoDiario(DiarioJogadas* diarioPtr, size_t bytes) {
+    uint64_t inicio = instanteDiarioNs(CLOCK_MONOTONIC);
+    size_t gravados = 0;
+    while (gravados < bytes) {
+        ssize_t resultado = write(diarioPtr->descritor, diarioPtr->bloco + gravados, bytes - gravados);
+        if (resultado < 0 && errno == EINTR) {
+            continue;
+        }
+        if (resultado <= 0) {
+            fprintf(stderr, "Falha ao gravar o diario: %s\n", strerror(errno));
+            atomic_fetch_add_explicit(&diarioPtr->descartadosFora, (bytes - gravados) / sizeof(EventoDiario),
+                                      memory_order_relaxed);
+            return 0;
+        }
+        gravados += (size_t)resultado;
+    }
+    acumularLatenciaDiario(&diarioPtr->latenciaEscritaTotalNs, &diarioPtr->latenciaEscritaMaximaNs,
+                           instanteDiarioNs(CLOCK_MONOTONIC) - inicio);
+    atomic_fetch_add_explicit(&diarioPtr->escritas, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&diarioPtr->bytesEscritos, bytes, memory_order_relaxed);
+    atomic_fetch_add_explicit(&diarioPtr->eventosEscritos, bytes / sizeof(EventoDiario), memory_order_relaxed);
+    if (diarioPtr->politicaSync == SYNC_DIARIO_SEMPRE) {
+        sincronizarDiario(diarioPtr);
+    }
+    return 1;
+}
+
+/**
+ * @brief Thread que esvazia os anéis no arquivo
+ *
+ * Cada varredura copia os eventos de todos os anéis para o bloco e o grava
+ * quando enche ou ao fim da varredura; um evento só volta a ocupar o anel
+ * depois de copiado. Termina quando, com o encerramento pedido, uma
+ * varredura inteira não encontra nada.
+ */
+static void* executarEscritorDiario(void* argumento) {
+    DiarioJogadas* diarioPtr = argumento;
+    const size_t eventosPorBloco = TAMANHO_BLOCO_DIARIO / sizeof(EventoDiario);
+    uint64_t ultimaSync = instanteDiarioNs(CLOCK_MONOTONIC);
+    int pendenteSync = 0;
+
+    for (;;) {
+        int encerrando = atomic_load_explicit(&diarioPtr->encerrar, memory_order_acquire);
+        int quantidadeAneis = atomic_load_explicit(&diarioPtr->quantidadeAneis, memory_order_acquire);
+        size_t noBloco = 0;
+        uint64_t profundidade = 0;
+
+        for (int a = 0; a < quantidadeAneis; a++) {
+            AnelDiario* anelPtr = diarioPtr->aneis[a];
+            uint64_t leitura = atomic_load_explicit(&anelPtr->leitura, memory_order_relaxed);
+            uint64_t escrita = atomic_load_explicit(&anelPtr->escrita, memory_order_acquire);
+            profundidade += escrita - leitura;
+            while (leitura < escrita) {
+                size_t inicio = (size_t)(leitura & (CAPACIDADE_ANEL_DIARIO - 1));
+                size_t trecho = (size_t)(escrita - leitura);
+                if (trecho > CAPACIDADE_ANEL_DIARIO - inicio) {
+                    trecho = CAPACIDADE_ANEL_DIARIO - inicio;
+                }
+                if (trecho > eventosPorBloco - noBloco) {
+                    trecho = eventosPorBloco - noBloco;
+                }
+                memcpy(diarioPtr->bloco + noBloco * sizeof(EventoDiario), &anelPtr->eventos[inicio],
+                       trecho * sizeof(EventoDiario));
+                noBloco += trecho;
+                leitura += trecho;
+                atomic_store_explicit(&anelPtr->leitura, leitura, memory_order_release);
+                if (noBloco == eventosPorBloco) {
+                    pendenteSync |= gravarBlocoDiario(diarioPtr, noBloco * sizeof(EventoDiario));
+                    noBloco = 0;
+                }
+            }
+        }
+        if (noBloco > 0) {
+            pendenteSync |= gravarBlocoDiario(diarioPtr, noBloco * sizeof(EventoDiario));
+        }
+
+        atomic_store_explicit(&diarioPtr->profundidadeAtual, profundidade, memory_order_relaxed);
+        if (profundidade > atomic_load_explicit(&diarioPtr->profundidadeMaxima, memory_order_relaxed)) {
+            atomic_store_explicit(&diarioPtr->profundidadeMaxima, profundidade, memory_order_relaxed);
+        }
+
+        uint64_t agora = instanteDiarioNs(CLOCK_MONOTONIC);
+        if (diarioPtr->politicaSync == SYNC_DIARIO_GRUPO && pendenteSync &&
+            agora - ultimaSync >= (uint64_t)diarioPtr->intervaloSyncMs * 1000000ULL) {
+            sincronizarDiario(diarioPtr);
+            ultimaSync = agora;
+            pendenteSync = 0;
+        }
+
+        if (profundidade == 0) {
+            if (encerrando) {
+                break;
+            }
+            struct timespec pausa = {0, PAUSA_ESCRITOR_DIARIO_US * 1000L};
+            nanosleep(&pausa, NULL);
+        }
+    }
+
+    if (diarioPtr->politicaSync == SYNC_DIARIO_GRUPO && pendenteSync) {
+        sincronizarDiario(diarioPtr);
+    }
+    return NULL;
+}
+
+/**
+ * @brief Abre (ou continua) o arquivo do diário e inicia o escritor
+ * @param diarioPtr Diário a preparar
+ * @param caminho Arquivo; os eventos são acrescentados ao final
+ * @param politica Quando forçar os dados para o disco
+ * @param intervaloSyncMs Janela do group commit em SYNC_DIARIO_GRUPO
+ * @return 1 em caso de sucesso, 0 se o arquivo ou a thread falharam
+ */
+int abrirDiario(DiarioJogadas* diarioPtr, const char* caminho, PoliticaSyncDiario politica, int intervaloSyncMs) {
+    memset(diarioPtr, 0, sizeof(*diarioPtr));
+    diarioPtr->descritor = open(caminho, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (diarioPtr->descritor < 0) {
+        fprintf(stderr, "Nao foi possivel abrir o diario %s: %s\n", caminho, strerror(errno));
+        return 0;
+    }
+    diarioPtr->politicaSync = (uint8_t)politica;
+    diarioPtr->intervaloSyncMs = intervaloSyncMs > 0 ? intervaloSyncMs : 0;
+    diarioPtr->identificador = atomic_fetch_add(&proximoIdentificadorDiario, 1);
+    diarioPtr->bloco = malloc(TAMANHO_BLOCO_DIARIO);
+    pthread_mutex_init(&diarioPtr->trava, NULL);
+    if (diarioPtr->bloco == NULL ||
+        pthread_create(&diarioPtr->escritor, NULL, executarEscritorDiario, diarioPtr) != 0) {
+        pthread_mutex_destroy(&diarioPtr->trava);
+        free(diarioPtr->bloco);
+        close(diarioPtr->descritor);
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief Cria o anel da thread atual no diário
+ * @return Anel, ou NULL se o diário já tem MAX_ANEIS_DIARIO threads
+ */
+static AnelDiario* registrarAnelDiario(DiarioJogadas* diarioPtr) {
+    AnelDiario* anelPtr = NULL;
+    pthread_mutex_lock(&diarioPtr->trava);
+    int quantidade = atomic_load_explicit(&diarioPtr->quantidadeAneis, memory_order_relaxed);
+    if (quantidade < MAX_ANEIS_DIARIO && (anelPtr = aligned_alloc(_Alignof(AnelDiario), sizeof(AnelDiario))) != NULL) {
+        memset(anelPtr, 0, sizeof(*anelPtr));
+        diarioPtr->aneis[quantidade] = anelPtr;
+        atomic_store_explicit(&diarioPtr->quantidadeAneis, quantidade + 1, memory_order_release);
+    }
+    pthread_mutex_unlock(&diarioPtr->trava);
+    return anelPtr;
+}
+
+/**
+ * @brief Entrega um evento ao escritor sem bloquear
+ * @param diarioPtr Diário aberto
+ * @param eventoPtr Evento a gravar
+ * @return 1 se o evento entrou no anel, 0 se foi descartado (anel cheio)
+ *
+ * A primeira chamada de cada thread registra o anel dela; as demais só
+ * copiam o evento e publicam o novo índice.
+ */
+int registrarEventoDiario(DiarioJogadas* diarioPtr, const EventoDiario* eventoPtr) {
+    if (diarioDoAnelThread != diarioPtr->identificador) {
+        anelDiarioThread = registrarAnelDiario(diarioPtr);
+        diarioDoAnelThread = diarioPtr->identificador;
+    }
+    AnelDiario* anelPtr = anelDiarioThread;
+    if (anelPtr == NULL) {
+        atomic_fetch_add_explicit(&diarioPtr->descartadosFora, 1, memory_order_relaxed);
+        return 0;
+    }
+
+    uint64_t escrita = atomic_load_explicit(&anelPtr->escrita, memory_order_relaxed);
+    if (escrita - anelPtr->leituraConhecida >= CAPACIDADE_ANEL_DIARIO) {
+        anelPtr->leituraConhecida = atomic_load_explicit(&anelPtr->leitura, memory_order_acquire);
+        if (escrita - anelPtr->leituraConhecida >= CAPACIDADE_ANEL_DIARIO) {
+            atomic_store_explicit(&anelPtr->descartados,
+                                  atomic_load_explicit(&anelPtr->descartados, memory_order_relaxed) + 1,
+                                  memory_order_relaxed);
+            return 0;
+        }
+    }
+    anelPtr->eventos[escrita & (CAPACIDADE_ANEL_DIARIO - 1)] = *eventoPtr;
+    atomic_store_explicit(&anelPtr->escrita, escrita + 1, memory_order_release);
+    return 1;
+}
+
+/**
+ * @brief Copia as métricas atuais do diário
+ * @param diarioPtr Diário aberto
+ * @param metricasPtr Destino
+ */
+void lerMetricasDiario(DiarioJogadas* diarioPtr, MetricasDiario* metricasPtr) {
+    memset(metricasPtr, 0, sizeof(*metricasPtr));
+    metricasPtr->eventosRegistrados = diarioPtr->registradosFechados;
+    metricasPtr->eventosDescartados = diarioPtr->descartadosFechados;
+    int quantidadeAneis = atomic_load_explicit(&diarioPtr->quantidadeAneis, memory_order_acquire);
+    for (int a = 0; a < quantidadeAneis; a++) {
+        metricasPtr->eventosRegistrados += atomic_load_explicit(&diarioPtr->aneis[a]->escrita, memory_order_relaxed);
+        metricasPtr->eventosDescartados += atomic_load_explicit(&diarioPtr->aneis[a]->descartados,
+                                                                memory_order_relaxed);
+    }
+    metricasPtr->eventosDescartados += atomic_load_explicit(&diarioPtr->descartadosFora, memory_order_relaxed);
+    metricasPtr->eventosEscritos = atomic_load_explicit(&diarioPtr->eventosEscritos, memory_order_relaxed);
+    metricasPtr->bytesEscritos = atomic_load_explicit(&diarioPtr->bytesEscritos, memory_order_relaxed);
+    metricasPtr->escritas = atomic_load_explicit(&diarioPtr->escritas, memory_order_relaxed);
+    metricasPtr->sincronizacoes = atomic_load_explicit(&diarioPtr->sincronizacoes, memory_order_relaxed);
+    metricasPtr->profundidadeAtual = atomic_load_explicit(&diarioPtr->profundidadeAtual, memory_order_relaxed);
+    metricasPtr->profundidadeMaxima = atomic_load_explicit(&diarioPtr->profundidadeMaxima, memory_order_relaxed);
+    metricasPtr->latenciaEscritaTotalNs = atomic_load_explicit(&diarioPtr->latenciaEscritaTotalNs,
+                                                               memory_order_relaxed);
+    metricasPtr->latenciaEscritaMaximaNs = atomic_load_explicit(&diarioPtr->latenciaEscritaMaximaNs,
+                                                                memory_order_relaxed);
+    metricasPtr->latenciaSyncTotalNs = atomic_load_explicit(&diarioPtr->latenciaSyncTotalNs, memory_order_relaxed);
+    metricasPtr->latenciaSyncMaximaNs = atomic_load_explicit(&diarioPtr->latenciaSyncMaximaNs,
+                                                             memory_order_relaxed);
+}
+
+/**
+ * @brief Grava o que resta nos anéis, encerra o escritor e fecha o arquivo
+ * @param diarioPtr Diário aberto, sem threads registrando eventos
+ *
+ * As métricas continuam disponíveis para lerMetricasDiario().
+ */
+void fecharDiario(DiarioJogadas* diarioPtr) {
+    atomic_store_explicit(&diarioPtr->encerrar, 1, memory_order_release);
+    pthread_join(diarioPtr->escritor, NULL);
+    close(diarioPtr->descritor);
+    int quantidadeAneis = atomic_load_explicit(&diarioPtr->quantidadeAneis, memory_order_relaxed);
+    for (int a = 0; a < quantidadeAneis; a++) {
+        diarioPtr->registradosFechados += atomic_load_explicit(&diarioPtr->aneis[a]->escrita, memory_order_relaxed);
+        diarioPtr->descartadosFechados += atomic_load_explicit(&diarioPtr->aneis[a]->descartados,
+                                                               memory_order_relaxed);
+        free(diarioPtr->aneis[a]);
+        diarioPtr->aneis[a] = NULL;
+    }
+    atomic_store_explicit(&diarioPtr->quantidadeAneis, 0, memory_order_relaxed);
+    pthread_mutex_destroy(&diarioPtr->trava);
+    free(diarioPtr->bloco);
+    diarioPtr->bloco = NULL;
+    diarioPtr->descritor = -1;
+}
+
+// ═══════════════════════════════════════════════════════════════════════════════
+//                       PAINEL DE ESTATÍSTICAS (MEMÓRIA COMPARTILHADA)
+// ═══════════════════════════════════════════════════════════════════════════════
+
+static const char MAGICO_PAINEL[8] = {'T', 'E', 'T', 'R', 'I', 'S', 'P', 'N'};
+
+/// Parte do slot copiada por escritores e leitores (tudo depois da sequência)
+#define INICIO_DADOS_PAINEL offsetof(EstatisticasPublicadas, sessao)
+#define TAMANHO_DADOS_PAINEL (sizeof(EstatisticasPublicadas) - INICIO_DADOS_PAINEL)
+
+/**
+ * @brief Cria (ou recria) a região compartilhada e a mapeia para publicar
+ * @param painelPtr Painel a inicializar
+ * @param nome Nome POSIX da região, começando com '/'
+ * @param capacidade Sessões que podem publicar ao mesmo tempo
+ * @return 1 em caso de sucesso, 0 em caso de falha (mensagem em stderr)
+ *
+ * Uma região deixada por um processo anterior com o mesmo nome é zerada e
+ * reaproveitada. O marcador é gravado por último, então um monitor que
+ * abre o painel durante a criação o recusa em vez de ler lixo.
+ */
+int criarPainelEstatisticas(PainelEstatisticas* painelPtr, const char* nome, int capacidade) {
+    memset(painelPtr, 0, sizeof(*painelPtr));
+    painelPtr->descritor = -1;
+    if (capacidade < 1 || nome[0] != '/' || strlen(nome) >= TAMANHO_NOME_PAINEL) {
+        fprintf(stderr, "Painel invalido: %s (capacidade %d)\n", nome, capacidade);
+        return 0;
+    }
+    size_t tamanho = sizeof(CabecalhoPainel) + sizeof(EstatisticasPublicadas) * (size_t)capacidade;
+    int descritor = shm_open(nome, O_CREAT | O_RDWR | O_CLOEXEC, 0644);
+    void* regiao = MAP_FAILED;
+    if (descritor >= 0 && ftruncate(descritor, (off_t)tamanho) == 0) {
+        regiao = mmap(NULL, tamanho, PROT_READ | PROT_WRITE, MAP_SHARED, descritor, 0);
+    }
+    uint8_t* ocupados = regiao != MAP_FAILED ? calloc((size_t)capacidade, 1) : NULL;
+    if (ocupados == NULL) {
+        fprintf(stderr, "Nao foi possivel criar o painel %s: %s\n", nome, strerror(errno));
+        if (regiao != MAP_FAILED) {
+            munmap(regiao, tamanho);
+        }
+        if (descritor >= 0) {
+            close(descritor);
+            shm_unlink(nome);
+        }
+        return 0;
+    }
+
+    memset(regiao, 0, tamanho);
+    CabecalhoPainel* cabecalhoPtr = regiao;
+    cabecalhoPtr->versao = VERSAO_PAINEL;
+    cabecalhoPtr->tamanhoSlot = sizeof(EstatisticasPublicadas);
+    cabecalhoPtr->capacidade = (uint32_t)capacidade;
+    cabecalhoPtr->processo = (int32_t)getpid();
+    cabecalhoPtr->criadoNs = instanteDiarioNs(CLOCK_REALTIME);
+    atomic_thread_fence(memory_order_release);
+    memcpy(cabecalhoPtr->magico, MAGICO_PAINEL, sizeof(MAGICO_PAINEL));
+
+    snprintf(painelPtr->nome, sizeof(painelPtr->nome), "%s", nome);
+    painelPtr->descritor = descritor;
+    painelPtr->gravavel = 1;
+    painelPtr->tamanho = tamanho;
+    painelPtr->cabecalho = cabecalhoPtr;
+    painelPtr->slots = (EstatisticasPublicadas*)(cabecalhoPtr + 1);
+    painelPtr->ocupados = ocupados;
+    pthread_mutex_init(&painelPtr->trava, NULL);
+    return 1;
+}
+
+/**
+ * @brief Mapeia só para leitura um painel criado por outro processo
+ * @param painelPtr Painel a inicializar
+ * @param nome Nome POSIX da região
+ * @return 1 em caso de sucesso, 0 se o painel não existe ou não é reconhecido
+ */
+int abrirPainelEstatisticas(PainelEstatisticas* painelPtr, const char* nome) {
+    memset(painelPtr, 0, sizeof(*painelPtr));
+    painelPtr->descritor = -1;
+    if (strlen(nome) >= TAMANHO_NOME_PAINEL) {
+        fprintf(stderr, "Nome de painel longo demais: %s\n", nome);
+        return 0;
+    }
+    int descritor = shm_open(nome, O_RDONLY | O_CLOEXEC, 0);
+    struct stat informacoes;
+    if (descritor < 0 || fstat(descritor, &informacoes) != 0) {
+        fprintf(stderr, "Nao foi possivel abrir o painel %s: %s\n", nome, strerror(errno));
+        if (descritor >= 0) {
+            close(descritor);
+        }
+        return 0;
+    }
+    size_t tamanho = (size_t)informacoes.st_size;
+    void* regiao = tamanho >= sizeof(CabecalhoPainel)
+                   ? mmap(NULL, tamanho, PROT_READ, MAP_SHARED, descritor, 0) : MAP_FAILED;
+    const CabecalhoPainel* cabecalhoPtr = regiao;
+    int valido = regiao != MAP_FAILED && memcmp(cabecalhoPtr->magico, MAGICO_PAINEL, sizeof(MAGICO_PAINEL)) == 0;
+    atomic_thread_fence(memory_order_acquire);
+    valido = valido && cabecalhoPtr->versao == VERSAO_PAINEL &&
+             cabecalhoPtr->tamanhoSlot == sizeof(EstatisticasPublicadas) &&
+             sizeof(CabecalhoPainel) + sizeof(EstatisticasPublicadas) * (size_t)cabecalhoPtr->capacidade <= tamanho;
+    if (!valido) {
+        fprintf(stderr, "Painel %s nao reconhecido (ainda sendo criado ou de outra versao)\n", nome);
+        if (regiao != MAP_FAILED) {
+            munmap(regiao, tamanho);
+        }
+        close(descritor);
+        return 0;
+    }
+
+    snprintf(painelPtr->nome, sizeof(painelPtr->nome), "%s", nome);
+    painelPtr->descritor = descritor;
+    painelPtr->tamanho = tamanho;
+    painelPtr->cabecalho = regiao;
+    painelPtr->slots = (EstatisticasPublicadas*)(painelPtr->cabecalho + 1);
+    return 1;
+}
+
+/**
+ * @brief Desfaz o mapeamento; quem criou o painel também remove o nome
+ * @param painelPtr Painel criado ou aberto (sessões publicando já retiradas)
+ */
+void fecharPainelEstatisticas(PainelEstatisticas* painelPtr) {
+    if (painelPtr->cabecalho != NULL) {
+        munmap(painelPtr->cabecalho, painelPtr->tamanho);
+    }
+    if (painelPtr->descritor >= 0) {
+        close(painelPtr->descritor);
+    }
+    if (painelPtr->gravavel) {
+        shm_unlink(painelPtr->nome);
+        free(painelPtr->ocupados);
+        pthread_mutex_destroy(&painelPtr->trava);
+    }
+    painelPtr->cabecalho = NULL;
+    painelPtr->slots = NULL;
+    painelPtr->ocupados = NULL;
+    painelPtr->descritor = -1;
+}
+
+/// Publica os valores no slot: sequência ímpar durante a cópia, par de novo no fim
+static void escreverSlotPainel(EstatisticasPublicadas* slotPtr, const EstatisticasPublicadas* valoresPtr) {
+    uint32_t sequencia = atomic_load_explicit(&slotPtr->sequencia, memory_order_relaxed);
+    atomic_store_explicit(&slotPtr->sequencia, sequencia + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    memcpy((char*)slotPtr + INICIO_DADOS_PAINEL, (const char*)valoresPtr + INICIO_DADOS_PAINEL,
+           TAMANHO_DADOS_PAINEL);
+    atomic_store_explicit(&slotPtr->sequencia, sequencia + 2, memory_order_release);
+}
+
+/// Contadores atuais da sessão (sem opcoes), sem sincronizar o Sistema Expert
+static void montarEstatisticasSessao(const SessaoJogo* sessaoPtr, EstatisticasPublicadas* valoresPtr) {
+    const SistemaExpert* sistemaPtr = &sessaoPtr->sistema;
+    valoresPtr->sessao = sessaoPtr->identificador;
+    valoresPtr->pontuacaoTotal = sistemaPtr->pontuacaoTotal;
+    valoresPtr->recordePessoal = sistemaPtr->pontuacaoTotal > sistemaPtr->recordePessoal
+                                 ? sistemaPtr->pontuacaoTotal : sistemaPtr->recordePessoal;
+    valoresPtr->nivelAtual = sistemaPtr->nivelAtual;
+    valoresPtr->comboAtual = sistemaPtr->comboAtual;
+    valoresPtr->melhorCombo = sistemaPtr->melhorCombo;
+    valoresPtr->totalCombos = sistemaPtr->totalCombos;
+    valoresPtr->totalJogadas = sistemaPtr->totalJogadas;
+    valoresPtr->jogadasDaPilha = sistemaPtr->jogadasDaPilha;
+    uint32_t conquistas = 0;
+    for (int i = 0; i < MAX_CONQUISTAS / 64; i++) {
+        conquistas += (uint32_t)__builtin_popcountll(sessaoPtr->conquistas.desbloqueadas[i]);
+    }
+    valoresPtr->conquistas = conquistas;
+    valoresPtr->atualizadoNs = instanteDiarioNs(CLOCK_MONOTONIC);
+    valoresPtr->multiplicadorAtual = sistemaPtr->multiplicadorAtual;
+}
+
+/**
+ * @brief Reserva um slot para a sessão e publica os contadores iniciais
+ * @param painelPtr Painel criado por este processo
+ * @param sessaoPtr Sessão que passa a publicar após cada opção
+ * @return 1 em caso de sucesso, 0 se o painel está cheio
+ */
+int publicarSessaoPainel(PainelEstatisticas* painelPtr, SessaoJogo* sessaoPtr) {
+    pthread_mutex_lock(&painelPtr->trava);
+    uint32_t capacidade = painelPtr->cabecalho->capacidade;
+    uint32_t slot = painelPtr->proximoLivre;
+    for (uint32_t i = 0; i < capacidade && painelPtr->ocupados[slot]; i++) {
+        slot = slot + 1 < capacidade ? slot + 1 : 0;
+    }
+    if (painelPtr->ocupados[slot]) {
+        pthread_mutex_unlock(&painelPtr->trava);
+        return 0;
+    }
+    painelPtr->ocupados[slot] = 1;
+    painelPtr->proximoLivre = slot + 1 < capacidade ? slot + 1 : 0;
+
+    EstatisticasPublicadas valores;
+    montarEstatisticasSessao(sessaoPtr, &valores);
+    valores.opcoes = 0;
+    escreverSlotPainel(&painelPtr->slots[slot], &valores);
+    sessaoPtr->painel = painelPtr;
+    sessaoPtr->slotPainel = (int32_t)slot;
+    if (slot >= atomic_load_explicit(&painelPtr->cabecalho->slotsUsados, memory_order_relaxed)) {
+        atomic_store_explicit(&painelPtr->cabecalho->slotsUsados, slot + 1, memory_order_release);
+    }
+    pthread_mutex_unlock(&painelPtr->trava);
+    return 1;
+}
+
+/**
+ * @brief Publica os contadores da sessão (após cada opção, em retomarSessao())
+ * @param sessaoPtr Sessão com slot no painel
+ *
+ * Só cópias para a linha do slot e duas escritas da sequência: nenhuma
+ * trava, chamada de sistema ou espera por leitores.
+ */
+void publicarEstatisticasSessao(SessaoJogo* sessaoPtr) {
+    EstatisticasPublicadas* slotPtr = &sessaoPtr->painel->slots[sessaoPtr->slotPainel];
+    EstatisticasPublicadas valores;
+    montarEstatisticasSessao(sessaoPtr, &valores);
+    valores.opcoes = slotPtr->opcoes + 1;
+    escreverSlotPainel(slotPtr, &valores);
+}
+
+/**
+ * @brief Libera o slot da sessão (fecharSessao() chama)
+ * @param sessaoPtr Sessão que deixa de publicar
+ */
+void retirarSessaoPainel(SessaoJogo* sessaoPtr) {
+    PainelEstatisticas* painelPtr = sessaoPtr->painel;
+    if (painelPtr == NULL) {
+        return;
+    }
+    EstatisticasPublicadas vazio;
+    memset(&vazio, 0, sizeof(vazio));
+    pthread_mutex_lock(&painelPtr->trava);
+    escreverSlotPainel(&painelPtr->slots[sessaoPtr->slotPainel], &vazio);
+    painelPtr->ocupados[sessaoPtr->slotPainel] = 0;
+    pthread_mutex_unlock(&painelPtr->trava);
+    sessaoPtr->painel = NULL;
+}
+
+/**
+ * @brief Copia um slot sem interferir em quem publica
+ * @param painelPtr Painel aberto (ou criado)
+ * @param slot Índice do slot, abaixo de cabecalho->slotsUsados
+ * @param copiaPtr Recebe os contadores
+ * @return 1 se o slot tem uma sessão, 0 se está livre, -1 se nenhuma cópia
+ *         consistente saiu em TENTATIVAS_LEITURA_PAINEL tentativas (quem
+ *         publicava parou no meio, por exemplo)
+ */
+int lerEstatisticasPainel(const PainelEstatisticas* painelPtr, int slot, EstatisticasPublicadas* copiaPtr) {
+    const EstatisticasPublicadas* slotPtr = &painelPtr->slots[slot];
+    for (int tentativa = 0; tentativa < TENTATIVAS_LEITURA_PAINEL; tentativa++) {
+        uint32_t sequencia = atomic_load_explicit(&slotPtr->sequencia, memory_order_acquire);
+        if (sequencia & 1) {
+            sched_yield();
+            continue;
+        }
+        memcpy((char*)copiaPtr + INICIO_DADOS_PAINEL, (const char*)slotPtr + INICIO_DADOS_PAINEL,
+               TAMANHO_DADOS_PAINEL);
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&slotPtr->sequencia, memory_order_relaxed) == sequencia) {
+            atomic_store_explicit(&copiaPtr->sequencia, sequencia, memory_order_relaxed);
+            return copiaPtr->sessao != 0;
+        }
+    }
+    return -1;
+}
+
+// ═══════════════════════════════════════════════════════════════════════════════
+//                     SESSÕES INTERATIVAS (MÁQUINA DE ESTADOS)
+// ═══════════════════════════════════════════════════════════════════════════════
+
+/**
+ * @brief Prepara uma sessão nova, suspensa antes das boas-vindas
+ * @param sessaoPtr Sessão a inicializar
+ * @param identificador Número da sessão
+ * @param semente Semente das peças da sessão
+ * @param historicoPtr Histórico de desfazer/refazer (NULL = desativado)
+ */
+void iniciarSessao(SessaoJogo* sessaoPtr, int identificador, uint64_t semente, HistoricoAcoes* historicoPtr) {
+    memset(sessaoPtr, 0, sizeof(*sessaoPtr));
+    inicializarFila(&sessaoPtr->fila);
+    inicializarPilha(&sessaoPtr->pilha);
+    inicializarSistemaExpert(&sessaoPtr->sistema);
+    limparTabuleiro(&sessaoPtr->tabuleiro);
+    inicializarGeradorPecas(&sessaoPtr->gerador, semente);
+    reabastecerFila(&sessaoPtr->fila, &sessaoPtr->gerador);
+    sessaoPtr->motorConquistas = obterMotorConquistasPadrao();
+    inicializarConquistas(&sessaoPtr->conquistas, sessaoPtr->motorConquistas);
+    sessaoPtr->historico = historicoPtr;
+    if (historicoPtr != NULL) {
+        inicializarHistorico(historicoPtr);
+    }
+    sessaoPtr->identificador = identificador;
+    sessaoPtr->sementeInicial = semente;
+    sessaoPtr->encaixeAutomatico = encaixeAutomaticoMenu != 0;
+    sessaoPtr->estado = SESSAO_INICIO;
+}
+
+/**
+ * @brief Ajusta a prévia e a reserva da sessão (regras do torneio)
+ * @param sessaoPtr Sessão a ajustar
+ * @param capacidadeFila Peças na fila (prévia)
+ * @param capacidadePilha Peças na reserva
+ * @return 1 em caso de sucesso, 0 se alguma capacidade foi recusada
+ *
+ * A fila é completada até a nova capacidade. Essa geração não entra no
+ * histórico, que recomeça: chame antes da primeira jogada.
+ */
+int configurarCapacidadesSessao(SessaoJogo* sessaoPtr, int capacidadeFila, int capacidadePilha) {
+    if (!configurarCapacidadeFila(&sessaoPtr->fila, capacidadeFila) ||
+        !configurarCapacidadePilha(&sessaoPtr->pilha, capacidadePilha)) {
+        return 0;
+    }
+    reabastecerFila(&sessaoPtr->fila, &sessaoPtr->gerador);
+    if (sessaoPtr->historico != NULL) {
+        inicializarHistorico(sessaoPtr->historico);
+    }
+    return 1;
+}
+
+/**
+ * @brief Abre uma sessão com memória dos pools
+ * @param poolSessoes Pool de objetos do tamanho de SessaoJogo
+ * @param poolHistoricos Pool de objetos do tamanho de HistoricoAcoes (NULL = sem desfazer)
+ * @param identificador Número da sessão
+ * @param semente Semente das peças da sessão
+ * @return Sessão pronta para retomarSessao(), ou NULL se faltou memória
+ */
+SessaoJogo* abrirSessao(PoolObjetos* poolSessoes, PoolObjetos* poolHistoricos, int identificador, uint64_t semente) {
+    SessaoJogo* sessaoPtr = alocarDoPool(poolSessoes);
+    if (sessaoPtr == NULL) {
+        return NULL;
+    }
+    HistoricoAcoes* historicoPtr = NULL;
+    if (poolHistoricos != NULL && (historicoPtr = alocarDoPool(poolHistoricos)) == NULL) {
+        devolverAoPool(poolSessoes, sessaoPtr);
+        return NULL;
+    }
+    iniciarSessao(sessaoPtr, identificador, semente, historicoPtr);
+    return sessaoPtr;
+}
+
+/**
+ * @brief Devolve aos pools a sessão e o seu histórico
+ * @param poolSessoes Pool de onde a sessão veio
+ * @param poolHistoricos Pool de onde o histórico veio (NULL se a sessão não tinha)
+ * @param sessaoPtr Sessão encerrada, sem entrada pendente no servidor
+ */
+void fecharSessao(PoolObjetos* poolSessoes, PoolObjetos* poolHistoricos, SessaoJogo* sessaoPtr) {
+    retirarSessaoPainel(sessaoPtr);
+    liberarFila(&sessaoPtr->fila);
+    liberarPilha(&sessaoPtr->pilha);
+    if (poolHistoricos != NULL) {
+        devolverAoPool(poolHistoricos, sessaoPtr->historico);
+    }
+    devolverAoPool(poolSessoes, sessaoPtr);
+}
+
+/**
+ * @brief Envia ao diário e ao WAL uma ação que mudou a sessão
+ * @param sessaoPtr Sessão do jogador
+ * @param opcao Opção do menu que executou a ação
+ * @param acao AcaoHistorico
+ * @param sentido 1 = feita ou refeita, -1 = desfeita
+ * @param pecaPtr Peça envolvida (NULL = nenhuma)
+ */
+static void registrarEventoSessao(SessaoJogo* sessaoPtr, int opcao, int acao, int sentido, const Peca* pecaPtr) {
+    if (walSessoes != NULL) {
+        RegistroWal registro;
+        memset(&registro, 0, sizeof(registro));
+        registro.sessao = sessaoPtr->identificador;
+        registro.tipo = WAL_OPCAO;
+        registro.opcao = (uint8_t)opcao;
+        sessaoPtr->lsnWal = registrarWal(walSessoes, &registro);
+    }
+    if (diarioJogadas == NULL) {
+        return;
+    }
+    EventoDiario evento;
+    memset(&evento, 0, sizeof(evento));
+    evento.instanteNs = instanteDiarioNs(CLOCK_REALTIME);
+    evento.sessao = sessaoPtr->identificador;
+    evento.sequencia = sessaoPtr->eventosDiario++;
+    evento.pontuacaoTotal = sessaoPtr->sistema.pontuacaoTotal;
+    evento.idPeca = pecaPtr != NULL ? pecaPtr->id : -1;
+    evento.nivel = (uint16_t)sessaoPtr->sistema.nivelAtual;
+    evento.acao = (uint8_t)acao;
+    evento.sentido = (int8_t)sentido;
+    evento.tipoPeca = pecaPtr != NULL ? pecaPtr->tipo : '\0';
+    registrarEventoDiario(diarioJogadas, &evento);
+}
+
+/**
+ * @brief Executa uma opção do menu na sessão
+ * @param sessaoPtr Sessão do jogador
+ * @param opcao Opção digitada (-1 se a entrada não era um número)
+ * @return 0 se a opção encerra a sessão, 1 caso contrário
+ */
+static int executarOpcaoSessao(SessaoJogo* sessaoPtr, int opcao) {
+    FilaCircular* filaPtr = &sessaoPtr->fila;
+    PilhaReserva* pilhaPtr = &sessaoPtr->pilha;
+    SistemaExpert* sistemaPtr = &sessaoPtr->sistema;
+    // Sem encaixe automático o tabuleiro só serve às recomendações do relatório
+    Tabuleiro* tabPtr = sessaoPtr->encaixeAutomatico ? &sessaoPtr->tabuleiro : NULL;
+    HistoricoAcoes* historicoPtr = sessaoPtr->historico;
+
+    switch (opcao) {
+        case 1: {
+            if (!filaVazia(filaPtr)) {
+                Peca peca = jogarPecaComHistorico(historicoPtr, 0, filaPtr, pilhaPtr, sistemaPtr, tabPtr);
+                registrarEventoSessao(sessaoPtr, opcao, ACAO_HISTORICO_JOGAR_FILA, 1, &peca);
+                imprimirJogo("Peca %c (ID: %d) jogada da fila!\n", peca.tipo, peca.id);
+            } else {
+                imprimirJogo("Fila vazia! Gere novas pecas primeiro.\n");
+            }
+            break;
+        }
+        case 2: {
+            if (!pilhaVazia(pilhaPtr)) {
+                Peca peca = jogarPecaComHistorico(historicoPtr, 1, filaPtr, pilhaPtr, sistemaPtr, tabPtr);
+                registrarEventoSessao(sessaoPtr, opcao, ACAO_HISTORICO_JOGAR_PILHA, 1, &peca);
+                imprimirJogo("Peca %c (ID: %d) jogada da pilha de reserva!\n", peca.tipo, peca.id);
+            } else {
+                imprimirJogo("Pilha de reserva vazia!\n");
+            }
+            break;
+        }
+        case 3: {
+            int reservadasAntes = pilhaPtr->quantidadeReservada;
+            Peca frente = !filaVazia(filaPtr) ? *espiarFila(filaPtr, 0) : (Peca){0};
+            transferirPecaComHistorico(historicoPtr, filaPtr, pilhaPtr);
+            if (pilhaPtr->quantidadeReservada != reservadasAntes) {
+                registrarEventoSessao(sessaoPtr, opcao, ACAO_HISTORICO_TRANSFERIR, 1, &frente);
+            }
+            break;
+        }
+        case 4: {
+            gerarPecasComHistorico(historicoPtr, filaPtr, &sessaoPtr->gerador);
+            registrarEventoSessao(sessaoPtr, opcao, ACAO_HISTORICO_GERAR, 1, NULL);
+            imprimirJogo("Novas pecas geradas na fila!\n");
+            break;
+        }
+        case 5: {
+            exibirEstadoCompleto(filaPtr, pilhaPtr, sistemaPtr);
+            break;
+        }
+        case 6: {
+            exibirEstatisticasExpert(sistemaPtr);
+            break;
+        }
+        case 7: {
+            if (otimizarSistemaComHistorico(historicoPtr, sistemaPtr)) {
+                registrarEventoSessao(sessaoPtr, opcao, ACAO_HISTORICO_OTIMIZAR, 1, NULL);
+                imprimirJogo("Sistema Expert otimizado com sucesso!\n");
+            } else {
+                imprimirJogo("Sistema Expert ja esta otimizado.\n");
+            }
+            break;
+        }
+        case 8: {
+            gerarRelatorioExpert(sistemaPtr, &sessaoPtr->tabuleiro, filaPtr, pilhaPtr);
+            break;
+        }
+        case 9: {
+            int acao = desfazerAcao(historicoPtr, filaPtr, pilhaPtr, sistemaPtr, &sessaoPtr->conquistas, tabPtr);
+            if (acao < 0) {
+                imprimirJogo("Nada para desfazer.\n");
+            } else {
+                registrarEventoSessao(sessaoPtr, opcao, acao, -1, NULL);
+                imprimirJogo("Acao desfeita: %s\n", NOMES_ACOES_HISTORICO[acao]);
+            }
+            break;
+        }
+        case 10: {
+            int acao = refazerAcao(historicoPtr, filaPtr, pilhaPtr, sistemaPtr, &sessaoPtr->conquistas, tabPtr);
+            if (acao < 0) {
+                imprimirJogo("Nada para refazer.\n");
+            } else {
+                registrarEventoSessao(sessaoPtr, opcao, acao, 1, NULL);
+                imprimirJogo("Acao refeita: %s\n", NOMES_ACOES_HISTORICO[acao]);
+            }
+            break;
+        }
+        case 0: {
+            imprimirJogo("\n+==============================================================+\n");
+            imprimirJogo("|                    OBRIGADO POR JOGAR!                      |\n");
+            imprimirJogo("|                                                              |\n");
+            imprimirJogo("|  Pontuacao Final: %8d                               |\n", sistemaPtr->pontuacaoTotal);
+            imprimirJogo("|  Nivel Alcancado: %3d                                    |\n", sistemaPtr->nivelAtual);
+            imprimirJogo("|  Melhor Combo: %3d                                       |\n", sistemaPtr->melhorCombo);
+            imprimirJogo("+==============================================================+\n");
+            return 0;
+        }
+        default: {
+            imprimirJogo("Opcao invalida! Tente novamente.\n");
+            break;
+        }
+    }
+    return 1;
+}
+
+/**
+ * @brief Avalia as conquistas após a opção e exibe os desbloqueios
+ * @param sessaoPtr Sessão do jogador
+ *
+ * Os desbloqueios ficam no delta da última ação aplicada, para que
+ * desfazê-la também os desfaça.
+ */
+static void exibirConquistasSessao(SessaoJogo* sessaoPtr) {
+    const MotorConquistas* motorPtr = sessaoPtr->motorConquistas;
+    uint64_t anteriores[MAX_CONQUISTAS / 64];
+    memcpy(anteriores, sessaoPtr->conquistas.desbloqueadas, sizeof(anteriores));
+    if (avaliarConquistas(motorPtr, &sessaoPtr->conquistas, &sessaoPtr->sistema) > 0) {
+        for (int i = 0; i < MAX_CONQUISTAS / 64; i++) {
+            anteriores[i] ^= sessaoPtr->conquistas.desbloqueadas[i];
+        }
+        registrarConquistasHistorico(sessaoPtr->historico, anteriores);
+    }
+    int indice;
+    while ((indice = proximaConquistaDesbloqueada(&sessaoPtr->conquistas)) >= 0) {
+        if (!saidaSilenciosa) {
+            imprimirJogo("*** CONQUISTA DESBLOQUEADA: %s (%s)\n",
+                         motorPtr->regras[indice].nome, motorPtr->regras[indice].descricao);
+        }
+    }
+}
+
+/**
+ * @brief Retoma a sessão com a linha digitada pelo jogador
+ * @param sessaoPtr Sessão suspensa
+ * @param entrada Linha recebida (ignorada em SESSAO_INICIO e SESSAO_AGUARDA_ENTER)
+ * @return Ponto em que a sessão suspendeu de novo
+ *
+ * É o antigo laço do menu de main() partido nos pontos em que ele
+ * bloqueava (scanf da opção e pausarExecucao): cada chamada executa até
+ * o próximo desses pontos e retorna, sem prender a thread ao jogador.
+ */
+EstadoSessao retomarSessao(SessaoJogo* sessaoPtr, const char* entrada) {
+    switch (sessaoPtr->estado) {
+        case SESSAO_INICIO: {
+            imprimirJogo("+==============================================================+\n");
+            imprimirJogo("|              BEM-VINDO AO TETRIS EXPERT SYSTEM               |\n");
+            imprimirJogo("|                                                              |\n");
+            imprimirJogo("|  Sistema inteligente de analise de jogabilidade Tetris      |\n");
+            imprimirJogo("|  com estatisticas avancadas e otimizacao automatica         |\n");
+            imprimirJogo("+==============================================================+\n");
+            break;
+        }
+        case SESSAO_AGUARDA_OPCAO: {
+            char* fim;
+            long opcao = strtol(entrada != NULL ? entrada : "", &fim, 10);
+            if (entrada == NULL || fim == entrada) {
+                opcao = -1;
+            }
+            // Versão ímpar durante a opção: gravarCheckpointWal() não copia a sessão pela metade
+            uint32_t versao = atomic_load_explicit(&sessaoPtr->versaoEstado, memory_order_relaxed);
+            atomic_store_explicit(&sessaoPtr->versaoEstado, versao + 1, memory_order_relaxed);
+            atomic_thread_fence(memory_order_release);
+            int continua = executarOpcaoSessao(sessaoPtr, (int)opcao);
+            if (continua) {
+                exibirConquistasSessao(sessaoPtr);
+            }
+            atomic_store_explicit(&sessaoPtr->versaoEstado, versao + 2, memory_order_release);
+            if (sessaoPtr->painel != NULL) {
+                publicarEstatisticasSessao(sessaoPtr);
+            }
+            if (walSessoes != NULL && !aguardarWal(walSessoes, sessaoPtr->lsnWal)) {
+                imprimirJogo("AVISO: a ultima acao nao foi gravada no WAL.\n");
+            }
+            if (!continua) {
+                sessaoPtr->estado = SESSAO_ENCERRADA;
+                return SESSAO_ENCERRADA;
+            }
+            imprimirJogo("\nPressione Enter para continuar...");
+            sessaoPtr->estado = SESSAO_AGUARDA_ENTER;
+            return SESSAO_AGUARDA_ENTER;
+        }
+        case SESSAO_AGUARDA_ENTER:
+            break;
+        default:
+            return SESSAO_ENCERRADA;
+    }
+    exibirMenu();
+    sessaoPtr->estado = SESSAO_AGUARDA_OPCAO;
+    return SESSAO_AGUARDA_OPCAO;
+}
+
+/**
+ * @brief Laço de uma thread trabalhadora: retoma sessões com entradas pendentes
+ */
+static void* executarTrabalhadorSessoes(void* argumento) {
+    ServidorSessoes* servidorPtr = argumento;
+    char* buffer = malloc(TAMANHO_SAIDA_TRABALHADOR);
+    FILE* saida = buffer != NULL ? fmemopen(buffer, TAMANHO_SAIDA_TRABALHADOR, "w") : NULL;
+    saidaJogo = saida;
+
+    for (;;) {
+        pthread_mutex_lock(&servidorPtr->trava);
+        while (servidorPtr->quantidade == 0 && !servidorPtr->encerrando) {
+            pthread_cond_wait(&servidorPtr->temEvento, &servidorPtr->trava);
+        }
+        if (servidorPtr->quantidade == 0) {
+            pthread_mutex_unlock(&servidorPtr->trava);
+            break;
+        }
+        EventoSessao evento = servidorPtr->eventos[servidorPtr->inicio];
+        servidorPtr->inicio = (servidorPtr->inicio + 1) % servidorPtr->capacidade;
+        servidorPtr->quantidade--;
+        pthread_mutex_unlock(&servidorPtr->trava);
+
+        if (saida != NULL) {
+            rewind(saida);
+        }
+        EstadoSessao estado = retomarSessao(evento.sessao, evento.entrada);
+        size_t tamanho = 0;
+        if (saida != NULL) {
+            fflush(saida);
+            tamanho = (size_t)ftell(saida);
+        }
+
+        // Libera a sessão antes da entrega: a resposta pode enviar a próxima entrada
+        pthread_mutex_lock(&servidorPtr->trava);
+        evento.sessao->ocupada = 0;
+        pthread_mutex_unlock(&servidorPtr->trava);
+        if (servidorPtr->entregarSaida != NULL) {
+            servidorPtr->entregarSaida(servidorPtr->contexto, evento.sessao, estado,
+                                       buffer != NULL ? buffer : "", tamanho);
+        }
+    }
+
+    saidaJogo = NULL;
+    if (saida != NULL) {
+        fclose(saida);
+    }
+    free(buffer);
+    return NULL;
+}
+
+/**
+ * @brief Cria as threads trabalhadoras do servidor de sessões
+ * @param servidorPtr Servidor a inicializar
+ * @param numeroThreads Threads trabalhadoras
+ * @param capacidadeEventos Entradas pendentes simultâneas (basta uma por sessão)
+ * @param entregarSaida Recebe a saída de cada passo (pode ser NULL)
+ * @param contexto Repassado a entregarSaida
+ * @return 1 em caso de sucesso, 0 se faltou memória ou uma thread não pôde ser criada
+ */
+int iniciarServidorSessoes(ServidorSessoes* servidorPtr, int numeroThreads, int capacidadeEventos,
+                           EntregaSaidaSessao entregarSaida, void* contexto) {
+    memset(servidorPtr, 0, sizeof(*servidorPtr));
+    servidorPtr->eventos = malloc(sizeof(EventoSessao) * (size_t)capacidadeEventos);
+    servidorPtr->threads = malloc(sizeof(pthread_t) * (size_t)numeroThreads);
+    if (servidorPtr->eventos == NULL || servidorPtr->threads == NULL) {
+        free(servidorPtr->eventos);
+        free(servidorPtr->threads);
+        return 0;
+    }
+    servidorPtr->capacidade = capacidadeEventos;
+    servidorPtr->entregarSaida = entregarSaida;
+    servidorPtr->contexto = contexto;
+    pthread_mutex_init(&servidorPtr->trava, NULL);
+    pthread_cond_init(&servidorPtr->temEvento, NULL);
+
+    for (int i = 0; i < numeroThreads; i++) {
+        if (pthread_create(&servidorPtr->threads[i], NULL, executarTrabalhadorSessoes, servidorPtr) != 0) {
+            encerrarServidorSessoes(servidorPtr);
+            return 0;
+        }
+        servidorPtr->numeroThreads++;
+    }
+    return 1;
+}
+
+/**
+ * @brief Entrega ao servidor a próxima linha digitada em uma sessão
+ * @param servidorPtr Servidor de sessões
+ * @param sessaoPtr Sessão do jogador
+ * @param entrada Linha digitada (truncada em TAMANHO_ENTRADA_SESSAO - 1 caracteres)
+ * @return 1 se a entrada foi aceita; 0 se a sessão ainda processa a anterior,
+ *         já terminou ou a fila de eventos está cheia
+ */
+int enviarEntradaSessao(ServidorSessoes* servidorPtr, SessaoJogo* sessaoPtr, const char* entrada) {
+    pthread_mutex_lock(&servidorPtr->trava);
+    int aceita = !sessaoPtr->ocupada && sessaoPtr->estado != SESSAO_ENCERRADA &&
+                 servidorPtr->quantidade < servidorPtr->capacidade && !servidorPtr->encerrando;
+    if (aceita) {
+        int posicao = (servidorPtr->inicio + servidorPtr->quantidade) % servidorPtr->capacidade;
+        EventoSessao* eventoPtr = &servidorPtr->eventos[posicao];
+        eventoPtr->sessao = sessaoPtr;
+        snprintf(eventoPtr->entrada, sizeof(eventoPtr->entrada), "%s", entrada != NULL ? entrada : "");
+        servidorPtr->quantidade++;
+        sessaoPtr->ocupada = 1;
+        pthread_cond_signal(&servidorPtr->temEvento);
+    }
+    pthread_mutex_unlock(&servidorPtr->trava);
+    return aceita;
+}
+
+/**
+ * @brief Processa as entradas pendentes, encerra as threads e libera o servidor
+ * @param servidorPtr Servidor de sessões
+ */
+void encerrarServidorSessoes(ServidorSessoes* servidorPtr) {
+    pthread_mutex_lock(&servidorPtr->trava);
+    servidorPtr->encerrando = 1;
+    pthread_cond_broadcast(&servidorPtr->temEvento);
+    pthread_mutex_unlock(&servidorPtr->trava);
+
+    for (int i = 0; i < servidorPtr->numeroThreads; i++) {
+        pthread_join(servidorPtr->threads[i], NULL);
+    }
+    pthread_cond_destroy(&servidorPtr->temEvento);
+    pthread_mutex_destroy(&servidorPtr->trava);
+    free(servidorPtr->threads);
+    free(servidorPtr->eventos);
+    servidorPtr->threads = NULL;
+    servidorPtr->eventos = NULL;
+    servidorPtr->numeroThreads = 0;
+}
+
+// ═══════════════════════════════════════════════════════════════════════════════
+//                       LOG DE ESCRITA ANTECIPADA (WAL) E CHECKPOINTS
+// ═══════════════════════════════════════════════════════════════════════════════
+
+#define VERSAO_CHECKPOINT_WAL 4
+
+/**
+ * @brief Cabeçalho do arquivo de checkpoint
+ */
+typedef struct {
+    char magica[8];                 ///< "TETRISCK"
+    uint32_t versao;
+    uint32_t primeiroSegmento;      ///< Primeiro segmento do WAL a reaplicar
+    uint64_t proximoLsn;            ///< LSN seguinte ao último anterior ao checkpoint
+    uint64_t tamanhoDados;
+    uint32_t sessoes;
+    uint32_t crcDados;              ///< CRC-32C das sessões
+    uint32_t crcCabecalho;          ///< CRC-32C dos campos acima
+    uint32_t reservado;
+} CabecalhoCheckpointWal;
+
+/**
+ * @brief Parte fixa de uma sessão no checkpoint
+ *
+ * Seguem: SistemaExpert, Tabuleiro, GeradorPecas, EstadoConquistas, as
+ * peças da fila (da frente para o fim), as da reserva (da base para o
+ * topo) e os deltas do histórico (do mais antigo para o mais novo).
+ */
+typedef struct {
+    int32_t identificador;
+    uint32_t eventosDiario;
+    uint64_t lsnWal;
+    uint64_t sementeInicial;
+    int32_t capacidadeFila;
+    int32_t quantidadeFila;
+    int32_t capacidadePilha;
+    int32_t quantidadePilha;
+    int32_t deltasAplicados;
+    int32_t deltasRegistrados;      ///< -1 = sessão sem histórico
+    int32_t encaixeAutomatico;
+    int32_t reservado;
+} SessaoCheckpointWal;
+
+/// Bytes acumulados antes de cada write() do checkpoint
+#define BLOCO_CHECKPOINT_WAL 65536
+
+/**
+ * @brief Buffer onde as sessões do checkpoint são copiadas
+ *
+ * Cresce conforme a necessidade; gravarCheckpointWal() o esvazia no
+ * arquivo a cada BLOCO_CHECKPOINT_WAL bytes, então ele não passa de um
+ * bloco mais uma sessão.
+ */
+typedef struct {
+    char* dados;
+    size_t tamanho;
+    size_t capacidade;
+    int semMemoria;
+} BufferCheckpointWal;
+
+/**
+ * @brief Leitura com verificação de limites do checkpoint
+ */
+typedef struct {
+    const char* dados;
+    size_t tamanho;
+    size_t posicao;
+    int erro;
+} LeituraCheckpointWal;
+
+static uint32_t tabelaCrc32c[256];
+static pthread_once_t tabelaCrc32cPronta = PTHREAD_ONCE_INIT;
+
+static void preencherTabelaCrc32c(void) {
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t crc = i;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0x82F63B78u & (0u - (crc & 1u)));
+        }
+        tabelaCrc32c[i] = crc;
+    }
+}
+
+/**
+ * @brief Estende um CRC-32C com mais bytes
+ * @param crc CRC dos bytes anteriores (0 para começar)
+ * @param dados Bytes seguintes
+ * @param tamanho Quantidade de bytes
+ * @return CRC de tudo, igual ao de calcularCrc32c() sobre os blocos concatenados
+ */
+uint32_t continuarCrc32c(uint32_t crc, const void* dados, size_t tamanho) {
+    pthread_once(&tabelaCrc32cPronta, preencherTabelaCrc32c);
+    const uint8_t* bytes = dados;
+    crc ^= 0xFFFFFFFFu;
+    for (size_t i = 0; i < tamanho; i++) {
+        crc = tabelaCrc32c[(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+/**
+ * @brief CRC-32C (Castagnoli) de um bloco de bytes
+ * @param dados Bytes a verificar
+ * @param tamanho Quantidade de bytes
+ * @return CRC do bloco
+ */
+uint32_t calcularCrc32c(const void* dados, size_t tamanho) {
+    return continuarCrc32c(0, dados, tamanho);
+}
+
+static uint32_t crcRegistroWal(const RegistroWal* registroPtr) {
+    return calcularCrc32c((const char*)registroPtr + sizeof(registroPtr->crc),
+                          sizeof(*registroPtr) - sizeof(registroPtr->crc));
+}
+
+static void nomeSegmentoWal(char* destino, size_t tamanho, const char* caminho, uint32_t segmento) {
+    snprintf(destino, tamanho, "%s.%06u", caminho, segmento);
+}
+
+/// fsync() do diretório do arquivo: torna duráveis criações e renomeações
+static void sincronizarDiretorioWal(const char* caminho) {
+    char diretorio[TAMANHO_CAMINHO_WAL];
+    snprintf(diretorio, sizeof(diretorio), "%s", caminho);
+    char* barra = strrchr(diretorio, '/');
+    if (barra == NULL) {
+        snprintf(diretorio, sizeof(diretorio), ".");
+    } else {
+        barra[barra == diretorio] = '\0';
+    }
+    int descritor = open(diretorio, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (descritor >= 0) {
+        fsync(descritor);
+        close(descritor);
+    }
+}
+
+/// write() até o fim, repetindo escritas parciais
+static int gravarTudoWal(int descritor, const void* dados, size_t tamanho) {
+    const char* bytes = dados;
+    while (tamanho > 0) {
+        ssize_t resultado = write(descritor, bytes, tamanho);
+        if (resultado < 0 && errno == EINTR) {
+            continue;
+        }
+        if (resultado <= 0) {
+            return 0;
+        }
+        bytes += resultado;
+        tamanho -= (size_t)resultado;
+    }
+    return 1;
+}
+
+static int abrirSegmentoWal(const char* caminho, uint32_t segmento) {
+    char nome[TAMANHO_CAMINHO_WAL + 16];
+    nomeSegmentoWal(nome, sizeof(nome), caminho, segmento);
+    int descritor = open(nome, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (descritor < 0) {
+        fprintf(stderr, "Nao foi possivel abrir o segmento %s: %s\n", nome, strerror(errno));
+        return -1;
+    }
+    sincronizarDiretorioWal(caminho);
+    return descritor;
+}
+
+/**
+ * @brief Grava e sincroniza o lote atual como líder do group commit
+ *
+ * Chamada com a trava tomada e sem outro líder; solta a trava durante o
+ * write() e o fdatasync(), para que novos registros formem o próximo lote.
+ */
+static void liderarCommitWal(WalSessoes* walPtr) {
+    RegistroWal* lote = walPtr->lote;
+    int quantidade = walPtr->quantidadeLote;
+    uint64_t ultimoLsn = walPtr->proximoLsn - 1;
+    walPtr->lote = walPtr->loteLider;
+    walPtr->loteLider = lote;
+    walPtr->quantidadeLote = 0;
+    walPtr->liderAtivo = 1;
+    pthread_mutex_unlock(&walPtr->trava);
+
+    int gravou = gravarTudoWal(walPtr->descritor, lote, sizeof(RegistroWal) * (size_t)quantidade) &&
+                 fdatasync(walPtr->descritor) == 0;
+    if (!gravou) {
+        fprintf(stderr, "Falha ao gravar o WAL: %s\n", strerror(errno));
+    }
+
+    pthread_mutex_lock(&walPtr->trava);
+    walPtr->liderAtivo = 0;
+    if (gravou) {
+        walPtr->lsnDuravel = ultimoLsn;
+    } else {
+        walPtr->falhou = 1;
+    }
+    walPtr->sincronizacoes++;
+    if (quantidade > walPtr->maiorGrupo) {
+        walPtr->maiorGrupo = quantidade;
+    }
+    pthread_cond_broadcast(&walPtr->sincronizado);
+}
+
+/**
+ * @brief Abre o WAL para novos registros depois da recuperação
+ * @param walPtr WAL a preparar
+ * @param caminho Mesmo caminho passado a recuperarSessoesWal()
+ * @param recuperacaoPtr Resultado da recuperação (também quando não havia arquivos)
+ * @return 1 em caso de sucesso, 0 se o segmento não pôde ser criado
+ *
+ * Os registros vão para um segmento novo, depois do último recuperado:
+ * um final corrompido por uma queda nunca recebe registros.
+ */
+int abrirWal(WalSessoes* walPtr, const char* caminho, const ResultadoRecuperacaoWal* recuperacaoPtr) {
+    memset(walPtr, 0, sizeof(*walPtr));
+    if (strlen(caminho) >= sizeof(walPtr->caminho)) {
+        fprintf(stderr, "Caminho do WAL muito longo: %s\n", caminho);
+        return 0;
+    }
+    snprintf(walPtr->caminho, sizeof(walPtr->caminho), "%s", caminho);
+    walPtr->segmento = recuperacaoPtr->proximoSegmento;
+    walPtr->primeiroSegmento = recuperacaoPtr->primeiroSegmento;
+    walPtr->proximoLsn = recuperacaoPtr->proximoLsn;
+    walPtr->lsnDuravel = walPtr->proximoLsn - 1;
+    walPtr->lote = malloc(sizeof(RegistroWal) * CAPACIDADE_LOTE_WAL);
+    walPtr->loteLider = malloc(sizeof(RegistroWal) * CAPACIDADE_LOTE_WAL);
+    walPtr->descritor = walPtr->lote != NULL && walPtr->loteLider != NULL
+                        ? abrirSegmentoWal(caminho, walPtr->segmento) : -1;
+    if (walPtr->descritor < 0) {
+        free(walPtr->lote);
+        free(walPtr->loteLider);
+        return 0;
+    }
+    pthread_mutex_init(&walPtr->trava, NULL);
+    pthread_cond_init(&walPtr->sincronizado, NULL);
+    return 1;
+}
+
+/**
+ * @brief Acrescenta um registro ao lote em memória
+ * @param walPtr WAL aberto
+ * @param registroPtr Registro preenchido; recebe o LSN e o CRC
+ * @return LSN do registro (durável depois de aguardarWal())
+ */
+uint64_t registrarWal(WalSessoes* walPtr, RegistroWal* registroPtr) {
+    pthread_mutex_lock(&walPtr->trava);
+    while (walPtr->quantidadeLote == CAPACIDADE_LOTE_WAL) {
+        if (walPtr->liderAtivo) {
+            pthread_cond_wait(&walPtr->sincronizado, &walPtr->trava);
+        } else {
+            liderarCommitWal(walPtr);
+        }
+    }
+    registroPtr->lsn = walPtr->proximoLsn++;
+    registroPtr->crc = crcRegistroWal(registroPtr);
+    walPtr->lote[walPtr->quantidadeLote++] = *registroPtr;
+    walPtr->registros++;
+    pthread_mutex_unlock(&walPtr->trava);
+    return registroPtr->lsn;
+}
+
+/**
+ * @brief Espera até o registro estar no disco
+ * @param walPtr WAL aberto
+ * @param lsn LSN devolvido por registrarWal() (0 = nada a esperar)
+ * @return 1 se o registro é durável, 0 se o WAL falhou
+ */
+int aguardarWal(WalSessoes* walPtr, uint64_t lsn) {
+    pthread_mutex_lock(&walPtr->trava);
+    while (walPtr->lsnDuravel < lsn && !walPtr->falhou) {
+        if (walPtr->liderAtivo) {
+            pthread_cond_wait(&walPtr->sincronizado, &walPtr->trava);
+        } else {
+            liderarCommitWal(walPtr);
+        }
+    }
+    int duravel = walPtr->lsnDuravel >= lsn;
+    pthread_mutex_unlock(&walPtr->trava);
+    return duravel;
+}
+
+/**
+ * @brief Registra uma sessão recém-criada e espera o registro ficar durável
+ * @param walPtr WAL aberto
+ * @param sessaoPtr Sessão já configurada (capacidades e regras), antes da primeira opção
+ */
+void registrarAberturaWal(WalSessoes* walPtr, SessaoJogo* sessaoPtr) {
+    RegistroWal registro;
+    memset(&registro, 0, sizeof(registro));
+    registro.sessao = sessaoPtr->identificador;
+    registro.tipo = WAL_ABRIR_SESSAO;
+    registro.semente = sessaoPtr->sementeInicial;
+    registro.capacidadeFila = (uint16_t)sessaoPtr->fila.capacidade;
+    registro.capacidadePilha = (uint16_t)sessaoPtr->pilha.capacidade;
+    registro.regras = sessaoPtr->sistema.regrasPontuacao;
+    registro.comHistorico = sessaoPtr->historico != NULL;
+    registro.encaixeAutomatico = sessaoPtr->encaixeAutomatico;
+    sessaoPtr->lsnWal = registrarWal(walPtr, &registro);
+    aguardarWal(walPtr, sessaoPtr->lsnWal);
+}
+
+/**
+ * @brief Registra o fim de uma sessão, que deixa de ser recuperada
+ * @param walPtr WAL aberto
+ * @param sessaoPtr Sessão encerrada
+ */
+void registrarFechamentoWal(WalSessoes* walPtr, SessaoJogo* sessaoPtr) {
+    RegistroWal registro;
+    memset(&registro, 0, sizeof(registro));
+    registro.sessao = sessaoPtr->identificador;
+    registro.tipo = WAL_FECHAR_SESSAO;
+    sessaoPtr->lsnWal = registrarWal(walPtr, &registro);
+    aguardarWal(walPtr, sessaoPtr->lsnWal);
+}
+
+/**
+ * @brief Grava a peça em destino com zeros no preenchimento entre tipo e id
+ *
+ * Campo a campo sobre os bytes: uma Peca devolvida por valor pode perder
+ * o preenchimento zerado, e o checkpoint precisa ser igual byte a byte.
+ */
+static void normalizarPecaWal(unsigned char destino[sizeof(Peca)], const Peca* pecaPtr) {
+    memset(destino, 0, sizeof(Peca));
+    if (pecaPtr != NULL) {
+        memcpy(destino + offsetof(Peca, tipo), &pecaPtr->tipo, sizeof(pecaPtr->tipo));
+        memcpy(destino + offsetof(Peca, id), &pecaPtr->id, sizeof(pecaPtr->id));
+    }
+}
+
+static void acrescentarCheckpointWal(BufferCheckpointWal* bufferPtr, const void* dados, size_t tamanho) {
+    if (bufferPtr->tamanho + tamanho > bufferPtr->capacidade) {
+        size_t capacidade = bufferPtr->capacidade > 0 ? bufferPtr->capacidade : 65536;
+        while (capacidade < bufferPtr->tamanho + tamanho) {
+            capacidade *= 2;
+        }
+        char* dadosNovos = realloc(bufferPtr->dados, capacidade);
+        if (dadosNovos == NULL) {
+            bufferPtr->semMemoria = 1;
+            return;
+        }
+        bufferPtr->dados = dadosNovos;
+        bufferPtr->capacidade = capacidade;
+    }
+    memcpy(bufferPtr->dados + bufferPtr->tamanho, dados, tamanho);
+    bufferPtr->tamanho += tamanho;
+}
+
+/**
+ * @brief Copia uma sessão para o checkpoint sem parar quem joga nela
+ *
+ * Leitura otimista: a cópia é refeita se uma opção começou ou terminou
+ * enquanto ela era feita (versaoEstado ímpar ou diferente no fim). As
+ * quantidades são limitadas às capacidades para que uma leitura no meio
+ * de uma alteração nunca saia dos vetores.
+ */
+static void copiarSessaoCheckpointWal(BufferCheckpointWal* bufferPtr, const SessaoJogo* sessaoPtr) {
+    size_t inicio = bufferPtr->tamanho;
+    for (;;) {
+        uint32_t versao = atomic_load_explicit(&sessaoPtr->versaoEstado, memory_order_acquire);
+        if (versao & 1) {
+            sched_yield();
+            continue;
+        }
+        bufferPtr->tamanho = inicio;
+
+        const FilaCircular* filaPtr = &sessaoPtr->fila;
+        const PilhaReserva* pilhaPtr = &sessaoPtr->pilha;
+        const HistoricoAcoes* historicoPtr = sessaoPtr->historico;
+        SessaoCheckpointWal fixa;
+        memset(&fixa, 0, sizeof(fixa));
+        fixa.identificador = sessaoPtr->identificador;
+        fixa.eventosDiario = sessaoPtr->eventosDiario;
+        fixa.lsnWal = sessaoPtr->lsnWal;
+        fixa.sementeInicial = sessaoPtr->sementeInicial;
+        fixa.encaixeAutomatico = sessaoPtr->encaixeAutomatico;
+        fixa.capacidadeFila = filaPtr->capacidade;
+        fixa.quantidadeFila = filaPtr->quantidadePecas < filaPtr->capacidade
+                              ? filaPtr->quantidadePecas : filaPtr->capacidade;
+        fixa.capacidadePilha = pilhaPtr->capacidade;
+        fixa.quantidadePilha = pilhaPtr->quantidadeReservada < pilhaPtr->capacidade
+                               ? pilhaPtr->quantidadeReservada : pilhaPtr->capacidade;
+        fixa.deltasRegistrados = -1;
+        if (historicoPtr != NULL) {
+            fixa.deltasRegistrados = historicoPtr->registrados < CAPACIDADE_HISTORICO
+                                     ? historicoPtr->registrados : CAPACIDADE_HISTORICO;
+            fixa.deltasAplicados = historicoPtr->aplicados < fixa.deltasRegistrados
+                                   ? historicoPtr->aplicados : fixa.deltasRegistrados;
+        }
+        SistemaExpert sistema = sessaoPtr->sistema; // A sessão é de outra thread: sincroniza a cópia
+        sincronizarSistemaExpert(&sistema);
+        acrescentarCheckpointWal(bufferPtr, &fixa, sizeof(fixa));
+        acrescentarCheckpointWal(bufferPtr, &sistema, sizeof(sistema));
+        acrescentarCheckpointWal(bufferPtr, &sessaoPtr->tabuleiro, sizeof(sessaoPtr->tabuleiro));
+        acrescentarCheckpointWal(bufferPtr, &sessaoPtr->gerador, sizeof(sessaoPtr->gerador));
+        acrescentarCheckpointWal(bufferPtr, &sessaoPtr->conquistas, sizeof(sessaoPtr->conquistas));
+        unsigned char peca[sizeof(Peca)];
+        for (int i = 0; i < fixa.quantidadeFila; i++) {
+            normalizarPecaWal(peca, espiarFila(filaPtr, i));
+            acrescentarCheckpointWal(bufferPtr, peca, sizeof(peca));
+        }
+        for (int i = fixa.quantidadePilha - 1; i >= 0; i--) {
+            normalizarPecaWal(peca, espiarPilha(pilhaPtr, i));
+            acrescentarCheckpointWal(bufferPtr, peca, sizeof(peca));
+        }
+        for (int i = 0; i < fixa.deltasRegistrados; i++) {
+            const DeltaHistorico* deltaPtr = &historicoPtr->deltas[(historicoPtr->inicio + i) % CAPACIDADE_HISTORICO];
+            unsigned char delta[sizeof(DeltaHistorico)];
+            memcpy(delta, deltaPtr, sizeof(delta));
+            normalizarPecaWal(delta + offsetof(DeltaHistorico, peca), &deltaPtr->peca);
+            acrescentarCheckpointWal(bufferPtr, delta, sizeof(delta));
+        }
+
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&sessaoPtr->versaoEstado, memory_order_relaxed) == versao) {
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Grava um checkpoint das sessões e descarta os segmentos que ele cobre
+ * @param walPtr WAL aberto
+ * @param sessoes Todas as sessões abertas (podem continuar jogando)
+ * @param quantidade Número de sessões
+ * @return 1 em caso de sucesso, 0 em caso de falha (o checkpoint anterior continua valendo)
+ *
+ * Primeiro o WAL passa para um segmento novo: todo registro dos segmentos
+ * anteriores pertence a uma opção que terminou antes da cópia da sua
+ * sessão. O checkpoint é gravado em um arquivo temporário, sincronizado e
+ * renomeado; só então os segmentos antigos são apagados. As sessões vão
+ * para o arquivo em blocos de BLOCO_CHECKPOINT_WAL bytes, com o CRC
+ * estendido a cada bloco, e o cabeçalho é regravado no início ao final:
+ * a memória usada não depende do número de sessões. Uma queda em
+ * qualquer ponto deixa o checkpoint anterior e todos os seus segmentos.
+ * Um checkpoint por vez.
+ */
+int gravarCheckpointWal(WalSessoes* walPtr, SessaoJogo* const* sessoes, int quantidade) {
+    pthread_mutex_lock(&walPtr->trava);
+    while ((walPtr->liderAtivo || walPtr->quantidadeLote > 0) && !walPtr->falhou) {
+        if (walPtr->liderAtivo) {
+            pthread_cond_wait(&walPtr->sincronizado, &walPtr->trava);
+        } else {
+            liderarCommitWal(walPtr);
+        }
+    }
+    int descritorNovo = walPtr->falhou ? -1 : abrirSegmentoWal(walPtr->caminho, walPtr->segmento + 1);
+    if (descritorNovo < 0) {
+        pthread_mutex_unlock(&walPtr->trava);
+        return 0;
+    }
+    close(walPtr->descritor);
+    walPtr->descritor = descritorNovo;
+    walPtr->segmento++;
+    CabecalhoCheckpointWal cabecalho;
+    memset(&cabecalho, 0, sizeof(cabecalho));
+    memcpy(cabecalho.magica, "TETRISCK", sizeof(cabecalho.magica));
+    cabecalho.versao = VERSAO_CHECKPOINT_WAL;
+    cabecalho.primeiroSegmento = walPtr->segmento;
+    cabecalho.proximoLsn = walPtr->proximoLsn;
+    pthread_mutex_unlock(&walPtr->trava);
+
+    char temporario[TAMANHO_CAMINHO_WAL + 16], definitivo[TAMANHO_CAMINHO_WAL + 16];
+    snprintf(temporario, sizeof(temporario), "%s.ckpt.tmp", walPtr->caminho);
+    snprintf(definitivo, sizeof(definitivo), "%s.ckpt", walPtr->caminho);
+    uint64_t inicio = instanteDiarioNs(CLOCK_MONOTONIC);
+    int descritor = open(temporario, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+
+    // Cabeçalho provisório: o definitivo só é conhecido depois das sessões
+    int gravou = descritor >= 0 && gravarTudoWal(descritor, &cabecalho, sizeof(cabecalho));
+    BufferCheckpointWal buffer = {NULL, 0, 0, 0};
+    for (int i = 0; gravou && i < quantidade; i++) {
+        copiarSessaoCheckpointWal(&buffer, sessoes[i]);
+        if (buffer.semMemoria) {
+            gravou = 0;
+        } else if (buffer.tamanho >= BLOCO_CHECKPOINT_WAL || i == quantidade - 1) {
+            cabecalho.crcDados = continuarCrc32c(cabecalho.crcDados, buffer.dados, buffer.tamanho);
+            cabecalho.tamanhoDados += buffer.tamanho;
+            gravou = gravarTudoWal(descritor, buffer.dados, buffer.tamanho);
+            buffer.tamanho = 0;
+        }
+    }
+    free(buffer.dados);
+    cabecalho.sessoes = (uint32_t)quantidade;
+    cabecalho.crcCabecalho = calcularCrc32c(&cabecalho, offsetof(CabecalhoCheckpointWal, crcCabecalho));
+    gravou = gravou && pwrite(descritor, &cabecalho, sizeof(cabecalho), 0) == (ssize_t)sizeof(cabecalho);
+    uint64_t copiado = instanteDiarioNs(CLOCK_MONOTONIC);
+    gravou = gravou && fdatasync(descritor) == 0;
+    if (descritor >= 0) {
+        close(descritor);
+    }
+    gravou = gravou && rename(temporario, definitivo) == 0;
+    if (!gravou) {
+        fprintf(stderr, "Falha ao gravar o checkpoint %s: %s\n", definitivo, strerror(errno));
+        unlink(temporario);
+        return 0;
+    }
+    sincronizarDiretorioWal(walPtr->caminho);
+
+    char nome[TAMANHO_CAMINHO_WAL + 16];
+    for (uint32_t segmento = walPtr->primeiroSegmento; segmento < cabecalho.primeiroSegmento; segmento++) {
+        nomeSegmentoWal(nome, sizeof(nome), walPtr->caminho, segmento);
+        unlink(nome);
+    }
+    walPtr->primeiroSegmento = cabecalho.primeiroSegmento;
+    pthread_mutex_lock(&walPtr->trava);
+    walPtr->checkpoints++;
+    walPtr->bytesUltimoCheckpoint = sizeof(cabecalho) + cabecalho.tamanhoDados;
+    walPtr->nsCopiaCheckpoints += copiado - inicio;
+    walPtr->nsSincronizacaoCheckpoints += instanteDiarioNs(CLOCK_MONOTONIC) - copiado;
+    pthread_mutex_unlock(&walPtr->trava);
+    return 1;
+}
+
+/**
+ * @brief Grava o lote pendente e fecha o WAL
+ * @param walPtr WAL aberto, sem threads registrando
+ */
+void fecharWal(WalSessoes* walPtr) {
+    aguardarWal(walPtr, walPtr->proximoLsn - 1);
+    close(walPtr->descritor);
+    walPtr->descritor = -1;
+    pthread_cond_destroy(&walPtr->sincronizado);
+    pthread_mutex_destroy(&walPtr->trava);
+    free(walPtr->lote);
+    free(walPtr->loteLider);
+    walPtr->lote = NULL;
+    walPtr->loteLider = NULL;
+}
+
+static void lerCheckpointWal(LeituraCheckpointWal* leituraPtr, void* destino, size_t tamanho) {
+    if (leituraPtr->erro || leituraPtr->tamanho - leituraPtr->posicao < tamanho) {
+        leituraPtr->erro = 1;
+        memset(destino, 0, tamanho);
+        return;
+    }
+    memcpy(destino, leituraPtr->dados + leituraPtr->posicao, tamanho);
+    leituraPtr->posicao += tamanho;
+}
+
+/**
+ * @brief Recria uma sessão a partir da sua cópia no checkpoint
+ * @return Sessão, ou NULL se a cópia é inválida ou faltou memória
+ */
+static SessaoJogo* restaurarSessaoCheckpointWal(LeituraCheckpointWal* leituraPtr, PoolObjetos* poolSessoes,
+                                               PoolObjetos* poolHistoricos) {
+    SessaoCheckpointWal fixa;
+    lerCheckpointWal(leituraPtr, &fixa, sizeof(fixa));
+    if (leituraPtr->erro || (fixa.deltasRegistrados >= 0 && poolHistoricos == NULL) ||
+        fixa.deltasRegistrados > CAPACIDADE_HISTORICO) {
+        return NULL;
+    }
+    SessaoJogo* sessaoPtr = abrirSessao(poolSessoes, fixa.deltasRegistrados >= 0 ? poolHistoricos : NULL,
+                                        fixa.identificador, fixa.sementeInicial);
+    if (sessaoPtr == NULL) {
+        return NULL;
+    }
+    sessaoPtr->encaixeAutomatico = fixa.encaixeAutomatico != 0;
+    lerCheckpointWal(leituraPtr, &sessaoPtr->sistema, sizeof(sessaoPtr->sistema));
+    lerCheckpointWal(leituraPtr, &sessaoPtr->tabuleiro, sizeof(sessaoPtr->tabuleiro));
+    lerCheckpointWal(leituraPtr, &sessaoPtr->gerador, sizeof(sessaoPtr->gerador));
+    lerCheckpointWal(leituraPtr, &sessaoPtr->conquistas, sizeof(sessaoPtr->conquistas));
+
+    liberarFila(&sessaoPtr->fila);
+    inicializarFila(&sessaoPtr->fila);
+    liberarPilha(&sessaoPtr->pilha);
+    inicializarPilha(&sessaoPtr->pilha);
+    int valida = configurarCapacidadeFila(&sessaoPtr->fila, fixa.capacidadeFila) &&
+                 configurarCapacidadePilha(&sessaoPtr->pilha, fixa.capacidadePilha) &&
+                 fixa.quantidadeFila >= 0 && fixa.quantidadeFila <= fixa.capacidadeFila &&
+                 fixa.quantidadePilha >= 0 && fixa.quantidadePilha <= fixa.capacidadePilha;
+    for (int i = 0; valida && i < fixa.quantidadeFila; i++) {
+        Peca peca;
+        lerCheckpointWal(leituraPtr, &peca, sizeof(peca));
+        inserirPecaNaFila(&sessaoPtr->fila, peca);
+    }
+    for (int i = 0; valida && i < fixa.quantidadePilha; i++) {
+        Peca peca;
+        lerCheckpointWal(leituraPtr, &peca, sizeof(peca));
+        reservarPeca(&sessaoPtr->pilha, peca);
+    }
+    HistoricoAcoes* historicoPtr = sessaoPtr->historico;
+    for (int i = 0; valida && i < fixa.deltasRegistrados; i++) {
+        lerCheckpointWal(leituraPtr, &historicoPtr->deltas[i], sizeof(DeltaHistorico));
+    }
+    if (historicoPtr != NULL) {
+        historicoPtr->inicio = 0;
+        historicoPtr->registrados = fixa.deltasRegistrados;
+        historicoPtr->aplicados = fixa.deltasAplicados;
+    }
+    if (!valida || leituraPtr->erro) {
+        fecharSessao(poolSessoes, historicoPtr != NULL ? poolHistoricos : NULL, sessaoPtr);
+        return NULL;
+    }
+    sessaoPtr->eventosDiario = fixa.eventosDiario;
+    sessaoPtr->lsnWal = fixa.lsnWal;
+    sessaoPtr->estado = SESSAO_AGUARDA_ENTER;
+    return sessaoPtr;
+}
+
+/**
+ * @brief Índice das sessões recuperadas por identificador (endereçamento aberto)
+ */
+typedef struct {
+    int* posicoes;                  ///< Posição em sessoes[], -1 = livre
+    int mascara;
+} IndiceSessoesWal;
+
+static int* buscarIndiceSessoesWal(IndiceSessoesWal* indicePtr, SessaoJogo** sessoes, int identificador) {
+    uint32_t h = (uint32_t)identificador * 2654435761u;
+    for (int i = (int)(h & (uint32_t)indicePtr->mascara);; i = (i + 1) & indicePtr->mascara) {
+        int posicao = indicePtr->posicoes[i];
+        if (posicao < 0 || sessoes[posicao]->identificador == identificador) {
+            return &indicePtr->posicoes[i];
+        }
+    }
+}
+
+/**
+ * @brief Reconstrói as sessões a partir do último checkpoint e dos segmentos seguintes
+ * @param caminho Caminho base do WAL
+ * @param poolSessoes Pool das sessões recuperadas
+ * @param poolHistoricos Pool dos históricos (NULL se nenhuma sessão usava desfazer)
+ * @param sessoes Recebe as sessões abertas, na ordem em que apareceram
+ * @param capacidade Tamanho de sessoes[]
+ * @param resultadoPtr Estatísticas e a continuação para abrirWal()
+ * @return Número de sessões recuperadas, ou -1 se o checkpoint ou o WAL são inválidos
+ *
+ * Cada opção registrada depois da cópia da sua sessão é reexecutada, sem
+ * saída. Um registro com CRC inválido marca o fim do que chegou ao disco
+ * naquele segmento (escrita interrompida por uma queda). As regras de
+ * pontuação carregadas e os padrões de combo precisam ser os mesmos da
+ * execução original.
+ */
+int recuperarSessoesWal(const char* caminho, PoolObjetos* poolSessoes, PoolObjetos* poolHistoricos,
+                        SessaoJogo** sessoes, int capacidade, ResultadoRecuperacaoWal* resultadoPtr) {
+    double inicio = (double)instanteDiarioNs(CLOCK_MONOTONIC);
+    memset(resultadoPtr, 0, sizeof(*resultadoPtr));
+    resultadoPtr->primeiroSegmento = 1;
+    resultadoPtr->proximoLsn = 1;
+
+    IndiceSessoesWal indice;
+    indice.mascara = 15;
+    while (indice.mascara + 1 < 2 * capacidade) {
+        indice.mascara = indice.mascara * 2 + 1;
+    }
+    indice.posicoes = malloc(sizeof(int) * (size_t)(indice.mascara + 1));
+    if (indice.posicoes == NULL) {
+        return -1;
+    }
+    memset(indice.posicoes, 0xFF, sizeof(int) * (size_t)(indice.mascara + 1));
+    int quantidade = 0, erro = 0;
+
+    char nome[TAMANHO_CAMINHO_WAL + 16];
+    snprintf(nome, sizeof(nome), "%s.ckpt", caminho);
+    FILE* arquivo = fopen(nome, "rb");
+    if (arquivo != NULL) {
+        CabecalhoCheckpointWal cabecalho;
+        char* dados = NULL;
+        erro = fread(&cabecalho, sizeof(cabecalho), 1, arquivo) != 1 ||
+               memcmp(cabecalho.magica, "TETRISCK", sizeof(cabecalho.magica)) != 0 ||
+               cabecalho.versao != VERSAO_CHECKPOINT_WAL ||
+               cabecalho.crcCabecalho != calcularCrc32c(&cabecalho, offsetof(CabecalhoCheckpointWal, crcCabecalho)) ||
+               (dados = malloc(cabecalho.tamanhoDados + 1)) == NULL ||
+               fread(dados, 1, cabecalho.tamanhoDados, arquivo) != cabecalho.tamanhoDados ||
+               calcularCrc32c(dados, cabecalho.tamanhoDados) != cabecalho.crcDados;
+        fclose(arquivo);
+        LeituraCheckpointWal leitura = {dados, erro ? 0 : cabecalho.tamanhoDados, 0, 0};
+        for (uint32_t i = 0; !erro && i < cabecalho.sessoes; i++) {
+            SessaoJogo* sessaoPtr = quantidade < capacidade
+                                    ? restaurarSessaoCheckpointWal(&leitura, poolSessoes, poolHistoricos) : NULL;
+            if (sessaoPtr == NULL) {
+                erro = 1;
+                break;
+            }
+            *buscarIndiceSessoesWal(&indice, sessoes, sessaoPtr->identificador) = quantidade;
+            sessoes[quantidade++] = sessaoPtr;
+        }
+        free(dados);
+        if (erro) {
+            fprintf(stderr, "Checkpoint invalido: %s\n", nome);
+        } else {
+            resultadoPtr->primeiroSegmento = cabecalho.primeiroSegmento;
+            resultadoPtr->proximoLsn = cabecalho.proximoLsn;
+            resultadoPtr->sessoesCheckpoint = quantidade;
+        }
+    }
+
+    // A reexecução não produz saída nem novos registros
+    FILE* saidaAnterior = saidaJogo;
+    WalSessoes* walAnterior = walSessoes;
+    DiarioJogadas* diarioAnterior = diarioJogadas;
+    FILE* descarte = fopen("/dev/null", "w");
+    saidaJogo = descarte;
+    walSessoes = NULL;
+    diarioJogadas = NULL;
+    int silenciosaAnterior = saidaSilenciosa;
+    saidaSilenciosa = 1;
+
+    uint32_t segmento = resultadoPtr->primeiroSegmento;
+    RegistroWal* registros = malloc(sizeof(RegistroWal) * CAPACIDADE_LOTE_WAL);
+    for (; !erro && registros != NULL; segmento++) {
+        nomeSegmentoWal(nome, sizeof(nome), caminho, segmento);
+        arquivo = fopen(nome, "rb");
+        if (arquivo == NULL) {
+            break;
+        }
+        size_t lidos;
+        int fimValido = 1;
+        while (fimValido && !erro && (lidos = fread(registros, sizeof(RegistroWal), CAPACIDADE_LOTE_WAL, arquivo)) > 0) {
+            for (size_t r = 0; r < lidos && !erro; r++) {
+                const RegistroWal* registroPtr = &registros[r];
+                if (registroPtr->crc != crcRegistroWal(registroPtr)) {
+                    fimValido = 0;
+                    break;
+                }
+                if (registroPtr->lsn >= resultadoPtr->proximoLsn) {
+                    resultadoPtr->proximoLsn = registroPtr->lsn + 1;
+                }
+                int* posicaoPtr = buscarIndiceSessoesWal(&indice, sessoes, registroPtr->sessao);
+                SessaoJogo* sessaoPtr = *posicaoPtr >= 0 ? sessoes[*posicaoPtr] : NULL;
+                if (sessaoPtr != NULL && registroPtr->lsn <= sessaoPtr->lsnWal) {
+                    continue;
+                }
+                if (registroPtr->tipo == WAL_ABRIR_SESSAO &&
+                    (sessaoPtr == NULL || sessaoPtr->estado == SESSAO_ENCERRADA)) {
+                    // Identificador reutilizado depois de um fechamento: a sessão nova ocupa o lugar
+                    int posicao = *posicaoPtr >= 0 ? *posicaoPtr : quantidade;
+                    if (posicao == capacidade || (registroPtr->comHistorico && poolHistoricos == NULL)) {
+                        erro = 1;
+                        break;
+                    }
+                    SessaoJogo* novaPtr = abrirSessao(poolSessoes, registroPtr->comHistorico ? poolHistoricos : NULL,
+                                                      registroPtr->sessao, registroPtr->semente);
+                    if (novaPtr == NULL ||
+                        !configurarCapacidadesSessao(novaPtr, registroPtr->capacidadeFila,
+                                                     registroPtr->capacidadePilha) ||
+                        !definirRegrasPontuacao(&novaPtr->sistema, registroPtr->regras)) {
+                        if (novaPtr != NULL) {
+                            fecharSessao(poolSessoes, novaPtr->historico != NULL ? poolHistoricos : NULL, novaPtr);
+                        }
+                        erro = 1;
+                        break;
+                    }
+                    if (sessaoPtr != NULL) {
+                        fecharSessao(poolSessoes, sessaoPtr->historico != NULL ? poolHistoricos : NULL, sessaoPtr);
+                    }
+                    sessaoPtr = novaPtr;
+                    sessaoPtr->encaixeAutomatico = registroPtr->encaixeAutomatico != 0;
+                    sessaoPtr->estado = SESSAO_AGUARDA_ENTER;
+                    *posicaoPtr = posicao;
+                    sessoes[posicao] = sessaoPtr;
+                    quantidade += posicao == quantidade;
+                } else if (registroPtr->tipo == WAL_OPCAO && sessaoPtr != NULL) {
+                    executarOpcaoSessao(sessaoPtr, registroPtr->opcao);
+                    exibirConquistasSessao(sessaoPtr);
+                    resultadoPtr->registrosReaplicados++;
+                } else if (registroPtr->tipo == WAL_FECHAR_SESSAO && sessaoPtr != NULL) {
+                    sessaoPtr->estado = SESSAO_ENCERRADA;
+                }
+                if (sessaoPtr != NULL) {
+                    sessaoPtr->lsnWal = registroPtr->lsn;
+                }
+            }
+        }
+        fclose(arquivo);
+    }
+    resultadoPtr->proximoSegmento = segmento;
+    free(registros);
+
+    saidaJogo = saidaAnterior;
+    walSessoes = walAnterior;
+    diarioJogadas = diarioAnterior;
+    saidaSilenciosa = silenciosaAnterior;
+    if (descarte != NULL) {
+        fclose(descarte);
+    }
+
+    // Sessões encerradas voltam aos pools
+    int abertas = 0;
+    for (int i = 0; i < quantidade; i++) {
+        if (sessoes[i]->estado == SESSAO_ENCERRADA) {
+            fecharSessao(poolSessoes, sessoes[i]->historico != NULL ? poolHistoricos : NULL, sessoes[i]);
+        } else {
+            sessoes[abertas++] = sessoes[i];
+        }
+    }
+    free(indice.posicoes);
+    resultadoPtr->sessoes = abertas;
+    resultadoPtr->segundos = ((double)instanteDiarioNs(CLOCK_MONOTONIC) - inicio) * 1e-9;
+    if (erro) {
+        fprintf(stderr, "Nao foi possivel recuperar as sessoes de %s\n", caminho);
+        return -1;
+    }
+    return abertas;
+}
+
+// ═══════════════════════════════════════════════════════════════════════════════
+//                       SEQUÊNCIA DIFUNDIDA (SALAS COMPETITIVAS)
+// ═══════════════════════════════════════════════════════════════════════════════
+
+/**
+ * @brief Prepara uma sequência difundida vazia
+ * @param sequenciaPtr Sequência a inicializar
+ * @param semente Semente do gerador (a sequência é a de inicializarGeradorPecas())
+ * @param capacidadeCursores Máximo de jogadores registrados ao mesmo tempo
+ * @param capacidadeSegmentos Segmentos retidos no máximo (arredondado para potência de 2)
+ * @return 1 em caso de sucesso, 0 sem memória
+ *
+ * capacidadeSegmentos limita a distância entre o jogador mais atrasado e
+ * a última peça produzida a capacidadeSegmentos x PECAS_POR_SEGMENTO_DIFUSAO.
+ */
+int iniciarSequenciaDifundida(SequenciaDifundida* sequenciaPtr, uint64_t semente, int capacidadeCursores,
+                              int capacidadeSegmentos) {
+    memset(sequenciaPtr, 0, sizeof(*sequenciaPtr));
+    int tamanho = 2;
+    while (tamanho < capacidadeSegmentos) {
+        tamanho *= 2;
+    }
+    sequenciaPtr->diretorio = calloc((size_t)tamanho, sizeof(SegmentoDifusao*));
+    sequenciaPtr->cursores = aligned_alloc(64, sizeof(CursorDifusao) * (size_t)(capacidadeCursores > 0 ? capacidadeCursores : 1));
+    if (sequenciaPtr->diretorio == NULL || sequenciaPtr->cursores == NULL) {
+        free(sequenciaPtr->diretorio);
+        free(sequenciaPtr->cursores);
+        return 0;
+    }
+    memset(sequenciaPtr->cursores, 0, sizeof(CursorDifusao) * (size_t)(capacidadeCursores > 0 ? capacidadeCursores : 1));
+    sequenciaPtr->capacidadeDiretorio = tamanho;
+    sequenciaPtr->capacidadeCursores = capacidadeCursores;
+    inicializarGeradorPecas(&sequenciaPtr->gerador, semente);
+    pthread_mutex_init(&sequenciaPtr->trava, NULL);
+    return 1;
+}
+
+/**
+ * @brief Libera segmentos e cursores (nenhum jogador pode estar lendo)
+ * @param sequenciaPtr Sequência iniciada
+ */
+void liberarSequenciaDifundida(SequenciaDifundida* sequenciaPtr) {
+    for (int i = 0; i < sequenciaPtr->capacidadeDiretorio; i++) {
+        free(sequenciaPtr->diretorio[i]);
+    }
+    while (sequenciaPtr->livres != NULL) {
+        SegmentoDifusao* proximo = sequenciaPtr->livres->proximoLivre;
+        free(sequenciaPtr->livres);
+        sequenciaPtr->livres = proximo;
+    }
+    free(sequenciaPtr->diretorio);
+    free(sequenciaPtr->cursores);
+    pthread_mutex_destroy(&sequenciaPtr->trava);
+    memset(sequenciaPtr, 0, sizeof(*sequenciaPtr));
+}
+
+/**
+ * @brief Registra um jogador na primeira peça ainda retida
+ * @param sequenciaPtr Sequência difundida
+ * @param janela Peças de prévia que o jogador enxerga além da próxima
+ * @return Índice do cursor, ou -1 se a sala está cheia
+ *
+ * Numa sala que começa junta, todos entram na peça 0. Quem entra depois
+ * começa no segmento mais antigo que ainda não foi reciclado.
+ */
+int registrarCursorDifusao(SequenciaDifundida* sequenciaPtr, int janela) {
+    pthread_mutex_lock(&sequenciaPtr->trava);
+    int indice = -1;
+    for (int i = 0; i < sequenciaPtr->capacidadeCursores && indice < 0; i++) {
+        if (!atomic_load_explicit(&sequenciaPtr->cursores[i].ativo, memory_order_relaxed)) {
+            indice = i;
+        }
+    }
+    if (indice >= 0) {
+        CursorDifusao* cursorPtr = &sequenciaPtr->cursores[indice];
+        cursorPtr->janela = janela > 0 ? janela : 0;
+        atomic_store_explicit(&cursorPtr->posicao, sequenciaPtr->primeiroSegmento << BITS_SEGMENTO_DIFUSAO,
+                              memory_order_relaxed);
+        atomic_store_explicit(&cursorPtr->ativo, 1, memory_order_release);
+        if (indice >= sequenciaPtr->cursoresUsados) {
+            sequenciaPtr->cursoresUsados = indice + 1;
+        }
+    }
+    pthread_mutex_unlock(&sequenciaPtr->trava);
+    return indice;
+}
+
+/**
+ * @brief Retira um jogador; os segmentos que só ele segurava passam a ser recicláveis
+ * @param sequenciaPtr Sequência difundida
+ * @param cursor Índice devolvido por registrarCursorDifusao()
+ */
+void removerCursorDifusao(SequenciaDifundida* sequenciaPtr, int cursor) {
+    pthread_mutex_lock(&sequenciaPtr->trava);
+    atomic_store_explicit(&sequenciaPtr->cursores[cursor].ativo, 0, memory_order_release);
+    pthread_mutex_unlock(&sequenciaPtr->trava);
+}
+
+/**
+ * @brief Produz peças até a prévia do jogador mais adiantado (só o produtor chama)
+ * @param sequenciaPtr Sequência difundida
+ * @return Peças publicadas até agora
+ *
+ * Uma passada pelos cursores dá a posição mais atrasada e a maior prévia
+ * pedida. Os segmentos inteiros antes do mais atrasado voltam para a lista
+ * de livres e são reaproveitados para as próximas peças: a memória
+ * acompanha a distância entre os jogadores, não o tamanho da partida. Se o
+ * mais atrasado segura o diretório inteiro, a produção para até ele andar.
+ */
+uint64_t produzirSequenciaDifundida(SequenciaDifundida* sequenciaPtr) {
+    uint64_t publicadas = atomic_load_explicit(&sequenciaPtr->publicadas, memory_order_relaxed);
+    pthread_mutex_lock(&sequenciaPtr->trava);
+    uint64_t maisAtrasado = publicadas, alvo = 0;
+    for (int i = 0; i < sequenciaPtr->cursoresUsados; i++) {
+        const CursorDifusao* cursorPtr = &sequenciaPtr->cursores[i];
+        if (atomic_load_explicit(&cursorPtr->ativo, memory_order_acquire)) {
+            uint64_t posicao = atomic_load_explicit(&cursorPtr->posicao, memory_order_acquire);
+            maisAtrasado = posicao < maisAtrasado ? posicao : maisAtrasado;
+            alvo = posicao + (uint64_t)cursorPtr->janela + 1 > alvo ? posicao + (uint64_t)cursorPtr->janela + 1 : alvo;
+        }
+    }
+    // Recicla os segmentos que todos os cursores já passaram
+    uint64_t mascara = (uint64_t)sequenciaPtr->capacidadeDiretorio - 1;
+    while (((sequenciaPtr->primeiroSegmento + 1) << BITS_SEGMENTO_DIFUSAO) <= maisAtrasado) {
+        SegmentoDifusao** entradaPtr = &sequenciaPtr->diretorio[sequenciaPtr->primeiroSegmento & mascara];
+        (*entradaPtr)->proximoLivre = sequenciaPtr->livres;
+        sequenciaPtr->livres = *entradaPtr;
+        *entradaPtr = NULL;
+        sequenciaPtr->primeiroSegmento++;
+        sequenciaPtr->segmentosEmUso--;
+        sequenciaPtr->segmentosReciclados++;
+    }
+    pthread_mutex_unlock(&sequenciaPtr->trava);
+
+    uint64_t limite = (sequenciaPtr->primeiroSegmento + (uint64_t)sequenciaPtr->capacidadeDiretorio)
+                      << BITS_SEGMENTO_DIFUSAO;
+    alvo = alvo < limite ? alvo : limite;
+    while (publicadas < alvo) {
+        uint64_t segmento = publicadas >> BITS_SEGMENTO_DIFUSAO;
+        SegmentoDifusao** entradaPtr = &sequenciaPtr->diretorio[segmento & mascara];
+        if (*entradaPtr == NULL) {
+            SegmentoDifusao* novo = sequenciaPtr->livres;
+            if (novo != NULL) {
+                sequenciaPtr->livres = novo->proximoLivre;
+            } else if ((novo = malloc(sizeof(SegmentoDifusao))) == NULL) {
+                break;
+            } else {
+                sequenciaPtr->segmentosAlocados++;
+            }
+            *entradaPtr = novo;
+            if (++sequenciaPtr->segmentosEmUso > sequenciaPtr->picoSegmentos) {
+                sequenciaPtr->picoSegmentos = sequenciaPtr->segmentosEmUso;
+            }
+        }
+        // Preenche até o fim do segmento ou do alvo e publica de uma vez
+        uint64_t fim = (segmento + 1) << BITS_SEGMENTO_DIFUSAO;
+        fim = fim < alvo ? fim : alvo;
+        for (; publicadas < fim; publicadas++) {
+            char tipo = sortearTipoPeca(&sequenciaPtr->gerador);
+            (*entradaPtr)->pecas[publicadas & (PECAS_POR_SEGMENTO_DIFUSAO - 1)] =
+                criarPeca(tipo, sequenciaPtr->gerador.proximoId++);
+        }
+        atomic_store_explicit(&sequenciaPtr->publicadas, publicadas, memory_order_release);
+    }
+    return publicadas;
+}
+
+/**
+ * @brief Consulta a k-ésima peça à frente de um jogador, sem consumi-la
+ * @param sequenciaPtr Sequência difundida
+ * @param cursor Cursor do jogador (só a thread dele chama)
+ * @param posicao 0 = próxima peça; até a janela do cursor
+ * @return Peça compartilhada, ou NULL se ainda não foi produzida
+ *
+ * A peça continua válida enquanto o cursor não passar dela: o produtor só
+ * recicla segmentos que todos os cursores já deixaram para trás.
+ */
+const Peca* espiarDifusao(const SequenciaDifundida* sequenciaPtr, int cursor, int posicao) {
+    uint64_t alvo = atomic_load_explicit(&sequenciaPtr->cursores[cursor].posicao, memory_order_relaxed) +
+                    (uint64_t)posicao;
+    if (alvo >= atomic_load_explicit(&sequenciaPtr->publicadas, memory_order_acquire)) {
+        return NULL;
+    }
+    const SegmentoDifusao* segmentoPtr =
+        sequenciaPtr->diretorio[(alvo >> BITS_SEGMENTO_DIFUSAO) & (uint64_t)(sequenciaPtr->capacidadeDiretorio - 1)];
+    return &segmentoPtr->pecas[alvo & (PECAS_POR_SEGMENTO_DIFUSAO - 1)];
+}
+
+/**
+ * @brief Consome a próxima peça de um jogador
+ * @param sequenciaPtr Sequência difundida
+ * @param cursor Cursor do jogador
+ * @param pecaPtr Peça consumida (saída)
+ * @return 1 se havia peça, 0 se o produtor ainda não chegou nela
+ */
+int avancarCursorDifusao(SequenciaDifundida* sequenciaPtr, int cursor, Peca* pecaPtr) {
+    const Peca* proximaPtr = espiarDifusao(sequenciaPtr, cursor, 0);
+    if (proximaPtr == NULL) {
+        return 0;
+    }
+    *pecaPtr = *proximaPtr;
+    _Atomic uint64_t* posicaoPtr = &sequenciaPtr->cursores[cursor].posicao;
+    atomic_store_explicit(posicaoPtr, atomic_load_explicit(posicaoPtr, memory_order_relaxed) + 1,
+                          memory_order_release);
+    return 1;
+}
+
+/**
+ * @brief Completa a fila de um jogador com as próximas peças da sala
+ * @param filaPtr Fila do jogador
+ * @param sequenciaPtr Sequência difundida
+ * @param cursor Cursor do jogador
+ * @return Peças inseridas (menos que o espaço livre se o produtor não chegou lá)
+ *
+ * Para quem usa as funções de jogo sobre FilaCircular; a fila só guarda as
+ * peças em jogo, e a prévia mais longa pode ser lida com espiarDifusao().
+ */
+int reabastecerFilaDifusao(FilaCircular* filaPtr, SequenciaDifundida* sequenciaPtr, int cursor) {
+    int inseridas = 0;
+    Peca peca;
+    while (!filaCheia(filaPtr) && avancarCursorDifusao(sequenciaPtr, cursor, &peca)) {
+        inserirPecaNaFila(filaPtr, peca);
+        inseridas++;
+    }
+    return inseridas;
+}
+
+// ═══════════════════════════════════════════════════════════════════════════════
+//                       TORNEIO PARALELO (BOTS x SEQUÊNCIAS)
+// ═══════════════════════════════════════════════════════════════════════════════
+
+/**
+ * @brief Lê uma configuração de participante no formato "nome:chave=valor,..."
+ * @param texto Descrição (modificada durante a leitura)
+ * @param participantePtr Participante (saída), partindo de configurarBotPadrao()
+ * @return 1 em caso de sucesso, 0 se alguma chave ou valor é inválido (mensagem em stderr)
+ *
+ * Chaves: largura, profundidade, fila, pilha, regras (nome registrado),
+ * gerador (uniforme ou saco7) e os pesos da avaliação (altura, buracos,
+ * irregularidade, pocos, transicoes, linhas). Sem "nome:", o texto
+ * inteiro vira o nome.
+ */
+int lerParticipanteTorneio(char* texto, ParticipanteTorneio* participantePtr) {
+    memset(participantePtr, 0, sizeof(*participantePtr));
+    configurarBotPadrao(&participantePtr->config);
+    char* separador = strchr(texto, ':');
+    if (separador != NULL) {
+        *separador = '\0';
+    }
+    snprintf(participantePtr->nome, sizeof(participantePtr->nome), "%s", texto);
+    if (separador == NULL) {
+        return 1;
+    }
+    ConfigBot* configPtr = &participantePtr->config;
+    char* contexto = NULL;
+    for (char* item = strtok_r(separador + 1, ",", &contexto); item != NULL; item = strtok_r(NULL, ",", &contexto)) {
+        char* valor = strchr(item, '=');
+        if (valor == NULL) {
+            fprintf(stderr, "Participante %s: esperado chave=valor em '%s'\n", participantePtr->nome, item);
+            return 0;
+        }
+        *valor++ = '\0';
+        int valido = 1;
+        if (strcmp(item, "largura") == 0) {
+            valido = (configPtr->larguraFeixe = atoi(valor)) > 0;
+        } else if (strcmp(item, "profundidade") == 0) {
+            valido = (configPtr->profundidade = atoi(valor)) > 0;
+        } else if (strcmp(item, "fila") == 0) {
+            valido = (configPtr->capacidadeFila = atoi(valor)) > 0 && configPtr->capacidadeFila <= CAPACIDADE_MAXIMA_FILA;
+        } else if (strcmp(item, "pilha") == 0) {
+            valido = (configPtr->capacidadePilha = atoi(valor)) > 0 && configPtr->capacidadePilha <= CAPACIDADE_MAXIMA_PILHA;
+        } else if (strcmp(item, "regras") == 0) {
+            valido = (configPtr->regrasPontuacao = buscarRegrasPontuacao(valor)) >= 0;
+        } else if (strcmp(item, "gerador") == 0) {
+            valido = (configPtr->modoGerador = buscarModoGerador(valor)) >= 0;
+        } else if (strcmp(item, "altura") == 0) {
+            configPtr->pesos.pesoAltura = atof(valor);
+        } else if (strcmp(item, "buracos") == 0) {
+            configPtr->pesos.pesoBuracos = atof(valor);
+        } else if (strcmp(item, "irregularidade") == 0) {
+            configPtr->pesos.pesoIrregularidade = atof(valor);
+        } else if (strcmp(item, "pocos") == 0) {
+            configPtr->pesos.pesoPocos = atof(valor);
+        } else if (strcmp(item, "transicoes") == 0) {
+            configPtr->pesos.pesoTransicoes = atof(valor);
+        } else if (strcmp(item, "linhas") == 0) {
+            configPtr->pesos.pesoLinhas = atof(valor);
+        } else {
+            valido = 0;
+        }
+        if (!valido) {
+            fprintf(stderr, "Participante %s: valor invalido para %s: %s\n", participantePtr->nome, item, valor);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/// Retira a próxima tarefa do fim da própria fila (LIFO) ou rouba do início de outra
+static int proximaTarefaTorneio(Torneio* torneioPtr, int trabalhador, int* roubadaPtr) {
+    FilaTarefasTorneio* propriaPtr = &torneioPtr->filas[trabalhador];
+    pthread_mutex_lock(&propriaPtr->trava);
+    int tarefa = propriaPtr->inicio < propriaPtr->fim ? propriaPtr->tarefas[--propriaPtr->fim] : -1;
+    pthread_mutex_unlock(&propriaPtr->trava);
+    *roubadaPtr = 0;
+    for (int k = 1; tarefa < 0 && k < torneioPtr->numeroThreads; k++) {
+        FilaTarefasTorneio* vitimaPtr = &torneioPtr->filas[(trabalhador + k) % torneioPtr->numeroThreads];
+        pthread_mutex_lock(&vitimaPtr->trava);
+        if (vitimaPtr->inicio < vitimaPtr->fim) {
+            tarefa = vitimaPtr->tarefas[vitimaPtr->inicio++];
+            *roubadaPtr = 1;
+        }
+        pthread_mutex_unlock(&vitimaPtr->trava);
+    }
+    return tarefa;
+}
+
+/**
+ * @brief Argumento de cada thread do torneio
+ */
+typedef struct {
+    Torneio* torneio;
+    int indice;
+} TrabalhadorTorneio;
+
+static void* executarTrabalhadorTorneio(void* argumento) {
+    TrabalhadorTorneio* trabalhadorPtr = argumento;
+    Torneio* torneioPtr = trabalhadorPtr->torneio;
+    int roubada;
+    int tarefa;
+    while ((tarefa = proximaTarefaTorneio(torneioPtr, trabalhadorPtr->indice, &roubada)) >= 0) {
+        int participante = tarefa / torneioPtr->quantidadeSequencias;
+        int sequencia = tarefa % torneioPtr->quantidadeSequencias;
+        ResultadoPartida resultado;
+        struct timespec antes, depois;
+        clock_gettime(CLOCK_MONOTONIC, &antes);
+        executarPartidaBot(&torneioPtr->participantes[participante].config,
+                           torneioPtr->sementeBase + (uint64_t)sequencia, torneioPtr->limitePecas, &resultado);
+        clock_gettime(CLOCK_MONOTONIC, &depois);
+
+        ResultadoJogoTorneio* jogoPtr = &torneioPtr->resultados[tarefa];
+        jogoPtr->pontuacao = resultado.sistema.pontuacaoTotal;
+        jogoPtr->pecasJogadas = resultado.pecasJogadas;
+        jogoPtr->linhasEliminadas = resultado.linhasEliminadas;
+        jogoPtr->nivel = resultado.sistema.nivelAtual;
+        jogoPtr->melhorCombo = resultado.sistema.melhorCombo;
+        jogoPtr->segundos = (depois.tv_sec - antes.tv_sec) + (depois.tv_nsec - antes.tv_nsec) * 1e-9;
+        jogoPtr->trabalhador = trabalhadorPtr->indice;
+        if (roubada) {
+            atomic_fetch_add_explicit(&torneioPtr->roubos, 1, memory_order_relaxed);
+        }
+    }
+    // A arena de busca é da thread: as criadas pelo torneio a devolvem ao terminar
+    if (trabalhadorPtr->indice > 0) {
+        liberarArena(&arenaBusca);
+    }
+    return NULL;
+}
+
+/**
+ * @brief Joga todas as combinações participante x sequência
+ * @param torneioPtr Torneio com participantes, sequências e resultados já preenchidos
+ * @param numeroThreads Threads trabalhadoras
+ * @return 1 em caso de sucesso, 0 se as threads não puderam ser criadas
+ *
+ * Cada thread recebe um bloco contíguo de partidas em uma fila própria e
+ * joga do fim para o começo; quem esvazia a sua rouba do começo da fila
+ * das outras, então partidas que acabam cedo não deixam núcleos parados.
+ * Cada resultado vai para a posição participante x sequência da tabela, e
+ * as partidas são determinísticas: a tabela é a mesma com qualquer número
+ * de threads.
+ */
+int executarTorneio(Torneio* torneioPtr, int numeroThreads) {
+    int totalTarefas = torneioPtr->quantidadeParticipantes * torneioPtr->quantidadeSequencias;
+    numeroThreads = numeroThreads < 1 ? 1 : numeroThreads;
+    torneioPtr->numeroThreads = numeroThreads;
+    torneioPtr->filas = calloc((size_t)numeroThreads, sizeof(FilaTarefasTorneio));
+    int* tarefas = malloc(sizeof(int) * (size_t)(totalTarefas > 0 ? totalTarefas : 1));
+    pthread_t* threads = malloc(sizeof(pthread_t) * (size_t)numeroThreads);
+    TrabalhadorTorneio* trabalhadores = malloc(sizeof(TrabalhadorTorneio) * (size_t)numeroThreads);
+    if (torneioPtr->filas == NULL || tarefas == NULL || threads == NULL || trabalhadores == NULL) {
+        free(torneioPtr->filas);
+        free(tarefas);
+        free(threads);
+        free(trabalhadores);
+        torneioPtr->filas = NULL;
+        return 0;
+    }
+    for (int i = 0; i < totalTarefas; i++) {
+        tarefas[i] = i;
+    }
+    for (int t = 0; t < numeroThreads; t++) {
+        FilaTarefasTorneio* filaPtr = &torneioPtr->filas[t];
+        pthread_mutex_init(&filaPtr->trava, NULL);
+        filaPtr->tarefas = tarefas;
+        filaPtr->inicio = (int)((long)totalTarefas * t / numeroThreads);
+        filaPtr->fim = (int)((long)totalTarefas * (t + 1) / numeroThreads);
+    }
+    atomic_store(&torneioPtr->roubos, 0);
+
+    struct timespec antes, depois;
+    clock_gettime(CLOCK_MONOTONIC, &antes);
+    int criadas = 0;
+    for (int t = 1; t < numeroThreads; t++) {
+        trabalhadores[t].torneio = torneioPtr;
+        trabalhadores[t].indice = t;
+        if (pthread_create(&threads[t], NULL, executarTrabalhadorTorneio, &trabalhadores[t]) != 0) {
+            break;
+        }
+        criadas = t;
+    }
+    trabalhadores[0].torneio = torneioPtr;
+    trabalhadores[0].indice = 0;
+    executarTrabalhadorTorneio(&trabalhadores[0]);   // A thread chamadora também joga (e rouba das que faltaram)
+    for (int t = 1; t <= criadas; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &depois);
+    torneioPtr->segundos = (depois.tv_sec - antes.tv_sec) + (depois.tv_nsec - antes.tv_nsec) * 1e-9;
+
+    for (int t = 0; t < numeroThreads; t++) {
+        pthread_mutex_destroy(&torneioPtr->filas[t].trava);
+    }
+    free(torneioPtr->filas);
+    torneioPtr->filas = NULL;
+    free(tarefas);
+    free(threads);
+    free(trabalhadores);
+    return 1;
+}
+
+/// Fração contínua da beta incompleta regularizada (método de Lentz)
+static double fracaoBetaIncompleta(double a, double b, double x) {
+    const double minimo = 1e-300;
+    double c = 1.0, d = 1.0 - (a + b) * x / (a + 1.0);
+    d = fabs(d) < minimo ? minimo : d;
+    d = 1.0 / d;
+    double h = d;
+    for (int m = 1; m <= 300; m++) {
+        double m2 = 2.0 * m;
+        double termo = m * (b - m) * x / ((a + m2 - 1.0) * (a + m2));
+        d = 1.0 + termo * d;
+        d = fabs(d) < minimo ? minimo : d;
+        c = 1.0 + termo / c;
+        c = fabs(c) < minimo ? minimo : c;
+        d = 1.0 / d;
+        h *= d * c;
+        termo = -(a + m) * (a + b + m) * x / ((a + m2) * (a + m2 + 1.0));
+        d = 1.0 + termo * d;
+        d = fabs(d) < minimo ? minimo : d;
+        c = 1.0 + termo / c;
+        c = fabs(c) < minimo ? minimo : c;
+        d = 1.0 / d;
+        double delta = d * c;
+        h *= delta;
+        if (fabs(delta - 1.0) < 1e-12) {
+            break;
+        }
+    }
+    return h;
+}
+
+/**
+ * @brief Probabilidade bilateral de |T| >= |t| na distribuição t de Student
+ * @param t Estatística t
+ * @param grausLiberdade Graus de liberdade (>= 1)
+ * @return Valor p
+ */
+double probabilidadeTStudent(double t, int grausLiberdade) {
+    if (grausLiberdade < 1 || isnan(t)) {
+        return 1.0;
+    }
+    if (isinf(t)) {
+        return 0.0;
+    }
+    double v = grausLiberdade, x = v / (v + t * t);
+    double a = v / 2.0, b = 0.5;
+    double fator = exp(lgamma(a + b) - lgamma(a) - lgamma(b) + a * log(x) + b * log1p(-x));
+    // I_x(a, b) pela fração no lado em que ela converge rápido
+    return x < (a + 1.0) / (a + b + 2.0) ? fator * fracaoBetaIncompleta(a, b, x) / a
+                                         : 1.0 - fator * fracaoBetaIncompleta(b, a, 1.0 - x) / b;
+}
+
+/**
+ * @brief Valor crítico bilateral da t de Student (p = 0,05 dá o intervalo de 95%)
+ * @param p Probabilidade bilateral
+ * @param grausLiberdade Graus de liberdade
+ * @return t tal que probabilidadeTStudent(t) = p
+ */
+double criticoTStudent(double p, int grausLiberdade) {
+    double baixo = 0.0, alto = 1000.0;
+    for (int i = 0; i < 100; i++) {
+        double meio = (baixo + alto) / 2.0;
+        if (probabilidadeTStudent(meio, grausLiberdade) > p) {
+            baixo = meio;
+        } else {
+            alto = meio;
+        }
+    }
+    return (baixo + alto) / 2.0;
+}
+
+/// Média e desvio padrão amostral
+static void mediaDesvioTorneio(const double* valores, int quantidade, double* mediaPtr, double* desvioPtr) {
+    double soma = 0.0, quadrados = 0.0;
+    for (int i = 0; i < quantidade; i++) {
+        soma += valores[i];
+    }
+    double media = quantidade > 0 ? soma / quantidade : 0.0;
+    for (int i = 0; i < quantidade; i++) {
+        quadrados += (valores[i] - media) * (valores[i] - media);
+    }
+    *mediaPtr = media;
+    *desvioPtr = quantidade > 1 ? sqrt(quadrados / (quantidade - 1)) : 0.0;
+}
+
+/**
+ * @brief Imprime a tabela de resultados e as comparações entre participantes
+ * @param torneioPtr Torneio já executado
+ * @param saida Destino do relatório
+ *
+ * Para cada participante: média da pontuação com intervalo de confiança de
+ * 95% (t de Student), peças, linhas e nível médios. Como todos jogam as
+ * mesmas sequências, cada par é comparado com o teste t pareado sobre a
+ * diferença de pontuação em cada sequência, que desconta a sorte da
+ * sequência e precisa de muito menos partidas que comparar as médias.
+ */
+void exibirResultadosTorneio(const Torneio* torneioPtr, FILE* saida) {
+    int m = torneioPtr->quantidadeSequencias;
+    double* valores = malloc(sizeof(double) * (size_t)(m > 0 ? m : 1));
+    double critico = m > 1 ? criticoTStudent(0.05, m - 1) : 0.0;
+    fprintf(saida, "%-16s %12s %12s %9s %9s %7s %8s\n", "Participante", "Pontuacao", "IC 95% +/-", "Pecas",
+            "Linhas", "Nivel", "s/jogo");
+    for (int p = 0; p < torneioPtr->quantidadeParticipantes; p++) {
+        const ResultadoJogoTorneio* jogos = &torneioPtr->resultados[(long)p * m];
+        double media, desvio, pecas = 0, linhas = 0, niveis = 0, segundos = 0;
+        for (int s = 0; s < m; s++) {
+            valores[s] = jogos[s].pontuacao;
+            pecas += jogos[s].pecasJogadas;
+            linhas += jogos[s].linhasEliminadas;
+            niveis += jogos[s].nivel;
+            segundos += jogos[s].segundos;
+        }
+        mediaDesvioTorneio(valores, m, &media, &desvio);
+        fprintf(saida, "%-16s %12.1f %12.1f %9.1f %9.1f %7.2f %8.3f\n", torneioPtr->participantes[p].nome, media,
+                m > 1 ? critico * desvio / sqrt(m) : 0.0, pecas / m, linhas / m, niveis / m, segundos / m);
+    }
+
+    if (torneioPtr->quantidadeParticipantes > 1 && m > 1) {
+        fprintf(saida, "\nComparacoes pareadas (mesmas %d sequencias):\n", m);
+        for (int a = 0; a < torneioPtr->quantidadeParticipantes; a++) {
+            for (int b = a + 1; b < torneioPtr->quantidadeParticipantes; b++) {
+                for (int s = 0; s < m; s++) {
+                    valores[s] = (double)torneioPtr->resultados[(long)a * m + s].pontuacao -
+                                 torneioPtr->resultados[(long)b * m + s].pontuacao;
+                }
+                double media, desvio;
+                mediaDesvioTorneio(valores, m, &media, &desvio);
+                double t = desvio > 0.0 ? media / (desvio / sqrt(m)) : (media == 0.0 ? 0.0 : INFINITY);
+                double p = probabilidadeTStudent(t, m - 1);
+                fprintf(saida, "  %s - %s: %+.1f (IC 95%% %+.1f a %+.1f) | t = %.2f | p = %.4g%s\n",
+                        torneioPtr->participantes[a].nome, torneioPtr->participantes[b].nome, media,
+                        media - critico * desvio / sqrt(m), media + critico * desvio / sqrt(m), t, p,
+                        p < 0.05 ? " *" : "");
+            }
+        }
+        fprintf(saida, "  (* diferenca significativa a 5%%)\n");
+    }
+    free(valores);
+}
+
+/**
+ * @brief Modo de linha de comando: torneio de configurações do bot
+ * @return Código de saída
+ *
+ * Uso: tetris --torneio [--config nome:chave=valor,...]... [--sequencias m]
+ *            [--semente s] [--pecas n] [--threads t] [--corpus arquivo]
+ *            [--arquivo-regras caminho]
+ *
+ * Sem --config, compara a configuração padrão com um feixe mais estreito.
+ * --threads 0 usa todos os núcleos disponíveis.
+ */
+int executarModoTorneio(int argc, char* argv[]) {
+    ParticipanteTorneio* participantes = calloc((size_t)argc + 2, sizeof(ParticipanteTorneio));
+    int quantidadeParticipantes = 0;
+    int quantidadeSequencias = 20, limitePecas = 500, numeroThreads = 0;
+    uint64_t sementeBase = 1;
+    const char* caminhoCorpus = NULL;
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--config") == 0 && i + 1 < argc) {
+            if (!lerParticipanteTorneio(argv[++i], &participantes[quantidadeParticipantes++])) {
+                free(participantes);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--sequencias") == 0 && i + 1 < argc) {
+            quantidadeSequencias = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--semente") == 0 && i + 1 < argc) {
+            sementeBase = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--pecas") == 0 && i + 1 < argc) {
+            limitePecas = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            numeroThreads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--corpus") == 0 && i + 1 < argc) {
+            caminhoCorpus = argv[++i];
+        } else if (strcmp(argv[i], "--arquivo-regras") == 0 && i + 1 < argc) {
+            if (carregarRegrasPontuacao(argv[++i]) < 0) {
+                free(participantes);
+                return 1;
+            }
+        }
+    }
+    if (quantidadeParticipantes == 0) {
+        char padrao[] = "padrao", estreito[] = "feixe4:largura=4";
+        lerParticipanteTorneio(padrao, &participantes[quantidadeParticipantes++]);
+        lerParticipanteTorneio(estreito, &participantes[quantidadeParticipantes++]);
+    }
+    if (quantidadeSequencias < 1) {
+        fprintf(stderr, "Informe ao menos uma sequencia\n");
+        free(participantes);
+        return 1;
+    }
+    if (numeroThreads <= 0) {
+        long nucleos = sysconf(_SC_NPROCESSORS_ONLN);
+        numeroThreads = nucleos > 0 ? (int)nucleos : 1;
+    }
+    CorpusSequencias corpus;
+    if (caminhoCorpus != NULL) {
+        if (!abrirCorpusSequencias(&corpus, caminhoCorpus)) {
+            free(participantes);
+            return 1;
+        }
+        for (int p = 0; p < quantidadeParticipantes; p++) {
+            participantes[p].config.corpus = &corpus;
+        }
+    }
+
+    saidaSilenciosa = 1;
+    Torneio torneio;
+    memset(&torneio, 0, sizeof(torneio));
+    torneio.participantes = participantes;
+    torneio.quantidadeParticipantes = quantidadeParticipantes;
+    torneio.quantidadeSequencias = quantidadeSequencias;
+    torneio.sementeBase = sementeBase;
+    torneio.limitePecas = limitePecas;
+    torneio.resultados = calloc((size_t)quantidadeParticipantes * (size_t)quantidadeSequencias,
+                                sizeof(ResultadoJogoTorneio));
+    int sucesso = torneio.resultados != NULL && executarTorneio(&torneio, numeroThreads);
+    if (sucesso) {
+        double somaPartidas = 0.0;
+        for (long i = 0; i < (long)quantidadeParticipantes * quantidadeSequencias; i++) {
+            somaPartidas += torneio.resultados[i].segundos;
+        }
+        printf("Torneio: %d participantes x %d sequencias (%s, sementes %llu..) | ate %d pecas | %d threads\n",
+               quantidadeParticipantes, quantidadeSequencias, caminhoCorpus != NULL ? caminhoCorpus : "gerador",
+               (unsigned long long)sementeBase, limitePecas, numeroThreads);
+        printf("Tempo: %.2fs (%.2fs somando as partidas) | %ld partidas roubadas\n\n", torneio.segundos,
+               somaPartidas, (long)atomic_load(&torneio.roubos));
+        exibirResultadosTorneio(&torneio, stdout);
+    }
+    free(torneio.resultados);
+    free(participantes);
+    if (caminhoCorpus != NULL) {
+        fecharCorpusSequencias(&corpus);
+    }
+    return sucesso ? 0 : 1;
+}
+
+// ═══════════════════════════════════════════════════════════════════════════════
+//                       AJUSTE DE PESOS (ALGORITMO GENÉTICO)
+// ═══════════════════════════════════════════════════════════════════════════════
+
+_Static_assert(sizeof(PesosAvaliacao) == GENES_AJUSTE * sizeof(double), "um gene por peso da avaliacao");
+
+/**
+ * @brief Preenche a configuração do ajuste com os valores padrão
+ * @param configPtr Configuração (saída); o bot base é o de configurarBotPadrao() com um feixe menor
+ */
+void configurarAjustePadrao(ConfigAjuste* configPtr) {
+    memset(configPtr, 0, sizeof(*configPtr));
+    configPtr->tamanhoPopulacao = 24;
+    configPtr->elite = 4;
+    configPtr->quantidadeSequencias = 8;
+    configPtr->limitePecas = 300;
+    configPtr->geracoes = 10;
+    configPtr->numeroThreads = 0;
+    configPtr->semente = 1;
+    configPtr->sigmaInicial = 0.15;
+    configPtr->decaimentoSigma = 0.9;
+    configPtr->pesoPontuacao = 1.0;
+    configPtr->pesoNivel = 10000.0;
+    configPtr->pesoCombo = 1000.0;
+    configurarBotPadrao(&configPtr->base);
+    configPtr->base.larguraFeixe = 4;
+    configPtr->base.profundidade = 2;
+}
+
+/// Número uniforme em [0, 1) do sorteio do ajuste (xorshift64*)
+static double sortearUniformeAjuste(uint64_t* estadoPtr) {
+    uint64_t x = *estadoPtr;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *estadoPtr = x;
+    return ((x * 0x2545F4914F6CDD1DULL) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/// Normal padrão (Box-Muller)
+static double sortearNormalAjuste(uint64_t* estadoPtr) {
+    double u = sortearUniformeAjuste(estadoPtr);
+    double v = sortearUniformeAjuste(estadoPtr);
+    return sqrt(-2.0 * log(1.0 - u)) * cos(2.0 * M_PI * v);
+}
+
+/**
+ * @brief Começa um ajuste do zero
+ * @param configPtr Configuração do ajuste
+ * @param estadoPtr Estado (saída)
+ *
+ * O indivíduo 0 são os pesos do bot base; os outros, os mesmos pesos com
+ * ruído normal de desvio sigmaInicial em cada gene.
+ */
+void iniciarEstadoAjuste(const ConfigAjuste* configPtr, EstadoAjuste* estadoPtr) {
+    memset(estadoPtr, 0, sizeof(*estadoPtr));
+    memcpy(estadoPtr->magica, "TETRISGA", sizeof(estadoPtr->magica));
+    estadoPtr->versao = VERSAO_AJUSTE;
+    estadoPtr->tamanhoPopulacao = (uint32_t)configPtr->tamanhoPopulacao;
+    estadoPtr->quantidadeSequencias = (uint32_t)configPtr->quantidadeSequencias;
+    estadoPtr->semente = configPtr->semente;
+    estadoPtr->estadoSorteio = configPtr->semente * 0x9E3779B97F4A7C15ULL + 0x2545F4914F6CDD1DULL;
+    estadoPtr->sigma = configPtr->sigmaInicial;
+    estadoPtr->melhor = configPtr->base.pesos;
+    estadoPtr->aptidaoMelhor = -INFINITY;
+    for (int i = 0; i < configPtr->tamanhoPopulacao; i++) {
+        double genes[GENES_AJUSTE];
+        memcpy(genes, &configPtr->base.pesos, sizeof(genes));
+        for (int g = 0; i > 0 && g < GENES_AJUSTE; g++) {
+            genes[g] += configPtr->sigmaInicial * sortearNormalAjuste(&estadoPtr->estadoSorteio);
+        }
+        memcpy(&estadoPtr->populacao[i], genes, sizeof(genes));
+    }
+}
+
+/**
+ * @brief Grava o estado do ajuste (substituído de uma vez, via arquivo temporário)
+ * @return 1 em caso de sucesso, 0 em caso de falha (mensagem em stderr)
+ */
+int gravarCheckpointAjuste(const char* caminho, const EstadoAjuste* estadoPtr) {
+    char temporario[4096];
+    snprintf(temporario, sizeof(temporario), "%s.tmp", caminho);
+    FILE* arquivo = fopen(temporario, "wb");
+    int gravou = arquivo != NULL && fwrite(estadoPtr, sizeof(*estadoPtr), 1, arquivo) == 1;
+    if (arquivo != NULL) {
+        gravou = fflush(arquivo) == 0 && fdatasync(fileno(arquivo)) == 0 && gravou;
+        gravou = fclose(arquivo) == 0 && gravou;
+    }
+    gravou = gravou && rename(temporario, caminho) == 0;
+    if (!gravou) {
+        fprintf(stderr, "Falha ao gravar o checkpoint %s: %s\n", caminho, strerror(errno));
+        unlink(temporario);
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief Lê o estado de um ajuste interrompido
+ * @param caminho Arquivo gravado por gravarCheckpointAjuste()
+ * @param configPtr Configuração atual: população, sequências e semente precisam ser as mesmas
+ * @param estadoPtr Estado (saída)
+ * @return 1 se carregou, 0 se o arquivo não existe, -1 se é inválido ou de outra configuração
+ */
+int carregarCheckpointAjuste(const char* caminho, const ConfigAjuste* configPtr, EstadoAjuste* estadoPtr) {
+    FILE* arquivo = fopen(caminho, "rb");
+    if (arquivo == NULL) {
+        return errno == ENOENT ? 0 : -1;
+    }
+    int lido = fread(estadoPtr, sizeof(*estadoPtr), 1, arquivo) == 1;
+    fclose(arquivo);
+    if (!lido || memcmp(estadoPtr->magica, "TETRISGA", sizeof(estadoPtr->magica)) != 0 ||
+        estadoPtr->versao != VERSAO_AJUSTE) {
+        fprintf(stderr, "Checkpoint invalido: %s\n", caminho);
+        return -1;
+    }
+    if (estadoPtr->tamanhoPopulacao != (uint32_t)configPtr->tamanhoPopulacao ||
+        estadoPtr->quantidadeSequencias != (uint32_t)configPtr->quantidadeSequencias ||
+        estadoPtr->semente != configPtr->semente) {
+        fprintf(stderr, "Checkpoint %s e de outra configuracao (populacao %u, sequencias %u, semente %llu)\n",
+                caminho, estadoPtr->tamanhoPopulacao, estadoPtr->quantidadeSequencias,
+                (unsigned long long)estadoPtr->semente);
+        return -1;
+    }
+    return 1;
+}
+
+/// Índice de um indivíduo por torneio de 3 (aptidões maiores vencem)
+static int selecionarIndividuoAjuste(const double* aptidoes, int tamanho, uint64_t* sorteioPtr) {
+    int vencedor = (int)(sortearUniformeAjuste(sorteioPtr) * tamanho);
+    for (int k = 1; k < 3; k++) {
+        int candidato = (int)(sortearUniformeAjuste(sorteioPtr) * tamanho);
+        if (aptidoes[candidato] > aptidoes[vencedor]) {
+            vencedor = candidato;
+        }
+    }
+    return vencedor;
+}
+
+/**
+ * @brief Joga uma geração e forma a próxima
+ * @param configPtr Configuração do ajuste
+ * @param estadoPtr Estado; avança uma geração
+ * @param relatorioPtr Aptidões e tempo da geração jogada (saída)
+ * @return 1 em caso de sucesso, 0 se o torneio não pôde rodar
+ *
+ * Todos os indivíduos jogam as mesmas sequências (números aleatórios
+ * comuns), e a diferença entre eles não depende da sorte das peças; as
+ * sequências mudam a cada geração para os pesos não decorarem um conjunto.
+ * A aptidão é a média de pesoPontuacao x pontuação + pesoNivel x nível +
+ * pesoCombo x melhor combo. A elite passa intacta (e é jogada de novo nas
+ * sequências seguintes); o resto vem de pais escolhidos por torneio de 3,
+ * cruzamento BLX-0,25 gene a gene e mutação normal de desvio sigma, que
+ * decai a cada geração.
+ */
+int executarGeracaoAjuste(const ConfigAjuste* configPtr, EstadoAjuste* estadoPtr,
+                          RelatorioGeracaoAjuste* relatorioPtr) {
+    int tamanho = configPtr->tamanhoPopulacao, sequencias = configPtr->quantidadeSequencias;
+    ParticipanteTorneio participantes[MAX_POPULACAO_AJUSTE];
+    for (int i = 0; i < tamanho; i++) {
+        snprintf(participantes[i].nome, sizeof(participantes[i].nome), "g%u-%d", estadoPtr->geracao, i);
+        participantes[i].config = configPtr->base;
+        participantes[i].config.pesos = estadoPtr->populacao[i];
+    }
+    Torneio torneio;
+    memset(&torneio, 0, sizeof(torneio));
+    torneio.participantes = participantes;
+    torneio.quantidadeParticipantes = tamanho;
+    torneio.quantidadeSequencias = sequencias;
+    torneio.sementeBase = configPtr->semente + (uint64_t)estadoPtr->geracao * (uint64_t)sequencias;
+    torneio.limitePecas = configPtr->limitePecas;
+    torneio.resultados = calloc((size_t)tamanho * (size_t)sequencias, sizeof(ResultadoJogoTorneio));
+    if (torneio.resultados == NULL || !executarTorneio(&torneio, configPtr->numeroThreads)) {
+        free(torneio.resultados);
+        return 0;
+    }
+
+    double aptidoes[MAX_POPULACAO_AJUSTE];
+    int ordem[MAX_POPULACAO_AJUSTE];
+    double soma = 0.0;
+    for (int i = 0; i < tamanho; i++) {
+        double total = 0.0;
+        for (int s = 0; s < sequencias; s++) {
+            const ResultadoJogoTorneio* jogoPtr = &torneio.resultados[(long)i * sequencias + s];
+            total += configPtr->pesoPontuacao * jogoPtr->pontuacao + configPtr->pesoNivel * jogoPtr->nivel +
+                     configPtr->pesoCombo * jogoPtr->melhorCombo;
+        }
+        aptidoes[i] = total / sequencias;
+        soma += aptidoes[i];
+        ordem[i] = i;
+    }
+    free(torneio.resultados);
+    // Ordem decrescente de aptidão; empates pelo índice, para o resultado não depender do qsort
+    for (int i = 1; i < tamanho; i++) {
+        int atual = ordem[i], j = i;
+        while (j > 0 && aptidoes[ordem[j - 1]] < aptidoes[atual]) {
+            ordem[j] = ordem[j - 1];
+            j--;
+        }
+        ordem[j] = atual;
+    }
+
+    relatorioPtr->melhorAptidao = aptidoes[ordem[0]];
+    relatorioPtr->aptidaoMedia = soma / tamanho;
+    relatorioPtr->melhor = estadoPtr->populacao[ordem[0]];
+    relatorioPtr->partidas = (long)tamanho * sequencias;
+    relatorioPtr->segundos = torneio.segundos;
+    relatorioPtr->numeroThreads = torneio.numeroThreads;
+    estadoPtr->aptidaoMelhor = aptidoes[ordem[0]];
+    estadoPtr->melhor = estadoPtr->populacao[ordem[0]];
+
+    PesosAvaliacao proxima[MAX_POPULACAO_AJUSTE];
+    int elite = configPtr->elite < tamanho ? configPtr->elite : tamanho;
+    for (int i = 0; i < elite; i++) {
+        proxima[i] = estadoPtr->populacao[ordem[i]];
+    }
+    for (int i = elite; i < tamanho; i++) {
+        int pai = selecionarIndividuoAjuste(aptidoes, tamanho, &estadoPtr->estadoSorteio);
+        int mae = selecionarIndividuoAjuste(aptidoes, tamanho, &estadoPtr->estadoSorteio);
+        double genesPai[GENES_AJUSTE], genesMae[GENES_AJUSTE], filho[GENES_AJUSTE];
+        memcpy(genesPai, &estadoPtr->populacao[pai], sizeof(genesPai));
+        memcpy(genesMae, &estadoPtr->populacao[mae], sizeof(genesMae));
+        for (int g = 0; g < GENES_AJUSTE; g++) {
+            double mistura = -0.25 + 1.5 * sortearUniformeAjuste(&estadoPtr->estadoSorteio);
+            filho[g] = genesPai[g] + mistura * (genesMae[g] - genesPai[g]) +
+                       estadoPtr->sigma * sortearNormalAjuste(&estadoPtr->estadoSorteio);
+        }
+        memcpy(&proxima[i], filho, sizeof(filho));
+    }
+    memcpy(estadoPtr->populacao, proxima, sizeof(PesosAvaliacao) * (size_t)tamanho);
+    estadoPtr->sigma *= configPtr->decaimentoSigma;
+    estadoPtr->geracao++;
+    estadoPtr->partidasJogadas += (uint64_t)relatorioPtr->partidas;
+    estadoPtr->segundosJogando += torneio.segundos;
+    return 1;
+}
+
+/// Imprime os seis pesos na ordem de PesosAvaliacao
+static void exibirPesosAjuste(const char* rotulo, const PesosAvaliacao* pesosPtr) {
+    printf("%s altura=%.4f,buracos=%.4f,irregularidade=%.4f,pocos=%.4f,transicoes=%.4f,linhas=%.4f\n", rotulo,
+           pesosPtr->pesoAltura, pesosPtr->pesoBuracos, pesosPtr->pesoIrregularidade, pesosPtr->pesoPocos,
+           pesosPtr->pesoTransicoes, pesosPtr->pesoLinhas);
+}
+
+/**
+ * @brief Modo de linha de comando: ajuste dos pesos da avaliação
+ * @return Código de saída
+ *
+ * Uso: tetris --ajustar-pesos [--populacao n] [--elite n] [--sequencias m]
+ *            [--pecas n] [--geracoes g] [--threads t] [--semente s]
+ *            [--sigma x] [--aptidao pontuacao,nivel,combo] [--largura n]
+ *            [--profundidade n] [--gerador modo] [--checkpoint arquivo]
+ *
+ * Com --checkpoint, o estado é gravado ao fim de cada geração e, se o
+ * arquivo já existe, o ajuste continua de onde parou até completar as
+ * --geracoes pedidas. A linha "melhores pesos" pode ser colada em
+ * --torneio --config nome:...
+ */
+int executarModoAjuste(int argc, char* argv[]) {
+    ConfigAjuste config;
+    configurarAjustePadrao(&config);
+    const char* caminhoCheckpoint = NULL;
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--populacao") == 0 && i + 1 < argc) {
+            config.tamanhoPopulacao = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--elite") == 0 && i + 1 < argc) {
+            config.elite = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--sequencias") == 0 && i + 1 < argc) {
+            config.quantidadeSequencias = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--pecas") == 0 && i + 1 < argc) {
+            config.limitePecas = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--geracoes") == 0 && i + 1 < argc) {
+            config.geracoes = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            config.numeroThreads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--semente") == 0 && i + 1 < argc) {
+            config.semente = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--sigma") == 0 && i + 1 < argc) {
+            config.sigmaInicial = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--aptidao") == 0 && i + 1 < argc) {
+            if (sscanf(argv[++i], "%lf,%lf,%lf", &config.pesoPontuacao, &config.pesoNivel, &config.pesoCombo) != 3) {
+                fprintf(stderr, "Use --aptidao pontuacao,nivel,combo (ex.: 1,10000,1000)\n");
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--largura") == 0 && i + 1 < argc) {
+            config.base.larguraFeixe = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--profundidade") == 0 && i + 1 < argc) {
+            config.base.profundidade = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--gerador") == 0 && i + 1 < argc) {
+            if ((config.base.modoGerador = buscarModoGerador(argv[++i])) < 0) {
+                fprintf(stderr, "Gerador desconhecido: %s (uniforme ou saco7)\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--checkpoint") == 0 && i + 1 < argc) {
+            caminhoCheckpoint = argv[++i];
+        }
+    }
+    if (config.tamanhoPopulacao < 2 || config.tamanhoPopulacao > MAX_POPULACAO_AJUSTE ||
+        config.quantidadeSequencias < 1 || config.elite < 0) {
+        fprintf(stderr, "Populacao de 2 a %d, ao menos uma sequencia e elite nao negativa\n", MAX_POPULACAO_AJUSTE);
+        return 1;
+    }
+    long nucleos = sysconf(_SC_NPROCESSORS_ONLN);
+    if (config.numeroThreads <= 0) {
+        config.numeroThreads = nucleos > 0 ? (int)nucleos : 1;
+    }
+
+    static EstadoAjuste estado;
+    int carregado = caminhoCheckpoint != NULL ? carregarCheckpointAjuste(caminhoCheckpoint, &config, &estado) : 0;
+    if (carregado < 0) {
+        return 1;
+    }
+    if (carregado == 0) {
+        iniciarEstadoAjuste(&config, &estado);
+    }
+    saidaSilenciosa = 1;
+    printf("Ajuste de pesos: populacao %d (elite %d) x %d sequencias | ate %d pecas | feixe %d, profundidade %d | "
+           "%d threads\n", config.tamanhoPopulacao, config.elite, config.quantidadeSequencias, config.limitePecas,
+           config.base.larguraFeixe, config.base.profundidade, config.numeroThreads);
+    printf("Aptidao: %.4g x pontuacao + %.4g x nivel + %.4g x melhor combo\n", config.pesoPontuacao,
+           config.pesoNivel, config.pesoCombo);
+    if (carregado) {
+        printf("Retomado de %s: %u geracoes, %llu partidas ja jogadas\n", caminhoCheckpoint, estado.geracao,
+               (unsigned long long)estado.partidasJogadas);
+    }
+
+    while (estado.geracao < (uint32_t)config.geracoes) {
+        RelatorioGeracaoAjuste relatorio;
+        uint32_t geracao = estado.geracao;
+        double sigma = estado.sigma;
+        if (!executarGeracaoAjuste(&config, &estado, &relatorio)) {
+            return 1;
+        }
+        double porSegundo = relatorio.segundos > 0 ? relatorio.partidas / relatorio.segundos : 0.0;
+        int nucleosUsados = relatorio.numeroThreads < nucleos || nucleos < 1 ? relatorio.numeroThreads : (int)nucleos;
+        printf("Geracao %u: melhor %.1f | media %.1f | sigma %.4f | %ld partidas em %.2fs | %.1f partidas/s "
+               "(%.1f por nucleo)\n", geracao + 1, relatorio.melhorAptidao, relatorio.aptidaoMedia,
+               sigma, relatorio.partidas, relatorio.segundos, porSegundo,
+               porSegundo / nucleosUsados);
+        exibirPesosAjuste("  melhor da geracao:", &relatorio.melhor);
+        if (caminhoCheckpoint != NULL && !gravarCheckpointAjuste(caminhoCheckpoint, &estado)) {
+            return 1;
+        }
+    }
+    printf("Total: %llu partidas em %.1fs de jogo | melhor da ultima geracao %.1f\n",
+           (unsigned long long)estado.partidasJogadas, estado.segundosJogando, estado.aptidaoMelhor);
+    exibirPesosAjuste("Melhores pesos:", &estado.melhor);
+    return 0;
+}
+
+// ═══════════════════════════════════════════════════════════════════════════════
+//                       REPLAYS COM QUADROS-CHAVE
+// ═══════════════════════════════════════════════════════════════════════════════
+
+/**
+ * @brief Começa a gravar o replay de uma partida do bot
+ * @param gravadorPtr Gravador (saída)
+ * @param caminho Arquivo a criar
+ * @param configPtr Bot da partida (capacidades, regras e modo do gerador)
+ * @param semente Semente da partida
+ * @param intervaloQuadros Ações entre quadros-chave (0 = INTERVALO_QUADROS_PADRAO)
+ * @return 1 em caso de sucesso, 0 em caso de falha (mensagem em stderr)
+ */
+int abrirGravacaoReplay(GravadorReplay* gravadorPtr, const char* caminho, const ConfigBot* configPtr,
+                        uint64_t semente, int intervaloQuadros) {
+    memset(gravadorPtr, 0, sizeof(*gravadorPtr));
+    gravadorPtr->intervaloQuadros = intervaloQuadros > 0 ? (uint32_t)intervaloQuadros : INTERVALO_QUADROS_PADRAO;
+    gravadorPtr->arquivo = fopen(caminho, "wb");
+    if (gravadorPtr->arquivo == NULL) {
+        fprintf(stderr, "Nao foi possivel criar o replay %s: %s\n", caminho, strerror(errno));
+        return 0;
+    }
+    CabecalhoReplay cabecalho;
+    memset(&cabecalho, 0, sizeof(cabecalho));
+    memcpy(cabecalho.magica, "TETRISRP", sizeof(cabecalho.magica));
+    cabecalho.versao = VERSAO_REPLAY;
+    cabecalho.intervaloQuadros = gravadorPtr->intervaloQuadros;
+    cabecalho.semente = semente;
+    cabecalho.capacidadeFila = configPtr->capacidadeFila;
+    cabecalho.capacidadePilha = configPtr->capacidadePilha;
+    cabecalho.regrasPontuacao = (uint8_t)configPtr->regrasPontuacao;
+    cabecalho.modoGerador = (uint8_t)configPtr->modoGerador;
+    gravadorPtr->falhou = fwrite(&cabecalho, sizeof(cabecalho), 1, gravadorPtr->arquivo) != 1;
+    gravadorPtr->deslocamento = sizeof(cabecalho);
+    return 1;
+}
+
+static void escreverReplay(GravadorReplay* gravadorPtr, const void* dados, size_t tamanho) {
+    if (!gravadorPtr->falhou && fwrite(dados, 1, tamanho, gravadorPtr->arquivo) != tamanho) {
+        gravadorPtr->falhou = 1;
+    }
+    gravadorPtr->deslocamento += tamanho;
+}
+
+/// Grava o estado completo da partida como quadro-chave e o acrescenta ao índice
+static void gravarQuadroChaveReplay(GravadorReplay* gravadorPtr, const EstadoPartidaBot* partidaPtr) {
+    if (gravadorPtr->quantidadeIndice == gravadorPtr->capacidadeIndice) {
+        size_t capacidade = gravadorPtr->capacidadeIndice > 0 ? gravadorPtr->capacidadeIndice * 2 : 64;
+        EntradaIndiceReplay* indice = realloc(gravadorPtr->indice, sizeof(EntradaIndiceReplay) * capacidade);
+        if (indice == NULL) {
+            gravadorPtr->falhou = 1;
+            return;
+        }
+        gravadorPtr->indice = indice;
+        gravadorPtr->capacidadeIndice = capacidade;
+    }
+    EntradaIndiceReplay* entradaPtr = &gravadorPtr->indice[gravadorPtr->quantidadeIndice++];
+    entradaPtr->jogada = gravadorPtr->jogadas;
+    entradaPtr->deslocamento = gravadorPtr->deslocamento;
+
+    QuadroChaveReplay quadro;
+    memset(&quadro, 0, sizeof(quadro));
+    quadro.marca = MARCA_QUADRO_REPLAY;
+    quadro.jogada = gravadorPtr->jogadas;
+    quadro.quantidadeFila = partidaPtr->fila.quantidadePecas;
+    quadro.quantidadePilha = partidaPtr->pilha.quantidadeReservada;
+    quadro.pecasJogadas = partidaPtr->pecasJogadas;
+    quadro.linhasEliminadas = partidaPtr->linhasEliminadas;
+    quadro.acoesReserva = partidaPtr->acoesReserva;
+    quadro.tamanho = (uint32_t)(sizeof(quadro) + sizeof(SistemaExpert) + sizeof(Tabuleiro) + sizeof(GeradorPecas) +
+                                sizeof(Peca) * (size_t)(quadro.quantidadeFila + quadro.quantidadePilha));
+    SistemaExpert sistema = partidaPtr->sistema;
+    sincronizarSistemaExpert(&sistema);
+    escreverReplay(gravadorPtr, &quadro, sizeof(quadro));
+    escreverReplay(gravadorPtr, &sistema, sizeof(sistema));
+    escreverReplay(gravadorPtr, &partidaPtr->tabuleiro, sizeof(partidaPtr->tabuleiro));
+    escreverReplay(gravadorPtr, &partidaPtr->gerador, sizeof(partidaPtr->gerador));
+    unsigned char peca[sizeof(Peca)];
+    for (int i = 0; i < quadro.quantidadeFila; i++) {
+        normalizarPecaWal(peca, espiarFila(&partidaPtr->fila, i));
+        escreverReplay(gravadorPtr, peca, sizeof(peca));
+    }
+    for (int i = quadro.quantidadePilha - 1; i >= 0; i--) {
+        normalizarPecaWal(peca, espiarPilha(&partidaPtr->pilha, i));
+        escreverReplay(gravadorPtr, peca, sizeof(peca));
+    }
+}
+
+/**
+ * @brief Grava a próxima ação, precedida de um quadro-chave quando é a vez
+ * @param gravadorPtr Gravador aberto
+ * @param partidaPtr Estado da partida antes da ação
+ * @param acaoPtr Ação que será aplicada
+ */
+void registrarAcaoReplay(GravadorReplay* gravadorPtr, const EstadoPartidaBot* partidaPtr, const AcaoBot* acaoPtr) {
+    if (gravadorPtr->jogadas % gravadorPtr->intervaloQuadros == 0) {
+        gravarQuadroChaveReplay(gravadorPtr, partidaPtr);
+    }
+    RegistroAcaoReplay registro;
+    memset(&registro, 0, sizeof(registro));
+    registro.acao = (uint8_t)acaoPtr->tipo;
+    if (acaoPtr->tipo != ACAO_RESERVAR) {
+        registro.tipo = acaoPtr->jogada.tipo;
+        registro.rotacao = acaoPtr->jogada.rotacao;
+        registro.coluna = acaoPtr->jogada.coluna;
+        registro.linha = acaoPtr->jogada.linha;
+        registro.origem = acaoPtr->jogada.origem;
+        registro.viaDeslize = acaoPtr->jogada.viaDeslize;
+    }
+    escreverReplay(gravadorPtr, &registro, sizeof(registro));
+    gravadorPtr->jogadas++;
+}
+
+/**
+ * @brief Termina o replay: grava o índice dos quadros e o rodapé
+ * @param gravadorPtr Gravador aberto (liberado mesmo em caso de falha)
+ * @return 1 se o arquivo inteiro foi gravado, 0 caso contrário
+ */
+int fecharGravacaoReplay(GravadorReplay* gravadorPtr) {
+    RodapeReplay rodape;
+    memset(&rodape, 0, sizeof(rodape));
+    memcpy(rodape.magica, "TETRISIX", sizeof(rodape.magica));
+    rodape.quantidadeQuadros = gravadorPtr->quantidadeIndice;
+    rodape.deslocamentoIndice = gravadorPtr->deslocamento;
+    rodape.totalJogadas = gravadorPtr->jogadas;
+    if (gravadorPtr->quantidadeIndice > 0) {
+        escreverReplay(gravadorPtr, gravadorPtr->indice, sizeof(EntradaIndiceReplay) * gravadorPtr->quantidadeIndice);
+    }
+    escreverReplay(gravadorPtr, &rodape, sizeof(rodape));
+    int gravou = !gravadorPtr->falhou;
+    if (gravadorPtr->arquivo != NULL) {
+        gravou = fclose(gravadorPtr->arquivo) == 0 && gravou;
+    }
+    if (!gravou) {
+        fprintf(stderr, "Falha ao gravar o replay: %s\n", strerror(errno));
+    }
+    free(gravadorPtr->indice);
+    memset(gravadorPtr, 0, sizeof(*gravadorPtr));
+    return gravou;
+}
+
+/**
+ * @brief Mapeia um replay só para leitura
+ * @param arquivoPtr Replay a inicializar
+ * @param caminho Arquivo gravado por fecharGravacaoReplay()
+ * @return 1 em caso de sucesso, 0 se o arquivo não existe, está incompleto ou não é reconhecido
+ *
+ * Cabeçalho, rodapé e índice são conferidos aqui; cada quadro-chave é
+ * conferido quando é carregado.
+ */
+int abrirArquivoReplay(ArquivoReplay* arquivoPtr, const char* caminho) {
+    memset(arquivoPtr, 0, sizeof(*arquivoPtr));
+    int descritor = open(caminho, O_RDONLY | O_CLOEXEC);
+    struct stat informacoes;
+    if (descritor < 0 || fstat(descritor, &informacoes) != 0) {
+        fprintf(stderr, "Nao foi possivel abrir o replay %s: %s\n", caminho, strerror(errno));
+        if (descritor >= 0) {
+            close(descritor);
+        }
+        return 0;
+    }
+    size_t tamanho = (size_t)informacoes.st_size;
+    void* regiao = tamanho >= sizeof(CabecalhoReplay) + sizeof(RodapeReplay)
+                   ? mmap(NULL, tamanho, PROT_READ, MAP_PRIVATE, descritor, 0) : MAP_FAILED;
+    close(descritor);
+    const CabecalhoReplay* cabecalhoPtr = regiao;
+    const RodapeReplay* rodapePtr = regiao != MAP_FAILED
+                                    ? (const RodapeReplay*)((const unsigned char*)regiao + tamanho - sizeof(RodapeReplay))
+                                    : NULL;
+    int valido = regiao != MAP_FAILED && memcmp(cabecalhoPtr->magica, "TETRISRP", sizeof(cabecalhoPtr->magica)) == 0 &&
+                 cabecalhoPtr->versao == VERSAO_REPLAY && cabecalhoPtr->intervaloQuadros > 0 &&
+                 memcmp(rodapePtr->magica, "TETRISIX", sizeof(rodapePtr->magica)) == 0 &&
+                 rodapePtr->deslocamentoIndice >= sizeof(CabecalhoReplay) &&
+                 rodapePtr->quantidadeQuadros <= tamanho / sizeof(EntradaIndiceReplay) &&
+                 rodapePtr->deslocamentoIndice + sizeof(EntradaIndiceReplay) * rodapePtr->quantidadeQuadros +
+                     sizeof(RodapeReplay) == tamanho;
+    if (!valido) {
+        fprintf(stderr, "Replay %s nao reconhecido (formato ou versao diferente, ou gravacao interrompida)\n", caminho);
+        if (regiao != MAP_FAILED) {
+            munmap(regiao, tamanho);
+        }
+        return 0;
+    }
+    arquivoPtr->mapa = regiao;
+    arquivoPtr->tamanho = tamanho;
+    arquivoPtr->cabecalho = cabecalhoPtr;
+    arquivoPtr->indice = (const EntradaIndiceReplay*)(arquivoPtr->mapa + rodapePtr->deslocamentoIndice);
+    arquivoPtr->rodape = rodapePtr;
+    return 1;
+}
+
+/**
+ * @brief Desfaz o mapeamento do replay
+ */
+void fecharArquivoReplay(ArquivoReplay* arquivoPtr) {
+    if (arquivoPtr->mapa != NULL) {
+        munmap((void*)arquivoPtr->mapa, arquivoPtr->tamanho);
+    }
+    memset(arquivoPtr, 0, sizeof(*arquivoPtr));
+}
+
+/**
+ * @brief Restaura a partida de um quadro-chave
+ * @return Deslocamento da primeira ação depois do quadro, ou 0 se o quadro é inválido
+ */
+static uint64_t carregarQuadroChaveReplay(const ArquivoReplay* arquivoPtr, uint64_t deslocamento,
+                                          EstadoPartidaBot* partidaPtr) {
+    uint64_t limite = arquivoPtr->rodape->deslocamentoIndice;
+    QuadroChaveReplay quadro;
+    if (deslocamento + sizeof(quadro) > limite) {
+        return 0;
+    }
+    memcpy(&quadro, arquivoPtr->mapa + deslocamento, sizeof(quadro));
+    const CabecalhoReplay* cabecalhoPtr = arquivoPtr->cabecalho;
+    if (quadro.marca != MARCA_QUADRO_REPLAY || quadro.quantidadeFila < 0 ||
+        quadro.quantidadeFila > cabecalhoPtr->capacidadeFila || quadro.quantidadePilha < 0 ||
+        quadro.quantidadePilha > cabecalhoPtr->capacidadePilha ||
+        quadro.tamanho != sizeof(quadro) + sizeof(SistemaExpert) + sizeof(Tabuleiro) + sizeof(GeradorPecas) +
+                          sizeof(Peca) * (size_t)(quadro.quantidadeFila + quadro.quantidadePilha) ||
+        deslocamento + quadro.tamanho > limite) {
+        return 0;
+    }
+    const unsigned char* dados = arquivoPtr->mapa + deslocamento + sizeof(quadro);
+    memcpy(&partidaPtr->sistema, dados, sizeof(SistemaExpert));
+    dados += sizeof(SistemaExpert);
+    memcpy(&partidaPtr->tabuleiro, dados, sizeof(Tabuleiro));
+    dados += sizeof(Tabuleiro);
+    memcpy(&partidaPtr->gerador, dados, sizeof(GeradorPecas));
+    dados += sizeof(GeradorPecas);
+
+    liberarFila(&partidaPtr->fila);
+    inicializarFila(&partidaPtr->fila);
+    liberarPilha(&partidaPtr->pilha);
+    inicializarPilha(&partidaPtr->pilha);
+    configurarCapacidadeFila(&partidaPtr->fila, cabecalhoPtr->capacidadeFila);
+    configurarCapacidadePilha(&partidaPtr->pilha, cabecalhoPtr->capacidadePilha);
+    for (int i = 0; i < quadro.quantidadeFila + quadro.quantidadePilha; i++) {
+        Peca peca;
+        memcpy(&peca, dados, sizeof(peca));
+        dados += sizeof(peca);
+        if (i < quadro.quantidadeFila) {
+            inserirPecaNaFila(&partidaPtr->fila, peca);
+        } else {
+            reservarPeca(&partidaPtr->pilha, peca);
+        }
+    }
+    partidaPtr->pecasJogadas = quadro.pecasJogadas;
+    partidaPtr->linhasEliminadas = quadro.linhasEliminadas;
+    partidaPtr->acoesReserva = quadro.acoesReserva;
+    partidaPtr->acoes = quadro.jogada;
+    return deslocamento + quadro.tamanho;
+}
+
+/**
+ * @brief Reconstrói a partida depois de um número de ações do replay
+ * @param arquivoPtr Replay aberto
+ * @param jogada Ações a aplicar (0 = início; até o total gravado)
+ * @param partidaPtr Partida (saída; inicializada aqui, liberar com liberarPartidaBot())
+ * @param usarQuadros 1 = parte do último quadro-chave antes da jogada;
+ *                    0 = reaplica desde o início (referência para conferir)
+ * @return 1 em caso de sucesso, 0 se a jogada não existe ou o arquivo é inválido
+ *
+ * O quadro é achado por busca binária no índice, e só as ações entre ele
+ * e a jogada pedida são reaplicadas: no máximo intervaloQuadros - 1,
+ * qualquer que seja o tamanho do replay.
+ */
+int buscarJogadaReplay(const ArquivoReplay* arquivoPtr, uint64_t jogada, EstadoPartidaBot* partidaPtr,
+                       int usarQuadros) {
+    const CabecalhoReplay* cabecalhoPtr = arquivoPtr->cabecalho;
+    iniciarPartidaBot(partidaPtr, cabecalhoPtr->capacidadeFila, cabecalhoPtr->capacidadePilha,
+                      cabecalhoPtr->regrasPontuacao, cabecalhoPtr->semente, (ModoGerador)cabecalhoPtr->modoGerador,
+                      NULL);
+    if (jogada > arquivoPtr->rodape->totalJogadas) {
+        return 0;
+    }
+    uint64_t deslocamento = sizeof(CabecalhoReplay);
+    size_t baixo = 0, alto = (size_t)arquivoPtr->rodape->quantidadeQuadros;
+    while (usarQuadros && baixo < alto) {
+        size_t meio = baixo + (alto - baixo) / 2;
+        if (arquivoPtr->indice[meio].jogada <= jogada) {
+            baixo = meio + 1;
+        } else {
+            alto = meio;
+        }
+    }
+    if (usarQuadros && baixo > 0 && arquivoPtr->indice[baixo - 1].jogada > 0) {
+        deslocamento = carregarQuadroChaveReplay(arquivoPtr, arquivoPtr->indice[baixo - 1].deslocamento, partidaPtr);
+        if (deslocamento == 0) {
+            return 0;
+        }
+    }
+
+    uint64_t limite = arquivoPtr->rodape->deslocamentoIndice;
+    while (partidaPtr->acoes < jogada) {
+        if (deslocamento + sizeof(RegistroAcaoReplay) > limite) {
+            return 0;
+        }
+        RegistroAcaoReplay registro;
+        memcpy(&registro, arquivoPtr->mapa + deslocamento, sizeof(registro));
+        if (registro.acao == MARCA_QUADRO_REPLAY) {
+            QuadroChaveReplay quadro;
+            if (deslocamento + sizeof(quadro) > limite) {
+                return 0;
+            }
+            memcpy(&quadro, arquivoPtr->mapa + deslocamento, sizeof(quadro));
+            if (quadro.tamanho < sizeof(quadro)) {
+                return 0;
+            }
+            deslocamento += quadro.tamanho;     // Reaplicando desde o início: pula o quadro
+            continue;
+        }
+        AcaoBot acao;
+        memset(&acao, 0, sizeof(acao));
+        acao.tipo = (TipoAcaoBot)registro.acao;
+        acao.jogada.tipo = registro.tipo;
+        acao.jogada.rotacao = registro.rotacao;
+        acao.jogada.coluna = registro.coluna;
+        acao.jogada.linha = registro.linha;
+        acao.jogada.origem = registro.origem;
+        acao.jogada.viaDeslize = registro.viaDeslize;
+        aplicarAcaoPartidaBot(partidaPtr, &acao);
+        deslocamento += sizeof(registro);
+    }
+    return 1;
+}
+
+/**
+ * @brief Modo de linha de comando: posiciona um replay em uma jogada
+ * @return Código de saída
+ *
+ * Uso: tetris --replay arquivo [--jogada n] [--sem-quadros]
+ *            [--arquivo-regras caminho] [--combos padroes]
+ *
+ * Sem --jogada, vai ao fim. --sem-quadros reaplica desde o início, para
+ * comparar o tempo e o resultado.
+ */
+int executarModoReplay(int argc, char* argv[]) {
+    const char* caminho = NULL;
+    long long jogada = -1;
+    int usarQuadros = 1;
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--jogada") == 0 && i + 1 < argc) {
+            jogada = atoll(argv[++i]);
+        } else if (strcmp(argv[i], "--sem-quadros") == 0) {
+            usarQuadros = 0;
+        } else if (strcmp(argv[i], "--arquivo-regras") == 0 && i + 1 < argc) {
+            if (carregarRegrasPontuacao(argv[++i]) < 0) {
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--combos") == 0 && i + 1 < argc) {
+            if (!configurarPadroesCombo(argv[++i])) {
+                fprintf(stderr, "Padroes de combo invalidos: %s\n", argv[i]);
+                return 1;
+            }
+        } else if (caminho == NULL) {
+            caminho = argv[i];
+        }
+    }
+    if (caminho == NULL) {
+        fprintf(stderr, "Uso: %s --replay arquivo [--jogada n] [--sem-quadros]\n", argv[0]);
+        return 1;
+    }
+    ArquivoReplay arquivo;
+    if (!abrirArquivoReplay(&arquivo, caminho)) {
+        return 1;
+    }
+    uint64_t total = arquivo.rodape->totalJogadas;
+    uint64_t alvo = jogada < 0 || (uint64_t)jogada > total ? total : (uint64_t)jogada;
+    printf("Replay %s: semente %llu | %llu jogadas | %llu quadros-chave a cada %u | %.1f KB\n", caminho,
+           (unsigned long long)arquivo.cabecalho->semente, (unsigned long long)total,
+           (unsigned long long)arquivo.rodape->quantidadeQuadros, arquivo.cabecalho->intervaloQuadros,
+           arquivo.tamanho / 1e3);
+
+    saidaSilenciosa = 1;
+    EstadoPartidaBot partida;
+    struct timespec antes, depois;
+    clock_gettime(CLOCK_MONOTONIC, &antes);
+    int encontrou = buscarJogadaReplay(&arquivo, alvo, &partida, usarQuadros);
+    clock_gettime(CLOCK_MONOTONIC, &depois);
+    if (encontrou) {
+        printf("Jogada %llu (%s, %.1f us): %d pecas | %d linhas | %d reservas | pontuacao %d | nivel %d | "
+               "melhor combo %d\n", (unsigned long long)alvo, usarQuadros ? "quadro-chave" : "desde o inicio",
+               (depois.tv_sec - antes.tv_sec) * 1e6 + (depois.tv_nsec - antes.tv_nsec) * 1e-3,
+               partida.pecasJogadas, partida.linhasEliminadas, partida.acoesReserva, partida.sistema.pontuacaoTotal,
+               partida.sistema.nivelAtual, partida.sistema.melhorCombo);
+        saidaSilenciosa = 0;
+        exibirFila(&partida.fila);
+        exibirPilha(&partida.pilha);
+    } else {
+        fprintf(stderr, "Replay %s corrompido antes da jogada %llu\n", caminho, (unsigned long long)alvo);
+    }
+    liberarPartidaBot(&partida);
+    fecharArquivoReplay(&arquivo);
+    return encontrou ? 0 : 1;
+}
+
+// ═══════════════════════════════════════════════════════════════════════════════
+//                       TRANSMISSÃO PARA ESPECTADORES (DELTAS)
+// ═══════════════════════════════════════════════════════════════════════════════
+
+#define TAMANHO_MAXIMO_EVENTO 32        ///< Maior evento de uma ação (cabeçalho, jogada, 3 peças, varints)
+
+static unsigned char* escreverVarintTransmissao(unsigned char* destino, uint64_t valor) {
+    while (valor >= 0x80) {
+        *destino++ = (unsigned char)(valor | 0x80);
+        valor >>= 7;
+    }
+    *destino++ = (unsigned char)valor;
+    return destino;
+}
+
+/// @return Byte seguinte ao varint, ou NULL se ele passa do fim
+static const unsigned char* lerVarintTransmissao(const unsigned char* origem, const unsigned char* fim,
+                                                 uint64_t* valorPtr) {
+    uint64_t valor = 0;
+    for (int deslocamento = 0; origem < fim && deslocamento < 64; deslocamento += 7) {
+        unsigned char byte = *origem++;
+        valor |= (uint64_t)(byte & 0x7F) << deslocamento;
+        if (byte < 0x80) {
+            *valorPtr = valor;
+            return origem;
+        }
+    }
+    return NULL;
+}
+
+/// Solta uma referência; liberar um bloco solta a referência que ele segurava do próximo
+static void soltarBlocoTransmissao(BlocoTransmissao* blocoPtr) {
+    while (blocoPtr != NULL && atomic_fetch_sub_explicit(&blocoPtr->referencias, 1, memory_order_acq_rel) == 1) {
+        BlocoTransmissao* proximo = atomic_load_explicit(&blocoPtr->proximo, memory_order_acquire);
+        free(blocoPtr);
+        blocoPtr = proximo;
+    }
+}
+
+/**
+ * @brief Abre um bloco com o quadro completo da partida e passa a escrever nele
+ * @return 1 em caso de sucesso, 0 sem memória (o bloco atual continua)
+ */
+static int publicarQuadroTransmissao(TransmissaoEspectadores* transmissaoPtr, const EstadoPartidaBot* partidaPtr) {
+    const SistemaExpert* sistemaPtr = &partidaPtr->sistema;
+    int quantidadeFila = partidaPtr->fila.quantidadePecas;
+    int quantidadePilha = partidaPtr->pilha.quantidadeReservada;
+    size_t necessario = 128 + (size_t)quantidadeFila + (size_t)quantidadePilha + sizeof(Tabuleiro);
+    uint32_t capacidade = transmissaoPtr->tamanhoBloco > necessario ? transmissaoPtr->tamanhoBloco : (uint32_t)necessario;
+    BlocoTransmissao* novo = malloc(sizeof(BlocoTransmissao) + capacidade);
+    if (novo == NULL) {
+        return 0;
+    }
+    novo->capacidade = capacidade;
+    atomic_init(&novo->proximo, NULL);
+    atomic_init(&novo->final, 0);
+    // Referência do produtor e, se houver, do elo do bloco anterior
+    atomic_init(&novo->referencias, transmissaoPtr->atual != NULL ? 2 : 1);
+
+    unsigned char* escrita = novo->dados;
+    *escrita++ = EVENTO_QUADRO_COMPLETO;
+    escrita = escreverVarintTransmissao(escrita, partidaPtr->acoes);
+    escrita = escreverVarintTransmissao(escrita, (uint32_t)sistemaPtr->pontuacaoTotal);
+    escrita = escreverVarintTransmissao(escrita, (uint32_t)sistemaPtr->nivelAtual);
+    escrita = escreverVarintTransmissao(escrita, (uint32_t)sistemaPtr->comboAtual);
+    escrita = escreverVarintTransmissao(escrita, (uint32_t)sistemaPtr->melhorCombo);
+    escrita = escreverVarintTransmissao(escrita, (uint32_t)partidaPtr->pecasJogadas);
+    escrita = escreverVarintTransmissao(escrita, (uint32_t)partidaPtr->linhasEliminadas);
+    escrita = escreverVarintTransmissao(escrita, (uint32_t)partidaPtr->acoesReserva);
+    escrita = escreverVarintTransmissao(escrita, (uint32_t)quantidadeFila);
+    for (int i = 0; i < quantidadeFila; i++) {
+        *escrita++ = (unsigned char)espiarFila(&partidaPtr->fila, i)->tipo;
+    }
+    escrita = escreverVarintTransmissao(escrita, (uint32_t)quantidadePilha);
+    for (int i = quantidadePilha - 1; i >= 0; i--) {
+        *escrita++ = (unsigned char)espiarPilha(&partidaPtr->pilha, i)->tipo;
+    }
+    // Só as linhas até a mais alta ocupada
+    int altura = ALTURA_TABULEIRO;
+    while (altura > 0 && partidaPtr->tabuleiro.linhas[altura - 1] == 0) {
+        altura--;
+    }
+    *escrita++ = (unsigned char)altura;
+    for (int i = 0; i < altura; i++) {
+        *escrita++ = (unsigned char)(partidaPtr->tabuleiro.linhas[i] & 0xFF);
+        *escrita++ = (unsigned char)(partidaPtr->tabuleiro.linhas[i] >> 8);
+    }
+    uint32_t tamanho = (uint32_t)(escrita - novo->dados);
+    atomic_init(&novo->publicados, tamanho);
+
+    // Encadeia: quem está no bloco anterior chega a este pelo elo
+    BlocoTransmissao* anterior = transmissaoPtr->atual;
+    pthread_mutex_lock(&transmissaoPtr->trava);
+    if (anterior != NULL) {
+        atomic_store_explicit(&anterior->proximo, novo, memory_order_release);
+    }
+    transmissaoPtr->atual = novo;
+    pthread_mutex_unlock(&transmissaoPtr->trava);
+    soltarBlocoTransmissao(anterior);
+
+    transmissaoPtr->pontuacao = sistemaPtr->pontuacaoTotal;
+    transmissaoPtr->combo = sistemaPtr->comboAtual;
+    transmissaoPtr->nivel = sistemaPtr->nivelAtual;
+    transmissaoPtr->quantidadeFila = quantidadeFila;
+    transmissaoPtr->quantidadePilha = quantidadePilha;
+    transmissaoPtr->acoesNoBloco = 0;
+    transmissaoPtr->quadros++;
+    transmissaoPtr->bytes += tamanho;
+    transmissaoPtr->blocosAlocados++;
+    return 1;
+}
+
+/**
+ * @brief Começa a transmitir uma partida (publica o primeiro quadro completo)
+ * @param transmissaoPtr Transmissão (saída; liberar com liberarTransmissao())
+ * @param partidaPtr Partida no estado inicial, ou em qualquer ponto
+ * @param tamanhoBloco Bytes por bloco (0 = TAMANHO_BLOCO_TRANSMISSAO)
+ * @param intervaloQuadros Ações entre quadros completos (0 = INTERVALO_QUADROS_TRANSMISSAO)
+ * @return 1 em caso de sucesso, 0 sem memória
+ *
+ * O intervalo limita quanto um espectador novo decodifica até alcançar a
+ * partida; cada quadro custa algumas dezenas de bytes mais a fila e a reserva.
+ */
+int iniciarTransmissao(TransmissaoEspectadores* transmissaoPtr, const EstadoPartidaBot* partidaPtr,
+                       int tamanhoBloco, int intervaloQuadros) {
+    memset(transmissaoPtr, 0, sizeof(*transmissaoPtr));
+    pthread_mutex_init(&transmissaoPtr->trava, NULL);
+    transmissaoPtr->tamanhoBloco = tamanhoBloco > 0 ? (uint32_t)tamanhoBloco : TAMANHO_BLOCO_TRANSMISSAO;
+    transmissaoPtr->intervaloQuadros = intervaloQuadros > 0 ? intervaloQuadros : INTERVALO_QUADROS_TRANSMISSAO;
+    transmissaoPtr->capacidadeFila = partidaPtr->fila.capacidade;
+    transmissaoPtr->capacidadePilha = partidaPtr->pilha.capacidade;
+    if (!publicarQuadroTransmissao(transmissaoPtr, partidaPtr)) {
+        pthread_mutex_destroy(&transmissaoPtr->trava);
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief Publica a ação que acabou de ser aplicada à partida (só o produtor chama)
+ * @param transmissaoPtr Transmissão iniciada
+ * @param partidaPtr Partida depois de aplicarAcaoPartidaBot()
+ * @param acaoPtr Ação aplicada
+ * @return 1 em caso de sucesso, 0 sem memória para um bloco novo
+ *
+ * O evento descreve só o que mudou em relação ao que os espectadores já
+ * sabem: a peça que saiu está implícita (a frente da fila ou o topo da
+ * reserva), e pontos, combo e nível só entram se mudaram. Se a partida
+ * mudou de um jeito que um evento não descreve, sai um quadro completo.
+ */
+int publicarAcaoTransmissao(TransmissaoEspectadores* transmissaoPtr, const EstadoPartidaBot* partidaPtr,
+                            const AcaoBot* acaoPtr) {
+    const SistemaExpert* sistemaPtr = &partidaPtr->sistema;
+    BlocoTransmissao* blocoPtr = transmissaoPtr->atual;
+    uint32_t publicados = atomic_load_explicit(&blocoPtr->publicados, memory_order_relaxed);
+    int novas = partidaPtr->fila.quantidadePecas - transmissaoPtr->quantidadeFila + (acaoPtr->tipo != ACAO_JOGAR_PILHA);
+    int pilhaEsperada = transmissaoPtr->quantidadePilha + (acaoPtr->tipo == ACAO_RESERVAR) -
+                        (acaoPtr->tipo == ACAO_JOGAR_PILHA);
+    int pontos = sistemaPtr->pontuacaoTotal - transmissaoPtr->pontuacao;
+    transmissaoPtr->eventos++;
+    transmissaoPtr->acoesNoBloco++;
+    if (novas < 0 || novas > 3 || pilhaEsperada != partidaPtr->pilha.quantidadeReservada || pontos < 0 ||
+        transmissaoPtr->acoesNoBloco >= transmissaoPtr->intervaloQuadros ||
+        publicados + TAMANHO_MAXIMO_EVENTO > blocoPtr->capacidade) {
+        return publicarQuadroTransmissao(transmissaoPtr, partidaPtr);
+    }
+
+    // Os bytes depois de publicados ainda não são lidos: escreve direto no bloco
+    unsigned char* inicio = blocoPtr->dados + publicados;
+    unsigned char* escrita = inicio + 1;
+    unsigned char cabecalho = (unsigned char)(acaoPtr->tipo | novas << NOVAS_EVENTO_DESLOCAMENTO);
+    if (acaoPtr->tipo != ACAO_RESERVAR) {
+        *escrita++ = (unsigned char)(acaoPtr->jogada.coluna | acaoPtr->jogada.rotacao << 4);
+        *escrita++ = acaoPtr->jogada.linha;
+    }
+    for (int i = partidaPtr->fila.quantidadePecas - novas; i < partidaPtr->fila.quantidadePecas; i++) {
+        *escrita++ = (unsigned char)espiarFila(&partidaPtr->fila, i)->tipo;
+    }
+    if (pontos != 0) {
+        cabecalho |= EVENTO_COM_PONTOS;
+        escrita = escreverVarintTransmissao(escrita, (uint32_t)pontos);
+    }
+    if (sistemaPtr->comboAtual != transmissaoPtr->combo) {
+        cabecalho |= EVENTO_COM_COMBO;
+        escrita = escreverVarintTransmissao(escrita, (uint32_t)sistemaPtr->comboAtual);
+    }
+    if (sistemaPtr->nivelAtual != transmissaoPtr->nivel) {
+        cabecalho |= EVENTO_COM_NIVEL;
+        escrita = escreverVarintTransmissao(escrita, (uint32_t)sistemaPtr->nivelAtual);
+    }
+    *inicio = cabecalho;
+    uint32_t tamanho = (uint32_t)(escrita - inicio);
+    atomic_store_explicit(&blocoPtr->publicados, publicados + tamanho, memory_order_release);
+
+    transmissaoPtr->pontuacao = sistemaPtr->pontuacaoTotal;
+    transmissaoPtr->combo = sistemaPtr->comboAtual;
+    transmissaoPtr->nivel = sistemaPtr->nivelAtual;
+    transmissaoPtr->quantidadeFila = partidaPtr->fila.quantidadePecas;
+    transmissaoPtr->quantidadePilha = partidaPtr->pilha.quantidadeReservada;
+    transmissaoPtr->bytes += tamanho;
+    return 1;
+}
+
+/**
+ * @brief Marca o fim da partida: quem chegar ao último evento fica sabendo
+ */
+void encerrarTransmissao(TransmissaoEspectadores* transmissaoPtr) {
+    atomic_store_explicit(&transmissaoPtr->atual->final, 1, memory_order_release);
+}
+
+/**
+ * @brief Solta a referência do produtor
+ *
+ * Espectadores que ainda estão assistindo continuam lendo os blocos que
+ * seguram; o último a sair libera a memória.
+ */
+void liberarTransmissao(TransmissaoEspectadores* transmissaoPtr) {
+    soltarBlocoTransmissao(transmissaoPtr->atual);
+    pthread_mutex_destroy(&transmissaoPtr->trava);
+    memset(transmissaoPtr, 0, sizeof(*transmissaoPtr));
+}
+
+/**
+ * @brief Entra na transmissão pelo quadro completo mais recente
+ * @param transmissaoPtr Transmissão iniciada (pode estar em andamento)
+ * @param espectadorPtr Espectador (saída; sair com sairTransmissao())
+ * @return 1 em caso de sucesso, 0 sem memória
+ */
+int entrarTransmissao(TransmissaoEspectadores* transmissaoPtr, EspectadorTransmissao* espectadorPtr) {
+    memset(espectadorPtr, 0, sizeof(*espectadorPtr));
+    espectadorPtr->capacidadeFila = transmissaoPtr->capacidadeFila;
+    espectadorPtr->capacidadePilha = transmissaoPtr->capacidadePilha;
+    espectadorPtr->fila = malloc((size_t)espectadorPtr->capacidadeFila + 1);
+    espectadorPtr->pilha = malloc((size_t)espectadorPtr->capacidadePilha + 1);
+    if (espectadorPtr->fila == NULL || espectadorPtr->pilha == NULL) {
+        free(espectadorPtr->fila);
+        free(espectadorPtr->pilha);
+        return 0;
+    }
+    pthread_mutex_lock(&transmissaoPtr->trava);
+    espectadorPtr->bloco = transmissaoPtr->atual;
+    atomic_fetch_add_explicit(&espectadorPtr->bloco->referencias, 1, memory_order_relaxed);
+    pthread_mutex_unlock(&transmissaoPtr->trava);
+    return 1;
+}
+
+/**
+ * @brief Decodifica um quadro completo sobre o estado do espectador
+ * @return Byte seguinte ao quadro, ou NULL se ele é inválido
+ */
+static const unsigned char* aplicarQuadroEspectador(EspectadorTransmissao* espectadorPtr, const unsigned char* leitura,
+                                                    const unsigned char* fim) {
+    uint64_t valores[10];
+    for (int i = 0; i < 9; i++) {
+        if ((leitura = lerVarintTransmissao(leitura, fim, &valores[i])) == NULL) {
+            return NULL;
+        }
+    }
+    if (valores[8] > (uint64_t)espectadorPtr->capacidadeFila || fim - leitura < (ptrdiff_t)valores[8] + 1) {
+        return NULL;
+    }
+    espectadorPtr->acoes = valores[0];
+    espectadorPtr->pontuacao = (int)valores[1];
+    espectadorPtr->nivel = (int)valores[2];
+    espectadorPtr->combo = (int)valores[3];
+    espectadorPtr->melhorCombo = (int)valores[4];
+    espectadorPtr->pecasJogadas = (int)valores[5];
+    espectadorPtr->linhasEliminadas = (int)valores[6];
+    espectadorPtr->acoesReserva = (int)valores[7];
+    espectadorPtr->inicioFila = 0;
+    espectadorPtr->quantidadeFila = (int)valores[8];
+    memcpy(espectadorPtr->fila, leitura, (size_t)valores[8]);
+    leitura += valores[8];
+    if ((leitura = lerVarintTransmissao(leitura, fim, &valores[9])) == NULL ||
+        valores[9] > (uint64_t)espectadorPtr->capacidadePilha || fim - leitura < (ptrdiff_t)valores[9] + 1) {
+        return NULL;
+    }
+    espectadorPtr->quantidadePilha = (int)valores[9];
+    memcpy(espectadorPtr->pilha, leitura, (size_t)valores[9]);
+    leitura += valores[9];
+    int altura = *leitura++;
+    if (altura > ALTURA_TABULEIRO || fim - leitura < 2 * altura) {
+        return NULL;
+    }
+    memset(&espectadorPtr->tabuleiro, 0, sizeof(Tabuleiro));
+    for (int i = 0; i < altura; i++, leitura += 2) {
+        espectadorPtr->tabuleiro.linhas[i] = (uint16_t)(leitura[0] | leitura[1] << 8);
     }
-    
-    // Aplicar multiplicadores
-    return (int)(pontuacaoBase * sistemaPtr->multiplicadorAtual * sistemaPtr->fatorDificuldade);
+    return leitura;
 }
 
 /**
- * @brief Detecta e processa combos de peças consecutivas
- * @param sistemaPtr Ponteiro para o sistema Expert
- * @param tipoPeca Tipo da peça atual
- * @return Multiplicador de combo aplicado
+ * @brief Decodifica o evento de uma ação sobre o estado do espectador
+ * @return Byte seguinte ao evento, ou NULL se ele é inválido
  */
-double detectarCombo(SistemaExpert* sistemaPtr, char tipoPeca) {
-    if (sistemaPtr->ultimoTipoJogado == tipoPeca) {
-        sistemaPtr->sequenciaTipoAtual++;
-        if (sistemaPtr->sequenciaTipoAtual >= 3) {
-            sistemaPtr->comboAtual = sistemaPtr->sequenciaTipoAtual - 2;
-            if (sistemaPtr->comboAtual > sistemaPtr->melhorCombo) {
-                sistemaPtr->melhorCombo = sistemaPtr->comboAtual;
-            }
-            return 1.0 + (sistemaPtr->comboAtual * 0.2);
+static const unsigned char* aplicarEventoEspectador(EspectadorTransmissao* espectadorPtr, unsigned char cabecalho,
+                                                    const unsigned char* leitura, const unsigned char* fim) {
+    int tipo = cabecalho & 0x03;
+    if (tipo == EVENTO_RESERVAR) {
+        if (espectadorPtr->quantidadeFila == 0 || espectadorPtr->quantidadePilha >= espectadorPtr->capacidadePilha) {
+            return NULL;
         }
+        espectadorPtr->pilha[espectadorPtr->quantidadePilha++] = espectadorPtr->fila[espectadorPtr->inicioFila];
+        espectadorPtr->inicioFila = espectadorPtr->inicioFila + 1 == espectadorPtr->capacidadeFila ? 0 : espectadorPtr->inicioFila + 1;
+        espectadorPtr->quantidadeFila--;
+        espectadorPtr->acoesReserva++;
     } else {
-        sistemaPtr->sequenciaTipoAtual = 1;
-        sistemaPtr->comboAtual = 0;
+        if (fim - leitura < 2) {
+            return NULL;
+        }
+        Jogada jogada;
+        memset(&jogada, 0, sizeof(jogada));
+        jogada.coluna = leitura[0] & 0x0F;
+        jogada.rotacao = leitura[0] >> 4;
+        jogada.linha = leitura[1];
+        jogada.origem = tipo == EVENTO_JOGAR_PILHA;
+        leitura += 2;
+        if (tipo == EVENTO_JOGAR_FILA && espectadorPtr->quantidadeFila > 0) {
+            jogada.tipo = espectadorPtr->fila[espectadorPtr->inicioFila];
+            espectadorPtr->inicioFila = espectadorPtr->inicioFila + 1 == espectadorPtr->capacidadeFila ? 0 : espectadorPtr->inicioFila + 1;
+            espectadorPtr->quantidadeFila--;
+        } else if (tipo == EVENTO_JOGAR_PILHA && espectadorPtr->quantidadePilha > 0) {
+            jogada.tipo = espectadorPtr->pilha[--espectadorPtr->quantidadePilha];
+        } else {
+            return NULL;
+        }
+        if (indiceTipoPeca(jogada.tipo) < 0 || jogada.rotacao > 3 || jogada.coluna >= LARGURA_TABULEIRO ||
+            jogada.linha >= ALTURA_TABULEIRO) {
+            return NULL;
+        }
+        espectadorPtr->linhasEliminadas += aplicarJogada(&espectadorPtr->tabuleiro, &jogada);
+        espectadorPtr->pecasJogadas++;
     }
-    sistemaPtr->ultimoTipoJogado = tipoPeca;
-    return 1.0;
+    int novas = (cabecalho >> NOVAS_EVENTO_DESLOCAMENTO) & 0x03;
+    if (fim - leitura < novas || espectadorPtr->quantidadeFila + novas > espectadorPtr->capacidadeFila) {
+        return NULL;
+    }
+    for (int i = 0; i < novas; i++) {
+        int posicao = espectadorPtr->inicioFila + espectadorPtr->quantidadeFila;
+        espectadorPtr->fila[posicao >= espectadorPtr->capacidadeFila ? posicao - espectadorPtr->capacidadeFila : posicao] =
+            (char)*leitura++;
+        espectadorPtr->quantidadeFila++;
+    }
+    uint64_t valor;
+    if (cabecalho & EVENTO_COM_PONTOS) {
+        if ((leitura = lerVarintTransmissao(leitura, fim, &valor)) == NULL) {
+            return NULL;
+        }
+        espectadorPtr->pontuacao += (int)valor;
+    }
+    if (cabecalho & EVENTO_COM_COMBO) {
+        if ((leitura = lerVarintTransmissao(leitura, fim, &valor)) == NULL) {
+            return NULL;
+        }
+        espectadorPtr->combo = (int)valor;
+        if (espectadorPtr->combo > espectadorPtr->melhorCombo) {
+            espectadorPtr->melhorCombo = espectadorPtr->combo;
+        }
+    }
+    if (cabecalho & EVENTO_COM_NIVEL) {
+        if ((leitura = lerVarintTransmissao(leitura, fim, &valor)) == NULL) {
+            return NULL;
+        }
+        espectadorPtr->nivel = (int)valor;
+    }
+    espectadorPtr->acoes++;
+    return leitura;
 }
 
 /**
- * @brief Verifica e processa a progressão de nível baseada na pontuação
- * @param sistemaPtr Ponteiro para o sistema Expert
- * 
- * Esta função implementa um sistema dinâmico de progressão que:
- * - Monitora a pontuação atual do nível
- * - Calcula progressão exponencial de dificuldade
- * - Ajusta automaticamente multiplicadores e limites
- * - Fornece feedback visual da evolução
+ * @brief Decodifica os eventos já publicados (só a thread do espectador chama)
+ * @param espectadorPtr Espectador que entrou com entrarTransmissao()
+ * @param maximoEventos Eventos a decodificar no máximo (0 = todos os publicados)
+ * @return Eventos decodificados, ou -1 se o bloco tem um evento inválido
+ *
+ * Lê direto dos blocos compartilhados. Ao terminar um bloco, segura o
+ * próximo antes de soltar o atual; o bloco que ninguém mais segura é
+ * liberado por quem o soltou. Depois do último evento de uma transmissão
+ * encerrada, espectadorPtr->encerrada fica 1.
  */
-void verificarProgressaoNivel(SistemaExpert* sistemaPtr) {
-    // Verificar se atingiu pontos suficientes para próximo nível
-    if (sistemaPtr->pontuacaoTotal >= sistemaPtr->limitePontosNivel) {
-        sistemaPtr->nivelAtual++;
-        
-        // Calcular novo limite com progressão exponencial
-        sistemaPtr->limitePontosNivel = (int)(1000 * pow(1.5, sistemaPtr->nivelAtual - 1));
-        sistemaPtr->pontosParaProximoNivel = sistemaPtr->limitePontosNivel - sistemaPtr->pontuacaoTotal;
-        
-        // Aumentar fator de dificuldade (máximo 3.0)
-        if (sistemaPtr->fatorDificuldade < 3.0) {
-            sistemaPtr->fatorDificuldade += 0.2;
+int acompanharTransmissao(EspectadorTransmissao* espectadorPtr, int maximoEventos) {
+    int decodificados = 0;
+    while (maximoEventos <= 0 || decodificados < maximoEventos) {
+        BlocoTransmissao* blocoPtr = espectadorPtr->bloco;
+        int final = atomic_load_explicit(&blocoPtr->final, memory_order_acquire);
+        uint32_t publicados = atomic_load_explicit(&blocoPtr->publicados, memory_order_acquire);
+        if (espectadorPtr->posicao < publicados) {
+            const unsigned char* leitura = blocoPtr->dados + espectadorPtr->posicao;
+            const unsigned char* fim = blocoPtr->dados + publicados;
+            unsigned char cabecalho = *leitura++;
+            leitura = (cabecalho & 0x03) == EVENTO_QUADRO_COMPLETO
+                          ? aplicarQuadroEspectador(espectadorPtr, leitura, fim)
+                          : aplicarEventoEspectador(espectadorPtr, cabecalho, leitura, fim);
+            if (leitura == NULL) {
+                return -1;
+            }
+            espectadorPtr->bytes += (uint64_t)(leitura - (blocoPtr->dados + espectadorPtr->posicao));
+            espectadorPtr->posicao = (uint32_t)(leitura - blocoPtr->dados);
+            espectadorPtr->eventos++;
+            decodificados++;
+            continue;
         }
-        
-        // Aumentar multiplicador base (máximo 10.0)
-        if (sistemaPtr->multiplicadorAtual < 10.0) {
-            sistemaPtr->multiplicadorAtual += 0.5;
+        // O produtor publica o bloco inteiro antes de encadear o próximo
+        BlocoTransmissao* proximo = atomic_load_explicit(&blocoPtr->proximo, memory_order_acquire);
+        if (proximo == NULL) {
+            espectadorPtr->encerrada = final;
+            break;
         }
-        
-        // Registrar marco alcançado
-        sistemaPtr->marcosAlcancados++;
-        
-        printf("\n*** NIVEL %d ALCANCADO! ***\n", sistemaPtr->nivelAtual);
-        printf("Novo multiplicador: %.1fx\n", sistemaPtr->multiplicadorAtual);
-        printf("Fator de dificuldade: %.1f\n", sistemaPtr->fatorDificuldade);
-    } else {
-        // Atualizar pontos restantes para próximo nível
-        sistemaPtr->pontosParaProximoNivel = sistemaPtr->limitePontosNivel - sistemaPtr->pontuacaoTotal;
+        if (espectadorPtr->posicao < atomic_load_explicit(&blocoPtr->publicados, memory_order_acquire)) {
+            continue;
+        }
+        atomic_fetch_add_explicit(&proximo->referencias, 1, memory_order_relaxed);
+        espectadorPtr->bloco = proximo;
+        espectadorPtr->posicao = 0;
+        soltarBlocoTransmissao(blocoPtr);
     }
-    
-    // Verificar conquistas especiais
-    if (sistemaPtr->nivelAtual == 5 && !(sistemaPtr->conquistasDesbloqueadas & 1)) {
-        sistemaPtr->conquistasDesbloqueadas |= 1; // Primeira conquista
-        printf("*** CONQUISTA DESBLOQUEADA: Veterano (Nivel 5)\n");
+    return decodificados;
+}
+
+/**
+ * @brief Sai da transmissão, soltando o bloco que o espectador segurava
+ */
+void sairTransmissao(EspectadorTransmissao* espectadorPtr) {
+    soltarBlocoTransmissao(espectadorPtr->bloco);
+    free(espectadorPtr->fila);
+    free(espectadorPtr->pilha);
+    memset(espectadorPtr, 0, sizeof(*espectadorPtr));
+}
+
+/**
+ * @brief Mostra a partida como o espectador a vê
+ */
+void exibirVisaoEspectador(const EspectadorTransmissao* espectadorPtr) {
+    imprimirJogo("Acao %llu: %d pecas | %d linhas | pontuacao %d | nivel %d | combo %d (melhor %d)\n",
+                 (unsigned long long)espectadorPtr->acoes, espectadorPtr->pecasJogadas,
+                 espectadorPtr->linhasEliminadas, espectadorPtr->pontuacao, espectadorPtr->nivel,
+                 espectadorPtr->combo, espectadorPtr->melhorCombo);
+    imprimirJogo("Fila: ");
+    for (int i = 0; i < espectadorPtr->quantidadeFila; i++) {
+        int posicao = espectadorPtr->inicioFila + i;
+        imprimirJogo("%c ", espectadorPtr->fila[posicao >= espectadorPtr->capacidadeFila
+                                                    ? posicao - espectadorPtr->capacidadeFila : posicao]);
     }
-    
-    if (sistemaPtr->nivelAtual == 10 && !(sistemaPtr->conquistasDesbloqueadas & 2)) {
-        sistemaPtr->conquistasDesbloqueadas |= 2; // Segunda conquista
-        printf("*** CONQUISTA DESBLOQUEADA: Mestre (Nivel 10)\n");
+    imprimirJogo("\nPilha: ");
+    for (int i = espectadorPtr->quantidadePilha - 1; i >= 0; i--) {
+        imprimirJogo("%c ", espectadorPtr->pilha[i]);
     }
+    imprimirJogo("\n");
 }
 
 /**
- * @brief Processa uma jogada completa no sistema Expert
- * @param peca Peça jogada
- * @param origem Origem da peça (0=fila, 1=pilha)
- * @param sistemaPtr Ponteiro para o sistema Expert
+ * @brief Modo de linha de comando: uma partida do bot transmitida a espectadores
+ * @return Código de saída
+ *
+ * Uso: tetris --transmissao [--espectadores n] [--pecas n] [--semente s]
+ *            [--largura n] [--quadros n] [--bloco bytes]
+ *
+ * Produtor e espectadores dividem a mesma thread: depois de cada ação,
+ * cada espectador decodifica o que foi publicado. Metade entra no começo
+ * e metade no meio da partida, pelo quadro completo mais recente. No fim,
+ * todos precisam ver o mesmo estado que a partida.
  */
-void processarJogadaExpert(Peca peca, int origem, SistemaExpert* sistemaPtr) {
-    // Cálculo da pontuação
-    int pontos = calcularPontuacao(peca.tipo, sistemaPtr);
-    
-    // Detectar combo e aplicar multiplicador
-    double multiplicadorCombo = detectarCombo(sistemaPtr, peca.tipo);
-    
-    // Aplicar multiplicador de combo à pontuação
-    pontos = (int)(pontos * multiplicadorCombo);
-    
-    // Atualização das pontuações
-    sistemaPtr->pontuacaoTotal += pontos;
-    sistemaPtr->pontuacaoNivel += pontos;
-    
-    // Atualização do recorde pessoal
-    if (sistemaPtr->pontuacaoTotal > sistemaPtr->recordePessoal) {
-        sistemaPtr->recordePessoal = sistemaPtr->pontuacaoTotal;
+int executarModoTransmissao(int argc, char* argv[]) {
+    int quantidadeEspectadores = 1000, limitePecas = 2000, intervaloQuadros = 0, tamanhoBloco = 0;
+    uint64_t semente = 1;
+    ConfigBot config;
+    configurarBotPadrao(&config);
+    config.larguraFeixe = 4;
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--espectadores") == 0 && i + 1 < argc) {
+            quantidadeEspectadores = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--pecas") == 0 && i + 1 < argc) {
+            limitePecas = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--semente") == 0 && i + 1 < argc) {
+            semente = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--largura") == 0 && i + 1 < argc) {
+            config.larguraFeixe = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--quadros") == 0 && i + 1 < argc) {
+            intervaloQuadros = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--bloco") == 0 && i + 1 < argc) {
+            tamanhoBloco = atoi(argv[++i]);
+        } else {
+            fprintf(stderr, "Uso: %s --transmissao [--espectadores n] [--pecas n] [--semente s] [--largura n] "
+                            "[--quadros n] [--bloco bytes]\n", argv[0]);
+            return 1;
+        }
     }
-    
-    // Estatísticas de origem das jogadas
-    sistemaPtr->totalJogadas++;
-    if (origem == 0) {
-        sistemaPtr->jogadasDaFila++;
-    } else {
-        sistemaPtr->jogadasDaPilha++;
+    if (quantidadeEspectadores < 1 || limitePecas < 1 || config.larguraFeixe < 1) {
+        fprintf(stderr, "Espectadores, pecas e largura precisam ser positivos\n");
+        return 1;
     }
-    
-    // Atualizar contadores de tipo de peça
-    switch(peca.tipo) {
-        case 'I': sistemaPtr->contagemTipoI++; break;
-        case 'O': sistemaPtr->contagemTipoO++; break;
-        case 'T': sistemaPtr->contagemTipoT++; break;
-        case 'L': sistemaPtr->contagemTipoL++; break;
+
+    saidaSilenciosa = 1;
+    EstadoPartidaBot partida;
+    iniciarPartidaBot(&partida, config.capacidadeFila, config.capacidadePilha, config.regrasPontuacao, semente,
+                      (ModoGerador)config.modoGerador, NULL);
+    TransmissaoEspectadores transmissao;
+    EspectadorTransmissao* espectadores = calloc((size_t)quantidadeEspectadores, sizeof(EspectadorTransmissao));
+    if (espectadores == NULL || !iniciarTransmissao(&transmissao, &partida, tamanhoBloco, intervaloQuadros)) {
+        fprintf(stderr, "Sem memoria para a transmissao\n");
+        free(espectadores);
+        liberarPartidaBot(&partida);
+        return 1;
     }
-    
-    // Determinar tipo mais jogado
-    int maxContagem = 0;
-    if (sistemaPtr->contagemTipoI > maxContagem) {
-        maxContagem = sistemaPtr->contagemTipoI;
-        sistemaPtr->tipoMaisJogado = 'I';
+    int presentes = 0, metade = (quantidadeEspectadores + 1) / 2;
+    while (presentes < metade && entrarTransmissao(&transmissao, &espectadores[presentes])) {
+        presentes++;
     }
-    if (sistemaPtr->contagemTipoO > maxContagem) {
-        maxContagem = sistemaPtr->contagemTipoO;
-        sistemaPtr->tipoMaisJogado = 'O';
+
+    double segundosDecodificando = 0.0;
+    uint64_t eventosDecodificados = 0;
+    int erro = 0;
+    AcaoBot acao;
+    while (partida.pecasJogadas < limitePecas &&
+           escolherAcaoBot(&config, &partida.tabuleiro, &partida.fila, &partida.pilha, &acao)) {
+        aplicarAcaoPartidaBot(&partida, &acao);
+        publicarAcaoTransmissao(&transmissao, &partida, &acao);
+        if (partida.pecasJogadas == limitePecas / 2) {
+            while (presentes < quantidadeEspectadores && entrarTransmissao(&transmissao, &espectadores[presentes])) {
+                presentes++;
+            }
+        }
+        struct timespec antes, depois;
+        clock_gettime(CLOCK_MONOTONIC, &antes);
+        for (int i = 0; i < presentes; i++) {
+            int decodificados = acompanharTransmissao(&espectadores[i], 0);
+            erro |= decodificados < 0;
+            eventosDecodificados += decodificados > 0 ? (uint64_t)decodificados : 0;
+        }
+        clock_gettime(CLOCK_MONOTONIC, &depois);
+        segundosDecodificando += (depois.tv_sec - antes.tv_sec) + (depois.tv_nsec - antes.tv_nsec) * 1e-9;
     }
-    if (sistemaPtr->contagemTipoT > maxContagem) {
-        maxContagem = sistemaPtr->contagemTipoT;
-        sistemaPtr->tipoMaisJogado = 'T';
+    encerrarTransmissao(&transmissao);
+
+    int divergentes = 0;
+    for (int i = 0; i < presentes; i++) {
+        EspectadorTransmissao* espectadorPtr = &espectadores[i];
+        erro |= acompanharTransmissao(espectadorPtr, 0) < 0;
+        int igual = espectadorPtr->encerrada && espectadorPtr->acoes == partida.acoes &&
+                    espectadorPtr->pontuacao == partida.sistema.pontuacaoTotal &&
+                    espectadorPtr->nivel == partida.sistema.nivelAtual &&
+                    espectadorPtr->melhorCombo == partida.sistema.melhorCombo &&
+                    espectadorPtr->linhasEliminadas == partida.linhasEliminadas &&
+                    espectadorPtr->quantidadeFila == partida.fila.quantidadePecas &&
+                    espectadorPtr->quantidadePilha == partida.pilha.quantidadeReservada &&
+                    memcmp(&espectadorPtr->tabuleiro, &partida.tabuleiro, sizeof(Tabuleiro)) == 0;
+        divergentes += !igual;
     }
-    if (sistemaPtr->contagemTipoL > maxContagem) {
-        maxContagem = sistemaPtr->contagemTipoL;
-        sistemaPtr->tipoMaisJogado = 'L';
+    saidaSilenciosa = 0;
+    printf("Partida: %d pecas | %llu acoes | pontuacao %d | nivel %d\n", partida.pecasJogadas,
+           (unsigned long long)partida.acoes, partida.sistema.pontuacaoTotal, partida.sistema.nivelAtual);
+    printf("Transmissao: %llu bytes (%.2f bytes/acao) | %llu quadros completos | %llu blocos\n",
+           (unsigned long long)transmissao.bytes, (double)transmissao.bytes / (double)(partida.acoes ? partida.acoes : 1),
+           (unsigned long long)transmissao.quadros, (unsigned long long)transmissao.blocosAlocados);
+    printf("Espectadores: %d (%d entraram no meio) | %llu eventos decodificados em %.3fs (%.1f ns/evento)\n",
+           presentes, presentes - metade, (unsigned long long)eventosDecodificados, segundosDecodificando,
+           eventosDecodificados ? segundosDecodificando * 1e9 / (double)eventosDecodificados : 0.0);
+    if (presentes > 0) {
+        printf("Visao do espectador 1:\n");
+        exibirVisaoEspectador(&espectadores[0]);
     }
-    
-    // Calcular eficiência da reserva
-    if (sistemaPtr->totalJogadas > 0) {
-        sistemaPtr->eficienciaReserva = (double)sistemaPtr->jogadasDaPilha / sistemaPtr->totalJogadas * 100.0;
+    printf("Espectadores divergentes: %d\n", divergentes);
+
+    for (int i = 0; i < presentes; i++) {
+        sairTransmissao(&espectadores[i]);
     }
-    
-    // Verificação de progressão de nível
-    verificarProgressaoNivel(sistemaPtr);
+    free(espectadores);
+    liberarTransmissao(&transmissao);
+    liberarPartidaBot(&partida);
+    return erro || divergentes != 0 ? 1 : 0;
+}
+
+// ═══════════════════════════════════════════════════════════════════════════════
+//                       ARQUIVO DE PARTIDAS (CONSULTAS COM ÍNDICE)
+// ═══════════════════════════════════════════════════════════════════════════════
+
+/// Nomes aceitos nas consultas, na ordem de ColunaArquivoPartidas
+static const char* const nomesColunasArquivo[COLUNAS_ARQUIVO] = {
+    "pontuacao", "nivel", "melhorCombo", "pecas", "linhas", "reservas", "eficienciaReserva", "eficienciaMinima",
+    "comboAntesNivel2", "comboAntesNivel3", "comboAntesNivel4", "comboAntesNivel5",
+    "comboAntesNivel6", "comboAntesNivel7", "comboAntesNivel8", "comboAntesNivel9"
+};
+
+/// Percentual de peças jogadas que saíram da reserva (mesma conta de sincronizarSistemaExpert())
+static int eficienciaResumoPartida(const SistemaExpert* sistemaPtr) {
+    return sistemaPtr->totalJogadas > 0
+           ? (int)((double)sistemaPtr->jogadasDaPilha / sistemaPtr->totalJogadas * 100.0) : 0;
 }
 
 /**
- * @brief Exibe estatísticas avançadas do sistema Expert
- * @param sistemaPtr Ponteiro para o sistema Expert
+ * @brief Prepara o resumo de uma partida que vai começar
+ * @param resumoPtr Resumo (saída)
+ * @param partida Semente da partida
  */
-void exibirEstatisticasExpert(SistemaExpert* sistemaPtr) {
-    printf("\n+==============================================================+\n");
-    printf("|                    ESTATISTICAS EXPERT                      |\n");
-    printf("+==============================================================+\n");
-    
-    // Pontuacao e Progressao
-    printf("| Pontuacao Total: %8d  |  Nivel Atual: %3d            |\n", 
-           sistemaPtr->pontuacaoTotal, sistemaPtr->nivelAtual);
-    printf("| Recorde Pessoal: %8d  |  Multiplicador: %.1fx         |\n", 
-           sistemaPtr->recordePessoal, sistemaPtr->multiplicadorAtual);
-    
-    // Progresso do nivel com barra visual
-    int progresso = (int)((double)sistemaPtr->pontuacaoTotal / sistemaPtr->limitePontosNivel * 20);
-    printf("| Progresso: [");
-    for (int i = 0; i < 20; i++) {
-        printf(i < progresso ? "#" : "-");
+void iniciarResumoPartida(ResumoPartidaArquivo* resumoPtr, uint64_t partida) {
+    memset(resumoPtr, 0, sizeof(*resumoPtr));
+    resumoPtr->partida = partida;
+    resumoPtr->valores[COLUNA_EFICIENCIA_MINIMA] = 100;
+}
+
+/**
+ * @brief Acompanha a partida depois de cada ação (colunas que dependem do caminho)
+ * @param resumoPtr Resumo iniciado por iniciarResumoPartida()
+ * @param partidaPtr Partida logo depois de aplicarAcaoPartidaBot()
+ *
+ * O nível só sobe, então o maior combo enquanto o nível era menor que
+ * k + 2 é o melhor combo da última ação ainda abaixo desse nível.
+ */
+void acompanharResumoPartida(ResumoPartidaArquivo* resumoPtr, const EstadoPartidaBot* partidaPtr) {
+    const SistemaExpert* sistemaPtr = &partidaPtr->sistema;
+    for (int k = 0; k < NIVEIS_COMBO_ARQUIVO && sistemaPtr->nivelAtual < k + 2; k++) {
+        resumoPtr->valores[COLUNA_COMBO_ANTES_NIVEL + k] = sistemaPtr->melhorCombo;
     }
-    printf("] %3d%%    |\n", (int)((double)sistemaPtr->pontuacaoTotal / sistemaPtr->limitePontosNivel * 100));
-    
-    // Combos e Sequencias
-    printf("| Combo Atual: %3d      |  Melhor Combo: %3d           |\n", 
-           sistemaPtr->comboAtual, sistemaPtr->melhorCombo);
-    printf("| Sequencia: %3d        |  Ultima Peca: %c              |\n", 
-           sistemaPtr->sequenciaTipoAtual, sistemaPtr->ultimoTipoJogado);
-    
-    // Estatisticas de Tipos de Pecas
-    printf("+==============================================================+\n");
-    printf("| Tipo Mais Jogado: %c  |  Total de Jogadas: %4d        |\n", 
-           sistemaPtr->tipoMaisJogado, sistemaPtr->totalJogadas);
-    
-    printf("| Tipos de Pecas:                                      |\n");
-    printf("|   I:%2d  O:%2d  T:%2d  L:%2d                        |\n", 
-           sistemaPtr->contagemTipoI, sistemaPtr->contagemTipoO, 
-           sistemaPtr->contagemTipoT, sistemaPtr->contagemTipoL);
-    
-    // Eficiencia do Jogo
-    printf("+==============================================================+\n");
-    printf("| Jogadas da Fila: %4d   |  Jogadas da Pilha: %4d      |\n", 
-           sistemaPtr->jogadasDaFila, sistemaPtr->jogadasDaPilha);
-    
-    // Eficiencia da reserva com barra visual
-    int eficiencia = (int)(sistemaPtr->eficienciaReserva / 5); // Escala para 20 caracteres
-    printf("| Eficiencia Reserva: [");
-    for (int i = 0; i < 20; i++) {
-        printf(i < eficiencia ? "#" : "-");
+    if (sistemaPtr->totalJogadas >= PECAS_MINIMAS_EFICIENCIA) {
+        int eficiencia = eficienciaResumoPartida(sistemaPtr);
+        if (eficiencia < resumoPtr->valores[COLUNA_EFICIENCIA_MINIMA]) {
+            resumoPtr->valores[COLUNA_EFICIENCIA_MINIMA] = eficiencia;
+        }
+    }
+}
+
+/**
+ * @brief Preenche as colunas do fim da partida
+ * @param resumoPtr Resumo acompanhado até a última ação
+ * @param partidaPtr Partida encerrada
+ *
+ * Partidas com menos de PECAS_MINIMAS_EFICIENCIA peças ficam com a
+ * eficiência mínima igual à final.
+ */
+void concluirResumoPartida(ResumoPartidaArquivo* resumoPtr, const EstadoPartidaBot* partidaPtr) {
+    const SistemaExpert* sistemaPtr = &partidaPtr->sistema;
+    int32_t* valores = resumoPtr->valores;
+    valores[COLUNA_PONTUACAO] = sistemaPtr->pontuacaoTotal;
+    valores[COLUNA_NIVEL] = sistemaPtr->nivelAtual;
+    valores[COLUNA_MELHOR_COMBO] = sistemaPtr->melhorCombo;
+    valores[COLUNA_PECAS] = partidaPtr->pecasJogadas;
+    valores[COLUNA_LINHAS] = partidaPtr->linhasEliminadas;
+    valores[COLUNA_RESERVAS] = partidaPtr->acoesReserva;
+    valores[COLUNA_EFICIENCIA_RESERVA] = eficienciaResumoPartida(sistemaPtr);
+    if (sistemaPtr->totalJogadas < PECAS_MINIMAS_EFICIENCIA) {
+        valores[COLUNA_EFICIENCIA_MINIMA] = valores[COLUNA_EFICIENCIA_RESERVA];
+    }
+}
+
+/// Bit do mapa de nível/combo que representa o valor (63 junta 63 ou mais)
+static uint64_t bitZonaArquivo(int32_t valor) {
+    return UINT64_C(1) << (valor < 0 ? 0 : valor > 63 ? 63 : valor);
+}
+
+static void iniciarZonaArquivo(ZonaArquivoPartidas* zonaPtr) {
+    memset(zonaPtr, 0, sizeof(*zonaPtr));
+    for (int c = 0; c < COLUNAS_ARQUIVO; c++) {
+        zonaPtr->minimo[c] = INT32_MAX;
+        zonaPtr->maximo[c] = INT32_MIN;
+    }
+}
+
+static void acrescentarZonaArquivo(ZonaArquivoPartidas* zonaPtr, const ResumoPartidaArquivo* resumoPtr) {
+    for (int c = 0; c < COLUNAS_ARQUIVO; c++) {
+        int32_t valor = resumoPtr->valores[c];
+        zonaPtr->minimo[c] = valor < zonaPtr->minimo[c] ? valor : zonaPtr->minimo[c];
+        zonaPtr->maximo[c] = valor > zonaPtr->maximo[c] ? valor : zonaPtr->maximo[c];
+    }
+    zonaPtr->niveis |= bitZonaArquivo(resumoPtr->valores[COLUNA_NIVEL]);
+    zonaPtr->combos |= bitZonaArquivo(resumoPtr->valores[COLUNA_MELHOR_COMBO]);
+    zonaPtr->quantidade++;
+}
+
+/// Ordem do arquivo: nível, melhor combo, pontuação e semente
+static int compararResumosArquivo(const void* a, const void* b) {
+    const ResumoPartidaArquivo* x = a;
+    const ResumoPartidaArquivo* y = b;
+    static const int ordem[] = {COLUNA_NIVEL, COLUNA_MELHOR_COMBO, COLUNA_PONTUACAO};
+    for (size_t i = 0; i < sizeof(ordem) / sizeof(ordem[0]); i++) {
+        int32_t u = x->valores[ordem[i]], v = y->valores[ordem[i]];
+        if (u != v) {
+            return (u > v) - (u < v);
+        }
+    }
+    return (x->partida > y->partida) - (x->partida < y->partida);
+}
+
+/**
+ * @brief Grava um arquivo de partidas com o índice de zonas
+ * @param caminho Arquivo de saída (gravado em caminho.tmp e renomeado)
+ * @param partidas Resumos (reordenados no lugar)
+ * @param quantidade Número de resumos
+ * @return 1 em caso de sucesso, 0 em caso de falha
+ */
+int gravarArquivoPartidas(const char* caminho, ResumoPartidaArquivo* partidas, uint64_t quantidade) {
+    uint64_t quantidadeBlocos = (quantidade + PARTIDAS_POR_BLOCO_ARQUIVO - 1) / PARTIDAS_POR_BLOCO_ARQUIVO;
+    if (quantidadeBlocos > UINT32_MAX) {
+        fprintf(stderr, "Arquivo de partidas: %llu partidas excedem o limite\n", (unsigned long long)quantidade);
+        return 0;
+    }
+    qsort(partidas, (size_t)quantidade, sizeof(ResumoPartidaArquivo), compararResumosArquivo);
+
+    CabecalhoArquivoPartidas cabecalho;
+    memset(&cabecalho, 0, sizeof(cabecalho));
+    memcpy(cabecalho.magica, "TETRISAP", sizeof(cabecalho.magica));
+    cabecalho.versao = VERSAO_ARQUIVO_PARTIDAS;
+    cabecalho.colunas = COLUNAS_ARQUIVO;
+    cabecalho.quantidadePartidas = quantidade;
+    cabecalho.partidasPorBloco = PARTIDAS_POR_BLOCO_ARQUIVO;
+    cabecalho.quantidadeBlocos = (uint32_t)quantidadeBlocos;
+    iniciarZonaArquivo(&cabecalho.resumo);
+    ZonaArquivoPartidas* zonas = malloc(sizeof(ZonaArquivoPartidas) * (quantidadeBlocos > 0 ? quantidadeBlocos : 1));
+    if (zonas == NULL) {
+        fprintf(stderr, "Sem memoria para o indice de %s\n", caminho);
+        return 0;
+    }
+    for (uint64_t b = 0; b < quantidadeBlocos; b++) {
+        iniciarZonaArquivo(&zonas[b]);
+    }
+    for (uint64_t i = 0; i < quantidade; i++) {
+        acrescentarZonaArquivo(&zonas[i / PARTIDAS_POR_BLOCO_ARQUIVO], &partidas[i]);
+        acrescentarZonaArquivo(&cabecalho.resumo, &partidas[i]);
+    }
+
+    char temporario[4096];
+    snprintf(temporario, sizeof(temporario), "%s.tmp", caminho);
+    FILE* arquivo = fopen(temporario, "wb");
+    int gravou = arquivo != NULL && fwrite(&cabecalho, sizeof(cabecalho), 1, arquivo) == 1 &&
+                 fwrite(zonas, sizeof(ZonaArquivoPartidas), (size_t)quantidadeBlocos, arquivo) == quantidadeBlocos &&
+                 fwrite(partidas, sizeof(ResumoPartidaArquivo), (size_t)quantidade, arquivo) == quantidade;
+    free(zonas);
+    if (arquivo != NULL) {
+        gravou = fclose(arquivo) == 0 && gravou;
+    }
+    gravou = gravou && rename(temporario, caminho) == 0;
+    if (!gravou) {
+        fprintf(stderr, "Falha ao gravar o arquivo de partidas %s: %s\n", caminho, strerror(errno));
+        unlink(temporario);
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief Mapeia um arquivo de partidas só para leitura
+ * @param arquivoPtr Arquivo a inicializar
+ * @param caminho Arquivo gravado por gravarArquivoPartidas()
+ * @return 1 em caso de sucesso, 0 se o arquivo não existe ou não é reconhecido
+ */
+int abrirArquivoPartidas(ArquivoPartidas* arquivoPtr, const char* caminho) {
+    memset(arquivoPtr, 0, sizeof(*arquivoPtr));
+    int descritor = open(caminho, O_RDONLY | O_CLOEXEC);
+    struct stat informacoes;
+    if (descritor < 0 || fstat(descritor, &informacoes) != 0) {
+        fprintf(stderr, "Nao foi possivel abrir o arquivo de partidas %s: %s\n", caminho, strerror(errno));
+        if (descritor >= 0) {
+            close(descritor);
+        }
+        return 0;
+    }
+    size_t tamanho = (size_t)informacoes.st_size;
+    void* regiao = tamanho >= sizeof(CabecalhoArquivoPartidas)
+                   ? mmap(NULL, tamanho, PROT_READ, MAP_PRIVATE, descritor, 0) : MAP_FAILED;
+    close(descritor);   // O mapeamento continua válido sem o descritor
+    const CabecalhoArquivoPartidas* cabecalhoPtr = regiao;
+    int valido = regiao != MAP_FAILED &&
+                 memcmp(cabecalhoPtr->magica, "TETRISAP", sizeof(cabecalhoPtr->magica)) == 0 &&
+                 cabecalhoPtr->versao == VERSAO_ARQUIVO_PARTIDAS && cabecalhoPtr->colunas == COLUNAS_ARQUIVO &&
+                 cabecalhoPtr->partidasPorBloco > 0 &&
+                 cabecalhoPtr->quantidadeBlocos == (cabecalhoPtr->quantidadePartidas + cabecalhoPtr->partidasPorBloco - 1) /
+                                                   cabecalhoPtr->partidasPorBloco &&
+                 cabecalhoPtr->quantidadePartidas <= tamanho / sizeof(ResumoPartidaArquivo) &&
+                 sizeof(CabecalhoArquivoPartidas) + sizeof(ZonaArquivoPartidas) * (uint64_t)cabecalhoPtr->quantidadeBlocos +
+                     sizeof(ResumoPartidaArquivo) * cabecalhoPtr->quantidadePartidas == tamanho;
+    if (!valido) {
+        fprintf(stderr, "Arquivo de partidas %s nao reconhecido (formato ou versao diferente, ou arquivo truncado)\n",
+                caminho);
+        if (regiao != MAP_FAILED) {
+            munmap(regiao, tamanho);
+        }
+        return 0;
+    }
+
+    arquivoPtr->mapa = regiao;
+    arquivoPtr->tamanho = tamanho;
+    arquivoPtr->cabecalho = cabecalhoPtr;
+    arquivoPtr->zonas = (const ZonaArquivoPartidas*)(arquivoPtr->mapa + sizeof(CabecalhoArquivoPartidas));
+    arquivoPtr->partidas = (const ResumoPartidaArquivo*)(arquivoPtr->zonas + cabecalhoPtr->quantidadeBlocos);
+    return 1;
+}
+
+/**
+ * @brief Desfaz o mapeamento do arquivo de partidas
+ */
+void fecharArquivoPartidas(ArquivoPartidas* arquivoPtr) {
+    if (arquivoPtr->mapa != NULL) {
+        munmap((void*)arquivoPtr->mapa, arquivoPtr->tamanho);
+    }
+    memset(arquivoPtr, 0, sizeof(*arquivoPtr));
+}
+
+/**
+ * @brief Lê uma consulta no formato "campo op valor, campo op valor, ..."
+ * @param texto Consulta (ex.: "comboAntesNivel3 >= 8, eficienciaMinima > 50")
+ * @param consultaPtr Consulta (saída)
+ * @return 1 em caso de sucesso, 0 se a consulta é inválida (mensagem em stderr)
+ *
+ * Operadores: >=, <=, >, <, = e ==. Condições no mesmo campo se somam
+ * (nivel >= 2, nivel <= 4 vira um intervalo só). Os campos são os de
+ * nomesColunasArquivo.
+ */
+int lerConsultaPartidas(const char* texto, ConsultaPartidas* consultaPtr) {
+    memset(consultaPtr, 0, sizeof(*consultaPtr));
+    const char* cursor = texto;
+    while (*cursor != '\0') {
+        while (isspace((unsigned char)*cursor) || *cursor == ',') {
+            cursor++;
+        }
+        if (*cursor == '\0') {
+            break;
+        }
+        const char* nome = cursor;
+        while (isalnum((unsigned char)*cursor)) {
+            cursor++;
+        }
+        size_t tamanhoNome = (size_t)(cursor - nome);
+        int coluna = -1;
+        for (int c = 0; c < COLUNAS_ARQUIVO; c++) {
+            if (strlen(nomesColunasArquivo[c]) == tamanhoNome && strncmp(nomesColunasArquivo[c], nome, tamanhoNome) == 0) {
+                coluna = c;
+            }
+        }
+        if (coluna < 0) {
+            fprintf(stderr, "Consulta: campo desconhecido '%.*s'\n", (int)tamanhoNome, nome);
+            return 0;
+        }
+        while (isspace((unsigned char)*cursor)) {
+            cursor++;
+        }
+        char operador = *cursor, igual = 0;
+        if (operador != '<' && operador != '>' && operador != '=') {
+            fprintf(stderr, "Consulta: operador esperado depois de '%s'\n", nomesColunasArquivo[coluna]);
+            return 0;
+        }
+        cursor++;
+        if (*cursor == '=') {
+            igual = 1;
+            cursor++;
+        }
+        char* fim;
+        errno = 0;
+        long long valor = strtoll(cursor, &fim, 10);
+        if (fim == cursor || errno != 0 || valor < INT32_MIN || valor > INT32_MAX) {
+            fprintf(stderr, "Consulta: valor invalido para '%s'\n", nomesColunasArquivo[coluna]);
+            return 0;
+        }
+        cursor = fim;
+        long long minimo = INT32_MIN, maximo = INT32_MAX;
+        if (operador == '=') {
+            minimo = maximo = valor;
+        } else if (operador == '>') {
+            minimo = igual ? valor : valor + 1;
+        } else {
+            maximo = igual ? valor : valor - 1;
+        }
+
+        CondicaoConsulta* condicaoPtr = NULL;
+        for (int i = 0; i < consultaPtr->quantidade; i++) {
+            if (consultaPtr->condicoes[i].coluna == coluna) {
+                condicaoPtr = &consultaPtr->condicoes[i];
+            }
+        }
+        if (condicaoPtr == NULL) {
+            // Cada campo ocupa uma condição, então COLUNAS_ARQUIVO <= MAX_CONDICOES_CONSULTA basta
+            condicaoPtr = &consultaPtr->condicoes[consultaPtr->quantidade++];
+            condicaoPtr->coluna = coluna;
+            condicaoPtr->minimo = INT32_MIN;
+            condicaoPtr->maximo = INT32_MAX;
+        }
+        // Intervalo vazio (ex.: pecas < INT32_MIN) fica com minimo > maximo e nada satisfaz
+        if (minimo > condicaoPtr->minimo) {
+            condicaoPtr->minimo = minimo > INT32_MAX ? INT32_MAX : (int32_t)minimo;
+            if (minimo > INT32_MAX) {
+                condicaoPtr->maximo = INT32_MIN;
+            }
+        }
+        if (maximo < condicaoPtr->maximo) {
+            condicaoPtr->maximo = maximo < INT32_MIN ? INT32_MIN : (int32_t)maximo;
+            if (maximo < INT32_MIN) {
+                condicaoPtr->minimo = INT32_MAX;
+            }
+        }
+        while (isspace((unsigned char)*cursor)) {
+            cursor++;
+        }
+        if (*cursor != '\0' && *cursor != ',') {
+            fprintf(stderr, "Consulta: esperado ',' antes de \"%s\"\n", cursor);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/// Bits do mapa de nível/combo que podem satisfazer "minimo <= valor <= maximo"
+static uint64_t mascaraZonaArquivo(int32_t minimo, int32_t maximo) {
+    if (minimo > maximo) {
+        return 0;
+    }
+    uint64_t ate = bitZonaArquivo(maximo);
+    return (ate | (ate - 1)) & ~(bitZonaArquivo(minimo) - 1);
+}
+
+/// 0 se nenhuma partida da zona pode satisfazer a consulta
+static int zonaPodeSatisfazer(const ZonaArquivoPartidas* zonaPtr, const ConsultaPartidas* consultaPtr) {
+    if (zonaPtr->quantidade == 0) {
+        return 0;
+    }
+    for (int i = 0; i < consultaPtr->quantidade; i++) {
+        const CondicaoConsulta* condicaoPtr = &consultaPtr->condicoes[i];
+        int c = condicaoPtr->coluna;
+        if (zonaPtr->maximo[c] < condicaoPtr->minimo || zonaPtr->minimo[c] > condicaoPtr->maximo) {
+            return 0;
+        }
+        uint64_t mascara = mascaraZonaArquivo(condicaoPtr->minimo, condicaoPtr->maximo);
+        if ((c == COLUNA_NIVEL && (zonaPtr->niveis & mascara) == 0) ||
+            (c == COLUNA_MELHOR_COMBO && (zonaPtr->combos & mascara) == 0)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static int partidaSatisfaz(const ResumoPartidaArquivo* resumoPtr, const ConsultaPartidas* consultaPtr) {
+    for (int i = 0; i < consultaPtr->quantidade; i++) {
+        const CondicaoConsulta* condicaoPtr = &consultaPtr->condicoes[i];
+        int32_t valor = resumoPtr->valores[condicaoPtr->coluna];
+        if (valor < condicaoPtr->minimo || valor > condicaoPtr->maximo) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * @brief Procura as partidas de um arquivo que satisfazem a consulta
+ * @param arquivoPtr Arquivo aberto
+ * @param consultaPtr Consulta lida por lerConsultaPartidas()
+ * @param usarIndice 1 = descarta o arquivo e os blocos pelas zonas; 0 = lê tudo
+ * @param visitar Chamada para cada partida encontrada (NULL = só contar)
+ * @param contexto Repassado a visitar
+ * @param estatisticasPtr Acumula o que foi lido (não é zerado aqui)
+ * @return Partidas encontradas neste arquivo
+ *
+ * As partidas de um bloco só são lidas se a zona dele pode satisfazer a
+ * consulta; o resultado é o mesmo com e sem índice.
+ */
+uint64_t consultarArquivoPartidas(const ArquivoPartidas* arquivoPtr, const ConsultaPartidas* consultaPtr,
+                                  int usarIndice, VisitarPartidaConsulta visitar, void* contexto,
+                                  EstatisticasConsulta* estatisticasPtr) {
+    const CabecalhoArquivoPartidas* cabecalhoPtr = arquivoPtr->cabecalho;
+    estatisticasPtr->arquivos++;
+    estatisticasPtr->blocos += cabecalhoPtr->quantidadeBlocos;
+    if (usarIndice && !zonaPodeSatisfazer(&cabecalhoPtr->resumo, consultaPtr)) {
+        estatisticasPtr->arquivosDescartados++;
+        estatisticasPtr->blocosDescartados += cabecalhoPtr->quantidadeBlocos;
+        return 0;
+    }
+    uint64_t encontradas = 0;
+    for (uint32_t b = 0; b < cabecalhoPtr->quantidadeBlocos; b++) {
+        if (usarIndice && !zonaPodeSatisfazer(&arquivoPtr->zonas[b], consultaPtr)) {
+            estatisticasPtr->blocosDescartados++;
+            continue;
+        }
+        uint64_t inicio = (uint64_t)b * cabecalhoPtr->partidasPorBloco;
+        uint64_t fim = inicio + cabecalhoPtr->partidasPorBloco;
+        fim = fim < cabecalhoPtr->quantidadePartidas ? fim : cabecalhoPtr->quantidadePartidas;
+        estatisticasPtr->partidasLidas += fim - inicio;
+        for (uint64_t i = inicio; i < fim; i++) {
+            if (partidaSatisfaz(&arquivoPtr->partidas[i], consultaPtr)) {
+                encontradas++;
+                if (visitar != NULL) {
+                    visitar(&arquivoPtr->partidas[i], contexto);
+                }
+            }
+        }
+    }
+    estatisticasPtr->encontradas += encontradas;
+    return encontradas;
+}
+
+/// Contexto de executarModoConsulta(): quantas partidas ainda listar
+typedef struct {
+    long restantes;
+    const char* caminho;
+} ListagemConsulta;
+
+static void listarPartidaConsulta(const ResumoPartidaArquivo* resumoPtr, void* contexto) {
+    ListagemConsulta* listagemPtr = contexto;
+    if (listagemPtr->restantes <= 0) {
+        return;
+    }
+    listagemPtr->restantes--;
+    const int32_t* valores = resumoPtr->valores;
+    printf("  %s | partida %llu: pontuacao %d | nivel %d | melhor combo %d | %d pecas | %d linhas | "
+           "reserva %d%% (minima %d%%) | combo antes do nivel 3: %d\n", listagemPtr->caminho,
+           (unsigned long long)resumoPtr->partida, valores[COLUNA_PONTUACAO], valores[COLUNA_NIVEL],
+           valores[COLUNA_MELHOR_COMBO], valores[COLUNA_PECAS], valores[COLUNA_LINHAS],
+           valores[COLUNA_EFICIENCIA_RESERVA], valores[COLUNA_EFICIENCIA_MINIMA],
+           valores[COLUNA_COMBO_ANTES_NIVEL + 1]);
+}
+
+/**
+ * @brief Modo --consultar: consultas sobre arquivos de partidas
+ *
+ * Uso: tetris --consultar arquivo... --onde "consulta" [--listar n] [--sem-indice]
+ *
+ * Os arquivos são gravados por ferramentas/arquivar_partidas.c. Mostra
+ * quantas partidas satisfazem a consulta, quantos arquivos e blocos o
+ * índice descartou sem ler e as primeiras n partidas encontradas.
+ * --sem-indice lê todas as partidas (para comparar).
+ */
+int executarModoConsulta(int argc, char* argv[]) {
+    const char* textoConsulta = NULL;
+    long listar = 10;
+    int usarIndice = 1;
+    int quantidadeCaminhos = 0;
+    const char** caminhos = malloc(sizeof(char*) * (size_t)argc);
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--onde") == 0 && i + 1 < argc) {
+            textoConsulta = argv[++i];
+        } else if (strcmp(argv[i], "--listar") == 0 && i + 1 < argc) {
+            listar = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--sem-indice") == 0) {
+            usarIndice = 0;
+        } else {
+            caminhos[quantidadeCaminhos++] = argv[i];
+        }
+    }
+    ConsultaPartidas consulta;
+    if (quantidadeCaminhos == 0 || textoConsulta == NULL) {
+        fprintf(stderr, "Uso: %s --consultar arquivo... --onde \"campo >= valor, ...\" [--listar n] [--sem-indice]\n"
+                "Campos:", argv[0]);
+        for (int c = 0; c < COLUNAS_ARQUIVO; c++) {
+            fprintf(stderr, " %s", nomesColunasArquivo[c]);
+        }
+        fprintf(stderr, "\n");
+        free(caminhos);
+        return 1;
+    }
+    if (!lerConsultaPartidas(textoConsulta, &consulta)) {
+        free(caminhos);
+        return 1;
     }
-    printf("] %5.1f%% |\n", (double)sistemaPtr->eficienciaReserva);
-    
-    // Conquistas e Marcos
-    printf("| Marcos Alcancados: %2d  |  Fator Dificuldade: %.1fx      |\n", 
-           sistemaPtr->marcosAlcancados, sistemaPtr->fatorDificuldade);
-    
-    printf("+==============================================================+\n");
+
+    EstatisticasConsulta estatisticas;
+    memset(&estatisticas, 0, sizeof(estatisticas));
+    ListagemConsulta listagem = {listar, NULL};
+    uint64_t totalPartidas = 0;
+    int falhas = 0;
+    struct timespec antes, depois;
+    printf("Consulta: %s (%s)\n", textoConsulta, usarIndice ? "com indice" : "sem indice");
+    clock_gettime(CLOCK_MONOTONIC, &antes);
+    for (int i = 0; i < quantidadeCaminhos; i++) {
+        ArquivoPartidas arquivo;
+        if (!abrirArquivoPartidas(&arquivo, caminhos[i])) {
+            falhas++;
+            continue;
+        }
+        listagem.caminho = caminhos[i];
+        totalPartidas += arquivo.cabecalho->quantidadePartidas;
+        consultarArquivoPartidas(&arquivo, &consulta, usarIndice, listarPartidaConsulta, &listagem, &estatisticas);
+        fecharArquivoPartidas(&arquivo);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &depois);
+    double milissegundos = (depois.tv_sec - antes.tv_sec) * 1e3 + (depois.tv_nsec - antes.tv_nsec) * 1e-6;
+
+    printf("Arquivos: %llu (%llu descartados) | blocos: %llu (%llu descartados) | partidas lidas: %llu de %llu\n",
+           (unsigned long long)estatisticas.arquivos, (unsigned long long)estatisticas.arquivosDescartados,
+           (unsigned long long)estatisticas.blocos, (unsigned long long)estatisticas.blocosDescartados,
+           (unsigned long long)estatisticas.partidasLidas, (unsigned long long)totalPartidas);
+    printf("Encontradas: %llu partidas em %.2f ms\n", (unsigned long long)estatisticas.encontradas, milissegundos);
+    free(caminhos);
+    return falhas == 0 ? 0 : 1;
+}
+
+// ═══════════════════════════════════════════════════════════════════════════════
+//                       MOTOR EM TEMPO REAL (PASSO FIXO)
+// ═══════════════════════════════════════════════════════════════════════════════
+
+/// Pedido de encerramento vindo de Ctrl+C (o laço restaura o terminal e sai)
+static volatile sig_atomic_t sinalEncerrarTempoReal = 0;
+
+static void tratarSinalTempoReal(int sinal) {
+    (void)sinal;
+    sinalEncerrarTempoReal = 1;
 }
 
 /**
- * @brief Otimiza e valida o sistema Expert
- * @param sistemaPtr Ponteiro para o sistema Expert
- * @return 1 se otimização foi aplicada, 0 caso contrário
+ * @brief Tempo de queda de uma linha no nível e na dificuldade atuais
+ * @param sistemaPtr Sistema Expert da partida
+ * @return Segundos por linha
+ *
+ * Curva de níveis clássica, (0,8 - (nível - 1) x 0,007)^(nível - 1): 1 s
+ * no nível 1, cerca de 64 ms no nível 10 e queda instantânea perto do 20.
+ * O fator de dificuldade divide o tempo.
  */
-int otimizarSistemaExpert(SistemaExpert* sistemaPtr) {
-    int otimizacaoAplicada = 0;
-    
-    // Validação e correção de valores inconsistentes
-    if (sistemaPtr->multiplicadorAtual > 10.0) {
-        sistemaPtr->multiplicadorAtual = 10.0;
-        otimizacaoAplicada = 1;
-    }
-    
-    if (sistemaPtr->multiplicadorAtual < 1.0) {
-        sistemaPtr->multiplicadorAtual = 1.0;
-        otimizacaoAplicada = 1;
+double segundosPorLinha(const SistemaExpert* sistemaPtr) {
+    int nivel = sistemaPtr->nivelAtual < 1 ? 1 : (sistemaPtr->nivelAtual > 20 ? 20 : sistemaPtr->nivelAtual);
+    double segundos = pow(0.8 - (nivel - 1) * 0.007, nivel - 1);
+    return segundos / (sistemaPtr->fatorDificuldade > 1.0 ? sistemaPtr->fatorDificuldade : 1.0);
+}
+
+/// Recalcula a gravidade (chamada quando nível ou dificuldade podem ter mudado)
+static void atualizarGravidadeTempoReal(PartidaTempoReal* partidaPtr) {
+    double gravidade = UNIDADE_GRAVIDADE / (segundosPorLinha(&partidaPtr->sistema) * partidaPtr->ticksPorSegundo);
+    partidaPtr->gravidade = gravidade >= GRAVIDADE_MAXIMA ? GRAVIDADE_MAXIMA
+                            : (gravidade < 1.0 ? 1u : (uint32_t)gravidade);
+}
+
+/// A peça cabe inteira no tabuleiro, sem sobrepor blocos
+static int pecaCabeTempoReal(const Tabuleiro* tabPtr, const Jogada* pecaPtr) {
+    const FormaPeca* forma = &FORMAS_PECA[indiceTipoPeca(pecaPtr->tipo)][pecaPtr->rotacao];
+    if (pecaPtr->coluna + forma->largura > LARGURA_TABULEIRO || pecaPtr->linha + forma->altura > ALTURA_TABULEIRO) {
+        return 0;
     }
-    
-    // Recálculo da eficiência se necessário
-    if (sistemaPtr->totalJogadas > 0) {
-        double novaEficiencia = (double)sistemaPtr->jogadasDaPilha / sistemaPtr->totalJogadas * 100.0;
-        if (abs((int)(novaEficiencia - sistemaPtr->eficienciaReserva)) > 1) {
-            sistemaPtr->eficienciaReserva = novaEficiencia;
-            otimizacaoAplicada = 1;
+    for (int i = 0; i < forma->altura; i++) {
+        if (tabPtr->linhas[pecaPtr->linha + i] & (uint16_t)(forma->linhas[i] << pecaPtr->coluna)) {
+            return 0;
         }
     }
-    
-    // Ajuste automático da dificuldade baseado no desempenho
-    if (sistemaPtr->nivelAtual > 5 && sistemaPtr->fatorDificuldade < 2.0) {
-        sistemaPtr->fatorDificuldade = 1.0 + (sistemaPtr->nivelAtual - 1) * 0.2;
-        otimizacaoAplicada = 1;
+    return 1;
+}
+
+/// A peça não pode descer mais
+static int pecaApoiadaTempoReal(const PartidaTempoReal* partidaPtr) {
+    Jogada abaixo = partidaPtr->ativa;
+    if (abaixo.linha == 0) {
+        return 1;
     }
-    
-    return otimizacaoAplicada;
+    abaixo.linha--;
+    return !pecaCabeTempoReal(&partidaPtr->tabuleiro, &abaixo);
 }
 
 /**
- * @brief Gera relatório detalhado do sistema Expert
- * @param sistemaPtr Ponteiro para o sistema Expert
+ * @brief Monta a peça que surgiria da fila ou da reserva, no topo e centralizada
+ * @return 1 se ela cabe (0 também quando a origem está vazia)
  */
-void gerarRelatorioExpert(SistemaExpert* sistemaPtr) {
-    printf("\n+==============================================================+\n");
-    printf("|                     RELATORIO EXPERT                        |\n");
-    printf("+==============================================================+\n");
-    
-    // Analise de Performance
-    printf("\n*** ANALISE DE PERFORMANCE:\n");
-    printf("   * Pontuacao Media por Jogada: %.1f\n", 
-           sistemaPtr->totalJogadas > 0 ? (double)sistemaPtr->pontuacaoTotal / sistemaPtr->totalJogadas : 0);
-    printf("   * Taxa de Uso da Reserva: %.1f%%\n", 
-           sistemaPtr->totalJogadas > 0 ? (double)sistemaPtr->jogadasDaPilha / sistemaPtr->totalJogadas * 100 : 0);
-    printf("   * Progressao de Nivel: %d niveis alcancados\n", sistemaPtr->nivelAtual - 1);
-    
-    // Recomendacoes Estrategicas
-    printf("\n*** RECOMENDACOES ESTRATEGICAS:\n");
-    if (sistemaPtr->eficienciaReserva < 20) {
-        printf("   * Utilize mais a pilha de reserva para melhor estrategia\n");
+static int prepararSurgimentoTempoReal(const PartidaTempoReal* partidaPtr, int origem, Jogada* pecaPtr) {
+    const Peca* origemPtr = origem == 0 ? espiarFila(&partidaPtr->fila, 0) : espiarPilha(&partidaPtr->pilha, 0);
+    if (origemPtr == NULL || indiceTipoPeca(origemPtr->tipo) < 0) {
+        return 0;
     }
-    if (sistemaPtr->melhorCombo < 5) {
-        printf("   * Foque em formar combos de pecas consecutivas\n");
-    }
-    if (sistemaPtr->sequenciaTipoAtual < 3) {
-        printf("   * Mantenha sequencias longas para maximizar multiplicadores\n");
+    const FormaPeca* forma = &FORMAS_PECA[indiceTipoPeca(origemPtr->tipo)][0];
+    memset(pecaPtr, 0, sizeof(*pecaPtr));
+    pecaPtr->tipo = origemPtr->tipo;
+    pecaPtr->coluna = (unsigned char)((LARGURA_TABULEIRO - forma->largura) / 2);
+    pecaPtr->linha = (unsigned char)(ALTURA_TABULEIRO - forma->altura);
+    pecaPtr->origem = (unsigned char)origem;
+    return pecaCabeTempoReal(&partidaPtr->tabuleiro, pecaPtr);
+}
+
+/// Coloca em jogo a peça da origem; se ela não couber, a partida acaba
+static void surgirPecaTempoReal(PartidaTempoReal* partidaPtr, int origem) {
+    if (!prepararSurgimentoTempoReal(partidaPtr, origem, &partidaPtr->ativa)) {
+        partidaPtr->encerrada = 1;
     }
-    
-    // Projecoes de Melhoria
-    printf("\n*** PROJECOES DE MELHORIA:\n");
-    int proximoNivel = sistemaPtr->limitePontosNivel - sistemaPtr->pontuacaoTotal;
-    printf("   * Pontos para proximo nivel: %d\n", proximoNivel);
-    printf("   * Potencial de pontuacao com combo maximo: %d\n", 
-           sistemaPtr->pontuacaoTotal + (sistemaPtr->melhorCombo * 100));
-    printf("   * Eficiencia otima da reserva: 40-60%%\n");
+    partidaPtr->acumuladorQueda = 0;
+    partidaPtr->ticksApoiada = 0;
+    partidaPtr->adiamentosFixacao = 0;
+    partidaPtr->alterada = 1;
+}
+
+/// Fixa a peça ativa, pontua pelo Sistema Expert e traz a próxima da fila
+static void fixarPecaTempoReal(PartidaTempoReal* partidaPtr) {
+    int origem = partidaPtr->ativa.origem;
+    Peca peca = origem == 0 ? jogarPecaDaFila(&partidaPtr->fila) : jogarPecaDaPilha(&partidaPtr->pilha);
+    partidaPtr->linhasEliminadas += aplicarJogada(&partidaPtr->tabuleiro, &partidaPtr->ativa);
+    processarJogadaExpert(peca, origem, &partidaPtr->sistema);
+    partidaPtr->pecasJogadas++;
+    reabastecerFila(&partidaPtr->fila, &partidaPtr->gerador);
+    atualizarGravidadeTempoReal(partidaPtr);
+    partidaPtr->pecasSurgidas++;
+    surgirPecaTempoReal(partidaPtr, 0);
 }
 
 /**
- * @brief Cria uma nova peça
- * @param tipo Tipo da peça
- * @param id ID da peça
- * @return Nova peça criada
+ * @brief Prepara uma partida em tempo real com a primeira peça em jogo
+ * @param partidaPtr Partida a inicializar
+ * @param semente Semente do gerador de peças
+ * @param ticksPorSegundo Passos da simulação por segundo de jogo
+ * @param capacidadeFila Peças na prévia
+ * @param capacidadePilha Peças na reserva
+ * @param regras Regras de pontuação (REGRAS_EXPERT, ...)
  */
-Peca criarPeca(char tipo, int id) {
-    Peca novaPeca;
-    novaPeca.tipo = tipo;
-    novaPeca.id = id;
-    return novaPeca;
+void iniciarPartidaTempoReal(PartidaTempoReal* partidaPtr, uint64_t semente, int ticksPorSegundo,
+                             int capacidadeFila, int capacidadePilha, int regras) {
+    memset(partidaPtr, 0, sizeof(*partidaPtr));
+    inicializarFila(&partidaPtr->fila);
+    inicializarPilha(&partidaPtr->pilha);
+    configurarCapacidadeFila(&partidaPtr->fila, capacidadeFila);
+    configurarCapacidadePilha(&partidaPtr->pilha, capacidadePilha);
+    inicializarSistemaExpert(&partidaPtr->sistema);
+    definirRegrasPontuacao(&partidaPtr->sistema, regras);
+    limparTabuleiro(&partidaPtr->tabuleiro);
+    inicializarGeradorPecas(&partidaPtr->gerador, semente);
+    reabastecerFila(&partidaPtr->fila, &partidaPtr->gerador);
+    partidaPtr->ticksPorSegundo = ticksPorSegundo > 0 ? ticksPorSegundo : TICKS_POR_SEGUNDO_PADRAO;
+    partidaPtr->ticksFixacao = (ATRASO_FIXACAO_MS * partidaPtr->ticksPorSegundo + 999) / 1000;
+    atualizarGravidadeTempoReal(partidaPtr);
+    surgirPecaTempoReal(partidaPtr, 0);
 }
 
 /**
- * @brief Gera peças aleatórias para a fila
- * @param filaPtr Ponteiro para a fila
+ * @brief Libera a fila e a reserva da partida
+ * @param partidaPtr Partida iniciada por iniciarPartidaTempoReal()
  */
-void gerarPecasAleatorias(FilaCircular* filaPtr) {
-    char tipos[] = {'I', 'O', 'T', 'S', 'Z', 'J', 'L'};
-    for (int i = 0; i < 5; i++) {
-        char tipoAleatorio = tipos[rand() % 7];
-        Peca novaPeca = criarPeca(tipoAleatorio, proximoId++);
-        inserirPecaNaFila(filaPtr, novaPeca);
+void liberarPartidaTempoReal(PartidaTempoReal* partidaPtr) {
+    liberarFila(&partidaPtr->fila);
+    liberarPilha(&partidaPtr->pilha);
+}
+
+/**
+ * @brief Aplica um comando do jogador à peça ativa
+ * @param partidaPtr Partida em andamento
+ * @param comando Comando recebido
+ * @return 1 se a partida mudou, 0 se o comando foi recusado (parede, bloco, reserva cheia)
+ *
+ * Mover ou girar a peça apoiada reinicia o atraso de fixação, no máximo
+ * MAX_ADIAMENTOS_FIXACAO vezes por peça. A rotação tenta a mesma coluna e
+ * depois uma à esquerda, uma à direita e duas à esquerda.
+ */
+int aplicarComandoTempoReal(PartidaTempoReal* partidaPtr, ComandoTempoReal comando) {
+    static const int chutes[] = {0, -1, 1, -2};
+    if (partidaPtr->encerrada) {
+        return 0;
+    }
+    Jogada nova = partidaPtr->ativa;
+    switch (comando) {
+        case COMANDO_ESQUERDA:
+            if (nova.coluna == 0) {
+                return 0;
+            }
+            nova.coluna--;
+            break;
+        case COMANDO_DIREITA:
+            nova.coluna++;
+            break;
+        case COMANDO_GIRAR: {
+            int indiceTipo = indiceTipoPeca(nova.tipo);
+            nova.rotacao = (unsigned char)((nova.rotacao + 1) % ROTACOES_DISTINTAS[indiceTipo]);
+            if (nova.rotacao == partidaPtr->ativa.rotacao) {
+                return 0;
+            }
+            const FormaPeca* forma = &FORMAS_PECA[indiceTipo][nova.rotacao];
+            if (nova.linha + forma->altura > ALTURA_TABULEIRO) {
+                nova.linha = (unsigned char)(ALTURA_TABULEIRO - forma->altura);
+            }
+            int base = nova.coluna + forma->largura > LARGURA_TABULEIRO ? LARGURA_TABULEIRO - forma->largura
+                                                                         : nova.coluna;
+            int coube = 0;
+            for (size_t i = 0; i < sizeof(chutes) / sizeof(chutes[0]) && !coube; i++) {
+                if (base + chutes[i] >= 0) {
+                    nova.coluna = (unsigned char)(base + chutes[i]);
+                    coube = pecaCabeTempoReal(&partidaPtr->tabuleiro, &nova);
+                }
+            }
+            if (!coube) {
+                return 0;
+            }
+            break;
+        }
+        case COMANDO_QUEDA_SUAVE:
+            if (nova.linha == 0) {
+                return 0;
+            }
+            nova.linha--;
+            if (!pecaCabeTempoReal(&partidaPtr->tabuleiro, &nova)) {
+                return 0;
+            }
+            partidaPtr->ativa = nova;
+            partidaPtr->acumuladorQueda = 0;
+            partidaPtr->alterada = 1;
+            return 1;
+        case COMANDO_QUEDA_RAPIDA:
+            while (!pecaApoiadaTempoReal(partidaPtr)) {
+                partidaPtr->ativa.linha--;
+            }
+            fixarPecaTempoReal(partidaPtr);
+            return 1;
+        case COMANDO_RESERVAR:
+            if (partidaPtr->ativa.origem != 0 || pilhaCheia(&partidaPtr->pilha)) {
+                return 0;
+            }
+            transferirPecaFilaParaPilha(&partidaPtr->fila, &partidaPtr->pilha);
+            reabastecerFila(&partidaPtr->fila, &partidaPtr->gerador);
+            partidaPtr->pecasSurgidas++;
+            surgirPecaTempoReal(partidaPtr, 0);
+            return 1;
+        case COMANDO_USAR_RESERVA:
+            if (!prepararSurgimentoTempoReal(partidaPtr, partidaPtr->ativa.origem ^ 1, &nova)) {
+                return 0;
+            }
+            surgirPecaTempoReal(partidaPtr, nova.origem);
+            return 1;
+        case COMANDO_SAIR:
+            partidaPtr->encerrada = 1;
+            partidaPtr->alterada = 1;
+            return 1;
+        default:
+            return 0;
+    }
+
+    if (!pecaCabeTempoReal(&partidaPtr->tabuleiro, &nova)) {
+        return 0;
+    }
+    partidaPtr->ativa = nova;
+    partidaPtr->alterada = 1;
+    if (partidaPtr->ticksApoiada > 0 && partidaPtr->adiamentosFixacao < MAX_ADIAMENTOS_FIXACAO) {
+        partidaPtr->ticksApoiada = 0;
+        partidaPtr->adiamentosFixacao++;
     }
+    return 1;
 }
 
 /**
- * @brief Transfere uma peça da fila para a pilha
- * @param filaPtr Ponteiro para a fila
- * @param pilhaPtr Ponteiro para a pilha
+ * @brief Avança um passo fixo: gravidade e atraso de fixação
+ * @param partidaPtr Partida em andamento
  */
-void transferirPecaFilaParaPilha(FilaCircular* filaPtr, PilhaReserva* pilhaPtr) {
-    if (!filaVazia(filaPtr) && !pilhaCheia(pilhaPtr)) {
-        Peca peca = jogarPecaDaFila(filaPtr);
-        reservarPeca(pilhaPtr, peca);
-        printf("Peca %c transferida da fila para a pilha de reserva.\n", peca.tipo);
+void avancarTickTempoReal(PartidaTempoReal* partidaPtr) {
+    if (partidaPtr->encerrada) {
+        return;
+    }
+    partidaPtr->tick++;
+    partidaPtr->acumuladorQueda += partidaPtr->gravidade;
+    while (partidaPtr->acumuladorQueda >= UNIDADE_GRAVIDADE) {
+        if (pecaApoiadaTempoReal(partidaPtr)) {
+            partidaPtr->acumuladorQueda = 0;
+            break;
+        }
+        partidaPtr->acumuladorQueda -= UNIDADE_GRAVIDADE;
+        partidaPtr->ativa.linha--;
+        partidaPtr->ticksApoiada = 0;
+        partidaPtr->alterada = 1;
+    }
+    if (!pecaApoiadaTempoReal(partidaPtr)) {
+        partidaPtr->ticksApoiada = 0;
+    } else if (++partidaPtr->ticksApoiada >= partidaPtr->ticksFixacao) {
+        fixarPecaTempoReal(partidaPtr);
     }
 }
 
 /**
- * @brief Exibe o estado completo do sistema
- * @param filaPtr Ponteiro para a fila
- * @param pilhaPtr Ponteiro para a pilha
- * @param sistemaPtr Ponteiro para o sistema Expert
+ * @brief Desenha a partida em um buffer com sequências ANSI
+ * @param partidaPtr Partida a desenhar
+ * @param tela Buffer de saída
+ * @param capacidade Tamanho do buffer
+ * @return Bytes escritos em tela
+ *
+ * Tudo em uma escrita só: o cursor volta ao início e cada linha apaga o
+ * resto da anterior, sem limpar a tela inteira (que piscaria).
  */
-void exibirEstadoCompleto(FilaCircular* filaPtr, PilhaReserva* pilhaPtr, SistemaExpert* sistemaPtr) {
-    printf("\n===============================================================\n");
-    printf("                    ESTADO ATUAL DO SISTEMA\n");
-    printf("===============================================================\n");
-    
-    exibirFila(filaPtr);
-    exibirPilha(pilhaPtr);
-    exibirEstatisticasExpert(sistemaPtr);
+size_t desenharPartidaTempoReal(const PartidaTempoReal* partidaPtr, char* tela, size_t capacidade) {
+    const SistemaExpert* sistemaPtr = &partidaPtr->sistema;
+    const FormaPeca* forma = &FORMAS_PECA[indiceTipoPeca(partidaPtr->ativa.tipo)][partidaPtr->ativa.rotacao];
+    char proximas[8] = "";
+    for (int i = 0; i < 5; i++) {
+        const Peca* pecaPtr = espiarFila(&partidaPtr->fila, i + (partidaPtr->ativa.origem == 0));
+        proximas[i] = pecaPtr != NULL ? pecaPtr->tipo : '-';
+    }
+    const Peca* reservaPtr = espiarPilha(&partidaPtr->pilha, partidaPtr->ativa.origem == 1);
+    char painel[ALTURA_TABULEIRO][64];
+    memset(painel, 0, sizeof(painel));
+    snprintf(painel[0], sizeof(painel[0]), "TETRIS EXPERT - TEMPO REAL");
+    snprintf(painel[2], sizeof(painel[2]), "Pontuacao: %d", sistemaPtr->pontuacaoTotal);
+    snprintf(painel[3], sizeof(painel[3]), "Nivel: %d (dificuldade %.1f)", sistemaPtr->nivelAtual,
+             sistemaPtr->fatorDificuldade);
+    snprintf(painel[4], sizeof(painel[4]), "Queda: %.1f ms por linha", segundosPorLinha(sistemaPtr) * 1e3);
+    snprintf(painel[5], sizeof(painel[5]), "Combo: %d (melhor %d)", sistemaPtr->comboAtual, sistemaPtr->melhorCombo);
+    snprintf(painel[6], sizeof(painel[6]), "Linhas: %d | Pecas: %d", partidaPtr->linhasEliminadas,
+             partidaPtr->pecasJogadas);
+    snprintf(painel[8], sizeof(painel[8]), "Proximas: %s", proximas);
+    snprintf(painel[9], sizeof(painel[9]), "Reserva: %c (%d/%d)%s", reservaPtr != NULL ? reservaPtr->tipo : '-',
+             partidaPtr->pilha.quantidadeReservada, partidaPtr->pilha.capacidade,
+             partidaPtr->ativa.origem == 1 ? " - em jogo" : "");
+    snprintf(painel[11], sizeof(painel[11]), "Tick %llu", (unsigned long long)partidaPtr->tick);
+    snprintf(painel[13], sizeof(painel[13]), "Setas/WASD: mover, girar, descer");
+    snprintf(painel[14], sizeof(painel[14]), "Espaco: queda rapida");
+    snprintf(painel[15], sizeof(painel[15]), "C: reservar | V: usar reserva");
+    snprintf(painel[16], sizeof(painel[16]), "Q: sair");
+    if (partidaPtr->encerrada) {
+        snprintf(painel[18], sizeof(painel[18]), "FIM DE JOGO");
+    }
+
+    size_t tamanho = 0;
+#define ESCREVER_TELA(...) do {                                                                   \
+        int escritos = snprintf(tela + tamanho, tamanho < capacidade ? capacidade - tamanho : 0, __VA_ARGS__); \
+        tamanho += escritos > 0 ? (size_t)escritos : 0;                                          \
+    } while (0)
+    ESCREVER_TELA("\033[H");
+    for (int y = ALTURA_TABULEIRO - 1; y >= 0; y--) {
+        uint16_t ativa = 0;
+        int i = y - partidaPtr->ativa.linha;
+        if (!partidaPtr->encerrada && i >= 0 && i < forma->altura) {
+            ativa = (uint16_t)(forma->linhas[i] << partidaPtr->ativa.coluna);
+        }
+        char linha[2 * LARGURA_TABULEIRO + 1];
+        for (int x = 0; x < LARGURA_TABULEIRO; x++) {
+            const char* celula = (ativa >> x) & 1 ? "##"
+                                 : (partidaPtr->tabuleiro.linhas[y] >> x) & 1 ? "[]"
+                                 : y >= 20 ? "  " : " .";
+            linha[2 * x] = celula[0];
+            linha[2 * x + 1] = celula[1];
+        }
+        linha[2 * LARGURA_TABULEIRO] = '\0';
+        ESCREVER_TELA("%c%s%c  %s\033[K\n", y >= 20 ? ' ' : '|', linha, y >= 20 ? ' ' : '|',
+                      painel[ALTURA_TABULEIRO - 1 - y]);
+    }
+    ESCREVER_TELA("+--------------------+\033[K\n");
+#undef ESCREVER_TELA
+    return tamanho < capacidade ? tamanho : capacidade - 1;
 }
 
 /**
- * @brief Exibe o menu principal
+ * @brief Converte os bytes lidos do teclado em comandos
+ * @return Número de comandos escritos em comandos
+ *
+ * Setas chegam como ESC [ A..D; teclas desconhecidas são ignoradas.
  */
-void exibirMenu() {
-    printf("\n+==============================================================+\n");
-    printf("|                    TETRIS EXPERT SYSTEM                     |\n");
-    printf("+==============================================================+\n");
-    printf("| 1. Jogar peca da fila                                       |\n");
-    printf("| 2. Jogar peca da pilha de reserva                           |\n");
-    printf("| 3. Transferir peca da fila para reserva                     |\n");
-    printf("| 4. Gerar novas pecas aleatorias                             |\n");
-    printf("| 5. Exibir estado completo                                   |\n");
-    printf("| 6. Exibir estatisticas Expert                               |\n");
-    printf("| 7. Otimizar sistema Expert                                  |\n");
-    printf("| 8. Gerar relatorio Expert                                   |\n");
-    printf("| 0. Sair                                                     |\n");
-    printf("+==============================================================+\n");
-    printf("Escolha uma opcao: ");
+static int traduzirTeclasTempoReal(const unsigned char* bytes, int quantidade, ComandoTempoReal* comandos) {
+    int total = 0;
+    for (int i = 0; i < quantidade; i++) {
+        ComandoTempoReal comando = COMANDO_NENHUM;
+        if (bytes[i] == 0x1B && i + 2 < quantidade && bytes[i + 1] == '[') {
+            switch (bytes[i + 2]) {
+                case 'A': comando = COMANDO_GIRAR; break;
+                case 'B': comando = COMANDO_QUEDA_SUAVE; break;
+                case 'C': comando = COMANDO_DIREITA; break;
+                case 'D': comando = COMANDO_ESQUERDA; break;
+                default: break;
+            }
+            i += 2;
+        } else {
+            switch (bytes[i]) {
+                case 'a': case 'A': comando = COMANDO_ESQUERDA; break;
+                case 'd': case 'D': comando = COMANDO_DIREITA; break;
+                case 'w': case 'W': comando = COMANDO_GIRAR; break;
+                case 's': case 'S': comando = COMANDO_QUEDA_SUAVE; break;
+                case ' ': comando = COMANDO_QUEDA_RAPIDA; break;
+                case 'c': case 'C': comando = COMANDO_RESERVAR; break;
+                case 'v': case 'V': comando = COMANDO_USAR_RESERVA; break;
+                case 'q': case 'Q': case 0x03: comando = COMANDO_SAIR; break;
+                default: break;
+            }
+        }
+        if (comando != COMANDO_NENHUM) {
+            comandos[total++] = comando;
+        }
+    }
+    return total;
 }
 
 /**
- * @brief Pausa a execução aguardando entrada do usuário
+ * @brief Plano do bot para a peça atual, executado um comando por tick
+ */
+typedef struct {
+    AcaoBot plano;
+    int pecaPlanejada;              ///< pecasSurgidas quando o plano foi feito (-1 = nenhum)
+    int bloqueado;                  ///< O último comando foi recusado: larga a peça onde está
+} PilotoTempoReal;
+
+/**
+ * @brief Próximo comando do piloto: reserva, rotação, coluna e queda rápida
+ *
+ * O plano vem de escolherAcaoBot() quando a peça surge. Encaixes por
+ * deslize (viaDeslize) não são executados: a peça cai direto na coluna.
  */
-void pausarExecucao() {
-    printf("\nPressione Enter para continuar...");
-    getchar();
+static ComandoTempoReal comandoPilotoTempoReal(PilotoTempoReal* pilotoPtr, const ConfigBot* configPtr,
+                                               PartidaTempoReal* partidaPtr) {
+    if (pilotoPtr->pecaPlanejada != partidaPtr->pecasSurgidas) {
+        pilotoPtr->pecaPlanejada = partidaPtr->pecasSurgidas;
+        pilotoPtr->bloqueado = 0;
+        if (!escolherAcaoBot(configPtr, &partidaPtr->tabuleiro, &partidaPtr->fila, &partidaPtr->pilha,
+                             &pilotoPtr->plano)) {
+            pilotoPtr->bloqueado = 1;
+        }
+    }
+    if (pilotoPtr->bloqueado) {
+        return COMANDO_QUEDA_RAPIDA;
+    }
+    if (pilotoPtr->plano.tipo == ACAO_RESERVAR) {
+        return COMANDO_RESERVAR;
+    }
+    const Jogada* alvoPtr = &pilotoPtr->plano.jogada;
+    if (partidaPtr->ativa.origem != (pilotoPtr->plano.tipo == ACAO_JOGAR_PILHA)) {
+        return COMANDO_USAR_RESERVA;
+    }
+    if (partidaPtr->ativa.rotacao != alvoPtr->rotacao) {
+        return COMANDO_GIRAR;
+    }
+    if (partidaPtr->ativa.coluna != alvoPtr->coluna) {
+        return partidaPtr->ativa.coluna < alvoPtr->coluna ? COMANDO_DIREITA : COMANDO_ESQUERDA;
+    }
+    return COMANDO_QUEDA_RAPIDA;
+}
+
+static int compararLatenciasTempoReal(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
 }
 
 /**
- * @brief Função principal do programa
- * @return Código de saída
+ * @brief Conduz a partida em passos fixos até ela acabar ou atingir um limite
+ * @param configPtr Velocidade, entrada e saída
+ * @param partidaPtr Partida já iniciada
+ * @param resultadoPtr Medidas da execução (saída)
+ * @return 1 em caso de sucesso, 0 se o relógio não pôde ser criado
+ *
+ * Com velocidade > 0, um timerfd dispara a cada 1/(ticksPorSegundo x
+ * velocidade) s e o laço espera com poll() pelo relógio e pelo teclado ao
+ * mesmo tempo: um comando é aplicado e desenhado assim que chega, sem
+ * esperar o próximo tick. Ticks perdidos (o processo não acordou a tempo)
+ * são executados em seguida, até MAX_TICKS_POR_ACORDAR por vez, e a
+ * partida não muda por isso. Com velocidade 0 os ticks rodam sem pausa. A
+ * latência medida vai da leitura do comando (ou da decisão do piloto) até
+ * a tela com o resultado escrita em saidaJogo.
  */
-int main() {
-    // Inicialização das estruturas
-    FilaCircular fila;
-    PilhaReserva pilha;
-    SistemaExpert sistema;
-    
-    inicializarFila(&fila);
-    inicializarPilha(&pilha);
-    inicializarSistemaExpert(&sistema);
-    
-    // Gerar peças iniciais
-    srand((unsigned int)time(NULL));
-    gerarPecasAleatorias(&fila);
-    
-    int opcao;
-    
-    printf("+==============================================================+\n");
-    printf("|              BEM-VINDO AO TETRIS EXPERT SYSTEM               |\n");
-    printf("|                                                              |\n");
-    printf("|  Sistema inteligente de analise de jogabilidade Tetris      |\n");
-    printf("|  com estatisticas avancadas e otimizacao automatica         |\n");
-    printf("+==============================================================+\n");
-    
-    do {
-        exibirMenu();
-        scanf("%d", &opcao);
-        getchar(); // Limpar buffer
-        
-        switch (opcao) {
-            case 1: {
-                if (!filaVazia(&fila)) {
-                    Peca peca = jogarPecaDaFila(&fila);
-                    processarJogadaExpert(peca, 0, &sistema);
-                    printf("Peca %c (ID: %d) jogada da fila!\n", peca.tipo, peca.id);
-                } else {
-                    printf("Fila vazia! Gere novas pecas primeiro.\n");
-                }
-                pausarExecucao();
-                break;
+int executarPartidaTempoReal(const ConfigTempoReal* configPtr, PartidaTempoReal* partidaPtr,
+                             ResultadoTempoReal* resultadoPtr) {
+    memset(resultadoPtr, 0, sizeof(*resultadoPtr));
+    FILE* saida = saidaJogo != NULL ? saidaJogo : stdout;
+    int descritorRelogio = -1;
+    uint64_t periodoNs = 0;
+    if (configPtr->velocidade > 0.0) {
+        double periodo = 1e9 / (partidaPtr->ticksPorSegundo * configPtr->velocidade);
+        periodoNs = periodo < 1000.0 ? 1000 : (uint64_t)periodo;
+        descritorRelogio = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        struct itimerspec agenda = {{(time_t)(periodoNs / 1000000000ULL), (long)(periodoNs % 1000000000ULL)},
+                                    {(time_t)(periodoNs / 1000000000ULL), (long)(periodoNs % 1000000000ULL)}};
+        if (descritorRelogio < 0 || timerfd_settime(descritorRelogio, 0, &agenda, NULL) != 0) {
+            fprintf(stderr, "Nao foi possivel criar o relogio dos ticks: %s\n", strerror(errno));
+            if (descritorRelogio >= 0) {
+                close(descritorRelogio);
             }
-            case 2: {
-                if (!pilhaVazia(&pilha)) {
-                    Peca peca = jogarPecaDaPilha(&pilha);
-                    processarJogadaExpert(peca, 1, &sistema);
-                    printf("Peca %c (ID: %d) jogada da pilha de reserva!\n", peca.tipo, peca.id);
-                } else {
-                    printf("Pilha de reserva vazia!\n");
+            return 0;
+        }
+    }
+
+    // Teclado: sem eco nem espera por Enter, leitura sem bloqueio
+    int teclado = configPtr->teclado;
+    struct termios terminalOriginal;
+    int terminalBruto = teclado && isatty(STDIN_FILENO) && tcgetattr(STDIN_FILENO, &terminalOriginal) == 0;
+    int flagsEntrada = teclado ? fcntl(STDIN_FILENO, F_GETFL) : -1;
+    if (terminalBruto) {
+        struct termios bruto = terminalOriginal;
+        bruto.c_lflag &= (tcflag_t)~(ICANON | ECHO);
+        bruto.c_cc[VMIN] = 0;
+        bruto.c_cc[VTIME] = 0;
+        tcsetattr(STDIN_FILENO, TCSANOW, &bruto);
+    }
+    if (flagsEntrada >= 0) {
+        fcntl(STDIN_FILENO, F_SETFL, flagsEntrada | O_NONBLOCK);
+    }
+    struct sigaction acao, acaoAnterior;
+    memset(&acao, 0, sizeof(acao));
+    acao.sa_handler = tratarSinalTempoReal;
+    sigemptyset(&acao.sa_mask);
+    sigaction(SIGINT, &acao, &acaoAnterior);
+    sinalEncerrarTempoReal = 0;
+
+    uint64_t* latencias = malloc(sizeof(uint64_t) * CAPACIDADE_LATENCIAS);
+    char* tela = malloc(TAMANHO_TELA_TEMPO_REAL);
+    long amostrasLatencia = 0;
+    if (configPtr->desenhar) {
+        fputs("\033[2J\033[?25l", saida);
+    }
+
+    PilotoTempoReal piloto;
+    memset(&piloto, 0, sizeof(piloto));
+    piloto.pecaPlanejada = -1;
+    uint64_t inicio = instanteDiarioNs(CLOCK_MONOTONIC);
+    uint64_t expiracoes = 0;           // Ticks do relógio desde o início
+    uint64_t pendentes = 0;            // Ticks vencidos ainda não simulados
+    uint64_t entradaPendente = 0;      // Instante do comando mais antigo ainda não desenhado
+    double atrasoTotalUs = 0.0;
+    long acordares = 0;
+    while (!partidaPtr->encerrada && !sinalEncerrarTempoReal &&
+           (configPtr->limitePecas <= 0 || partidaPtr->pecasJogadas < configPtr->limitePecas) &&
+           (configPtr->limiteTicks == 0 || partidaPtr->tick < configPtr->limiteTicks)) {
+        struct pollfd esperas[2];
+        int quantidadeEsperas = 0;
+        if (descritorRelogio >= 0) {
+            esperas[quantidadeEsperas++] = (struct pollfd){descritorRelogio, POLLIN, 0};
+        }
+        int indiceTeclado = -1;
+        if (teclado) {
+            indiceTeclado = quantidadeEsperas;
+            esperas[quantidadeEsperas++] = (struct pollfd){STDIN_FILENO, POLLIN, 0};
+        }
+        // Sem relógio só se olha o teclado entre lotes de ticks
+        int esperarMs = descritorRelogio >= 0 && pendentes == 0 ? -1 : 0;
+        if (quantidadeEsperas > 0 && (descritorRelogio >= 0 || partidaPtr->tick % MAX_TICKS_POR_ACORDAR == 0) &&
+            poll(esperas, (nfds_t)quantidadeEsperas, esperarMs) < 0 && errno != EINTR) {
+            break;
+        }
+        uint64_t agora = instanteDiarioNs(CLOCK_MONOTONIC);
+
+        if (indiceTeclado >= 0 && (esperas[indiceTeclado].revents & (POLLIN | POLLHUP))) {
+            unsigned char bytes[64];
+            ssize_t lidos = read(STDIN_FILENO, bytes, sizeof(bytes));
+            if (lidos == 0 || (lidos < 0 && errno != EAGAIN && errno != EINTR)) {
+                teclado = 0;    // Fim da entrada: com o piloto a partida segue, sem ele acaba
+                if (!configPtr->piloto) {
+                    aplicarComandoTempoReal(partidaPtr, COMANDO_SAIR);
+                }
+            } else if (lidos > 0) {
+                ComandoTempoReal comandos[64];
+                int quantidade = traduzirTeclasTempoReal(bytes, (int)lidos, comandos);
+                for (int c = 0; c < quantidade; c++) {
+                    resultadoPtr->comandos++;
+                    if (aplicarComandoTempoReal(partidaPtr, comandos[c]) && entradaPendente == 0) {
+                        entradaPendente = agora;
+                    }
                 }
-                pausarExecucao();
-                break;
-            }
-            case 3: {
-                transferirPecaFilaParaPilha(&fila, &pilha);
-                pausarExecucao();
-                break;
-            }
-            case 4: {
-                gerarPecasAleatorias(&fila);
-                printf("Novas pecas geradas na fila!\n");
-                pausarExecucao();
-                break;
-            }
-            case 5: {
-                exibirEstadoCompleto(&fila, &pilha, &sistema);
-                pausarExecucao();
-                break;
             }
-            case 6: {
-                exibirEstatisticasExpert(&sistema);
-                pausarExecucao();
-                break;
+            esperas[indiceTeclado].revents = 0;
+        }
+
+        if (descritorRelogio >= 0) {
+            uint64_t vencidos = 0;
+            if ((esperas[0].revents & POLLIN) && read(descritorRelogio, &vencidos, sizeof(vencidos)) == sizeof(vencidos)) {
+                expiracoes += vencidos;
+                pendentes += vencidos;
+                resultadoPtr->ticksAtrasados += vencidos - 1;
+                uint64_t instanteTick = inicio + expiracoes * periodoNs;
+                double atrasoUs = agora > instanteTick ? (agora - instanteTick) / 1e3 : 0.0;
+                atrasoTotalUs += atrasoUs;
+                acordares++;
+                if (atrasoUs > resultadoPtr->atrasoMaximoUs) {
+                    resultadoPtr->atrasoMaximoUs = atrasoUs;
+                }
             }
-            case 7: {
-                if (otimizarSistemaExpert(&sistema)) {
-                    printf("Sistema Expert otimizado com sucesso!\n");
-                } else {
-                    printf("Sistema Expert ja esta otimizado.\n");
+        } else {
+            pendentes = MAX_TICKS_POR_ACORDAR;
+        }
+
+        for (uint64_t t = 0; t < MAX_TICKS_POR_ACORDAR && pendentes > 0 && !partidaPtr->encerrada; t++, pendentes--) {
+            if (configPtr->piloto) {
+                ComandoTempoReal comando = comandoPilotoTempoReal(&piloto, &configPtr->configBot, partidaPtr);
+                resultadoPtr->comandos++;
+                int mudou = aplicarComandoTempoReal(partidaPtr, comando);
+                piloto.bloqueado |= !mudou;
+                if (mudou && configPtr->desenhar && entradaPendente == 0) {
+                    entradaPendente = instanteDiarioNs(CLOCK_MONOTONIC);
                 }
-                pausarExecucao();
-                break;
             }
-            case 8: {
-                gerarRelatorioExpert(&sistema);
-                pausarExecucao();
+            avancarTickTempoReal(partidaPtr);
+            if ((configPtr->limitePecas > 0 && partidaPtr->pecasJogadas >= configPtr->limitePecas) ||
+                (configPtr->limiteTicks != 0 && partidaPtr->tick >= configPtr->limiteTicks)) {
+                pendentes = 1;
                 break;
             }
-            case 0: {
-                printf("\n+==============================================================+\n");
-                printf("|                    OBRIGADO POR JOGAR!                      |\n");
-                printf("|                                                              |\n");
-                printf("|  Pontuacao Final: %8d                               |\n", sistema.pontuacaoTotal);
-                printf("|  Nivel Alcancado: %3d                                    |\n", sistema.nivelAtual);
-                printf("|  Melhor Combo: %3d                                       |\n", sistema.melhorCombo);
-                printf("+==============================================================+\n");
-                break;
+        }
+        if (descritorRelogio < 0) {
+            pendentes = 0;
+        }
+
+        if (configPtr->desenhar && partidaPtr->alterada && pendentes == 0) {
+            size_t tamanho = desenharPartidaTempoReal(partidaPtr, tela, TAMANHO_TELA_TEMPO_REAL);
+            fwrite(tela, 1, tamanho, saida);
+            fflush(saida);
+            partidaPtr->alterada = 0;
+            resultadoPtr->desenhos++;
+            if (entradaPendente != 0) {
+                latencias[amostrasLatencia++ % CAPACIDADE_LATENCIAS] = instanteDiarioNs(CLOCK_MONOTONIC) -
+                                                                       entradaPendente;
+                entradaPendente = 0;
             }
-            default: {
-                printf("Opcao invalida! Tente novamente.\n");
-                pausarExecucao();
-                break;
+        }
+    }
+
+    if (configPtr->desenhar) {
+        size_t tamanho = desenharPartidaTempoReal(partidaPtr, tela, TAMANHO_TELA_TEMPO_REAL);
+        fwrite(tela, 1, tamanho, saida);
+        fputs("\033[?25h", saida);
+        fflush(saida);
+    }
+    sigaction(SIGINT, &acaoAnterior, NULL);
+    if (flagsEntrada >= 0) {
+        fcntl(STDIN_FILENO, F_SETFL, flagsEntrada);
+    }
+    if (terminalBruto) {
+        tcsetattr(STDIN_FILENO, TCSANOW, &terminalOriginal);
+    }
+    if (descritorRelogio >= 0) {
+        close(descritorRelogio);
+    }
+
+    resultadoPtr->segundosReais = (instanteDiarioNs(CLOCK_MONOTONIC) - inicio) * 1e-9;
+    resultadoPtr->segundosSimulados = (double)partidaPtr->tick / partidaPtr->ticksPorSegundo;
+    resultadoPtr->atrasoMedioUs = acordares > 0 ? atrasoTotalUs / acordares : 0.0;
+    int amostras = amostrasLatencia < CAPACIDADE_LATENCIAS ? (int)amostrasLatencia : CAPACIDADE_LATENCIAS;
+    resultadoPtr->amostrasLatencia = amostras;
+    if (amostras > 0) {
+        qsort(latencias, (size_t)amostras, sizeof(uint64_t), compararLatenciasTempoReal);
+        resultadoPtr->latenciaP50Us = latencias[amostras / 2] / 1e3;
+        resultadoPtr->latenciaP99Us = latencias[(long)amostras * 99 / 100] / 1e3;
+        resultadoPtr->latenciaMaximaUs = latencias[amostras - 1] / 1e3;
+    }
+    free(latencias);
+    free(tela);
+    return 1;
+}
+
+/**
+ * @brief Modo de linha de comando: partida com gravidade em tempo real
+ * @return Código de saída
+ *
+ * Uso: tetris --tempo-real [--velocidade x] [--hz n] [--piloto] [--sem-tela]
+ *            [--pecas n] [--semente s] [--fila n] [--pilha n]
+ *            [--arquivo-regras caminho] [--regras nome]
+ *
+ * --velocidade 1 (padrão) é o ritmo humano; 1000 acelera mil vezes e 0
+ * tira o limite. Sem --piloto, o jogador usa o teclado; com --piloto o
+ * bot joga (--sem-tela para testes headless).
+ */
+int executarModoTempoReal(int argc, char* argv[]) {
+    ConfigTempoReal config;
+    memset(&config, 0, sizeof(config));
+    config.velocidade = 1.0;
+    config.desenhar = 1;
+    configurarBotPadrao(&config.configBot);
+    int ticksPorSegundo = TICKS_POR_SEGUNDO_PADRAO;
+    uint64_t semente = (uint64_t)time(NULL);
+    const char* nomeRegras = NULL;
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--velocidade") == 0 && i + 1 < argc) {
+            config.velocidade = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--hz") == 0 && i + 1 < argc) {
+            ticksPorSegundo = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--piloto") == 0) {
+            config.piloto = 1;
+        } else if (strcmp(argv[i], "--sem-tela") == 0) {
+            config.desenhar = 0;
+        } else if (strcmp(argv[i], "--pecas") == 0 && i + 1 < argc) {
+            config.limitePecas = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--semente") == 0 && i + 1 < argc) {
+            semente = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--fila") == 0 && i + 1 < argc) {
+            config.configBot.capacidadeFila = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--pilha") == 0 && i + 1 < argc) {
+            config.configBot.capacidadePilha = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--arquivo-regras") == 0 && i + 1 < argc) {
+            if (carregarRegrasPontuacao(argv[++i]) < 0) {
+                return 1;
             }
+        } else if (strcmp(argv[i], "--regras") == 0 && i + 1 < argc) {
+            nomeRegras = argv[++i];
         }
-    } while (opcao != 0);
-    
+    }
+    if (nomeRegras != NULL && (config.configBot.regrasPontuacao = buscarRegrasPontuacao(nomeRegras)) < 0) {
+        fprintf(stderr, "Regras de pontuacao desconhecidas: %s\n", nomeRegras);
+        return 1;
+    }
+    config.teclado = !config.piloto;
+
+    saidaSilenciosa = 1;
+    static PartidaTempoReal partida;
+    iniciarPartidaTempoReal(&partida, semente, ticksPorSegundo, config.configBot.capacidadeFila,
+                            config.configBot.capacidadePilha, config.configBot.regrasPontuacao);
+    ResultadoTempoReal resultado;
+    if (!executarPartidaTempoReal(&config, &partida, &resultado)) {
+        liberarPartidaTempoReal(&partida);
+        return 1;
+    }
+
+    printf("\nTempo real: %llu ticks (%.1f s de jogo a %d Hz) em %.3f s | %.1fx | %d pecas | %d linhas | "
+           "pontuacao %d | nivel %d\n",
+           (unsigned long long)partida.tick, resultado.segundosSimulados, partida.ticksPorSegundo,
+           resultado.segundosReais, resultado.segundosReais > 0 ? resultado.segundosSimulados / resultado.segundosReais : 0.0,
+           partida.pecasJogadas, partida.linhasEliminadas, partida.sistema.pontuacaoTotal, partida.sistema.nivelAtual);
+    if (config.velocidade > 0.0) {
+        printf("Ticks: atraso medio %.0f us, maximo %.0f us | %llu recuperados em lote\n", resultado.atrasoMedioUs,
+               resultado.atrasoMaximoUs, (unsigned long long)resultado.ticksAtrasados);
+    }
+    if (resultado.amostrasLatencia > 0) {
+        printf("Latencia comando -> tela: p50 %.0f us | p99 %.0f us | max %.0f us (%d amostras, %ld desenhos)\n",
+               resultado.latenciaP50Us, resultado.latenciaP99Us, resultado.latenciaMaximaUs,
+               resultado.amostrasLatencia, resultado.desenhos);
+    }
+    liberarPartidaTempoReal(&partida);
     return 0;
 }
 
+#ifndef TETRIS_SEM_MAIN
+/**
+ * @brief Função principal do programa
+ * @return Código de saída
+ *
+ * O menu interativo é uma sessão conduzida pela entrada padrão, linha a
+ * linha; --fila n e --pilha n mudam as capacidades da sessão, --combos
+ * lista troca os padrões de combo (ver configurarPadroesCombo()) e
+ * --regras nome escolhe as regras de pontuação, embutidas ou carregadas
+ * com --arquivo-regras caminho. --diario caminho grava cada ação da
+ * sessão em segundo plano (--sync nunca|grupo|sempre, --sync-ms n para a
+ * janela do group commit) e mostra as métricas do diário ao sair.
+ * --wal caminho torna a sessão durável: ao iniciar, ela é recuperada do
+ * último checkpoint e do WAL, e um checkpoint é gravado a cada
+ * --checkpoint n opções. --painel nome publica os contadores da sessão
+ * em memória compartilhada para monitores externos. --encaixe automatico
+ * encaixa cada peça jogada no tabuleiro pela avaliação. --bot, --tempo-real,
+ * --torneio, --ajustar-pesos, --replay, --transmissao e --consultar (ver
+ * executarModoBot(), executarModoTempoReal(), executarModoTorneio(),
+ * executarModoAjuste(), executarModoReplay(), executarModoTransmissao() e
+ * executarModoConsulta()) são modos à parte. Defina
+ * TETRIS_SEM_MAIN antes de incluir este arquivo para reutilizar o sistema
+ * em ferramentas e benchmarks sem o menu.
+ */
+int main(int argc, char* argv[]) {
+    if (argc > 1 && strcmp(argv[1], "--bot") == 0) {
+        return executarModoBot(argc, argv);
+    }
+    if (argc > 1 && strcmp(argv[1], "--tempo-real") == 0) {
+        return executarModoTempoReal(argc, argv);
+    }
+    if (argc > 1 && strcmp(argv[1], "--torneio") == 0) {
+        return executarModoTorneio(argc, argv);
+    }
+    if (argc > 1 && strcmp(argv[1], "--ajustar-pesos") == 0) {
+        return executarModoAjuste(argc, argv);
+    }
+    if (argc > 1 && strcmp(argv[1], "--replay") == 0) {
+        return executarModoReplay(argc, argv);
+    }
+    if (argc > 1 && strcmp(argv[1], "--transmissao") == 0) {
+        return executarModoTransmissao(argc, argv);
+    }
+    if (argc > 1 && strcmp(argv[1], "--consultar") == 0) {
+        return executarModoConsulta(argc, argv);
+    }
+
+    int capacidadeFila = CAPACIDADE_PADRAO_FILA;
+    int capacidadePilha = CAPACIDADE_PADRAO_PILHA;
+    const char* nomeRegras = NULL;
+    const char* caminhoDiario = NULL;
+    PoliticaSyncDiario politicaSync = SYNC_DIARIO_GRUPO;
+    int intervaloSyncMs = 10;
+    const char* caminhoWal = NULL;
+    int intervaloCheckpoint = INTERVALO_CHECKPOINT_PADRAO;
+    const char* nomePainel = NULL;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--fila") == 0) {
+            capacidadeFila = atoi(argv[i + 1]);
+        } else if (strcmp(argv[i], "--pilha") == 0) {
+            capacidadePilha = atoi(argv[i + 1]);
+        } else if (strcmp(argv[i], "--combos") == 0 && !configurarPadroesCombo(argv[i + 1])) {
+            fprintf(stderr, "Padroes de combo invalidos: %s\n", argv[i + 1]);
+            return 1;
+        } else if (strcmp(argv[i], "--arquivo-regras") == 0 && carregarRegrasPontuacao(argv[i + 1]) < 0) {
+            return 1;
+        } else if (strcmp(argv[i], "--regras") == 0) {
+            nomeRegras = argv[i + 1];
+        } else if (strcmp(argv[i], "--diario") == 0) {
+            caminhoDiario = argv[i + 1];
+        } else if (strcmp(argv[i], "--sync") == 0) {
+            if (strcmp(argv[i + 1], "nunca") == 0) {
+                politicaSync = SYNC_DIARIO_NUNCA;
+            } else if (strcmp(argv[i + 1], "sempre") == 0) {
+                politicaSync = SYNC_DIARIO_SEMPRE;
+            } else if (strcmp(argv[i + 1], "grupo") == 0) {
+                politicaSync = SYNC_DIARIO_GRUPO;
+            } else {
+                fprintf(stderr, "Politica de sincronizacao desconhecida: %s\n", argv[i + 1]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--sync-ms") == 0) {
+            intervaloSyncMs = atoi(argv[i + 1]);
+        } else if (strcmp(argv[i], "--wal") == 0) {
+            caminhoWal = argv[i + 1];
+        } else if (strcmp(argv[i], "--checkpoint") == 0) {
+            intervaloCheckpoint = atoi(argv[i + 1]) > 0 ? atoi(argv[i + 1]) : INTERVALO_CHECKPOINT_PADRAO;
+        } else if (strcmp(argv[i], "--painel") == 0) {
+            nomePainel = argv[i + 1];
+        } else if (strcmp(argv[i], "--encaixe") == 0) {
+            if (strcmp(argv[i + 1], "automatico") == 0) {
+                encaixeAutomaticoMenu = 1;
+            } else if (strcmp(argv[i + 1], "manual") == 0) {
+                encaixeAutomaticoMenu = 0;
+            } else {
+                fprintf(stderr, "Encaixe desconhecido: %s (use automatico ou manual)\n", argv[i + 1]);
+                return 1;
+            }
+        }
+    }
+    int regras = nomeRegras != NULL ? buscarRegrasPontuacao(nomeRegras) : REGRAS_EXPERT;
+    if (regras < 0) {
+        fprintf(stderr, "Regras de pontuacao desconhecidas: %s\n", nomeRegras);
+        return 1;
+    }
+
+    // Com WAL a sessão vem dos pools, como as recuperadas
+    static SessaoJogo sessao;
+    static HistoricoAcoes historico;
+    static PoolObjetos poolSessoes, poolHistoricos;
+    static WalSessoes wal;
+    SessaoJogo* sessaoPtr = NULL;
+    ResultadoRecuperacaoWal recuperacao;
+    if (caminhoWal != NULL) {
+        SessaoJogo* recuperadas[8];
+        inicializarPool(&poolSessoes, sizeof(SessaoJogo), 4);
+        inicializarPool(&poolHistoricos, sizeof(HistoricoAcoes), 4);
+        if (recuperarSessoesWal(caminhoWal, &poolSessoes, &poolHistoricos, recuperadas, 8, &recuperacao) < 0) {
+            return 1;
+        }
+        if (recuperacao.sessoes > 0) {
+            sessaoPtr = recuperadas[0];
+            fprintf(stderr, "WAL: sessao recuperada (%d do checkpoint, %ld opcoes reaplicadas em %.2f ms)\n",
+                    recuperacao.sessoesCheckpoint, recuperacao.registrosReaplicados, recuperacao.segundos * 1e3);
+        } else {
+            sessaoPtr = abrirSessao(&poolSessoes, &poolHistoricos, 1, (uint64_t)time(NULL));
+        }
+    } else {
+        sessaoPtr = &sessao;
+        iniciarSessao(sessaoPtr, 1, (uint64_t)time(NULL), &historico);
+    }
+    int novaSessao = caminhoWal == NULL || recuperacao.sessoes == 0;
+    if (novaSessao) {
+        definirRegrasPontuacao(&sessaoPtr->sistema, regras);
+        if (!configurarCapacidadesSessao(sessaoPtr, capacidadeFila, capacidadePilha)) {
+            fprintf(stderr, "Capacidades invalidas: fila 1-%d, pilha 1-%d\n",
+                    CAPACIDADE_MAXIMA_FILA, CAPACIDADE_MAXIMA_PILHA);
+            return 1;
+        }
+    }
+    if (caminhoWal != NULL) {
+        if (!abrirWal(&wal, caminhoWal, &recuperacao)) {
+            return 1;
+        }
+        walSessoes = &wal;
+        if (novaSessao) {
+            registrarAberturaWal(&wal, sessaoPtr);
+        }
+    }
+
+    static DiarioJogadas diario;
+    if (caminhoDiario != NULL) {
+        if (!abrirDiario(&diario, caminhoDiario, politicaSync, intervaloSyncMs)) {
+            return 1;
+        }
+        diarioJogadas = &diario;
+    }
+
+    static PainelEstatisticas painel;
+    if (nomePainel != NULL && (!criarPainelEstatisticas(&painel, nomePainel, 1) ||
+                               !publicarSessaoPainel(&painel, sessaoPtr))) {
+        return 1;
+    }
+
+    char linha[128];
+    int opcoes = 0;
+    EstadoSessao estado = retomarSessao(sessaoPtr, NULL);
+    while (estado != SESSAO_ENCERRADA && fgets(linha, sizeof(linha), stdin) != NULL) {
+        estado = retomarSessao(sessaoPtr, linha);
+        if (walSessoes != NULL && estado == SESSAO_AGUARDA_ENTER && ++opcoes % intervaloCheckpoint == 0) {
+            gravarCheckpointWal(walSessoes, &sessaoPtr, 1);
+        }
+    }
+    if (nomePainel != NULL) {
+        retirarSessaoPainel(sessaoPtr);
+        fecharPainelEstatisticas(&painel);
+    }
+
+    if (walSessoes != NULL) {
+        // Sem a opção 0 (fim da entrada), a sessão continua na próxima execução
+        if (estado == SESSAO_ENCERRADA) {
+            registrarFechamentoWal(walSessoes, sessaoPtr);
+            gravarCheckpointWal(walSessoes, NULL, 0);
+        }
+        walSessoes = NULL;
+        fecharWal(&wal);
+        fprintf(stderr, "WAL: %llu registros, %llu fdatasync (maior grupo %d), %llu checkpoints\n",
+                (unsigned long long)wal.registros, (unsigned long long)wal.sincronizacoes, wal.maiorGrupo,
+                (unsigned long long)wal.checkpoints);
+    }
+
+    if (diarioJogadas != NULL) {
+        MetricasDiario metricas;
+        diarioJogadas = NULL;
+        fecharDiario(&diario);
+        lerMetricasDiario(&diario, &metricas);
+        fprintf(stderr, "Diario: %llu eventos gravados, %llu descartados, %llu escritas, %llu fdatasync "
+                "(max %.2f ms), fila maxima %llu\n",
+                (unsigned long long)metricas.eventosEscritos, (unsigned long long)metricas.eventosDescartados,
+                (unsigned long long)metricas.escritas, (unsigned long long)metricas.sincronizacoes,
+                metricas.latenciaSyncMaximaNs / 1e6, (unsigned long long)metricas.profundidadeMaxima);
+    }
+    return 0;
+}
+#endif // TETRIS_SEM_MAIN